@@ -63,6 +63,14 @@ class MathUtil {
     return floor_of_ratio;
   }
 
+  // Returns the smallest multiple of "factor" that is greater than or equal to
+  // "n". Both must be non-negative and factor must be positive.
+  template <typename IntegralType>
+  static IntegralType RoundUpTo(IntegralType n, IntegralType factor) {
+    DCHECK_GT(factor, 0);
+    return CeilOfRatio(n, factor) * factor;
+  }
+
   // Returns the greatest common divisor of two unsigned integers x and y.
   static unsigned int GCD(unsigned int x, unsigned int y) {
     while (y != 0) {
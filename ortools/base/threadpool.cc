@@ -15,22 +15,45 @@
 
 #include <functional>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif  // defined(__linux__)
+
 namespace operations_research {
-void RunWorker(void* data) {
-  ThreadPool* const thread_pool = reinterpret_cast<ThreadPool*>(data);
-  std::function<void()> work = thread_pool->GetNextTask();
+namespace {
+// The pool and worker number of the calling thread, if it is a worker.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local int current_worker = -1;
+}  // namespace
+
+void ThreadPool::RunWorker(int worker, int cpu) {
+#if defined(__linux__)
+  if (cpu >= 0) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    // Pinning is best effort: on failure, the worker runs unpinned.
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+  }
+#endif  // defined(__linux__)
+  current_pool = this;
+  current_worker = worker;
+  std::function<void()> work = GetNextTask(worker);
   while (work != nullptr) {
     work();
-    work = thread_pool->GetNextTask();
+    work = GetNextTask(worker);
   }
 }
 
 ThreadPool::ThreadPool(absl::string_view prefix, int num_workers)
-    : num_workers_(num_workers) {}
+    : num_workers_(num_workers), worker_tasks_(num_workers) {}
 
 ThreadPool::~ThreadPool() {
   if (started_) {
@@ -50,16 +73,48 @@ void ThreadPool::SetQueueCapacity(int capacity) {
   queue_capacity_ = capacity;
 }
 
+void ThreadPool::SetPinWorkersToCpus(bool pin_workers_to_cpus) {
+  CHECK(!started_);
+  pin_workers_to_cpus_ = pin_workers_to_cpus;
+}
+
+int ThreadPool::CurrentWorker() const {
+  return current_pool == this ? current_worker : -1;
+}
+
 void ThreadPool::StartWorkers() {
   started_ = true;
+  // The CPUs to pin the workers to, if any.
+  std::vector<int> cpus;
+#if defined(__linux__)
+  if (pin_workers_to_cpus_) {
+    cpu_set_t allowed_cpus;
+    CPU_ZERO(&allowed_cpus);
+    if (sched_getaffinity(0, sizeof(allowed_cpus), &allowed_cpus) == 0) {
+      for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed_cpus)) cpus.push_back(cpu);
+      }
+    }
+  }
+#endif  // defined(__linux__)
   for (int i = 0; i < num_workers_; ++i) {
-    all_workers_.push_back(std::thread(&RunWorker, this));
+    // Each worker pins itself before running its first task, so that it
+    // never runs a task, and never first-touches memory, on another CPU.
+    const int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+    all_workers_.push_back(std::thread(&ThreadPool::RunWorker, this, i, cpu));
   }
 }
 
-std::function<void()> ThreadPool::GetNextTask() {
+std::function<void()> ThreadPool::GetNextTask() { return GetNextTask(-1); }
+
+std::function<void()> ThreadPool::GetNextTask(int worker) {
   std::unique_lock<std::mutex> lock(mutex_);
   for (;;) {
+    if (worker >= 0 && !worker_tasks_[worker].empty()) {
+      std::function<void()> task = std::move(worker_tasks_[worker].front());
+      worker_tasks_[worker].pop_front();
+      return task;
+    }
     if (!tasks_.empty()) {
       std::function<void()> task = tasks_.front();
       tasks_.pop_front();
@@ -91,4 +146,17 @@ void ThreadPool::Schedule(std::function<void()> closure) {
   }
 }
 
+void ThreadPool::ScheduleOnWorker(int worker, std::function<void()> closure) {
+  CHECK_GE(worker, 0);
+  CHECK_LT(worker, num_workers_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  worker_tasks_[worker].push_back(std::move(closure));
+  if (started_) {
+    lock.unlock();
+    // The workers share `condition_`, so all of them are woken up to let the
+    // right one pick up the task.
+    condition_.notify_all();
+  }
+}
+
 }  // namespace operations_research
@@ -35,15 +35,41 @@ class ThreadPool {
   std::function<void()> GetNextTask();
   void SetQueueCapacity(int capacity);
 
+  int NumWorkers() const { return num_workers_; }
+
+  // Schedules `closure` to run on the worker thread number `worker`, in
+  // [0, NumWorkers()). Scheduling the same kind of work on the same worker
+  // keeps its data in that worker's caches and, with first-touch page
+  // placement, in the memory of that worker's NUMA node. The tasks of a worker
+  // run before the tasks scheduled with Schedule(), and are not limited by the
+  // queue capacity.
+  void ScheduleOnWorker(int worker, std::function<void()> closure);
+
+  // Returns the number of the worker running the calling thread, or -1 if the
+  // calling thread is not a worker of this pool.
+  int CurrentWorker() const;
+
+  // If set before StartWorkers(), worker number i pins itself to the i-th CPU
+  // (modulo their number) that the process is allowed to run on, before it
+  // runs any task. Only has an effect on Linux.
+  void SetPinWorkersToCpus(bool pin_workers_to_cpus);
+
  private:
+  // Runs the tasks of `worker`, pinned to `cpu` if it is not -1.
+  void RunWorker(int worker, int cpu);
+  std::function<void()> GetNextTask(int worker);
+
   const int num_workers_;
   std::list<std::function<void()>> tasks_;
+  // Size: num_workers_. The tasks of ScheduleOnWorker().
+  std::vector<std::list<std::function<void()>>> worker_tasks_;
   std::mutex mutex_;
   std::condition_variable condition_;
   std::condition_variable capacity_condition_;
   bool waiting_to_finish_ = false;
   bool waiting_for_capacity_ = false;
   bool started_ = false;
+  bool pin_workers_to_cpus_ = false;
   int queue_capacity_ = 2e9;
   std::vector<std::thread> all_workers_;
 };
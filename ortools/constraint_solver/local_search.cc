@@ -4430,6 +4430,13 @@ class FindOneNeighbor : public DecisionBuilder {
                   const RegularLimit* limit,
                   LocalSearchFilterManager* filter_manager);
   ~FindOneNeighbor() override {}
+  // Makes the next call to Next() synchronize the operators and the filters
+  // with the current assignment, as the previous search may have stopped in the
+  // middle of a neighborhood.
+  void EnterSearch() {
+    neighbor_found_ = false;
+    last_synchronized_assignment_.reset();
+  }
   Decision* Next(Solver* solver) override;
   std::string DebugString() const override { return "FindOneNeighbor"; }
 
@@ -4963,6 +4970,7 @@ class LocalSearch : public DecisionBuilder {
   DecisionBuilder* const first_solution_sub_decision_builder_;
   DecisionBuilder* const sub_decision_builder_;
   std::vector<NestedSolveDecision*> nested_decisions_;
+  FindOneNeighbor* find_neighbors_ = nullptr;
   int nested_decision_index_;
   RegularLimit* const limit_;
   LocalSearchFilterManager* const filter_manager_;
@@ -5116,6 +5124,7 @@ Decision* LocalSearch::Next(Solver* const solver) {
   CHECK_LT(0, nested_decisions_.size());
   if (!has_started_) {
     nested_decision_index_ = 0;
+    find_neighbors_->EnterSearch();
     solver->SaveAndSetValue(&has_started_, true);
   } else if (nested_decision_index_ < 0) {
     solver->Fail();
@@ -5178,11 +5187,11 @@ void LocalSearch::PushFirstSolutionDecision(DecisionBuilder* first_solution) {
 
 void LocalSearch::PushLocalSearchDecision() {
   Solver* const solver = assignment_->solver();
-  DecisionBuilder* find_neighbors = solver->RevAlloc(
+  find_neighbors_ = solver->RevAlloc(
       new FindOneNeighbor(assignment_, objective_, pool_, ls_operator_,
                           sub_decision_builder_, limit_, filter_manager_));
   nested_decisions_.push_back(
-      solver->RevAlloc(new NestedSolveDecision(find_neighbors, false)));
+      solver->RevAlloc(new NestedSolveDecision(find_neighbors_, false)));
 }
 
 class DefaultSolutionPool : public SolutionPool {
@@ -0,0 +1,74 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ortools/constraint_solver/constraint_solver.h"
+
+namespace operations_research {
+namespace {
+
+// Minimizes the sum of 5 variables by decrementing one of them at a time,
+// starting from all of them at the same value.
+class ResolveTest : public testing::Test {
+ protected:
+  ResolveTest() : solver_("ResolveTest") {
+    solver_.MakeIntVarArray(5, 0, 100, "x", &vars_);
+    cost_ = solver_.MakeSum(vars_)->Var();
+    start_ = solver_.MakeAssignment();
+    start_->Add(vars_);
+    local_search_ = solver_.MakeLocalSearchPhase(
+        start_, solver_.MakeLocalSearchPhaseParameters(
+                    cost_, solver_.MakeOperator(vars_, Solver::DECREMENT),
+                    nullptr));
+    last_solution_ = solver_.MakeLastSolutionCollector();
+    last_solution_->Add(vars_);
+    last_solution_->AddObjective(cost_);
+  }
+
+  // Returns the cost of the last of the first `solution_limit` solutions of
+  // the search starting from all variables at `value`.
+  int64_t Solve(int64_t value, int64_t solution_limit) {
+    for (IntVar* const var : vars_) start_->SetValue(var, value);
+    EXPECT_TRUE(solver_.Solve(
+        local_search_, {last_solution_, solver_.MakeMinimize(cost_, 1),
+                        solver_.MakeSolutionsLimit(solution_limit)}));
+    return last_solution_->objective_value(0);
+  }
+
+  Solver solver_;
+  std::vector<IntVar*> vars_;
+  IntVar* cost_ = nullptr;
+  Assignment* start_ = nullptr;
+  DecisionBuilder* local_search_ = nullptr;
+  SolutionCollector* last_solution_ = nullptr;
+};
+
+// The solutions are the starting assignment, then one decrement per solution.
+TEST_F(ResolveTest, FirstSearch) { EXPECT_EQ(Solve(50, 3), 248); }
+
+// A search which stopped at its solution limit right after a neighbor was
+// accepted must not leak its neighborhood into the next search: the first
+// neighbor of the next search is one decrement away from its own start, even
+// if the neighbors of the previous search are better.
+TEST_F(ResolveTest, ResolveAfterSolutionLimit) {
+  EXPECT_EQ(Solve(50, 3), 248);
+  EXPECT_EQ(Solve(60, 2), 299);
+  EXPECT_EQ(Solve(40, 4), 197);
+  EXPECT_EQ(Solve(60, 2), 299);
+}
+
+}  // namespace
+}  // namespace operations_research
@@ -52,6 +52,7 @@
 #include "ortools/base/protoutil.h"
 #include "ortools/base/stl_util.h"
 #include "ortools/base/strong_vector.h"
+#include "ortools/base/threadpool.h"
 #include "ortools/base/types.h"
 #include "ortools/constraint_solver/constraint_solver.h"
 #include "ortools/constraint_solver/constraint_solveri.h"
@@ -398,6 +399,9 @@ RoutingModel::RoutingModel(const RoutingIndexManager& index_manager,
       costs_are_homogeneous_across_vehicles_(
           parameters.reduce_vehicle_cost_model()),
       cache_callbacks_(false),
+      max_arc_cost_table_memory_bytes_(
+          parameters.max_arc_cost_table_memory_bytes()),
+      num_arc_cost_table_threads_(parameters.num_arc_cost_table_threads()),
       vehicle_class_index_of_vehicle_(vehicles_, VehicleClassIndex(-1)),
       vehicle_pickup_delivery_policy_(vehicles_, PICKUP_AND_DELIVERY_NO_ORDER),
       has_hard_type_incompatibilities_(false),
@@ -1970,6 +1974,7 @@ void RoutingModel::CloseModelWithParameters(
   }
 
   ComputeCostClasses(parameters);
+  ComputeArcCostTables();
   ComputeVehicleClasses();
   ComputeVehicleTypes();
   FinalizeVisitTypes();
@@ -3312,19 +3317,224 @@ std::vector<std::vector<int64_t>> RoutingModel::GetRoutesFromAssignment(
 }
 #endif
 
+namespace {
+// Minimum number of neighbors per node for a sparse arc cost table to be
+// worth its memory.
+constexpr int64_t kMinArcCostTableNeighbors = 10;
+}  // namespace
+
+int64_t RoutingModel::GetArcCostWithoutFixedCost(
+    int64_t from_index, int64_t to_index, const CostClass& cost_class) const {
+  return CapAdd(
+      transit_evaluators_[cost_class.evaluator_index](from_index, to_index),
+      GetDimensionTransitCostSum(from_index, to_index, cost_class));
+}
+
+void RoutingModel::ComputeArcCostTables() {
+  arc_cost_tables_.clear();
+  const int64_t num_rows = Size();
+  const int64_t num_columns = Size() + vehicles_;
+  if (max_arc_cost_table_memory_bytes_ <= 0 || num_rows == 0) return;
+  arc_cost_tables_.resize(cost_classes_.size());
+  // Calls process_row(row, costs) for all rows, where costs points to the
+  // costs of the arcs from row to all columns, in blocks of rows run by
+  // num_arc_cost_table_threads_ threads. Stops early, leaving some rows
+  // unprocessed, as soon as process_row() returns false, and then returns
+  // false.
+  const auto for_each_row =
+      [this, num_rows, num_columns](
+          const CostClass& cost_class,
+          const std::function<bool(int64_t, const int64_t*)>& process_row) {
+        std::atomic<bool> stopped = false;
+        const auto process_rows = [this, num_columns, &cost_class, &process_row,
+                                   &stopped](int64_t begin, int64_t end) {
+          std::vector<int64_t> costs(num_columns);
+          for (int64_t row = begin;
+               row < end && !stopped.load(std::memory_order_relaxed); ++row) {
+            for (int64_t column = 0; column < num_columns; ++column) {
+              // Arcs from a node to itself are never looked up.
+              costs[column] =
+                  column == row
+                      ? 0
+                      : GetArcCostWithoutFixedCost(row, column, cost_class);
+            }
+            if (!process_row(row, costs.data())) {
+              stopped.store(true, std::memory_order_relaxed);
+            }
+          }
+        };
+        const int num_threads =
+            std::min<int64_t>(num_arc_cost_table_threads_, num_rows);
+        if (num_threads <= 1) {
+          process_rows(0, num_rows);
+        } else {
+          // More blocks than threads, to balance the threads when the costs of
+          // some rows are slower to compute.
+          const int64_t num_blocks =
+              std::min<int64_t>(num_rows, 8 * num_threads);
+          ThreadPool thread_pool("ArcCostTables", num_threads);
+          thread_pool.StartWorkers();
+          for (int64_t block = 0; block < num_blocks; ++block) {
+            thread_pool.Schedule(
+                [&process_rows, block, num_blocks, num_rows]() {
+                  process_rows(block * num_rows / num_blocks,
+                               (block + 1) * num_rows / num_blocks);
+                });
+          }
+          // The destructor of thread_pool waits for all blocks to be
+          // processed.
+        }
+        return !stopped.load();
+      };
+  // Stores the arcs from row to its table.num_neighbors nearest neighbors in
+  // the SPARSE table, given the costs of the arcs from row to all columns.
+  const auto fill_sparse_row = [num_columns](ArcCostTable& table, int64_t row,
+                                             const int64_t* costs) {
+    std::vector<int> heads;
+    heads.reserve(num_columns - 1);
+    for (int head = 0; head < num_columns; ++head) {
+      if (head != row) heads.push_back(head);
+    }
+    // Ties are broken by head, so that the table is deterministic.
+    const auto is_nearer = [costs](int head1, int head2) {
+      return std::tie(costs[head1], head1) < std::tie(costs[head2], head2);
+    };
+    std::nth_element(heads.begin(), heads.begin() + table.num_neighbors - 1,
+                     heads.end(), is_nearer);
+    heads.resize(table.num_neighbors);
+    std::sort(heads.begin(), heads.end());
+    const int64_t row_start = row * table.num_neighbors;
+    for (int64_t k = 0; k < table.num_neighbors; ++k) {
+      table.sparse_heads[row_start + k] = heads[k];
+      table.sparse_costs[row_start + k] = costs[heads[k]];
+    }
+  };
+
+  const int64_t num_arcs = num_rows * num_columns;
+  int64_t memory_left = max_arc_cost_table_memory_bytes_;
+  // The zero cost class only has the fixed costs of vehicles.
+  for (CostClassIndex cost_class_index(kCostClassIndexOfZeroCost + 1);
+       cost_class_index < cost_classes_.size(); ++cost_class_index) {
+    if (!HasVehicleWithCostClassIndex(cost_class_index)) continue;
+    const CostClass& cost_class = cost_classes_[cost_class_index];
+    ArcCostTable& table = arc_cost_tables_[cost_class_index];
+    // A dense table is first filled in 32 bits, each row being narrowed as it
+    // is computed, and only filled again in 64 bits if a cost doesn't fit, so
+    // that building a table takes no more memory than the table itself.
+    if (num_arcs <= memory_left / static_cast<int64_t>(sizeof(int32_t))) {
+      table.dense_int32_costs.resize(num_arcs);
+      const bool fits_in_int32 = for_each_row(
+          cost_class,
+          [&table, num_columns](int64_t row, const int64_t* costs) {
+            int32_t* const row_costs =
+                table.dense_int32_costs.data() + row * num_columns;
+            for (int64_t column = 0; column < num_columns; ++column) {
+              if (costs[column] < std::numeric_limits<int32_t>::min() ||
+                  costs[column] > std::numeric_limits<int32_t>::max()) {
+                return false;
+              }
+              row_costs[column] = static_cast<int32_t>(costs[column]);
+            }
+            return true;
+          });
+      if (fits_in_int32) {
+        table.type = ArcCostTable::DENSE_INT32;
+        memory_left -= num_arcs * sizeof(int32_t);
+        VLOG(1) << "Dense int32 arc cost table for cost class "
+                << cost_class_index;
+        continue;
+      }
+      table.dense_int32_costs = std::vector<int32_t>();
+      if (num_arcs <= memory_left / static_cast<int64_t>(sizeof(int64_t))) {
+        table.dense_int64_costs.resize(num_arcs);
+        for_each_row(cost_class,
+                     [&table, num_columns](int64_t row, const int64_t* costs) {
+                       std::copy(costs, costs + num_columns,
+                                 table.dense_int64_costs.begin() +
+                                     row * num_columns);
+                       return true;
+                     });
+        table.type = ArcCostTable::DENSE_INT64;
+        memory_left -= num_arcs * sizeof(int64_t);
+        VLOG(1) << "Dense int64 arc cost table for cost class "
+                << cost_class_index;
+        continue;
+      }
+    }
+    const int64_t num_neighbors =
+        std::min(memory_left / (num_rows * static_cast<int64_t>(
+                                               sizeof(int) + sizeof(int64_t))),
+                 num_columns - 1);
+    if (num_neighbors < kMinArcCostTableNeighbors) {
+      VLOG(1) << "No arc cost table for cost class " << cost_class_index;
+      continue;
+    }
+    table.num_neighbors = num_neighbors;
+    table.sparse_heads.resize(num_rows * num_neighbors);
+    table.sparse_costs.resize(num_rows * num_neighbors);
+    for_each_row(cost_class, [&table, &fill_sparse_row](int64_t row,
+                                                        const int64_t* costs) {
+      fill_sparse_row(table, row, costs);
+      return true;
+    });
+    table.type = ArcCostTable::SPARSE;
+    memory_left -= num_rows * num_neighbors * (sizeof(int) + sizeof(int64_t));
+    VLOG(1) << "Sparse arc cost table with " << num_neighbors
+            << " neighbors per node for cost class " << cost_class_index;
+  }
+}
+
+bool RoutingModel::FindArcCostInTable(int64_t from_index, int64_t to_index,
+                                      CostClassIndex cost_class_index,
+                                      int64_t* cost) const {
+  // Arcs from ends are not in the tables.
+  if (arc_cost_tables_.empty() || from_index >= Size()) return false;
+  const ArcCostTable& table = arc_cost_tables_[cost_class_index];
+  DCHECK_LT(to_index, Size() + vehicles_);
+  switch (table.type) {
+    case ArcCostTable::NONE:
+      return false;
+    case ArcCostTable::DENSE_INT32:
+      *cost = table.dense_int32_costs[from_index * (Size() + vehicles_) +
+                                      to_index];
+      return true;
+    case ArcCostTable::DENSE_INT64:
+      *cost = table.dense_int64_costs[from_index * (Size() + vehicles_) +
+                                      to_index];
+      return true;
+    case ArcCostTable::SPARSE: {
+      const auto begin =
+          table.sparse_heads.begin() + from_index * table.num_neighbors;
+      const auto end = begin + table.num_neighbors;
+      const auto it = std::lower_bound(begin, end, to_index);
+      if (it == end || *it != to_index) return false;
+      *cost = table.sparse_costs[it - table.sparse_heads.begin()];
+      return true;
+    }
+  }
+  return false;
+}
+
 int64_t RoutingModel::GetArcCostForClassInternal(
     int64_t from_index, int64_t to_index,
     CostClassIndex cost_class_index) const {
   DCHECK(closed_);
   DCHECK_GE(cost_class_index, 0);
   DCHECK_LT(cost_class_index, cost_classes_.size());
+  int64_t cost = 0;
+  if (FindArcCostInTable(from_index, to_index, cost_class_index, &cost)) {
+    if (!IsStart(from_index)) return cost;
+    // Same as below.
+    const int vehicle = VehicleIndex(from_index);
+    if (!IsEnd(to_index)) return CapAdd(cost, fixed_cost_of_vehicle_[vehicle]);
+    return vehicle_used_when_empty_[vehicle] ? cost : 0;
+  }
   CostCacheElement* const cache = &cost_cache_[from_index];
   // See the comment in CostCacheElement in the .h for the int64_t->int cast.
   if (cache->index == static_cast<int>(to_index) &&
       cache->cost_class_index == cost_class_index) {
     return cache->cost;
   }
-  int64_t cost = 0;
   const CostClass& cost_class = cost_classes_[cost_class_index];
   const auto& evaluator = transit_evaluators_[cost_class.evaluator_index];
   if (!IsStart(from_index)) {
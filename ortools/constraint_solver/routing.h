@@ -1224,7 +1224,8 @@ class RoutingModel {
   /// corresponds to the 'number_of_solutions_to_collect' in
   /// 'search_parameters'. Note that the Assignment returned by the method and
   /// the ones in solutions are owned by the underlying solver and should not be
-  /// deleted.
+  /// deleted. The search runs on a single thread; see ParallelRoutingSolver in
+  /// routing_parallel.h to run several searches in parallel.
   const Assignment* SolveWithParameters(
       const RoutingSearchParameters& search_parameters,
       std::vector<const Assignment*>* solutions = nullptr);
@@ -1577,7 +1578,9 @@ class RoutingModel {
   /// Unlike GetArcCostForVehicle(), if cost_class is kNoCost, then the
   /// returned cost won't necessarily be zero: only some of the components
   /// of the cost that depend on the cost class will be omited. See the code
-  /// for details.
+  /// for details. The costs are looked up in the arc cost tables when they
+  /// were precomputed, see
+  /// RoutingModelParameters.max_arc_cost_table_memory_bytes.
   int64_t GetArcCostForClass(int64_t from_index, int64_t to_index,
                              int64_t /*CostClassIndex*/ cost_class_index) const;
   /// Get the cost class index of the given vehicle.
@@ -1866,6 +1869,24 @@ class RoutingModel {
     int64_t cost;
   };
 
+  /// Arc costs of a cost class precomputed by ComputeArcCostTables(), without
+  /// the fixed costs of vehicles and the special case of empty routes, which
+  /// are applied by GetArcCostForClassInternal(). Rows are the from indices in
+  /// [0, Size()), columns the to indices in [0, Size() + vehicles()).
+  struct ArcCostTable {
+    enum Type { NONE, DENSE_INT32, DENSE_INT64, SPARSE };
+    Type type = NONE;
+    std::vector<int32_t> dense_int32_costs;
+    std::vector<int64_t> dense_int64_costs;
+    /// The arcs of row i of a SPARSE table are the arcs to its num_neighbors
+    /// nearest neighbors, sparse_heads[k] for k in
+    /// [i * num_neighbors, (i + 1) * num_neighbors), sorted by increasing
+    /// head, with costs sparse_costs[k].
+    int64_t num_neighbors = 0;
+    std::vector<int> sparse_heads;
+    std::vector<int64_t> sparse_costs;
+  };
+
   /// Internal struct used to store the lp/mp versions of the local and global
   /// cumul optimizers for a given dimension.
   template <class DimensionCumulOptimizer>
@@ -1947,6 +1968,18 @@ class RoutingModel {
   void TopologicallySortVisitTypes();
   int64_t GetArcCostForClassInternal(int64_t from_index, int64_t to_index,
                                      CostClassIndex cost_class_index) const;
+  /// Returns the cost of the arc from 'from_index' to 'to_index' for the
+  /// given cost class, without the fixed cost of vehicles.
+  int64_t GetArcCostWithoutFixedCost(int64_t from_index, int64_t to_index,
+                                     const CostClass& cost_class) const;
+  /// Fills arc_cost_tables_ within max_arc_cost_table_memory_bytes_, see
+  /// RoutingModelParameters.max_arc_cost_table_memory_bytes.
+  void ComputeArcCostTables();
+  /// Sets 'cost' to the arc cost stored in the table of the cost class, if
+  /// any, and returns whether there was one.
+  bool FindArcCostInTable(int64_t from_index, int64_t to_index,
+                          CostClassIndex cost_class_index,
+                          int64_t* cost) const;
   void AppendHomogeneousArcCosts(const RoutingSearchParameters& parameters,
                                  int node_index,
                                  std::vector<IntVar*>* cost_elements);
@@ -2285,6 +2318,11 @@ class RoutingModel {
   bool costs_are_homogeneous_across_vehicles_;
   bool cache_callbacks_;
   mutable std::vector<CostCacheElement> cost_cache_;  /// Index by source index.
+  int64_t max_arc_cost_table_memory_bytes_;
+  int num_arc_cost_table_threads_;
+#ifndef SWIG
+  absl::StrongVector<CostClassIndex, ArcCostTable> arc_cost_tables_;
+#endif  // SWIG
   std::vector<VehicleClassIndex> vehicle_class_index_of_vehicle_;
 #ifndef SWIG
   absl::StrongVector<VehicleClassIndex, VehicleClass> vehicle_classes_;
@@ -0,0 +1,112 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Arc cost evaluations per second (items_per_second) of
+// RoutingModel::GetArcCostForClass(), with the costs computed by the transit
+// callback, or looked up in the arc cost tables precomputed when the model is
+// closed (see RoutingModelParameters.max_arc_cost_table_memory_bytes).
+//
+// The nodes are on a strip, in the order of their indices, so that the
+// nearest neighbors of a node have nearby indices. The arcs evaluated go from
+// random nodes to nodes at most kMaxArcLength indices away, like the arcs
+// evaluated by neighbor-based local search operators. They are all in the
+// sparse tables, which store the kNumSparseNeighbors nearest neighbors of
+// each node.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "ortools/constraint_solver/routing.h"
+#include "ortools/constraint_solver/routing_index_manager.h"
+#include "ortools/constraint_solver/routing_parameters.h"
+#include "ortools/constraint_solver/routing_parameters.pb.h"
+
+namespace operations_research {
+namespace {
+
+constexpr int kNumArcs = 1 << 16;
+constexpr int kMaxArcLength = 8;
+constexpr int64_t kNumSparseNeighbors = 32;
+
+enum ArcCostTableType { kNoTable = 0, kSparseTable = 1, kDenseTable = 2 };
+
+// Arguments are the number of nodes and the ArcCostTableType.
+void BM_GetArcCostForClass(benchmark::State& state) {
+  const int num_nodes = state.range(0);
+  RoutingIndexManager manager(num_nodes, /*num_vehicles=*/1,
+                              RoutingIndexManager::NodeIndex(0));
+  RoutingModelParameters parameters = DefaultRoutingModelParameters();
+  // With a single vehicle whose start and end are node 0, the model has
+  // num_nodes rows of num_nodes + 1 arcs.
+  switch (state.range(1)) {
+    case kSparseTable:
+      parameters.set_max_arc_cost_table_memory_bytes(
+          num_nodes * kNumSparseNeighbors * (sizeof(int) + sizeof(int64_t)));
+      break;
+    case kDenseTable:
+      parameters.set_max_arc_cost_table_memory_bytes(
+          int64_t{num_nodes} * (num_nodes + 1) * sizeof(int32_t));
+      break;
+  }
+  RoutingModel model(manager, parameters);
+
+  std::mt19937 random(12345);
+  std::uniform_real_distribution<double> jitter(0.0, 10.0);
+  std::vector<std::pair<double, double>> positions(num_nodes);
+  for (int node = 0; node < num_nodes; ++node) {
+    positions[node] = {10.0 * node, jitter(random)};
+  }
+  const int transit = model.RegisterTransitCallback(
+      [&manager, &positions](int64_t from_index, int64_t to_index) {
+        const auto& [from_x, from_y] =
+            positions[manager.IndexToNode(from_index).value()];
+        const auto& [to_x, to_y] =
+            positions[manager.IndexToNode(to_index).value()];
+        return static_cast<int64_t>(
+            std::round(std::hypot(to_x - from_x, to_y - from_y)));
+      });
+  model.SetArcCostEvaluatorOfAllVehicles(transit);
+  model.CloseModel();
+  const int64_t cost_class = model.GetCostClassIndexOfVehicle(0).value();
+
+  std::uniform_int_distribution<int64_t> tail(0, model.Size() - 1);
+  std::uniform_int_distribution<int64_t> offset(-kMaxArcLength, kMaxArcLength);
+  std::vector<std::pair<int64_t, int64_t>> arcs;
+  arcs.reserve(kNumArcs);
+  while (arcs.size() < kNumArcs) {
+    const int64_t from = tail(random);
+    const int64_t to = std::clamp<int64_t>(from + offset(random), 0,
+                                           model.Size() - 1);
+    if (from != to) arcs.push_back({from, to});
+  }
+
+  for (auto _ : state) {
+    int64_t total_cost = 0;
+    for (const auto& [from, to] : arcs) {
+      total_cost += model.GetArcCostForClass(from, to, cost_class);
+    }
+    benchmark::DoNotOptimize(total_cost);
+  }
+  state.SetItemsProcessed(state.iterations() * arcs.size());
+}
+BENCHMARK(BM_GetArcCostForClass)
+    ->ArgNames({"nodes", "table"})
+    ->ArgsProduct({{1 << 10, 1 << 12}, {kNoTable, kSparseTable, kDenseTable}});
+
+}  // namespace
+}  // namespace operations_research
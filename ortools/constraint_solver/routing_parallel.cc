@@ -0,0 +1,423 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/constraint_solver/routing_parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ortools/base/logging.h"
+#include "ortools/base/protoutil.h"
+#include "ortools/base/threadpool.h"
+#include "ortools/constraint_solver/constraint_solver.h"
+#include "ortools/constraint_solver/routing.h"
+#include "ortools/constraint_solver/routing_enums.pb.h"
+#include "ortools/constraint_solver/routing_index_manager.h"
+#include "ortools/constraint_solver/routing_parameters.pb.h"
+#include "ortools/util/optional_boolean.pb.h"
+
+namespace operations_research {
+
+RoutingSolutionPool::RoutingSolutionPool(int max_size) : max_size_(max_size) {
+  CHECK_GE(max_size, 1);
+}
+
+bool RoutingSolutionPool::Add(int64_t cost,
+                              std::vector<std::vector<int64_t>> routes) {
+  absl::MutexLock lock(&mutex_);
+  if (solutions_.size() == max_size_ && solutions_.back().cost <= cost) {
+    return false;
+  }
+  for (const Solution& solution : solutions_) {
+    if (solution.cost == cost && solution.routes == routes) return false;
+  }
+  const auto position = std::upper_bound(
+      solutions_.begin(), solutions_.end(), cost,
+      [](int64_t value, const Solution& solution) {
+        return value < solution.cost;
+      });
+  solutions_.insert(position, {cost, std::move(routes)});
+  if (solutions_.size() > max_size_) solutions_.pop_back();
+  return true;
+}
+
+std::optional<RoutingSolutionPool::Solution> RoutingSolutionPool::Get(
+    int rank) const {
+  absl::MutexLock lock(&mutex_);
+  if (solutions_.empty()) return std::nullopt;
+  return solutions_[rank % solutions_.size()];
+}
+
+int RoutingSolutionPool::size() const {
+  absl::MutexLock lock(&mutex_);
+  return solutions_.size();
+}
+
+namespace {
+
+constexpr LocalSearchMetaheuristic::Value kWorkerMetaheuristics[] = {
+    LocalSearchMetaheuristic::GUIDED_LOCAL_SEARCH,
+    LocalSearchMetaheuristic::TABU_SEARCH,
+    LocalSearchMetaheuristic::SIMULATED_ANNEALING,
+};
+
+constexpr FirstSolutionStrategy::Value kWorkerFirstSolutionStrategies[] = {
+    FirstSolutionStrategy::PATH_CHEAPEST_ARC,
+    FirstSolutionStrategy::PARALLEL_CHEAPEST_INSERTION,
+    FirstSolutionStrategy::LOCAL_CHEAPEST_INSERTION,
+    FirstSolutionStrategy::SAVINGS,
+    FirstSolutionStrategy::GLOBAL_CHEAPEST_ARC,
+};
+
+// Returns the parameters of the given worker. Worker 0 keeps the user's
+// choices. The others cycle through the metaheuristics, then through the first
+// solution strategies, and every other worker adds the neighborhoods which are
+// off by default and picks its operators with a multi-armed bandit.
+RoutingSearchParameters WorkerParameters(
+    const RoutingSearchParameters& parameters, int worker) {
+  RoutingSearchParameters worker_parameters = parameters;
+  const std::string& log_tag = parameters.log_tag();
+  worker_parameters.set_log_tag(absl::StrCat(
+      log_tag, log_tag.empty() ? "" : " ", "worker ", worker));
+  // The secondary local search is a cleanup meant to run once at the end of
+  // the solve, not at the end of each search of a worker.
+  worker_parameters.set_secondary_ls_time_limit_ratio(0);
+  if (worker == 0) return worker_parameters;
+  const int index = worker - 1;
+  constexpr int kNumMetaheuristics = std::size(kWorkerMetaheuristics);
+  constexpr int kNumFirstSolutionStrategies =
+      std::size(kWorkerFirstSolutionStrategies);
+  worker_parameters.set_local_search_metaheuristic(
+      kWorkerMetaheuristics[index % kNumMetaheuristics]);
+  worker_parameters.set_first_solution_strategy(
+      kWorkerFirstSolutionStrategies[(index / kNumMetaheuristics) %
+                                     kNumFirstSolutionStrategies]);
+  if (index % 2 == 1) {
+    RoutingSearchParameters::LocalSearchNeighborhoodOperators* const
+        operators = worker_parameters.mutable_local_search_operators();
+    operators->set_use_relocate_neighbors(BOOL_TRUE);
+    operators->set_use_cross_exchange(BOOL_TRUE);
+    operators->set_use_extended_swap_active(BOOL_TRUE);
+    operators->set_use_relocate_and_make_active(BOOL_TRUE);
+    operators->set_use_global_cheapest_insertion_expensive_chain_lns(BOOL_TRUE);
+    operators->set_use_local_cheapest_insertion_close_nodes_lns(BOOL_TRUE);
+    worker_parameters.set_use_multi_armed_bandit_concatenate_operators(true);
+  }
+  return worker_parameters;
+}
+
+// Returns true if the metaheuristic stops by itself at the first local optimum,
+// in which case restarting it from the same solution is useless.
+bool StopsAtLocalOptimum(const RoutingSearchParameters& parameters) {
+  switch (parameters.local_search_metaheuristic()) {
+    case LocalSearchMetaheuristic::GUIDED_LOCAL_SEARCH:
+    case LocalSearchMetaheuristic::SIMULATED_ANNEALING:
+    case LocalSearchMetaheuristic::TABU_SEARCH:
+    case LocalSearchMetaheuristic::GENERIC_TABU_SEARCH:
+      return false;
+    default:
+      return true;
+  }
+}
+
+absl::Duration GetTimeLimit(const RoutingSearchParameters& parameters) {
+  if (!parameters.has_time_limit()) return absl::InfiniteDuration();
+  return util_time::DecodeGoogleApiProto(parameters.time_limit()).value();
+}
+
+bool IsFinalStatus(RoutingModel::Status status) {
+  return status == RoutingModel::ROUTING_INFEASIBLE ||
+         status == RoutingModel::ROUTING_INVALID;
+}
+
+}  // namespace
+
+struct ParallelRoutingSolver::Worker {
+  // Runs a search from `start`, or from scratch if it is nullopt or isn't a
+  // valid solution of `model`. `time_limit` and `solution_limit` are multiplied
+  // by `limit_multiplier`, the time limit is capped at `time_left`, and the
+  // solution limit at the one of `parameters`.
+  void Search(const std::optional<RoutingSolutionPool::Solution>& start,
+              absl::Duration time_limit, absl::Duration time_left,
+              int64_t solution_limit) {
+    RoutingSearchParameters search_parameters = parameters;
+    const absl::Duration scaled_time_limit =
+        std::min(time_limit * limit_multiplier, time_left);
+    if (scaled_time_limit == absl::InfiniteDuration()) {
+      search_parameters.clear_time_limit();
+    } else {
+      *search_parameters.mutable_time_limit() =
+          util_time::EncodeGoogleApiProto(scaled_time_limit).value();
+    }
+    search_parameters.set_solution_limit(std::min(
+        parameters.solution_limit(),
+        solution_limit > std::numeric_limits<int64_t>::max() / limit_multiplier
+            ? std::numeric_limits<int64_t>::max()
+            : solution_limit * limit_multiplier));
+    const Assignment* first_solution = nullptr;
+    std::optional<int64_t> start_cost;
+    // RoutesToAssignment() needs a closed model.
+    if (start.has_value() && model_closed) {
+      if (initial_solution == nullptr) {
+        initial_solution = model->solver()->MakeAssignment();
+      }
+      if (model->RoutesToAssignment(start->routes,
+                                    /*ignore_inactive_indices=*/false,
+                                    /*close_routes=*/true, initial_solution)) {
+        first_solution = initial_solution;
+        start_cost = start->cost;
+      }
+    }
+    const Assignment* const solution = model->SolveFromAssignmentWithParameters(
+        first_solution, search_parameters);
+    model_closed = true;
+    status = model->status();
+    last_solution.reset();
+    improved = false;
+    if (solution == nullptr) return;
+    local_optimum_reached |= status == RoutingModel::ROUTING_SUCCESS ||
+                             status == RoutingModel::ROUTING_OPTIMAL;
+    last_solution.emplace();
+    last_solution->cost = solution->ObjectiveValue();
+    model->AssignmentToRoutes(*solution, &last_solution->routes);
+    improved = !start_cost.has_value() || last_solution->cost < *start_cost;
+  }
+
+  // Updates the state of the worker after a synchronization, in which it
+  // took `next_start` from the pool. Returns false if the worker should stop.
+  bool Continue(const std::optional<RoutingSolutionPool::Solution>& next_start,
+                bool has_time_limit) {
+    if (IsFinalStatus(status)) return false;
+    if (improved) {
+      limit_multiplier = 1;
+      return true;
+    }
+    if (!has_time_limit) return false;
+    const bool same_start = next_start.has_value() &&
+                            last_solution.has_value() &&
+                            next_start->cost >= last_solution->cost;
+    if (same_start && StopsAtLocalOptimum(parameters)) return false;
+    // Gives more time to a metaheuristic which didn't improve its solution.
+    if (limit_multiplier < kMaxLimitMultiplier) limit_multiplier *= 2;
+    return true;
+  }
+
+  static constexpr int64_t kMaxLimitMultiplier = 1024;
+
+  std::unique_ptr<RoutingModel> model;
+  RoutingSearchParameters parameters;
+  bool model_closed = false;
+  // Owned by the solver of `model`.
+  Assignment* initial_solution = nullptr;
+  int64_t limit_multiplier = 1;
+  // The result of the last search.
+  RoutingModel::Status status = RoutingModel::ROUTING_NOT_SOLVED;
+  std::optional<RoutingSolutionPool::Solution> last_solution;
+  // Whether the last search found a solution better than the one it started
+  // from.
+  bool improved = false;
+  // Whether a search of the worker reached a local optimum.
+  bool local_optimum_reached = false;
+};
+
+ParallelRoutingSolver::ParallelRoutingSolver(
+    const RoutingIndexManager& index_manager,
+    std::function<void(RoutingModel*)> build_model,
+    const RoutingModelParameters& model_parameters)
+    : index_manager_(index_manager),
+      build_model_(std::move(build_model)),
+      model_parameters_(model_parameters) {
+  AddWorker();
+}
+
+ParallelRoutingSolver::~ParallelRoutingSolver() = default;
+
+RoutingModel* ParallelRoutingSolver::model() const {
+  return workers_[0]->model.get();
+}
+
+void ParallelRoutingSolver::AddWorker() {
+  auto worker = std::make_unique<Worker>();
+  worker->model =
+      std::make_unique<RoutingModel>(index_manager_, model_parameters_);
+  build_model_(worker->model.get());
+  workers_.push_back(std::move(worker));
+}
+
+const Assignment* ParallelRoutingSolver::SolveWithParameters(
+    const RoutingSearchParameters& parameters) {
+  const RoutingSearchParameters::ParallelSearchParameters& parallel =
+      parameters.parallel_search_parameters();
+  num_synchronizations_ = 0;
+  if (parallel.num_workers() <= 1) {
+    const Assignment* const solution = model()->SolveWithParameters(parameters);
+    status_ = model()->status();
+    return solution;
+  }
+  const std::string error = FindErrorInRoutingSearchParameters(parameters);
+  if (!error.empty()) {
+    LOG(ERROR) << "Invalid RoutingSearchParameters: " << error;
+    status_ = RoutingModel::ROUTING_INVALID;
+    return nullptr;
+  }
+  while (workers_.size() < parallel.num_workers()) AddWorker();
+  for (int w = 0; w < parallel.num_workers(); ++w) {
+    Worker& worker = *workers_[w];
+    worker.parameters = WorkerParameters(parameters, w);
+    worker.limit_multiplier = 1;
+    worker.status = RoutingModel::ROUTING_NOT_SOLVED;
+    worker.last_solution.reset();
+    worker.local_optimum_reached = false;
+  }
+
+  RoutingSolutionPool pool(parallel.solution_pool_size());
+  if (parallel.deterministic()) {
+    SolveDeterministically(parameters, pool);
+  } else {
+    SolveNonDeterministically(parameters, pool);
+  }
+  if (pool.size() == 0) {
+    status_ = workers_[0]->status;
+    return nullptr;
+  }
+  return RestoreBestSolution(pool, parallel.num_workers());
+}
+
+const Assignment* ParallelRoutingSolver::RestoreBestSolution(
+    const RoutingSolutionPool& pool, int num_workers) {
+  bool local_optimum_reached = false;
+  for (int w = 0; w < num_workers; ++w) {
+    local_optimum_reached |= workers_[w]->local_optimum_reached;
+  }
+  // The time limit of the last search may have run out.
+  model()->UpdateTimeLimit(absl::InfiniteDuration());
+  const Assignment* const solution = model()->ReadAssignmentFromRoutes(
+      pool.Get(0)->routes, /*ignore_inactive_indices=*/false);
+  if (solution == nullptr) {
+    status_ = RoutingModel::ROUTING_FAIL;
+    return nullptr;
+  }
+  status_ =
+      local_optimum_reached
+          ? RoutingModel::ROUTING_SUCCESS
+          : RoutingModel::ROUTING_PARTIAL_SUCCESS_LOCAL_OPTIMUM_NOT_REACHED;
+  return solution;
+}
+
+void ParallelRoutingSolver::SolveDeterministically(
+    const RoutingSearchParameters& parameters, RoutingSolutionPool& pool) {
+  const RoutingSearchParameters::ParallelSearchParameters& parallel =
+      parameters.parallel_search_parameters();
+  const int num_workers = parallel.num_workers();
+  const absl::Duration time_limit = GetTimeLimit(parameters);
+  const bool has_time_limit = time_limit != absl::InfiniteDuration();
+  const absl::Time deadline = absl::Now() + time_limit;
+  ThreadPool thread_pool("ParallelRoutingSolver", num_workers);
+  thread_pool.StartWorkers();
+  std::vector<bool> active(num_workers, true);
+  std::vector<std::optional<RoutingSolutionPool::Solution>> starts(
+      num_workers);
+  while (true) {
+    const absl::Duration time_left = deadline - absl::Now();
+    if (time_left <= absl::ZeroDuration()) break;
+    const int num_active = std::count(active.begin(), active.end(), true);
+    if (num_active == 0) break;
+    absl::BlockingCounter searches(num_active);
+    for (int w = 0; w < num_workers; ++w) {
+      if (!active[w]) continue;
+      thread_pool.Schedule([this, w, &starts, &searches, &parallel,
+                            time_left]() {
+        workers_[w]->Search(starts[w], absl::InfiniteDuration(), time_left,
+                            parallel.solutions_per_synchronization());
+        searches.DecrementCount();
+      });
+    }
+    searches.Wait();
+    // The solutions are added in the order of the workers, so that the pool
+    // doesn't depend on the order in which the searches finished.
+    bool improved = false;
+    for (int w = 0; w < num_workers; ++w) {
+      if (!active[w]) continue;
+      const Worker& worker = *workers_[w];
+      if (worker.last_solution.has_value()) {
+        pool.Add(worker.last_solution->cost, worker.last_solution->routes);
+      }
+      improved |= worker.improved;
+      ++num_synchronizations_;
+    }
+    if (!has_time_limit && !improved) break;
+    for (int w = 0; w < num_workers; ++w) {
+      if (!active[w]) continue;
+      starts[w] = pool.Get(w);
+      active[w] = workers_[w]->Continue(starts[w], /*has_time_limit=*/true);
+    }
+  }
+}
+
+void ParallelRoutingSolver::SolveNonDeterministically(
+    const RoutingSearchParameters& parameters, RoutingSolutionPool& pool) {
+  const RoutingSearchParameters::ParallelSearchParameters& parallel =
+      parameters.parallel_search_parameters();
+  const int num_workers = parallel.num_workers();
+  const absl::Duration time_limit = GetTimeLimit(parameters);
+  const bool has_time_limit = time_limit != absl::InfiniteDuration();
+  const absl::Time deadline = absl::Now() + time_limit;
+  const absl::Duration period =
+      util_time::DecodeGoogleApiProto(parallel.synchronization_period())
+          .value();
+  std::atomic<int64_t> num_synchronizations = 0;
+  const auto run_worker = [&](int w) {
+    Worker& worker = *workers_[w];
+    std::optional<RoutingSolutionPool::Solution> start;
+    while (true) {
+      const absl::Duration time_left = deadline - absl::Now();
+      if (time_left <= absl::ZeroDuration()) break;
+      // Searches without a starting solution aren't limited by the period, so
+      // that slow first solution heuristics are not interrupted.
+      worker.Search(start,
+                    start.has_value() ? period : absl::InfiniteDuration(),
+                    time_left, parallel.solutions_per_synchronization());
+      if (worker.last_solution.has_value()) {
+        pool.Add(worker.last_solution->cost, worker.last_solution->routes);
+      }
+      ++num_synchronizations;
+      start = pool.Get(w);
+      if (!worker.Continue(start, has_time_limit)) break;
+    }
+  };
+  {
+    ThreadPool thread_pool("ParallelRoutingSolver", num_workers);
+    thread_pool.StartWorkers();
+    for (int w = 0; w < num_workers; ++w) {
+      thread_pool.Schedule([&run_worker, w]() { run_worker(w); });
+    }
+  }  // Waits for the workers.
+  num_synchronizations_ = num_synchronizations;
+}
+
+}  // namespace operations_research
@@ -0,0 +1,153 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Parallel local search for vehicle routing problems.
+//
+// A RoutingModel and its solver are not thread-safe, and a model cannot be
+// copied, so the parallel search builds one model per worker with a callback
+// provided by the user. Each worker runs its own local search, with different
+// metaheuristics, first solution strategies and operators, and the workers
+// exchange their best solutions through a shared pool, as routes, at regular
+// synchronization points:
+//
+//   RoutingIndexManager manager(num_nodes, num_vehicles, depot);
+//   ParallelRoutingSolver solver(manager, [&](RoutingModel* model) {
+//     const int transit = model->RegisterTransitCallback(...);
+//     model->SetArcCostEvaluatorOfAllVehicles(transit);
+//     ...
+//   });
+//   RoutingSearchParameters parameters = DefaultRoutingSearchParameters();
+//   parameters.mutable_time_limit()->set_seconds(600);
+//   parameters.mutable_parallel_search_parameters()->set_num_workers(64);
+//   const Assignment* solution = solver.SolveWithParameters(parameters);
+//   // solution is a solution of solver.model().
+
+#ifndef OR_TOOLS_CONSTRAINT_SOLVER_ROUTING_PARALLEL_H_
+#define OR_TOOLS_CONSTRAINT_SOLVER_ROUTING_PARALLEL_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "ortools/constraint_solver/constraint_solver.h"
+#include "ortools/constraint_solver/routing.h"
+#include "ortools/constraint_solver/routing_index_manager.h"
+#include "ortools/constraint_solver/routing_parameters.h"
+#include "ortools/constraint_solver/routing_parameters.pb.h"
+
+namespace operations_research {
+
+// A thread-safe pool of the best distinct solutions of a routing model, stored
+// as routes (see RoutingModel::AssignmentToRoutes()) so that they can be
+// shared between models built identically.
+class RoutingSolutionPool {
+ public:
+  struct Solution {
+    int64_t cost;
+    std::vector<std::vector<int64_t>> routes;
+  };
+
+  explicit RoutingSolutionPool(int max_size);
+
+  // Adds a solution to the pool. Returns false if the pool already contains
+  // it, or if the pool is full and all its solutions are at least as good.
+  bool Add(int64_t cost, std::vector<std::vector<int64_t>> routes);
+  // Returns the (rank mod size())-th best solution, or nullopt if the pool is
+  // empty. Solutions of equal cost are ranked in their order of addition.
+  std::optional<Solution> Get(int rank) const;
+  int size() const;
+
+ private:
+  const int max_size_;
+  mutable absl::Mutex mutex_;
+  // Sorted by increasing cost.
+  std::vector<Solution> solutions_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Runs several local searches in parallel on copies of a routing model, as
+// set in RoutingSearchParameters.parallel_search_parameters.
+class ParallelRoutingSolver {
+ public:
+  // `build_model` adds the dimensions, costs and constraints of the problem to
+  // an empty model created from `index_manager`. It is called once per worker,
+  // on the calling thread, and must build the same model each time. The
+  // callbacks registered by `build_model` are called concurrently from the
+  // worker threads. `index_manager` must outlive the solver.
+  ParallelRoutingSolver(const RoutingIndexManager& index_manager,
+                        std::function<void(RoutingModel*)> build_model,
+                        const RoutingModelParameters& model_parameters =
+                            DefaultRoutingModelParameters());
+
+  // This type is neither copyable nor movable.
+  ParallelRoutingSolver(const ParallelRoutingSolver&) = delete;
+  ParallelRoutingSolver& operator=(const ParallelRoutingSolver&) = delete;
+
+  ~ParallelRoutingSolver();
+
+  // The model of the first worker, in which solutions are returned.
+  RoutingModel* model() const;
+
+  // Solves the model and returns the best solution found, as an assignment of
+  // model() owned by its solver, or nullptr if none was found. With a single
+  // worker, this is model()->SolveWithParameters(parameters).
+  //
+  // With several workers, the first one uses `parameters`, and the others
+  // diversify them (see parallel_search_parameters.num_workers). Each worker
+  // alternates searches, which are limited by the synchronization parameters,
+  // the time left and parameters.solution_limit, with synchronizations, in
+  // which it adds its best solution to the pool and takes the solution it
+  // restarts from. The first searches start from scratch with the first
+  // solution strategy of the worker, and are not limited by
+  // synchronization_period so that slow first solution heuristics are not
+  // interrupted. A worker whose search doesn't improve its starting solution
+  // gets twice the limits for its next search, or stops if its metaheuristic
+  // stops at the first local optimum and the pool has nothing better for it.
+  // The solve stops at the time limit. If there is none, the deterministic
+  // solve stops after a synchronization in which no worker improved its
+  // starting solution, and in the non-deterministic solve each worker stops
+  // after such a search.
+  const Assignment* SolveWithParameters(
+      const RoutingSearchParameters& parameters);
+
+  // Status of the last solve, with the same meaning as RoutingModel::status().
+  RoutingModel::Status status() const { return status_; }
+  // Number of synchronizations with the pool in the last solve, summed over
+  // the workers.
+  int64_t num_synchronizations() const { return num_synchronizations_; }
+
+ private:
+  struct Worker;
+
+  void AddWorker();
+  const Assignment* RestoreBestSolution(const RoutingSolutionPool& pool,
+                                        int num_workers);
+  void SolveDeterministically(const RoutingSearchParameters& parameters,
+                              RoutingSolutionPool& pool);
+  void SolveNonDeterministically(const RoutingSearchParameters& parameters,
+                                 RoutingSolutionPool& pool);
+
+  const RoutingIndexManager& index_manager_;
+  const std::function<void(RoutingModel*)> build_model_;
+  const RoutingModelParameters model_parameters_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  RoutingModel::Status status_ = RoutingModel::ROUTING_NOT_SOLVED;
+  int64_t num_synchronizations_ = 0;
+};
+
+}  // namespace operations_research
+
+#endif  // OR_TOOLS_CONSTRAINT_SOLVER_ROUTING_PARALLEL_H_
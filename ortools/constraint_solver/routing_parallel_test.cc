@@ -0,0 +1,173 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/constraint_solver/routing_parallel.h"
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ortools/constraint_solver/constraint_solver.h"
+#include "ortools/constraint_solver/routing.h"
+#include "ortools/constraint_solver/routing_enums.pb.h"
+#include "ortools/constraint_solver/routing_index_manager.h"
+#include "ortools/constraint_solver/routing_parameters.h"
+#include "ortools/constraint_solver/routing_parameters.pb.h"
+
+namespace operations_research {
+namespace {
+
+using Routes = std::vector<std::vector<int64_t>>;
+
+TEST(RoutingSolutionPoolTest, EmptyPool) {
+  const RoutingSolutionPool pool(/*max_size=*/2);
+  EXPECT_EQ(pool.size(), 0);
+  EXPECT_FALSE(pool.Get(0).has_value());
+}
+
+TEST(RoutingSolutionPoolTest, SortsByCostThenByAddition) {
+  RoutingSolutionPool pool(/*max_size=*/4);
+  EXPECT_TRUE(pool.Add(5, Routes{{1, 2}}));
+  EXPECT_TRUE(pool.Add(3, Routes{{2, 1}}));
+  EXPECT_TRUE(pool.Add(5, Routes{{1}, {2}}));
+  EXPECT_TRUE(pool.Add(4, Routes{{2}, {1}}));
+  ASSERT_EQ(pool.size(), 4);
+  EXPECT_EQ(pool.Get(0)->cost, 3);
+  EXPECT_EQ(pool.Get(1)->cost, 4);
+  EXPECT_EQ(pool.Get(2)->routes, (Routes{{1, 2}}));
+  EXPECT_EQ(pool.Get(3)->routes, (Routes{{1}, {2}}));
+  // Ranks wrap around the size of the pool.
+  EXPECT_EQ(pool.Get(5)->cost, 4);
+}
+
+TEST(RoutingSolutionPoolTest, SkipsDuplicates) {
+  RoutingSolutionPool pool(/*max_size=*/4);
+  EXPECT_TRUE(pool.Add(5, Routes{{1, 2}}));
+  EXPECT_FALSE(pool.Add(5, Routes{{1, 2}}));
+  // The same routes with another cost are a different solution, e.g. of a
+  // model with other costs.
+  EXPECT_TRUE(pool.Add(6, Routes{{1, 2}}));
+  EXPECT_EQ(pool.size(), 2);
+}
+
+TEST(RoutingSolutionPoolTest, KeepsTheBestSolutionsWhenFull) {
+  RoutingSolutionPool pool(/*max_size=*/2);
+  EXPECT_TRUE(pool.Add(5, Routes{{1, 2}}));
+  EXPECT_TRUE(pool.Add(7, Routes{{2, 1}}));
+  EXPECT_FALSE(pool.Add(8, Routes{{1}, {2}}));
+  // Ties with the worst solution don't replace it.
+  EXPECT_FALSE(pool.Add(7, Routes{{1}, {2}}));
+  EXPECT_TRUE(pool.Add(6, Routes{{2}, {1}}));
+  ASSERT_EQ(pool.size(), 2);
+  EXPECT_EQ(pool.Get(0)->cost, 5);
+  EXPECT_EQ(pool.Get(1)->cost, 6);
+}
+
+// A capacitated vehicle routing problem on random points, in which each
+// vehicle visits at most kCapacity nodes.
+class ParallelRoutingSolverTest : public testing::Test {
+ protected:
+  static constexpr int kNumNodes = 30;
+  static constexpr int kNumVehicles = 4;
+  static constexpr int64_t kCapacity = 9;
+
+  ParallelRoutingSolverTest()
+      : manager_(kNumNodes, kNumVehicles, RoutingIndexManager::NodeIndex(0)) {
+    std::mt19937 random(12345);
+    std::uniform_int_distribution<int> coordinate(0, 1000);
+    for (int node = 0; node < kNumNodes; ++node) {
+      positions_.emplace_back(coordinate(random), coordinate(random));
+    }
+  }
+
+  void BuildModel(RoutingModel* model) const {
+    const int transit = model->RegisterTransitCallback(
+        [this](int64_t from_index, int64_t to_index) {
+          const auto& [from_x, from_y] =
+              positions_[manager_.IndexToNode(from_index).value()];
+          const auto& [to_x, to_y] =
+              positions_[manager_.IndexToNode(to_index).value()];
+          return static_cast<int64_t>(
+              std::hypot(from_x - to_x, from_y - to_y));
+        });
+    model->SetArcCostEvaluatorOfAllVehicles(transit);
+    model->AddConstantDimension(1, kCapacity, /*fix_start_cumul_to_zero=*/true,
+                                "Count");
+  }
+
+  RoutingSearchParameters DeterministicParameters() const {
+    RoutingSearchParameters parameters = DefaultRoutingSearchParameters();
+    parameters.set_first_solution_strategy(
+        FirstSolutionStrategy::PATH_CHEAPEST_ARC);
+    // Bounds the searches of the workers, whose solution limit doubles each
+    // time they don't improve their solution.
+    parameters.set_solution_limit(100);
+    RoutingSearchParameters::ParallelSearchParameters* const parallel =
+        parameters.mutable_parallel_search_parameters();
+    parallel->set_num_workers(2);
+    parallel->set_deterministic(true);
+    parallel->set_solutions_per_synchronization(20);
+    return parameters;
+  }
+
+  RoutingIndexManager manager_;
+  std::vector<std::pair<int, int>> positions_;
+};
+
+TEST_F(ParallelRoutingSolverTest, DeterministicSolvesAreIdentical) {
+  const RoutingSearchParameters parameters = DeterministicParameters();
+  std::optional<int64_t> first_cost;
+  Routes first_routes;
+  int64_t first_num_synchronizations = 0;
+  for (int run = 0; run < 2; ++run) {
+    ParallelRoutingSolver solver(
+        manager_, [this](RoutingModel* model) { BuildModel(model); });
+    const Assignment* const solution = solver.SolveWithParameters(parameters);
+    ASSERT_NE(solution, nullptr);
+    EXPECT_EQ(solver.status(), RoutingModel::ROUTING_SUCCESS);
+    Routes routes;
+    solver.model()->AssignmentToRoutes(*solution, &routes);
+    if (!first_cost.has_value()) {
+      first_cost = solution->ObjectiveValue();
+      first_routes = routes;
+      first_num_synchronizations = solver.num_synchronizations();
+      continue;
+    }
+    EXPECT_EQ(solution->ObjectiveValue(), *first_cost);
+    EXPECT_EQ(routes, first_routes);
+    EXPECT_EQ(solver.num_synchronizations(), first_num_synchronizations);
+  }
+  EXPECT_GT(first_num_synchronizations, parameters.parallel_search_parameters()
+                                            .num_workers());
+}
+
+// With a limit of one solution, each search stops at its first solution, so
+// no worker improves the solution it restarts from.
+TEST_F(ParallelRoutingSolverTest, HonorsTheSolutionLimit) {
+  RoutingSearchParameters parameters = DeterministicParameters();
+  parameters.set_solution_limit(1);
+  ParallelRoutingSolver solver(
+      manager_, [this](RoutingModel* model) { BuildModel(model); });
+  ASSERT_NE(solver.SolveWithParameters(parameters), nullptr);
+  // One synchronization for the first solutions, and one in which no worker
+  // improved its starting solution.
+  EXPECT_EQ(solver.num_synchronizations(),
+            2 * parameters.parallel_search_parameters().num_workers());
+}
+
+}  // namespace
+}  // namespace operations_research
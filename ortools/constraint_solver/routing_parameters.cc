@@ -46,6 +46,7 @@ RoutingModelParameters DefaultRoutingModelParameters() {
       ConstraintSolverParameters::COMPRESS_WITH_ZLIB);
   solver_parameters->set_skip_locally_optimal_paths(true);
   parameters.set_reduce_vehicle_cost_model(true);
+  parameters.set_num_arc_cost_table_threads(1);
   return parameters;
 }
 
@@ -137,6 +138,13 @@ RoutingSearchParameters CreateDefaultRoutingSearchParameters() {
   p.set_solution_limit(kint64max);
   p.mutable_lns_time_limit()->set_nanos(100000000);  // 0.1s.
   p.set_secondary_ls_time_limit_ratio(0);
+  RoutingSearchParameters::ParallelSearchParameters* const parallel =
+      p.mutable_parallel_search_parameters();
+  parallel->set_num_workers(1);
+  parallel->set_deterministic(false);
+  parallel->mutable_synchronization_period()->set_seconds(1);
+  parallel->set_solutions_per_synchronization(1000);
+  parallel->set_solution_pool_size(4);
   p.set_use_full_propagation(false);
   p.set_log_search(false);
   p.set_log_cost_scaling_factor(1.0);
@@ -388,6 +396,38 @@ std::vector<std::string> FindErrorsInRoutingSearchParameters(
     }
   }
 
+  if (search_parameters.has_parallel_search_parameters()) {
+    const RoutingSearchParameters::ParallelSearchParameters& parallel =
+        search_parameters.parallel_search_parameters();
+    if (parallel.num_workers() < 0) {
+      errors.emplace_back(StrCat(
+          "Invalid parallel_search_parameters.num_workers: ",
+          parallel.num_workers()));
+    }
+    if (parallel.num_workers() > 1) {
+      if (parallel.solutions_per_synchronization() < 1) {
+        errors.emplace_back(StrCat(
+            "Invalid "
+            "parallel_search_parameters.solutions_per_synchronization: ",
+            parallel.solutions_per_synchronization()));
+      }
+      if (!parallel.deterministic()) {
+        const auto period =
+            util_time::DecodeGoogleApiProto(parallel.synchronization_period());
+        if (!period.ok() || period.value() <= absl::ZeroDuration()) {
+          errors.emplace_back(
+              "Invalid parallel_search_parameters.synchronization_period: " +
+              parallel.synchronization_period().ShortDebugString());
+        }
+      }
+      if (parallel.solution_pool_size() < 1) {
+        errors.emplace_back(StrCat(
+            "Invalid parallel_search_parameters.solution_pool_size: ",
+            parallel.solution_pool_size()));
+      }
+    }
+  }
+
   if (const double memory_coefficient =
           search_parameters
               .multi_armed_bandit_compound_operator_memory_coefficient();
@@ -0,0 +1,147 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/constraint_solver/routing.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ortools/constraint_solver/routing_index_manager.h"
+#include "ortools/constraint_solver/routing_parameters.h"
+#include "ortools/constraint_solver/routing_parameters.pb.h"
+
+namespace operations_research {
+namespace {
+
+// With 60 nodes and 2 vehicles starting and ending at node 0, the model has 61
+// rows of 63 arcs, so a dense table takes 15372 bytes in 32 bits and 30744
+// bytes in 64 bits, and a sparse table 732 bytes per neighbor of each node.
+constexpr int kNumNodes = 60;
+constexpr int kNumVehicles = 2;
+
+struct ArcCostTableTestCase {
+  // The costs are multiplied by this.
+  int64_t cost_scale;
+  int64_t max_arc_cost_table_memory_bytes;
+  int num_arc_cost_table_threads;
+};
+
+class ArcCostTableTest : public testing::TestWithParam<ArcCostTableTestCase> {
+ protected:
+  ArcCostTableTest()
+      : manager_(kNumNodes, kNumVehicles, RoutingIndexManager::NodeIndex(0)) {
+    std::mt19937 random(12345);
+    std::uniform_int_distribution<int> coordinate(0, 1000);
+    for (int node = 0; node < kNumNodes; ++node) {
+      positions_.emplace_back(coordinate(random), coordinate(random));
+    }
+  }
+
+  int64_t Distance(int64_t from_index, int64_t to_index) const {
+    const auto& [from_x, from_y] =
+        positions_[manager_.IndexToNode(from_index).value()];
+    const auto& [to_x, to_y] =
+        positions_[manager_.IndexToNode(to_index).value()];
+    return static_cast<int64_t>(std::hypot(from_x - to_x, from_y - to_y));
+  }
+
+  // Each vehicle has its own cost class, with a fixed cost. The second vehicle
+  // also pays for the span of a dimension, and is used when empty.
+  void BuildModel(int64_t cost_scale, RoutingModel* model) const {
+    for (int vehicle = 0; vehicle < kNumVehicles; ++vehicle) {
+      const int transit = model->RegisterTransitCallback(
+          [this, cost_scale, vehicle](int64_t from_index, int64_t to_index) {
+            return cost_scale * (vehicle + 1) * Distance(from_index, to_index);
+          });
+      model->SetArcCostEvaluatorOfVehicle(transit, vehicle);
+      model->SetFixedCostOfVehicle(1000 * (vehicle + 1), vehicle);
+    }
+    const int distance = model->RegisterTransitCallback(
+        [this](int64_t from_index, int64_t to_index) {
+          return Distance(from_index, to_index);
+        });
+    model->AddDimension(distance, 0, 1'000'000,
+                        /*fix_start_cumul_to_zero=*/true, "Distance");
+    model->GetMutableDimension("Distance")
+        ->SetSpanCostCoefficientForVehicle(3, 1);
+    model->SetVehicleUsedWhenEmpty(true, 1);
+    model->CloseModel();
+  }
+
+  // Checks that all arc costs of `model` are those of `expected_model`, which
+  // doesn't have arc cost tables.
+  void ExpectSameArcCosts(const RoutingModel& model,
+                          const RoutingModel& expected_model) const {
+    for (int vehicle = 0; vehicle < kNumVehicles; ++vehicle) {
+      for (int64_t from = 0; from < model.Size(); ++from) {
+        for (int64_t to = 0; to < model.Size() + kNumVehicles; ++to) {
+          ASSERT_EQ(model.GetArcCostForVehicle(from, to, vehicle),
+                    expected_model.GetArcCostForVehicle(from, to, vehicle))
+              << "from " << from << " to " << to << " vehicle " << vehicle;
+        }
+      }
+    }
+  }
+
+  RoutingIndexManager manager_;
+  std::vector<std::pair<int, int>> positions_;
+};
+
+TEST_P(ArcCostTableTest, MatchesCallbackCosts) {
+  const ArcCostTableTestCase& test_case = GetParam();
+  RoutingModel expected_model(manager_);
+  BuildModel(test_case.cost_scale, &expected_model);
+  RoutingModelParameters parameters = DefaultRoutingModelParameters();
+  parameters.set_max_arc_cost_table_memory_bytes(
+      test_case.max_arc_cost_table_memory_bytes);
+  parameters.set_num_arc_cost_table_threads(
+      test_case.num_arc_cost_table_threads);
+  RoutingModel model(manager_, parameters);
+  BuildModel(test_case.cost_scale, &model);
+
+  // The costs of the arcs from the start of a vehicle include its fixed cost,
+  // and the arc to its end costs nothing when it isn't used when empty.
+  const int64_t start = model.Start(0);
+  const int64_t node = manager_.NodeToIndex(RoutingIndexManager::NodeIndex(1));
+  EXPECT_EQ(model.GetArcCostForVehicle(start, node, 0),
+            1000 + test_case.cost_scale * Distance(start, node));
+  EXPECT_EQ(model.GetArcCostForVehicle(start, model.End(0), 0), 0);
+  ExpectSameArcCosts(model, expected_model);
+}
+
+constexpr int64_t kInt64Scale = int64_t{1} << 32;
+
+INSTANTIATE_TEST_SUITE_P(
+    ArcCostTables, ArcCostTableTest,
+    testing::Values(
+        // Dense int32 tables for both cost classes.
+        ArcCostTableTestCase{1, 2 * 15372, 1},
+        ArcCostTableTestCase{1, 2 * 15372, 4},
+        // Dense int64 tables for both cost classes.
+        ArcCostTableTestCase{kInt64Scale, 2 * 30744, 1},
+        ArcCostTableTestCase{kInt64Scale, 2 * 30744, 4},
+        // A sparse table with 27 neighbors for the first cost class, whose
+        // 64-bit costs don't fit in the dense int32 table tried first, and no
+        // table for the second one.
+        ArcCostTableTestCase{kInt64Scale, 20000, 1},
+        // A sparse table with 13 neighbors built from the costs of each row
+        // for the first cost class, and no table for the second one.
+        ArcCostTableTestCase{1, 10000, 1},
+        ArcCostTableTestCase{1, 10000, 4}));
+
+}  // namespace
+}  // namespace operations_research
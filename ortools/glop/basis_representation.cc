@@ -179,7 +179,8 @@ void EtaFactorization::RightSolve(DenseColumn* d) const {
 // BasisFactorization
 // --------------------------------------------------------
 BasisFactorization::BasisFactorization(
-    const CompactSparseMatrix* compact_matrix, const RowToColMapping* basis)
+    const CompactSparseMatrix* compact_matrix, const RowToColMapping* basis,
+    ShardedExecutor* sharded_executor)
     : stats_(),
       compact_matrix_(*compact_matrix),
       basis_(*basis),
@@ -190,6 +191,7 @@ BasisFactorization::BasisFactorization(
       lu_factorization_(),
       deterministic_time_(0.0) {
   SetParameters(parameters_);
+  lu_factorization_.SetShardedExecutor(sharded_executor);
 }
 
 BasisFactorization::~BasisFactorization() = default;
@@ -25,6 +25,7 @@
 #include "ortools/lp_data/lp_types.h"
 #include "ortools/lp_data/permutation.h"
 #include "ortools/lp_data/scattered_vector.h"
+#include "ortools/lp_data/sharded_executor.h"
 #include "ortools/lp_data/sparse.h"
 #include "ortools/util/stats.h"
 
@@ -159,8 +160,11 @@ class EtaFactorization {
 // thus they must outlive this class (and keep the same address in memory).
 class BasisFactorization {
  public:
+  // The sharded_executor can be nullptr, see
+  // LuFactorization::SetShardedExecutor().
   BasisFactorization(const CompactSparseMatrix* compact_matrix,
-                     const RowToColMapping* basis);
+                     const RowToColMapping* basis,
+                     ShardedExecutor* sharded_executor = nullptr);
 
   // This type is neither copyable nor movable.
   BasisFactorization(const BasisFactorization&) = delete;
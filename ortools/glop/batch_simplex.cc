@@ -0,0 +1,213 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/glop/batch_simplex.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "ortools/base/logging.h"
+#include "ortools/base/threadpool.h"
+#include "ortools/glop/parameters.pb.h"
+#include "ortools/glop/revised_simplex.h"
+#include "ortools/glop/status.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/util/time_limit.h"
+
+namespace operations_research {
+namespace glop {
+
+namespace {
+
+bool IsValidVariant(const LinearProgram& lp,
+                    const LinearProgramVariant& variant) {
+  const auto has_valid_size = [](const auto& values, auto size) {
+    return values.empty() || values.size() == size;
+  };
+  const ColIndex num_cols = lp.num_variables();
+  const RowIndex num_rows = lp.num_constraints();
+  return has_valid_size(variant.objective_coefficients, num_cols) &&
+         has_valid_size(variant.variable_lower_bounds, num_cols) &&
+         has_valid_size(variant.variable_upper_bounds, num_cols) &&
+         has_valid_size(variant.constraint_lower_bounds, num_rows) &&
+         has_valid_size(variant.constraint_upper_bounds, num_rows);
+}
+
+// Sets the objective and the bounds of lp to the ones of the variant, or to
+// the ones of base if they are not given. The matrix of lp is not modified.
+void ApplyVariant(const LinearProgram& base,
+                  const LinearProgramVariant& variant, LinearProgram* lp) {
+  const auto pick = [](const auto& variant_values, const auto& base_values)
+      -> const auto& {
+    return variant_values.empty() ? base_values : variant_values;
+  };
+  const DenseRow& objective = pick(variant.objective_coefficients,
+                                   base.objective_coefficients());
+  const DenseRow& variable_lower_bounds =
+      pick(variant.variable_lower_bounds, base.variable_lower_bounds());
+  const DenseRow& variable_upper_bounds =
+      pick(variant.variable_upper_bounds, base.variable_upper_bounds());
+  for (ColIndex col(0); col < base.num_variables(); ++col) {
+    lp->SetObjectiveCoefficient(col, objective[col]);
+    lp->SetVariableBounds(col, variable_lower_bounds[col],
+                          variable_upper_bounds[col]);
+  }
+  *lp->mutable_constraint_lower_bounds() =
+      pick(variant.constraint_lower_bounds, base.constraint_lower_bounds());
+  *lp->mutable_constraint_upper_bounds() =
+      pick(variant.constraint_upper_bounds, base.constraint_upper_bounds());
+}
+
+// Sets lp to a problem with the dimensions and objective parameters of base but
+// without its coefficients, which is all that a RevisedSimplex sharing the
+// matrix of base reads. The only exception is a problem in equation form, since
+// it is detected with the identity part of its matrix.
+void PopulateWithoutMatrix(const LinearProgram& base, LinearProgram* lp) {
+  if (base.IsInEquationForm()) {
+    lp->PopulateFromLinearProgram(base);
+    return;
+  }
+  lp->Clear();
+  lp->SetMaximizationProblem(base.IsMaximizationProblem());
+  lp->SetObjectiveOffset(base.objective_offset());
+  lp->SetObjectiveScalingFactor(base.objective_scaling_factor());
+  for (ColIndex col(0); col < base.num_variables(); ++col) {
+    lp->CreateNewVariable();
+  }
+  for (RowIndex row(0); row < base.num_constraints(); ++row) {
+    lp->CreateNewConstraint();
+  }
+}
+
+// Copies the solution of the simplex, without the slacks it may have added.
+void ExtractSolution(const RevisedSimplex& simplex,
+                     ProblemSolution* solution) {
+  solution->status = simplex.GetProblemStatus();
+  for (ColIndex col(0); col < solution->primal_values.size(); ++col) {
+    solution->primal_values[col] = simplex.GetVariableValue(col);
+    solution->variable_statuses[col] = simplex.GetVariableStatus(col);
+  }
+  for (RowIndex row(0); row < solution->dual_values.size(); ++row) {
+    solution->dual_values[row] = simplex.GetDualValue(row);
+    solution->constraint_statuses[row] = simplex.GetConstraintStatus(row);
+  }
+}
+
+}  // namespace
+
+ProblemStatus BatchRevisedSimplex::Solve(
+    const LinearProgram& lp, absl::Span<const LinearProgramVariant> variants,
+    TimeLimit* time_limit) {
+  const int num_variants = variants.size();
+  solutions_.assign(num_variants, ProblemSolution(lp.num_constraints(),
+                                                  lp.num_variables()));
+  for (ProblemSolution& solution : solutions_) {
+    solution.status = ProblemStatus::INIT;
+  }
+  objective_values_.assign(num_variants, 0.0);
+  num_iterations_.assign(num_variants, 0);
+  total_num_iterations_ = 0;
+  deterministic_time_ = 0.0;
+
+  const int num_workers =
+      std::max(1, std::min(parameters_.num_omp_threads(), num_variants));
+  GlopParameters parameters = parameters_;
+  parameters.set_allow_simplex_algorithm_change(true);
+  if (num_workers > 1) parameters.set_num_omp_threads(1);
+
+  // The base problem is solved first. Its simplex then only owns the matrix,
+  // which is shared by the simplexes of all the workers.
+  RevisedSimplex base_simplex;
+  base_simplex.SetParameters(parameters);
+  if (!base_simplex.Solve(lp, time_limit).ok()) {
+    return ProblemStatus::ABNORMAL;
+  }
+  const ProblemStatus base_status = base_simplex.GetProblemStatus();
+  total_num_iterations_ = base_simplex.GetNumberOfIterations();
+  deterministic_time_ = base_simplex.DeterministicTime();
+  const BasisState base_state = base_simplex.GetState();
+
+  std::vector<int64_t> worker_iterations(num_workers, 0);
+  std::vector<double> worker_deterministic_times(num_workers, 0.0);
+  SharedTimeLimit shared_time_limit(time_limit);
+  const auto solve_range = [&](int worker) {
+    const int begin = static_cast<int64_t>(num_variants) * worker / num_workers;
+    const int end =
+        static_cast<int64_t>(num_variants) * (worker + 1) / num_workers;
+    RevisedSimplex simplex(&base_simplex);
+    simplex.SetParameters(parameters);
+    simplex.LoadStateForNextSolve(base_state);
+
+    // Only the objective and the bounds of this problem are read. Since the
+    // matrix never changes, the simplex keeps its factorization from one
+    // variant to the next, except for the first solve.
+    LinearProgram variant_lp;
+    PopulateWithoutMatrix(lp, &variant_lp);
+    bool factorization_is_valid = false;
+    for (int i = begin; i < end; ++i) {
+      if (shared_time_limit.LimitReached()) break;
+      if (!IsValidVariant(lp, variants[i])) {
+        LOG(DFATAL) << "Variant #" << i << " does not match the problem size.";
+        solutions_[i].status = ProblemStatus::ABNORMAL;
+        continue;
+      }
+      ApplyVariant(lp, variants[i], &variant_lp);
+      if (factorization_is_valid) {
+        simplex.NotifyThatMatrixIsUnchangedForNextSolve();
+      }
+      TimeLimit local_time_limit(std::numeric_limits<double>::infinity());
+      shared_time_limit.UpdateLocalLimit(&local_time_limit);
+      const Status status = simplex.Solve(variant_lp, &local_time_limit);
+      shared_time_limit.AdvanceDeterministicTime(
+          local_time_limit.GetElapsedDeterministicTime());
+      factorization_is_valid = true;
+      num_iterations_[i] = simplex.GetNumberOfIterations();
+      worker_iterations[worker] += num_iterations_[i];
+      if (!status.ok()) {
+        // The state of the simplex is unknown, so we restart from the basis of
+        // the base problem.
+        solutions_[i].status = ProblemStatus::ABNORMAL;
+        simplex.ClearStateForNextSolve();
+        simplex.LoadStateForNextSolve(base_state);
+        factorization_is_valid = false;
+        continue;
+      }
+      ExtractSolution(simplex, &solutions_[i]);
+      objective_values_[i] = simplex.GetObjectiveValue();
+    }
+    worker_deterministic_times[worker] = simplex.DeterministicTime();
+  };
+
+  if (num_workers == 1) {
+    solve_range(0);
+  } else {
+    ThreadPool pool("BatchSimplex", num_workers);
+    pool.StartWorkers();
+    for (int worker = 0; worker < num_workers; ++worker) {
+      pool.Schedule([&solve_range, worker]() { solve_range(worker); });
+    }
+  }
+
+  for (int worker = 0; worker < num_workers; ++worker) {
+    total_num_iterations_ += worker_iterations[worker];
+    deterministic_time_ += worker_deterministic_times[worker];
+  }
+  return base_status;
+}
+
+}  // namespace glop
+}  // namespace operations_research
@@ -0,0 +1,111 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OR_TOOLS_GLOP_BATCH_SIMPLEX_H_
+#define OR_TOOLS_GLOP_BATCH_SIMPLEX_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "ortools/glop/parameters.pb.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/util/time_limit.h"
+
+namespace operations_research {
+namespace glop {
+
+// A variant of a base LinearProgram that only differs by its objective and/or
+// its bounds. An empty vector means that the values of the base problem are
+// used, otherwise the vector must have the size of the base problem.
+struct LinearProgramVariant {
+  DenseRow objective_coefficients;
+  DenseRow variable_lower_bounds;
+  DenseRow variable_upper_bounds;
+  DenseColumn constraint_lower_bounds;
+  DenseColumn constraint_upper_bounds;
+};
+
+// Solves many variants of the same LinearProgram, as needed for instance for
+// sensitivity analysis or column generation.
+//
+// The base problem is solved once with the RevisedSimplex, which then owns the
+// only copy of the matrix. Each variant is solved by a RevisedSimplex that
+// reads this matrix, keeps its basis factorization from the previous solve,
+// and is warm-started from the previous optimal basis: the primal simplex is
+// used when only the objective changed, and the dual simplex when only the
+// bounds changed (see allow_simplex_algorithm_change, which is always true
+// here). Consecutive variants that are close to each other thus need few
+// iterations.
+//
+// With num_omp_threads > 1, the variants are split in contiguous ranges that
+// are solved in parallel, each by its own RevisedSimplex warm-started from the
+// optimal basis of the base problem. The solutions do not depend on the thread
+// scheduling, but they may depend on the number of threads when a variant has
+// several optimal solutions.
+//
+// Note that, unlike the LPSolver, there is no preprocessing: most presolve
+// reductions depend on the bounds and objective that the variants change, so
+// the problem is given as is to the RevisedSimplex. It should thus already be
+// reasonably well scaled.
+class BatchRevisedSimplex {
+ public:
+  BatchRevisedSimplex() = default;
+
+  // This type is neither copyable nor movable.
+  BatchRevisedSimplex(const BatchRevisedSimplex&) = delete;
+  BatchRevisedSimplex& operator=(const BatchRevisedSimplex&) = delete;
+
+  void SetParameters(const GlopParameters& parameters) {
+    parameters_ = parameters;
+  }
+
+  // Solves all the variants of the given problem. The time limit is shared by
+  // all the solves; the variants that are not solved before it is reached have
+  // the status ProblemStatus::INIT.
+  //
+  // The status of the base problem is returned. If it is ABNORMAL, the
+  // variants are not solved.
+  ProblemStatus Solve(const LinearProgram& lp,
+                      absl::Span<const LinearProgramVariant> variants,
+                      TimeLimit* time_limit);
+
+  // Results of the last Solve(), one per variant.
+  const ProblemSolution& GetSolution(int variant) const {
+    return solutions_[variant];
+  }
+  Fractional GetObjectiveValue(int variant) const {
+    return objective_values_[variant];
+  }
+  int64_t GetNumberOfIterations(int variant) const {
+    return num_iterations_[variant];
+  }
+
+  // Total for the last Solve(), including the solve of the base problem.
+  int64_t GetTotalNumberOfIterations() const { return total_num_iterations_; }
+  double DeterministicTime() const { return deterministic_time_; }
+
+ private:
+  GlopParameters parameters_;
+  std::vector<ProblemSolution> solutions_;
+  std::vector<Fractional> objective_values_;
+  std::vector<int64_t> num_iterations_;
+  int64_t total_num_iterations_ = 0;
+  double deterministic_time_ = 0.0;
+};
+
+}  // namespace glop
+}  // namespace operations_research
+
+#endif  // OR_TOOLS_GLOP_BATCH_SIMPLEX_H_
@@ -0,0 +1,147 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Throughput of re-solving many variants of the same LP, one at a time with
+// the LPSolver versus with the BatchRevisedSimplex.
+//
+// The problem is a random packing LP: max c.x s.t. A.x <= b, 0 <= x <= 1, with
+// a nonnegative sparse A, so all the variants are feasible and bounded. The
+// variants either perturb the objective or the right-hand side by a few
+// percent, as in a sensitivity analysis. The reported items_per_second is the
+// number of variants solved per second.
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "ortools/base/logging.h"
+#include "ortools/glop/batch_simplex.h"
+#include "ortools/glop/lp_solver.h"
+#include "ortools/glop/parameters.pb.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/util/time_limit.h"
+
+namespace operations_research {
+namespace glop {
+namespace {
+
+constexpr int kNumRows = 300;
+constexpr int kNumCols = 1000;
+constexpr int kEntriesPerCol = 5;
+constexpr int kNumVariants = 100;
+
+void BuildPackingLp(LinearProgram* lp) {
+  std::mt19937 random(12345);
+  std::uniform_real_distribution<double> coefficient(1.0, 10.0);
+  std::uniform_int_distribution<int> row_index(0, kNumRows - 1);
+  lp->Clear();
+  lp->SetMaximizationProblem(true);
+  for (int r = 0; r < kNumRows; ++r) {
+    const RowIndex row = lp->CreateNewConstraint();
+    lp->SetConstraintBounds(row, -kInfinity, 10.0 * kEntriesPerCol);
+  }
+  for (int c = 0; c < kNumCols; ++c) {
+    const ColIndex col = lp->CreateNewVariable();
+    lp->SetVariableBounds(col, 0.0, 1.0);
+    lp->SetObjectiveCoefficient(col, coefficient(random));
+    for (int e = 0; e < kEntriesPerCol; ++e) {
+      lp->SetCoefficient(RowIndex(row_index(random)), col, coefficient(random));
+    }
+  }
+  lp->CleanUp();
+}
+
+std::vector<LinearProgramVariant> BuildVariants(const LinearProgram& lp,
+                                                bool perturb_objective) {
+  std::mt19937 random(67890);
+  std::uniform_real_distribution<double> factor(0.95, 1.05);
+  std::vector<LinearProgramVariant> variants(kNumVariants);
+  for (LinearProgramVariant& variant : variants) {
+    if (perturb_objective) {
+      variant.objective_coefficients = lp.objective_coefficients();
+      for (Fractional& value : variant.objective_coefficients) {
+        value *= factor(random);
+      }
+    } else {
+      variant.constraint_upper_bounds = lp.constraint_upper_bounds();
+      for (Fractional& value : variant.constraint_upper_bounds) {
+        value *= factor(random);
+      }
+    }
+  }
+  return variants;
+}
+
+// Solves each variant with the same LPSolver, after applying it on a copy of
+// the problem. This is what the users of LPSolver did before the batch API.
+void BM_LPSolverVariants(benchmark::State& state) {
+  const bool perturb_objective = state.range(0);
+  LinearProgram lp;
+  BuildPackingLp(&lp);
+  const std::vector<LinearProgramVariant> variants =
+      BuildVariants(lp, perturb_objective);
+  LinearProgram variant_lp;
+  for (auto _ : state) {
+    LPSolver solver;
+    for (const LinearProgramVariant& variant : variants) {
+      variant_lp.PopulateFromLinearProgram(lp);
+      if (perturb_objective) {
+        for (ColIndex col(0); col < lp.num_variables(); ++col) {
+          variant_lp.SetObjectiveCoefficient(
+              col, variant.objective_coefficients[col]);
+        }
+      } else {
+        *variant_lp.mutable_constraint_upper_bounds() =
+            variant.constraint_upper_bounds;
+      }
+      CHECK_EQ(solver.Solve(variant_lp), ProblemStatus::OPTIMAL);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumVariants);
+}
+BENCHMARK(BM_LPSolverVariants)->ArgName("objective")->Arg(0)->Arg(1);
+
+void BM_BatchRevisedSimplexVariants(benchmark::State& state) {
+  const bool perturb_objective = state.range(0);
+  LinearProgram lp;
+  BuildPackingLp(&lp);
+  const std::vector<LinearProgramVariant> variants =
+      BuildVariants(lp, perturb_objective);
+  GlopParameters parameters;
+  parameters.set_num_omp_threads(state.range(1));
+  int64_t num_iterations = 0;
+  for (auto _ : state) {
+    BatchRevisedSimplex batch;
+    batch.SetParameters(parameters);
+    TimeLimit time_limit(std::numeric_limits<double>::infinity());
+    CHECK_EQ(batch.Solve(lp, variants, &time_limit), ProblemStatus::OPTIMAL);
+    for (int i = 0; i < kNumVariants; ++i) {
+      CHECK_EQ(batch.GetSolution(i).status, ProblemStatus::OPTIMAL);
+    }
+    num_iterations += batch.GetTotalNumberOfIterations();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumVariants);
+  state.counters["simplex_iterations"] =
+      benchmark::Counter(num_iterations, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_BatchRevisedSimplexVariants)
+    ->ArgNames({"objective", "threads"})
+    ->ArgsProduct({{0, 1}, {1, 2, 4, 8}})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace glop
+}  // namespace operations_research
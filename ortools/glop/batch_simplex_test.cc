@@ -0,0 +1,169 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/glop/batch_simplex.h"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "absl/random/distributions.h"
+#include "gtest/gtest.h"
+#include "ortools/glop/lp_solver.h"
+#include "ortools/glop/parameters.pb.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/util/time_limit.h"
+
+namespace operations_research {
+namespace glop {
+namespace {
+
+// Random packing problem: max c.x s.t. A.x <= b, 0 <= x <= 1 with a
+// nonnegative A. It stays feasible and bounded when b >= 0.
+void BuildPackingLp(int num_rows, int num_cols, std::mt19937* random,
+                    LinearProgram* lp) {
+  lp->SetMaximizationProblem(true);
+  for (int r = 0; r < num_rows; ++r) {
+    const RowIndex row = lp->CreateNewConstraint();
+    lp->SetConstraintBounds(row, -kInfinity, absl::Uniform(*random, 5, 20));
+  }
+  for (int c = 0; c < num_cols; ++c) {
+    const ColIndex col = lp->CreateNewVariable();
+    lp->SetVariableBounds(col, 0.0, 1.0);
+    lp->SetObjectiveCoefficient(col, absl::Uniform(*random, 1.0, 10.0));
+    for (int e = 0; e < 4; ++e) {
+      lp->SetCoefficient(RowIndex(absl::Uniform(*random, 0, num_rows)), col,
+                         absl::Uniform(*random, 1.0, 10.0));
+    }
+  }
+  lp->CleanUp();
+}
+
+// Variants that change the objective, the constraint bounds, the variable
+// bounds or all of them, in turn.
+std::vector<LinearProgramVariant> BuildVariants(const LinearProgram& lp,
+                                                int num_variants,
+                                                std::mt19937* random) {
+  std::vector<LinearProgramVariant> variants(num_variants);
+  for (int i = 0; i < num_variants; ++i) {
+    LinearProgramVariant& variant = variants[i];
+    if (i % 4 == 0 || i % 4 == 3) {
+      variant.objective_coefficients = lp.objective_coefficients();
+      for (Fractional& value : variant.objective_coefficients) {
+        value *= absl::Uniform(*random, 0.5, 1.5);
+      }
+    }
+    if (i % 4 == 1 || i % 4 == 3) {
+      variant.constraint_upper_bounds = lp.constraint_upper_bounds();
+      for (Fractional& value : variant.constraint_upper_bounds) {
+        value *= absl::Uniform(*random, 0.5, 1.5);
+      }
+    }
+    if (i % 4 == 2 || i % 4 == 3) {
+      variant.variable_upper_bounds = lp.variable_upper_bounds();
+      for (Fractional& value : variant.variable_upper_bounds) {
+        value = absl::Uniform(*random, 0.0, 1.0);
+      }
+    }
+  }
+  return variants;
+}
+
+// Returns a copy of lp with the objective and the bounds of the variant.
+void ApplyVariant(const LinearProgram& lp, const LinearProgramVariant& variant,
+                  LinearProgram* variant_lp) {
+  variant_lp->PopulateFromLinearProgram(lp);
+  for (ColIndex col(0); col < lp.num_variables(); ++col) {
+    if (!variant.objective_coefficients.empty()) {
+      variant_lp->SetObjectiveCoefficient(col,
+                                          variant.objective_coefficients[col]);
+    }
+    if (!variant.variable_upper_bounds.empty()) {
+      variant_lp->SetVariableBounds(col, lp.variable_lower_bounds()[col],
+                                    variant.variable_upper_bounds[col]);
+    }
+  }
+  if (!variant.constraint_upper_bounds.empty()) {
+    *variant_lp->mutable_constraint_upper_bounds() =
+        variant.constraint_upper_bounds;
+  }
+}
+
+TEST(BatchRevisedSimplexTest, MatchesIndependentSolves) {
+  std::mt19937 random(12345);
+  LinearProgram lp;
+  BuildPackingLp(50, 150, &random, &lp);
+  const std::vector<LinearProgramVariant> variants =
+      BuildVariants(lp, 40, &random);
+
+  std::vector<Fractional> expected_objectives;
+  LinearProgram variant_lp;
+  for (const LinearProgramVariant& variant : variants) {
+    ApplyVariant(lp, variant, &variant_lp);
+    LPSolver solver;
+    ASSERT_EQ(solver.Solve(variant_lp), ProblemStatus::OPTIMAL);
+    expected_objectives.push_back(solver.GetObjectiveValue());
+  }
+
+  for (const int num_threads : {1, 4}) {
+    GlopParameters parameters;
+    parameters.set_num_omp_threads(num_threads);
+    BatchRevisedSimplex batch;
+    batch.SetParameters(parameters);
+    TimeLimit time_limit(std::numeric_limits<double>::infinity());
+    ASSERT_EQ(batch.Solve(lp, variants, &time_limit), ProblemStatus::OPTIMAL);
+    for (int i = 0; i < variants.size(); ++i) {
+      const ProblemSolution& solution = batch.GetSolution(i);
+      ASSERT_EQ(solution.status, ProblemStatus::OPTIMAL)
+          << "variant " << i << ", num_threads " << num_threads;
+      EXPECT_NEAR(batch.GetObjectiveValue(i), expected_objectives[i], 1e-6)
+          << "variant " << i << ", num_threads " << num_threads;
+
+      // The primal values are the ones of an optimal solution of the variant.
+      ApplyVariant(lp, variants[i], &variant_lp);
+      Fractional objective = 0.0;
+      for (ColIndex col(0); col < lp.num_variables(); ++col) {
+        const Fractional value = solution.primal_values[col];
+        EXPECT_GE(value, variant_lp.variable_lower_bounds()[col] - 1e-9);
+        EXPECT_LE(value, variant_lp.variable_upper_bounds()[col] + 1e-9);
+        objective += variant_lp.objective_coefficients()[col] * value;
+      }
+      EXPECT_NEAR(objective, expected_objectives[i], 1e-6);
+    }
+    EXPECT_GT(batch.GetTotalNumberOfIterations(), 0);
+  }
+}
+
+// Re-solving the base problem needs no iteration.
+TEST(BatchRevisedSimplexTest, BaseProblemIsWarmStarted) {
+  std::mt19937 random(12345);
+  LinearProgram lp;
+  BuildPackingLp(20, 60, &random, &lp);
+  LPSolver solver;
+  ASSERT_EQ(solver.Solve(lp), ProblemStatus::OPTIMAL);
+
+  const std::vector<LinearProgramVariant> variants(3);
+  BatchRevisedSimplex batch;
+  TimeLimit time_limit(std::numeric_limits<double>::infinity());
+  ASSERT_EQ(batch.Solve(lp, variants, &time_limit), ProblemStatus::OPTIMAL);
+  for (int i = 0; i < variants.size(); ++i) {
+    EXPECT_EQ(batch.GetSolution(i).status, ProblemStatus::OPTIMAL);
+    EXPECT_EQ(batch.GetNumberOfIterations(i), 0);
+    EXPECT_NEAR(batch.GetObjectiveValue(i), solver.GetObjectiveValue(), 1e-6);
+  }
+}
+
+}  // namespace
+}  // namespace glop
+}  // namespace operations_research
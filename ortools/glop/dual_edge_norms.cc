@@ -13,15 +13,20 @@
 
 #include "ortools/glop/dual_edge_norms.h"
 
+#include <cstdint>
 #include <cstdlib>
+#include <vector>
 
 #include "ortools/lp_data/lp_utils.h"
+#include "ortools/lp_data/sharded_executor.h"
 
 namespace operations_research {
 namespace glop {
 
-DualEdgeNorms::DualEdgeNorms(const BasisFactorization& basis_factorization)
+DualEdgeNorms::DualEdgeNorms(const BasisFactorization& basis_factorization,
+                             ShardedExecutor* executor)
     : basis_factorization_(basis_factorization),
+      executor_(executor),
       recompute_edge_squared_norms_(true) {}
 
 bool DualEdgeNorms::NeedsBasisRefactorization() const {
@@ -93,28 +98,50 @@ void DualEdgeNorms::UpdateBeforeBasisPivot(
       edge_squared_norms_[leaving_row] / Square(pivot);
 
   // Update the norm.
-  int stat_lower_bounded_norms = 0;
   auto output = edge_squared_norms_.view();
-  for (const auto e : direction) {
+  const auto update_row_norm = [&](RowIndex row, Fractional coeff) {
     // Note that the update formula used is important to maximize the precision.
     // See Koberstein's PhD section 8.2.2.1.
-    output[e.row()] +=
-        e.coefficient() * (e.coefficient() * new_leaving_squared_norm -
-                           2.0 / pivot * tau[e.row()]);
+    output[row] +=
+        coeff * (coeff * new_leaving_squared_norm - 2.0 / pivot * tau[row]);
 
     // Avoid 0.0 norms (The 1e-4 is the value used by Koberstein).
     // TODO(user): use a more precise lower bound depending on the column norm?
     // We can do that with Cauchy-Swartz inequality:
     //   (edge . leaving_column)^2 = 1.0 < ||edge||^2 * ||leaving_column||^2
     const Fractional kLowerBound = 1e-4;
-    if (output[e.row()] < kLowerBound) {
-      if (e.row() == leaving_row) continue;
-      output[e.row()] = kLowerBound;
-      ++stat_lower_bounded_norms;
+    if (output[row] < kLowerBound) {
+      if (row == leaving_row) return 0;
+      output[row] = kLowerBound;
+      return 1;
     }
-  }
+    return 0;
+  };
+
+  // Each row is updated independently, so the shards write disjoint entries
+  // and the result does not depend on the number of threads.
+  DCHECK(!direction.non_zeros.empty() || IsAllZero(direction.values));
+  const int64_t kMinRowsPerShard = 1 << 14;
+  const int64_t size = direction.non_zeros.size();
+  std::vector<int> shard_lower_bounded_norms(
+      executor_->NumShards(size, kMinRowsPerShard), 0);
+  executor_->ParallelFor(
+      size, kMinRowsPerShard, [&](int shard, int64_t begin, int64_t end) {
+        int num_lower_bounded = 0;
+        for (int64_t i = begin; i < end; ++i) {
+          const RowIndex row = direction.non_zeros[i];
+          num_lower_bounded += update_row_norm(row, direction.values[row]);
+        }
+        shard_lower_bounded_norms[shard] = num_lower_bounded;
+      });
   output[leaving_row] = new_leaving_squared_norm;
-  IF_STATS_ENABLED(stats_.lower_bounded_norms.Add(stat_lower_bounded_norms));
+  IF_STATS_ENABLED({
+    int stat_lower_bounded_norms = 0;
+    for (const int n : shard_lower_bounded_norms) {
+      stat_lower_bounded_norms += n;
+    }
+    stats_.lower_bounded_norms.Add(stat_lower_bounded_norms);
+  });
 }
 
 void DualEdgeNorms::ComputeEdgeSquaredNorms() {
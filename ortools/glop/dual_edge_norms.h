@@ -22,6 +22,7 @@
 #include "ortools/lp_data/lp_types.h"
 #include "ortools/lp_data/permutation.h"
 #include "ortools/lp_data/scattered_vector.h"
+#include "ortools/lp_data/sharded_executor.h"
 #include "ortools/util/stats.h"
 
 namespace operations_research {
@@ -48,8 +49,10 @@ namespace glop {
 // http://digital.ub.uni-paderborn.de/hs/download/pdf/3885?originalFilename=true
 class DualEdgeNorms {
  public:
-  // Takes references to the linear program data we need.
-  explicit DualEdgeNorms(const BasisFactorization& basis_factorization);
+  // Takes references to the linear program data we need. The executor is used
+  // to split the norm updates between threads.
+  DualEdgeNorms(const BasisFactorization& basis_factorization,
+                ShardedExecutor* executor);
 
   // This type is neither copyable nor movable.
   DualEdgeNorms(const DualEdgeNorms&) = delete;
@@ -133,6 +136,7 @@ class DualEdgeNorms {
 
   // Problem data that should be updated from outside.
   const BasisFactorization& basis_factorization_;
+  ShardedExecutor* executor_;
 
   // The dual edge norms.
   DenseColumn edge_squared_norms_;
@@ -14,10 +14,15 @@
 #include "ortools/glop/lp_solver.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <string>
+#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
@@ -25,6 +30,7 @@
 #include "absl/strings/str_format.h"
 #include "google/protobuf/text_format.h"
 #include "ortools/base/logging.h"
+#include "ortools/base/threadpool.h"
 #include "ortools/base/version.h"
 #include "ortools/glop/parameters.pb.h"
 #include "ortools/glop/preprocessor.h"
@@ -33,11 +39,13 @@
 #include "ortools/glop/variables_info.h"
 #include "ortools/linear_solver/linear_solver.pb.h"
 #include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_decomposer.h"
 #include "ortools/lp_data/lp_types.h"
 #include "ortools/lp_data/lp_utils.h"
 #include "ortools/lp_data/proto_utils.h"
 #include "ortools/util/fp_utils.h"
 #include "ortools/util/logging.h"
+#include "ortools/util/time_limit.h"
 
 #ifndef __PORTABLE_PLATFORM__
 // TODO(user): abstract this in some way to the port directory.
@@ -154,6 +162,7 @@ ProblemStatus LPSolver::SolveWithTimeLimit(const LinearProgram& lp,
   }
   ++num_solves_;
   num_revised_simplex_iterations_ = 0;
+  blocks_deterministic_time_ = 0.0;
   DumpLinearProgramIfRequiredByFlags(lp, num_solves_);
 
   // Display a warning if running in non-opt, unless we're inside a unit test.
@@ -241,7 +250,8 @@ ProblemStatus LPSolver::SolveWithTimeLimit(const LinearProgram& lp,
   // Do not launch the solver if the time limit was already reached. This might
   // mean that the pre-processors were not all run, and current_linear_program_
   // might not be in a completely safe state.
-  if (!time_limit->LimitReached()) {
+  if (!time_limit->LimitReached() &&
+      !SolveIndependentBlocksIfPossible(&solution, time_limit)) {
     RunRevisedSimplexIfNeeded(&solution, time_limit);
   }
   if (postsolve_is_needed) preprocessor.DestructiveRecoverSolution(&solution);
@@ -533,8 +543,9 @@ int LPSolver::GetNumberOfSimplexIterations() const {
 }
 
 double LPSolver::DeterministicTime() const {
-  return revised_simplex_ == nullptr ? 0.0
-                                     : revised_simplex_->DeterministicTime();
+  return blocks_deterministic_time_ +
+         (revised_simplex_ == nullptr ? 0.0
+                                      : revised_simplex_->DeterministicTime());
 }
 
 void LPSolver::MovePrimalValuesWithinBounds(const LinearProgram& lp) {
@@ -659,6 +670,283 @@ void LPSolver::RunRevisedSimplexIfNeeded(ProblemSolution* solution,
 
 namespace {
 
+// Returns the status of a problem made of independent blocks, given the status
+// of each block. Note that the dual of such a problem also decomposes.
+ProblemStatus CombineBlockStatuses(const std::vector<ProblemStatus>& statuses) {
+  // One primal infeasible block is enough to prove the primal infeasibility.
+  for (const ProblemStatus status : statuses) {
+    if (status == ProblemStatus::PRIMAL_INFEASIBLE ||
+        status == ProblemStatus::DUAL_UNBOUNDED) {
+      return status;
+    }
+  }
+  for (const ProblemStatus status : statuses) {
+    if (status == ProblemStatus::ABNORMAL ||
+        status == ProblemStatus::INFEASIBLE_OR_UNBOUNDED) {
+      return status;
+    }
+  }
+  bool all_primal_feasible = true;
+  bool all_dual_feasible = true;
+  bool one_primal_unbounded = false;
+  bool one_dual_infeasible = false;
+  for (const ProblemStatus status : statuses) {
+    all_primal_feasible &= status == ProblemStatus::OPTIMAL ||
+                           status == ProblemStatus::PRIMAL_FEASIBLE ||
+                           status == ProblemStatus::PRIMAL_UNBOUNDED;
+    all_dual_feasible &= status == ProblemStatus::OPTIMAL ||
+                         status == ProblemStatus::DUAL_FEASIBLE;
+    one_primal_unbounded |= status == ProblemStatus::PRIMAL_UNBOUNDED;
+    one_dual_infeasible |= status == ProblemStatus::PRIMAL_UNBOUNDED ||
+                           status == ProblemStatus::DUAL_INFEASIBLE;
+  }
+  if (one_primal_unbounded && all_primal_feasible) {
+    return ProblemStatus::PRIMAL_UNBOUNDED;
+  }
+  if (one_dual_infeasible) return ProblemStatus::DUAL_INFEASIBLE;
+  if (all_primal_feasible && all_dual_feasible) return ProblemStatus::OPTIMAL;
+  if (all_primal_feasible) return ProblemStatus::PRIMAL_FEASIBLE;
+  if (all_dual_feasible) return ProblemStatus::DUAL_FEASIBLE;
+  return ProblemStatus::INIT;
+}
+
+}  // namespace
+
+bool LPSolver::SolveIndependentBlocksIfPossible(ProblemSolution* solution,
+                                                TimeLimit* time_limit) {
+  if (!parameters_.solve_independent_blocks()) return false;
+  if (solution->status != ProblemStatus::INIT) return false;
+
+  // As in RunRevisedSimplexIfNeeded(), the transpose is not needed anymore.
+  // Note that LPDecomposer only uses the column-wise matrix.
+  current_linear_program_.ClearTransposeMatrix();
+
+  LPDecomposer decomposer;
+  decomposer.Decompose(&current_linear_program_);
+  const int num_blocks = decomposer.GetNumberOfProblems();
+  if (num_blocks <= 1) return false;
+
+  // The constraints without entries are not part of any block. They are
+  // normally removed by the preprocessors, but we do not decompose if some
+  // remain.
+  int64_t num_rows_in_blocks = 0;
+  ColIndex max_block_num_cols(0);
+  for (int block = 0; block < num_blocks; ++block) {
+    num_rows_in_blocks += decomposer.GetProblemRows(block).size();
+    max_block_num_cols =
+        std::max(max_block_num_cols,
+                 ColIndex(decomposer.GetProblemColumns(block).size()));
+  }
+  if (num_rows_in_blocks != current_linear_program_.num_constraints().value()) {
+    return false;
+  }
+
+  const int num_threads =
+      std::max(1, std::min(parameters_.num_omp_threads(), num_blocks));
+  SOLVER_LOG(&logger_, "");
+  SOLVER_LOG(&logger_, "Solving ", num_blocks, " independent blocks with ",
+             num_threads, " thread(s). The largest block has ",
+             max_block_num_cols.value(), " columns.");
+
+  // Each block is solved sequentially, the parallelism comes from solving
+  // several blocks at once. The objective limits apply to the whole problem,
+  // so they can't be used on a block.
+  GlopParameters block_parameters = parameters_;
+  block_parameters.set_num_omp_threads(1);
+  block_parameters.set_log_search_progress(false);
+  block_parameters.clear_objective_lower_limit();
+  block_parameters.clear_objective_upper_limit();
+
+  // The basis of the whole problem is stored in revised_simplex_ so that the
+  // next solve, with or without blocks, can be warm-started. Its layout is the
+  // one of RevisedSimplex: the variables followed by one slack per constraint.
+  // This is not the case if the problem already contains its slacks.
+  const ColIndex num_cols = current_linear_program_.num_variables();
+  const RowIndex num_rows = current_linear_program_.num_constraints();
+  const bool keep_basis = !current_linear_program_.IsInEquationForm();
+  BasisState previous_state;
+  if (keep_basis && revised_simplex_ != nullptr &&
+      revised_simplex_->GetState().statuses.size() ==
+          num_cols + RowToColIndex(num_rows)) {
+    previous_state = revised_simplex_->GetState();
+  }
+  BasisState state;
+  if (keep_basis) {
+    state.statuses.resize(num_cols + RowToColIndex(num_rows),
+                          VariableStatus::FREE);
+  }
+
+  // The rays are only returned when they are valid for the given problem, see
+  // RunRevisedSimplexIfNeeded(). They are stored per block and only the ones
+  // of the block that determines the problem status are used.
+  const bool compute_rays =
+      !parameters_.use_preprocessing() && !parameters_.use_scaling();
+  std::vector<DenseRow> primal_rays(num_blocks);
+  std::vector<DenseColumn> dual_rays(num_blocks);
+  std::vector<DenseRow> dual_ray_row_combinations(num_blocks);
+
+  // Each block writes directly its part of the solution, and the statistics
+  // are aggregated in block order so that the result does not depend on the
+  // thread scheduling.
+  std::vector<ProblemStatus> statuses(num_blocks, ProblemStatus::INIT);
+  std::vector<int> num_iterations(num_blocks, 0);
+  std::vector<double> deterministic_times(num_blocks, 0.0);
+  SharedTimeLimit shared_time_limit(time_limit);
+  std::atomic<bool> stop_blocks(false);
+  const auto solve_block = [&](int block) {
+    if (stop_blocks || shared_time_limit.LimitReached()) return;
+    LinearProgram lp;
+    decomposer.ExtractLocalProblem(block, &lp);
+    lp.CleanUp();
+
+    const std::vector<ColIndex>& cols = decomposer.GetProblemColumns(block);
+    const std::vector<RowIndex>& rows = decomposer.GetProblemRows(block);
+    RevisedSimplex simplex;
+    simplex.SetParameters(block_parameters);
+    if (!previous_state.IsEmpty()) {
+      BasisState block_state;
+      block_state.statuses.reserve(ColIndex(cols.size() + rows.size()));
+      for (const ColIndex col : cols) {
+        block_state.statuses.push_back(previous_state.statuses[col]);
+      }
+      for (const RowIndex row : rows) {
+        block_state.statuses.push_back(
+            previous_state.statuses[num_cols + RowToColIndex(row)]);
+      }
+      simplex.LoadStateForNextSolve(block_state);
+    }
+
+    TimeLimit local_time_limit(std::numeric_limits<double>::infinity());
+    shared_time_limit.UpdateLocalLimit(&local_time_limit);
+    local_time_limit.RegisterSecondaryExternalBooleanAsLimit(&stop_blocks);
+    const Status status = simplex.Solve(lp, &local_time_limit);
+    shared_time_limit.AdvanceDeterministicTime(
+        local_time_limit.GetElapsedDeterministicTime());
+    num_iterations[block] = simplex.GetNumberOfIterations();
+    deterministic_times[block] = simplex.DeterministicTime();
+    if (!status.ok()) {
+      statuses[block] = ProblemStatus::ABNORMAL;
+      stop_blocks = true;
+      return;
+    }
+    statuses[block] = simplex.GetProblemStatus();
+
+    // As soon as one block proves something about the whole problem, there is
+    // no point solving the others.
+    if (statuses[block] != ProblemStatus::OPTIMAL &&
+        statuses[block] != ProblemStatus::INIT &&
+        statuses[block] != ProblemStatus::PRIMAL_FEASIBLE &&
+        statuses[block] != ProblemStatus::DUAL_FEASIBLE) {
+      stop_blocks = true;
+    }
+
+    for (int i = 0; i < cols.size(); ++i) {
+      solution->primal_values[cols[i]] = simplex.GetVariableValue(ColIndex(i));
+      solution->variable_statuses[cols[i]] =
+          simplex.GetVariableStatus(ColIndex(i));
+    }
+    for (int i = 0; i < rows.size(); ++i) {
+      solution->dual_values[rows[i]] = simplex.GetDualValue(RowIndex(i));
+      solution->constraint_statuses[rows[i]] =
+          simplex.GetConstraintStatus(RowIndex(i));
+    }
+    if (keep_basis) {
+      const VariableStatusRow& block_statuses = simplex.GetState().statuses;
+      for (int i = 0; i < cols.size(); ++i) {
+        state.statuses[cols[i]] = block_statuses[ColIndex(i)];
+      }
+      const ColIndex first_slack(cols.size());
+      for (int i = 0; i < rows.size(); ++i) {
+        state.statuses[num_cols + RowToColIndex(rows[i])] =
+            block_statuses[first_slack + ColIndex(i)];
+      }
+    }
+    if (compute_rays) {
+      if (statuses[block] == ProblemStatus::PRIMAL_UNBOUNDED) {
+        primal_rays[block] = simplex.GetPrimalRay();
+      } else if (statuses[block] == ProblemStatus::DUAL_UNBOUNDED) {
+        dual_rays[block] = simplex.GetDualRay();
+        dual_ray_row_combinations[block] = simplex.GetDualRayRowCombination();
+      }
+    }
+  };
+
+  // Start with the largest blocks so that a large block is less likely to end
+  // up running alone at the end.
+  std::vector<int> order(num_blocks);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&decomposer](int a, int b) {
+    return decomposer.GetProblemColumns(a).size() >
+           decomposer.GetProblemColumns(b).size();
+  });
+  if (num_threads == 1) {
+    for (const int block : order) solve_block(block);
+  } else {
+    ThreadPool pool("LPBlocks", num_threads);
+    pool.StartWorkers();
+    for (const int block : order) {
+      pool.Schedule([&solve_block, block]() { solve_block(block); });
+    }
+  }
+
+  for (int block = 0; block < num_blocks; ++block) {
+    num_revised_simplex_iterations_ += num_iterations[block];
+    blocks_deterministic_time_ += deterministic_times[block];
+  }
+  solution->status = CombineBlockStatuses(statuses);
+
+  // The blocks that were not solved keep the statuses of the previous basis.
+  revised_simplex_ = std::make_unique<RevisedSimplex>();
+  revised_simplex_->SetLogger(&logger_);
+  if (keep_basis) {
+    if (!previous_state.IsEmpty()) {
+      for (int block = 0; block < num_blocks; ++block) {
+        if (statuses[block] != ProblemStatus::INIT) continue;
+        for (const ColIndex col : decomposer.GetProblemColumns(block)) {
+          state.statuses[col] = previous_state.statuses[col];
+        }
+        for (const RowIndex row : decomposer.GetProblemRows(block)) {
+          const ColIndex slack = num_cols + RowToColIndex(row);
+          state.statuses[slack] = previous_state.statuses[slack];
+        }
+      }
+    }
+    revised_simplex_->LoadStateForNextSolve(state);
+  }
+
+  // The rays of a block, completed by zeros, are rays of the whole problem.
+  // The signs follow the same convention as in RunRevisedSimplexIfNeeded().
+  if (!compute_rays) return true;
+  for (int block = 0; block < num_blocks; ++block) {
+    if (statuses[block] != solution->status) continue;
+    const std::vector<ColIndex>& cols = decomposer.GetProblemColumns(block);
+    const std::vector<RowIndex>& rows = decomposer.GetProblemRows(block);
+    if (solution->status == ProblemStatus::PRIMAL_UNBOUNDED) {
+      primal_ray_.assign(num_cols, 0.0);
+      for (int i = 0; i < cols.size(); ++i) {
+        primal_ray_[cols[i]] = primal_rays[block][ColIndex(i)];
+      }
+    } else if (solution->status == ProblemStatus::DUAL_UNBOUNDED) {
+      const bool is_maximization =
+          current_linear_program_.IsMaximizationProblem();
+      constraints_dual_ray_.assign(num_rows, 0.0);
+      for (int i = 0; i < rows.size(); ++i) {
+        const Fractional value = dual_rays[block][RowIndex(i)];
+        constraints_dual_ray_[rows[i]] = is_maximization ? value : -value;
+      }
+      variable_bounds_dual_ray_.assign(num_cols, 0.0);
+      for (int i = 0; i < cols.size(); ++i) {
+        const Fractional value = dual_ray_row_combinations[block][ColIndex(i)];
+        variable_bounds_dual_ray_[cols[i]] = is_maximization ? -value : value;
+      }
+    }
+    break;
+  }
+  return true;
+}
+
+namespace {
+
 void LogVariableStatusError(ColIndex col, Fractional value,
                             VariableStatus status, Fractional lb,
                             Fractional ub) {
@@ -195,6 +195,14 @@ class LPSolver {
   void RunRevisedSimplexIfNeeded(ProblemSolution* solution,
                                  TimeLimit* time_limit);
 
+  // If the solve_independent_blocks parameter is true and the preprocessed
+  // problem can be split into more than one independent block, solves each
+  // block with its own RevisedSimplex (possibly in parallel) and assembles the
+  // solution, the basis and the rays. Returns false if nothing was done, in
+  // which case RunRevisedSimplexIfNeeded() must be used instead.
+  bool SolveIndependentBlocksIfPossible(ProblemSolution* solution,
+                                        TimeLimit* time_limit);
+
   // Checks that the returned solution values and statuses are consistent.
   // Returns true if this is the case. See the code for the exact check
   // performed.
@@ -278,6 +286,10 @@ class LPSolver {
   // The number of revised simplex iterations used by the last Solve().
   int num_revised_simplex_iterations_;
 
+  // The total deterministic time of the blocks solved by the last Solve() if
+  // SolveIndependentBlocksIfPossible() was used, zero otherwise.
+  double blocks_deterministic_time_ = 0.0;
+
   // The current ProblemSolution.
   // TODO(user): use a ProblemSolution directly? Note, that primal_ray_,
   // constraints_dual_ray_ and variable_bounds_dual_ray_ are not currently in
@@ -0,0 +1,268 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/glop/lp_solver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "absl/random/distributions.h"
+#include "gtest/gtest.h"
+#include "ortools/glop/parameters.pb.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+
+namespace operations_research {
+namespace glop {
+namespace {
+
+// The rays are only returned without preprocessing nor scaling.
+GlopParameters BlockParameters() {
+  GlopParameters parameters;
+  parameters.set_solve_independent_blocks(true);
+  parameters.set_use_preprocessing(false);
+  parameters.set_use_scaling(false);
+  return parameters;
+}
+
+// Adds a new constraint lb <= sum coefficients[i] * cols[i] <= ub.
+RowIndex AddConstraint(const std::vector<ColIndex>& cols,
+                       const std::vector<Fractional>& coefficients,
+                       Fractional lb, Fractional ub, LinearProgram* lp) {
+  const RowIndex row = lp->CreateNewConstraint();
+  lp->SetConstraintBounds(row, lb, ub);
+  for (int i = 0; i < cols.size(); ++i) {
+    lp->SetCoefficient(row, cols[i], coefficients[i]);
+  }
+  return row;
+}
+
+// Block 0: max x0 + x1 s.t. x0 + 2 x1 <= 4 and x0, x1 in [0, 3].
+void AddFeasibleBlock(LinearProgram* lp) {
+  const ColIndex x0 = lp->CreateNewVariable();
+  const ColIndex x1 = lp->CreateNewVariable();
+  lp->SetVariableBounds(x0, 0.0, 3.0);
+  lp->SetVariableBounds(x1, 0.0, 3.0);
+  lp->SetObjectiveCoefficient(x0, 1.0);
+  lp->SetObjectiveCoefficient(x1, 1.0);
+  AddConstraint({x0, x1}, {1.0, 2.0}, -kInfinity, 4.0, lp);
+}
+
+// Block-diagonal problem with num_blocks random blocks of 3 variables and 2
+// constraints each. All the variables are boxed, so it is never unbounded.
+void BuildRandomBlocks(int num_blocks, std::mt19937* random,
+                       LinearProgram* lp) {
+  lp->SetMaximizationProblem(true);
+  for (int block = 0; block < num_blocks; ++block) {
+    std::vector<ColIndex> cols;
+    for (int i = 0; i < 3; ++i) {
+      cols.push_back(lp->CreateNewVariable());
+      lp->SetVariableBounds(cols.back(), 0.0, absl::Uniform(*random, 1, 10));
+      lp->SetObjectiveCoefficient(cols.back(),
+                                  absl::Uniform(*random, -5, 10));
+    }
+    for (int i = 0; i < 2; ++i) {
+      AddConstraint(cols,
+                    {absl::Uniform<double>(*random, 1, 5),
+                     absl::Uniform<double>(*random, 1, 5),
+                     absl::Uniform<double>(*random, -5, 5)},
+                    -kInfinity, absl::Uniform(*random, 5, 20), lp);
+    }
+  }
+  lp->CleanUp();
+}
+
+TEST(LPSolverTest, IndependentBlocksMatchSingleSolve) {
+  std::mt19937 random(12345);
+  for (const bool use_preprocessing : {false, true}) {
+    LinearProgram lp;
+    BuildRandomBlocks(20, &random, &lp);
+
+    GlopParameters parameters;
+    parameters.set_use_preprocessing(use_preprocessing);
+    LPSolver single_solver;
+    single_solver.SetParameters(parameters);
+    ASSERT_EQ(single_solver.Solve(lp), ProblemStatus::OPTIMAL);
+
+    parameters.set_solve_independent_blocks(true);
+    parameters.set_num_omp_threads(4);
+    LPSolver block_solver;
+    block_solver.SetParameters(parameters);
+    ASSERT_EQ(block_solver.Solve(lp), ProblemStatus::OPTIMAL);
+    EXPECT_NEAR(block_solver.GetObjectiveValue(),
+                single_solver.GetObjectiveValue(), 1e-6);
+  }
+}
+
+TEST(LPSolverTest, IndependentBlocksWithInfeasibleBlock) {
+  for (const bool maximize : {false, true}) {
+    LinearProgram lp;
+    lp.SetMaximizationProblem(maximize);
+    AddFeasibleBlock(&lp);
+    // Block 1: x2 + x3 >= 3 with x2, x3 in [0, 1] is infeasible.
+    const ColIndex x2 = lp.CreateNewVariable();
+    const ColIndex x3 = lp.CreateNewVariable();
+    lp.SetVariableBounds(x2, 0.0, 1.0);
+    lp.SetVariableBounds(x3, 0.0, 1.0);
+    lp.SetObjectiveCoefficient(x2, 1.0);
+    const RowIndex infeasible_row =
+        AddConstraint({x2, x3}, {1.0, 1.0}, 3.0, kInfinity, &lp);
+    lp.CleanUp();
+
+    // The dual simplex proves the infeasibility with a dual ray.
+    GlopParameters parameters = BlockParameters();
+    parameters.set_use_dual_simplex(true);
+    LPSolver solver;
+    solver.SetParameters(parameters);
+    LPSolver single_solver;
+    parameters.set_solve_independent_blocks(false);
+    single_solver.SetParameters(parameters);
+    const ProblemStatus expected_status = single_solver.Solve(lp);
+
+    ASSERT_EQ(solver.Solve(lp), expected_status);
+    ASSERT_EQ(expected_status, ProblemStatus::DUAL_UNBOUNDED);
+
+    // The ray is zero outside of the infeasible block, and it satisfies the
+    // same relation as the one of a single solve.
+    const DenseColumn& constraints_ray = solver.constraints_dual_ray();
+    const DenseRow& bounds_ray = solver.variable_bounds_dual_ray();
+    ASSERT_EQ(constraints_ray.size(), lp.num_constraints());
+    ASSERT_EQ(bounds_ray.size(), lp.num_variables());
+    EXPECT_EQ(constraints_ray[RowIndex(0)], 0.0);
+    EXPECT_EQ(bounds_ray[ColIndex(0)], 0.0);
+    EXPECT_EQ(bounds_ray[ColIndex(1)], 0.0);
+    EXPECT_NE(constraints_ray[infeasible_row], 0.0);
+    EXPECT_EQ(std::signbit(constraints_ray[infeasible_row]),
+              std::signbit(single_solver.constraints_dual_ray()[RowIndex(1)]));
+    for (const ColIndex col : {x2, x3}) {
+      EXPECT_NEAR(bounds_ray[col], -constraints_ray[infeasible_row], 1e-9);
+    }
+  }
+}
+
+TEST(LPSolverTest, IndependentBlocksWithUnboundedBlock) {
+  LinearProgram lp;
+  lp.SetMaximizationProblem(true);
+  AddFeasibleBlock(&lp);
+  // Block 1: max x2 s.t. x2 - x3 >= 1 with x2, x3 >= 0 is unbounded.
+  const ColIndex x2 = lp.CreateNewVariable();
+  const ColIndex x3 = lp.CreateNewVariable();
+  lp.SetVariableBounds(x2, 0.0, kInfinity);
+  lp.SetVariableBounds(x3, 0.0, kInfinity);
+  lp.SetObjectiveCoefficient(x2, 1.0);
+  AddConstraint({x2, x3}, {1.0, -1.0}, 1.0, kInfinity, &lp);
+  lp.CleanUp();
+
+  LPSolver solver;
+  solver.SetParameters(BlockParameters());
+  ASSERT_EQ(solver.Solve(lp), ProblemStatus::PRIMAL_UNBOUNDED);
+
+  // The ray is zero outside of the unbounded block, improves the objective and
+  // keeps the constraints and the variable bounds satisfied.
+  const DenseRow& ray = solver.primal_ray();
+  ASSERT_EQ(ray.size(), lp.num_variables());
+  EXPECT_EQ(ray[ColIndex(0)], 0.0);
+  EXPECT_EQ(ray[ColIndex(1)], 0.0);
+  EXPECT_GT(ray[x2], 0.0);
+  EXPECT_GE(ray[x3], 0.0);
+  EXPECT_GE(ray[x2] - ray[x3], 0.0);
+}
+
+TEST(LPSolverTest, IndependentBlocksKeepTheBasis) {
+  std::mt19937 random(12345);
+  LinearProgram lp;
+  BuildRandomBlocks(10, &random, &lp);
+  LPSolver solver;
+  solver.SetParameters(BlockParameters());
+  ASSERT_EQ(solver.Solve(lp), ProblemStatus::OPTIMAL);
+  const Fractional objective = solver.GetObjectiveValue();
+  EXPECT_GT(solver.GetNumberOfSimplexIterations(), 0);
+
+  // The same problem is solved again, from the optimal basis of each block.
+  ASSERT_EQ(solver.Solve(lp), ProblemStatus::OPTIMAL);
+  EXPECT_EQ(solver.GetNumberOfSimplexIterations(), 0);
+  EXPECT_NEAR(solver.GetObjectiveValue(), objective, 1e-9);
+
+  // The basis is also used by a solve without blocks.
+  GlopParameters parameters = BlockParameters();
+  parameters.set_solve_independent_blocks(false);
+  solver.SetParameters(parameters);
+  ASSERT_EQ(solver.Solve(lp), ProblemStatus::OPTIMAL);
+  EXPECT_EQ(solver.GetNumberOfSimplexIterations(), 0);
+  EXPECT_NEAR(solver.GetObjectiveValue(), objective, 1e-9);
+}
+
+// Maximizes a positive objective over num_cols variables in [0, 1] with
+// num_rows random constraints of 3 variables. Only num_violated_rows of them
+// are violated by the all-ones solution, so the solve needs few iterations
+// even though both dimensions are large enough to be split by the simplex.
+void BuildLargeSparseLp(int num_rows, int num_cols, int num_violated_rows,
+                        std::mt19937* random, LinearProgram* lp) {
+  lp->SetMaximizationProblem(true);
+  std::vector<ColIndex> cols;
+  for (int col = 0; col < num_cols; ++col) {
+    cols.push_back(lp->CreateNewVariable());
+    lp->SetVariableBounds(cols.back(), 0.0, 1.0);
+    lp->SetObjectiveCoefficient(cols.back(), absl::Uniform(*random, 1.0, 2.0));
+  }
+  for (int row = 0; row < num_rows; ++row) {
+    std::vector<ColIndex> row_cols;
+    std::vector<Fractional> coefficients;
+    Fractional sum = 0.0;
+    for (int i = 0; i < 3; ++i) {
+      row_cols.push_back(cols[absl::Uniform(*random, 0, num_cols)]);
+      coefficients.push_back(absl::Uniform(*random, 1.0, 2.0));
+      sum += coefficients.back();
+    }
+    AddConstraint(row_cols, coefficients, -kInfinity,
+                  row < num_violated_rows ? sum / 2 : sum, lp);
+  }
+  lp->CleanUp();
+}
+
+// The sharded loops of the simplex compute each entry independently, so the
+// solves must be identical for any number of threads.
+TEST(LPSolverTest, SameSolveWithAnyNumberOfThreads) {
+  std::mt19937 random(12345);
+  LinearProgram lp;
+  BuildLargeSparseLp(/*num_rows=*/34'000, /*num_cols=*/34'000,
+                     /*num_violated_rows=*/200, &random, &lp);
+  for (const bool use_dual_simplex : {false, true}) {
+    GlopParameters parameters;
+    // The preprocessing would remove the rows that are never violated.
+    parameters.set_use_preprocessing(false);
+    parameters.set_use_dual_simplex(use_dual_simplex);
+    LPSolver sequential_solver;
+    sequential_solver.SetParameters(parameters);
+    ASSERT_EQ(sequential_solver.Solve(lp), ProblemStatus::OPTIMAL);
+    EXPECT_GT(sequential_solver.GetNumberOfSimplexIterations(), 100);
+
+    parameters.set_num_omp_threads(4);
+    LPSolver parallel_solver;
+    parallel_solver.SetParameters(parameters);
+    ASSERT_EQ(parallel_solver.Solve(lp), ProblemStatus::OPTIMAL);
+    EXPECT_EQ(parallel_solver.GetNumberOfSimplexIterations(),
+              sequential_solver.GetNumberOfSimplexIterations());
+    EXPECT_EQ(parallel_solver.GetObjectiveValue(),
+              sequential_solver.GetObjectiveValue());
+    EXPECT_EQ(parallel_solver.variable_values(),
+              sequential_solver.variable_values());
+    EXPECT_EQ(parallel_solver.dual_values(), sequential_solver.dual_values());
+  }
+}
+
+}  // namespace
+}  // namespace glop
+}  // namespace operations_research
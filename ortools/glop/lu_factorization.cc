@@ -29,7 +29,14 @@ LuFactorization::LuFactorization()
       col_perm_(),
       inverse_col_perm_(),
       row_perm_(),
-      inverse_row_perm_() {}
+      inverse_row_perm_() {
+  // The same sparsity patterns are often solved many times with the same
+  // factorization, for instance the unit rows of the dual simplex.
+  lower_.EnableReachCache(true);
+  upper_.EnableReachCache(true);
+  transpose_upper_.EnableReachCache(true);
+  transpose_lower_.EnableReachCache(true);
+}
 
 void LuFactorization::Clear() {
   SCOPED_TIME_STAT(&stats_);
@@ -116,8 +123,10 @@ void LuFactorization::LeftSolve(DenseRow* y) const {
   // We need to interpret y as a column for the permutation functions.
   DenseColumn* const x = reinterpret_cast<DenseColumn*>(y);
   ApplyInversePermutation(inverse_col_perm_, *x, &dense_column_scratchpad_);
-  upper_.TransposeUpperSolve(&dense_column_scratchpad_);
-  lower_.TransposeLowerSolve(&dense_column_scratchpad_);
+  upper_.ParallelTransposeUpperSolve(sharded_executor_,
+                                     &dense_column_scratchpad_);
+  lower_.ParallelTransposeLowerSolve(sharded_executor_,
+                                     &dense_column_scratchpad_);
   ApplyInversePermutation(row_perm_, dense_column_scratchpad_, x);
 }
 
@@ -327,7 +336,7 @@ void LuFactorization::LeftSolveUWithNonZeros(ScatteredRow* y) const {
   transpose_upper_.ComputeRowsToConsiderInSortedOrder(nz);
   y->non_zeros_are_sorted = true;
   if (nz->empty()) {
-    upper_.TransposeUpperSolve(x);
+    upper_.ParallelTransposeUpperSolve(sharded_executor_, x);
   } else {
     upper_.TransposeHyperSparseSolve(x, nz);
   }
@@ -344,7 +353,8 @@ void LuFactorization::RightSolveUWithNonZeros(ScatteredColumn* x) const {
   upper_.ComputeRowsToConsiderInSortedOrder(&x->non_zeros, 0.1, 0.2);
   x->non_zeros_are_sorted = true;
   if (x->non_zeros.empty()) {
-    transpose_upper_.TransposeLowerSolve(&x->values);
+    transpose_upper_.ParallelTransposeLowerSolve(sharded_executor_,
+                                                 &x->values);
   } else {
     transpose_upper_.TransposeHyperSparseSolveWithReversedNonZeros(
         &x->values, &x->non_zeros);
@@ -365,7 +375,7 @@ bool LuFactorization::LeftSolveLWithNonZeros(
   transpose_lower_.ComputeRowsToConsiderInSortedOrder(nz);
   y->non_zeros_are_sorted = true;
   if (nz->empty()) {
-    lower_.TransposeLowerSolve(x);
+    lower_.ParallelTransposeLowerSolve(sharded_executor_, x);
   } else {
     lower_.TransposeHyperSparseSolveWithReversedNonZeros(x, nz);
   }
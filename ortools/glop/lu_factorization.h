@@ -23,6 +23,7 @@
 #include "ortools/lp_data/lp_types.h"
 #include "ortools/lp_data/permutation.h"
 #include "ortools/lp_data/scattered_vector.h"
+#include "ortools/lp_data/sharded_executor.h"
 #include "ortools/lp_data/sparse.h"
 #include "ortools/lp_data/sparse_column.h"
 #include "ortools/util/stats.h"
@@ -205,6 +206,14 @@ class LuFactorization {
     markowitz_.SetParameters(parameters);
   }
 
+  // If not nullptr, the dense transpose solves (i.e. the ones that do not
+  // exploit the hyper-sparsity of the input) are level-scheduled and run in
+  // parallel on this executor, which must outlive this class. The results are
+  // the same as without it.
+  void SetShardedExecutor(ShardedExecutor* executor) {
+    sharded_executor_ = executor;
+  }
+
   // Returns a string containing the statistics for this class.
   std::string StatString() const {
     return stats_.StatString() + markowitz_.StatString();
@@ -302,6 +311,9 @@ class LuFactorization {
 
   // The class doing the Markowitz LU factorization.
   Markowitz markowitz_;
+
+  // Not owned, see SetShardedExecutor().
+  ShardedExecutor* sharded_executor_ = nullptr;
 };
 
 }  // namespace glop
@@ -0,0 +1,161 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/glop/lu_factorization.h"
+
+#include <cmath>
+#include <random>
+
+#include "absl/random/distributions.h"
+#include "gtest/gtest.h"
+#include "ortools/glop/markowitz.h"
+#include "ortools/glop/parameters.pb.h"
+#include "ortools/glop/status.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/lp_data/permutation.h"
+#include "ortools/lp_data/sparse.h"
+
+namespace operations_research {
+namespace glop {
+namespace {
+
+constexpr int kNumSparseRows = 80;
+constexpr int kDenseSize = 120;
+constexpr int kSize = kNumSparseRows + kDenseSize;
+
+// A basis whose first kNumSparseRows rows are row singletons, and whose other
+// rows and columns form a dense core. Once the singletons are eliminated, the
+// residual matrix is the dense core, so the dense LU switch triggers with any
+// density threshold. If singular is true, the last two columns are the same.
+void BuildBasisWithDenseCore(bool singular, std::mt19937* random,
+                             SparseMatrix* matrix) {
+  matrix->PopulateFromZero(RowIndex(kSize), ColIndex(kSize));
+  for (ColIndex col(0); col < kNumSparseRows; ++col) {
+    matrix->mutable_column(col)->SetCoefficient(ColToRowIndex(col), 3.0);
+    matrix->mutable_column(col)->SetCoefficient(
+        RowIndex(kNumSparseRows + col.value() % kDenseSize), 0.5);
+  }
+  for (ColIndex col(kNumSparseRows); col < kSize; ++col) {
+    SparseColumn* column = matrix->mutable_column(col);
+    if (singular && col == kSize - 1) {
+      column->PopulateFromSparseVector(matrix->column(col - 1));
+      continue;
+    }
+    for (RowIndex row(kNumSparseRows); row < kSize; ++row) {
+      // The diagonal makes the core well conditioned.
+      const Fractional diagonal = ColToRowIndex(col) == row ? 5.0 : 0.0;
+      column->SetCoefficient(row,
+                             diagonal + absl::Uniform(*random, -1.0, 1.0));
+    }
+  }
+}
+
+GlopParameters DenseSwitchParameters() {
+  GlopParameters parameters;
+  parameters.set_markowitz_dense_switch_density(0.3);
+  return parameters;
+}
+
+DenseColumn RandomColumn(std::mt19937* random) {
+  DenseColumn result(RowIndex(kSize), 0.0);
+  for (RowIndex row(0); row < kSize; ++row) {
+    result[row] = absl::Uniform(*random, -10.0, 10.0);
+  }
+  return result;
+}
+
+TEST(LuFactorizationTest, DenseSwitchMatchesSparseFactorization) {
+  std::mt19937 random(12345);
+  SparseMatrix matrix;
+  BuildBasisWithDenseCore(/*singular=*/false, &random, &matrix);
+  const CompactSparseMatrix compact_matrix(matrix);
+  RowToColMapping basis;
+  for (ColIndex col(0); col < kSize; ++col) basis.push_back(col);
+  const CompactSparseMatrixView view(&compact_matrix, &basis);
+
+  LuFactorization sparse_lu;
+  ASSERT_TRUE(sparse_lu.ComputeFactorization(view).ok());
+  LuFactorization dense_lu;
+  dense_lu.SetParameters(DenseSwitchParameters());
+  ASSERT_TRUE(dense_lu.ComputeFactorization(view).ok());
+
+  for (int i = 0; i < 5; ++i) {
+    const DenseColumn rhs = RandomColumn(&random);
+
+    // B.x = rhs.
+    DenseColumn sparse_x = rhs;
+    sparse_lu.RightSolve(&sparse_x);
+    DenseColumn dense_x = rhs;
+    dense_lu.RightSolve(&dense_x);
+    DenseColumn product(RowIndex(kSize), 0.0);
+    for (ColIndex col(0); col < kSize; ++col) {
+      for (const SparseColumn::Entry e : matrix.column(col)) {
+        product[e.row()] += e.coefficient() * dense_x[ColToRowIndex(col)];
+      }
+    }
+    for (RowIndex row(0); row < kSize; ++row) {
+      EXPECT_NEAR(dense_x[row], sparse_x[row], 1e-9) << row;
+      EXPECT_NEAR(product[row], rhs[row], 1e-9) << row;
+    }
+
+    // y.B = rhs.
+    DenseRow sparse_y(ColIndex(kSize), 0.0);
+    for (RowIndex row(0); row < kSize; ++row) {
+      sparse_y[RowToColIndex(row)] = rhs[row];
+    }
+    DenseRow dense_y = sparse_y;
+    sparse_lu.LeftSolve(&sparse_y);
+    dense_lu.LeftSolve(&dense_y);
+    for (ColIndex col(0); col < kSize; ++col) {
+      EXPECT_NEAR(dense_y[col], sparse_y[col], 1e-9) << col;
+    }
+  }
+}
+
+// On a singular basis, both the sparse and the dense elimination stop with
+// ERROR_LU and leave one column without a pivot.
+TEST(LuFactorizationTest, DenseSwitchOnSingularBasis) {
+  std::mt19937 random(12345);
+  SparseMatrix matrix;
+  BuildBasisWithDenseCore(/*singular=*/true, &random, &matrix);
+  const CompactSparseMatrix compact_matrix(matrix);
+  RowToColMapping basis;
+  for (ColIndex col(0); col < kSize; ++col) basis.push_back(col);
+  const CompactSparseMatrixView view(&compact_matrix, &basis);
+
+  for (const bool use_dense_switch : {false, true}) {
+    const GlopParameters parameters =
+        use_dense_switch ? DenseSwitchParameters() : GlopParameters();
+    LuFactorization lu;
+    lu.SetParameters(parameters);
+    EXPECT_EQ(lu.ComputeFactorization(view).error_code(), Status::ERROR_LU);
+
+    Markowitz markowitz;
+    markowitz.SetParameters(parameters);
+    RowPermutation row_perm;
+    ColumnPermutation col_perm;
+    EXPECT_EQ(
+        markowitz.ComputeRowAndColumnPermutation(view, &row_perm, &col_perm)
+            .error_code(),
+        Status::ERROR_LU);
+    int num_missing_pivots = 0;
+    for (ColIndex col(0); col < kSize; ++col) {
+      if (col_perm[col] == kInvalidCol) ++num_missing_pivots;
+    }
+    EXPECT_EQ(num_missing_pivots, 1) << use_dense_switch;
+  }
+}
+
+}  // namespace
+}  // namespace glop
+}  // namespace operations_research
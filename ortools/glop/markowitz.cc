@@ -94,6 +94,16 @@ Status Markowitz::ComputeRowAndColumnPermutation(
     DCHECK_EQ((*row_perm)[pivot_row], kInvalidRow);
     DCHECK_EQ((*col_perm)[pivot_col], kInvalidCol);
 
+    // Once the residual matrix is dense, it is a lot faster to finish with a
+    // dense factorization. Note that the pivot we just found is not used.
+    if (min_markowitz > 0 && num_rows.value() == num_cols.value() &&
+        ShouldSwitchToDenseLU(end_index - index)) {
+      stats_.dense_residual_ratio.Add(
+          static_cast<double>(end_index - index) / num_rows.value());
+      GLOP_RETURN_IF_ERROR(ComputeDenseResidualLU(row_perm, col_perm, &index));
+      break;
+    }
+
     // Update residual_matrix_non_zero_.
     // TODO(user): This step can be skipped, once a fully dense matrix is
     // obtained. But note that permuted_lower_column_needs_solve_ needs to be
@@ -558,6 +568,153 @@ double Markowitz::DeterministicTimeOfLastFactorization() const {
   return DeterministicTimeForFpOperations(num_fp_operations_);
 }
 
+bool Markowitz::ShouldSwitchToDenseLU(int residual_size) const {
+  const double switch_density = parameters_.markowitz_dense_switch_density();
+  if (switch_density >= 1.0) return false;
+
+  // Below this size, the sparse code is fast enough, and above it we do not
+  // want to allocate the dense matrix.
+  const int kMinDenseSize = 64;
+  const int64_t kMaxDenseEntries = int64_t{1} << 25;
+  if (residual_size < kMinDenseSize) return false;
+  if (int64_t{residual_size} * residual_size > kMaxDenseEntries) return false;
+
+  // FindPivot() examines the columns by increasing degree, so the first ones
+  // have the minimum degree of the residual matrix.
+  if (examined_col_.empty()) return false;
+  int min_degree = residual_size;
+  for (const ColIndex col : examined_col_) {
+    min_degree = std::min(min_degree, residual_matrix_non_zero_.ColDegree(col));
+  }
+  return min_degree >= switch_density * residual_size;
+}
+
+Status Markowitz::ComputeDenseResidualLU(RowPermutation* row_perm,
+                                         ColumnPermutation* col_perm,
+                                         int* index) {
+  SCOPED_TIME_STAT(&stats_);
+  dense_rows_.clear();
+  for (RowIndex row(0); row < row_perm->size(); ++row) {
+    if ((*row_perm)[row] == kInvalidRow) dense_rows_.push_back(row);
+  }
+  dense_cols_.clear();
+  for (ColIndex col(0); col < col_perm->size(); ++col) {
+    if ((*col_perm)[col] == kInvalidCol) dense_cols_.push_back(col);
+  }
+  const int size = dense_rows_.size();
+  DCHECK_EQ(size, dense_cols_.size());
+
+  // The dense residual matrix. Note that ComputeColumn() returns the residual
+  // part of the column, the part on the rows already pivoted is kept in
+  // permuted_upper_ and will be used below.
+  StrictITIVector<RowIndex, int> row_to_dense(row_perm->size(), -1);
+  for (int i = 0; i < size; ++i) row_to_dense[dense_rows_[i]] = i;
+  dense_matrix_.assign(static_cast<size_t>(size) * size, 0.0);
+  for (int j = 0; j < size; ++j) {
+    Fractional* const column = dense_matrix_.data() + size_t{j} * size;
+    for (const SparseColumn::Entry e :
+         ComputeColumn(*row_perm, dense_cols_[j])) {
+      DCHECK_NE(row_to_dense[e.row()], -1);
+      column[row_to_dense[e.row()]] = e.coefficient();
+    }
+  }
+
+  const Fractional singularity_threshold =
+      parameters_.markowitz_singularity_threshold();
+  int num_cols = size;
+  int k = 0;
+  while (k < num_cols) {
+    Fractional* const column_k = dense_matrix_.data() + size_t{k} * size;
+
+    // Partial pivoting: we take the entry of maximum magnitude.
+    int pivot = k;
+    Fractional max_magnitude = std::abs(column_k[k]);
+    for (int i = k + 1; i < size; ++i) {
+      const Fractional magnitude = std::abs(column_k[i]);
+      if (magnitude > max_magnitude) {
+        max_magnitude = magnitude;
+        pivot = i;
+      }
+    }
+    if (max_magnitude <= singularity_threshold) {
+      // This column depends on the previous ones. Move it at the end and only
+      // look at the other ones.
+      --num_cols;
+      std::swap_ranges(column_k, column_k + size,
+                       dense_matrix_.data() + size_t{num_cols} * size);
+      std::swap(dense_cols_[k], dense_cols_[num_cols]);
+      continue;
+    }
+
+    // Swap the rows k and pivot on the columns not yet processed.
+    if (pivot != k) {
+      std::swap(dense_rows_[k], dense_rows_[pivot]);
+      for (int j = k; j < num_cols; ++j) {
+        Fractional* const column = dense_matrix_.data() + size_t{j} * size;
+        std::swap(column[k], column[pivot]);
+      }
+    }
+    const Fractional pivot_coefficient = column_k[k];
+    const RowIndex pivot_row = dense_rows_[k];
+    const ColIndex pivot_col = dense_cols_[k];
+
+    // Column of L, it will be normalized by AddAndNormalizeTriangularColumn().
+    dense_column_.Clear();
+    for (int i = k; i < size; ++i) {
+      if (column_k[i] != 0.0) {
+        dense_column_.SetCoefficient(dense_rows_[i], column_k[i]);
+      }
+    }
+    lower_.AddAndNormalizeTriangularColumn(dense_column_, pivot_row,
+                                           pivot_coefficient);
+    permuted_lower_.ClearAndReleaseColumn(pivot_col);
+
+    // Column of U: the entries on the rows pivoted before the switch, and the
+    // one of the rows pivoted during the dense elimination.
+    dense_column_.Clear();
+    for (const SparseColumn::Entry e : permuted_upper_.column(pivot_col)) {
+      dense_column_.SetCoefficient(e.row(), e.coefficient());
+    }
+    for (int i = 0; i < k; ++i) {
+      if (column_k[i] != 0.0) {
+        dense_column_.SetCoefficient(dense_rows_[i], column_k[i]);
+      }
+    }
+    upper_.AddTriangularColumnWithGivenDiagonalEntry(dense_column_, pivot_row,
+                                                     pivot_coefficient);
+    permuted_upper_.ClearAndReleaseColumn(pivot_col);
+
+    // Trailing update. The inner loop is on contiguous memory so that it can
+    // be vectorized by the compiler.
+    const Fractional inverse_pivot = 1.0 / pivot_coefficient;
+    for (int i = k + 1; i < size; ++i) column_k[i] *= inverse_pivot;
+    for (int j = k + 1; j < num_cols; ++j) {
+      Fractional* const column = dense_matrix_.data() + size_t{j} * size;
+      const Fractional multiplier = column[k];
+      if (multiplier == 0.0) continue;
+      for (int i = k + 1; i < size; ++i) {
+        column[i] -= multiplier * column_k[i];
+      }
+    }
+    num_fp_operations_ += int64_t{size - k} * (num_cols - k);
+
+    (*col_perm)[pivot_col] = ColIndex(*index);
+    (*row_perm)[pivot_row] = RowIndex(*index);
+    ++(*index);
+    ++k;
+  }
+
+  if (num_cols < size) {
+    const std::string error_message =
+        absl::StrFormat("The matrix is singular! %d dependent columns in the "
+                        "dense part of the factorization.",
+                        size - num_cols);
+    VLOG(1) << "ERROR_LU: " << error_message;
+    return Status(Status::ERROR_LU, error_message);
+  }
+  return Status::OK();
+}
+
 void MatrixNonZeroPattern::Clear() {
   row_degree_.clear();
   col_degree_.clear();
@@ -325,11 +325,13 @@ class Markowitz {
           basis_residual_singleton_column_ratio(
               "basis_residual_singleton_column_ratio", this),
           pivots_without_fill_in_ratio("pivots_without_fill_in_ratio", this),
-          degree_two_pivot_columns("degree_two_pivot_columns", this) {}
+          degree_two_pivot_columns("degree_two_pivot_columns", this),
+          dense_residual_ratio("dense_residual_ratio", this) {}
     RatioDistribution basis_singleton_column_ratio;
     RatioDistribution basis_residual_singleton_column_ratio;
     RatioDistribution pivots_without_fill_in_ratio;
     RatioDistribution degree_two_pivot_columns;
+    RatioDistribution dense_residual_ratio;
   };
   Stats stats_;
 
@@ -398,6 +400,26 @@ class Markowitz {
   // Remove...() functions above.
   void UpdateResidualMatrix(RowIndex pivot_row, ColIndex pivot_col);
 
+  // Returns true if the residual matrix of the given size is dense enough to
+  // be factorized by ComputeDenseResidualLU(). This must be called just after
+  // a FindPivot() that returned a non-zero Markowitz number, since it uses
+  // the degrees of the columns it examined.
+  bool ShouldSwitchToDenseLU(int residual_size) const;
+
+  // Finishes the factorization by copying the residual matrix into a dense
+  // column-major matrix and doing a right-looking Gaussian elimination with
+  // partial pivoting on it. The resulting columns of L and U are appended to
+  // lower_ and upper_ exactly like the sparse steps do, so the rest of the
+  // code (and the triangular solves) do not need to know about this.
+  //
+  // If a column has no pivot above the singularity threshold, it is skipped
+  // and left unassigned in col_perm, and an ERROR_LU status is returned once
+  // the other columns are processed. The columns kept depend on the order in
+  // which they are eliminated, so they are not guaranteed to form a maximum
+  // set of independent columns.
+  ABSL_MUST_USE_RESULT Status ComputeDenseResidualLU(
+      RowPermutation* row_perm, ColumnPermutation* col_perm, int* index);
+
   // Pointer to the matrix to factorize.
   CompactSparseMatrixView const* basis_matrix_;
 
@@ -449,6 +471,14 @@ class Markowitz {
   // Number of floating point operations of the last factorization.
   int64_t num_fp_operations_;
 
+  // Used by ComputeDenseResidualLU(). The dense matrix is stored by columns,
+  // and dense_rows_/dense_cols_ give the original indices of its rows/columns
+  // (they are permuted during the elimination).
+  std::vector<Fractional> dense_matrix_;
+  std::vector<RowIndex> dense_rows_;
+  std::vector<ColIndex> dense_cols_;
+  SparseColumn dense_column_;
+
   DISALLOW_COPY_AND_ASSIGN(Markowitz);
 };
 
@@ -75,6 +75,7 @@ std::string ValidateParameters(const GlopParameters& params) {
 
   TEST_NON_NEGATIVE(crossover_bound_snapping_distance);
   TEST_NON_NEGATIVE(initial_condition_number_threshold);
+  TEST_NON_NEGATIVE(markowitz_dense_switch_density);
   TEST_NON_NEGATIVE(max_deterministic_time);
   TEST_NON_NEGATIVE(max_time_in_seconds);
   TEST_NON_NEGATIVE(max_valid_magnitude);
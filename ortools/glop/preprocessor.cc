@@ -85,6 +85,7 @@ bool MainLpPreprocessor::Run(LinearProgram* lp) {
   initial_num_rows_ = lp->num_constraints();
   initial_num_cols_ = lp->num_variables();
   initial_num_entries_ = lp->num_entries();
+  owned_executor_.SetNumThreads(parameters_.num_omp_threads());
   if (parameters_.use_preprocessing()) {
     RUN_PREPROCESSOR(ShiftVariableBoundsPreprocessor);
 
@@ -93,6 +94,7 @@ bool MainLpPreprocessor::Run(LinearProgram* lp) {
     const int kMaxNumPasses = 20;
     for (int i = 0; i < kMaxNumPasses; ++i) {
       const int old_stack_size = preprocessors_.size();
+      const double pass_start_time = time_limit_->GetElapsedTime();
       RUN_PREPROCESSOR(FixedVariablePreprocessor);
       RUN_PREPROCESSOR(SingletonPreprocessor);
       RUN_PREPROCESSOR(ForcingAndImpliedFreeConstraintPreprocessor);
@@ -101,6 +103,13 @@ bool MainLpPreprocessor::Run(LinearProgram* lp) {
       RUN_PREPROCESSOR(UnconstrainedVariablePreprocessor);
       RUN_PREPROCESSOR(DoubletonFreeColumnPreprocessor);
       RUN_PREPROCESSOR(DoubletonEqualityRowPreprocessor);
+      SOLVER_LOG(logger_,
+                 absl::StrFormat("%-45s: %d rows, %d columns. (%fs)",
+                                 absl::StrFormat("Presolve pass #%d", i),
+                                 lp->num_constraints().value(),
+                                 lp->num_variables().value(),
+                                 time_limit_->GetElapsedTime() -
+                                     pass_start_time));
 
       // Abort early if none of the preprocessors did something. Technically
       // this is true if none of the preprocessors above needs postsolving,
@@ -155,6 +164,7 @@ void MainLpPreprocessor::RunAndPushIfRelevant(
 
   const double start_time = time_limit->GetElapsedTime();
   preprocessor->SetTimeLimit(time_limit);
+  preprocessor->SetShardedExecutor(&owned_executor_);
 
   // No need to run the preprocessor if the lp is empty.
   // TODO(user): without this test, the code is failing as of 2013-03-18.
@@ -497,8 +507,10 @@ struct ColumnWithRepresentativeAndScaledCost {
 bool ProportionalColumnPreprocessor::Run(LinearProgram* lp) {
   SCOPED_INSTRUCTION_COUNT(time_limit_);
   RETURN_VALUE_IF_NULL(lp, false);
-  ColMapping mapping = FindProportionalColumns(
-      lp->GetSparseMatrix(), parameters_.preprocessor_zero_tolerance());
+  ColMapping mapping =
+      FindProportionalColumns(lp->GetSparseMatrix(),
+                              parameters_.preprocessor_zero_tolerance(),
+                              executor_);
 
   // Compute some statistics and make each class representative point to itself
   // in the mapping. Also store the columns that are proportional to at least
@@ -870,7 +882,7 @@ bool ProportionalRowPreprocessor::Run(LinearProgram* lp) {
   // itself for the loop below. TODO(user): Already return such a mapping from
   // FindProportionalColumns()?
   ColMapping mapping = FindProportionalColumns(
-      transpose, parameters_.preprocessor_zero_tolerance());
+      transpose, parameters_.preprocessor_zero_tolerance(), executor_);
   DenseBooleanColumn is_a_representative(num_rows, false);
   int num_proportional_rows = 0;
   for (RowIndex row(0); row < num_rows; ++row) {
@@ -1125,25 +1137,65 @@ bool ForcingAndImpliedFreeConstraintPreprocessor::Run(LinearProgram* lp) {
   RETURN_VALUE_IF_NULL(lp, false);
   const RowIndex num_rows = lp->num_constraints();
 
-  // Compute the implied constraint bounds from the variable bounds.
+  // Compute the implied constraint bounds from the variable bounds. If the
+  // previous preprocessors kept the transpose up to date, this is done row by
+  // row on it, so that the rows can be split in independent shards. Otherwise
+  // we accumulate column by column rather than recomputing the transpose at
+  // each pass. The entries of a transposed row are sorted by column, so the
+  // sums are the same either way.
   DenseColumn implied_lower_bounds(num_rows, 0);
   DenseColumn implied_upper_bounds(num_rows, 0);
-  const ColIndex num_cols = lp->num_variables();
   StrictITIVector<RowIndex, int> row_degree(num_rows, 0);
-  for (ColIndex col(0); col < num_cols; ++col) {
-    const Fractional lower = lp->variable_lower_bounds()[col];
-    const Fractional upper = lp->variable_upper_bounds()[col];
-    for (const SparseColumn::Entry e : lp->GetSparseColumn(col)) {
-      const RowIndex row = e.row();
-      const Fractional coeff = e.coefficient();
-      if (coeff > 0.0) {
-        implied_lower_bounds[row] += lower * coeff;
-        implied_upper_bounds[row] += upper * coeff;
-      } else {
-        implied_lower_bounds[row] += upper * coeff;
-        implied_upper_bounds[row] += lower * coeff;
+  const ColIndex num_cols = lp->num_variables();
+  const SparseMatrix* transpose = lp->IsTransposeMatrixConsistent()
+                                      ? &lp->GetTransposeSparseMatrix()
+                                      : nullptr;
+  const DenseRow& variable_lower_bounds = lp->variable_lower_bounds();
+  const DenseRow& variable_upper_bounds = lp->variable_upper_bounds();
+  if (transpose != nullptr) {
+    const int64_t kMinRowsPerShard = 4096;
+    ParallelFor(
+        num_rows.value(), kMinRowsPerShard,
+        [&](int shard, int64_t begin, int64_t end) {
+          for (RowIndex row(begin); row < RowIndex(end); ++row) {
+            const SparseColumn& transposed_row =
+                transpose->column(RowToColIndex(row));
+            Fractional implied_lower = 0.0;
+            Fractional implied_upper = 0.0;
+            for (const SparseColumn::Entry e : transposed_row) {
+              const ColIndex col = RowToColIndex(e.row());
+              const Fractional lower = variable_lower_bounds[col];
+              const Fractional upper = variable_upper_bounds[col];
+              const Fractional coeff = e.coefficient();
+              if (coeff > 0.0) {
+                implied_lower += lower * coeff;
+                implied_upper += upper * coeff;
+              } else {
+                implied_lower += upper * coeff;
+                implied_upper += lower * coeff;
+              }
+            }
+            implied_lower_bounds[row] = implied_lower;
+            implied_upper_bounds[row] = implied_upper;
+            row_degree[row] = transposed_row.num_entries().value();
+          }
+        });
+  } else {
+    for (ColIndex col(0); col < num_cols; ++col) {
+      const Fractional lower = variable_lower_bounds[col];
+      const Fractional upper = variable_upper_bounds[col];
+      for (const SparseColumn::Entry e : lp->GetSparseColumn(col)) {
+        const RowIndex row = e.row();
+        const Fractional coeff = e.coefficient();
+        if (coeff > 0.0) {
+          implied_lower_bounds[row] += lower * coeff;
+          implied_upper_bounds[row] += upper * coeff;
+        } else {
+          implied_lower_bounds[row] += upper * coeff;
+          implied_upper_bounds[row] += lower * coeff;
+        }
+        ++row_degree[row];
       }
-      ++row_degree[row];
     }
   }
 
@@ -1153,6 +1205,10 @@ bool ForcingAndImpliedFreeConstraintPreprocessor::Run(LinearProgram* lp) {
   int num_forcing_constraints = 0;
   is_forcing_up_.assign(num_rows, false);
   DenseBooleanColumn is_forcing_down(num_rows, false);
+  std::vector<RowIndex> forcing_rows;
+  // All the rows are checked, since the preprocessors do not report which
+  // bounds they changed. This is linear in the number of rows, which is small
+  // next to the computation of the implied bounds above.
   for (RowIndex row(0); row < num_rows; ++row) {
     if (row_degree[row] == 0) continue;
     Fractional lower = lp->constraint_lower_bounds()[row];
@@ -1175,12 +1231,14 @@ bool ForcingAndImpliedFreeConstraintPreprocessor::Run(LinearProgram* lp) {
     if (IsSmallerWithinPreprocessorZeroTolerance(implied_upper_bounds[row],
                                                  lower)) {
       is_forcing_down[row] = true;
+      forcing_rows.push_back(row);
       ++num_forcing_constraints;
       continue;
     }
     if (IsSmallerWithinPreprocessorZeroTolerance(upper,
                                                  implied_lower_bounds[row])) {
       is_forcing_up_[row] = true;
+      forcing_rows.push_back(row);
       ++num_forcing_constraints;
       continue;
     }
@@ -1208,7 +1266,29 @@ bool ForcingAndImpliedFreeConstraintPreprocessor::Run(LinearProgram* lp) {
     VLOG(1) << num_forcing_constraints << " forcing constraints.";
     lp_is_maximization_problem_ = lp->IsMaximizationProblem();
     costs_.resize(num_cols, 0.0);
-    for (ColIndex col(0); col < num_cols; ++col) {
+
+    // Only the columns of the forcing rows can be forced. They are processed
+    // in increasing order, like a scan of all the columns would. Without the
+    // transpose, we just scan all the columns.
+    std::vector<ColIndex> candidate_columns;
+    if (transpose != nullptr) {
+      for (const RowIndex row : forcing_rows) {
+        for (const SparseColumn::Entry e :
+             transpose->column(RowToColIndex(row))) {
+          candidate_columns.push_back(RowToColIndex(e.row()));
+        }
+      }
+      std::sort(candidate_columns.begin(), candidate_columns.end());
+      candidate_columns.erase(
+          std::unique(candidate_columns.begin(), candidate_columns.end()),
+          candidate_columns.end());
+    } else {
+      candidate_columns.reserve(num_cols.value());
+      for (ColIndex col(0); col < num_cols; ++col) {
+        candidate_columns.push_back(col);
+      }
+    }
+    for (const ColIndex col : candidate_columns) {
       const SparseColumn& column = lp->GetSparseColumn(col);
       const Fractional lower = lp->variable_lower_bounds()[col];
       const Fractional upper = lp->variable_upper_bounds()[col];
@@ -1267,16 +1347,14 @@ bool ForcingAndImpliedFreeConstraintPreprocessor::Run(LinearProgram* lp) {
         costs_[col] = lp->objective_coefficients()[col];
       }
     }
-    for (RowIndex row(0); row < num_rows; ++row) {
+    for (const RowIndex row : forcing_rows) {
       // In theory, an M exists such that for any magnitude >= M, we will be at
       // an optimal solution. However, because of numerical errors, if the value
       // is too large, it causes problem when verifying the solution. So we
       // select the smallest such M (at least a resonably small one) during
       // postsolve. It is the reason why we need to store the columns that were
       // fixed.
-      if (is_forcing_down[row] || is_forcing_up_[row]) {
-        row_deletion_helper_.MarkRowForDeletion(row);
-      }
+      row_deletion_helper_.MarkRowForDeletion(row);
     }
   }
 
@@ -3852,6 +3930,7 @@ bool ScalingPreprocessor::Run(LinearProgram* lp) {
 
   // See the doc of these functions for more details.
   // It is important to call Scale() before the other two.
+  scaler_.SetNumThreads(parameters_.num_omp_threads());
   Scale(lp, &scaler_, parameters_.scaling_method());
   cost_scaling_factor_ = lp->ScaleObjective(parameters_.cost_scaling());
   bound_scaling_factor_ = lp->ScaleBounds();
@@ -21,6 +21,7 @@
 #ifndef OR_TOOLS_GLOP_PREPROCESSOR_H_
 #define OR_TOOLS_GLOP_PREPROCESSOR_H_
 
+#include <cstdint>
 #include <deque>
 #include <memory>
 #include <string>
@@ -33,6 +34,7 @@
 #include "ortools/lp_data/lp_data.h"
 #include "ortools/lp_data/lp_types.h"
 #include "ortools/lp_data/matrix_scaler.h"
+#include "ortools/lp_data/sharded_executor.h"
 
 namespace operations_research {
 namespace glop {
@@ -78,7 +80,24 @@ class Preprocessor {
 
   void SetTimeLimit(TimeLimit* time_limit) { time_limit_ = time_limit; }
 
+  // Preprocessors with parallel detection passes use this executor. If none is
+  // set, everything runs in the calling thread. The result does not depend on
+  // the number of threads of the executor.
+  void SetShardedExecutor(ShardedExecutor* executor) { executor_ = executor; }
+
  protected:
+  // Calls function(shard, begin, end) over shards of [0, size) with executor_,
+  // or once over the whole range if there is no executor.
+  template <typename Function>
+  void ParallelFor(int64_t size, int64_t min_shard_size,
+                   const Function& function) {
+    if (executor_ == nullptr) {
+      function(0, 0, size);
+    } else {
+      executor_->ParallelFor(size, min_shard_size, function);
+    }
+  }
+
   // Returns true if a is less than b (or slighlty greater than b with a given
   // tolerance).
   bool IsSmallerWithinFeasibilityTolerance(Fractional a, Fractional b) const {
@@ -97,6 +116,7 @@ class Preprocessor {
   bool in_mip_context_;
   std::unique_ptr<TimeLimit> infinite_time_limit_;
   TimeLimit* time_limit_;
+  ShardedExecutor* executor_ = nullptr;
 };
 
 // --------------------------------------------------------
@@ -132,6 +152,10 @@ class MainLpPreprocessor : public Preprocessor {
   // Stack of preprocessors currently applied to the lp that needs postsolve.
   std::vector<std::unique_ptr<Preprocessor>> preprocessors_;
 
+  // Shared by all the preprocessors run by this one. Sized from
+  // num_omp_threads.
+  ShardedExecutor owned_executor_;
+
   // Helpers for logging during presolve.
   SolverLogger default_logger_;
   SolverLogger* logger_ = &default_logger_;
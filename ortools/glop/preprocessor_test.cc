@@ -0,0 +1,198 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/glop/preprocessor.h"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "absl/random/distributions.h"
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+#include "ortools/glop/parameters.pb.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/lp_data/sharded_executor.h"
+
+namespace operations_research {
+namespace glop {
+namespace {
+
+constexpr int kNumRows = 20000;
+constexpr int kNumCols = 25000;
+
+// A feasible problem, large enough for the row and column passes of the
+// preprocessors to be split in several shards. The variables are in [0, u],
+// and a tenth of them are zero in the feasible solution. The constraints are
+// ranges or equalities around the activity of that solution, and:
+// - a tenth of them only have positive coefficients on variables that are zero
+//   in the solution, and an upper bound of zero, so they are forcing,
+// - a tenth of them have bounds far from their implied bounds, so they are
+//   implied free,
+// - some of them are twice a previous constraint, and some of the columns
+//   are a multiple of a previous column, so they are proportional.
+void BuildRandomLp(std::mt19937* random, LinearProgram* lp) {
+  std::vector<Fractional> solution;
+  std::vector<ColIndex> zero_cols;
+  for (int i = 0; i < kNumCols; ++i) {
+    const ColIndex col = lp->CreateNewVariable();
+    lp->SetVariableBounds(col, 0.0, absl::Uniform<int>(*random, 1, 11));
+    lp->SetObjectiveCoefficient(col, absl::Uniform<int>(*random, -5, 6));
+    if (absl::Bernoulli(*random, 0.1)) {
+      solution.push_back(0.0);
+      zero_cols.push_back(col);
+    } else {
+      solution.push_back(absl::Uniform<int>(
+          *random, 0, lp->variable_upper_bounds()[col] + 1));
+    }
+  }
+
+  std::vector<std::vector<std::pair<ColIndex, Fractional>>> rows;
+  for (int i = 0; i < kNumRows; ++i) {
+    std::vector<std::pair<ColIndex, Fractional>> terms;
+    const bool proportional = !rows.empty() && absl::Bernoulli(*random, 0.03);
+    const bool forcing = !proportional && absl::Bernoulli(*random, 0.1);
+    if (proportional) {
+      terms = rows[absl::Uniform<int>(*random, 0, rows.size())];
+      for (auto& [col, coefficient] : terms) coefficient *= 2.0;
+    } else {
+      const int num_terms = absl::Uniform<int>(*random, 2, 7);
+      for (int j = 0; j < num_terms; ++j) {
+        if (forcing) {
+          terms.push_back(
+              {zero_cols[absl::Uniform<int>(*random, 0, zero_cols.size())],
+               absl::Uniform<int>(*random, 1, 6)});
+        } else {
+          const int coefficient = absl::Uniform<int>(*random, 1, 6);
+          terms.push_back({ColIndex(absl::Uniform<int>(*random, 0, kNumCols)),
+                           absl::Bernoulli(*random, 0.5) ? coefficient
+                                                         : -coefficient});
+        }
+      }
+    }
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end(),
+                            [](const auto& a, const auto& b) {
+                              return a.first == b.first;
+                            }),
+                terms.end());
+    Fractional activity = 0.0;
+    const RowIndex row = lp->CreateNewConstraint();
+    for (const auto& [col, coefficient] : terms) {
+      lp->SetCoefficient(row, col, coefficient);
+      activity += coefficient * solution[col.value()];
+    }
+    if (forcing) {
+      lp->SetConstraintBounds(row, -kInfinity, 0.0);
+    } else if (absl::Bernoulli(*random, 0.1)) {
+      lp->SetConstraintBounds(row, -1e6, 1e6);
+    } else if (absl::Bernoulli(*random, 0.5)) {
+      lp->SetConstraintBounds(row, activity, activity);
+    } else {
+      lp->SetConstraintBounds(row, activity - absl::Uniform<int>(*random, 0, 5),
+                              activity + absl::Uniform<int>(*random, 0, 5));
+    }
+    rows.push_back(std::move(terms));
+  }
+
+  for (int i = 0; i < kNumCols / 50; ++i) {
+    const ColIndex col = lp->CreateNewVariable();
+    const ColIndex other(absl::Uniform<int>(*random, 0, kNumCols));
+    lp->SetVariableBounds(col, 0.0, lp->variable_upper_bounds()[other]);
+    lp->SetObjectiveCoefficient(col, 3.0 * lp->objective_coefficients()[other]);
+    for (const SparseColumn::Entry e : lp->GetSparseColumn(other)) {
+      lp->SetCoefficient(e.row(), col, 3.0 * e.coefficient());
+    }
+  }
+  lp->CleanUp();
+}
+
+// Checks that the two problems are exactly the same.
+void ExpectSameLp(const LinearProgram& lp, const LinearProgram& expected) {
+  ASSERT_EQ(lp.num_constraints(), expected.num_constraints());
+  ASSERT_EQ(lp.num_variables(), expected.num_variables());
+  EXPECT_EQ(lp.constraint_lower_bounds(), expected.constraint_lower_bounds());
+  EXPECT_EQ(lp.constraint_upper_bounds(), expected.constraint_upper_bounds());
+  EXPECT_EQ(lp.variable_lower_bounds(), expected.variable_lower_bounds());
+  EXPECT_EQ(lp.variable_upper_bounds(), expected.variable_upper_bounds());
+  EXPECT_EQ(lp.objective_coefficients(), expected.objective_coefficients());
+  EXPECT_EQ(lp.objective_offset(), expected.objective_offset());
+  EXPECT_TRUE(lp.GetSparseMatrix().Equals(expected.GetSparseMatrix(),
+                                          /*tolerance=*/0.0));
+}
+
+// The preprocessors only split their work in shards whose results do not
+// depend on the number of shards, so the presolved problem is exactly the
+// same with any number of threads.
+TEST(MainLpPreprocessorTest, DoesNotDependOnTheNumberOfThreads) {
+  LinearProgram expected;
+  for (const int num_threads : {1, 2, 4, 8}) {
+    std::mt19937 random(12345);
+    LinearProgram lp;
+    BuildRandomLp(&random, &lp);
+    GlopParameters parameters;
+    parameters.set_num_omp_threads(num_threads);
+    MainLpPreprocessor preprocessor(&parameters);
+    preprocessor.Run(&lp);
+    ASSERT_EQ(preprocessor.status(), ProblemStatus::INIT);
+    if (num_threads == 1) {
+      // Make sure the preprocessors did something.
+      EXPECT_LT(lp.num_constraints(), RowIndex(kNumRows * 9 / 10));
+      expected.PopulateFromLinearProgram(lp);
+      continue;
+    }
+    SCOPED_TRACE(absl::StrCat(num_threads, " threads"));
+    ExpectSameLp(lp, expected);
+  }
+}
+
+// The implied bounds are computed from the transpose when it is up to date,
+// and column by column otherwise. Both give the same sums, so the result
+// depends neither on the state of the transpose nor on the number of threads.
+TEST(ForcingAndImpliedFreeConstraintPreprocessorTest,
+     DoesNotDependOnTheTransposeNorOnTheNumberOfThreads) {
+  GlopParameters parameters;
+  LinearProgram expected;
+  for (const bool use_transpose : {false, true}) {
+    for (const int num_threads : {1, 4}) {
+      std::mt19937 random(12345);
+      LinearProgram lp;
+      BuildRandomLp(&random, &lp);
+      if (use_transpose) {
+        lp.GetTransposeSparseMatrix();
+      } else {
+        lp.ClearTransposeMatrix();
+      }
+      ShardedExecutor executor;
+      executor.SetNumThreads(num_threads);
+      ForcingAndImpliedFreeConstraintPreprocessor preprocessor(&parameters);
+      preprocessor.SetShardedExecutor(&executor);
+      EXPECT_TRUE(preprocessor.Run(&lp));
+      ASSERT_EQ(preprocessor.status(), ProblemStatus::INIT);
+      if (!use_transpose && num_threads == 1) {
+        EXPECT_LT(lp.num_constraints(), RowIndex(kNumRows * 95 / 100));
+        expected.PopulateFromLinearProgram(lp);
+        continue;
+      }
+      SCOPED_TRACE(absl::StrCat("use_transpose ", use_transpose, ", ",
+                                num_threads, " threads"));
+      ExpectSameLp(lp, expected);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace glop
+}  // namespace operations_research
@@ -14,14 +14,13 @@
 #include "ortools/glop/reduced_costs.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <random>
-
-#ifdef OMP
-#include <omp.h>
-#endif
+#include <vector>
 
 #include "ortools/lp_data/lp_utils.h"
+#include "ortools/lp_data/sharded_executor.h"
 
 namespace operations_research {
 namespace glop {
@@ -31,12 +30,13 @@ ReducedCosts::ReducedCosts(const CompactSparseMatrix& matrix,
                            const RowToColMapping& basis,
                            const VariablesInfo& variables_info,
                            const BasisFactorization& basis_factorization,
-                           absl::BitGenRef random)
+                           ShardedExecutor* executor, absl::BitGenRef random)
     : matrix_(matrix),
       objective_(objective),
       basis_(basis),
       variables_info_(variables_info),
       basis_factorization_(basis_factorization),
+      executor_(executor),
       random_(random),
       parameters_(),
       stats_(),
@@ -359,49 +359,30 @@ void ReducedCosts::ComputeReducedCosts() {
 
   reduced_costs_.resize(num_cols, 0.0);
   const DenseBitRow& is_basic = variables_info_.GetIsBasicBitRow();
-#ifdef OMP
-  const int num_omp_threads = parameters_.num_omp_threads();
-#else
-  const int num_omp_threads = 1;
-#endif
-  if (num_omp_threads == 1) {
-    for (ColIndex col(0); col < num_cols; ++col) {
-      reduced_costs_[col] = objective_[col] + cost_perturbations_[col] -
-                            matrix_.ColumnScalarProduct(
-                                col, basic_objective_left_inverse_.values);
-
-      // We also compute the dual residual error y.B - c_B.
-      if (is_basic.IsSet(col)) {
-        dual_residual_error =
-            std::max(dual_residual_error, std::abs(reduced_costs_[col]));
-      }
-    }
-  } else {
-#ifdef OMP
-    // In the multi-threaded case, perform the same computation as in the
-    // single-threaded case above.
-    std::vector<Fractional> thread_local_dual_residual_error(num_omp_threads,
-                                                             0.0);
-    const int parallel_loop_size = num_cols.value();
-#pragma omp parallel for num_threads(num_omp_threads)
-    for (int i = 0; i < parallel_loop_size; i++) {
-      const ColIndex col(i);
-      reduced_costs_[col] = objective_[col] + objective_perturbation_[col] -
-                            matrix_.ColumnScalarProduct(
-                                col, basic_objective_left_inverse_.values);
-
-      if (is_basic.IsSet(col)) {
-        thread_local_dual_residual_error[omp_get_thread_num()] =
-            std::max(thread_local_dual_residual_error[omp_get_thread_num()],
-                     std::abs(reduced_costs_[col]));
-      }
-    }
-    // end of omp parallel for
-    for (int i = 0; i < num_omp_threads; i++) {
-      dual_residual_error =
-          std::max(dual_residual_error, thread_local_dual_residual_error[i]);
-    }
-#endif  // OMP
+
+  // Each column is independent, so the result does not depend on the number
+  // of shards. The dual residual error is a max, which is also exact.
+  const int64_t kMinColumnsPerShard = 1 << 14;
+  std::vector<Fractional> shard_dual_residual_error(
+      executor_->NumShards(num_cols.value(), kMinColumnsPerShard), 0.0);
+  executor_->ParallelFor(
+      num_cols.value(), kMinColumnsPerShard,
+      [&](int shard, int64_t begin, int64_t end) {
+        Fractional error = 0.0;
+        for (ColIndex col(begin); col < ColIndex(end); ++col) {
+          reduced_costs_[col] = objective_[col] + cost_perturbations_[col] -
+                                matrix_.ColumnScalarProduct(
+                                    col, basic_objective_left_inverse_.values);
+
+          // We also compute the dual residual error y.B - c_B.
+          if (is_basic.IsSet(col)) {
+            error = std::max(error, std::abs(reduced_costs_[col]));
+          }
+        }
+        shard_dual_residual_error[shard] = error;
+      });
+  for (const Fractional error : shard_dual_residual_error) {
+    dual_residual_error = std::max(dual_residual_error, error);
   }
 
   deterministic_time_ +=
@@ -477,9 +458,19 @@ void ReducedCosts::UpdateReducedCosts(ColIndex entering_col,
   const Fractional new_leaving_reduced_cost = entering_reduced_cost / -pivot;
   auto rc = reduced_costs_.view();
   auto update_coeffs = update_row->GetCoefficients().const_view();
-  for (const ColIndex col : update_row->GetNonZeroPositions()) {
-    rc[col] += new_leaving_reduced_cost * update_coeffs[col];
-  }
+  const absl::Span<const ColIndex> positions =
+      update_row->GetNonZeroPositions();
+
+  // The positions are distinct, so the shards write disjoint entries.
+  const int64_t kMinPositionsPerShard = 1 << 15;
+  executor_->ParallelFor(positions.size(), kMinPositionsPerShard,
+                         [&](int /*shard*/, int64_t begin, int64_t end) {
+                           for (int64_t i = begin; i < end; ++i) {
+                             const ColIndex col = positions[i];
+                             rc[col] +=
+                                 new_leaving_reduced_cost * update_coeffs[col];
+                           }
+                         });
   rc[leaving_col] = new_leaving_reduced_cost;
 
   // In the dual, since we compute the update before selecting the entering
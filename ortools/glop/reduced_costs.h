@@ -28,6 +28,7 @@
 #include "ortools/lp_data/lp_data.h"
 #include "ortools/lp_data/lp_types.h"
 #include "ortools/lp_data/scattered_vector.h"
+#include "ortools/lp_data/sharded_executor.h"
 #include "ortools/util/stats.h"
 
 namespace operations_research {
@@ -56,7 +57,7 @@ class ReducedCosts {
                const RowToColMapping& basis,
                const VariablesInfo& variables_info,
                const BasisFactorization& basis_factorization,
-               absl::BitGenRef random);
+               ShardedExecutor* executor, absl::BitGenRef random);
 
   // This type is neither copyable nor movable.
   ReducedCosts(const ReducedCosts&) = delete;
@@ -240,6 +241,7 @@ class ReducedCosts {
   const RowToColMapping& basis_;
   const VariablesInfo& variables_info_;
   const BasisFactorization& basis_factorization_;
+  ShardedExecutor* executor_;
   absl::BitGenRef random_;
 
   // Internal data.
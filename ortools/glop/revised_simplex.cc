@@ -80,8 +80,15 @@ class Cleanup {
 
 constexpr const uint64_t kDeterministicSeed = 42;
 
-RevisedSimplex::RevisedSimplex()
+RevisedSimplex::RevisedSimplex() : RevisedSimplex(nullptr) {}
+
+RevisedSimplex::RevisedSimplex(const RevisedSimplex* matrix_owner)
     : problem_status_(ProblemStatus::INIT),
+      matrix_is_shared_(matrix_owner != nullptr),
+      compact_matrix_(matrix_is_shared_ ? matrix_owner->compact_matrix_
+                                        : owned_compact_matrix_),
+      transposed_matrix_(matrix_is_shared_ ? matrix_owner->transposed_matrix_
+                                           : owned_transposed_matrix_),
       objective_(),
       basis_(),
       variable_name_(),
@@ -89,18 +96,18 @@ RevisedSimplex::RevisedSimplex()
       error_(),
       deterministic_random_(kDeterministicSeed),
       random_(deterministic_random_),
-      basis_factorization_(&compact_matrix_, &basis_),
+      basis_factorization_(&compact_matrix_, &basis_, &sharded_executor_),
       variables_info_(compact_matrix_),
       primal_edge_norms_(compact_matrix_, variables_info_,
                          basis_factorization_),
-      dual_edge_norms_(basis_factorization_),
+      dual_edge_norms_(basis_factorization_, &sharded_executor_),
       dual_prices_(random_),
       variable_values_(parameters_, compact_matrix_, basis_, variables_info_,
                        basis_factorization_, &dual_edge_norms_, &dual_prices_),
       update_row_(compact_matrix_, transposed_matrix_, variables_info_, basis_,
-                  basis_factorization_),
+                  basis_factorization_, &sharded_executor_),
       reduced_costs_(compact_matrix_, objective_, basis_, variables_info_,
-                     basis_factorization_, random_),
+                     basis_factorization_, &sharded_executor_, random_),
       entering_variable_(variables_info_, random_, &reduced_costs_),
       primal_prices_(random_, variables_info_, &primal_edge_norms_,
                      &reduced_costs_),
@@ -934,6 +941,26 @@ bool RevisedSimplex::InitializeMatrixAndTestIfUnchanged(
   DCHECK(only_change_is_new_rows != nullptr);
   DCHECK(only_change_is_new_cols != nullptr);
   DCHECK(num_new_cols != nullptr);
+
+  // This is the only adaptation we need for the test below.
+  const ColIndex lp_first_slack =
+      lp_is_in_equation_form ? lp.GetFirstSlackVariable() : lp.num_variables();
+
+  // A shared matrix is read-only and is not compared with the one of the lp,
+  // we only need to initialize the dimensions on the first Solve().
+  if (matrix_is_shared_) {
+    DCHECK_EQ(lp_first_slack + RowToColIndex(lp.num_constraints()),
+              compact_matrix_.num_cols());
+    DCHECK(!parameters_.use_transposed_matrix() ||
+           !transposed_matrix_.IsEmpty());
+    const bool matrix_is_unchanged = num_rows_ == lp.num_constraints() &&
+                                     first_slack_col_ == lp_first_slack;
+    first_slack_col_ = lp_first_slack;
+    num_rows_ = lp.num_constraints();
+    num_cols_ = compact_matrix_.num_cols();
+    return matrix_is_unchanged;
+  }
+
   DCHECK_EQ(num_cols_, compact_matrix_.num_cols());
   DCHECK_EQ(num_rows_, compact_matrix_.num_rows());
 
@@ -942,10 +969,6 @@ bool RevisedSimplex::InitializeMatrixAndTestIfUnchanged(
       AreFirstColumnsAndRowsExactlyEquals(
           num_rows_, first_slack_col_, lp.GetSparseMatrix(), compact_matrix_);
 
-  // This is the only adaptation we need for the test below.
-  const ColIndex lp_first_slack =
-      lp_is_in_equation_form ? lp.GetFirstSlackVariable() : lp.num_variables();
-
   // Test if the matrix is unchanged, and if yes, just returns true. Note that
   // this doesn't check the columns corresponding to the slack variables,
   // because they were checked by lp.IsInEquationForm() when Solve() was called.
@@ -957,10 +980,10 @@ bool RevisedSimplex::InitializeMatrixAndTestIfUnchanged(
     // really a big overhead.
     if (parameters_.use_transposed_matrix()) {
       if (transposed_matrix_.IsEmpty()) {
-        transposed_matrix_.PopulateFromTranspose(compact_matrix_);
+        owned_transposed_matrix_.PopulateFromTranspose(compact_matrix_);
       }
     } else {
-      transposed_matrix_.Reset(RowIndex(0));
+      owned_transposed_matrix_.Reset(RowIndex(0));
     }
     return true;
   }
@@ -990,14 +1013,16 @@ bool RevisedSimplex::InitializeMatrixAndTestIfUnchanged(
   if (lp_is_in_equation_form) {
     // TODO(user): This can be sped up by removing the MatrixView, but then
     // this path will likely go away.
-    compact_matrix_.PopulateFromMatrixView(MatrixView(lp.GetSparseMatrix()));
+    owned_compact_matrix_.PopulateFromMatrixView(
+        MatrixView(lp.GetSparseMatrix()));
   } else {
-    compact_matrix_.PopulateFromSparseMatrixAndAddSlacks(lp.GetSparseMatrix());
+    owned_compact_matrix_.PopulateFromSparseMatrixAndAddSlacks(
+        lp.GetSparseMatrix());
   }
   if (parameters_.use_transposed_matrix()) {
-    transposed_matrix_.PopulateFromTranspose(compact_matrix_);
+    owned_transposed_matrix_.PopulateFromTranspose(compact_matrix_);
   } else {
-    transposed_matrix_.Reset(RowIndex(0));
+    owned_transposed_matrix_.Reset(RowIndex(0));
   }
   return false;
 }
@@ -3601,6 +3626,7 @@ void RevisedSimplex::SetParameters(const GlopParameters& parameters) {
 
 void RevisedSimplex::PropagateParameters() {
   SCOPED_TIME_STAT(&function_stats_);
+  sharded_executor_.SetNumThreads(parameters_.num_omp_threads());
   basis_factorization_.SetParameters(parameters_);
   entering_variable_.SetParameters(parameters_);
   reduced_costs_.SetParameters(parameters_);
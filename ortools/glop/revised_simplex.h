@@ -112,6 +112,7 @@
 #include "ortools/lp_data/lp_print_utils.h"
 #include "ortools/lp_data/lp_types.h"
 #include "ortools/lp_data/scattered_vector.h"
+#include "ortools/lp_data/sharded_executor.h"
 #include "ortools/lp_data/sparse_row.h"
 #include "ortools/util/logging.h"
 #include "ortools/util/random_engine.h"
@@ -125,6 +126,17 @@ class RevisedSimplex {
  public:
   RevisedSimplex();
 
+  // Advanced usage. This simplex reads the matrix (and its transpose) of
+  // matrix_owner instead of keeping its own copy, so that several simplexes
+  // can solve variants of the same problem in parallel. matrix_owner must have
+  // solved a problem with the same use_transposed_matrix parameter, outlive
+  // this class and not solve anything else while this class is used.
+  //
+  // The LinearProgram given to Solve() must have the dimensions of the one
+  // solved by matrix_owner. Its matrix is not read, so it can be empty, unless
+  // the problem is in equation form (see Solve()).
+  explicit RevisedSimplex(const RevisedSimplex* matrix_owner);
+
   // This type is neither copyable nor movable.
   RevisedSimplex(const RevisedSimplex&) = delete;
   RevisedSimplex& operator=(const RevisedSimplex&) = delete;
@@ -644,11 +656,19 @@ class RevisedSimplex {
   // it's as fast as std::unique_ptr as long as the size is properly reserved
   // beforehand.
 
-  // Compact version of the matrix given to Solve().
-  CompactSparseMatrix compact_matrix_;
+  // Compact version of the matrix given to Solve(), and its transpose. These
+  // are only used if the matrix is not shared with another simplex.
+  CompactSparseMatrix owned_compact_matrix_;
+  CompactSparseMatrix owned_transposed_matrix_;
+
+  // True if the matrix below is the one of another simplex.
+  const bool matrix_is_shared_;
+
+  // The matrix given to Solve(), in compact form.
+  const CompactSparseMatrix& compact_matrix_;
 
   // The transpose of compact_matrix_, it may be empty if it is not needed.
-  CompactSparseMatrix transposed_matrix_;
+  const CompactSparseMatrix& transposed_matrix_;
 
   // Stop the algorithm and report feasibility if:
   // - The primal simplex is used, the problem is primal-feasible and the
@@ -731,6 +751,11 @@ class RevisedSimplex {
   SolverLogger default_logger_;
   SolverLogger* logger_ = &default_logger_;
 
+  // Used to run the per-iteration column or row loops on
+  // parameters_.num_omp_threads() threads. This must be declared before the
+  // classes that use it.
+  ShardedExecutor sharded_executor_;
+
   // Representation of matrix B using eta matrices and LU decomposition.
   BasisFactorization basis_factorization_;
 
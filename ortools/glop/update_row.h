@@ -23,6 +23,7 @@
 #include "ortools/glop/variables_info.h"
 #include "ortools/lp_data/lp_types.h"
 #include "ortools/lp_data/scattered_vector.h"
+#include "ortools/lp_data/sharded_executor.h"
 #include "ortools/util/stats.h"
 
 namespace operations_research {
@@ -41,11 +42,13 @@ namespace glop {
 //     update_row[col] = (unit_{leaving_row} . B^{-1}) . A_col
 class UpdateRow {
  public:
-  // Takes references to the linear program data we need.
+  // Takes references to the linear program data we need. The executor is used
+  // to split the column-wise computation between threads.
   UpdateRow(const CompactSparseMatrix& matrix,
             const CompactSparseMatrix& transposed_matrix,
             const VariablesInfo& variables_info, const RowToColMapping& basis,
-            const BasisFactorization& basis_factorization);
+            const BasisFactorization& basis_factorization,
+            ShardedExecutor* executor);
 
   // This type is neither copyable nor movable.
   UpdateRow(const UpdateRow&) = delete;
@@ -127,6 +130,7 @@ class UpdateRow {
   const VariablesInfo& variables_info_;
   const RowToColMapping& basis_;
   const BasisFactorization& basis_factorization_;
+  ShardedExecutor* executor_;
 
   // Left inverse by B of a unit row. Its scalar product with a column 'a' of A
   // gives the value of the right inverse of 'a' on the 'leaving_row'.
@@ -142,6 +146,10 @@ class UpdateRow {
   DenseBitRow non_zero_position_set_;
   DenseRow coefficient_;
 
+  // Used by the multi-threaded ComputeUpdatesColumnWise(), see there.
+  std::vector<int64_t> shard_begins_;
+  std::vector<int64_t> shard_num_non_zeros_;
+
   // Boolean used to avoid recomputing many times the same thing.
   bool compute_update_row_;
   RowIndex left_inverse_computed_for_ = kInvalidRow;
@@ -0,0 +1,613 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#if defined(USE_GLOP) && defined(USE_PDLP)
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "google/protobuf/text_format.h"
+#include "ortools/base/logging.h"
+#include "ortools/base/threadpool.h"
+#include "ortools/glop/lp_solver.h"
+#include "ortools/glop/parameters.pb.h"
+#include "ortools/linear_solver/glop_utils.h"
+#include "ortools/linear_solver/linear_solver.h"
+#include "ortools/linear_solver/linear_solver.pb.h"
+#include "ortools/linear_solver/model_validator.h"
+#include "ortools/linear_solver/proto_solver/pdlp_proto_solver.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/lp_data/proto_utils.h"
+#include "ortools/pdlp/crossover.h"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/port/proto_utils.h"
+#include "ortools/util/lazy_mutable_copy.h"
+#include "ortools/util/time_limit.h"
+
+namespace operations_research {
+
+namespace {
+
+// The workers of the concurrent solve. The order only matters when none of
+// them returns a conclusive status, see the end of ConcurrentLpSolveProto().
+enum Worker { kDualSimplex = 0, kPrimalSimplex = 1, kPdlp = 2, kNumWorkers };
+
+const char* WorkerName(int worker) {
+  switch (worker) {
+    case kDualSimplex:
+      return "glop dual simplex";
+    case kPrimalSimplex:
+      return "glop primal simplex";
+    case kPdlp:
+      return "pdlp";
+  }
+  return "unknown";
+}
+
+// The statuses of the variables and constraints in an optimal basis, which
+// MPSolutionResponse has no field for. Empty when the basis is not known.
+struct LpBasis {
+  std::vector<MPSolver::BasisStatus> column_status;
+  std::vector<MPSolver::BasisStatus> row_status;
+};
+
+// A conclusive status ends the race.
+bool IsConclusive(MPSolverResponseStatus status) {
+  return status == MPSOLVER_OPTIMAL || status == MPSOLVER_INFEASIBLE ||
+         status == MPSOLVER_UNBOUNDED;
+}
+
+MPSolutionResponse GlopSolve(const MPModelProto& model,
+                             const glop::GlopParameters& parameters,
+                             TimeLimit* time_limit, LpBasis* basis) {
+  glop::LinearProgram lp;
+  glop::MPModelProtoToLinearProgram(model, &lp);
+  glop::LPSolver solver;
+  solver.SetParameters(parameters);
+  const glop::ProblemStatus status = solver.SolveWithTimeLimit(lp, time_limit);
+
+  // The MPSolver::ResultStatus values are the same as the corresponding
+  // MPSolverResponseStatus ones.
+  MPSolutionResponse response;
+  response.set_status(static_cast<MPSolverResponseStatus>(
+      GlopToMPSolverResultStatus(status)));
+  if (response.status() != MPSOLVER_OPTIMAL &&
+      response.status() != MPSOLVER_FEASIBLE) {
+    return response;
+  }
+  response.set_objective_value(solver.GetObjectiveValue());
+  for (const glop::Fractional value : solver.variable_values()) {
+    response.add_variable_value(value);
+  }
+  for (const glop::Fractional value : solver.dual_values()) {
+    response.add_dual_value(value);
+  }
+  for (const glop::Fractional value : solver.reduced_costs()) {
+    response.add_reduced_cost(value);
+  }
+  for (const glop::VariableStatus status : solver.variable_statuses()) {
+    basis->column_status.push_back(GlopToMPSolverVariableStatus(status));
+  }
+  for (const glop::ConstraintStatus status : solver.constraint_statuses()) {
+    basis->row_status.push_back(GlopToMPSolverConstraintStatus(status));
+  }
+  return response;
+}
+
+// Runs pdlp::Crossover() from the optimal primal and dual solutions found by
+// PDLP. Returns the basic solution, and fills its basis, if the simplex proved
+// its optimality, and returns nullopt otherwise.
+std::optional<MPSolutionResponse> Crossover(
+    const MPModelProto& model, const MPSolutionResponse& pdlp_response,
+    glop::GlopParameters parameters, TimeLimit* time_limit, LpBasis* basis) {
+  absl::StatusOr<pdlp::QuadraticProgram> lp =
+      pdlp::QpFromMpModelProto(model, /*relax_integer_variables=*/true);
+  if (!lp.ok() ||
+      pdlp_response.variable_value_size() != model.variable_size() ||
+      pdlp_response.dual_value_size() != model.constraint_size()) {
+    return std::nullopt;
+  }
+
+  // PdlpSolveProto() negates the dual values of the maximization problems,
+  // which are solved as minimization problems with objective_scaling_factor
+  // set to -1. The crossover works on the minimization problem.
+  const double objective_scaling_factor = lp->objective_scaling_factor;
+  Eigen::VectorXd primal_solution(model.variable_size());
+  for (int i = 0; i < model.variable_size(); ++i) {
+    primal_solution[i] = pdlp_response.variable_value(i);
+  }
+  Eigen::VectorXd dual_solution(model.constraint_size());
+  for (int i = 0; i < model.constraint_size(); ++i) {
+    dual_solution[i] = objective_scaling_factor * pdlp_response.dual_value(i);
+  }
+
+  if (!parameters.has_crossover_bound_snapping_distance()) {
+    parameters.set_crossover_bound_snapping_distance(1e-6);
+  }
+  absl::StatusOr<pdlp::CrossoverResult> crossover = pdlp::Crossover(
+      *lp, primal_solution, dual_solution, parameters, time_limit);
+  if (!crossover.ok()) {
+    VLOG(1) << "Skipping crossover: " << crossover.status();
+    return std::nullopt;
+  }
+  if (crossover->status != glop::ProblemStatus::OPTIMAL) return std::nullopt;
+
+  MPSolutionResponse response;
+  response.set_status(MPSOLVER_OPTIMAL);
+  double objective_value = model.objective_offset();
+  for (int i = 0; i < model.variable_size(); ++i) {
+    const double value = crossover->primal_solution[i];
+    objective_value += model.variable(i).objective_coefficient() * value;
+    response.add_variable_value(value);
+    response.add_reduced_cost(objective_scaling_factor *
+                              crossover->reduced_costs[i]);
+  }
+  for (int i = 0; i < model.constraint_size(); ++i) {
+    response.add_dual_value(objective_scaling_factor *
+                            crossover->dual_solution[i]);
+  }
+  response.set_objective_value(objective_value);
+  for (const glop::VariableStatus status : crossover->variable_statuses) {
+    basis->column_status.push_back(GlopToMPSolverVariableStatus(status));
+  }
+  for (const glop::ConstraintStatus status : crossover->constraint_statuses) {
+    basis->row_status.push_back(GlopToMPSolverConstraintStatus(status));
+  }
+  return response;
+}
+
+// Solves the LP of the request by racing, each in its own thread, the glop
+// primal simplex, the glop dual simplex and pdlp::PrimalDualHybridGradient.
+// Depending on the problem, one of these algorithms can easily be an order of
+// magnitude faster than the others, and there is no reliable way to know
+// which one in advance. Integer variables are relaxed.
+//
+// All the workers share the same time limit. As soon as one of them returns a
+// conclusive status (optimal, infeasible or unbounded), the others are stopped
+// and its result is returned. If PDLP wins with an optimal solution,
+// pdlp::Crossover() is run from its primal and dual solutions to return an
+// optimal basic solution, unless the time limit is reached before. The
+// status_str of the response indicates which algorithm produced it.
+//
+// The solver_specific_parameters of the request, if any, must be GlopParameters
+// in text format. They are used by both simplex workers, except for
+// use_dual_simplex which is overridden, and by the crossover. PDLP uses its
+// default parameters.
+//
+// If basis is not null, it is set to the basis of the returned solution when
+// it comes from a simplex or from the crossover, and cleared otherwise.
+MPSolutionResponse ConcurrentLpSolveProto(const MPModelRequest& request,
+                                          std::atomic<bool>* interrupt_solve,
+                                          LpBasis* basis = nullptr) {
+  if (basis != nullptr) *basis = LpBasis();
+  MPSolutionResponse error_response;
+  glop::GlopParameters glop_parameters;
+  if (!ProtobufTextFormatMergeFromString(request.solver_specific_parameters(),
+                                         &glop_parameters)) {
+    error_response.set_status(
+        MPSolverResponseStatus::MPSOLVER_MODEL_INVALID_SOLVER_PARAMETERS);
+    return error_response;
+  }
+  if (interrupt_solve != nullptr && interrupt_solve->load() == true) {
+    error_response.set_status(MPSolverResponseStatus::MPSOLVER_NOT_SOLVED);
+    return error_response;
+  }
+  if (request.has_solver_time_limit_seconds()) {
+    glop_parameters.set_max_time_in_seconds(
+        request.solver_time_limit_seconds());
+  }
+  glop_parameters.set_log_search_progress(
+      request.enable_internal_solver_output());
+
+  const std::optional<LazyMutableCopy<MPModelProto>> optional_model =
+      ExtractValidMPModelOrPopulateResponseStatus(request, &error_response);
+  if (!optional_model) {
+    LOG_IF(WARNING, request.enable_internal_solver_output())
+        << "Failed to extract a valid model from protocol buffer. Status: "
+        << ProtoEnumToString<MPSolverResponseStatus>(error_response.status())
+        << " (" << error_response.status()
+        << "): " << error_response.status_str();
+    return error_response;
+  }
+  const MPModelProto& model = optional_model->get();
+
+  // The workers stop on the shared Boolean of shared_time_limit, which is set
+  // by the first conclusive worker. The user interrupt is registered as the
+  // secondary Boolean of the glop time limits, and forwarded to PDLP (that
+  // only takes one Boolean) by the polling loop below.
+  std::unique_ptr<TimeLimit> time_limit =
+      TimeLimit::FromParameters(glop_parameters);
+  SharedTimeLimit shared_time_limit(time_limit.get());
+
+  absl::Mutex mutex;
+  int num_running_workers = kNumWorkers;
+  int winner = -1;
+  std::vector<MPSolutionResponse> responses(kNumWorkers);
+  std::vector<LpBasis> bases(kNumWorkers);
+  const auto report = [&](int worker, MPSolutionResponse response,
+                          LpBasis worker_basis) {
+    absl::MutexLock lock(&mutex);
+    if (winner == -1 && IsConclusive(response.status())) {
+      winner = worker;
+      shared_time_limit.Stop();
+    }
+    responses[worker] = std::move(response);
+    bases[worker] = std::move(worker_basis);
+    --num_running_workers;
+  };
+
+  const auto run_glop = [&](int worker) {
+    glop::GlopParameters parameters = glop_parameters;
+    parameters.set_use_dual_simplex(worker == kDualSimplex);
+    std::unique_ptr<TimeLimit> local_time_limit = TimeLimit::Infinite();
+    shared_time_limit.UpdateLocalLimit(local_time_limit.get());
+    local_time_limit->RegisterSecondaryExternalBooleanAsLimit(interrupt_solve);
+    LpBasis glop_basis;
+    MPSolutionResponse response =
+        GlopSolve(model, parameters, local_time_limit.get(), &glop_basis);
+    report(worker, std::move(response), std::move(glop_basis));
+  };
+
+  const auto run_pdlp = [&]() {
+    // PdlpSolveProto() needs its own request. The model is already validated
+    // and has no delta at this point.
+    MPModelRequest pdlp_request;
+    *pdlp_request.mutable_model() = model;
+    pdlp_request.set_enable_internal_solver_output(
+        request.enable_internal_solver_output());
+    const double time_left = shared_time_limit.GetTimeLeft();
+    if (std::isfinite(time_left)) {
+      pdlp_request.set_solver_time_limit_seconds(time_left);
+    }
+    absl::StatusOr<MPSolutionResponse> pdlp_response =
+        PdlpSolveProto(pdlp_request, /*relax_integer_variables=*/true,
+                       shared_time_limit.ExternalBooleanAsLimit());
+    if (!pdlp_response.ok()) {
+      MPSolutionResponse response;
+      response.set_status(MPSOLVER_ABNORMAL);
+      response.set_status_str(std::string(pdlp_response.status().message()));
+      report(kPdlp, std::move(response), LpBasis());
+      return;
+    }
+    report(kPdlp, *std::move(pdlp_response), LpBasis());
+  };
+
+  {
+    ThreadPool pool("ConcurrentLp", kNumWorkers);
+    pool.StartWorkers();
+    pool.Schedule([&]() { run_glop(kDualSimplex); });
+    pool.Schedule([&]() { run_glop(kPrimalSimplex); });
+    pool.Schedule(run_pdlp);
+
+    absl::MutexLock lock(&mutex);
+    const auto all_done = [&]() { return num_running_workers == 0; };
+    while (!mutex.AwaitWithTimeout(absl::Condition(&all_done),
+                                   absl::Milliseconds(10))) {
+      if (interrupt_solve != nullptr && interrupt_solve->load()) {
+        shared_time_limit.Stop();
+      }
+    }
+  }
+
+  if (winner == -1) {
+    // Nobody could conclude, return the first feasible solution if any.
+    for (int worker = 0; worker < kNumWorkers; ++worker) {
+      if (responses[worker].status() == MPSOLVER_FEASIBLE) {
+        winner = worker;
+        break;
+      }
+    }
+    if (winner == -1) winner = kDualSimplex;
+  }
+  LOG_IF(INFO, request.enable_internal_solver_output())
+      << "Concurrent LP solve: " << WorkerName(winner)
+      << " finished first with "
+      << ProtoEnumToString<MPSolverResponseStatus>(
+             responses[winner].status());
+
+  MPSolutionResponse response = std::move(responses[winner]);
+  LpBasis winner_basis = std::move(bases[winner]);
+  std::string result_from = WorkerName(winner);
+  if (winner == kPdlp && response.status() == MPSOLVER_OPTIMAL) {
+    // Note that we cannot use time_limit since its Boolean was set by the
+    // race, but we still honor the remaining time and the user interrupt.
+    TimeLimit crossover_time_limit(time_limit->GetTimeLeft());
+    crossover_time_limit.RegisterExternalBooleanAsLimit(interrupt_solve);
+    LpBasis crossover_basis;
+    std::optional<MPSolutionResponse> crossover_response =
+        Crossover(model, response, glop_parameters, &crossover_time_limit,
+                  &crossover_basis);
+    if (crossover_response.has_value()) {
+      response = *std::move(crossover_response);
+      winner_basis = std::move(crossover_basis);
+      result_from = "pdlp followed by a crossover";
+    }
+  }
+  if (basis != nullptr) *basis = std::move(winner_basis);
+  response.set_status_str(
+      response.status_str().empty()
+          ? absl::StrCat("Result from ", result_from)
+          : absl::StrCat("Result from ", result_from, ": ",
+                         response.status_str()));
+  return response;
+}
+
+}  // namespace
+
+class ConcurrentLpInterface : public MPSolverInterface {
+ public:
+  explicit ConcurrentLpInterface(MPSolver* solver);
+  ~ConcurrentLpInterface() override;
+
+  // ----- Solve -----
+  MPSolver::ResultStatus Solve(const MPSolverParameters& param) override;
+  std::optional<MPSolutionResponse> DirectlySolveProto(
+      const MPModelRequest& request, std::atomic<bool>* interrupt) override;
+
+  // ----- Model modifications and extraction -----
+  void Reset() override;
+  void SetOptimizationDirection(bool maximize) override;
+  void SetVariableBounds(int index, double lb, double ub) override;
+  void SetVariableInteger(int index, bool integer) override;
+  void SetConstraintBounds(int index, double lb, double ub) override;
+  void AddRowConstraint(MPConstraint* ct) override;
+  void AddVariable(MPVariable* var) override;
+  void SetCoefficient(MPConstraint* constraint, const MPVariable* variable,
+                      double new_value, double old_value) override;
+  void ClearConstraint(MPConstraint* constraint) override;
+  void SetObjectiveCoefficient(const MPVariable* variable,
+                               double coefficient) override;
+  void SetObjectiveOffset(double value) override;
+  void ClearObjective() override;
+
+  // ------ Query statistics on the solution and the solve ------
+  int64_t iterations() const override;
+  int64_t nodes() const override;
+  MPSolver::BasisStatus row_status(int constraint_index) const override;
+  MPSolver::BasisStatus column_status(int variable_index) const override;
+
+  // ----- Misc -----
+  bool IsContinuous() const override;
+  bool IsLP() const override;
+  bool IsMIP() const override;
+
+  std::string SolverVersion() const override;
+  void* underlying_solver() override;
+  bool InterruptSolve() override;
+
+  void ExtractNewVariables() override;
+  void ExtractNewConstraints() override;
+  void ExtractObjective() override;
+
+  void SetParameters(const MPSolverParameters& param) override;
+  void SetRelativeMipGap(double value) override;
+  void SetPrimalTolerance(double value) override;
+  void SetDualTolerance(double value) override;
+  void SetPresolveMode(int value) override;
+  void SetScalingMode(int value) override;
+  void SetLpAlgorithm(int value) override;
+  bool SetSolverSpecificParametersAsString(
+      const std::string& parameters) override;
+
+ private:
+  void NonIncrementalChange();
+
+  // The basis of the last solution, empty if it isn't known, e.g. when PDLP
+  // won the race and the crossover didn't complete.
+  LpBasis basis_;
+  glop::GlopParameters parameters_;
+  std::atomic<bool> interrupt_solver_;
+};
+
+ConcurrentLpInterface::ConcurrentLpInterface(MPSolver* const solver)
+    : MPSolverInterface(solver), interrupt_solver_(false) {}
+
+ConcurrentLpInterface::~ConcurrentLpInterface() {}
+
+MPSolver::ResultStatus ConcurrentLpInterface::Solve(
+    const MPSolverParameters& param) {
+  // Reset extraction as this interface is not incremental.
+  Reset();
+  interrupt_solver_ = false;
+  ExtractModel();
+  parameters_.Clear();
+  SetParameters(param);
+  solver_->SetSolverSpecificParametersAsString(
+      solver_->solver_specific_parameter_string_);
+
+  // Mark variables and constraints as extracted.
+  for (int i = 0; i < solver_->variables_.size(); ++i) {
+    set_variable_as_extracted(i, true);
+  }
+  for (int i = 0; i < solver_->constraints_.size(); ++i) {
+    set_constraint_as_extracted(i, true);
+  }
+
+  MPModelProto model_proto;
+  solver_->ExportModelToProto(&model_proto);
+  MPModelRequest request;
+  *request.mutable_model() = std::move(model_proto);
+  request.set_enable_internal_solver_output(!quiet_);
+  if (solver_->time_limit()) {
+    VLOG(1) << "Setting time limit = " << solver_->time_limit() << " ms.";
+    request.set_solver_time_limit_seconds(
+        static_cast<double>(solver_->time_limit()) / 1000.0);
+  }
+  if (!google::protobuf::TextFormat::PrintToString(
+          parameters_, request.mutable_solver_specific_parameters())) {
+    LOG(QFATAL) << "Error converting parameters to text format: "
+                << parameters_.DebugString();
+  }
+  const MPSolutionResponse response =
+      ConcurrentLpSolveProto(request, &interrupt_solver_, &basis_);
+
+  // The solution must be marked as synchronized even when no solution exists.
+  sync_status_ = SOLUTION_SYNCHRONIZED;
+  if (response.status() == MPSOLVER_CANCELLED_BY_USER) {
+    // MPSOLVER_CANCELLED_BY_USER is only for when the solver didn't have time
+    // to return a proper status, and is not convertible to an MPSolver status.
+    result_status_ = MPSolver::NOT_SOLVED;
+  } else {
+    result_status_ = static_cast<MPSolver::ResultStatus>(response.status());
+  }
+  if (response.status() == MPSOLVER_FEASIBLE ||
+      response.status() == MPSOLVER_OPTIMAL) {
+    const absl::Status result = solver_->LoadSolutionFromProto(response);
+    if (!result.ok()) {
+      LOG(ERROR) << "LoadSolutionFromProto failed: " << result;
+    }
+  }
+  return result_status_;
+}
+
+std::optional<MPSolutionResponse> ConcurrentLpInterface::DirectlySolveProto(
+    const MPModelRequest& request, std::atomic<bool>* interrupt) {
+  return ConcurrentLpSolveProto(request, interrupt);
+}
+
+void ConcurrentLpInterface::Reset() { ResetExtractionInformation(); }
+
+void ConcurrentLpInterface::SetOptimizationDirection(bool maximize) {
+  NonIncrementalChange();
+}
+
+void ConcurrentLpInterface::SetVariableBounds(int index, double lb,
+                                              double ub) {
+  NonIncrementalChange();
+}
+
+void ConcurrentLpInterface::SetVariableInteger(int index, bool integer) {
+  NonIncrementalChange();
+}
+
+void ConcurrentLpInterface::SetConstraintBounds(int index, double lb,
+                                                double ub) {
+  NonIncrementalChange();
+}
+
+void ConcurrentLpInterface::AddRowConstraint(MPConstraint* const ct) {
+  NonIncrementalChange();
+}
+
+void ConcurrentLpInterface::AddVariable(MPVariable* const var) {
+  NonIncrementalChange();
+}
+
+void ConcurrentLpInterface::SetCoefficient(MPConstraint* const constraint,
+                                           const MPVariable* const variable,
+                                           double new_value, double old_value) {
+  NonIncrementalChange();
+}
+
+void ConcurrentLpInterface::ClearConstraint(MPConstraint* const constraint) {
+  NonIncrementalChange();
+}
+
+void ConcurrentLpInterface::SetObjectiveCoefficient(
+    const MPVariable* const variable, double coefficient) {
+  NonIncrementalChange();
+}
+
+void ConcurrentLpInterface::SetObjectiveOffset(double value) {
+  NonIncrementalChange();
+}
+
+void ConcurrentLpInterface::ClearObjective() { NonIncrementalChange(); }
+
+int64_t ConcurrentLpInterface::iterations() const {
+  // The iterations of the different workers are not comparable.
+  return kUnknownNumberOfIterations;
+}
+
+int64_t ConcurrentLpInterface::nodes() const {
+  LOG(DFATAL) << "Number of nodes only available for discrete problems";
+  return MPSolverInterface::kUnknownNumberOfNodes;
+}
+
+MPSolver::BasisStatus ConcurrentLpInterface::row_status(
+    int constraint_index) const {
+  if (basis_.row_status.empty()) return MPSolver::BasisStatus::FREE;
+  return basis_.row_status[constraint_index];
+}
+
+MPSolver::BasisStatus ConcurrentLpInterface::column_status(
+    int variable_index) const {
+  if (basis_.column_status.empty()) return MPSolver::BasisStatus::FREE;
+  return basis_.column_status[variable_index];
+}
+
+bool ConcurrentLpInterface::IsContinuous() const { return true; }
+
+bool ConcurrentLpInterface::IsLP() const { return true; }
+
+bool ConcurrentLpInterface::IsMIP() const { return false; }
+
+std::string ConcurrentLpInterface::SolverVersion() const {
+  return "Concurrent Glop and PDLP Solver";
+}
+
+void* ConcurrentLpInterface::underlying_solver() { return nullptr; }
+
+bool ConcurrentLpInterface::InterruptSolve() {
+  interrupt_solver_ = true;
+  return true;
+}
+
+void ConcurrentLpInterface::ExtractNewVariables() { NonIncrementalChange(); }
+
+void ConcurrentLpInterface::ExtractNewConstraints() { NonIncrementalChange(); }
+
+void ConcurrentLpInterface::ExtractObjective() { NonIncrementalChange(); }
+
+void ConcurrentLpInterface::SetParameters(const MPSolverParameters& param) {
+  SetCommonParameters(param);
+}
+
+// These have no effect. Use SetSolverSpecificParametersAsString instead.
+void ConcurrentLpInterface::SetPrimalTolerance(double value) {}
+void ConcurrentLpInterface::SetDualTolerance(double value) {}
+void ConcurrentLpInterface::SetScalingMode(int value) {}
+void ConcurrentLpInterface::SetLpAlgorithm(int value) {}
+void ConcurrentLpInterface::SetRelativeMipGap(double value) {}
+void ConcurrentLpInterface::SetPresolveMode(int value) {}
+
+bool ConcurrentLpInterface::SetSolverSpecificParametersAsString(
+    const std::string& parameters) {
+  return ProtobufTextFormatMergeFromString(parameters, &parameters_);
+}
+
+void ConcurrentLpInterface::NonIncrementalChange() {
+  // The current implementation is not incremental.
+  sync_status_ = MUST_RELOAD;
+}
+
+// Register the concurrent LP solver in the global linear solver factory.
+MPSolverInterface* BuildConcurrentLpInterface(MPSolver* const solver) {
+  return new ConcurrentLpInterface(solver);
+}
+
+}  // namespace operations_research
+#endif  //  #if defined(USE_GLOP) && defined(USE_PDLP)
@@ -0,0 +1,221 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "absl/random/distributions.h"
+#include "absl/strings/match.h"
+#include "gtest/gtest.h"
+#include "ortools/linear_solver/linear_solver.h"
+#include "ortools/linear_solver/linear_solver.pb.h"
+
+namespace operations_research {
+namespace {
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+// max 3x + 2y s.t. x + y <= 4, x + 3y <= 7, 0 <= x <= 3, y >= 0.
+// The optimum is x = 3, y = 1, with an objective of 11.
+MPModelProto SmallLp() {
+  MPModelProto model;
+  model.set_maximize(true);
+  MPVariableProto* x = model.add_variable();
+  x->set_upper_bound(3.0);
+  x->set_objective_coefficient(3.0);
+  MPVariableProto* y = model.add_variable();
+  y->set_upper_bound(kInfinity);
+  y->set_objective_coefficient(2.0);
+  MPConstraintProto* c1 = model.add_constraint();
+  c1->set_lower_bound(-kInfinity);
+  c1->set_upper_bound(4.0);
+  c1->add_var_index(0);
+  c1->add_coefficient(1.0);
+  c1->add_var_index(1);
+  c1->add_coefficient(1.0);
+  MPConstraintProto* c2 = model.add_constraint();
+  c2->set_lower_bound(-kInfinity);
+  c2->set_upper_bound(7.0);
+  c2->add_var_index(0);
+  c2->add_coefficient(1.0);
+  c2->add_var_index(1);
+  c2->add_coefficient(3.0);
+  return model;
+}
+
+// Random LP with boxed variables, so that it is never unbounded. It is
+// infeasible from time to time.
+MPModelProto RandomLp(int num_variables, int num_constraints,
+                      std::mt19937* random) {
+  MPModelProto model;
+  model.set_maximize(absl::Bernoulli(*random, 0.5));
+  for (int i = 0; i < num_variables; ++i) {
+    MPVariableProto* variable = model.add_variable();
+    variable->set_lower_bound(absl::Uniform<int>(*random, -5, 1));
+    variable->set_upper_bound(absl::Uniform<int>(*random, 1, 10));
+    variable->set_objective_coefficient(absl::Uniform<int>(*random, -10, 11));
+  }
+  for (int i = 0; i < num_constraints; ++i) {
+    MPConstraintProto* constraint = model.add_constraint();
+    for (int j = 0; j < num_variables; ++j) {
+      if (!absl::Bernoulli(*random, 0.5)) continue;
+      constraint->add_var_index(j);
+      constraint->add_coefficient(absl::Uniform<int>(*random, -5, 6));
+    }
+    const int bound = absl::Uniform<int>(*random, -10, 20);
+    if (absl::Bernoulli(*random, 0.5)) {
+      constraint->set_lower_bound(-kInfinity);
+      constraint->set_upper_bound(bound);
+    } else {
+      constraint->set_lower_bound(bound);
+      constraint->set_upper_bound(kInfinity);
+    }
+  }
+  return model;
+}
+
+MPSolutionResponse SolveWithProto(const MPModelProto& model,
+                                  MPModelRequest::SolverType solver_type) {
+  MPModelRequest request;
+  *request.mutable_model() = model;
+  request.set_solver_type(solver_type);
+  MPSolutionResponse response;
+  MPSolver::SolveWithProto(request, &response);
+  return response;
+}
+
+TEST(ConcurrentLpInterfaceTest, IsAvailable) {
+  EXPECT_TRUE(MPSolver::SupportsProblemType(
+      MPSolver::CONCURRENT_LP_LINEAR_PROGRAMMING));
+  MPSolver::OptimizationProblemType type;
+  ASSERT_TRUE(MPSolver::ParseSolverType("concurrent_lp", &type));
+  EXPECT_EQ(type, MPSolver::CONCURRENT_LP_LINEAR_PROGRAMMING);
+}
+
+TEST(ConcurrentLpInterfaceTest, SolvesSmallLpWithMPSolver) {
+  MPSolver solver("small_lp", MPSolver::CONCURRENT_LP_LINEAR_PROGRAMMING);
+  std::string error;
+  ASSERT_EQ(solver.LoadModelFromProto(SmallLp(), &error),
+            MPSOLVER_MODEL_IS_VALID)
+      << error;
+  ASSERT_EQ(solver.Solve(), MPSolver::OPTIMAL);
+  EXPECT_NEAR(solver.Objective().Value(), 11.0, 1e-6);
+  EXPECT_NEAR(solver.variable(0)->solution_value(), 3.0, 1e-6);
+  EXPECT_NEAR(solver.variable(1)->solution_value(), 1.0, 1e-6);
+  // The dual value of x + y <= 4 is 2, the one of x + 3y <= 7 is 0.
+  EXPECT_NEAR(solver.constraint(0)->dual_value(), 2.0, 1e-6);
+  EXPECT_NEAR(solver.constraint(1)->dual_value(), 0.0, 1e-6);
+}
+
+// Whichever worker wins, the basis comes from a simplex or from the crossover.
+TEST(ConcurrentLpInterfaceTest, ReturnsTheOptimalBasis) {
+  MPSolver solver("small_lp", MPSolver::CONCURRENT_LP_LINEAR_PROGRAMMING);
+  std::string error;
+  ASSERT_EQ(solver.LoadModelFromProto(SmallLp(), &error),
+            MPSOLVER_MODEL_IS_VALID)
+      << error;
+  ASSERT_EQ(solver.Solve(), MPSolver::OPTIMAL);
+  // x = 3 is at its upper bound and x + y <= 4 is tight, y = 1 and the slack
+  // of x + 3y <= 7 are basic.
+  EXPECT_EQ(solver.variable(0)->basis_status(), MPSolver::AT_UPPER_BOUND);
+  EXPECT_EQ(solver.variable(1)->basis_status(), MPSolver::BASIC);
+  EXPECT_EQ(solver.constraint(0)->basis_status(), MPSolver::AT_UPPER_BOUND);
+  EXPECT_EQ(solver.constraint(1)->basis_status(), MPSolver::BASIC);
+}
+
+TEST(ConcurrentLpInterfaceTest, ReturnsABasisOnRandomLps) {
+  std::mt19937 random(12345);
+  int num_optimal = 0;
+  for (int trial = 0; trial < 30; ++trial) {
+    MPSolver solver("random_lp", MPSolver::CONCURRENT_LP_LINEAR_PROGRAMMING);
+    std::string error;
+    ASSERT_EQ(solver.LoadModelFromProto(RandomLp(15, 10, &random), &error),
+              MPSOLVER_MODEL_IS_VALID)
+        << error;
+    if (solver.Solve() != MPSolver::OPTIMAL) continue;
+    ++num_optimal;
+    int num_basic = 0;
+    for (const MPVariable* variable : solver.variables()) {
+      switch (variable->basis_status()) {
+        case MPSolver::BASIC:
+          ++num_basic;
+          break;
+        case MPSolver::AT_LOWER_BOUND:
+          EXPECT_NEAR(variable->solution_value(), variable->lb(), 1e-6);
+          break;
+        case MPSolver::AT_UPPER_BOUND:
+          EXPECT_NEAR(variable->solution_value(), variable->ub(), 1e-6);
+          break;
+        default:
+          ADD_FAILURE() << "trial " << trial << ": status "
+                        << variable->basis_status();
+      }
+    }
+    for (const MPConstraint* constraint : solver.constraints()) {
+      if (constraint->basis_status() == MPSolver::BASIC) ++num_basic;
+    }
+    EXPECT_EQ(num_basic, solver.NumConstraints()) << "trial " << trial;
+  }
+  EXPECT_GT(num_optimal, 0);
+}
+
+TEST(ConcurrentLpInterfaceTest, ReportsWhichSolverWon) {
+  const MPSolutionResponse response = SolveWithProto(
+      SmallLp(), MPModelRequest::CONCURRENT_LP_LINEAR_PROGRAMMING);
+  ASSERT_EQ(response.status(), MPSOLVER_OPTIMAL);
+  EXPECT_NEAR(response.objective_value(), 11.0, 1e-6);
+  EXPECT_TRUE(absl::StartsWith(response.status_str(), "Result from "))
+      << response.status_str();
+}
+
+TEST(ConcurrentLpInterfaceTest, DetectsInfeasibility) {
+  MPModelProto model = SmallLp();
+  // x + y >= 5 conflicts with x + y <= 4.
+  MPConstraintProto* constraint = model.add_constraint();
+  constraint->set_lower_bound(5.0);
+  constraint->set_upper_bound(kInfinity);
+  constraint->add_var_index(0);
+  constraint->add_coefficient(1.0);
+  constraint->add_var_index(1);
+  constraint->add_coefficient(1.0);
+  EXPECT_EQ(SolveWithProto(model,
+                           MPModelRequest::CONCURRENT_LP_LINEAR_PROGRAMMING)
+                .status(),
+            MPSOLVER_INFEASIBLE);
+}
+
+TEST(ConcurrentLpInterfaceTest, MatchesGlopOnRandomLps) {
+  std::mt19937 random(12345);
+  int num_optimal = 0;
+  for (int trial = 0; trial < 30; ++trial) {
+    const MPModelProto model = RandomLp(15, 10, &random);
+    const MPSolutionResponse glop =
+        SolveWithProto(model, MPModelRequest::GLOP_LINEAR_PROGRAMMING);
+    const MPSolutionResponse concurrent = SolveWithProto(
+        model, MPModelRequest::CONCURRENT_LP_LINEAR_PROGRAMMING);
+    ASSERT_EQ(concurrent.status(), glop.status())
+        << "trial " << trial << ": " << concurrent.status_str();
+    if (glop.status() != MPSOLVER_OPTIMAL) continue;
+    ++num_optimal;
+    EXPECT_NEAR(concurrent.objective_value(), glop.objective_value(),
+                1e-6 * std::max(1.0, std::abs(glop.objective_value())))
+        << "trial " << trial << ": " << concurrent.status_str();
+  }
+  EXPECT_GT(num_optimal, 0);
+}
+
+}  // namespace
+}  // namespace operations_research
@@ -84,6 +84,7 @@ namespace operations_research {
 bool SolverTypeIsMip(MPModelRequest::SolverType solver_type) {
   switch (solver_type) {
     case MPModelRequest::PDLP_LINEAR_PROGRAMMING:
+    case MPModelRequest::CONCURRENT_LP_LINEAR_PROGRAMMING:
     case MPModelRequest::GLOP_LINEAR_PROGRAMMING:
     case MPModelRequest::CLP_LINEAR_PROGRAMMING:
     case MPModelRequest::GLPK_LINEAR_PROGRAMMING:
@@ -394,6 +395,9 @@ extern MPSolverInterface* BuildHighsInterface(bool mip, MPSolver* const solver);
 #if defined(USE_PDLP)
 extern MPSolverInterface* BuildPdlpInterface(MPSolver* const solver);
 #endif
+#if defined(USE_GLOP) && defined(USE_PDLP)
+extern MPSolverInterface* BuildConcurrentLpInterface(MPSolver* const solver);
+#endif
 extern MPSolverInterface* BuildSatInterface(MPSolver* const solver);
 #if defined(USE_SCIP)
 extern MPSolverInterface* BuildSCIPInterface(MPSolver* const solver);
@@ -443,6 +447,10 @@ MPSolverInterface* BuildSolverInterface(MPSolver* const solver) {
 #if defined(USE_PDLP)
     case MPSolver::PDLP_LINEAR_PROGRAMMING:
       return BuildPdlpInterface(solver);
+#endif
+#if defined(USE_GLOP) && defined(USE_PDLP)
+    case MPSolver::CONCURRENT_LP_LINEAR_PROGRAMMING:
+      return BuildConcurrentLpInterface(solver);
 #endif
     case MPSolver::SAT_INTEGER_PROGRAMMING:
       return BuildSatInterface(solver);
@@ -530,6 +538,9 @@ bool MPSolver::SupportsProblemType(OptimizationProblemType problem_type) {
 #endif
 #ifdef USE_PDLP
   if (problem_type == PDLP_LINEAR_PROGRAMMING) return true;
+#endif
+#if defined(USE_GLOP) && defined(USE_PDLP)
+  if (problem_type == CONCURRENT_LP_LINEAR_PROGRAMMING) return true;
 #endif
   if (problem_type == GUROBI_LINEAR_PROGRAMMING ||
       problem_type == GUROBI_MIXED_INTEGER_PROGRAMMING) {
@@ -586,6 +597,7 @@ constexpr
         {MPSolver::GLPK_MIXED_INTEGER_PROGRAMMING, "glpk"},
         {MPSolver::HIGHS_MIXED_INTEGER_PROGRAMMING, "highs"},
         {MPSolver::PDLP_LINEAR_PROGRAMMING, "pdlp"},
+        {MPSolver::CONCURRENT_LP_LINEAR_PROGRAMMING, "concurrent_lp"},
         {MPSolver::KNAPSACK_MIXED_INTEGER_PROGRAMMING, "knapsack"},
         {MPSolver::CPLEX_MIXED_INTEGER_PROGRAMMING, "cplex"},
         {MPSolver::XPRESS_MIXED_INTEGER_PROGRAMMING, "xpress"},
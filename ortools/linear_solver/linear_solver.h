@@ -205,6 +205,9 @@ class MPSolver {
     // scales to much larger problems than Glop.
     PDLP_LINEAR_PROGRAMMING = 8,
     HIGHS_LINEAR_PROGRAMMING = 15,
+    // Races the Glop primal simplex, the Glop dual simplex and PDLP, each in
+    // its own thread, and returns the result of the first one to conclude.
+    CONCURRENT_LP_LINEAR_PROGRAMMING = 17,
 
     // Integer programming problems.
     // -----------------------------
@@ -593,7 +596,8 @@ class MPSolver {
            solver == MPModelRequest::GUROBI_LINEAR_PROGRAMMING ||
            solver == MPModelRequest::GUROBI_MIXED_INTEGER_PROGRAMMING ||
            solver == MPModelRequest::SAT_INTEGER_PROGRAMMING ||
-           solver == MPModelRequest::PDLP_LINEAR_PROGRAMMING;
+           solver == MPModelRequest::PDLP_LINEAR_PROGRAMMING ||
+           solver == MPModelRequest::CONCURRENT_LP_LINEAR_PROGRAMMING;
   }
 
   /// Exports model to protocol buffer.
@@ -878,6 +882,7 @@ class MPSolver {
   friend class BopInterface;
   friend class SatInterface;
   friend class PdlpInterface;
+  friend class ConcurrentLpInterface;
   friend class HighsInterface;
   friend class KnapsackInterface;
 
@@ -1108,6 +1113,7 @@ class MPObjective {
   friend class BopInterface;
   friend class SatInterface;
   friend class PdlpInterface;
+  friend class ConcurrentLpInterface;
   friend class HighsInterface;
   friend class KnapsackInterface;
 
@@ -1223,6 +1229,7 @@ class MPVariable {
   friend class BopInterface;
   friend class SatInterface;
   friend class PdlpInterface;
+  friend class ConcurrentLpInterface;
   friend class HighsInterface;
   friend class KnapsackInterface;
 
@@ -1371,6 +1378,7 @@ class MPConstraint {
   friend class BopInterface;
   friend class SatInterface;
   friend class PdlpInterface;
+  friend class ConcurrentLpInterface;
   friend class HighsInterface;
   friend class KnapsackInterface;
 
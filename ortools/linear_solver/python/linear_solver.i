@@ -293,6 +293,7 @@ PY_CONVERT(MPVariable);
 %unignore operations_research::MPSolver::GLOP_LINEAR_PROGRAMMING;
 %unignore operations_research::MPSolver::GLPK_LINEAR_PROGRAMMING;
 %unignore operations_research::MPSolver::PDLP_LINEAR_PROGRAMMING;
+%unignore operations_research::MPSolver::CONCURRENT_LP_LINEAR_PROGRAMMING;
 %unignore operations_research::MPSolver::CBC_MIXED_INTEGER_PROGRAMMING;
 %unignore operations_research::MPSolver::GLPK_MIXED_INTEGER_PROGRAMMING;
 %unignore operations_research::MPSolver::SCIP_MIXED_INTEGER_PROGRAMMING;
@@ -180,6 +180,12 @@ class LinearProgram {
   const SparseMatrix& GetSparseMatrix() const { return matrix_; }
   const SparseMatrix& GetTransposeSparseMatrix() const;
 
+  // Returns true if GetTransposeSparseMatrix() does not need to recompute the
+  // transpose.
+  bool IsTransposeMatrixConsistent() const {
+    return transpose_matrix_is_consistent_;
+  }
+
   // Some transformations are better done on the transpose representation. These
   // two functions are here for that. Note that calling the first function and
   // modifying the matrix does not change the result of any function in this
@@ -13,7 +13,6 @@
 
 #include "ortools/lp_data/lp_decomposer.h"
 
-#include <algorithm>
 #include <vector>
 
 #include "absl/synchronization/mutex.h"
@@ -34,45 +33,72 @@ void LPDecomposer::Decompose(const LinearProgram* linear_problem) {
   absl::MutexLock mutex_lock(&mutex_);
   original_problem_ = linear_problem;
   clusters_.clear();
-
-  const SparseMatrix& transposed_matrix =
-      original_problem_->GetTransposeSparseMatrix();
-  MergingPartition partition(original_problem_->num_variables().value());
-
-  // Iterate on all constraints, and merge all variables of each constraint.
-  const ColIndex num_ct = RowToColIndex(original_problem_->num_constraints());
-  for (ColIndex ct(0); ct < num_ct; ++ct) {
-    const SparseColumn& sparse_constraint = transposed_matrix.column(ct);
-    if (sparse_constraint.num_entries() > 1) {
-      const RowIndex first_row = sparse_constraint.GetFirstRow();
-      for (EntryIndex e(1); e < sparse_constraint.num_entries(); ++e) {
-        partition.MergePartsOf(first_row.value(),
-                               sparse_constraint.EntryRow(e).value());
+  row_clusters_.clear();
+
+  // Note that we only use the column-wise matrix, so that the transpose does
+  // not need to be computed and the problem is never modified.
+  const SparseMatrix& matrix = original_problem_->GetSparseMatrix();
+  const ColIndex num_cols = original_problem_->num_variables();
+  const RowIndex num_rows = original_problem_->num_constraints();
+  MergingPartition partition(num_cols.value());
+
+  // Merge all variables of each constraint with the first variable seen in
+  // this constraint.
+  StrictITIVector<RowIndex, ColIndex> first_col(num_rows, kInvalidCol);
+  for (ColIndex col(0); col < num_cols; ++col) {
+    for (const SparseColumn::Entry e : matrix.column(col)) {
+      if (first_col[e.row()] == kInvalidCol) {
+        first_col[e.row()] = col;
+      } else {
+        partition.MergePartsOf(first_col[e.row()].value(), col.value());
       }
     }
   }
 
+  // Since we iterate in increasing order, all the clusters are sorted.
   std::vector<int> classes;
   const int num_classes = partition.FillEquivalenceClasses(&classes);
   clusters_.resize(num_classes);
-  for (int i = 0; i < classes.size(); ++i) {
-    clusters_[classes[i]].push_back(ColIndex(i));
+  for (ColIndex col(0); col < num_cols; ++col) {
+    clusters_[classes[col.value()]].push_back(col);
   }
-  for (int i = 0; i < num_classes; ++i) {
-    std::sort(clusters_[i].begin(), clusters_[i].end());
+  row_clusters_.resize(num_classes);
+  local_rows_.assign(num_rows, kInvalidRow);
+  for (RowIndex row(0); row < num_rows; ++row) {
+    if (first_col[row] == kInvalidCol) continue;
+    std::vector<RowIndex>& row_cluster =
+        row_clusters_[classes[first_col[row].value()]];
+    local_rows_[row] = RowIndex(row_cluster.size());
+    row_cluster.push_back(row);
   }
 }
 
 int LPDecomposer::GetNumberOfProblems() const {
-  absl::MutexLock mutex_lock(&mutex_);
+  absl::ReaderMutexLock mutex_lock(&mutex_);
   return clusters_.size();
 }
 
 const LinearProgram& LPDecomposer::original_problem() const {
-  absl::MutexLock mutex_lock(&mutex_);
+  absl::ReaderMutexLock mutex_lock(&mutex_);
   return *original_problem_;
 }
 
+const std::vector<ColIndex>& LPDecomposer::GetProblemColumns(
+    int problem_index) const {
+  absl::ReaderMutexLock mutex_lock(&mutex_);
+  CHECK_GE(problem_index, 0);
+  CHECK_LT(problem_index, clusters_.size());
+  return clusters_[problem_index];
+}
+
+const std::vector<RowIndex>& LPDecomposer::GetProblemRows(
+    int problem_index) const {
+  absl::ReaderMutexLock mutex_lock(&mutex_);
+  CHECK_GE(problem_index, 0);
+  CHECK_LT(problem_index, row_clusters_.size());
+  return row_clusters_[problem_index];
+}
+
 void LPDecomposer::ExtractLocalProblem(int problem_index, LinearProgram* lp) {
   CHECK(lp != nullptr);
   CHECK_GE(problem_index, 0);
@@ -80,26 +106,30 @@ void LPDecomposer::ExtractLocalProblem(int problem_index, LinearProgram* lp) {
 
   lp->Clear();
 
-  absl::MutexLock mutex_lock(&mutex_);
+  absl::ReaderMutexLock mutex_lock(&mutex_);
   const std::vector<ColIndex>& cluster = clusters_[problem_index];
-  StrictITIVector<ColIndex, ColIndex> global_to_local(
-      original_problem_->num_variables(), kInvalidCol);
-  SparseBitset<RowIndex> constraints_to_use(
-      original_problem_->num_constraints());
+  const std::vector<RowIndex>& row_cluster = row_clusters_[problem_index];
   lp->SetMaximizationProblem(original_problem_->IsMaximizationProblem());
 
-  // Create variables and get all constraints of the cluster.
+  // Create the constraints.
+  for (int i = 0; i < row_cluster.size(); ++i) {
+    const RowIndex global_row = row_cluster[i];
+    const RowIndex local_row = lp->CreateNewConstraint();
+    CHECK_EQ(local_row, RowIndex(i));
+    lp->SetConstraintName(local_row,
+                          original_problem_->GetConstraintName(global_row));
+    lp->SetConstraintBounds(
+        local_row, original_problem_->constraint_lower_bounds()[global_row],
+        original_problem_->constraint_upper_bounds()[global_row]);
+  }
+
+  // Create the variables and their columns. Because the local row indices are
+  // increasing with the global ones, the columns stay sorted.
   const SparseMatrix& original_matrix = original_problem_->GetSparseMatrix();
-  const SparseMatrix& transposed_matrix =
-      original_problem_->GetTransposeSparseMatrix();
   for (int i = 0; i < cluster.size(); ++i) {
     const ColIndex global_col = cluster[i];
     const ColIndex local_col = lp->CreateNewVariable();
     CHECK_EQ(local_col, ColIndex(i));
-    CHECK(global_to_local[global_col] == kInvalidCol ||
-          global_to_local[global_col] == local_col)
-        << "If the mapping is already assigned it has to be the same.";
-    global_to_local[global_col] = local_col;
 
     lp->SetVariableName(local_col,
                         original_problem_->GetVariableName(global_col));
@@ -112,24 +142,8 @@ void LPDecomposer::ExtractLocalProblem(int problem_index, LinearProgram* lp) {
         local_col, original_problem_->objective_coefficients()[global_col]);
 
     for (const SparseColumn::Entry e : original_matrix.column(global_col)) {
-      constraints_to_use.Set(e.row());
-    }
-  }
-  // Create the constraints.
-  for (const RowIndex global_row :
-       constraints_to_use.PositionsSetAtLeastOnce()) {
-    const RowIndex local_row = lp->CreateNewConstraint();
-    lp->SetConstraintName(local_row,
-                          original_problem_->GetConstraintName(global_row));
-    lp->SetConstraintBounds(
-        local_row, original_problem_->constraint_lower_bounds()[global_row],
-        original_problem_->constraint_upper_bounds()[global_row]);
-
-    for (const SparseColumn::Entry e :
-         transposed_matrix.column(RowToColIndex(global_row))) {
-      const ColIndex global_col = RowToColIndex(e.row());
-      const ColIndex local_col = global_to_local[global_col];
-      lp->SetCoefficient(local_row, local_col, e.coefficient());
+      DCHECK_NE(local_rows_[e.row()], kInvalidRow);
+      lp->SetCoefficient(local_rows_[e.row()], local_col, e.coefficient());
     }
   }
 }
@@ -138,7 +152,7 @@ DenseRow LPDecomposer::AggregateAssignments(
     const std::vector<DenseRow>& assignments) const {
   CHECK_EQ(assignments.size(), clusters_.size());
 
-  absl::MutexLock mutex_lock(&mutex_);
+  absl::ReaderMutexLock mutex_lock(&mutex_);
   DenseRow global_assignment(original_problem_->num_variables(),
                              Fractional(0.0));
   for (int problem = 0; problem < assignments.size(); ++problem) {
@@ -158,7 +172,7 @@ DenseRow LPDecomposer::ExtractLocalAssignment(int problem_index,
   CHECK_LT(problem_index, clusters_.size());
   CHECK_EQ(assignment.size(), original_problem_->num_variables());
 
-  absl::MutexLock mutex_lock(&mutex_);
+  absl::ReaderMutexLock mutex_lock(&mutex_);
   const std::vector<ColIndex>& cluster = clusters_[problem_index];
   DenseRow local_assignment(ColIndex(cluster.size()), Fractional(0.0));
   for (int i = 0; i < cluster.size(); ++i) {
@@ -69,10 +69,22 @@ class LPDecomposer {
 
   // Fills lp with the problem_index^th independent problem generated by
   // Decompose().
-  // Note that this method runs in O(num-entries-in-generated-problem).
+  // Note that this method runs in O(num-entries-in-generated-problem). It can
+  // be called concurrently for different problems.
   void ExtractLocalProblem(int problem_index, LinearProgram* lp)
       ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Returns the variables (resp. constraints) of the original problem that form
+  // the problem_index^th independent problem, in increasing order. The i-th
+  // variable (resp. constraint) of the problem filled by ExtractLocalProblem()
+  // is the i-th element of this vector, so a local solution can be scattered
+  // directly into a solution of the original problem. Note that constraints
+  // without any entries are not part of any problem.
+  const std::vector<ColIndex>& GetProblemColumns(int problem_index) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  const std::vector<RowIndex>& GetProblemRows(int problem_index) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
   // Returns an assignment to the original problem based on the assignments
   // to the independent problems. Requires Decompose() to have been called.
   DenseRow AggregateAssignments(const std::vector<DenseRow>& assignments) const
@@ -86,6 +98,11 @@ class LPDecomposer {
  private:
   const LinearProgram* original_problem_;
   std::vector<std::vector<ColIndex>> clusters_;
+  std::vector<std::vector<RowIndex>> row_clusters_;
+
+  // Index of each constraint of the original problem in its cluster, i.e. in
+  // its local problem.
+  StrictITIVector<RowIndex, RowIndex> local_rows_;
 
   mutable absl::Mutex mutex_;
 };
@@ -0,0 +1,485 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/lp_data/lp_snapshot.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "ortools/base/file.h"
+#include "ortools/base/logging.h"
+#include "ortools/base/status_macros.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/lp_data/sparse_column.h"
+
+namespace operations_research {
+namespace glop {
+
+namespace {
+
+// The arrays are reinterpreted in place, so the index types must have the
+// layout of the integers that are stored.
+static_assert(sizeof(RowIndex) == sizeof(int32_t));
+static_assert(sizeof(EntryIndex) == sizeof(int64_t));
+static_assert(sizeof(Fractional) == sizeof(double));
+
+constexpr char kMagic[8] = {'G', 'L', 'O', 'P', 'S', 'N', 'A', 'P'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+constexpr size_t kAlignment = 64;
+
+enum HeaderFlags : uint32_t {
+  kMaximize = 1,
+  kHasNames = 2,
+};
+
+// The arrays of a snapshot, in the order in which they are written.
+enum Section {
+  kStarts,
+  kRows,
+  kCoefficients,
+  kObjectiveCoefficients,
+  kVariableLowerBounds,
+  kVariableUpperBounds,
+  kVariableTypes,
+  kConstraintLowerBounds,
+  kConstraintUpperBounds,
+  kProblemName,
+  kVariableNameStarts,
+  kVariableNames,
+  kConstraintNameStarts,
+  kConstraintNames,
+  kNumSections
+};
+
+struct SectionInfo {
+  uint64_t offset;
+  uint64_t size;
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order_mark;
+  uint32_t flags;
+  uint32_t reserved;
+  int64_t num_rows;
+  int64_t num_cols;
+  int64_t num_entries;
+  double objective_offset;
+  double objective_scaling_factor;
+  SectionInfo sections[kNumSections];
+};
+
+uint64_t AlignUp(uint64_t offset) {
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// Writes the sections of a snapshot, buffering the small writes.
+class SnapshotWriter {
+ public:
+  explicit SnapshotWriter(File* file) : file_(file) {}
+
+  absl::Status Append(const void* data, size_t size) {
+    buffer_.append(static_cast<const char*>(data), size);
+    offset_ += size;
+    if (buffer_.size() >= kBufferSize) return Flush();
+    return absl::OkStatus();
+  }
+
+  // Pads the file with zeros up to the given offset.
+  void PadTo(uint64_t offset) {
+    DCHECK_GE(offset, offset_);
+    buffer_.append(offset - offset_, '\0');
+    offset_ = offset;
+  }
+
+  absl::Status Flush() {
+    RETURN_IF_ERROR(file::WriteString(file_, buffer_, file::Defaults()));
+    buffer_.clear();
+    return absl::OkStatus();
+  }
+
+ private:
+  static constexpr size_t kBufferSize = 1 << 20;
+
+  File* file_;
+  std::string buffer_;
+  uint64_t offset_ = 0;
+};
+
+// Returns the concatenation of the given names, and their starts.
+void ConcatenateNames(const std::vector<std::string>& names,
+                      std::vector<int64_t>* starts, std::string* all_names) {
+  starts->clear();
+  starts->reserve(names.size() + 1);
+  all_names->clear();
+  starts->push_back(0);
+  for (const std::string& name : names) {
+    all_names->append(name);
+    starts->push_back(all_names->size());
+  }
+}
+
+// Checks that starts has size + 1 non-decreasing elements from 0 to end.
+bool AreValidStarts(const int64_t* starts, int64_t size, int64_t end) {
+  if (starts[0] != 0 || starts[size] != end) return false;
+  for (int64_t i = 0; i < size; ++i) {
+    if (starts[i] > starts[i + 1]) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+absl::Status WriteLinearProgramSnapshot(const LinearProgram& linear_program,
+                                        absl::string_view file_name,
+                                        bool include_names) {
+  const RowIndex num_rows = linear_program.num_constraints();
+  const ColIndex num_cols = linear_program.num_variables();
+  const EntryIndex num_entries = linear_program.num_entries();
+
+  std::vector<int64_t> variable_name_starts;
+  std::string variable_names;
+  std::vector<int64_t> constraint_name_starts;
+  std::string constraint_names;
+  if (include_names) {
+    std::vector<std::string> names;
+    names.reserve(num_cols.value());
+    for (ColIndex col(0); col < num_cols; ++col) {
+      names.push_back(linear_program.GetVariableName(col));
+    }
+    ConcatenateNames(names, &variable_name_starts, &variable_names);
+    names.clear();
+    for (RowIndex row(0); row < num_rows; ++row) {
+      names.push_back(linear_program.GetConstraintName(row));
+    }
+    ConcatenateNames(names, &constraint_name_starts, &constraint_names);
+  }
+
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.byte_order_mark = kByteOrderMark;
+  header.flags = (linear_program.IsMaximizationProblem() ? kMaximize : 0) |
+                 (include_names ? kHasNames : 0);
+  header.num_rows = num_rows.value();
+  header.num_cols = num_cols.value();
+  header.num_entries = num_entries.value();
+  header.objective_offset = linear_program.objective_offset();
+  header.objective_scaling_factor = linear_program.objective_scaling_factor();
+
+  const uint64_t section_sizes[kNumSections] = {
+      (header.num_cols + 1) * sizeof(int64_t),
+      header.num_entries * sizeof(int32_t),
+      header.num_entries * sizeof(double),
+      header.num_cols * sizeof(double),
+      header.num_cols * sizeof(double),
+      header.num_cols * sizeof(double),
+      header.num_cols * sizeof(int8_t),
+      header.num_rows * sizeof(double),
+      header.num_rows * sizeof(double),
+      include_names ? linear_program.name().size() : 0,
+      variable_name_starts.size() * sizeof(int64_t),
+      variable_names.size(),
+      constraint_name_starts.size() * sizeof(int64_t),
+      constraint_names.size()};
+  uint64_t offset = AlignUp(sizeof(Header));
+  for (int s = 0; s < kNumSections; ++s) {
+    header.sections[s].offset = offset;
+    header.sections[s].size = section_sizes[s];
+    offset = AlignUp(offset + section_sizes[s]);
+  }
+
+  File* file;
+  RETURN_IF_ERROR(file::Open(file_name, "w", &file, file::Defaults()));
+  SnapshotWriter writer(file);
+  const auto write_section = [&header, &writer](Section section,
+                                                const void* data) {
+    writer.PadTo(header.sections[section].offset);
+    return writer.Append(data, header.sections[section].size);
+  };
+  absl::Status status = [&]() -> absl::Status {
+    RETURN_IF_ERROR(writer.Append(&header, sizeof(header)));
+
+    // The columns are not contiguous in a SparseMatrix, so we write the matrix
+    // column by column.
+    std::vector<int64_t> starts;
+    starts.reserve(num_cols.value() + 1);
+    starts.push_back(0);
+    for (ColIndex col(0); col < num_cols; ++col) {
+      starts.push_back(
+          starts.back() +
+          linear_program.GetSparseColumn(col).num_entries().value());
+    }
+    RETURN_IF_ERROR(write_section(kStarts, starts.data()));
+    writer.PadTo(header.sections[kRows].offset);
+    for (ColIndex col(0); col < num_cols; ++col) {
+      for (const SparseColumn::Entry e : linear_program.GetSparseColumn(col)) {
+        const int32_t row = e.row().value();
+        RETURN_IF_ERROR(writer.Append(&row, sizeof(row)));
+      }
+    }
+    writer.PadTo(header.sections[kCoefficients].offset);
+    for (ColIndex col(0); col < num_cols; ++col) {
+      for (const SparseColumn::Entry e : linear_program.GetSparseColumn(col)) {
+        const double coefficient = e.coefficient();
+        RETURN_IF_ERROR(writer.Append(&coefficient, sizeof(coefficient)));
+      }
+    }
+
+    RETURN_IF_ERROR(write_section(
+        kObjectiveCoefficients,
+        linear_program.objective_coefficients().data()));
+    RETURN_IF_ERROR(write_section(
+        kVariableLowerBounds, linear_program.variable_lower_bounds().data()));
+    RETURN_IF_ERROR(write_section(
+        kVariableUpperBounds, linear_program.variable_upper_bounds().data()));
+    std::vector<int8_t> variable_types(num_cols.value());
+    for (ColIndex col(0); col < num_cols; ++col) {
+      variable_types[col.value()] =
+          static_cast<int8_t>(linear_program.GetVariableType(col));
+    }
+    RETURN_IF_ERROR(write_section(kVariableTypes, variable_types.data()));
+    RETURN_IF_ERROR(write_section(
+        kConstraintLowerBounds,
+        linear_program.constraint_lower_bounds().data()));
+    RETURN_IF_ERROR(write_section(
+        kConstraintUpperBounds,
+        linear_program.constraint_upper_bounds().data()));
+    RETURN_IF_ERROR(
+        write_section(kProblemName, linear_program.name().data()));
+    RETURN_IF_ERROR(
+        write_section(kVariableNameStarts, variable_name_starts.data()));
+    RETURN_IF_ERROR(write_section(kVariableNames, variable_names.data()));
+    RETURN_IF_ERROR(
+        write_section(kConstraintNameStarts, constraint_name_starts.data()));
+    RETURN_IF_ERROR(write_section(kConstraintNames, constraint_names.data()));
+    writer.PadTo(offset);
+    return writer.Flush();
+  }();
+  const absl::Status close_status = file->Close(file::Defaults());
+  if (status.ok()) status = close_status;
+  return status;
+}
+
+absl::Status LoadLinearProgramFromSnapshot(absl::string_view file_name,
+                                           LinearProgram* linear_program) {
+  ASSIGN_OR_RETURN(const std::unique_ptr<LinearProgramSnapshot> snapshot,
+                   LinearProgramSnapshot::Open(file_name));
+  snapshot->CopyTo(linear_program);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<LinearProgramSnapshot>>
+LinearProgramSnapshot::Open(absl::string_view file_name) {
+  std::unique_ptr<LinearProgramSnapshot> snapshot(new LinearProgramSnapshot());
+  ASSIGN_OR_RETURN(snapshot->file_, FileContents::Open(file_name));
+  RETURN_IF_ERROR(snapshot->Parse(snapshot->file_->contents()));
+  return snapshot;
+}
+
+absl::Status LinearProgramSnapshot::Parse(absl::string_view contents) {
+  Header header;
+  if (contents.size() < sizeof(header)) {
+    return absl::InvalidArgumentError("LP snapshot: file too small.");
+  }
+  memcpy(&header, contents.data(), sizeof(header));
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return absl::InvalidArgumentError("LP snapshot: wrong magic number.");
+  }
+  if (header.version != kVersion) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("LP snapshot: unsupported version ", header.version));
+  }
+  if (header.byte_order_mark != kByteOrderMark) {
+    return absl::InvalidArgumentError(
+        "LP snapshot: written on a machine with another byte order.");
+  }
+  constexpr int64_t kMaxIndex = std::numeric_limits<int32_t>::max();
+  if (header.num_rows < 0 || header.num_rows > kMaxIndex ||
+      header.num_cols < 0 || header.num_cols > kMaxIndex ||
+      header.num_entries < 0) {
+    return absl::InvalidArgumentError("LP snapshot: invalid dimensions.");
+  }
+  // Each entry takes 12 bytes in the file, so this bounds num_entries well
+  // below 2^61 and none of the section sizes below can overflow.
+  if (static_cast<uint64_t>(header.num_entries) >
+      contents.size() / (sizeof(int32_t) + sizeof(double))) {
+    return absl::InvalidArgumentError(
+        "LP snapshot: too many entries for the file size.");
+  }
+  maximize_ = (header.flags & kMaximize) != 0;
+  has_names_ = (header.flags & kHasNames) != 0;
+
+  // Checks that each section is in the file, aligned, and has the expected
+  // size. The size of the name sections is only known after reading the
+  // starts.
+  const uint64_t num_rows = header.num_rows;
+  const uint64_t num_cols = header.num_cols;
+  const uint64_t num_entries = header.num_entries;
+  const uint64_t expected_sizes[kNumSections] = {
+      (num_cols + 1) * sizeof(int64_t),
+      num_entries * sizeof(int32_t),
+      num_entries * sizeof(double),
+      num_cols * sizeof(double),
+      num_cols * sizeof(double),
+      num_cols * sizeof(double),
+      num_cols * sizeof(int8_t),
+      num_rows * sizeof(double),
+      num_rows * sizeof(double),
+      header.sections[kProblemName].size,
+      has_names_ ? (num_cols + 1) * sizeof(int64_t) : 0,
+      header.sections[kVariableNames].size,
+      has_names_ ? (num_rows + 1) * sizeof(int64_t) : 0,
+      header.sections[kConstraintNames].size};
+  const char* section_data[kNumSections];
+  for (int s = 0; s < kNumSections; ++s) {
+    const SectionInfo& section = header.sections[s];
+    if (section.size != expected_sizes[s] ||
+        section.offset % kAlignment != 0 || section.offset > contents.size() ||
+        section.size > contents.size() - section.offset) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("LP snapshot: invalid section #", s));
+    }
+    section_data[s] = contents.data() + section.offset;
+  }
+
+  num_rows_ = RowIndex(header.num_rows);
+  num_cols_ = ColIndex(header.num_cols);
+  num_entries_ = EntryIndex(header.num_entries);
+  objective_offset_ = header.objective_offset;
+  objective_scaling_factor_ = header.objective_scaling_factor;
+  starts_ = reinterpret_cast<const EntryIndex*>(section_data[kStarts]);
+  rows_ = reinterpret_cast<const RowIndex*>(section_data[kRows]);
+  coefficients_ =
+      reinterpret_cast<const Fractional*>(section_data[kCoefficients]);
+  objective_coefficients_ =
+      reinterpret_cast<const Fractional*>(section_data[kObjectiveCoefficients]);
+  variable_lower_bounds_ =
+      reinterpret_cast<const Fractional*>(section_data[kVariableLowerBounds]);
+  variable_upper_bounds_ =
+      reinterpret_cast<const Fractional*>(section_data[kVariableUpperBounds]);
+  variable_types_ =
+      reinterpret_cast<const int8_t*>(section_data[kVariableTypes]);
+  constraint_lower_bounds_ =
+      reinterpret_cast<const Fractional*>(section_data[kConstraintLowerBounds]);
+  constraint_upper_bounds_ =
+      reinterpret_cast<const Fractional*>(section_data[kConstraintUpperBounds]);
+  name_ = absl::string_view(section_data[kProblemName],
+                            header.sections[kProblemName].size);
+
+  // Validates the index arrays so that the accessors never read outside of
+  // the file.
+  if (!AreValidStarts(reinterpret_cast<const int64_t*>(starts_),
+                      header.num_cols, header.num_entries)) {
+    return absl::InvalidArgumentError("LP snapshot: invalid column starts.");
+  }
+  const int32_t* const rows = reinterpret_cast<const int32_t*>(rows_);
+  for (int64_t i = 0; i < header.num_entries; ++i) {
+    if (rows[i] < 0 || rows[i] >= header.num_rows) {
+      return absl::InvalidArgumentError("LP snapshot: invalid row index.");
+    }
+  }
+  for (int64_t col = 0; col < header.num_cols; ++col) {
+    if (variable_types_[col] < 0 ||
+        variable_types_[col] >
+            static_cast<int8_t>(LinearProgram::VariableType::IMPLIED_INTEGER)) {
+      return absl::InvalidArgumentError("LP snapshot: invalid variable type.");
+    }
+  }
+  if (has_names_) {
+    variable_name_starts_ =
+        reinterpret_cast<const int64_t*>(section_data[kVariableNameStarts]);
+    variable_names_ = section_data[kVariableNames];
+    constraint_name_starts_ =
+        reinterpret_cast<const int64_t*>(section_data[kConstraintNameStarts]);
+    constraint_names_ = section_data[kConstraintNames];
+    if (!AreValidStarts(variable_name_starts_, header.num_cols,
+                        header.sections[kVariableNames].size) ||
+        !AreValidStarts(constraint_name_starts_, header.num_rows,
+                        header.sections[kConstraintNames].size)) {
+      return absl::InvalidArgumentError("LP snapshot: invalid name starts.");
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::string_view LinearProgramSnapshot::variable_name(ColIndex col) const {
+  if (!has_names_) return absl::string_view();
+  const int64_t start = variable_name_starts_[col.value()];
+  return absl::string_view(variable_names_ + start,
+                           variable_name_starts_[col.value() + 1] - start);
+}
+
+absl::string_view LinearProgramSnapshot::constraint_name(RowIndex row) const {
+  if (!has_names_) return absl::string_view();
+  const int64_t start = constraint_name_starts_[row.value()];
+  return absl::string_view(constraint_names_ + start,
+                           constraint_name_starts_[row.value() + 1] - start);
+}
+
+void LinearProgramSnapshot::CopyTo(LinearProgram* linear_program) const {
+  linear_program->Clear();
+  linear_program->SetName(name_);
+  linear_program->SetMaximizationProblem(maximize_);
+  linear_program->SetObjectiveOffset(objective_offset_);
+  linear_program->SetObjectiveScalingFactor(objective_scaling_factor_);
+  for (RowIndex row(0); row < num_rows_; ++row) {
+    linear_program->CreateNewConstraint();
+  }
+  *linear_program->mutable_constraint_lower_bounds() =
+      constraint_lower_bounds();
+  *linear_program->mutable_constraint_upper_bounds() =
+      constraint_upper_bounds();
+  const auto matrix_view = matrix();
+  for (ColIndex col(0); col < num_cols_; ++col) {
+    linear_program->CreateNewVariable();
+    linear_program->SetVariableBounds(col, variable_lower_bounds_[col.value()],
+                                      variable_upper_bounds_[col.value()]);
+    linear_program->SetObjectiveCoefficient(
+        col, objective_coefficients_[col.value()]);
+    if (variable_type(col) != LinearProgram::VariableType::CONTINUOUS) {
+      linear_program->SetVariableType(col, variable_type(col));
+    }
+    SparseColumn* const column = linear_program->GetMutableSparseColumn(col);
+    column->Reserve(matrix_view.ColumnNumEntries(col));
+    for (const EntryIndex i : matrix_view.Column(col)) {
+      column->SetCoefficient(matrix_view.EntryRow(i),
+                             matrix_view.EntryCoefficient(i));
+    }
+  }
+  if (has_names_) {
+    for (ColIndex col(0); col < num_cols_; ++col) {
+      linear_program->SetVariableName(col, variable_name(col));
+    }
+    for (RowIndex row(0); row < num_rows_; ++row) {
+      linear_program->SetConstraintName(row, constraint_name(row));
+    }
+  }
+  linear_program->CleanUp();
+}
+
+}  // namespace glop
+}  // namespace operations_research
@@ -0,0 +1,165 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Binary snapshot format for a LinearProgram.
+//
+// Unlike MPS or MPModelProto, there is nothing to parse: the file stores the
+// constraint matrix in compressed sparse column format, the bounds, the
+// objective and, optionally, the names as flat arrays, each aligned on 64
+// bytes. A snapshot can thus be memory-mapped and used in place, or copied
+// into a LinearProgram at about the speed of a memcpy().
+//
+// The layout is a fixed header, that contains the offset and size of each
+// array, followed by the arrays. The header stores a version number and the
+// byte order of the machine that wrote the file; a file with another version or
+// byte order is rejected. All the integers and doubles are stored in the native
+// format of the writer.
+//
+// Note that the slack variables and the name to index tables of the
+// LinearProgram are not stored: the slack variables are saved as normal
+// variables.
+#ifndef OR_TOOLS_LP_DATA_LP_SNAPSHOT_H_
+#define OR_TOOLS_LP_DATA_LP_SNAPSHOT_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/lp_data/sparse.h"
+#include "ortools/lp_data/sparse_column.h"
+#include "ortools/util/file_contents.h"
+
+namespace operations_research {
+namespace glop {
+
+// Writes the given LinearProgram to a snapshot file. If include_names is false,
+// the names of the problem, of the variables and of the constraints are not
+// saved, which makes the file smaller.
+absl::Status WriteLinearProgramSnapshot(const LinearProgram& linear_program,
+                                        absl::string_view file_name,
+                                        bool include_names = true);
+
+// Reads a snapshot file into the given LinearProgram. This is a shortcut for
+// LinearProgramSnapshot::Open() followed by CopyTo().
+absl::Status LoadLinearProgramFromSnapshot(absl::string_view file_name,
+                                           LinearProgram* linear_program);
+
+// Read-only view of a snapshot file. The file is memory-mapped when possible,
+// and all the accessors below point directly to its content, so opening a
+// snapshot costs a validation pass over the index arrays but no copy.
+class LinearProgramSnapshot {
+ public:
+  // Opens and validates the given file. Returns an InvalidArgumentError if it
+  // is not a valid snapshot of a supported version.
+  static absl::StatusOr<std::unique_ptr<LinearProgramSnapshot>> Open(
+      absl::string_view file_name);
+
+  // This type is neither copyable nor movable.
+  LinearProgramSnapshot(const LinearProgramSnapshot&) = delete;
+  LinearProgramSnapshot& operator=(const LinearProgramSnapshot&) = delete;
+
+  RowIndex num_rows() const { return num_rows_; }
+  ColIndex num_cols() const { return num_cols_; }
+  EntryIndex num_entries() const { return num_entries_; }
+
+  // The constraint matrix, with the same interface as a CompactSparseMatrix.
+  CompactSparseMatrix::ConstView matrix() const {
+    return CompactSparseMatrix::ConstView(coefficients_, rows_, starts_);
+  }
+  ColumnView column(ColIndex col) const {
+    const EntryIndex start = starts_[col.value()];
+    return ColumnView(starts_[col.value() + 1] - start, rows_ + start.value(),
+                      coefficients_ + start.value());
+  }
+
+  DenseRow::ConstView objective_coefficients() const {
+    return DenseRow::ConstView(objective_coefficients_, num_cols_);
+  }
+  DenseRow::ConstView variable_lower_bounds() const {
+    return DenseRow::ConstView(variable_lower_bounds_, num_cols_);
+  }
+  DenseRow::ConstView variable_upper_bounds() const {
+    return DenseRow::ConstView(variable_upper_bounds_, num_cols_);
+  }
+  DenseColumn::ConstView constraint_lower_bounds() const {
+    return DenseColumn::ConstView(constraint_lower_bounds_, num_rows_);
+  }
+  DenseColumn::ConstView constraint_upper_bounds() const {
+    return DenseColumn::ConstView(constraint_upper_bounds_, num_rows_);
+  }
+  LinearProgram::VariableType variable_type(ColIndex col) const {
+    return static_cast<LinearProgram::VariableType>(
+        variable_types_[col.value()]);
+  }
+
+  bool IsMaximizationProblem() const { return maximize_; }
+  Fractional objective_offset() const { return objective_offset_; }
+  Fractional objective_scaling_factor() const {
+    return objective_scaling_factor_;
+  }
+
+  // The names are empty if the snapshot was written without them.
+  bool has_names() const { return has_names_; }
+  absl::string_view name() const { return name_; }
+  absl::string_view variable_name(ColIndex col) const;
+  absl::string_view constraint_name(RowIndex row) const;
+
+  // Copies the snapshot into the given LinearProgram, which is cleared first.
+  void CopyTo(LinearProgram* linear_program) const;
+
+ private:
+  LinearProgramSnapshot() = default;
+
+  // Reads the header and sets all the pointers below, checking that the
+  // content is consistent.
+  absl::Status Parse(absl::string_view contents);
+
+  // The file content. Its start is aligned, so all the arrays below are too.
+  std::unique_ptr<FileContents> file_;
+
+  RowIndex num_rows_;
+  ColIndex num_cols_;
+  EntryIndex num_entries_;
+  bool maximize_ = false;
+  bool has_names_ = false;
+  Fractional objective_offset_ = 0.0;
+  Fractional objective_scaling_factor_ = 1.0;
+
+  const EntryIndex* starts_ = nullptr;
+  const RowIndex* rows_ = nullptr;
+  const Fractional* coefficients_ = nullptr;
+  const Fractional* objective_coefficients_ = nullptr;
+  const Fractional* variable_lower_bounds_ = nullptr;
+  const Fractional* variable_upper_bounds_ = nullptr;
+  const int8_t* variable_types_ = nullptr;
+  const Fractional* constraint_lower_bounds_ = nullptr;
+  const Fractional* constraint_upper_bounds_ = nullptr;
+
+  // The names are stored one after the other, the name of the i-th variable
+  // being in [variable_name_starts_[i], variable_name_starts_[i + 1]).
+  absl::string_view name_;
+  const int64_t* variable_name_starts_ = nullptr;
+  const char* variable_names_ = nullptr;
+  const int64_t* constraint_name_starts_ = nullptr;
+  const char* constraint_names_ = nullptr;
+};
+
+}  // namespace glop
+}  // namespace operations_research
+
+#endif  // OR_TOOLS_LP_DATA_LP_SNAPSHOT_H_
@@ -0,0 +1,411 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/lp_data/lp_snapshot.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "ortools/base/file.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+
+namespace operations_research {
+namespace glop {
+namespace {
+
+// Offsets in the header of a snapshot, see Header in lp_snapshot.cc.
+constexpr int kVersionOffset = 8;
+constexpr int kByteOrderMarkOffset = 12;
+constexpr int kNumRowsOffset = 24;
+constexpr int kNumEntriesOffset = 40;
+constexpr int kSectionsOffset = 64;
+constexpr int kSectionInfoSize = 16;
+// Sections, in the order of the Section enum of lp_snapshot.cc.
+constexpr int kStartsSection = 0;
+constexpr int kRowsSection = 1;
+constexpr int kCoefficientsSection = 2;
+constexpr int kNumSections = 14;
+constexpr int kHeaderSize = kSectionsOffset + kNumSections * kSectionInfoSize;
+
+std::string TestFile(absl::string_view name) {
+  return absl::StrCat(::testing::TempDir(), "/", name, ".glopsnap");
+}
+
+// max 2x + 3y - z + 1.5 with:
+//   c1: 1 <= x + y <= 10
+//   c2: -inf <= 2x - z <= 4
+//   c3: y + z = 3
+//   x in [0, 5], y integer in [-inf, 7], z free.
+void BuildTestLinearProgram(LinearProgram* linear_program) {
+  LinearProgram& lp = *linear_program;
+  lp.SetName("test_lp");
+  const ColIndex x = lp.CreateNewVariable();
+  const ColIndex y = lp.CreateNewVariable();
+  const ColIndex z = lp.CreateNewVariable();
+  lp.SetVariableName(x, "x");
+  lp.SetVariableName(y, "y");
+  lp.SetVariableName(z, "z");
+  lp.SetVariableBounds(x, 0.0, 5.0);
+  lp.SetVariableBounds(y, -kInfinity, 7.0);
+  lp.SetVariableBounds(z, -kInfinity, kInfinity);
+  lp.SetVariableType(y, LinearProgram::VariableType::INTEGER);
+  lp.SetObjectiveCoefficient(x, 2.0);
+  lp.SetObjectiveCoefficient(y, 3.0);
+  lp.SetObjectiveCoefficient(z, -1.0);
+  lp.SetObjectiveOffset(1.5);
+  lp.SetObjectiveScalingFactor(2.0);
+  lp.SetMaximizationProblem(true);
+  const RowIndex c1 = lp.CreateNewConstraint();
+  const RowIndex c2 = lp.CreateNewConstraint();
+  const RowIndex c3 = lp.CreateNewConstraint();
+  lp.SetConstraintName(c1, "c1");
+  lp.SetConstraintName(c2, "c2");
+  lp.SetConstraintName(c3, "c3");
+  lp.SetConstraintBounds(c1, 1.0, 10.0);
+  lp.SetConstraintBounds(c2, -kInfinity, 4.0);
+  lp.SetConstraintBounds(c3, 3.0, 3.0);
+  lp.SetCoefficient(c1, x, 1.0);
+  lp.SetCoefficient(c1, y, 1.0);
+  lp.SetCoefficient(c2, x, 2.0);
+  lp.SetCoefficient(c2, z, -1.0);
+  lp.SetCoefficient(c3, y, 1.0);
+  lp.SetCoefficient(c3, z, 1.0);
+  lp.CleanUp();
+}
+
+void ExpectSameLinearProgram(const LinearProgram& expected,
+                             const LinearProgram& actual, bool with_names) {
+  ASSERT_EQ(actual.num_variables(), expected.num_variables());
+  ASSERT_EQ(actual.num_constraints(), expected.num_constraints());
+  EXPECT_EQ(actual.num_entries(), expected.num_entries());
+  EXPECT_EQ(actual.IsMaximizationProblem(), expected.IsMaximizationProblem());
+  EXPECT_EQ(actual.objective_offset(), expected.objective_offset());
+  EXPECT_EQ(actual.objective_scaling_factor(),
+            expected.objective_scaling_factor());
+  if (with_names) EXPECT_EQ(actual.name(), expected.name());
+  for (ColIndex col(0); col < expected.num_variables(); ++col) {
+    EXPECT_EQ(actual.objective_coefficients()[col],
+              expected.objective_coefficients()[col]);
+    EXPECT_EQ(actual.variable_lower_bounds()[col],
+              expected.variable_lower_bounds()[col]);
+    EXPECT_EQ(actual.variable_upper_bounds()[col],
+              expected.variable_upper_bounds()[col]);
+    EXPECT_EQ(actual.GetVariableType(col), expected.GetVariableType(col));
+    if (with_names) {
+      EXPECT_EQ(actual.GetVariableName(col), expected.GetVariableName(col));
+    }
+    const SparseColumn& expected_column = expected.GetSparseColumn(col);
+    const SparseColumn& actual_column = actual.GetSparseColumn(col);
+    ASSERT_EQ(actual_column.num_entries(), expected_column.num_entries());
+    for (EntryIndex i(0); i < expected_column.num_entries(); ++i) {
+      EXPECT_EQ(actual_column.EntryRow(i), expected_column.EntryRow(i));
+      EXPECT_EQ(actual_column.EntryCoefficient(i),
+                expected_column.EntryCoefficient(i));
+    }
+  }
+  for (RowIndex row(0); row < expected.num_constraints(); ++row) {
+    EXPECT_EQ(actual.constraint_lower_bounds()[row],
+              expected.constraint_lower_bounds()[row]);
+    EXPECT_EQ(actual.constraint_upper_bounds()[row],
+              expected.constraint_upper_bounds()[row]);
+    if (with_names) {
+      EXPECT_EQ(actual.GetConstraintName(row),
+                expected.GetConstraintName(row));
+    }
+  }
+}
+
+std::string ReadFile(absl::string_view file_name) {
+  std::string contents;
+  CHECK_OK(file::GetContents(file_name, &contents, file::Defaults()));
+  return contents;
+}
+
+void WriteFile(absl::string_view file_name, absl::string_view contents) {
+  CHECK_OK(file::SetContents(file_name, contents, file::Defaults()));
+}
+
+template <typename T>
+void Overwrite(std::string& contents, int offset, T value) {
+  memcpy(contents.data() + offset, &value, sizeof(value));
+}
+
+template <typename T>
+T Read(const std::string& contents, int offset) {
+  T value;
+  memcpy(&value, contents.data() + offset, sizeof(value));
+  return value;
+}
+
+// Returns the contents of a valid snapshot of the test linear program.
+std::string ValidSnapshot(absl::string_view name) {
+  const std::string file_name = TestFile(name);
+  LinearProgram lp;
+  BuildTestLinearProgram(&lp);
+  CHECK_OK(WriteLinearProgramSnapshot(lp, file_name));
+  return ReadFile(file_name);
+}
+
+absl::Status OpenContents(absl::string_view name, absl::string_view contents) {
+  const std::string file_name = TestFile(name);
+  WriteFile(file_name, contents);
+  return LinearProgramSnapshot::Open(file_name).status();
+}
+
+TEST(LinearProgramSnapshotTest, RoundTripWithNames) {
+  LinearProgram lp;
+  BuildTestLinearProgram(&lp);
+  const std::string file_name = TestFile("round_trip_with_names");
+  ASSERT_TRUE(WriteLinearProgramSnapshot(lp, file_name).ok());
+
+  const absl::StatusOr<std::unique_ptr<LinearProgramSnapshot>> snapshot =
+      LinearProgramSnapshot::Open(file_name);
+  ASSERT_TRUE(snapshot.ok()) << snapshot.status();
+  EXPECT_EQ((*snapshot)->num_rows(), RowIndex(3));
+  EXPECT_EQ((*snapshot)->num_cols(), ColIndex(3));
+  EXPECT_EQ((*snapshot)->num_entries(), EntryIndex(6));
+  EXPECT_TRUE((*snapshot)->IsMaximizationProblem());
+  EXPECT_TRUE((*snapshot)->has_names());
+  EXPECT_EQ((*snapshot)->name(), "test_lp");
+  EXPECT_EQ((*snapshot)->variable_name(ColIndex(1)), "y");
+  EXPECT_EQ((*snapshot)->constraint_name(RowIndex(2)), "c3");
+  EXPECT_EQ((*snapshot)->variable_type(ColIndex(1)),
+            LinearProgram::VariableType::INTEGER);
+  EXPECT_EQ((*snapshot)->column(ColIndex(2)).num_entries(), EntryIndex(2));
+
+  LinearProgram copy;
+  (*snapshot)->CopyTo(&copy);
+  ExpectSameLinearProgram(lp, copy, /*with_names=*/true);
+}
+
+TEST(LinearProgramSnapshotTest, RoundTripWithoutNames) {
+  LinearProgram lp;
+  BuildTestLinearProgram(&lp);
+  const std::string file_name = TestFile("round_trip_without_names");
+  ASSERT_TRUE(
+      WriteLinearProgramSnapshot(lp, file_name, /*include_names=*/false).ok());
+
+  const absl::StatusOr<std::unique_ptr<LinearProgramSnapshot>> snapshot =
+      LinearProgramSnapshot::Open(file_name);
+  ASSERT_TRUE(snapshot.ok()) << snapshot.status();
+  EXPECT_FALSE((*snapshot)->has_names());
+  EXPECT_EQ((*snapshot)->name(), "");
+  EXPECT_EQ((*snapshot)->variable_name(ColIndex(0)), "");
+  EXPECT_EQ((*snapshot)->constraint_name(RowIndex(0)), "");
+
+  LinearProgram copy;
+  (*snapshot)->CopyTo(&copy);
+  ExpectSameLinearProgram(lp, copy, /*with_names=*/false);
+  EXPECT_EQ(copy.name(), "");
+}
+
+TEST(LinearProgramSnapshotTest, LoadLinearProgramFromSnapshot) {
+  LinearProgram lp;
+  BuildTestLinearProgram(&lp);
+  const std::string file_name = TestFile("load");
+  ASSERT_TRUE(WriteLinearProgramSnapshot(lp, file_name).ok());
+  LinearProgram copy;
+  // The previous content of the LinearProgram is cleared.
+  copy.CreateNewVariable();
+  ASSERT_TRUE(LoadLinearProgramFromSnapshot(file_name, &copy).ok());
+  ExpectSameLinearProgram(lp, copy, /*with_names=*/true);
+}
+
+TEST(LinearProgramSnapshotTest, EmptyLinearProgram) {
+  const LinearProgram lp;
+  const std::string file_name = TestFile("empty");
+  ASSERT_TRUE(WriteLinearProgramSnapshot(lp, file_name).ok());
+  LinearProgram copy;
+  ASSERT_TRUE(LoadLinearProgramFromSnapshot(file_name, &copy).ok());
+  ExpectSameLinearProgram(lp, copy, /*with_names=*/true);
+}
+
+TEST(LinearProgramSnapshotTest, RejectsMissingFile) {
+  EXPECT_FALSE(LinearProgramSnapshot::Open(TestFile("missing")).ok());
+}
+
+TEST(LinearProgramSnapshotTest, RejectsTruncatedFiles) {
+  const std::string contents = ValidSnapshot("truncated");
+  for (const int size : {0, 7, kHeaderSize - 1, kHeaderSize + 1,
+                         static_cast<int>(contents.size()) - 64}) {
+    EXPECT_EQ(OpenContents("truncated", contents.substr(0, size)).code(),
+              absl::StatusCode::kInvalidArgument)
+        << size;
+  }
+}
+
+TEST(LinearProgramSnapshotTest, RejectsCorruptedHeaders) {
+  const std::string valid = ValidSnapshot("corrupted_header");
+
+  std::string contents = valid;
+  contents[0] = 'X';
+  EXPECT_EQ(OpenContents("corrupted_header", contents).code(),
+            absl::StatusCode::kInvalidArgument);
+
+  contents = valid;
+  Overwrite<uint32_t>(contents, kVersionOffset, 1000);
+  EXPECT_EQ(OpenContents("corrupted_header", contents).code(),
+            absl::StatusCode::kInvalidArgument);
+
+  contents = valid;
+  Overwrite<uint32_t>(contents, kByteOrderMarkOffset, 0x04030201);
+  EXPECT_EQ(OpenContents("corrupted_header", contents).code(),
+            absl::StatusCode::kInvalidArgument);
+
+  contents = valid;
+  Overwrite<int64_t>(contents, kNumRowsOffset, -1);
+  EXPECT_EQ(OpenContents("corrupted_header", contents).code(),
+            absl::StatusCode::kInvalidArgument);
+
+  contents = valid;
+  Overwrite<int64_t>(contents, kNumRowsOffset, 2);
+  EXPECT_EQ(OpenContents("corrupted_header", contents).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+// With 2^62 entries, the sizes of the row and coefficient sections are
+// multiples of 2^64, so they would wrap to 0 without the check on the file
+// size.
+TEST(LinearProgramSnapshotTest, RejectsNumEntriesOverflowingSectionSizes) {
+  std::string contents = ValidSnapshot("overflow");
+  const int64_t num_entries = int64_t{1} << 62;
+  Overwrite<int64_t>(contents, kNumEntriesOffset, num_entries);
+  for (const int section : {kRowsSection, kCoefficientsSection}) {
+    Overwrite<uint64_t>(
+        contents, kSectionsOffset + section * kSectionInfoSize + 8, 0);
+  }
+  // Last column start, at the end of the starts of the 3 columns.
+  const int starts_offset = static_cast<int>(Read<uint64_t>(
+      contents, kSectionsOffset + kStartsSection * kSectionInfoSize));
+  Overwrite<int64_t>(contents, starts_offset + 3 * sizeof(int64_t),
+                     num_entries);
+  EXPECT_EQ(OpenContents("overflow", contents).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(LinearProgramSnapshotTest, RejectsInvalidRowIndex) {
+  std::string contents = ValidSnapshot("invalid_row");
+  const int rows_offset = static_cast<int>(Read<uint64_t>(
+      contents, kSectionsOffset + kRowsSection * kSectionInfoSize));
+  Overwrite<int32_t>(contents, rows_offset, 3);
+  EXPECT_EQ(OpenContents("invalid_row", contents).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+// Corrupts random bytes of the header and of the index arrays. The snapshot
+// must either be rejected, or be readable without going out of the file.
+TEST(LinearProgramSnapshotTest, RandomCorruptions) {
+  const std::string valid = ValidSnapshot("random_corruptions");
+  const int starts_offset = static_cast<int>(Read<uint64_t>(
+      valid, kSectionsOffset + kStartsSection * kSectionInfoSize));
+  const int rows_end = static_cast<int>(
+      Read<uint64_t>(valid, kSectionsOffset + kRowsSection * kSectionInfoSize) +
+      Read<uint64_t>(valid,
+                     kSectionsOffset + kRowsSection * kSectionInfoSize + 8));
+  std::mt19937 random(12345);
+  std::uniform_int_distribution<int> num_corruptions(1, 4);
+  std::uniform_int_distribution<int> byte_value(0, 255);
+  std::uniform_int_distribution<int> header_byte(0, kHeaderSize - 1);
+  std::uniform_int_distribution<int> index_byte(starts_offset, rows_end - 1);
+  std::bernoulli_distribution in_header(0.5);
+  const std::string file_name = TestFile("random_corruptions");
+  for (int trial = 0; trial < 1000; ++trial) {
+    std::string contents = valid;
+    for (int i = num_corruptions(random); i > 0; --i) {
+      const int position =
+          in_header(random) ? header_byte(random) : index_byte(random);
+      contents[position] = static_cast<char>(byte_value(random));
+    }
+    WriteFile(file_name, contents);
+    const absl::StatusOr<std::unique_ptr<LinearProgramSnapshot>> snapshot =
+        LinearProgramSnapshot::Open(file_name);
+    if (!snapshot.ok()) continue;
+    LinearProgram copy;
+    (*snapshot)->CopyTo(&copy);
+    EXPECT_EQ(copy.num_variables(), (*snapshot)->num_cols());
+    EXPECT_EQ(copy.num_constraints(), (*snapshot)->num_rows());
+  }
+}
+
+// Random LP with num_cols variables of 10 entries each on num_cols / 4
+// constraints, written once to a snapshot file with names.
+std::string RandomLinearProgramSnapshot(int num_cols) {
+  const std::string file_name =
+      TestFile(absl::StrCat("benchmark_", num_cols));
+  std::mt19937 random(12345);
+  std::uniform_int_distribution<int> row(0, num_cols / 4 - 1);
+  std::uniform_real_distribution<double> value(-10.0, 10.0);
+  LinearProgram lp;
+  for (int i = 0; i < num_cols / 4; ++i) {
+    const RowIndex r = lp.CreateNewConstraint();
+    lp.SetConstraintName(r, absl::StrCat("c", i));
+    lp.SetConstraintBounds(r, -kInfinity, value(random));
+  }
+  for (int i = 0; i < num_cols; ++i) {
+    const ColIndex col = lp.CreateNewVariable();
+    lp.SetVariableName(col, absl::StrCat("x", i));
+    lp.SetVariableBounds(col, 0.0, 1.0);
+    lp.SetObjectiveCoefficient(col, value(random));
+    for (int j = 0; j < 10; ++j) {
+      lp.SetCoefficient(RowIndex(row(random)), col, value(random));
+    }
+  }
+  lp.CleanUp();
+  CHECK_OK(WriteLinearProgramSnapshot(lp, file_name));
+  return file_name;
+}
+
+// Time to open and validate a snapshot. The arrays are used in place.
+void BM_OpenSnapshot(benchmark::State& state) {
+  const std::string file_name = RandomLinearProgramSnapshot(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LinearProgramSnapshot::Open(file_name));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          ReadFile(file_name).size());
+}
+BENCHMARK(BM_OpenSnapshot)
+    ->Arg(100'000)
+    ->Arg(1'000'000)
+    ->Unit(benchmark::kMillisecond);
+
+// Time to load a snapshot into a LinearProgram.
+void BM_LoadLinearProgramFromSnapshot(benchmark::State& state) {
+  const std::string file_name = RandomLinearProgramSnapshot(state.range(0));
+  for (auto _ : state) {
+    LinearProgram lp;
+    CHECK_OK(LoadLinearProgramFromSnapshot(file_name, &lp));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          ReadFile(file_name).size());
+}
+BENCHMARK(BM_LoadLinearProgramFromSnapshot)
+    ->Arg(100'000)
+    ->Arg(1'000'000)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace glop
+}  // namespace operations_research
@@ -15,6 +15,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <memory>
 #include <string>
@@ -25,12 +26,26 @@
 #include "ortools/base/strong_vector.h"
 #include "ortools/glop/revised_simplex.h"
 #include "ortools/lp_data/lp_utils.h"
+#include "ortools/lp_data/sharded_executor.h"
 #include "ortools/lp_data/sparse.h"
 #include "ortools/util/time_limit.h"
 
 namespace operations_research {
 namespace glop {
 
+namespace {
+
+// Shards smaller than this are not worth the scheduling overhead.
+constexpr int64_t kMinColumnsPerShard = 4096;
+constexpr int64_t kMinRowsPerShard = 4096;
+
+// The sums of VarianceOfAbsoluteValueOfNonZeros() are computed by blocks of
+// that many columns, so that the result does not depend on the number of
+// threads.
+constexpr int64_t kColumnsPerVarianceBlock = 1024;
+
+}  // namespace
+
 SparseMatrixScaler::SparseMatrixScaler()
     : matrix_(nullptr), row_scale_(), col_scale_() {}
 
@@ -39,12 +54,100 @@ void SparseMatrixScaler::Init(SparseMatrix* matrix) {
   matrix_ = matrix;
   row_scale_.resize(matrix_->num_rows(), 1.0);
   col_scale_.resize(matrix_->num_cols(), 1.0);
+  row_entries_are_valid_ = false;
 }
 
 void SparseMatrixScaler::Clear() {
   matrix_ = nullptr;
   row_scale_.clear();
   col_scale_.clear();
+  row_starts_.clear();
+  row_entries_.clear();
+  row_entries_are_valid_ = false;
+}
+
+void SparseMatrixScaler::ComputeRowWiseEntriesIfNeeded() {
+  DCHECK(matrix_ != nullptr);
+  if (row_entries_are_valid_) return;
+  const RowIndex num_rows = matrix_->num_rows();
+  const ColIndex num_cols = matrix_->num_cols();
+  row_starts_.assign(RowToIntIndex(num_rows) + 1, 0);
+  for (ColIndex col(0); col < num_cols; ++col) {
+    for (const SparseColumn::Entry e : matrix_->column(col)) {
+      ++row_starts_[RowToIntIndex(e.row()) + 1];
+    }
+  }
+  for (int row = 0; row < RowToIntIndex(num_rows); ++row) {
+    row_starts_[row + 1] += row_starts_[row];
+  }
+  row_entries_.resize(row_starts_.back());
+  std::vector<int64_t> next(row_starts_.begin(), row_starts_.end() - 1);
+  for (ColIndex col(0); col < num_cols; ++col) {
+    const SparseColumn& column = matrix_->column(col);
+    for (const EntryIndex i : column.AllEntryIndices()) {
+      row_entries_[next[RowToIntIndex(column.EntryRow(i))]++] = {col, i};
+    }
+  }
+  row_entries_are_valid_ = true;
+}
+
+template <typename RowFunction>
+void SparseMatrixScaler::ParallelForRowEntries(
+    const RowFunction& row_function) {
+  // With a single thread, scattering the entries of the columns into the rows
+  // is faster than building the row-wise copy.
+  if (executor_.NumThreads() <= 1) {
+    const ColIndex num_cols = matrix_->num_cols();
+    for (ColIndex col(0); col < num_cols; ++col) {
+      for (const SparseColumn::Entry e : matrix_->column(col)) {
+        row_function(e.row(), std::abs(e.coefficient()));
+      }
+    }
+    return;
+  }
+  ComputeRowWiseEntriesIfNeeded();
+  executor_.ParallelFor(
+      RowToIntIndex(matrix_->num_rows()), kMinRowsPerShard,
+      [&](int shard, int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; ++row) {
+          for (int64_t k = row_starts_[row]; k < row_starts_[row + 1]; ++k) {
+            const RowEntry& entry = row_entries_[k];
+            row_function(RowIndex(row),
+                         std::abs(matrix_->column(entry.col)
+                                      .EntryCoefficient(entry.index)));
+          }
+        }
+      });
+}
+
+template <typename ColumnFunction>
+void SparseMatrixScaler::ParallelForColumns(
+    const ColumnFunction& column_function) {
+  executor_.ParallelFor(ColToIntIndex(matrix_->num_cols()), kMinColumnsPerShard,
+                        [&](int shard, int64_t begin, int64_t end) {
+                          for (ColIndex col(begin); col < ColIndex(end);
+                               ++col) {
+                            column_function(col);
+                          }
+                        });
+}
+
+template <typename ColumnFunction>
+ColIndex SparseMatrixScaler::ParallelCountColumns(
+    const ColumnFunction& column_function) {
+  const int64_t num_cols = ColToIntIndex(matrix_->num_cols());
+  std::vector<int64_t> counts(
+      executor_.NumShards(num_cols, kMinColumnsPerShard), 0);
+  executor_.ParallelFor(num_cols, kMinColumnsPerShard,
+                        [&](int shard, int64_t begin, int64_t end) {
+                          for (ColIndex col(begin); col < ColIndex(end);
+                               ++col) {
+                            if (column_function(col)) ++counts[shard];
+                          }
+                        });
+  int64_t total = 0;
+  for (const int64_t count : counts) total += count;
+  return ColIndex(total);
 }
 
 Fractional SparseMatrixScaler::RowUnscalingFactor(RowIndex row) const {
@@ -184,19 +287,42 @@ void SparseMatrixScaler::ScaleColumnVector(bool up,
 
 Fractional SparseMatrixScaler::VarianceOfAbsoluteValueOfNonZeros() const {
   DCHECK(matrix_ != nullptr);
+  const int64_t num_cols = ColToIntIndex(matrix_->num_cols());
+  const int64_t num_blocks =
+      (num_cols + kColumnsPerVarianceBlock - 1) / kColumnsPerVarianceBlock;
+  struct Sums {
+    Fractional sigma_square = 0.0;
+    Fractional sigma_abs = 0.0;
+    double n = 0.0;  // n is used in a calculation involving doubles.
+  };
+  std::vector<Sums> block_sums(num_blocks);
+  executor_.ParallelFor(
+      num_blocks, kMinColumnsPerShard / kColumnsPerVarianceBlock,
+      [&](int shard, int64_t begin, int64_t end) {
+        for (int64_t block = begin; block < end; ++block) {
+          Sums& sums = block_sums[block];
+          const ColIndex block_end(
+              std::min(num_cols, (block + 1) * kColumnsPerVarianceBlock));
+          for (ColIndex col(block * kColumnsPerVarianceBlock); col < block_end;
+               ++col) {
+            for (const SparseColumn::Entry e : matrix_->column(col)) {
+              const Fractional magnitude = fabs(e.coefficient());
+              if (magnitude != 0.0) {
+                sums.sigma_square += magnitude * magnitude;
+                sums.sigma_abs += magnitude;
+                ++sums.n;
+              }
+            }
+          }
+        }
+      });
   Fractional sigma_square(0.0);
   Fractional sigma_abs(0.0);
-  double n = 0.0;  // n is used in a calculation involving doubles.
-  const ColIndex num_cols = matrix_->num_cols();
-  for (ColIndex col(0); col < num_cols; ++col) {
-    for (const SparseColumn::Entry e : matrix_->column(col)) {
-      const Fractional magnitude = fabs(e.coefficient());
-      if (magnitude != 0.0) {
-        sigma_square += magnitude * magnitude;
-        sigma_abs += magnitude;
-        ++n;
-      }
-    }
+  double n = 0.0;
+  for (const Sums& sums : block_sums) {
+    sigma_square += sums.sigma_square;
+    sigma_abs += sums.sigma_abs;
+    n += sums.n;
   }
   if (n == 0.0) return 0.0;
   // Since we know all the population (the non-zeros) and we are not using a
@@ -216,17 +342,12 @@ RowIndex SparseMatrixScaler::ScaleRowsGeometrically() {
   DCHECK(matrix_ != nullptr);
   DenseColumn max_in_row(matrix_->num_rows(), 0.0);
   DenseColumn min_in_row(matrix_->num_rows(), kInfinity);
-  const ColIndex num_cols = matrix_->num_cols();
-  for (ColIndex col(0); col < num_cols; ++col) {
-    for (const SparseColumn::Entry e : matrix_->column(col)) {
-      const Fractional magnitude = fabs(e.coefficient());
-      const RowIndex row = e.row();
-      if (magnitude != 0.0) {
-        max_in_row[row] = std::max(max_in_row[row], magnitude);
-        min_in_row[row] = std::min(min_in_row[row], magnitude);
-      }
+  ParallelForRowEntries([&](RowIndex row, Fractional magnitude) {
+    if (magnitude != 0.0) {
+      max_in_row[row] = std::max(max_in_row[row], magnitude);
+      min_in_row[row] = std::min(min_in_row[row], magnitude);
     }
-  }
+  });
   const RowIndex num_rows = matrix_->num_rows();
   DenseColumn scaling_factor(num_rows, 0.0);
   for (RowIndex row(0); row < num_rows; ++row) {
@@ -242,9 +363,7 @@ RowIndex SparseMatrixScaler::ScaleRowsGeometrically() {
 
 ColIndex SparseMatrixScaler::ScaleColumnsGeometrically() {
   DCHECK(matrix_ != nullptr);
-  ColIndex num_cols_scaled(0);
-  const ColIndex num_cols = matrix_->num_cols();
-  for (ColIndex col(0); col < num_cols; ++col) {
+  return ParallelCountColumns([this](ColIndex col) {
     Fractional max_in_col(0.0);
     Fractional min_in_col(kInfinity);
     for (const SparseColumn::Entry e : matrix_->column(col)) {
@@ -254,13 +373,11 @@ ColIndex SparseMatrixScaler::ScaleColumnsGeometrically() {
         min_in_col = std::min(min_in_col, magnitude);
       }
     }
-    if (max_in_col != 0.0) {
-      const Fractional factor(sqrt(ToDouble(max_in_col * min_in_col)));
-      ScaleMatrixColumn(col, factor);
-      num_cols_scaled++;
-    }
-  }
-  return num_cols_scaled;
+    if (max_in_col == 0.0) return false;
+    const Fractional factor(sqrt(ToDouble(max_in_col * min_in_col)));
+    ScaleMatrixColumn(col, factor);
+    return true;
+  });
 }
 
 // For equilibration, we compute the maximum magnitude of non-zeros
@@ -272,16 +389,9 @@ RowIndex SparseMatrixScaler::EquilibrateRows() {
   DCHECK(matrix_ != nullptr);
   const RowIndex num_rows = matrix_->num_rows();
   DenseColumn max_magnitude(num_rows, 0.0);
-  const ColIndex num_cols = matrix_->num_cols();
-  for (ColIndex col(0); col < num_cols; ++col) {
-    for (const SparseColumn::Entry e : matrix_->column(col)) {
-      const Fractional magnitude = fabs(e.coefficient());
-      if (magnitude != 0.0) {
-        const RowIndex row = e.row();
-        max_magnitude[row] = std::max(max_magnitude[row], magnitude);
-      }
-    }
-  }
+  ParallelForRowEntries([&](RowIndex row, Fractional magnitude) {
+    max_magnitude[row] = std::max(max_magnitude[row], magnitude);
+  });
   for (RowIndex row(0); row < num_rows; ++row) {
     if (max_magnitude[row] == 0.0) {
       max_magnitude[row] = 1.0;
@@ -292,16 +402,12 @@ RowIndex SparseMatrixScaler::EquilibrateRows() {
 
 ColIndex SparseMatrixScaler::EquilibrateColumns() {
   DCHECK(matrix_ != nullptr);
-  ColIndex num_cols_scaled(0);
-  const ColIndex num_cols = matrix_->num_cols();
-  for (ColIndex col(0); col < num_cols; ++col) {
+  return ParallelCountColumns([this](ColIndex col) {
     const Fractional max_magnitude = InfinityNorm(matrix_->column(col));
-    if (max_magnitude != 0.0) {
-      ScaleMatrixColumn(col, max_magnitude);
-      num_cols_scaled++;
-    }
-  }
-  return num_cols_scaled;
+    if (max_magnitude == 0.0) return false;
+    ScaleMatrixColumn(col, max_magnitude);
+    return true;
+  });
 }
 
 RowIndex SparseMatrixScaler::ScaleMatrixRows(const DenseColumn& factors) {
@@ -319,13 +425,12 @@ RowIndex SparseMatrixScaler::ScaleMatrixRows(const DenseColumn& factors) {
     }
   }
 
-  const ColIndex num_cols = matrix_->num_cols();
-  for (ColIndex col(0); col < num_cols; ++col) {
+  ParallelForColumns([this, &factors](ColIndex col) {
     SparseColumn* const column = matrix_->mutable_column(col);
     if (column != nullptr) {
       column->ComponentWiseDivide(factors);
     }
-  }
+  });
 
   return num_rows_scaled;
 }
@@ -345,8 +450,7 @@ void SparseMatrixScaler::ScaleMatrixColumn(ColIndex col, Fractional factor) {
 void SparseMatrixScaler::Unscale() {
   // Unscaling is easier than scaling since all scaling factors are stored.
   DCHECK(matrix_ != nullptr);
-  const ColIndex num_cols = matrix_->num_cols();
-  for (ColIndex col(0); col < num_cols; ++col) {
+  ParallelForColumns([this](ColIndex col) {
     const Fractional column_scale = col_scale_[col];
     DCHECK_NE(0.0, column_scale);
 
@@ -355,7 +459,7 @@ void SparseMatrixScaler::Unscale() {
       column->MultiplyByConstant(column_scale);
       column->ComponentWiseMultiply(row_scale_);
     }
-  }
+  });
 }
 
 Status SparseMatrixScaler::LPScale() {
@@ -393,6 +497,7 @@ Status SparseMatrixScaler::LPScale() {
   // Default objective is to minimize.
   linear_program->SetObjectiveCoefficient(beta, 1);
   matrix_->CleanUp();
+  row_entries_are_valid_ = false;
   const ColIndex num_cols = matrix_->num_cols();
   for (ColIndex col(0); col < num_cols; ++col) {
     SparseColumn* const column = matrix_->mutable_column(col);
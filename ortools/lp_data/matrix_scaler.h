@@ -60,6 +60,7 @@
 #ifndef OR_TOOLS_LP_DATA_MATRIX_SCALER_H_
 #define OR_TOOLS_LP_DATA_MATRIX_SCALER_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -69,6 +70,7 @@
 #include "ortools/glop/status.h"
 #include "ortools/lp_data/lp_data.h"
 #include "ortools/lp_data/lp_types.h"
+#include "ortools/lp_data/sharded_executor.h"
 
 namespace operations_research {
 namespace glop {
@@ -92,6 +94,13 @@ class SparseMatrixScaler {
   // constructed.
   void Clear();
 
+  // Sets the number of threads used by Scale(), Unscale() and the scaling
+  // passes below. The columns are split in contiguous shards, and the row
+  // passes work on a row-wise copy of the sparsity pattern built once per
+  // Init(), if there is more than one thread. The result does not depend on
+  // the number of threads.
+  void SetNumThreads(int num_threads) { executor_.SetNumThreads(num_threads); }
+
   // The column col of the matrix was multiplied by ColScalingFactor(col). The
   // variable bounds and objective coefficient at the same columsn where DIVIDED
   // by that same factor. If col is outside the matrix size, this returns 1.0.
@@ -163,6 +172,25 @@ class SparseMatrixScaler {
   // Used by ScaleColumnsGeometrically and EquilibrateColumns.
   void ScaleMatrixColumn(ColIndex col, Fractional factor);
 
+  // Fills row_starts_ and row_entries_ if they are not up to date. Scaling
+  // never changes the sparsity pattern of the matrix, so this is only done
+  // once per Init().
+  void ComputeRowWiseEntriesIfNeeded();
+
+  // Calls row_function(row, magnitude) for each entry of each row, in parallel
+  // over contiguous ranges of rows. With one thread, the entries are visited
+  // column by column instead, and the row-wise copy is never built.
+  template <typename RowFunction>
+  void ParallelForRowEntries(const RowFunction& row_function);
+
+  // Calls column_function(col) for each column, in parallel over contiguous
+  // ranges of columns. The Count version returns the number of calls that
+  // returned true.
+  template <typename ColumnFunction>
+  void ParallelForColumns(const ColumnFunction& column_function);
+  template <typename ColumnFunction>
+  ColIndex ParallelCountColumns(const ColumnFunction& column_function);
+
   // Looks up the index to the scale factor variable for this matrix row, in the
   // LinearProgram, or creates it. Note lp_ must be initialized first.
   ColIndex GetRowScaleIndex(RowIndex row_num);
@@ -187,6 +215,21 @@ class SparseMatrixScaler {
 
   // Array of scaling factors for each column. Indexed by column number.
   DenseRow col_scale_;
+
+  // Row-wise copy of the sparsity pattern of matrix_: the entries of row r are
+  // row_entries_[row_starts_[r], row_starts_[r + 1]), and each one refers to
+  // an entry of a column of matrix_, so that the coefficients can be read in
+  // place even after the columns are scaled.
+  struct RowEntry {
+    ColIndex col;
+    EntryIndex index;
+  };
+  std::vector<int64_t> row_starts_;
+  std::vector<RowEntry> row_entries_;
+  bool row_entries_are_valid_ = false;
+
+  // Mutable since VarianceOfAbsoluteValueOfNonZeros() is const.
+  mutable ShardedExecutor executor_;
 };
 
 }  // namespace glop
@@ -0,0 +1,109 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/lp_data/matrix_scaler.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "absl/random/distributions.h"
+#include "gtest/gtest.h"
+#include "ortools/glop/parameters.pb.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/lp_data/sparse.h"
+
+namespace operations_research {
+namespace glop {
+namespace {
+
+// Large enough for the column and row passes to be split in several shards.
+constexpr int kNumRows = 20000;
+constexpr int kNumCols = 25000;
+
+// A matrix with about 5 entries per column, whose magnitudes range from 1e-6 to
+// 1e6, with a different magnitude per row and per column so that the scaling
+// needs several geometric iterations.
+void BuildRandomMatrix(std::mt19937* random, SparseMatrix* matrix) {
+  matrix->PopulateFromZero(RowIndex(kNumRows), ColIndex(kNumCols));
+  std::vector<Fractional> row_magnitudes(kNumRows);
+  for (Fractional& magnitude : row_magnitudes) {
+    magnitude = std::pow(10.0, absl::Uniform(*random, -3.0, 3.0));
+  }
+  for (ColIndex col(0); col < kNumCols; ++col) {
+    const Fractional col_magnitude =
+        std::pow(10.0, absl::Uniform(*random, -3.0, 3.0));
+    SparseColumn* column = matrix->mutable_column(col);
+    for (int i = 0; i < 5; ++i) {
+      const int row = absl::Uniform<int>(*random, 0, kNumRows);
+      const Fractional sign = absl::Bernoulli(*random, 0.5) ? 1.0 : -1.0;
+      column->SetCoefficient(
+          RowIndex(row), sign * row_magnitudes[row] * col_magnitude *
+                             absl::Uniform(*random, 0.5, 2.0));
+    }
+    column->CleanUp();
+  }
+}
+
+class MatrixScalerThreadsTest
+    : public testing::TestWithParam<GlopParameters::ScalingAlgorithm> {};
+
+// Maxima and minima do not depend on the evaluation order, and the variance is
+// summed by fixed blocks, so the factors are the same with any number of
+// threads, and not only up to rounding errors.
+TEST_P(MatrixScalerThreadsTest, FactorsDoNotDependOnTheNumberOfThreads) {
+  std::mt19937 random(12345);
+  SparseMatrix single_thread_matrix;
+  BuildRandomMatrix(&random, &single_thread_matrix);
+  SparseMatrix matrix;
+  matrix.PopulateFromSparseMatrix(single_thread_matrix);
+
+  SparseMatrixScaler single_thread_scaler;
+  single_thread_scaler.Init(&single_thread_matrix);
+  single_thread_scaler.Scale(GetParam());
+
+  for (const int num_threads : {2, 4, 8}) {
+    SparseMatrix scaled_matrix;
+    scaled_matrix.PopulateFromSparseMatrix(matrix);
+    SparseMatrixScaler scaler;
+    scaler.SetNumThreads(num_threads);
+    scaler.Init(&scaled_matrix);
+    scaler.Scale(GetParam());
+    for (RowIndex row(0); row < kNumRows; ++row) {
+      ASSERT_EQ(scaler.RowScalingFactor(row),
+                single_thread_scaler.RowScalingFactor(row))
+          << "row " << row << ", " << num_threads << " threads";
+    }
+    for (ColIndex col(0); col < kNumCols; ++col) {
+      ASSERT_EQ(scaler.ColScalingFactor(col),
+                single_thread_scaler.ColScalingFactor(col))
+          << "col " << col << ", " << num_threads << " threads";
+      ASSERT_TRUE(scaled_matrix.column(col).IsEqualTo(
+          single_thread_matrix.column(col)))
+          << "col " << col << ", " << num_threads << " threads";
+    }
+
+    // Unscaling with several threads also gives back the same matrix.
+    scaler.Unscale();
+    ASSERT_TRUE(scaled_matrix.Equals(matrix, /*tolerance=*/1e-6))
+        << num_threads << " threads";
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(ScalingAlgorithms, MatrixScalerThreadsTest,
+                         testing::Values(GlopParameters::DEFAULT,
+                                         GlopParameters::EQUILIBRATION));
+
+}  // namespace
+}  // namespace glop
+}  // namespace operations_research
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "ortools/base/hash.h"
+#include "ortools/lp_data/sharded_executor.h"
 
 namespace operations_research {
 namespace glop {
@@ -58,18 +59,21 @@ bool AreColumnsProportional(const SparseColumn& a, const SparseColumn& b,
 
 // A column index together with its fingerprint. See ComputeFingerprint().
 struct ColumnFingerprint {
+  ColumnFingerprint() = default;
   ColumnFingerprint(ColIndex _col, int64_t _hash, double _value)
       : col(_col), hash(_hash), value(_value) {}
-  ColIndex col;
-  int64_t hash;
-  double value;
+  ColIndex col = kInvalidCol;
+  int64_t hash = 0;
+  double value = 0.0;
 
   // This order has the property that if AreProportionalCandidates() is true for
   // two given columns, then in a sorted list of columns
   // AreProportionalCandidates() will be true for all the pairs of columns
-  // between the two given ones (included).
+  // between the two given ones (included). The ties are broken by column index
+  // so that the order does not depend on how the fingerprints were bucketed.
   bool operator<(const ColumnFingerprint& other) const {
     if (hash == other.hash) {
+      if (value == other.value) return col < other.col;
       return value < other.value;
     }
     return hash < other.hash;
@@ -117,41 +121,91 @@ ColumnFingerprint ComputeFingerprint(ColIndex col, const SparseColumn& column) {
 }  // namespace
 
 ColMapping FindProportionalColumns(const SparseMatrix& matrix,
-                                   Fractional tolerance) {
+                                   Fractional tolerance,
+                                   ShardedExecutor* executor) {
   const ColIndex num_cols = matrix.num_cols();
   ColMapping mapping(num_cols, kInvalidCol);
+  const auto parallel_for = [executor](int64_t size, int64_t min_shard_size,
+                                       const auto& function) {
+    if (executor == nullptr) {
+      function(0, 0, size);
+    } else {
+      executor->ParallelFor(size, min_shard_size, function);
+    }
+  };
 
-  // Compute the fingerprint of each columns and sort them.
-  std::vector<ColumnFingerprint> fingerprints;
-  for (ColIndex col(0); col < num_cols; ++col) {
-    if (!matrix.column(col).IsEmpty()) {
-      fingerprints.push_back(ComputeFingerprint(col, matrix.column(col)));
+  // Compute the fingerprint of each non-empty column.
+  const int64_t kMinColumnsPerShard = 4096;
+  std::vector<ColumnFingerprint> fingerprints(num_cols.value());
+  parallel_for(num_cols.value(), kMinColumnsPerShard,
+               [&](int shard, int64_t begin, int64_t end) {
+                 for (ColIndex col(begin); col < ColIndex(end); ++col) {
+                   if (!matrix.column(col).IsEmpty()) {
+                     fingerprints[col.value()] =
+                         ComputeFingerprint(col, matrix.column(col));
+                   }
+                 }
+               });
+
+  // Two columns can only be proportional if their non-zero pattern hashes are
+  // the same, so we split the fingerprints in buckets by hash. The number of
+  // buckets only depends on the number of columns, and the order within a
+  // bucket is the one of a global sort, so the result does not depend on the
+  // number of threads.
+  const int64_t kColumnsPerBucket = 1024;
+  const int64_t num_buckets =
+      std::max<int64_t>(1, num_cols.value() / kColumnsPerBucket);
+  const auto bucket_of = [num_buckets](const ColumnFingerprint& fingerprint) {
+    return static_cast<uint64_t>(fingerprint.hash) % num_buckets;
+  };
+  std::vector<int64_t> bucket_starts(num_buckets + 1, 0);
+  for (const ColumnFingerprint& fingerprint : fingerprints) {
+    if (fingerprint.col == kInvalidCol) continue;
+    ++bucket_starts[bucket_of(fingerprint) + 1];
+  }
+  for (int64_t b = 0; b < num_buckets; ++b) {
+    bucket_starts[b + 1] += bucket_starts[b];
+  }
+  std::vector<ColumnFingerprint> sorted(bucket_starts.back());
+  {
+    std::vector<int64_t> next(bucket_starts.begin(), bucket_starts.end() - 1);
+    for (const ColumnFingerprint& fingerprint : fingerprints) {
+      if (fingerprint.col == kInvalidCol) continue;
+      sorted[next[bucket_of(fingerprint)]++] = fingerprint;
     }
   }
-  std::sort(fingerprints.begin(), fingerprints.end());
+  fingerprints.clear();
+  fingerprints.shrink_to_fit();
 
   // Find a representative of each proportional columns class. This only
-  // compares columns with a close-enough fingerprint.
-  for (int i = 0; i < fingerprints.size(); ++i) {
-    const ColIndex col_a = fingerprints[i].col;
-    if (mapping[col_a] != kInvalidCol) continue;
-    for (int j = i + 1; j < fingerprints.size(); ++j) {
-      const ColIndex col_b = fingerprints[j].col;
-      if (mapping[col_b] != kInvalidCol) continue;
+  // compares columns with a close-enough fingerprint, which are always in the
+  // same bucket, so each bucket only reads and writes the mapping of its own
+  // columns.
+  parallel_for(num_buckets, 1, [&](int shard, int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; ++b) {
+      const int64_t bucket_end = bucket_starts[b + 1];
+      std::sort(sorted.begin() + bucket_starts[b], sorted.begin() + bucket_end);
+      for (int64_t i = bucket_starts[b]; i < bucket_end; ++i) {
+        const ColIndex col_a = sorted[i].col;
+        if (mapping[col_a] != kInvalidCol) continue;
+        for (int64_t j = i + 1; j < bucket_end; ++j) {
+          const ColIndex col_b = sorted[j].col;
+          if (mapping[col_b] != kInvalidCol) continue;
 
-      // Note that we use the same tolerance for the fingerprints.
-      // TODO(user): Derive precise bounds on what this tolerance should be so
-      // that no proportional columns are missed.
-      if (!AreProportionalCandidates(fingerprints[i], fingerprints[j],
-                                     tolerance)) {
-        break;
-      }
-      if (AreColumnsProportional(matrix.column(col_a), matrix.column(col_b),
-                                 tolerance)) {
-        mapping[col_b] = col_a;
+          // Note that we use the same tolerance for the fingerprints.
+          // TODO(user): Derive precise bounds on what this tolerance should be
+          // so that no proportional columns are missed.
+          if (!AreProportionalCandidates(sorted[i], sorted[j], tolerance)) {
+            break;
+          }
+          if (AreColumnsProportional(matrix.column(col_a),
+                                     matrix.column(col_b), tolerance)) {
+            mapping[col_b] = col_a;
+          }
+        }
       }
     }
-  }
+  });
 
   // Sort the mapping so that the representative of each class is the smallest
   // column. To achieve this, the current representative is used as a pointer
@@ -15,6 +15,7 @@
 #define OR_TOOLS_LP_DATA_MATRIX_UTILS_H_
 
 #include "ortools/lp_data/lp_types.h"
+#include "ortools/lp_data/sharded_executor.h"
 #include "ortools/lp_data/sparse.h"
 
 namespace operations_research {
@@ -33,8 +34,13 @@ namespace glop {
 // The complexity is in most cases O(num entries of the matrix). However,
 // compared to the less efficient algorithm below, it is highly unlikely but
 // possible that some pairs of proportional columns are not detected.
+//
+// If an executor is given, the fingerprints are computed over column shards
+// and the buckets of columns with the same non-zero pattern hash are compared
+// in parallel. The result is the same as with a nullptr executor.
 ColMapping FindProportionalColumns(const SparseMatrix& matrix,
-                                   Fractional tolerance);
+                                   Fractional tolerance,
+                                   ShardedExecutor* executor = nullptr);
 
 // A simple version of FindProportionalColumns() that compares all the columns
 // pairs one by one. This is slow, but here for reference. The complexity is
@@ -0,0 +1,181 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/lp_data/matrix_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "absl/random/distributions.h"
+#include "gtest/gtest.h"
+#include "ortools/base/hash.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/lp_data/sharded_executor.h"
+#include "ortools/lp_data/sparse.h"
+
+namespace operations_research {
+namespace glop {
+namespace {
+
+constexpr Fractional kTolerance = 1e-9;
+
+// The FindProportionalColumns() implementation before the columns were split
+// in buckets: one global sort of the fingerprints, and a sequential scan.
+ColMapping FindProportionalColumnsWithGlobalSort(const SparseMatrix& matrix,
+                                                 Fractional tolerance) {
+  struct Fingerprint {
+    ColIndex col;
+    int64_t hash;
+    double value;
+  };
+  const ColIndex num_cols = matrix.num_cols();
+  ColMapping mapping(num_cols, kInvalidCol);
+  std::vector<Fingerprint> fingerprints;
+  for (ColIndex col(0); col < num_cols; ++col) {
+    const SparseColumn& column = matrix.column(col);
+    if (column.IsEmpty()) continue;
+    int64_t hash = 0;
+    Fractional min_abs = std::numeric_limits<Fractional>::max();
+    Fractional max_abs = 0.0;
+    Fractional sum = 0.0;
+    for (const SparseColumn::Entry e : column) {
+      hash = util_hash::Hash(e.row().value(), hash);
+      sum += e.coefficient();
+      min_abs = std::min(min_abs, std::abs(e.coefficient()));
+      max_abs = std::max(max_abs, std::abs(e.coefficient()));
+    }
+    fingerprints.push_back(
+        {col, hash,
+         min_abs / max_abs +
+             std::abs(sum) /
+                 (static_cast<double>(column.num_entries().value()) *
+                  max_abs)});
+  }
+  std::sort(fingerprints.begin(), fingerprints.end(),
+            [](const Fingerprint& a, const Fingerprint& b) {
+              if (a.hash == b.hash) return a.value < b.value;
+              return a.hash < b.hash;
+            });
+  for (int i = 0; i < fingerprints.size(); ++i) {
+    const ColIndex col_a = fingerprints[i].col;
+    if (mapping[col_a] != kInvalidCol) continue;
+    for (int j = i + 1; j < fingerprints.size(); ++j) {
+      const ColIndex col_b = fingerprints[j].col;
+      if (mapping[col_b] != kInvalidCol) continue;
+      if (fingerprints[i].hash != fingerprints[j].hash ||
+          std::abs(fingerprints[i].value - fingerprints[j].value) >=
+              tolerance) {
+        break;
+      }
+      // All the proportional columns of the tests are exact multiples, so
+      // AreColumnsProportional() reduces to this.
+      const SparseColumn& a = matrix.column(col_a);
+      const SparseColumn& b = matrix.column(col_b);
+      bool proportional = a.num_entries() == b.num_entries();
+      for (EntryIndex k(0); proportional && k < a.num_entries(); ++k) {
+        proportional = a.EntryRow(k) == b.EntryRow(k) &&
+                       std::abs(a.EntryCoefficient(k) / b.EntryCoefficient(k) -
+                                a.EntryCoefficient(EntryIndex(0)) /
+                                    b.EntryCoefficient(EntryIndex(0))) <=
+                           tolerance;
+      }
+      if (proportional) mapping[col_b] = col_a;
+    }
+  }
+  for (ColIndex col(0); col < num_cols; ++col) {
+    if (mapping[col] == kInvalidCol) continue;
+    const ColIndex new_representative = mapping[mapping[col]];
+    if (new_representative != kInvalidCol) {
+      mapping[col] = new_representative;
+    } else if (mapping[col] > col) {
+      mapping[mapping[col]] = col;
+      mapping[col] = kInvalidCol;
+    }
+  }
+  return mapping;
+}
+
+// Returns a matrix with num_cols columns of 1 to 4 entries on few rows, so that
+// many columns share a non-zero pattern. A third of the columns are a power of
+// two times a random previous column, so that the fingerprints of proportional
+// columns are exactly the same. Some columns are empty.
+void BuildMatrixWithProportionalColumns(int num_cols, std::mt19937* random,
+                                        SparseMatrix* matrix) {
+  const RowIndex num_rows(20);
+  matrix->PopulateFromZero(num_rows, ColIndex(num_cols));
+  for (ColIndex col(0); col < num_cols; ++col) {
+    SparseColumn* column = matrix->mutable_column(col);
+    if (col > 0 && absl::Bernoulli(*random, 1.0 / 3.0)) {
+      const ColIndex other(absl::Uniform<int>(*random, 0, col.value()));
+      const Fractional factor =
+          std::ldexp(absl::Bernoulli(*random, 0.5) ? 1.0 : -1.0,
+                     absl::Uniform<int>(*random, -3, 4));
+      for (const SparseColumn::Entry e : matrix->column(other)) {
+        column->SetCoefficient(e.row(), factor * e.coefficient());
+      }
+      continue;
+    }
+    if (absl::Bernoulli(*random, 0.05)) continue;
+    const int num_entries = absl::Uniform<int>(*random, 1, 5);
+    for (int i = 0; i < num_entries; ++i) {
+      column->SetCoefficient(
+          RowIndex(absl::Uniform<int>(*random, 0, num_rows.value())),
+          absl::Uniform<int>(*random, 1, 4));
+    }
+    column->CleanUp();
+  }
+}
+
+TEST(FindProportionalColumnsTest, MatchesTheGlobalSortAndTheSimpleAlgorithm) {
+  std::mt19937 random(12345);
+  for (const int num_cols : {10, 1000, 20000}) {
+    SparseMatrix matrix;
+    BuildMatrixWithProportionalColumns(num_cols, &random, &matrix);
+    const ColMapping expected =
+        FindProportionalColumnsWithGlobalSort(matrix, kTolerance);
+    int num_proportional_columns = 0;
+    for (const ColIndex representative : expected) {
+      if (representative != kInvalidCol) ++num_proportional_columns;
+    }
+    EXPECT_GT(num_proportional_columns, num_cols / 4) << num_cols;
+    EXPECT_EQ(FindProportionalColumns(matrix, kTolerance), expected)
+        << num_cols;
+    if (num_cols <= 1000) {
+      EXPECT_EQ(
+          FindProportionalColumnsUsingSimpleAlgorithm(matrix, kTolerance),
+          expected)
+          << num_cols;
+    }
+  }
+}
+
+TEST(FindProportionalColumnsTest, DoesNotDependOnTheNumberOfThreads) {
+  std::mt19937 random(12345);
+  SparseMatrix matrix;
+  BuildMatrixWithProportionalColumns(50000, &random, &matrix);
+  const ColMapping expected = FindProportionalColumns(matrix, kTolerance);
+  for (const int num_threads : {1, 2, 4, 8}) {
+    ShardedExecutor executor;
+    executor.SetNumThreads(num_threads);
+    EXPECT_EQ(FindProportionalColumns(matrix, kTolerance, &executor), expected)
+        << num_threads << " threads";
+  }
+}
+
+}  // namespace
+}  // namespace glop
+}  // namespace operations_research
@@ -36,11 +36,15 @@
 namespace operations_research {
 namespace glop {
 
-// Parses an MPS model from a string.
-absl::StatusOr<MPModelProto> MpsDataToMPModelProto(absl::string_view mps_data);
+// Parses an MPS model from a string. With num_threads > 1, the COLUMNS section
+// of large models is tokenized in parallel, see
+// MPSReaderTemplate::SetNumThreads().
+absl::StatusOr<MPModelProto> MpsDataToMPModelProto(absl::string_view mps_data,
+                                                   int num_threads = 1);
 
-// Parses an MPS model from a file.
-absl::StatusOr<MPModelProto> MpsFileToMPModelProto(absl::string_view mps_file);
+// Parses an MPS model from a file. The file is memory-mapped when possible.
+absl::StatusOr<MPModelProto> MpsFileToMPModelProto(absl::string_view mps_file,
+                                                   int num_threads = 1);
 
 // Implementation class. Please use the 2 functions above.
 //
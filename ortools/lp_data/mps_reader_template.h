@@ -274,8 +274,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -291,9 +293,11 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "ortools/base/logging.h"
 #include "ortools/base/status_macros.h"
-#include "ortools/util/filelineiter.h"
+#include "ortools/base/threadpool.h"
+#include "ortools/util/file_contents.h"
 
 namespace operations_research {
 
@@ -340,8 +344,11 @@ class MPSLineInfo {
   absl::string_view GetLine() const { return line_; }
 
   // TODO(b/284163180): Fix handling of sections and data in `free_form`.
-  // Returns true if the line defines a new section.
-  bool IsNewSection() const { return line_[0] != '\0' && line_[0] != ' '; }
+  // Returns true if the line defines a new section. Note that data lines can
+  // start with a tab in free format, tabs are rejected in fixed format.
+  bool IsNewSection() const {
+    return line_[0] != '\0' && line_[0] != ' ' && line_[0] != '\t';
+  }
 
   // Returns the number of fields in the line. What constitutes a 'field'
   // depends on the format (fixed or free) used at creation time. See the
@@ -516,18 +523,87 @@ class MPSReaderTemplate {
       absl::string_view source, DataWrapper* data,
       MPSReaderFormat form = MPSReaderFormat::kAutoDetect);
 
+  // Sets the number of threads used to parse the COLUMNS section, which is
+  // usually most of the file. With more than one thread, its lines are split
+  // into chunks that are tokenized, converted to numbers and matched to the
+  // rows in parallel, while the calling thread passes the result to the
+  // DataWrapper in the file order. The parsed model does not depend on this.
+  void SetNumThreads(int num_threads) {
+    num_threads_ = std::max(1, num_threads);
+  }
+
  private:
   static constexpr double kInfinity = std::numeric_limits<double>::infinity();
 
+  // The COLUMNS data lines are parsed in parallel only if there are at least
+  // that many bytes of them, by chunks of kColumnsChunkSize bytes.
+  static constexpr size_t kMinParallelColumnsSize = 1 << 20;
+  static constexpr size_t kColumnsChunkSize = 1 << 20;
+
+  // Result of the tokenization of one line of the COLUMNS section.
+  struct ColumnsLine {
+    enum Kind : int8_t {
+      // A comment or a blank line.
+      kSkip,
+      // A data line whose column name is in text.
+      kData,
+      // A line, in text, that must go through ProcessLine(): marker, unknown
+      // row, invalid field, ...
+      kFallback
+    };
+    Kind kind = kFallback;
+    int8_t num_entries = 0;
+    bool is_objective[2];
+    IndexType rows[2];
+    double values[2];
+    absl::string_view text;
+  };
+
   // Resets the object to its initial value before reading a new file.
   void Reset();
 
   // Displays some information on the last loaded file.
   void DisplaySummary();
 
+  // Parses the whole content of a file or string. If remove_inline_cr is true,
+  // the '\r' characters are removed from each line like FileLines() does.
+  absl::StatusOr<MPSReaderFormat> ParseContents(absl::string_view contents,
+                                                bool remove_inline_cr,
+                                                DataWrapper* data,
+                                                MPSReaderFormat form);
+
+  // Removes the '\r' characters from the line if needed, then processes it.
+  absl::Status ProcessRawLine(absl::string_view line, bool remove_inline_cr,
+                              DataWrapper* data);
+
   // Line processor.
   absl::Status ProcessLine(absl::string_view line, DataWrapper* data);
 
+  // Returns the start of the first line at or after begin that is neither a
+  // data line, a comment nor a blank line, i.e. the next section header.
+  static size_t FindEndOfDataLines(absl::string_view contents, size_t begin);
+
+  // Processes the given COLUMNS data lines, tokenized in parallel by
+  // TokenizeColumnsLine(), with the same result as calling ProcessRawLine() on
+  // each of them.
+  absl::Status ProcessColumnsLinesInParallel(absl::string_view lines,
+                                             bool remove_inline_cr,
+                                             DataWrapper* data);
+
+  // Tokenizes a line of the COLUMNS section. This does not modify the reader
+  // or the data, so that it can be called concurrently on different lines.
+  ColumnsLine TokenizeColumnsLine(absl::string_view line,
+                                  bool remove_inline_cr) const;
+
+  // Stores a line tokenized by TokenizeColumnsLine().
+  absl::Status StoreColumnsLine(const ColumnsLine& line, bool remove_inline_cr,
+                                DataWrapper* data);
+
+  // Returns the index of the given column, creating it if needed, and applies
+  // the integer marker to it. This is done for each line of the COLUMNS
+  // section.
+  IndexType ProcessColumnName(absl::string_view column_name, DataWrapper* data);
+
   // Process section OBJSENSE in MPS file.
   absl::Status ProcessObjectiveSenseSection(
       const internal::MPSLineInfo& line_info, DataWrapper* data);
@@ -647,6 +723,20 @@ class MPSReaderTemplate {
   // the user because other solvers usually ignore them and we don't (they will
   // be removed in the preprocessor).
   IndexType num_unconstrained_rows_;
+
+  // See SetNumThreads().
+  int num_threads_ = 1;
+
+  // Index of the rows declared in the ROWS and LAZYCONS sections. This is only
+  // filled with more than one thread, and is read-only during the COLUMNS
+  // section so that TokenizeColumnsLine() can use it concurrently.
+  absl::flat_hash_map<std::string, IndexType> row_name_to_index_;
+
+  // The consecutive lines of the COLUMNS section are usually about the same
+  // column, so we cache the last one to avoid a lookup by name.
+  bool has_last_column_ = false;
+  std::string last_column_name_;
+  IndexType last_column_;
 };
 
 template <class DataWrapper>
@@ -656,23 +746,59 @@ absl::StatusOr<MPSReaderFormat> MPSReaderTemplate<DataWrapper>::ParseFile(
   if (data == nullptr) {
     return absl::InvalidArgumentError("NULL pointer passed as argument.");
   }
+  ASSIGN_OR_RETURN(
+      const std::unique_ptr<FileContents> file,
+      FileContents::Open(file_name, /*sequential_access=*/true));
+  return ParseContents(file->contents(), /*remove_inline_cr=*/true, data,
+                       form);
+}
 
+template <class DataWrapper>
+absl::StatusOr<MPSReaderFormat> MPSReaderTemplate<DataWrapper>::ParseString(
+    absl::string_view source, DataWrapper* const data,
+    const MPSReaderFormat form) {
+  return ParseContents(source, /*remove_inline_cr=*/false, data, form);
+}
+
+template <class DataWrapper>
+absl::StatusOr<MPSReaderFormat> MPSReaderTemplate<DataWrapper>::ParseContents(
+    absl::string_view contents, bool remove_inline_cr, DataWrapper* const data,
+    const MPSReaderFormat form) {
   if (form != MPSReaderFormat::kFree && form != MPSReaderFormat::kFixed) {
-    if (ParseFile(file_name, data, MPSReaderFormat::kFixed).ok()) {
+    if (ParseContents(contents, remove_inline_cr, data, MPSReaderFormat::kFixed)
+            .ok()) {
       return MPSReaderFormat::kFixed;
     }
-    return ParseFile(file_name, data, MPSReaderFormat::kFree);
+    return ParseContents(contents, remove_inline_cr, data,
+                         MPSReaderFormat::kFree);
   }
 
   DCHECK(form == MPSReaderFormat::kFree || form == MPSReaderFormat::kFixed);
   free_form_ = form == MPSReaderFormat::kFree;
   Reset();
   data->SetUp();
-  File* file = nullptr;
-  RETURN_IF_ERROR(file::Open(file_name, "r", &file, file::Defaults()));
-  for (const absl::string_view line :
-       FileLines(file_name, file, FileLineIterator::REMOVE_INLINE_CR)) {
-    RETURN_IF_ERROR(ProcessLine(line, data));
+
+  // Like absl::StrSplit(contents, '\n'), this yields an empty last line if the
+  // contents end with '\n'.
+  size_t begin = 0;
+  size_t sequential_until = 0;
+  while (begin <= contents.size()) {
+    size_t end = contents.find('\n', begin);
+    if (end == absl::string_view::npos) end = contents.size();
+    RETURN_IF_ERROR(ProcessRawLine(contents.substr(begin, end - begin),
+                                   remove_inline_cr, data));
+    begin = end + 1;
+    if (num_threads_ > 1 && section_ == internal::MPSSectionId::kColumns &&
+        begin >= sequential_until && begin < contents.size()) {
+      const size_t data_end = FindEndOfDataLines(contents, begin);
+      if (data_end - begin >= kMinParallelColumnsSize) {
+        RETURN_IF_ERROR(ProcessColumnsLinesInParallel(
+            contents.substr(begin, data_end - begin), remove_inline_cr, data));
+        begin = data_end;
+      } else {
+        sequential_until = data_end;
+      }
+    }
   }
   data->CleanUp();
   DisplaySummary();
@@ -680,26 +806,187 @@ absl::StatusOr<MPSReaderFormat> MPSReaderTemplate<DataWrapper>::ParseFile(
 }
 
 template <class DataWrapper>
-absl::StatusOr<MPSReaderFormat> MPSReaderTemplate<DataWrapper>::ParseString(
-    absl::string_view source, DataWrapper* const data,
-    const MPSReaderFormat form) {
-  if (form != MPSReaderFormat::kFree && form != MPSReaderFormat::kFixed) {
-    if (ParseString(source, data, MPSReaderFormat::kFixed).ok()) {
-      return MPSReaderFormat::kFixed;
+absl::Status MPSReaderTemplate<DataWrapper>::ProcessRawLine(
+    absl::string_view line, bool remove_inline_cr, DataWrapper* data) {
+  // A trailing '\r' is removed with the trailing white space anyway.
+  if (remove_inline_cr) {
+    const size_t cr = line.find('\r');
+    if (cr != absl::string_view::npos && cr + 1 != line.size()) {
+      std::string cleaned_line(line);
+      cleaned_line.erase(
+          std::remove(cleaned_line.begin(), cleaned_line.end(), '\r'),
+          cleaned_line.end());
+      return ProcessLine(cleaned_line, data);
     }
-    return ParseString(source, data, MPSReaderFormat::kFree);
   }
+  return ProcessLine(line, data);
+}
 
-  DCHECK(form == MPSReaderFormat::kFree || form == MPSReaderFormat::kFixed);
-  free_form_ = form == MPSReaderFormat::kFree;
-  Reset();
-  data->SetUp();
-  for (absl::string_view line : absl::StrSplit(source, '\n')) {
-    RETURN_IF_ERROR(ProcessLine(line, data));
+template <class DataWrapper>
+size_t MPSReaderTemplate<DataWrapper>::FindEndOfDataLines(
+    absl::string_view contents, size_t begin) {
+  size_t pos = begin;
+  while (pos < contents.size()) {
+    const size_t eol = contents.find('\n', pos);
+    const size_t next = eol == absl::string_view::npos ? contents.size()
+                                                       : eol + 1;
+    if (contents[pos] != ' ' && contents[pos] != '\t' &&
+        contents[pos] != '*' &&
+        !absl::StripTrailingAsciiWhitespace(contents.substr(pos, next - pos))
+             .empty()) {
+      break;
+    }
+    pos = next;
   }
-  data->CleanUp();
-  DisplaySummary();
-  return form;
+  return pos;
+}
+
+template <class DataWrapper>
+absl::Status MPSReaderTemplate<DataWrapper>::ProcessColumnsLinesInParallel(
+    absl::string_view lines, bool remove_inline_cr, DataWrapper* data) {
+  // Returns the start of the first line at or after pos.
+  const auto line_start = [lines](size_t pos) {
+    if (pos == 0 || pos >= lines.size()) return std::min(pos, lines.size());
+    if (lines[pos - 1] == '\n') return pos;
+    const size_t eol = lines.find('\n', pos);
+    return eol == absl::string_view::npos ? lines.size() : eol + 1;
+  };
+
+  // The lines are processed by batches of num_threads_ chunks. The next batch
+  // is tokenized while the calling thread stores the current one. Note that
+  // the pool is declared last so that it is joined before the batches are
+  // destroyed, even on error.
+  struct Batch {
+    std::vector<std::vector<ColumnsLine>> chunks;
+    std::unique_ptr<absl::BlockingCounter> done;
+  };
+  Batch batches[2];
+  ThreadPool pool("MPSReader", num_threads_);
+  pool.StartWorkers();
+
+  size_t batch_begin = 0;
+  const auto schedule_batch = [&](Batch* batch) {
+    batch->chunks.resize(num_threads_);
+    batch->done = std::make_unique<absl::BlockingCounter>(num_threads_);
+    for (int i = 0; i < num_threads_; ++i) {
+      const size_t chunk_begin = batch_begin;
+      const size_t chunk_end = line_start(chunk_begin + kColumnsChunkSize);
+      batch_begin = chunk_end;
+      std::vector<ColumnsLine>* const chunk = &batch->chunks[i];
+      absl::BlockingCounter* const done = batch->done.get();
+      pool.Schedule([this, lines, chunk_begin, chunk_end, chunk, done,
+                     remove_inline_cr]() {
+        chunk->clear();
+        size_t pos = chunk_begin;
+        while (pos < chunk_end) {
+          size_t eol = lines.find('\n', pos);
+          if (eol == absl::string_view::npos) eol = chunk_end;
+          chunk->push_back(TokenizeColumnsLine(lines.substr(pos, eol - pos),
+                                               remove_inline_cr));
+          pos = eol + 1;
+        }
+        done->DecrementCount();
+      });
+    }
+  };
+
+  int current = 0;
+  schedule_batch(&batches[current]);
+  while (true) {
+    batches[current].done->Wait();
+    const bool has_next_batch = batch_begin < lines.size();
+    if (has_next_batch) schedule_batch(&batches[1 - current]);
+    for (const std::vector<ColumnsLine>& chunk : batches[current].chunks) {
+      for (const ColumnsLine& line : chunk) {
+        RETURN_IF_ERROR(StoreColumnsLine(line, remove_inline_cr, data));
+      }
+    }
+    if (!has_next_batch) break;
+    current = 1 - current;
+  }
+  return absl::OkStatus();
+}
+
+template <class DataWrapper>
+typename MPSReaderTemplate<DataWrapper>::ColumnsLine
+MPSReaderTemplate<DataWrapper>::TokenizeColumnsLine(
+    absl::string_view line, bool remove_inline_cr) const {
+  // Everything that is not a plain data line is left to ProcessLine() so that
+  // the behavior, and the error messages, are exactly the same.
+  ColumnsLine result;
+  result.text = line;
+  if (remove_inline_cr) {
+    const size_t cr = line.find('\r');
+    if (cr != absl::string_view::npos && cr + 1 != line.size()) return result;
+  }
+  const absl::StatusOr<internal::MPSLineInfo> line_info =
+      internal::MPSLineInfo::Create(/*line_num=*/0, free_form_, line);
+  if (!line_info.ok()) return result;
+  if (line_info->IsCommentOrBlank()) {
+    result.kind = ColumnsLine::kSkip;
+    return result;
+  }
+  if (line_info->IsNewSection() ||
+      absl::StrContains(line_info->GetLine(), "'MARKER'")) {
+    return result;
+  }
+  const int start_index = free_form_ ? 0 : 1;
+  const int num_fields = line_info->GetFieldsSize();
+  if (num_fields < start_index + 3 || num_fields == start_index + 4) {
+    return result;
+  }
+  const int num_pairs = num_fields - start_index > 4 ? 2 : 1;
+  for (int i = 0; i < num_pairs; ++i) {
+    const absl::string_view row_name =
+        line_info->GetField(start_index + 1 + 2 * i);
+    if (row_name.empty() || row_name == "$") continue;
+    double value;
+    if (!absl::SimpleAtod(line_info->GetField(start_index + 2 + 2 * i),
+                          &value) ||
+        !std::isfinite(value)) {
+      return result;
+    }
+    if (value == 0.0) continue;
+    const int entry = result.num_entries;
+    if (row_name == objective_name_) {
+      result.is_objective[entry] = true;
+    } else {
+      const auto it = row_name_to_index_.find(row_name);
+      if (it == row_name_to_index_.end()) return result;
+      result.is_objective[entry] = false;
+      result.rows[entry] = it->second;
+    }
+    result.values[entry] = value;
+    ++result.num_entries;
+  }
+  result.kind = ColumnsLine::kData;
+  result.text = line_info->GetField(start_index);
+  return result;
+}
+
+template <class DataWrapper>
+absl::Status MPSReaderTemplate<DataWrapper>::StoreColumnsLine(
+    const ColumnsLine& line, bool remove_inline_cr, DataWrapper* data) {
+  switch (line.kind) {
+    case ColumnsLine::kSkip:
+      ++line_num_;
+      break;
+    case ColumnsLine::kData: {
+      ++line_num_;
+      const IndexType col = ProcessColumnName(line.text, data);
+      for (int i = 0; i < line.num_entries; ++i) {
+        if (line.is_objective[i]) {
+          data->SetObjectiveCoefficient(col, line.values[i]);
+        } else {
+          data->SetConstraintCoefficient(line.rows[i], col, line.values[i]);
+        }
+      }
+      break;
+    }
+    case ColumnsLine::kFallback:
+      return ProcessRawLine(line.text, remove_inline_cr, data);
+  }
+  return absl::OkStatus();
 }
 
 template <class DataWrapper>
@@ -811,6 +1098,7 @@ absl::Status MPSReaderTemplate<DataWrapper>::ProcessRowsSection(
     }
     const IndexType row = data->FindOrCreateConstraint(row_name);
     if (is_lazy) data->SetIsLazy(row);
+    if (num_threads_ > 1) row_name_to_index_.try_emplace(row_name, row);
 
     // The initial row range is [0, 0]. We encode the type in the range by
     // setting one of the bounds to +/- infinity.
@@ -864,16 +1152,7 @@ absl::Status MPSReaderTemplate<DataWrapper>::ProcessColumnsSection(
   const absl::string_view column_name = line_info.GetField(start_index + 0);
   const absl::string_view row1_name = line_info.GetField(start_index + 1);
   const absl::string_view row1_value = line_info.GetField(start_index + 2);
-  const IndexType col = data->FindOrCreateVariable(column_name);
-  is_binary_by_default_.resize(col + 1, false);
-  if (in_integer_section_) {
-    data->SetVariableTypeToInteger(col);
-    // The default bounds for integer variables are [0, 1].
-    data->SetVariableBounds(col, 0.0, 1.0);
-    is_binary_by_default_[col] = true;
-  } else {
-    data->SetVariableBounds(col, 0.0, kInfinity);
-  }
+  const IndexType col = ProcessColumnName(column_name, data);
   RETURN_IF_ERROR(
       StoreCoefficient(line_info, col, row1_name, row1_value, data));
   if (line_info.GetFieldsSize() == start_index + 4) {
@@ -888,6 +1167,28 @@ absl::Status MPSReaderTemplate<DataWrapper>::ProcessColumnsSection(
   return absl::OkStatus();
 }
 
+template <class DataWrapper>
+typename MPSReaderTemplate<DataWrapper>::IndexType
+MPSReaderTemplate<DataWrapper>::ProcessColumnName(
+    absl::string_view column_name, DataWrapper* data) {
+  if (!has_last_column_ || column_name != last_column_name_) {
+    last_column_ = data->FindOrCreateVariable(column_name);
+    last_column_name_ = std::string(column_name);
+    has_last_column_ = true;
+  }
+  const IndexType col = last_column_;
+  is_binary_by_default_.resize(col + 1, false);
+  if (in_integer_section_) {
+    data->SetVariableTypeToInteger(col);
+    // The default bounds for integer variables are [0, 1].
+    data->SetVariableBounds(col, 0.0, 1.0);
+    is_binary_by_default_[col] = true;
+  } else {
+    data->SetVariableBounds(col, 0.0, kInfinity);
+  }
+  return col;
+}
+
 template <class DataWrapper>
 absl::Status MPSReaderTemplate<DataWrapper>::ProcessRhsSection(
     const internal::MPSLineInfo& line_info, DataWrapper* data) {
@@ -1187,6 +1488,8 @@ void MPSReaderTemplate<DataWrapper>::Reset() {
   in_integer_section_ = false;
   num_unconstrained_rows_ = 0;
   objective_name_.clear();
+  row_name_to_index_.clear();
+  has_last_column_ = false;
 }
 
 template <class DataWrapper>
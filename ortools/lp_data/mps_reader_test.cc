@@ -0,0 +1,206 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/lp_data/mps_reader.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/random/distributions.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ortools/base/file.h"
+#include "ortools/linear_solver/linear_solver.pb.h"
+
+namespace operations_research {
+namespace glop {
+namespace {
+
+using ::testing::HasSubstr;
+
+// The COLUMNS section must span at least this many bytes to be parsed in
+// parallel, see MPSReaderTemplate::kMinParallelColumnsSize.
+constexpr int kMinParallelColumnsSize = 1 << 20;
+
+struct MpsOptions {
+  // Indent some data lines with a tab instead of a space, add some comments
+  // and end some lines with "\r\n".
+  bool mixed_whitespace = false;
+  // If not empty, this line replaces the data line in the middle of the
+  // COLUMNS section.
+  std::string bad_line;
+};
+
+// Generates a free format MPS model with num_cols columns, each with a random
+// objective coefficient and 5 random coefficients on num_rows rows, written
+// two per line. The columns of the middle third are integer. Sets
+// *bad_line_number to the number of the replaced line, if any.
+std::string GenerateMps(int num_rows, int num_cols, const MpsOptions& options,
+                        std::mt19937* random, int* bad_line_number = nullptr) {
+  std::vector<std::string> lines = {"NAME test", "ROWS", " N COST"};
+  for (int row = 0; row < num_rows; ++row) {
+    lines.push_back(absl::StrCat(" ", row % 2 == 0 ? "L" : "G", " R", row));
+  }
+  lines.push_back("COLUMNS");
+  std::vector<int> data_lines;
+  for (int col = 0; col < num_cols; ++col) {
+    if (col == num_cols / 3) {
+      lines.push_back(" MARKER 'MARKER' 'INTORG'");
+    } else if (col == 2 * num_cols / 3) {
+      lines.push_back(" MARKER 'MARKER' 'INTEND'");
+    }
+    std::vector<std::string> entries = {absl::StrCat(
+        "COST ", absl::Uniform<int>(*random, -20, 20) / 4.0)};
+    for (int i = 0; i < 5; ++i) {
+      entries.push_back(absl::StrCat("R", absl::Uniform(*random, 0, num_rows),
+                                     " ",
+                                     absl::Uniform<int>(*random, -99, 99)));
+    }
+    for (int i = 0; i < entries.size(); i += 2) {
+      const char* indent = " ";
+      if (options.mixed_whitespace) {
+        if (absl::Bernoulli(*random, 0.01)) lines.push_back("* comment");
+        if (absl::Bernoulli(*random, 0.1)) indent = "\t";
+      }
+      std::string line = absl::StrCat(indent, "X", col, " ", entries[i]);
+      if (i + 1 < entries.size()) absl::StrAppend(&line, " ", entries[i + 1]);
+      if (options.mixed_whitespace && absl::Bernoulli(*random, 0.1)) {
+        line += "\r";
+      }
+      data_lines.push_back(lines.size());
+      lines.push_back(line);
+    }
+  }
+  if (!options.bad_line.empty()) {
+    const int index = data_lines[data_lines.size() / 2];
+    lines[index] = options.bad_line;
+    if (bad_line_number != nullptr) *bad_line_number = index + 1;
+  }
+  lines.push_back("RHS");
+  for (int row = 0; row < num_rows; ++row) {
+    lines.push_back(absl::StrCat(" RHS R", row, " ", row % 7));
+  }
+  lines.push_back("BOUNDS");
+  for (int col = 0; col < num_cols; col += 3) {
+    lines.push_back(absl::StrCat(" UP BND X", col, " ", col % 5 + 1));
+  }
+  lines.push_back("ENDATA");
+
+  std::string mps;
+  for (const std::string& line : lines) absl::StrAppend(&mps, line, "\n");
+  return mps;
+}
+
+TEST(MpsReaderTest, ParallelParsingMatchesSequentialParsing) {
+  std::mt19937 random(12345);
+  for (const bool mixed_whitespace : {false, true}) {
+    MpsOptions options;
+    options.mixed_whitespace = mixed_whitespace;
+    const std::string mps = GenerateMps(1000, 40000, options, &random);
+    ASSERT_GT(mps.size(), 2 * kMinParallelColumnsSize);
+
+    const absl::StatusOr<MPModelProto> sequential =
+        MpsDataToMPModelProto(mps, /*num_threads=*/1);
+    ASSERT_TRUE(sequential.ok()) << sequential.status();
+    EXPECT_EQ(sequential->variable_size(), 40000);
+    EXPECT_EQ(sequential->constraint_size(), 1000);
+    for (const int num_threads : {2, 4}) {
+      const absl::StatusOr<MPModelProto> parallel =
+          MpsDataToMPModelProto(mps, num_threads);
+      ASSERT_TRUE(parallel.ok()) << parallel.status();
+      EXPECT_EQ(parallel->SerializeAsString(), sequential->SerializeAsString())
+          << "num_threads: " << num_threads
+          << ", mixed_whitespace: " << mixed_whitespace;
+    }
+  }
+}
+
+TEST(MpsReaderTest, ParallelParsingReportsTheSameErrors) {
+  const std::vector<std::string> bad_lines = {
+      // Invalid number.
+      " X7 R1 1.5x",
+      // Too many fields.
+      " X7 R1 1 R2 2 R3 3",
+      // Missing value.
+      " X7 R1",
+      // Infinite coefficient.
+      " X7 R1 inf",
+  };
+  std::mt19937 random(12345);
+  for (const std::string& bad_line : bad_lines) {
+    MpsOptions options;
+    options.mixed_whitespace = true;
+    options.bad_line = bad_line;
+    int bad_line_number = 0;
+    const std::string mps =
+        GenerateMps(1000, 40000, options, &random, &bad_line_number);
+
+    const absl::StatusOr<MPModelProto> sequential =
+        MpsDataToMPModelProto(mps, /*num_threads=*/1);
+    ASSERT_FALSE(sequential.ok()) << bad_line;
+    EXPECT_THAT(sequential.status().message(),
+                HasSubstr(absl::StrCat("Line ", bad_line_number, ":")))
+        << sequential.status();
+    for (const int num_threads : {2, 4}) {
+      const absl::StatusOr<MPModelProto> parallel =
+          MpsDataToMPModelProto(mps, num_threads);
+      EXPECT_EQ(parallel.status(), sequential.status())
+          << "num_threads: " << num_threads;
+    }
+  }
+}
+
+TEST(MpsReaderTest, FileParsingMatchesStringParsing) {
+  std::mt19937 random(12345);
+  MpsOptions options;
+  options.mixed_whitespace = true;
+  const std::string mps = GenerateMps(100, 1000, options, &random);
+  const std::string file_name =
+      absl::StrCat(::testing::TempDir(), "/file_parsing.mps");
+  ASSERT_TRUE(file::SetContents(file_name, mps, file::Defaults()).ok());
+
+  const absl::StatusOr<MPModelProto> from_string = MpsDataToMPModelProto(mps);
+  ASSERT_TRUE(from_string.ok()) << from_string.status();
+  const absl::StatusOr<MPModelProto> from_file =
+      MpsFileToMPModelProto(file_name);
+  ASSERT_TRUE(from_file.ok()) << from_file.status();
+  EXPECT_EQ(from_file->SerializeAsString(), from_string->SerializeAsString());
+  EXPECT_FALSE(MpsFileToMPModelProto(file_name + ".missing").ok());
+}
+
+// Parsing throughput, in MB/s of MPS data, with the given number of threads.
+void BM_MpsDataToMPModelProto(benchmark::State& state) {
+  std::mt19937 random(12345);
+  const std::string mps = GenerateMps(10000, 200000, MpsOptions(), &random);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MpsDataToMPModelProto(mps, state.range(0)));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          mps.size());
+}
+BENCHMARK(BM_MpsDataToMPModelProto)
+    ->Arg(1)
+    ->Arg(4)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace glop
+}  // namespace operations_research
@@ -0,0 +1,78 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/lp_data/sharded_executor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "absl/log/check.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "ortools/base/threadpool.h"
+
+namespace operations_research {
+namespace glop {
+
+void ShardedExecutor::SetNumThreads(int num_threads) {
+  num_threads = std::max(num_threads, 1);
+  if (num_threads == num_threads_) return;
+  num_threads_ = num_threads;
+  thread_pool_.reset();
+}
+
+int ShardedExecutor::NumShards(int64_t size, int64_t min_shard_size) const {
+  DCHECK_GT(min_shard_size, 0);
+  return static_cast<int>(
+      std::max<int64_t>(1, std::min<int64_t>(num_threads_,
+                                             size / min_shard_size)));
+}
+
+void ShardedExecutor::ParallelFor(
+    int64_t size, int64_t min_shard_size,
+    const std::function<void(int shard, int64_t begin, int64_t end)>&
+        shard_function,
+    int64_t alignment) {
+  DCHECK_GT(alignment, 0);
+  const int num_shards = NumShards(size, min_shard_size);
+  if (num_shards == 1) {
+    shard_function(0, 0, size);
+    return;
+  }
+
+  const auto shard_begin = [size, num_shards, alignment](int shard) {
+    if (shard == num_shards) return size;
+    return (size * shard / num_shards) / alignment * alignment;
+  };
+
+  // The calling thread processes the first shard, so the pool only needs
+  // num_threads_ - 1 workers.
+  if (thread_pool_ == nullptr) {
+    thread_pool_ = std::make_unique<ThreadPool>("ShardedExecutor",
+                                                num_threads_ - 1);
+    thread_pool_->StartWorkers();
+  }
+  absl::BlockingCounter counter(num_shards - 1);
+  for (int shard = 1; shard < num_shards; ++shard) {
+    thread_pool_->Schedule([&, shard]() {
+      shard_function(shard, shard_begin(shard), shard_begin(shard + 1));
+      counter.DecrementCount();
+    });
+  }
+  shard_function(0, 0, shard_begin(1));
+  counter.Wait();
+}
+
+}  // namespace glop
+}  // namespace operations_research
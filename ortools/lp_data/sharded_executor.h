@@ -0,0 +1,73 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OR_TOOLS_LP_DATA_SHARDED_EXECUTOR_H_
+#define OR_TOOLS_LP_DATA_SHARDED_EXECUTOR_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "ortools/base/threadpool.h"
+
+namespace operations_research {
+namespace glop {
+
+// Runs a loop over [0, size) split in contiguous shards, possibly in parallel.
+// This is similar in spirit to pdlp/sharder.h, but without the Eigen
+// dependency and with a thread pool that is owned and reused across calls,
+// since in the simplex the loops are short and run once per iteration.
+//
+// Determinism: the shard boundaries only depend on size and NumShards(), and
+// shard i always covers a range that is before the one of shard i + 1. Callers
+// that write disjoint outputs, or that combine per-shard results in shard
+// order, thus get exactly the same result as the sequential loop, whatever the
+// thread scheduling.
+class ShardedExecutor {
+ public:
+  ShardedExecutor() = default;
+
+  // This type is neither copyable nor movable.
+  ShardedExecutor(const ShardedExecutor&) = delete;
+  ShardedExecutor& operator=(const ShardedExecutor&) = delete;
+
+  // Sets the number of threads. A value <= 1 means that all the work is done
+  // in the calling thread. The threads are only created on the first parallel
+  // call.
+  void SetNumThreads(int num_threads);
+  int NumThreads() const { return num_threads_; }
+
+  // Returns the number of shards ParallelFor() will use for the given size.
+  // This is at most NumThreads(), and at most size / min_shard_size so that
+  // each shard has enough work to amortize the scheduling overhead.
+  int NumShards(int64_t size, int64_t min_shard_size) const;
+
+  // Calls shard_function(shard, begin, end) for each of the NumShards(size,
+  // min_shard_size) shards and returns once all the calls are done. The ranges
+  // [begin, end) partition [0, size), and begin is always a multiple of
+  // alignment so that shards can work on whole words of a bitset for instance.
+  void ParallelFor(
+      int64_t size, int64_t min_shard_size,
+      const std::function<void(int shard, int64_t begin, int64_t end)>&
+          shard_function,
+      int64_t alignment = 1);
+
+ private:
+  int num_threads_ = 1;
+  std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+}  // namespace glop
+}  // namespace operations_research
+
+#endif  // OR_TOOLS_LP_DATA_SHARDED_EXECUTOR_H_
@@ -14,7 +14,9 @@
 #include "ortools/lp_data/sparse.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <functional>
 #include <initializer_list>
 #include <string>
 #include <utility>
@@ -25,6 +27,7 @@
 #include "ortools/base/logging.h"
 #include "ortools/lp_data/lp_types.h"
 #include "ortools/lp_data/permutation.h"
+#include "ortools/lp_data/sharded_executor.h"
 
 namespace operations_research {
 namespace glop {
@@ -529,6 +532,7 @@ void CompactSparseMatrix::PopulateFromTranspose(
 
 void TriangularMatrix::PopulateFromTranspose(const TriangularMatrix& input) {
   CompactSparseMatrix::PopulateFromTranspose(input);
+  InvalidateSolveCaches();
 
   // This takes care of the triangular special case.
   diagonal_coefficients_ = input.diagonal_coefficients_;
@@ -562,6 +566,7 @@ void CompactSparseMatrix::Reset(RowIndex num_rows) {
 
 void TriangularMatrix::Reset(RowIndex num_rows, ColIndex col_capacity) {
   CompactSparseMatrix::Reset(num_rows);
+  InvalidateSolveCaches();
   first_non_identity_column_ = 0;
   all_diagonal_coefficients_are_one_ = true;
 
@@ -635,6 +640,8 @@ void TriangularMatrix::Swap(TriangularMatrix* other) {
   std::swap(first_non_identity_column_, other->first_non_identity_column_);
   std::swap(all_diagonal_coefficients_are_one_,
             other->all_diagonal_coefficients_are_one_);
+  InvalidateSolveCaches();
+  other->InvalidateSolveCaches();
 }
 
 EntryIndex CompactSparseMatrixView::num_entries() const {
@@ -656,6 +663,7 @@ void TriangularMatrix::CloseCurrentColumn(Fractional diagonal_value) {
   // been preallocated by a call to SetTotalNumberOfColumns().
   DCHECK_LT(num_cols_, diagonal_coefficients_.size());
   diagonal_coefficients_[num_cols_] = diagonal_value;
+  InvalidateSolveCaches();
 
   // TODO(user): This is currently not used by all matrices. It will be good
   // to fill it only when needed.
@@ -750,6 +758,7 @@ bool TriangularMatrix::IsUpperTriangular() const {
 
 void TriangularMatrix::ApplyRowPermutationToNonDiagonalEntries(
     const RowPermutation& row_perm) {
+  InvalidateSolveCaches();
   EntryIndex num_entries = rows_.size();
   for (EntryIndex i(0); i < num_entries; ++i) {
     rows_[i] = row_perm[rows_[i]];
@@ -855,44 +864,43 @@ void TriangularMatrix::TransposeUpperSolve(DenseColumn* rhs) const {
 }
 
 template <bool diagonal_of_ones>
-void TriangularMatrix::TransposeUpperSolveInternal(
-    DenseColumn::View rhs) const {
-  const ColIndex end = num_cols_;
-  const auto starts = starts_.view();
+Fractional TriangularMatrix::TransposeUpperSolveColumn(
+    ColIndex col, DenseColumn::View rhs) const {
   const auto entry_rows = rows_.view();
   const auto entry_coefficients = coefficients_.view();
-  const auto diagonal_coefficients = diagonal_coefficients_.view();
-
-  EntryIndex i = starts_[first_non_identity_column_];
-  for (ColIndex col(first_non_identity_column_); col < end; ++col) {
-    Fractional sum = rhs[ColToRowIndex(col)];
-
-    // Note that this is a bit faster than the simpler
-    //     for (const EntryIndex i : Column(col)) {
-    // EntryIndex i is explicitly not modified in outer iterations, since
-    // the last entry in column col is stored contiguously just before the
-    // first entry in column col+1.
-    const EntryIndex i_end = starts[col + 1];
-    const EntryIndex shifted_end = i_end - 3;
-    for (; i < shifted_end; i += 4) {
-      sum -= entry_coefficients[i] * rhs[entry_rows[i]] +
-             entry_coefficients[i + 1] * rhs[entry_rows[i + 1]] +
-             entry_coefficients[i + 2] * rhs[entry_rows[i + 2]] +
-             entry_coefficients[i + 3] * rhs[entry_rows[i + 3]];
-    }
-    if (i < i_end) {
-      sum -= entry_coefficients[i] * rhs[entry_rows[i]];
-      if (i + 1 < i_end) {
-        sum -= entry_coefficients[i + 1] * rhs[entry_rows[i + 1]];
-        if (i + 2 < i_end) {
-          sum -= entry_coefficients[i + 2] * rhs[entry_rows[i + 2]];
-        }
+  Fractional sum = rhs[ColToRowIndex(col)];
+
+  // Note that this is a bit faster than the simpler
+  //     for (const EntryIndex i : Column(col)) {
+  // because of the manual unrolling.
+  EntryIndex i = starts_[col];
+  const EntryIndex i_end = starts_[col + 1];
+  const EntryIndex shifted_end = i_end - 3;
+  for (; i < shifted_end; i += 4) {
+    sum -= entry_coefficients[i] * rhs[entry_rows[i]] +
+           entry_coefficients[i + 1] * rhs[entry_rows[i + 1]] +
+           entry_coefficients[i + 2] * rhs[entry_rows[i + 2]] +
+           entry_coefficients[i + 3] * rhs[entry_rows[i + 3]];
+  }
+  if (i < i_end) {
+    sum -= entry_coefficients[i] * rhs[entry_rows[i]];
+    if (i + 1 < i_end) {
+      sum -= entry_coefficients[i + 1] * rhs[entry_rows[i + 1]];
+      if (i + 2 < i_end) {
+        sum -= entry_coefficients[i + 2] * rhs[entry_rows[i + 2]];
       }
-      i = i_end;
     }
+  }
+  return diagonal_of_ones ? sum : sum / diagonal_coefficients_[col];
+}
 
+template <bool diagonal_of_ones>
+void TriangularMatrix::TransposeUpperSolveInternal(
+    DenseColumn::View rhs) const {
+  const ColIndex end = num_cols_;
+  for (ColIndex col(first_non_identity_column_); col < end; ++col) {
     rhs[ColToRowIndex(col)] =
-        diagonal_of_ones ? sum : sum / diagonal_coefficients[col];
+        TransposeUpperSolveColumn<diagonal_of_ones>(col, rhs);
   }
 }
 
@@ -916,42 +924,161 @@ void TriangularMatrix::TransposeLowerSolveInternal(
     --col;
   }
 
-  const auto starts = starts_.view();
-  const auto diagonal_coeffs = diagonal_coefficients_.view();
+  for (; col >= end; --col) {
+    rhs[ColToRowIndex(col)] =
+        TransposeLowerSolveColumn<diagonal_of_ones>(col, rhs);
+  }
+}
+
+template <bool diagonal_of_ones>
+Fractional TriangularMatrix::TransposeLowerSolveColumn(
+    ColIndex col, DenseColumn::View rhs) const {
   const auto entry_rows = rows_.view();
   const auto entry_coefficients = coefficients_.view();
-  EntryIndex i = starts[col + 1] - 1;
-  for (; col >= end; --col) {
-    Fractional sum = rhs[ColToRowIndex(col)];
-
-    // Note that this is a bit faster than the simpler
-    //     for (const EntryIndex i : Column(col)) {
-    // mainly because we iterate in a good direction for the cache.
-    // EntryIndex i is explicitly not modified in outer iterations, since
-    // the last entry in column col is stored contiguously just before the
-    // first entry in column col+1.
-    const EntryIndex i_end = starts[col];
-    const EntryIndex shifted_end = i_end + 3;
-    for (; i >= shifted_end; i -= 4) {
-      sum -= entry_coefficients[i] * rhs[entry_rows[i]] +
-             entry_coefficients[i - 1] * rhs[entry_rows[i - 1]] +
-             entry_coefficients[i - 2] * rhs[entry_rows[i - 2]] +
-             entry_coefficients[i - 3] * rhs[entry_rows[i - 3]];
+  Fractional sum = rhs[ColToRowIndex(col)];
+
+  // Note that this is a bit faster than the simpler
+  //     for (const EntryIndex i : Column(col)) {
+  // mainly because we iterate in a good direction for the cache.
+  EntryIndex i = starts_[col + 1] - 1;
+  const EntryIndex i_end = starts_[col];
+  const EntryIndex shifted_end = i_end + 3;
+  for (; i >= shifted_end; i -= 4) {
+    sum -= entry_coefficients[i] * rhs[entry_rows[i]] +
+           entry_coefficients[i - 1] * rhs[entry_rows[i - 1]] +
+           entry_coefficients[i - 2] * rhs[entry_rows[i - 2]] +
+           entry_coefficients[i - 3] * rhs[entry_rows[i - 3]];
+  }
+  if (i >= i_end) {
+    sum -= entry_coefficients[i] * rhs[entry_rows[i]];
+    if (i >= i_end + 1) {
+      sum -= entry_coefficients[i - 1] * rhs[entry_rows[i - 1]];
+      if (i >= i_end + 2) {
+        sum -= entry_coefficients[i - 2] * rhs[entry_rows[i - 2]];
+      }
     }
-    if (i >= i_end) {
-      sum -= entry_coefficients[i] * rhs[entry_rows[i]];
-      if (i >= i_end + 1) {
-        sum -= entry_coefficients[i - 1] * rhs[entry_rows[i - 1]];
-        if (i >= i_end + 2) {
-          sum -= entry_coefficients[i - 2] * rhs[entry_rows[i - 2]];
+  }
+  return diagonal_of_ones ? sum : sum / diagonal_coefficients_[col];
+}
+
+void TriangularMatrix::ParallelTransposeLowerSolve(ShardedExecutor* executor,
+                                                   DenseColumn* rhs) const {
+  RETURN_IF_NULL(rhs);
+  if (all_diagonal_coefficients_are_one_) {
+    ParallelTransposeSolveInternal<true>(/*lower=*/true, executor,
+                                         rhs->view());
+  } else {
+    ParallelTransposeSolveInternal<false>(/*lower=*/true, executor,
+                                          rhs->view());
+  }
+}
+
+void TriangularMatrix::ParallelTransposeUpperSolve(ShardedExecutor* executor,
+                                                   DenseColumn* rhs) const {
+  RETURN_IF_NULL(rhs);
+  if (all_diagonal_coefficients_are_one_) {
+    ParallelTransposeSolveInternal<true>(/*lower=*/false, executor,
+                                         rhs->view());
+  } else {
+    ParallelTransposeSolveInternal<false>(/*lower=*/false, executor,
+                                          rhs->view());
+  }
+}
+
+template <bool diagonal_of_ones>
+void TriangularMatrix::ParallelTransposeSolveInternal(
+    bool lower, ShardedExecutor* executor, DenseColumn::View rhs) const {
+  // A shard must contain enough columns to amortize the synchronization, and
+  // we only use the schedule if on average a level can be split in a few
+  // shards. Otherwise most of the levels would be processed by the calling
+  // thread anyway, with the overhead of the schedule.
+  const int kMinColumnsPerShard = 1024;
+  const int kMinAverageLevelWidth = 4 * kMinColumnsPerShard;
+  bool use_schedule =
+      executor != nullptr && executor->NumThreads() > 1 &&
+      (num_cols_ - first_non_identity_column_).value() >= kMinAverageLevelWidth;
+  if (use_schedule) {
+    ComputeLevelSchedule(lower);
+    const int num_levels = static_cast<int>(level_starts_.size()) - 1;
+    use_schedule = static_cast<int64_t>(num_levels) * kMinAverageLevelWidth <=
+                   static_cast<int64_t>(level_cols_.size());
+  }
+  if (!use_schedule) {
+    if (lower) {
+      TransposeLowerSolveInternal<diagonal_of_ones>(rhs);
+    } else {
+      TransposeUpperSolveInternal<diagonal_of_ones>(rhs);
+    }
+    return;
+  }
+
+  // All the columns of a level only read entries of rhs computed in the
+  // previous levels and each write a different entry, so the shards never
+  // conflict and the result does not depend on the scheduling.
+  int level_start = 0;
+  const std::function<void(int, int64_t, int64_t)> solve_shard =
+      [&](int /*shard*/, int64_t begin, int64_t end) {
+        for (int64_t k = level_start + begin; k < level_start + end; ++k) {
+          const ColIndex col = level_cols_[k];
+          rhs[ColToRowIndex(col)] =
+              lower ? TransposeLowerSolveColumn<diagonal_of_ones>(col, rhs)
+                    : TransposeUpperSolveColumn<diagonal_of_ones>(col, rhs);
         }
-      }
-      i = i_end - 1;
+      };
+  const int num_levels = static_cast<int>(level_starts_.size()) - 1;
+  for (int level = 0; level < num_levels; ++level) {
+    level_start = level_starts_[level];
+    executor->ParallelFor(level_starts_[level + 1] - level_start,
+                          kMinColumnsPerShard, solve_shard);
+  }
+}
+
+void TriangularMatrix::ComputeLevelSchedule(bool lower) const {
+  if (level_schedule_is_valid_ && level_schedule_is_for_lower_ == lower) {
+    return;
+  }
+  level_schedule_is_valid_ = true;
+  level_schedule_is_for_lower_ = lower;
+
+  // The level of a column is one more than the maximum level of the rows of
+  // its entries. The rows before first_non_identity_column_ are not part of
+  // the solve, their level is -1. The columns are processed in the same order
+  // as in the sequential solve, so that the rows are always processed first.
+  const ColIndex begin = first_non_identity_column_;
+  const ColIndex end = num_cols_;
+  col_levels_.assign(end, -1);
+  const auto entry_rows = rows_.view();
+  int num_levels = 0;
+  const auto compute_level = [&](ColIndex col) {
+    int level = 0;
+    for (const EntryIndex i : Column(col)) {
+      level = std::max(level, col_levels_[RowToColIndex(entry_rows[i])] + 1);
     }
+    col_levels_[col] = level;
+    num_levels = std::max(num_levels, level + 1);
+  };
+  if (lower) {
+    for (ColIndex col = end - 1; col >= begin; --col) compute_level(col);
+  } else {
+    for (ColIndex col = begin; col < end; ++col) compute_level(col);
+  }
 
-    rhs[ColToRowIndex(col)] =
-        diagonal_of_ones ? sum : sum / diagonal_coeffs[col];
+  // Counting sort of the columns by level.
+  level_starts_.assign(num_levels + 1, 0);
+  for (ColIndex col = begin; col < end; ++col) {
+    ++level_starts_[col_levels_[col] + 1];
+  }
+  for (int level = 0; level < num_levels; ++level) {
+    level_starts_[level + 1] += level_starts_[level];
+  }
+  level_cols_.resize((end - begin).value());
+  for (ColIndex col = begin; col < end; ++col) {
+    level_cols_[level_starts_[col_levels_[col]]++] = col;
+  }
+  for (int level = num_levels; level > 0; --level) {
+    level_starts_[level] = level_starts_[level - 1];
   }
+  level_starts_[0] = 0;
 }
 
 void TriangularMatrix::HyperSparseSolve(DenseColumn* rhs,
@@ -1466,6 +1593,28 @@ void TriangularMatrix::ComputeRowsToConsiderInSortedOrder(
     return;
   }
 
+  // Look up the reach cache. On a miss, the entry is overwritten with the
+  // input now and with the output at the end.
+  ReachCacheEntry* cache_entry = nullptr;
+  if (use_reach_cache_) {
+    const int kReachCacheSize = 64;
+    if (!reach_cache_is_valid_) {
+      reach_cache_.resize(kReachCacheSize);
+      for (ReachCacheEntry& entry : reach_cache_) entry.input.clear();
+      reach_cache_is_valid_ = true;
+    }
+    uint64_t hash = non_zero_rows->size();
+    for (const RowIndex row : *non_zero_rows) {
+      hash = hash * uint64_t{0x9E3779B97F4A7C15} + row.value();
+    }
+    cache_entry = &reach_cache_[(hash ^ (hash >> 32)) % kReachCacheSize];
+    if (cache_entry->input == *non_zero_rows) {
+      *non_zero_rows = cache_entry->output;
+      return;
+    }
+    cache_entry->input = *non_zero_rows;
+  }
+
   stored_.resize(num_rows_, false);
   for (const RowIndex row : *non_zero_rows) stored_[row] = true;
 
@@ -1489,6 +1638,7 @@ void TriangularMatrix::ComputeRowsToConsiderInSortedOrder(
   } else {
     std::sort(non_zero_rows->begin(), non_zero_rows->end());
   }
+  if (cache_entry != nullptr) cache_entry->output = *non_zero_rows;
 }
 
 // A known upper bound for the infinity norm of T^{-1} is the
@@ -38,6 +38,7 @@
 #include "ortools/lp_data/lp_types.h"
 #include "ortools/lp_data/permutation.h"
 #include "ortools/lp_data/scattered_vector.h"
+#include "ortools/lp_data/sharded_executor.h"
 #include "ortools/lp_data/sparse_column.h"
 #include "ortools/util/return_macros.h"
 
@@ -303,6 +304,14 @@ class CompactSparseMatrix {
           rows_(matrix->rows_.data()),
           starts_(matrix->starts_.data()) {}
 
+    // Creates a view on a matrix stored elsewhere in the same compressed
+    // column format, for instance in a memory-mapped file (see
+    // lp_snapshot.h). starts must have num_cols + 1 entries, and the arrays
+    // must outlive the view.
+    ConstView(const Fractional* coefficients, const RowIndex* rows,
+              const EntryIndex* starts)
+        : coefficients_(coefficients), rows_(rows), starts_(starts) {}
+
     // Functions to iterate on the entries of a given column:
     // const auto view = compact_matrix.view();
     // for (const EntryIndex i : view.Column(col)) {
@@ -696,6 +705,21 @@ class TriangularMatrix : private CompactSparseMatrix {
   // This can be used to do a left-solve for a row vector (i.e., y.Y = rhs).
   void TransposeLowerSolve(DenseColumn* rhs) const;
 
+  // Same as TransposeLowerSolve() and TransposeUpperSolve() but using a level
+  // schedule of the columns: in a transpose solve, the value of a column only
+  // depends on the values of the rows of its entries, so all the columns whose
+  // longest chain of dependencies has the same length (a "level") can be
+  // computed in parallel. The result is exactly the same as the one of the
+  // sequential version.
+  //
+  // The schedule is computed on the first call after the matrix changed. If
+  // executor is nullptr, has only one thread, or if the levels are too narrow
+  // to be worth the synchronization, this just calls the sequential version.
+  void ParallelTransposeLowerSolve(ShardedExecutor* executor,
+                                   DenseColumn* rhs) const;
+  void ParallelTransposeUpperSolve(ShardedExecutor* executor,
+                                   DenseColumn* rhs) const;
+
   // Hyper-sparse version of the triangular solve functions. The passed
   // non_zero_rows should contain the positions of the symbolic non-zeros of the
   // result in the order in which they need to be accessed (or in the reverse
@@ -748,6 +772,14 @@ class TriangularMatrix : private CompactSparseMatrix {
                                           Fractional sparsity_ratio,
                                           Fractional num_ops_ratio) const;
   void ComputeRowsToConsiderInSortedOrder(RowIndexVector* non_zero_rows) const;
+
+  // If enabled, ComputeRowsToConsiderInSortedOrder() keeps the result of its
+  // last calls in a small direct-mapped cache indexed by the exact input
+  // non-zero positions. This is useful when the same sparsity patterns are
+  // solved over and over with the same factorization, for instance for the
+  // unit rows and the entering columns of the simplex. The cache is
+  // automatically invalidated when the matrix is modified.
+  void EnableReachCache(bool enable) { use_reach_cache_ = enable; }
   // This is currently only used for testing. It achieves the same result as
   // PermutedLowerSparseSolve() below, but the latter exploits the sparsity of
   // rhs and is thus faster for our use case.
@@ -839,6 +871,28 @@ class TriangularMatrix : private CompactSparseMatrix {
   template <bool diagonal_of_ones>
   void TransposeUpperSolveInternal(DenseColumn::View rhs) const;
   template <bool diagonal_of_ones>
+  void ParallelTransposeSolveInternal(bool lower, ShardedExecutor* executor,
+                                      DenseColumn::View rhs) const;
+
+  // Returns the new value of rhs[col] in a transpose lower (resp. upper)
+  // solve, assuming the values of the rows of the column entries are final.
+  template <bool diagonal_of_ones>
+  Fractional TransposeLowerSolveColumn(ColIndex col,
+                                       DenseColumn::View rhs) const;
+  template <bool diagonal_of_ones>
+  Fractional TransposeUpperSolveColumn(ColIndex col,
+                                       DenseColumn::View rhs) const;
+
+  // Fills level_starts_ and level_cols_ for a transpose lower (resp. upper)
+  // solve if they are not already valid.
+  void ComputeLevelSchedule(bool lower) const;
+
+  // Must be called each time the structure of the matrix changes.
+  void InvalidateSolveCaches() {
+    level_schedule_is_valid_ = false;
+    reach_cache_is_valid_ = false;
+  }
+  template <bool diagonal_of_ones>
   void HyperSparseSolveInternal(DenseColumn::View rhs,
                                 RowIndexVector* non_zero_rows) const;
   template <bool diagonal_of_ones>
@@ -929,6 +983,25 @@ class TriangularMatrix : private CompactSparseMatrix {
   // TODO(user): Use this during the "normal" hyper-sparse solves so that
   // we can benefit from the pruned lower matrix there?
   StrictITIVector<ColIndex, EntryIndex> pruned_ends_;
+
+  // Level schedule for the parallel transpose solves. The columns of level l
+  // are level_cols_[level_starts_[l] .. level_starts_[l + 1]), by increasing
+  // index. Only the columns starting at first_non_identity_column_ are listed.
+  mutable bool level_schedule_is_valid_ = false;
+  mutable bool level_schedule_is_for_lower_ = false;
+  mutable std::vector<int> level_starts_;
+  mutable std::vector<ColIndex> level_cols_;
+  mutable StrictITIVector<ColIndex, int> col_levels_;
+
+  // Direct-mapped cache for ComputeRowsToConsiderInSortedOrder(). An entry
+  // with an empty input is unused (an empty input is never looked up).
+  struct ReachCacheEntry {
+    RowIndexVector input;
+    RowIndexVector output;
+  };
+  bool use_reach_cache_ = false;
+  mutable bool reach_cache_is_valid_ = false;
+  mutable std::vector<ReachCacheEntry> reach_cache_;
 };
 
 }  // namespace glop
@@ -0,0 +1,207 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/lp_data/sparse.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "absl/random/distributions.h"
+#include "gtest/gtest.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/lp_data/sharded_executor.h"
+
+namespace operations_research {
+namespace glop {
+namespace {
+
+constexpr int kNumBlocks = 4;
+constexpr int kBlockSize = 10000;
+constexpr int kSize = kNumBlocks * kBlockSize;
+
+// Returns a triangular matrix whose off-diagonal entries of the columns of a
+// block are in the rows of the next block for a lower triangular matrix, or of
+// the previous block for an upper triangular one. So a transpose solve has
+// kNumBlocks levels of kBlockSize columns, which are wide enough for the level
+// schedule to be used.
+void BuildBlockTriangularMatrix(bool lower, bool unit_diagonal,
+                                std::mt19937* random, SparseMatrix* matrix) {
+  matrix->PopulateFromZero(RowIndex(kSize), ColIndex(kSize));
+  for (ColIndex col(0); col < kSize; ++col) {
+    SparseColumn* column = matrix->mutable_column(col);
+    const int block = col.value() / kBlockSize;
+    const int other_block = lower ? block + 1 : block - 1;
+    const Fractional diagonal =
+        unit_diagonal ? 1.0 : absl::Uniform(*random, 1.0, 2.0);
+    if (other_block < 0 || other_block >= kNumBlocks) {
+      column->SetCoefficient(ColToRowIndex(col), diagonal);
+      continue;
+    }
+    std::vector<RowIndex> rows = {ColToRowIndex(col)};
+    for (int i = 0; i < 3; ++i) {
+      rows.push_back(RowIndex(other_block * kBlockSize +
+                              absl::Uniform<int>(*random, 0, kBlockSize)));
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    for (const RowIndex row : rows) {
+      column->SetCoefficient(row, row == ColToRowIndex(col)
+                                      ? diagonal
+                                      : absl::Uniform(*random, -0.5, 0.5));
+    }
+  }
+}
+
+DenseColumn RandomDenseColumn(std::mt19937* random) {
+  DenseColumn result(RowIndex(kSize), 0.0);
+  for (RowIndex row(0); row < kSize; ++row) {
+    result[row] = absl::Uniform(*random, -1.0, 1.0);
+  }
+  return result;
+}
+
+struct TransposeSolveTestCase {
+  bool lower;
+  bool unit_diagonal;
+};
+
+class ParallelTransposeSolveTest
+    : public testing::TestWithParam<TransposeSolveTestCase> {};
+
+// The columns of a level are computed in parallel, but from the same values in
+// the same order, so the result is bit for bit the one of the sequential solve.
+TEST_P(ParallelTransposeSolveTest, MatchesTheSequentialSolve) {
+  const TransposeSolveTestCase& test_case = GetParam();
+  std::mt19937 random(12345);
+  SparseMatrix sparse_matrix;
+  BuildBlockTriangularMatrix(test_case.lower, test_case.unit_diagonal, &random,
+                             &sparse_matrix);
+  TriangularMatrix matrix;
+  matrix.PopulateFromTriangularSparseMatrix(sparse_matrix);
+  ShardedExecutor executor;
+  executor.SetNumThreads(4);
+
+  for (int i = 0; i < 3; ++i) {
+    DenseColumn expected = RandomDenseColumn(&random);
+    DenseColumn parallel = expected;
+    DenseColumn single_thread = expected;
+    ShardedExecutor single_thread_executor;
+    if (test_case.lower) {
+      matrix.TransposeLowerSolve(&expected);
+      matrix.ParallelTransposeLowerSolve(&executor, &parallel);
+      matrix.ParallelTransposeLowerSolve(&single_thread_executor,
+                                         &single_thread);
+    } else {
+      matrix.TransposeUpperSolve(&expected);
+      matrix.ParallelTransposeUpperSolve(&executor, &parallel);
+      matrix.ParallelTransposeUpperSolve(&single_thread_executor,
+                                         &single_thread);
+    }
+    EXPECT_EQ(parallel, expected);
+    EXPECT_EQ(single_thread, expected);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllTriangles, ParallelTransposeSolveTest,
+    testing::Values(TransposeSolveTestCase{/*lower=*/true,
+                                           /*unit_diagonal=*/true},
+                    TransposeSolveTestCase{/*lower=*/true,
+                                           /*unit_diagonal=*/false},
+                    TransposeSolveTestCase{/*lower=*/false,
+                                           /*unit_diagonal=*/true},
+                    TransposeSolveTestCase{/*lower=*/false,
+                                           /*unit_diagonal=*/false}));
+
+// Returns num_rows distinct random rows of the first block, whose reach in a
+// lower triangular matrix spans all the blocks.
+RowIndexVector RandomNonZeroRows(int num_rows, std::mt19937* random) {
+  RowIndexVector result;
+  while (result.size() < num_rows) {
+    const RowIndex row(absl::Uniform<int>(*random, 0, kBlockSize));
+    if (std::find(result.begin(), result.end(), row) == result.end()) {
+      result.push_back(row);
+    }
+  }
+  return result;
+}
+
+// The same sparsity patterns are looked up several times so that most calls
+// hit the cache, and the results must be the ones computed without it.
+TEST(TriangularMatrixTest, ReachCacheMatchesUncachedReach) {
+  std::mt19937 random(12345);
+  SparseMatrix sparse_matrix;
+  BuildBlockTriangularMatrix(/*lower=*/true, /*unit_diagonal=*/true, &random,
+                             &sparse_matrix);
+  TriangularMatrix matrix;
+  matrix.PopulateFromTriangularSparseMatrix(sparse_matrix);
+  matrix.EnableReachCache(true);
+  TriangularMatrix uncached_matrix;
+  uncached_matrix.PopulateFromTriangularSparseMatrix(sparse_matrix);
+
+  std::vector<RowIndexVector> patterns;
+  for (int i = 0; i < 20; ++i) {
+    patterns.push_back(RandomNonZeroRows(1 + i % 3, &random));
+  }
+  // Too dense for the hyper-sparse solve, which must also be cached.
+  patterns.push_back(RandomNonZeroRows(kSize / 20, &random));
+  for (int i = 0; i < 200; ++i) {
+    const RowIndexVector& pattern =
+        patterns[absl::Uniform<int>(random, 0, patterns.size())];
+    RowIndexVector reach = pattern;
+    matrix.ComputeRowsToConsiderInSortedOrder(&reach);
+    RowIndexVector expected = pattern;
+    uncached_matrix.ComputeRowsToConsiderInSortedOrder(&expected);
+    ASSERT_EQ(reach, expected) << i;
+  }
+}
+
+// Both the reach cache and the level schedule depend on the structure of the
+// matrix, and must not survive a new factorization.
+TEST(TriangularMatrixTest, SolveCachesAreInvalidatedWhenTheMatrixChanges) {
+  std::mt19937 random(12345);
+  TriangularMatrix matrix;
+  matrix.EnableReachCache(true);
+  ShardedExecutor executor;
+  executor.SetNumThreads(4);
+  const std::vector<RowIndexVector> patterns = {
+      RandomNonZeroRows(1, &random), RandomNonZeroRows(2, &random)};
+  const DenseColumn rhs = RandomDenseColumn(&random);
+  for (int factorization = 0; factorization < 3; ++factorization) {
+    SparseMatrix sparse_matrix;
+    BuildBlockTriangularMatrix(/*lower=*/true, /*unit_diagonal=*/false,
+                               &random, &sparse_matrix);
+    matrix.PopulateFromTriangularSparseMatrix(sparse_matrix);
+    TriangularMatrix expected_matrix;
+    expected_matrix.PopulateFromTriangularSparseMatrix(sparse_matrix);
+
+    for (const RowIndexVector& pattern : patterns) {
+      RowIndexVector reach = pattern;
+      matrix.ComputeRowsToConsiderInSortedOrder(&reach);
+      RowIndexVector expected = pattern;
+      expected_matrix.ComputeRowsToConsiderInSortedOrder(&expected);
+      EXPECT_EQ(reach, expected) << factorization;
+    }
+
+    DenseColumn parallel = rhs;
+    matrix.ParallelTransposeLowerSolve(&executor, &parallel);
+    DenseColumn expected = rhs;
+    expected_matrix.TransposeLowerSolve(&expected);
+    EXPECT_EQ(parallel, expected) << factorization;
+  }
+}
+
+}  // namespace
+}  // namespace glop
+}  // namespace operations_research
@@ -0,0 +1,529 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/pdlp/batched_primal_dual_hybrid_gradient.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/SparseCore"
+#include "absl/log/check.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "ortools/base/status_macros.h"
+#include "ortools/base/timer.h"
+#include "ortools/pdlp/iteration_stats.h"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/pdlp/sharded_optimization_utils.h"
+#include "ortools/pdlp/sharded_quadratic_program.h"
+#include "ortools/pdlp/sharder.h"
+#include "ortools/pdlp/solve_log.pb.h"
+#include "ortools/pdlp/solvers.pb.h"
+#include "ortools/pdlp/solvers_proto_validation.h"
+#include "ortools/pdlp/termination.h"
+
+namespace operations_research::pdlp {
+
+namespace {
+
+using ::Eigen::VectorXd;
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+absl::Status CheckSupportedParams(
+    const PrimalDualHybridGradientParams& params) {
+  RETURN_IF_ERROR(ValidatePrimalDualHybridGradientParams(params));
+  if (params.linesearch_rule() !=
+      PrimalDualHybridGradientParams::CONSTANT_STEP_SIZE_RULE) {
+    return absl::InvalidArgumentError(
+        "BatchedLpSolver only supports the constant step size rule");
+  }
+  if (params.restart_strategy() !=
+          PrimalDualHybridGradientParams::NO_RESTARTS &&
+      params.restart_strategy() !=
+          PrimalDualHybridGradientParams::EVERY_MAJOR_ITERATION) {
+    return absl::InvalidArgumentError(
+        "BatchedLpSolver only supports the NO_RESTARTS and "
+        "EVERY_MAJOR_ITERATION restart strategies");
+  }
+  if (params.presolve_options().use_glop() ||
+      params.presolve_options().use_native_presolve()) {
+    return absl::InvalidArgumentError(
+        "BatchedLpSolver doesn't support presolve");
+  }
+  if (params.use_feasibility_polishing()) {
+    return absl::InvalidArgumentError(
+        "BatchedLpSolver doesn't support feasibility polishing");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CheckBatchSizes(const LpBatch& batch, const int64_t num_variables,
+                             const int64_t num_constraints) {
+  const int64_t batch_size = batch.objective_vectors.cols();
+  auto has_shape = [batch_size](const Eigen::MatrixXd& matrix,
+                                const int64_t rows) {
+    return matrix.rows() == rows && matrix.cols() == batch_size;
+  };
+  if (!has_shape(batch.objective_vectors, num_variables) ||
+      !has_shape(batch.variable_lower_bounds, num_variables) ||
+      !has_shape(batch.variable_upper_bounds, num_variables) ||
+      !has_shape(batch.constraint_lower_bounds, num_constraints) ||
+      !has_shape(batch.constraint_upper_bounds, num_constraints)) {
+    return absl::InvalidArgumentError(
+        "the objective and bounds of the LpBatch must have one row per "
+        "variable or constraint and one column per instance");
+  }
+  if (batch.objective_offsets.size() != 0 &&
+      batch.objective_offsets.size() != batch_size) {
+    return absl::InvalidArgumentError(
+        "objective_offsets must be empty or have one entry per instance");
+  }
+  const bool has_initial_primal = batch.initial_primal_solutions.size() > 0;
+  const bool has_initial_dual = batch.initial_dual_solutions.size() > 0;
+  if (has_initial_primal != has_initial_dual ||
+      (has_initial_primal &&
+       (!has_shape(batch.initial_primal_solutions, num_variables) ||
+        !has_shape(batch.initial_dual_solutions, num_constraints)))) {
+    return absl::InvalidArgumentError(
+        "initial_primal_solutions and initial_dual_solutions must both be "
+        "empty or have one column per instance");
+  }
+  return absl::OkStatus();
+}
+
+int NumThreads(const PrimalDualHybridGradientParams& params) {
+  return std::max(1, params.num_threads());
+}
+
+int NumShards(const PrimalDualHybridGradientParams& params) {
+  if (params.num_shards() > 0) return params.num_shards();
+  return NumThreads(params) == 1 ? 1 : 4 * NumThreads(params);
+}
+
+// The L2 and infinity norms of the largest absolute finite bound of each
+// constraint, as in the `combined_bounds_*` problem statistics.
+struct CombinedBoundNorms {
+  double l2_norm = 0.0;
+  double l_inf_norm = 0.0;
+};
+
+CombinedBoundNorms CombinedBoundsNorms(const VectorXd& lower_bounds,
+                                       const VectorXd& upper_bounds) {
+  double squared_norm = 0.0;
+  double max_bound = 0.0;
+  for (int64_t i = 0; i < lower_bounds.size(); ++i) {
+    double bound = 0.0;
+    if (std::isfinite(lower_bounds[i])) bound = std::abs(lower_bounds[i]);
+    if (std::isfinite(upper_bounds[i])) {
+      bound = std::max(bound, std::abs(upper_bounds[i]));
+    }
+    squared_norm += bound * bound;
+    max_bound = std::max(max_bound, bound);
+  }
+  return {.l2_norm = std::sqrt(squared_norm), .l_inf_norm = max_bound};
+}
+
+// Returns a copy of `matrix` with only the columns `columns`, in that order.
+RowMajorMatrixXd SelectedColumns(const RowMajorMatrixXd& matrix,
+                                 const std::vector<int>& columns) {
+  RowMajorMatrixXd result(matrix.rows(), columns.size());
+  for (int i = 0; i < columns.size(); ++i) {
+    result.col(i) = matrix.col(columns[i]);
+  }
+  return result;
+}
+
+// The instances of a batch that haven't terminated, in the rescaled space.
+// Column `i` of each matrix belongs to the instance `instances[i]` of the
+// batch.
+struct ActiveInstances {
+  // Keeps the columns `columns`, in that order.
+  void SelectColumns(const std::vector<int>& columns) {
+    std::vector<int> selected_instances;
+    VectorXd selected_primal_weights(columns.size());
+    std::vector<QuadraticProgramBoundNorms> selected_bound_norms;
+    for (int i = 0; i < columns.size(); ++i) {
+      selected_instances.push_back(instances[columns[i]]);
+      selected_primal_weights[i] = primal_weights[columns[i]];
+      selected_bound_norms.push_back(bound_norms[columns[i]]);
+    }
+    instances = std::move(selected_instances);
+    primal_weights = std::move(selected_primal_weights);
+    bound_norms = std::move(selected_bound_norms);
+    for (RowMajorMatrixXd* matrix :
+         {&objectives, &variable_lower_bounds, &variable_upper_bounds,
+          &constraint_lower_bounds, &constraint_upper_bounds, &primal, &dual,
+          &dual_product, &primal_sum, &dual_sum, &primal_start, &dual_start}) {
+      *matrix = SelectedColumns(*matrix, columns);
+    }
+  }
+
+  int Size() const { return static_cast<int>(instances.size()); }
+
+  std::vector<int> instances;
+  VectorXd primal_weights;
+  // The bound norms of the original instances.
+  std::vector<QuadraticProgramBoundNorms> bound_norms;
+  RowMajorMatrixXd objectives;
+  RowMajorMatrixXd variable_lower_bounds;
+  RowMajorMatrixXd variable_upper_bounds;
+  RowMajorMatrixXd constraint_lower_bounds;
+  RowMajorMatrixXd constraint_upper_bounds;
+  // The current iterates, and the constraint matrix transpose times `dual`.
+  RowMajorMatrixXd primal;
+  RowMajorMatrixXd dual;
+  RowMajorMatrixXd dual_product;
+  // The sums of the iterates since the last restart, whose averages are the
+  // restart candidates, and the iterates at the last restart.
+  RowMajorMatrixXd primal_sum;
+  RowMajorMatrixXd dual_sum;
+  RowMajorMatrixXd primal_start;
+  RowMajorMatrixXd dual_start;
+  int num_sum_terms = 0;
+};
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<BatchedLpSolver>> BatchedLpSolver::Create(
+    Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> constraint_matrix,
+    const PrimalDualHybridGradientParams& params) {
+  RETURN_IF_ERROR(CheckSupportedParams(params));
+  QuadraticProgram qp(constraint_matrix.cols(), constraint_matrix.rows());
+  qp.constraint_matrix.swap(constraint_matrix);
+  qp.constraint_matrix.makeCompressed();
+  return absl::WrapUnique(new BatchedLpSolver(
+      params,
+      ShardedQuadraticProgram(std::move(qp), NumThreads(params),
+                              NumShards(params),
+                              params.pin_threads_to_cpus())));
+}
+
+BatchedLpSolver::BatchedLpSolver(const PrimalDualHybridGradientParams& params,
+                                 ShardedQuadraticProgram sharded_qp)
+    : params_(params), sharded_qp_(std::move(sharded_qp)) {
+  // The rescaling only depends on the constraint matrix, so it is the one
+  // `PrimalDualHybridGradient()` would compute for each instance.
+  ScalingVectors scaling = ApplyRescaling(
+      RescalingOptions{.l_inf_ruiz_iterations = params_.l_inf_ruiz_iterations(),
+                       .l2_norm_rescaling = params_.l2_norm_rescaling()},
+      sharded_qp_);
+  row_scaling_vec_ = std::move(scaling.row_scaling_vec);
+  col_scaling_vec_ = std::move(scaling.col_scaling_vec);
+  // The same as for the `CONSTANT_STEP_SIZE_RULE` in
+  // `PreprocessSolver::PreprocessSolver()`.
+  std::mt19937 random(1);
+  const SingularValueAndIterations lipschitz_result =
+      EstimateMaximumSingularValueOfConstraintMatrix(
+          sharded_qp_, std::nullopt, std::nullopt,
+          /*desired_relative_error=*/0.2, /*failure_probability=*/0.0005,
+          random);
+  const double lipschitz_term_upper_bound =
+      lipschitz_result.singular_value /
+      (1.0 - lipschitz_result.estimated_relative_error);
+  step_size_ = lipschitz_term_upper_bound > 0.0
+                   ? 1.0 / lipschitz_term_upper_bound
+                   : 1.0;
+}
+
+absl::StatusOr<BatchedSolverResult> BatchedLpSolver::Solve(
+    const LpBatch& batch) {
+  WallTimer timer;
+  timer.Start();
+  const int64_t num_variables = NumVariables();
+  const int64_t num_constraints = NumConstraints();
+  RETURN_IF_ERROR(CheckBatchSizes(batch, num_variables, num_constraints));
+  const int batch_size = static_cast<int>(batch.objective_vectors.cols());
+  const bool has_initial_solutions = batch.initial_primal_solutions.size() > 0;
+
+  BatchedSolverResult result;
+  result.primal_solutions = Eigen::MatrixXd::Zero(num_variables, batch_size);
+  result.dual_solutions = Eigen::MatrixXd::Zero(num_constraints, batch_size);
+  result.termination_reasons.assign(batch_size,
+                                    TERMINATION_REASON_UNSPECIFIED);
+  result.iteration_counts.assign(batch_size, 0);
+  result.convergence_information.resize(batch_size);
+
+  ActiveInstances active;
+  for (int instance = 0; instance < batch_size; ++instance) {
+    if ((batch.variable_lower_bounds.col(instance).array() >
+         batch.variable_upper_bounds.col(instance).array())
+            .any() ||
+        (batch.constraint_lower_bounds.col(instance).array() >
+         batch.constraint_upper_bounds.col(instance).array())
+            .any()) {
+      result.termination_reasons[instance] = TERMINATION_REASON_INVALID_PROBLEM;
+    } else {
+      active.instances.push_back(instance);
+    }
+  }
+  const int num_active = active.Size();
+  active.objectives.resize(num_variables, num_active);
+  active.variable_lower_bounds.resize(num_variables, num_active);
+  active.variable_upper_bounds.resize(num_variables, num_active);
+  active.constraint_lower_bounds.resize(num_constraints, num_active);
+  active.constraint_upper_bounds.resize(num_constraints, num_active);
+  active.primal.setZero(num_variables, num_active);
+  active.dual.setZero(num_constraints, num_active);
+  active.primal_weights.resize(num_active);
+  for (int i = 0; i < num_active; ++i) {
+    const int instance = active.instances[i];
+    active.objectives.col(i) =
+        batch.objective_vectors.col(instance).cwiseProduct(col_scaling_vec_);
+    active.variable_lower_bounds.col(i) =
+        batch.variable_lower_bounds.col(instance).cwiseQuotient(
+            col_scaling_vec_);
+    active.variable_upper_bounds.col(i) =
+        batch.variable_upper_bounds.col(instance).cwiseQuotient(
+            col_scaling_vec_);
+    active.constraint_lower_bounds.col(i) =
+        batch.constraint_lower_bounds.col(instance).cwiseProduct(
+            row_scaling_vec_);
+    active.constraint_upper_bounds.col(i) =
+        batch.constraint_upper_bounds.col(instance).cwiseProduct(
+            row_scaling_vec_);
+    const CombinedBoundNorms original_bound_norms =
+        CombinedBoundsNorms(batch.constraint_lower_bounds.col(instance),
+                            batch.constraint_upper_bounds.col(instance));
+    active.bound_norms.push_back(
+        {.l2_norm_primal_linear_objective =
+             batch.objective_vectors.col(instance).norm(),
+         .l2_norm_constraint_bounds = original_bound_norms.l2_norm,
+         .l_inf_norm_primal_linear_objective =
+             batch.objective_vectors.col(instance).lpNorm<Eigen::Infinity>(),
+         .l_inf_norm_constraint_bounds = original_bound_norms.l_inf_norm});
+    // See `PreprocessSolver::InitialPrimalWeight()`.
+    const double scaled_objective_norm = active.objectives.col(i).norm();
+    const double scaled_bounds_norm =
+        CombinedBoundsNorms(active.constraint_lower_bounds.col(i),
+                            active.constraint_upper_bounds.col(i))
+            .l2_norm;
+    if (params_.has_initial_primal_weight()) {
+      active.primal_weights[i] = params_.initial_primal_weight();
+    } else if (scaled_objective_norm > 0.0 && scaled_bounds_norm > 0.0) {
+      active.primal_weights[i] = scaled_objective_norm / scaled_bounds_norm;
+    } else {
+      active.primal_weights[i] = 1.0;
+    }
+    if (has_initial_solutions) {
+      active.primal.col(i) =
+          batch.initial_primal_solutions.col(instance).cwiseQuotient(
+              col_scaling_vec_);
+      active.dual.col(i) =
+          batch.initial_dual_solutions.col(instance).cwiseQuotient(
+              row_scaling_vec_);
+    }
+  }
+  // The same projections as `ProjectToPrimalVariableBounds()` and
+  // `ProjectToDualVariableBounds()`.
+  active.primal = active.primal.cwiseMin(active.variable_upper_bounds)
+                      .cwiseMax(active.variable_lower_bounds);
+  for (int64_t row = 0; row < num_constraints; ++row) {
+    for (int i = 0; i < num_active; ++i) {
+      double& dual = active.dual(row, i);
+      if (active.constraint_lower_bounds(row, i) == -kInfinity) {
+        dual = std::min(dual, 0.0);
+      }
+      if (active.constraint_upper_bounds(row, i) == kInfinity) {
+        dual = std::max(dual, 0.0);
+      }
+    }
+  }
+  const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>&
+      constraint_matrix = sharded_qp_.Qp().constraint_matrix;
+  const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>&
+      transposed_constraint_matrix = sharded_qp_.TransposedConstraintMatrix();
+  active.dual_product = TransposedMatrixMatrixProduct(
+      constraint_matrix, active.dual, sharded_qp_.ConstraintMatrixSharder());
+  active.primal_sum.setZero(num_variables, num_active);
+  active.dual_sum.setZero(num_constraints, num_active);
+  active.primal_start = active.primal;
+  active.dual_start = active.dual;
+
+  const TerminationCriteria& criteria = params_.termination_criteria();
+  const TerminationCriteria::DetailedOptimalityCriteria optimality_criteria =
+      EffectiveOptimalityCriteria(criteria);
+  const double primal_epsilon_ratio =
+      EpsilonRatio(optimality_criteria.eps_optimal_primal_residual_absolute(),
+                   optimality_criteria.eps_optimal_primal_residual_relative());
+  const double dual_epsilon_ratio =
+      EpsilonRatio(optimality_criteria.eps_optimal_dual_residual_absolute(),
+                   optimality_criteria.eps_optimal_dual_residual_relative());
+  // Computes the convergence information of column `i` of `active` by swapping
+  // its vectors into `sharded_qp_`.
+  auto convergence_information = [&](const int i) {
+    VectorXd objective = active.objectives.col(i);
+    VectorXd variable_lower_bounds = active.variable_lower_bounds.col(i);
+    VectorXd variable_upper_bounds = active.variable_upper_bounds.col(i);
+    VectorXd constraint_lower_bounds = active.constraint_lower_bounds.col(i);
+    VectorXd constraint_upper_bounds = active.constraint_upper_bounds.col(i);
+    auto swap_vectors = [&] {
+      sharded_qp_.SwapObjectiveVector(objective);
+      sharded_qp_.SwapVariableBounds(variable_lower_bounds,
+                                     variable_upper_bounds);
+      sharded_qp_.SwapConstraintBounds(constraint_lower_bounds,
+                                       constraint_upper_bounds);
+    };
+    swap_vectors();
+    ConvergenceInformation info = ComputeConvergenceInformation(
+        params_, sharded_qp_, col_scaling_vec_, row_scaling_vec_,
+        active.primal.col(i), active.dual.col(i), primal_epsilon_ratio,
+        dual_epsilon_ratio, POINT_TYPE_CURRENT_ITERATE);
+    swap_vectors();
+    if (batch.objective_offsets.size() > 0) {
+      const double offset = batch.objective_offsets[active.instances[i]];
+      info.set_primal_objective(info.primal_objective() + offset);
+      info.set_dual_objective(info.dual_objective() + offset);
+    }
+    return info;
+  };
+
+  const Sharder& primal_sharder = sharded_qp_.PrimalSharder();
+  const Sharder& dual_sharder = sharded_qp_.DualSharder();
+  int iterations_completed = 0;
+  while (active.Size() > 0) {
+    const bool iteration_limit_reached =
+        iterations_completed >= criteria.iteration_limit();
+    if (iterations_completed % params_.termination_check_frequency() == 0 ||
+        iteration_limit_reached) {
+      const bool time_limit_reached =
+          timer.Get() >= criteria.time_sec_limit();
+      std::vector<int> remaining_columns;
+      for (int i = 0; i < active.Size(); ++i) {
+        const int instance = active.instances[i];
+        ConvergenceInformation info = convergence_information(i);
+        TerminationReason reason = TERMINATION_REASON_UNSPECIFIED;
+        if (OptimalityCriteriaMet(optimality_criteria, info,
+                                  criteria.optimality_norm(),
+                                  active.bound_norms[i])) {
+          reason = TERMINATION_REASON_OPTIMAL;
+        } else if (!std::isfinite(info.l2_primal_residual()) ||
+                   !std::isfinite(info.l2_dual_residual())) {
+          reason = TERMINATION_REASON_NUMERICAL_ERROR;
+        } else if (iteration_limit_reached) {
+          reason = TERMINATION_REASON_ITERATION_LIMIT;
+        } else if (time_limit_reached) {
+          reason = TERMINATION_REASON_TIME_LIMIT;
+        }
+        result.convergence_information[instance] = std::move(info);
+        if (reason == TERMINATION_REASON_UNSPECIFIED) {
+          remaining_columns.push_back(i);
+          continue;
+        }
+        result.termination_reasons[instance] = reason;
+        result.iteration_counts[instance] = iterations_completed;
+        result.primal_solutions.col(instance) =
+            active.primal.col(i).cwiseProduct(col_scaling_vec_);
+        result.dual_solutions.col(instance) =
+            active.dual.col(i).cwiseProduct(row_scaling_vec_);
+      }
+      if (static_cast<int>(remaining_columns.size()) < active.Size()) {
+        active.SelectColumns(remaining_columns);
+      }
+      if (active.Size() == 0) break;
+    }
+
+    if (iterations_completed > 0 &&
+        iterations_completed % params_.major_iteration_frequency() == 0) {
+      // See `Solver::ApplyRestartChoice()`.
+      if (params_.restart_strategy() ==
+          PrimalDualHybridGradientParams::EVERY_MAJOR_ITERATION) {
+        active.primal = active.primal_sum / active.num_sum_terms;
+        active.dual = active.dual_sum / active.num_sum_terms;
+        active.dual_product = TransposedMatrixMatrixProduct(
+            constraint_matrix, active.dual,
+            sharded_qp_.ConstraintMatrixSharder());
+      }
+      // See `Solver::ComputeNewPrimalWeight()`.
+      constexpr double kNonzeroTol = 1.0e-10;
+      const double smoothing_param = params_.primal_weight_update_smoothing();
+      for (int i = 0; i < active.Size(); ++i) {
+        const double primal_distance =
+            (active.primal.col(i) - active.primal_start.col(i)).norm();
+        const double dual_distance =
+            (active.dual.col(i) - active.dual_start.col(i)).norm();
+        if (primal_distance <= kNonzeroTol ||
+            primal_distance >= 1.0 / kNonzeroTol ||
+            dual_distance <= kNonzeroTol ||
+            dual_distance >= 1.0 / kNonzeroTol) {
+          continue;
+        }
+        active.primal_weights[i] = std::exp(
+            smoothing_param * std::log(dual_distance / primal_distance) +
+            (1.0 - smoothing_param) * std::log(active.primal_weights[i]));
+      }
+      active.primal_start = active.primal;
+      active.dual_start = active.dual;
+      active.primal_sum.setZero();
+      active.dual_sum.setZero();
+      active.num_sum_terms = 0;
+    }
+
+    // One step of PDHG for all the instances, like
+    // `Solver::TakeConstantSizeStep()`.
+    const VectorXd primal_step_sizes =
+        step_size_ * active.primal_weights.cwiseInverse();
+    const VectorXd dual_step_sizes = step_size_ * active.primal_weights;
+    RowMajorMatrixXd extrapolated_primal(num_variables, active.Size());
+    primal_sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+      const int64_t start = primal_sharder.ShardStart(shard.Index());
+      const int64_t size = primal_sharder.ShardSize(shard.Index());
+      auto primal = active.primal.middleRows(start, size);
+      const RowMajorMatrixXd next_primal =
+          (primal - (active.objectives.middleRows(start, size) -
+                     active.dual_product.middleRows(start, size)) *
+                        primal_step_sizes.asDiagonal())
+              .cwiseMin(active.variable_upper_bounds.middleRows(start, size))
+              .cwiseMax(active.variable_lower_bounds.middleRows(start, size));
+      extrapolated_primal.middleRows(start, size) = 2 * next_primal - primal;
+      primal = next_primal;
+      active.primal_sum.middleRows(start, size) += next_primal;
+    });
+    const RowMajorMatrixXd activities = TransposedMatrixMatrixProduct(
+        transposed_constraint_matrix, extrapolated_primal,
+        sharded_qp_.TransposedConstraintMatrixSharder());
+    dual_sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+      const int64_t start = dual_sharder.ShardStart(shard.Index());
+      const int64_t size = dual_sharder.ShardSize(shard.Index());
+      auto dual = active.dual.middleRows(start, size);
+      // See `Solver::ComputeNextDualSolution()`.
+      const RowMajorMatrixXd temp =
+          dual - activities.middleRows(start, size) *
+                     dual_step_sizes.asDiagonal();
+      dual = (temp + active.constraint_upper_bounds.middleRows(start, size) *
+                         dual_step_sizes.asDiagonal())
+                 .cwiseMin(0.0)
+                 .cwiseMax(temp +
+                           active.constraint_lower_bounds.middleRows(start,
+                                                                     size) *
+                               dual_step_sizes.asDiagonal());
+      active.dual_sum.middleRows(start, size) += dual;
+    });
+    active.dual_product = TransposedMatrixMatrixProduct(
+        constraint_matrix, active.dual, sharded_qp_.ConstraintMatrixSharder());
+    ++active.num_sum_terms;
+    ++iterations_completed;
+  }
+  return result;
+}
+
+}  // namespace operations_research::pdlp
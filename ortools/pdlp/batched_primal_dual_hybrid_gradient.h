@@ -0,0 +1,117 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PDLP_BATCHED_PRIMAL_DUAL_HYBRID_GRADIENT_H_
+#define PDLP_BATCHED_PRIMAL_DUAL_HYBRID_GRADIENT_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/SparseCore"
+#include "absl/status/statusor.h"
+#include "ortools/pdlp/sharded_quadratic_program.h"
+#include "ortools/pdlp/solve_log.pb.h"
+#include "ortools/pdlp/solvers.pb.h"
+
+namespace operations_research::pdlp {
+
+// A batch of minimization LPs that share the constraint matrix of a
+// `BatchedLpSolver`. Each matrix has one column per instance, and the rows of
+// the variable (constraint) matrices correspond to the columns (rows) of the
+// constraint matrix. To maximize, negate the objective.
+struct LpBatch {
+  Eigen::MatrixXd objective_vectors;
+  Eigen::MatrixXd variable_lower_bounds;
+  Eigen::MatrixXd variable_upper_bounds;
+  Eigen::MatrixXd constraint_lower_bounds;
+  Eigen::MatrixXd constraint_upper_bounds;
+  // Either empty, for zero offsets, or one entry per instance.
+  Eigen::VectorXd objective_offsets;
+
+  // Either both empty, to start from zero, or one column per instance. For
+  // instances that are perturbations of each other, like the scenarios of a
+  // planning sweep, the solutions of a neighboring scenario (for example from
+  // the `BatchedSolverResult` of a previous batch) are good starting points.
+  Eigen::MatrixXd initial_primal_solutions;
+  Eigen::MatrixXd initial_dual_solutions;
+};
+
+struct BatchedSolverResult {
+  // One column per instance, with the last iterate of that instance.
+  Eigen::MatrixXd primal_solutions;
+  Eigen::MatrixXd dual_solutions;
+  // One entry per instance.
+  std::vector<TerminationReason> termination_reasons;
+  std::vector<int> iteration_counts;
+  // The convergence information of the last iterate of each instance, at the
+  // last termination check.
+  std::vector<ConvergenceInformation> convergence_information;
+};
+
+// Solves batches of LPs that share a constraint matrix with PDHG. The rescaling
+// of the matrix and the estimate of its largest singular value are computed
+// once, when the solver is created, and shared by all the instances of all the
+// batches. The instances of a batch advance together: each iteration takes two
+// products of the constraint matrix with a dense block holding one iterate per
+// instance, which reads the matrix once for the whole batch. An instance
+// leaves the batch as soon as it terminates.
+//
+// Since the step size comes from the shared singular value estimate, only the
+// `CONSTANT_STEP_SIZE_RULE` linesearch rule is supported, and the
+// `NO_RESTARTS` and `EVERY_MAJOR_ITERATION` restart strategies. The primal
+// weight of each instance is updated at every major iteration, as in
+// `PrimalDualHybridGradient()`. Presolve and feasibility polishing are not
+// supported, `use_float_transposed_constraint_matrix` is ignored, and the
+// termination criteria are checked on the current iterate only. Infeasibility
+// is not detected.
+class BatchedLpSolver {
+ public:
+  // Returns an `InvalidArgumentError` if `params` are invalid or unsupported.
+  static absl::StatusOr<std::unique_ptr<BatchedLpSolver>> Create(
+      Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> constraint_matrix,
+      const PrimalDualHybridGradientParams& params);
+
+  BatchedLpSolver(const BatchedLpSolver&) = delete;
+  BatchedLpSolver& operator=(const BatchedLpSolver&) = delete;
+
+  int64_t NumVariables() const { return sharded_qp_.PrimalSize(); }
+  int64_t NumConstraints() const { return sharded_qp_.DualSize(); }
+
+  // The step size shared by all the instances, that is the inverse of an upper
+  // bound on the largest singular value of the rescaled constraint matrix.
+  double StepSize() const { return step_size_; }
+
+  // Solves the instances of `batch`. Returns an `InvalidArgumentError` if the
+  // sizes in `batch` are inconsistent. Instances with inconsistent bounds
+  // terminate with `TERMINATION_REASON_INVALID_PROBLEM`. Not thread-safe: the
+  // instances are swapped in and out of the internal `ShardedQuadraticProgram`
+  // to check the termination criteria.
+  absl::StatusOr<BatchedSolverResult> Solve(const LpBatch& batch);
+
+ private:
+  BatchedLpSolver(const PrimalDualHybridGradientParams& params,
+                  ShardedQuadraticProgram sharded_qp);
+
+  const PrimalDualHybridGradientParams params_;
+  // The rescaled constraint matrix and its transpose.
+  ShardedQuadraticProgram sharded_qp_;
+  Eigen::VectorXd row_scaling_vec_;
+  Eigen::VectorXd col_scaling_vec_;
+  double step_size_ = 0.0;
+};
+
+}  // namespace operations_research::pdlp
+
+#endif  // PDLP_BATCHED_PRIMAL_DUAL_HYBRID_GRADIENT_H_
@@ -0,0 +1,238 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/pdlp/batched_primal_dual_hybrid_gradient.h"
+
+#include <memory>
+#include <utility>
+
+#include "Eigen/Core"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/pdlp/solve_log.pb.h"
+#include "ortools/pdlp/solvers.pb.h"
+#include "ortools/pdlp/test_util.h"
+
+namespace operations_research::pdlp {
+namespace {
+
+using ::Eigen::VectorXd;
+using ::testing::ElementsAre;
+
+PrimalDualHybridGradientParams TestParams() {
+  PrimalDualHybridGradientParams params;
+  params.mutable_termination_criteria()
+      ->mutable_simple_optimality_criteria()
+      ->set_eps_optimal_relative(0.0);
+  params.mutable_termination_criteria()
+      ->mutable_simple_optimality_criteria()
+      ->set_eps_optimal_absolute(1.0e-6);
+  params.mutable_termination_criteria()->set_iteration_limit(20000);
+  params.set_linesearch_rule(
+      PrimalDualHybridGradientParams::CONSTANT_STEP_SIZE_RULE);
+  params.set_restart_strategy(
+      PrimalDualHybridGradientParams::EVERY_MAJOR_ITERATION);
+  params.mutable_presolve_options()->set_use_glop(false);
+  return params;
+}
+
+// A batch with `batch_size` copies of `lp`.
+LpBatch RepeatedLp(const QuadraticProgram& lp, const int batch_size) {
+  return {
+      .objective_vectors = lp.objective_vector.replicate(1, batch_size),
+      .variable_lower_bounds =
+          lp.variable_lower_bounds.replicate(1, batch_size),
+      .variable_upper_bounds =
+          lp.variable_upper_bounds.replicate(1, batch_size),
+      .constraint_lower_bounds =
+          lp.constraint_lower_bounds.replicate(1, batch_size),
+      .constraint_upper_bounds =
+          lp.constraint_upper_bounds.replicate(1, batch_size),
+      .objective_offsets = VectorXd::Constant(batch_size, lp.objective_offset),
+  };
+}
+
+std::unique_ptr<BatchedLpSolver> CreateSolver(
+    const QuadraticProgram& lp, const PrimalDualHybridGradientParams& params) {
+  absl::StatusOr<std::unique_ptr<BatchedLpSolver>> solver =
+      BatchedLpSolver::Create(lp.constraint_matrix, params);
+  CHECK_OK(solver.status());
+  return *std::move(solver);
+}
+
+class BatchedLpSolverThreadsTest
+    : public testing::TestWithParam</*num_threads=*/int> {
+ protected:
+  PrimalDualHybridGradientParams Params() const {
+    PrimalDualHybridGradientParams params = TestParams();
+    params.set_num_threads(GetParam());
+    params.set_num_shards(2 * GetParam());
+    return params;
+  }
+};
+
+TEST_P(BatchedLpSolverThreadsTest, SolvesTestLp) {
+  const QuadraticProgram lp = TestLp();
+  std::unique_ptr<BatchedLpSolver> solver = CreateSolver(lp, Params());
+  EXPECT_EQ(solver->NumVariables(), 4);
+  EXPECT_EQ(solver->NumConstraints(), 4);
+  EXPECT_GT(solver->StepSize(), 0.0);
+  const absl::StatusOr<BatchedSolverResult> result =
+      solver->Solve(RepeatedLp(lp, 1));
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_THAT(result->termination_reasons,
+              ElementsAre(TERMINATION_REASON_OPTIMAL));
+  EXPECT_TRUE(result->primal_solutions.col(0).isApprox(
+      VectorXd{{-1, 8, 1, 2.5}}, 1.0e-4));
+  EXPECT_TRUE(result->dual_solutions.col(0).isApprox(
+      VectorXd{{-2, 0, 2.375, 2.0 / 3}}, 1.0e-4));
+  EXPECT_NEAR(result->convergence_information[0].primal_objective(), -34.0,
+              1.0e-4);
+}
+
+TEST_P(BatchedLpSolverThreadsTest, InstancesMatchSeparateSolves) {
+  const QuadraticProgram lp = TinyLp();
+  std::unique_ptr<BatchedLpSolver> solver = CreateSolver(lp, Params());
+  LpBatch batch = RepeatedLp(lp, 3);
+  batch.objective_vectors(1, 1) = 3.0;
+  batch.objective_vectors(0, 2) = 2.0;
+  batch.constraint_lower_bounds(1, 2) = 6.0;
+  const absl::StatusOr<BatchedSolverResult> batch_result =
+      solver->Solve(batch);
+  ASSERT_TRUE(batch_result.ok()) << batch_result.status();
+  for (int instance = 0; instance < 3; ++instance) {
+    SCOPED_TRACE(instance);
+    const LpBatch single = {
+        .objective_vectors = batch.objective_vectors.col(instance),
+        .variable_lower_bounds = batch.variable_lower_bounds.col(instance),
+        .variable_upper_bounds = batch.variable_upper_bounds.col(instance),
+        .constraint_lower_bounds = batch.constraint_lower_bounds.col(instance),
+        .constraint_upper_bounds = batch.constraint_upper_bounds.col(instance),
+    };
+    const absl::StatusOr<BatchedSolverResult> single_result =
+        solver->Solve(single);
+    ASSERT_TRUE(single_result.ok()) << single_result.status();
+    EXPECT_EQ(batch_result->termination_reasons[instance],
+              TERMINATION_REASON_OPTIMAL);
+    EXPECT_EQ(single_result->iteration_counts[0],
+              batch_result->iteration_counts[instance]);
+    EXPECT_TRUE(single_result->primal_solutions.col(0).isApprox(
+        batch_result->primal_solutions.col(instance), 1.0e-9));
+    EXPECT_TRUE(single_result->dual_solutions.col(0).isApprox(
+        batch_result->dual_solutions.col(instance), 1.0e-9));
+  }
+}
+
+TEST_P(BatchedLpSolverThreadsTest, WarmStartFromNeighboringScenario) {
+  const QuadraticProgram lp = TinyLp();
+  std::unique_ptr<BatchedLpSolver> solver = CreateSolver(lp, Params());
+  const absl::StatusOr<BatchedSolverResult> neighbor =
+      solver->Solve(RepeatedLp(lp, 1));
+  ASSERT_TRUE(neighbor.ok()) << neighbor.status();
+  LpBatch scenario = RepeatedLp(lp, 1);
+  scenario.constraint_lower_bounds(0, 0) = 12.1;
+  scenario.constraint_upper_bounds(0, 0) = 12.1;
+  const absl::StatusOr<BatchedSolverResult> cold = solver->Solve(scenario);
+  scenario.initial_primal_solutions = neighbor->primal_solutions;
+  scenario.initial_dual_solutions = neighbor->dual_solutions;
+  const absl::StatusOr<BatchedSolverResult> warm = solver->Solve(scenario);
+  ASSERT_TRUE(cold.ok()) << cold.status();
+  ASSERT_TRUE(warm.ok()) << warm.status();
+  EXPECT_THAT(cold->termination_reasons,
+              ElementsAre(TERMINATION_REASON_OPTIMAL));
+  EXPECT_THAT(warm->termination_reasons,
+              ElementsAre(TERMINATION_REASON_OPTIMAL));
+  EXPECT_LT(warm->iteration_counts[0], cold->iteration_counts[0]);
+}
+
+TEST_P(BatchedLpSolverThreadsTest, InvalidBoundsOnlyStopTheirInstance) {
+  const QuadraticProgram lp = TinyLp();
+  std::unique_ptr<BatchedLpSolver> solver = CreateSolver(lp, Params());
+  LpBatch batch = RepeatedLp(lp, 2);
+  batch.variable_lower_bounds(2, 0) = 7.0;
+  const absl::StatusOr<BatchedSolverResult> result = solver->Solve(batch);
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_THAT(result->termination_reasons,
+              ElementsAre(TERMINATION_REASON_INVALID_PROBLEM,
+                          TERMINATION_REASON_OPTIMAL));
+  EXPECT_TRUE(result->primal_solutions.col(1).isApprox(
+      VectorXd{{1, 0, 6, 2}}, 1.0e-4));
+}
+
+INSTANTIATE_TEST_SUITE_P(Threads, BatchedLpSolverThreadsTest,
+                         testing::Values(1, 2));
+
+TEST(BatchedLpSolverTest, IterationLimit) {
+  PrimalDualHybridGradientParams params = TestParams();
+  params.mutable_termination_criteria()->set_iteration_limit(10);
+  const QuadraticProgram lp = TestLp();
+  std::unique_ptr<BatchedLpSolver> solver = CreateSolver(lp, params);
+  const absl::StatusOr<BatchedSolverResult> result =
+      solver->Solve(RepeatedLp(lp, 2));
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_THAT(result->termination_reasons,
+              ElementsAre(TERMINATION_REASON_ITERATION_LIMIT,
+                          TERMINATION_REASON_ITERATION_LIMIT));
+  EXPECT_THAT(result->iteration_counts, ElementsAre(10, 10));
+}
+
+TEST(BatchedLpSolverTest, EmptyBatch) {
+  const QuadraticProgram lp = TestLp();
+  std::unique_ptr<BatchedLpSolver> solver = CreateSolver(lp, TestParams());
+  const absl::StatusOr<BatchedSolverResult> result =
+      solver->Solve(RepeatedLp(lp, 0));
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_TRUE(result->termination_reasons.empty());
+}
+
+TEST(BatchedLpSolverTest, RejectsUnsupportedParams) {
+  const QuadraticProgram lp = TestLp();
+  PrimalDualHybridGradientParams params = TestParams();
+  params.set_linesearch_rule(
+      PrimalDualHybridGradientParams::ADAPTIVE_LINESEARCH_RULE);
+  EXPECT_EQ(BatchedLpSolver::Create(lp.constraint_matrix, params)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  params = TestParams();
+  params.set_restart_strategy(
+      PrimalDualHybridGradientParams::ADAPTIVE_HEURISTIC);
+  EXPECT_EQ(BatchedLpSolver::Create(lp.constraint_matrix, params)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(BatchedLpSolverTest, RejectsInconsistentSizes) {
+  const QuadraticProgram lp = TestLp();
+  std::unique_ptr<BatchedLpSolver> solver = CreateSolver(lp, TestParams());
+  LpBatch batch = RepeatedLp(lp, 2);
+  batch.objective_offsets = VectorXd::Zero(3);
+  EXPECT_EQ(solver->Solve(batch).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  batch = RepeatedLp(lp, 2);
+  batch.initial_primal_solutions = Eigen::MatrixXd::Zero(4, 2);
+  EXPECT_EQ(solver->Solve(batch).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  batch = RepeatedLp(lp, 2);
+  batch.constraint_upper_bounds = Eigen::MatrixXd::Zero(3, 2);
+  EXPECT_EQ(solver->Solve(batch).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace operations_research::pdlp
@@ -0,0 +1,405 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/pdlp/communicator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+
+#if !defined(_WIN32)
+#include <cerrno>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif  // !defined(_WIN32)
+
+namespace operations_research::pdlp {
+
+absl::Status Communicator::AllReduce(const ReductionOp op,
+                                     absl::Span<double> values) {
+  absl::StatusOr<std::vector<std::vector<double>>> all_values =
+      Exchange(values);
+  if (!all_values.ok()) return all_values.status();
+  for (int rank = 0; rank < Size(); ++rank) {
+    const int64_t rank_size = (*all_values)[rank].size();
+    if (rank_size != values.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("AllReduce() called with ", values.size(),
+                       " values on rank ", Rank(), " and ", rank_size,
+                       " values on rank ", rank));
+    }
+  }
+  // The entries are reduced in rank order so that all the ranks get the same
+  // rounding.
+  for (int64_t i = 0; i < values.size(); ++i) {
+    double reduced = (*all_values)[0][i];
+    for (int rank = 1; rank < Size(); ++rank) {
+      switch (op) {
+        case ReductionOp::kSum:
+          reduced += (*all_values)[rank][i];
+          break;
+        case ReductionOp::kMax:
+          reduced = std::max(reduced, (*all_values)[rank][i]);
+          break;
+      }
+    }
+    values[i] = reduced;
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<double>> Communicator::AllGather(
+    absl::Span<const double> local) {
+  absl::StatusOr<std::vector<std::vector<double>>> all_values =
+      Exchange(local);
+  if (!all_values.ok()) return all_values.status();
+  int64_t total_size = 0;
+  for (const std::vector<double>& rank_values : *all_values) {
+    total_size += rank_values.size();
+  }
+  std::vector<double> result;
+  result.reserve(total_size);
+  for (const std::vector<double>& rank_values : *all_values) {
+    result.insert(result.end(), rank_values.begin(), rank_values.end());
+  }
+  return result;
+}
+
+class InProcessCommunicatorGroup::Member : public Communicator {
+ public:
+  Member(InProcessCommunicatorGroup* group, int rank)
+      : group_(*group), rank_(rank) {}
+
+  int Rank() const override { return rank_; }
+  int Size() const override { return group_.size_; }
+
+  absl::StatusOr<std::vector<std::vector<double>>> Exchange(
+      absl::Span<const double> local) override {
+    return group_.Exchange(rank_, local);
+  }
+
+ private:
+  InProcessCommunicatorGroup& group_;
+  const int rank_;
+};
+
+InProcessCommunicatorGroup::InProcessCommunicatorGroup(const int size)
+    : size_(size), contributions_(size) {
+  CHECK_GE(size, 1);
+  members_.reserve(size);
+  for (int rank = 0; rank < size; ++rank) {
+    members_.push_back(std::make_unique<Member>(this, rank));
+  }
+}
+
+InProcessCommunicatorGroup::~InProcessCommunicatorGroup() = default;
+
+Communicator& InProcessCommunicatorGroup::Get(const int rank) {
+  CHECK_GE(rank, 0);
+  CHECK_LT(rank, size_);
+  return *members_[rank];
+}
+
+std::vector<std::vector<double>> InProcessCommunicatorGroup::Exchange(
+    const int rank, absl::Span<const double> local) {
+  absl::MutexLock lock(&mutex_);
+  contributions_[rank].assign(local.begin(), local.end());
+  const int64_t exchange_number = num_completed_;
+  if (++num_arrived_ == size_) {
+    // The last rank to arrive publishes the exchange. A rank can't start the
+    // next exchange's `contributions_` before all the ranks arrived in this
+    // one, and `published_` isn't replaced until all the ranks arrived in the
+    // next one, after they copied it below.
+    published_.swap(contributions_);
+    contributions_.resize(size_);
+    num_arrived_ = 0;
+    ++num_completed_;
+  } else {
+    auto exchange_completed = [this, exchange_number]() {
+      mutex_.AssertHeld();
+      return num_completed_ > exchange_number;
+    };
+    mutex_.Await(absl::Condition(&exchange_completed));
+  }
+  return published_;
+}
+
+#if !defined(_WIN32)
+
+namespace {
+
+absl::Status ErrnoError(const std::string& operation) {
+  return absl::UnavailableError(
+      absl::StrCat(operation, " failed: ", std::strerror(errno)));
+}
+
+absl::Status WriteBytes(const int socket, const void* data, size_t size) {
+  const char* bytes = static_cast<const char*>(data);
+  while (size > 0) {
+#ifdef MSG_NOSIGNAL
+    const ssize_t written = send(socket, bytes, size, MSG_NOSIGNAL);
+#else
+    const ssize_t written = send(socket, bytes, size, 0);
+#endif
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return ErrnoError("send()");
+    }
+    bytes += written;
+    size -= written;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReadBytes(const int socket, void* data, size_t size) {
+  char* bytes = static_cast<char*>(data);
+  while (size > 0) {
+    const ssize_t read = recv(socket, bytes, size, 0);
+    if (read < 0) {
+      if (errno == EINTR) continue;
+      return ErrnoError("recv()");
+    }
+    if (read == 0) {
+      return absl::UnavailableError("the connection was closed by the peer");
+    }
+    bytes += read;
+    size -= read;
+  }
+  return absl::OkStatus();
+}
+
+// A message is its number of doubles as a `uint64_t` followed by the doubles.
+// Both ends are on the same host, so there is no byte order conversion.
+absl::Status WriteMessage(const int socket, absl::Span<const double> values) {
+  const uint64_t size = values.size();
+  if (absl::Status status = WriteBytes(socket, &size, sizeof(size));
+      !status.ok()) {
+    return status;
+  }
+  return WriteBytes(socket, values.data(), size * sizeof(double));
+}
+
+absl::StatusOr<std::vector<double>> ReadMessage(const int socket) {
+  uint64_t size = 0;
+  if (absl::Status status = ReadBytes(socket, &size, sizeof(size));
+      !status.ok()) {
+    return status;
+  }
+  std::vector<double> values(size);
+  if (absl::Status status =
+          ReadBytes(socket, values.data(), size * sizeof(double));
+      !status.ok()) {
+    return status;
+  }
+  return values;
+}
+
+absl::StatusOr<sockaddr_un> SocketAddress(const std::string& socket_path) {
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("socket path is too long: ", socket_path));
+  }
+  std::memcpy(address.sun_path, socket_path.data(), socket_path.size());
+  return address;
+}
+
+// Waits until a connection can be accepted on `listener`, or until `deadline`.
+absl::Status WaitForConnection(const int listener, const absl::Time deadline) {
+  while (true) {
+    const absl::Duration remaining = deadline - absl::Now();
+    if (remaining <= absl::ZeroDuration()) {
+      return absl::DeadlineExceededError(
+          "timed out waiting for the other ranks to connect");
+    }
+    pollfd poll_fd = {.fd = listener, .events = POLLIN, .revents = 0};
+    const int64_t timeout_ms = absl::ToInt64Milliseconds(absl::Ceil(
+        std::min(remaining, absl::Seconds(1)), absl::Milliseconds(1)));
+    const int num_ready = poll(&poll_fd, 1, static_cast<int>(timeout_ms));
+    if (num_ready < 0) {
+      if (errno == EINTR) continue;
+      return ErrnoError("poll()");
+    }
+    if (num_ready > 0) return absl::OkStatus();
+  }
+}
+
+void CloseSockets(const std::vector<int>& sockets) {
+  for (const int socket : sockets) {
+    if (socket >= 0) close(socket);
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<UnixSocketCommunicator>>
+UnixSocketCommunicator::Create(const std::string& socket_path, const int rank,
+                               const int size,
+                               const absl::Duration connect_timeout) {
+  if (size < 1 || rank < 0 || rank >= size) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("invalid rank ", rank, " for size ", size));
+  }
+  absl::StatusOr<sockaddr_un> address = SocketAddress(socket_path);
+  if (!address.ok()) return address.status();
+  const sockaddr* socket_address = reinterpret_cast<const sockaddr*>(&*address);
+  const absl::Time deadline = absl::Now() + connect_timeout;
+
+  if (rank == 0) {
+    std::vector<int> sockets(size, -1);
+    if (size == 1) {
+      return absl::WrapUnique(
+          new UnixSocketCommunicator(rank, size, std::move(sockets)));
+    }
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) return ErrnoError("socket()");
+    unlink(socket_path.c_str());
+    if (bind(listener, socket_address, sizeof(sockaddr_un)) < 0 ||
+        listen(listener, size) < 0) {
+      const absl::Status status = ErrnoError("bind() or listen()");
+      close(listener);
+      return status;
+    }
+    // The other ranks connect in any order and identify themselves by
+    // sending their rank.
+    absl::Status status;
+    for (int i = 1; i < size && status.ok(); ++i) {
+      status = WaitForConnection(listener, deadline);
+      if (!status.ok()) break;
+      const int peer = accept(listener, nullptr, nullptr);
+      if (peer < 0) {
+        if (errno == EINTR) {
+          --i;
+          continue;
+        }
+        status = ErrnoError("accept()");
+        break;
+      }
+      int32_t peer_rank = -1;
+      status = ReadBytes(peer, &peer_rank, sizeof(peer_rank));
+      if (status.ok() && (peer_rank < 1 || peer_rank >= size ||
+                          sockets[peer_rank] >= 0)) {
+        status = absl::InvalidArgumentError(
+            absl::StrCat("unexpected rank ", peer_rank, " connected"));
+      }
+      if (!status.ok()) {
+        close(peer);
+        break;
+      }
+      sockets[peer_rank] = peer;
+    }
+    close(listener);
+    unlink(socket_path.c_str());
+    if (!status.ok()) {
+      CloseSockets(sockets);
+      return status;
+    }
+    return absl::WrapUnique(
+        new UnixSocketCommunicator(rank, size, std::move(sockets)));
+  }
+
+  int connection = -1;
+  while (true) {
+    connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection < 0) return ErrnoError("socket()");
+    if (connect(connection, socket_address, sizeof(sockaddr_un)) == 0) break;
+    // Rank 0 may not be listening yet.
+    const absl::Status status = ErrnoError("connect()");
+    close(connection);
+    if (absl::Now() >= deadline) return status;
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+  const int32_t own_rank = rank;
+  if (absl::Status status = WriteBytes(connection, &own_rank, sizeof(own_rank));
+      !status.ok()) {
+    close(connection);
+    return status;
+  }
+  return absl::WrapUnique(
+      new UnixSocketCommunicator(rank, size, std::vector<int>{connection}));
+}
+
+UnixSocketCommunicator::~UnixSocketCommunicator() { CloseSockets(sockets_); }
+
+absl::StatusOr<std::vector<std::vector<double>>>
+UnixSocketCommunicator::Exchange(absl::Span<const double> local) {
+  std::vector<std::vector<double>> all_values(size_);
+  if (rank_ == 0) {
+    // Rank 0 gathers the vectors of all the ranks and sends all of them back.
+    all_values[0].assign(local.begin(), local.end());
+    for (int rank = 1; rank < size_; ++rank) {
+      absl::StatusOr<std::vector<double>> values = ReadMessage(sockets_[rank]);
+      if (!values.ok()) return values.status();
+      all_values[rank] = *std::move(values);
+    }
+    for (int peer = 1; peer < size_; ++peer) {
+      for (const std::vector<double>& values : all_values) {
+        if (absl::Status status = WriteMessage(sockets_[peer], values);
+            !status.ok()) {
+          return status;
+        }
+      }
+    }
+  } else {
+    if (absl::Status status = WriteMessage(sockets_[0], local); !status.ok()) {
+      return status;
+    }
+    for (int rank = 0; rank < size_; ++rank) {
+      absl::StatusOr<std::vector<double>> values = ReadMessage(sockets_[0]);
+      if (!values.ok()) return values.status();
+      all_values[rank] = *std::move(values);
+    }
+  }
+  return all_values;
+}
+
+#else  // !defined(_WIN32)
+
+absl::StatusOr<std::unique_ptr<UnixSocketCommunicator>>
+UnixSocketCommunicator::Create(const std::string& socket_path, const int rank,
+                               const int size,
+                               const absl::Duration connect_timeout) {
+  return absl::UnimplementedError(
+      "UnixSocketCommunicator is not available on Windows");
+}
+
+UnixSocketCommunicator::~UnixSocketCommunicator() = default;
+
+absl::StatusOr<std::vector<std::vector<double>>>
+UnixSocketCommunicator::Exchange(absl::Span<const double> local) {
+  return absl::UnimplementedError(
+      "UnixSocketCommunicator is not available on Windows");
+}
+
+#endif  // !defined(_WIN32)
+
+}  // namespace operations_research::pdlp
@@ -0,0 +1,139 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Collective operations used by `DistributedPrimalDualHybridGradient()` to
+// exchange vector slices and scalar reductions between the processes (or
+// threads) that each own a block of the problem.
+
+#ifndef PDLP_COMMUNICATOR_H_
+#define PDLP_COMMUNICATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+
+namespace operations_research::pdlp {
+
+// A group of `Size()` ranks, numbered from 0, that exchange vectors of doubles.
+// All the operations are collective: every rank of the group must call them in
+// the same order, and they block until all the ranks did so.
+//
+// The results are identical on all the ranks, and reductions are combined in
+// rank order, so they don't depend on the timing of the calls.
+//
+// Implementations only provide `Exchange()`; the other operations are built on
+// it.
+class Communicator {
+ public:
+  enum class ReductionOp { kSum, kMax };
+
+  virtual ~Communicator() = default;
+
+  virtual int Rank() const = 0;
+  virtual int Size() const = 0;
+
+  // Returns the `local` vectors of all the ranks, indexed by rank. The vectors
+  // may have different sizes on different ranks.
+  virtual absl::StatusOr<std::vector<std::vector<double>>> Exchange(
+      absl::Span<const double> local) = 0;
+
+  // Replaces each entry of `values` by its reduction over all the ranks.
+  // `values` must have the same size on all the ranks.
+  absl::Status AllReduce(ReductionOp op, absl::Span<double> values);
+
+  // Returns the concatenation of the `local` vectors of all the ranks in rank
+  // order.
+  absl::StatusOr<std::vector<double>> AllGather(
+      absl::Span<const double> local);
+};
+
+// A group of communicators for ranks that are threads of the same process,
+// mostly for tests. `Get(rank)` must be called by at most one thread per rank,
+// and the group must outlive the calls.
+class InProcessCommunicatorGroup {
+ public:
+  explicit InProcessCommunicatorGroup(int size);
+  ~InProcessCommunicatorGroup();
+
+  // This type is neither copyable nor movable.
+  InProcessCommunicatorGroup(const InProcessCommunicatorGroup&) = delete;
+  InProcessCommunicatorGroup& operator=(const InProcessCommunicatorGroup&) =
+      delete;
+
+  Communicator& Get(int rank);
+
+ private:
+  class Member;
+
+  std::vector<std::vector<double>> Exchange(int rank,
+                                            absl::Span<const double> local);
+
+  const int size_;
+  std::vector<std::unique_ptr<Member>> members_;
+  absl::Mutex mutex_;
+  // The vectors of the exchange in progress.
+  std::vector<std::vector<double>> contributions_ ABSL_GUARDED_BY(mutex_);
+  // The vectors of the last completed exchange.
+  std::vector<std::vector<double>> published_ ABSL_GUARDED_BY(mutex_);
+  int num_arrived_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t num_completed_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// A communicator between processes of the same host, connected through a Unix
+// domain socket. Rank 0 listens on `socket_path` and relays all the exchanges,
+// so it does `Size() - 1` times more communication than the other ranks; this
+// is meant for testing the distributed code on a single host, not for
+// performance. Not available on Windows.
+class UnixSocketCommunicator : public Communicator {
+ public:
+  // Connects the ranks. Rank 0 creates `socket_path` (replacing any existing
+  // file) and removes it once all the other ranks are connected, or returns a
+  // `DeadlineExceededError` if they are not all connected after
+  // `connect_timeout`. The other ranks retry connecting until
+  // `connect_timeout`.
+  static absl::StatusOr<std::unique_ptr<UnixSocketCommunicator>> Create(
+      const std::string& socket_path, int rank, int size,
+      absl::Duration connect_timeout = absl::Seconds(60));
+
+  ~UnixSocketCommunicator() override;
+
+  int Rank() const override { return rank_; }
+  int Size() const override { return size_; }
+
+  absl::StatusOr<std::vector<std::vector<double>>> Exchange(
+      absl::Span<const double> local) override;
+
+ private:
+  UnixSocketCommunicator(int rank, int size, std::vector<int> sockets)
+      : rank_(rank), size_(size), sockets_(std::move(sockets)) {}
+
+  const int rank_;
+  const int size_;
+  // On rank 0, the socket connected to rank `r` is `sockets_[r]` (and
+  // `sockets_[0]` is unused). On the other ranks, `sockets_[0]` is the socket
+  // connected to rank 0.
+  std::vector<int> sockets_;
+};
+
+}  // namespace operations_research::pdlp
+
+#endif  // PDLP_COMMUNICATOR_H_
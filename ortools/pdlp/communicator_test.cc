@@ -0,0 +1,192 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/pdlp/communicator.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace operations_research::pdlp {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+using ReductionOp = Communicator::ReductionOp;
+
+// Runs `function(communicator)` for each rank of `communicators` in its own
+// thread.
+void RunOnAllRanks(const std::vector<Communicator*>& communicators,
+                   const std::function<void(Communicator&)>& function) {
+  std::vector<std::thread> threads;
+  for (Communicator* communicator : communicators) {
+    threads.emplace_back([&function, communicator]() {
+      function(*communicator);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+}
+
+std::vector<Communicator*> InProcessCommunicators(
+    InProcessCommunicatorGroup& group, const int size) {
+  std::vector<Communicator*> communicators;
+  for (int rank = 0; rank < size; ++rank) {
+    communicators.push_back(&group.Get(rank));
+  }
+  return communicators;
+}
+
+// Checks the collective operations on the ranks of a group of size 3.
+void CheckCollectives(Communicator& communicator) {
+  const int rank = communicator.Rank();
+  ASSERT_EQ(communicator.Size(), 3);
+
+  std::vector<double> sum = {1.0 * rank, 10.0};
+  ASSERT_TRUE(communicator.AllReduce(ReductionOp::kSum, absl::MakeSpan(sum))
+                  .ok());
+  EXPECT_THAT(sum, ElementsAre(3.0, 30.0));
+
+  std::vector<double> max = {-1.0 * rank, 1.0 * rank};
+  ASSERT_TRUE(communicator.AllReduce(ReductionOp::kMax, absl::MakeSpan(max))
+                  .ok());
+  EXPECT_THAT(max, ElementsAre(0.0, 2.0));
+
+  // Rank r contributes r copies of r.
+  const std::vector<double> local(rank, 1.0 * rank);
+  const absl::StatusOr<std::vector<double>> gathered =
+      communicator.AllGather(local);
+  ASSERT_TRUE(gathered.ok()) << gathered.status();
+  EXPECT_THAT(*gathered, ElementsAre(1.0, 2.0, 2.0));
+
+  const absl::StatusOr<std::vector<std::vector<double>>> exchanged =
+      communicator.Exchange(local);
+  ASSERT_TRUE(exchanged.ok()) << exchanged.status();
+  EXPECT_THAT(*exchanged, ElementsAre(IsEmpty(), ElementsAre(1.0),
+                                      ElementsAre(2.0, 2.0)));
+}
+
+TEST(InProcessCommunicatorTest, Collectives) {
+  InProcessCommunicatorGroup group(3);
+  RunOnAllRanks(InProcessCommunicators(group, 3), CheckCollectives);
+}
+
+TEST(InProcessCommunicatorTest, SingleRank) {
+  InProcessCommunicatorGroup group(1);
+  Communicator& communicator = group.Get(0);
+  EXPECT_EQ(communicator.Rank(), 0);
+  EXPECT_EQ(communicator.Size(), 1);
+  std::vector<double> values = {1.0, 2.0};
+  ASSERT_TRUE(
+      communicator.AllReduce(ReductionOp::kSum, absl::MakeSpan(values)).ok());
+  EXPECT_THAT(values, ElementsAre(1.0, 2.0));
+}
+
+TEST(InProcessCommunicatorTest, ManyConsecutiveExchanges) {
+  const int size = 4;
+  const int num_rounds = 1000;
+  InProcessCommunicatorGroup group(size);
+  RunOnAllRanks(InProcessCommunicators(group, size),
+                [&](Communicator& communicator) {
+                  for (int round = 0; round < num_rounds; ++round) {
+                    std::vector<double> values = {1.0 * round};
+                    ASSERT_TRUE(communicator
+                                    .AllReduce(ReductionOp::kSum,
+                                               absl::MakeSpan(values))
+                                    .ok());
+                    ASSERT_EQ(values[0], 1.0 * size * round);
+                  }
+                });
+}
+
+TEST(InProcessCommunicatorTest, AllReduceSizeMismatch) {
+  InProcessCommunicatorGroup group(2);
+  RunOnAllRanks(InProcessCommunicators(group, 2),
+                [](Communicator& communicator) {
+                  std::vector<double> values(communicator.Rank() + 1, 1.0);
+                  EXPECT_EQ(communicator
+                                .AllReduce(ReductionOp::kSum,
+                                           absl::MakeSpan(values))
+                                .code(),
+                            absl::StatusCode::kInvalidArgument);
+                });
+}
+
+#if !defined(_WIN32)
+
+std::string SocketPath(const std::string& test_name) {
+  return absl::StrCat(::testing::TempDir(), "/", test_name, ".socket");
+}
+
+TEST(UnixSocketCommunicatorTest, Collectives) {
+  const std::string socket_path = SocketPath("Collectives");
+  const int size = 3;
+  std::vector<std::thread> threads;
+  for (int rank = 0; rank < size; ++rank) {
+    threads.emplace_back([&socket_path, rank]() {
+      absl::StatusOr<std::unique_ptr<UnixSocketCommunicator>> communicator =
+          UnixSocketCommunicator::Create(socket_path, rank, size);
+      ASSERT_TRUE(communicator.ok()) << communicator.status();
+      EXPECT_EQ((*communicator)->Rank(), rank);
+      CheckCollectives(**communicator);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+}
+
+TEST(UnixSocketCommunicatorTest, SingleRank) {
+  absl::StatusOr<std::unique_ptr<UnixSocketCommunicator>> communicator =
+      UnixSocketCommunicator::Create(SocketPath("SingleRank"), 0, 1);
+  ASSERT_TRUE(communicator.ok()) << communicator.status();
+  const absl::StatusOr<std::vector<double>> gathered =
+      (*communicator)->AllGather(std::vector<double>{1.0, 2.0});
+  ASSERT_TRUE(gathered.ok()) << gathered.status();
+  EXPECT_THAT(*gathered, ElementsAre(1.0, 2.0));
+}
+
+TEST(UnixSocketCommunicatorTest, InvalidRank) {
+  EXPECT_EQ(UnixSocketCommunicator::Create(SocketPath("InvalidRank"), 2, 2)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(UnixSocketCommunicatorTest, ConnectTimeout) {
+  EXPECT_EQ(UnixSocketCommunicator::Create(SocketPath("ConnectTimeout"), 1, 2,
+                                           absl::Milliseconds(50))
+                .status()
+                .code(),
+            absl::StatusCode::kUnavailable);
+}
+
+// Rank 0 gives up if the other ranks don't connect.
+TEST(UnixSocketCommunicatorTest, AcceptTimeout) {
+  EXPECT_EQ(UnixSocketCommunicator::Create(SocketPath("AcceptTimeout"), 0, 2,
+                                           absl::Milliseconds(50))
+                .status()
+                .code(),
+            absl::StatusCode::kDeadlineExceeded);
+}
+
+#endif  // !defined(_WIN32)
+
+}  // namespace
+}  // namespace operations_research::pdlp
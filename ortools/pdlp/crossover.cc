@@ -0,0 +1,232 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/pdlp/crossover.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "Eigen/Core"
+#include "Eigen/SparseCore"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "ortools/base/logging.h"
+#include "ortools/glop/parameters.pb.h"
+#include "ortools/glop/revised_simplex.h"
+#include "ortools/glop/status.h"
+#include "ortools/glop/variables_info.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/util/time_limit.h"
+
+namespace operations_research::pdlp {
+
+namespace {
+
+using ::Eigen::VectorXd;
+
+// Returns the guessed status of a variable with the given bounds, value and
+// reduced cost. A constraint is handled as a variable equal to its activity,
+// with its dual value as reduced cost.
+glop::VariableStatus GuessStatus(const double lower_bound,
+                                 const double upper_bound, const double value,
+                                 const double reduced_cost,
+                                 const double bound_tolerance) {
+  if (lower_bound == upper_bound) {
+    return glop::VariableStatus::FIXED_VALUE;
+  }
+  // Infinite when the bound is infinite.
+  const double lower_gap = value - lower_bound;
+  const double upper_gap = upper_bound - value;
+  // By complementarity, a non-zero reduced cost means that the variable is at
+  // the bound given by its sign. The reduced cost is trusted when it is larger
+  // than the distance to that bound.
+  if (reduced_cost > 0.0 &&
+      lower_gap <= std::max(bound_tolerance, reduced_cost)) {
+    return glop::VariableStatus::AT_LOWER_BOUND;
+  }
+  if (reduced_cost < 0.0 &&
+      upper_gap <= std::max(bound_tolerance, -reduced_cost)) {
+    return glop::VariableStatus::AT_UPPER_BOUND;
+  }
+  if (std::min(lower_gap, upper_gap) <= bound_tolerance) {
+    return lower_gap <= upper_gap ? glop::VariableStatus::AT_LOWER_BOUND
+                                  : glop::VariableStatus::AT_UPPER_BOUND;
+  }
+  return glop::VariableStatus::BASIC;
+}
+
+// The slack of a constraint is minus its activity, so a constraint at its
+// lower bound has its slack at its upper bound and vice versa. This is the
+// same conversion as in `glop::LPSolver::SetInitialBasis()`.
+glop::VariableStatus SlackStatus(const glop::ConstraintStatus status) {
+  switch (status) {
+    case glop::ConstraintStatus::AT_LOWER_BOUND:
+      return glop::VariableStatus::AT_UPPER_BOUND;
+    case glop::ConstraintStatus::AT_UPPER_BOUND:
+      return glop::VariableStatus::AT_LOWER_BOUND;
+    case glop::ConstraintStatus::FIXED_VALUE:
+      return glop::VariableStatus::FIXED_VALUE;
+    case glop::ConstraintStatus::BASIC:
+      return glop::VariableStatus::BASIC;
+    case glop::ConstraintStatus::FREE:
+      return glop::VariableStatus::FREE;
+  }
+  LOG(DFATAL) << "Invalid ConstraintStatus " << static_cast<int>(status);
+  return glop::VariableStatus::FREE;
+}
+
+// Copies `lp` into `glop_lp` as a minimization problem, without the objective
+// offset and scaling factor.
+void PopulateGlopLinearProgram(const QuadraticProgram& lp,
+                               glop::LinearProgram& glop_lp) {
+  using InnerIterator =
+      Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>::InnerIterator;
+  for (int64_t row = 0; row < lp.constraint_lower_bounds.size(); ++row) {
+    const glop::RowIndex glop_row = glop_lp.CreateNewConstraint();
+    glop_lp.SetConstraintBounds(glop_row, lp.constraint_lower_bounds[row],
+                                lp.constraint_upper_bounds[row]);
+  }
+  for (int64_t col = 0; col < lp.variable_lower_bounds.size(); ++col) {
+    const glop::ColIndex glop_col = glop_lp.CreateNewVariable();
+    glop_lp.SetVariableBounds(glop_col, lp.variable_lower_bounds[col],
+                              lp.variable_upper_bounds[col]);
+    glop_lp.SetObjectiveCoefficient(glop_col, lp.objective_vector[col]);
+    for (InnerIterator it(lp.constraint_matrix, col); it; ++it) {
+      glop_lp.SetCoefficient(glop::RowIndex(it.row()), glop_col, it.value());
+    }
+  }
+  glop_lp.CleanUp();
+}
+
+}  // namespace
+
+absl::StatusOr<CrossoverResult> Crossover(
+    const QuadraticProgram& lp, const VectorXd& primal_solution,
+    const VectorXd& dual_solution, const glop::GlopParameters& parameters,
+    TimeLimit* time_limit) {
+  if (!IsLinearProgram(lp)) {
+    return absl::InvalidArgumentError(
+        "Crossover is only implemented for linear programs.");
+  }
+  const int64_t num_variables = lp.variable_lower_bounds.size();
+  const int64_t num_constraints = lp.constraint_lower_bounds.size();
+  // Glop adds a slack column per constraint, and uses 32-bit column indices.
+  if (num_variables + num_constraints > std::numeric_limits<int32_t>::max()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Crossover is limited to 2^31 - 1 variables and "
+                     "constraints, got ",
+                     num_variables, " variables and ", num_constraints,
+                     " constraints."));
+  }
+  if (primal_solution.size() != num_variables ||
+      dual_solution.size() != num_constraints) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "The sizes of the solutions (", primal_solution.size(), " and ",
+        dual_solution.size(), ") don't match the linear program (",
+        num_variables, " variables and ", num_constraints, " constraints)."));
+  }
+
+  glop::LinearProgram glop_lp;
+  PopulateGlopLinearProgram(lp, glop_lp);
+
+  const glop::ProblemSolution guess =
+      internal::GuessStatuses(lp, primal_solution, dual_solution,
+                              parameters.crossover_bound_snapping_distance());
+  const VectorXd activities = lp.constraint_matrix * primal_solution;
+  glop::BasisState state;
+  state.statuses = guess.variable_statuses;
+  glop::DenseRow starting_values(
+      glop::ColIndex(num_variables + num_constraints), 0.0);
+  for (int64_t col = 0; col < num_variables; ++col) {
+    starting_values[glop::ColIndex(col)] = primal_solution[col];
+  }
+  for (int64_t row = 0; row < num_constraints; ++row) {
+    state.statuses.push_back(
+        SlackStatus(guess.constraint_statuses[glop::RowIndex(row)]));
+    starting_values[glop::ColIndex(num_variables + row)] = -activities[row];
+  }
+
+  CrossoverResult result;
+  result.num_guessed_basic =
+      std::count(state.statuses.begin(), state.statuses.end(),
+                 glop::VariableStatus::BASIC);
+  glop::RevisedSimplex simplex;
+  simplex.SetParameters(parameters);
+  simplex.LoadStateForNextSolve(state);
+  simplex.SetStartingVariableValuesForNextSolve(starting_values);
+  const glop::Status status = simplex.Solve(glop_lp, time_limit);
+  result.simplex_iteration_count = simplex.GetNumberOfIterations();
+  if (!status.ok()) {
+    LOG(WARNING) << "The simplex solve of the crossover failed: "
+                 << status.error_message();
+    result.status = glop::ProblemStatus::ABNORMAL;
+    return result;
+  }
+  result.status = simplex.GetProblemStatus();
+
+  result.primal_solution.resize(num_variables);
+  result.reduced_costs.resize(num_variables);
+  result.variable_statuses.resize(glop::ColIndex(num_variables));
+  for (int64_t col = 0; col < num_variables; ++col) {
+    const glop::ColIndex glop_col(col);
+    result.primal_solution[col] = simplex.GetVariableValue(glop_col);
+    result.reduced_costs[col] = simplex.GetReducedCost(glop_col);
+    result.variable_statuses[glop_col] = simplex.GetVariableStatus(glop_col);
+  }
+  result.dual_solution.resize(num_constraints);
+  result.constraint_statuses.resize(glop::RowIndex(num_constraints));
+  for (int64_t row = 0; row < num_constraints; ++row) {
+    const glop::RowIndex glop_row(row);
+    result.dual_solution[row] = simplex.GetDualValue(glop_row);
+    result.constraint_statuses[glop_row] =
+        simplex.GetConstraintStatus(glop_row);
+  }
+  return result;
+}
+
+namespace internal {
+
+glop::ProblemSolution GuessStatuses(const QuadraticProgram& lp,
+                                    const VectorXd& primal_solution,
+                                    const VectorXd& dual_solution,
+                                    const double bound_tolerance) {
+  const int64_t num_variables = primal_solution.size();
+  const int64_t num_constraints = dual_solution.size();
+  glop::ProblemSolution guess(glop::RowIndex{num_constraints},
+                              glop::ColIndex{num_variables});
+  // The statuses come from an approximate solution.
+  guess.status = glop::ProblemStatus::IMPRECISE;
+  const VectorXd activities = lp.constraint_matrix * primal_solution;
+  const VectorXd reduced_costs =
+      lp.objective_vector - lp.constraint_matrix.transpose() * dual_solution;
+  for (int64_t col = 0; col < num_variables; ++col) {
+    guess.variable_statuses[glop::ColIndex(col)] = GuessStatus(
+        lp.variable_lower_bounds[col], lp.variable_upper_bounds[col],
+        primal_solution[col], reduced_costs[col], bound_tolerance);
+  }
+  for (int64_t row = 0; row < num_constraints; ++row) {
+    guess.constraint_statuses[glop::RowIndex(row)] =
+        glop::VariableToConstraintStatus(GuessStatus(
+            lp.constraint_lower_bounds[row], lp.constraint_upper_bounds[row],
+            activities[row], dual_solution[row], bound_tolerance));
+  }
+  return guess;
+}
+
+}  // namespace internal
+
+}  // namespace operations_research::pdlp
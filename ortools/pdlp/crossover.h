@@ -0,0 +1,96 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Crossover from an approximately optimal primal and dual solution of a linear
+// program, like the ones found by PDLP, to an optimal basic solution.
+
+#ifndef PDLP_CROSSOVER_H_
+#define PDLP_CROSSOVER_H_
+
+#include <cstdint>
+
+#include "Eigen/Core"
+#include "absl/status/statusor.h"
+#include "ortools/glop/parameters.pb.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/util/time_limit.h"
+
+namespace operations_research::pdlp {
+
+struct CrossoverResult {
+  // The status of the simplex solve. The other fields are only meaningful if
+  // it is `glop::ProblemStatus::OPTIMAL`.
+  glop::ProblemStatus status = glop::ProblemStatus::INIT;
+  // A basic solution of the linear program, with the same conventions as the
+  // solutions of `PrimalDualHybridGradient()`.
+  Eigen::VectorXd primal_solution;
+  Eigen::VectorXd dual_solution;
+  Eigen::VectorXd reduced_costs;
+  // The basis of the solution.
+  glop::VariableStatusRow variable_statuses;
+  glop::ConstraintStatusColumn constraint_statuses;
+  // The number of variables and constraints whose guessed status was `BASIC`.
+  // The basis has as many basic variables and constraints as there are
+  // constraints.
+  int64_t num_guessed_basic = 0;
+  int64_t simplex_iteration_count = 0;
+};
+
+// Finds an optimal basic solution of `lp` starting from `primal_solution` and
+// `dual_solution`, which should be close to optimal. A basis is first guessed
+// from the complementarity of the primal and dual solutions (see
+// `internal::GuessStatuses()`), using `crossover_bound_snapping_distance` from
+// `parameters` as the distance under which a value is considered to be at its
+// bound. Glop's `RevisedSimplex` then starts from the largest factorizable
+// subset of the guessed basic columns, completed with slacks, with the other
+// columns at their guessed bound. The guessed basic columns that are left out
+// of the basis start at their value in `primal_solution`, or at their bound if
+// they are within `crossover_bound_snapping_distance` of it, and are pushed to
+// a bound at the end of the solve if `push_to_vertex` is true, so that the
+// solution is a vertex.
+//
+// The closer the solutions are to optimal, the fewer simplex iterations are
+// needed. With the default glop parameters `crossover_bound_snapping_distance`
+// is infinite, so that every value is snapped to its closest bound; a small
+// value like 1e-6 is usually a better choice.
+//
+// Returns an `InvalidArgumentError` if `lp` has a quadratic objective, if it
+// has more than 2^31 - 1 variables or constraints, or if the sizes of the
+// solutions don't match it. The objective offset and scaling factor of `lp`
+// are ignored.
+absl::StatusOr<CrossoverResult> Crossover(
+    const QuadraticProgram& lp, const Eigen::VectorXd& primal_solution,
+    const Eigen::VectorXd& dual_solution,
+    const glop::GlopParameters& parameters, TimeLimit* time_limit);
+
+namespace internal {
+
+// Guesses the statuses of an optimal basis of `lp` from complementarity. A
+// variable (constraint) with equal bounds is `FIXED_VALUE`. Otherwise it is
+// at its lower bound if its value (activity) is within `bound_tolerance` of
+// it, or if its reduced cost (dual value) is positive and larger than the
+// distance to it, and symmetrically for the upper bound. A variable
+// (constraint) that is at neither bound is `BASIC`. The primal and dual
+// values in the returned `ProblemSolution` are NOT set.
+glop::ProblemSolution GuessStatuses(const QuadraticProgram& lp,
+                                    const Eigen::VectorXd& primal_solution,
+                                    const Eigen::VectorXd& dual_solution,
+                                    double bound_tolerance);
+
+}  // namespace internal
+
+}  // namespace operations_research::pdlp
+
+#endif  // PDLP_CROSSOVER_H_
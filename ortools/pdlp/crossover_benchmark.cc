@@ -0,0 +1,162 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Time to an optimal basis of a random LP.
+//
+// `BM_ColdSimplex` solves the LP with Glop from scratch. `BM_Crossover` only
+// runs the crossover from a PDLP solution computed before the benchmark loop,
+// with PDLP's relative tolerance given as an argument, and
+// `BM_PdlpWithCrossover` runs PDLP with `crossover_options.use_crossover`, so
+// that its time is the time to a basis when starting with PDLP. The
+// simplex_iterations counter is the number of simplex iterations per solve.
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/SparseCore"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "benchmark/benchmark.h"
+#include "ortools/glop/lp_solver.h"
+#include "ortools/glop/parameters.pb.h"
+#include "ortools/linear_solver/linear_solver.pb.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/lp_data/proto_utils.h"
+#include "ortools/pdlp/crossover.h"
+#include "ortools/pdlp/primal_dual_hybrid_gradient.h"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/pdlp/solve_log.pb.h"
+#include "ortools/pdlp/solvers.pb.h"
+#include "ortools/util/time_limit.h"
+
+namespace operations_research::pdlp {
+namespace {
+
+using ::Eigen::VectorXd;
+
+constexpr int kEntriesPerCol = 6;
+
+// min c^T x s.t. A x <= b, 0 <= x <= u, with positive A, b and u and a
+// negative c, so that x = 0 is feasible and the LP is bounded. Has half as
+// many constraints as variables.
+QuadraticProgram RandomLp(const int64_t num_cols) {
+  const int64_t num_rows = num_cols / 2;
+  std::mt19937 random(12345);
+  std::uniform_int_distribution<int64_t> row(0, num_rows - 1);
+  std::uniform_real_distribution<double> value(0.1, 1.0);
+  QuadraticProgram lp(num_cols, num_rows);
+  std::vector<Eigen::Triplet<double, int64_t>> triplets;
+  triplets.reserve(num_cols * kEntriesPerCol);
+  for (int64_t col = 0; col < num_cols; ++col) {
+    for (int e = 0; e < kEntriesPerCol; ++e) {
+      triplets.emplace_back(row(random), col, value(random));
+    }
+    lp.objective_vector[col] = -value(random);
+    lp.variable_lower_bounds[col] = 0.0;
+    lp.variable_upper_bounds[col] = 10.0 * value(random);
+  }
+  lp.constraint_matrix.setFromTriplets(triplets.begin(), triplets.end());
+  lp.constraint_matrix.makeCompressed();
+  for (int64_t r = 0; r < num_rows; ++r) {
+    lp.constraint_upper_bounds[r] = 10.0 * value(random);
+  }
+  return lp;
+}
+
+PrimalDualHybridGradientParams PdlpParams(const double eps_optimal) {
+  PrimalDualHybridGradientParams params;
+  params.mutable_termination_criteria()
+      ->mutable_simple_optimality_criteria()
+      ->set_eps_optimal_absolute(eps_optimal);
+  params.mutable_termination_criteria()
+      ->mutable_simple_optimality_criteria()
+      ->set_eps_optimal_relative(eps_optimal);
+  return params;
+}
+
+// Arguments are the number of variables.
+void BM_ColdSimplex(benchmark::State& state) {
+  const QuadraticProgram lp = RandomLp(state.range(0));
+  const absl::StatusOr<MPModelProto> model = QpToMpModelProto(lp);
+  CHECK_OK(model.status());
+  glop::LinearProgram glop_lp;
+  glop::MPModelProtoToLinearProgram(*model, &glop_lp);
+  int64_t num_iterations = 0;
+  for (auto _ : state) {
+    glop::LPSolver solver;
+    CHECK_EQ(solver.Solve(glop_lp), glop::ProblemStatus::OPTIMAL);
+    num_iterations = solver.GetNumberOfSimplexIterations();
+  }
+  state.counters["simplex_iterations"] = num_iterations;
+}
+BENCHMARK(BM_ColdSimplex)
+    ->ArgName("cols")
+    ->Arg(1 << 12)
+    ->Arg(1 << 14)
+    ->Arg(1 << 16)
+    ->Unit(benchmark::kMillisecond);
+
+// Arguments are the number of variables and minus the base 10 logarithm of
+// the tolerance of the PDLP solution.
+void BM_Crossover(benchmark::State& state) {
+  const QuadraticProgram lp = RandomLp(state.range(0));
+  const SolverResult pdlp_result =
+      PrimalDualHybridGradient(lp, PdlpParams(std::pow(10.0, -state.range(1))));
+  CHECK_EQ(pdlp_result.solve_log.termination_reason(),
+           TERMINATION_REASON_OPTIMAL);
+  glop::GlopParameters parameters;
+  parameters.set_crossover_bound_snapping_distance(1.0e-6);
+  int64_t num_iterations = 0;
+  for (auto _ : state) {
+    TimeLimit time_limit;
+    const absl::StatusOr<CrossoverResult> result =
+        Crossover(lp, pdlp_result.primal_solution, pdlp_result.dual_solution,
+                  parameters, &time_limit);
+    CHECK_OK(result.status());
+    CHECK_EQ(result->status, glop::ProblemStatus::OPTIMAL);
+    num_iterations = result->simplex_iteration_count;
+  }
+  state.counters["simplex_iterations"] = num_iterations;
+}
+BENCHMARK(BM_Crossover)
+    ->ArgNames({"cols", "eps"})
+    ->ArgsProduct({{1 << 12, 1 << 14, 1 << 16}, {4, 8}})
+    ->Unit(benchmark::kMillisecond);
+
+// Arguments are the number of variables and minus the base 10 logarithm of
+// the tolerance of PDLP.
+void BM_PdlpWithCrossover(benchmark::State& state) {
+  const QuadraticProgram lp = RandomLp(state.range(0));
+  PrimalDualHybridGradientParams params =
+      PdlpParams(std::pow(10.0, -state.range(1)));
+  params.mutable_crossover_options()->set_use_crossover(true);
+  int64_t num_iterations = 0;
+  for (auto _ : state) {
+    const SolverResult result = PrimalDualHybridGradient(lp, params);
+    CHECK_EQ(result.solve_log.solution_type(), POINT_TYPE_CROSSOVER_SOLUTION);
+    num_iterations =
+        result.solve_log.crossover_details().simplex_iteration_count();
+  }
+  state.counters["simplex_iterations"] = num_iterations;
+}
+BENCHMARK(BM_PdlpWithCrossover)
+    ->ArgNames({"cols", "eps"})
+    ->ArgsProduct({{1 << 12, 1 << 14, 1 << 16}, {4, 8}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace operations_research::pdlp
@@ -0,0 +1,204 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/pdlp/crossover.h"
+
+#include <algorithm>
+
+#include "Eigen/Core"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ortools/glop/parameters.pb.h"
+#include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/pdlp/test_util.h"
+#include "ortools/util/time_limit.h"
+
+namespace operations_research::pdlp {
+namespace {
+
+using ::Eigen::VectorXd;
+using ::operations_research::glop::ConstraintStatus;
+using ::operations_research::glop::VariableStatus;
+using ::testing::ElementsAre;
+
+glop::GlopParameters CrossoverParameters() {
+  glop::GlopParameters parameters;
+  parameters.set_crossover_bound_snapping_distance(1.0e-6);
+  return parameters;
+}
+
+absl::StatusOr<CrossoverResult> RunCrossover(
+    const QuadraticProgram& lp, const VectorXd& primal_solution,
+    const VectorXd& dual_solution,
+    const glop::GlopParameters& parameters = CrossoverParameters()) {
+  TimeLimit time_limit;
+  return Crossover(lp, primal_solution, dual_solution, parameters,
+                   &time_limit);
+}
+
+TEST(GuessStatusesTest, TestLpAtOptimum) {
+  const glop::ProblemSolution guess =
+      internal::GuessStatuses(TestLp(), VectorXd{{-1, 8, 1, 2.5}},
+                              VectorXd{{-2, 0, 2.375, 2.0 / 3}},
+                              /*bound_tolerance=*/1.0e-6);
+  EXPECT_THAT(guess.constraint_statuses,
+              ElementsAre(ConstraintStatus::FIXED_VALUE,
+                          ConstraintStatus::BASIC,
+                          ConstraintStatus::AT_LOWER_BOUND,
+                          ConstraintStatus::AT_LOWER_BOUND));
+  EXPECT_THAT(guess.variable_statuses,
+              ElementsAre(VariableStatus::BASIC, VariableStatus::BASIC,
+                          VariableStatus::BASIC,
+                          VariableStatus::AT_LOWER_BOUND));
+}
+
+TEST(GuessStatusesTest, TinyLpAtOptimum) {
+  const glop::ProblemSolution guess = internal::GuessStatuses(
+      TinyLp(), VectorXd{{1, 0, 6, 2}}, VectorXd{{0.5, 4, 0}},
+      /*bound_tolerance=*/1.0e-6);
+  EXPECT_THAT(guess.constraint_statuses,
+              ElementsAre(ConstraintStatus::FIXED_VALUE,
+                          ConstraintStatus::AT_LOWER_BOUND,
+                          ConstraintStatus::BASIC));
+  EXPECT_THAT(guess.variable_statuses,
+              ElementsAre(VariableStatus::BASIC, VariableStatus::AT_LOWER_BOUND,
+                          VariableStatus::AT_UPPER_BOUND,
+                          VariableStatus::BASIC));
+}
+
+TEST(GuessStatusesTest, TrustsReducedCostsLargerThanTheGap) {
+  // The reduced costs are [0, 1.5, -3.5, 0]. x_2 and x_3 are further than the
+  // tolerance from their bounds, but closer than their reduced costs. x_1 and
+  // x_4 are within the tolerance of a bound.
+  const glop::ProblemSolution guess = internal::GuessStatuses(
+      TinyLp(), VectorXd{{1.0e-3, 0.1, 5.9, 3.0 - 1.0e-3}},
+      VectorXd{{0.5, 4, 0}}, /*bound_tolerance=*/1.0e-2);
+  EXPECT_THAT(guess.variable_statuses,
+              ElementsAre(VariableStatus::AT_LOWER_BOUND,
+                          VariableStatus::AT_LOWER_BOUND,
+                          VariableStatus::AT_UPPER_BOUND,
+                          VariableStatus::AT_UPPER_BOUND));
+  const glop::ProblemSolution tight_guess = internal::GuessStatuses(
+      TinyLp(), VectorXd{{1.0e-3, 2.0, 5.9, 3.0 - 1.0e-3}},
+      VectorXd{{0.5, 4, 0}}, /*bound_tolerance=*/1.0e-6);
+  EXPECT_THAT(tight_guess.variable_statuses,
+              ElementsAre(VariableStatus::BASIC, VariableStatus::BASIC,
+                          VariableStatus::AT_UPPER_BOUND,
+                          VariableStatus::BASIC));
+}
+
+TEST(CrossoverTest, FromOptimalSolution) {
+  const absl::StatusOr<CrossoverResult> result = RunCrossover(
+      TinyLp(), VectorXd{{1, 0, 6, 2}}, VectorXd{{0.5, 4, 0}});
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(result->status, glop::ProblemStatus::OPTIMAL);
+  EXPECT_EQ(result->num_guessed_basic, 3);
+  EXPECT_EQ(result->simplex_iteration_count, 0);
+  EXPECT_TRUE(result->primal_solution.isApprox(VectorXd{{1, 0, 6, 2}}));
+  EXPECT_TRUE(result->dual_solution.isApprox(VectorXd{{0.5, 4, 0}}));
+  EXPECT_TRUE(result->reduced_costs.isApprox(VectorXd{{0, 1.5, -3.5, 0}}));
+  EXPECT_THAT(result->variable_statuses,
+              ElementsAre(VariableStatus::BASIC, VariableStatus::AT_LOWER_BOUND,
+                          VariableStatus::AT_UPPER_BOUND,
+                          VariableStatus::BASIC));
+  EXPECT_THAT(result->constraint_statuses,
+              ElementsAre(ConstraintStatus::FIXED_VALUE,
+                          ConstraintStatus::AT_LOWER_BOUND,
+                          ConstraintStatus::BASIC));
+}
+
+TEST(CrossoverTest, FromApproximateSolution) {
+  const absl::StatusOr<CrossoverResult> result =
+      RunCrossover(TestLp(), VectorXd{{-1.001, 7.99, 1.002, 2.5}},
+                   VectorXd{{-1.999, 0.001, 2.37, 0.67}});
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(result->status, glop::ProblemStatus::OPTIMAL);
+  EXPECT_EQ(result->num_guessed_basic, 4);
+  EXPECT_TRUE(result->primal_solution.isApprox(VectorXd{{-1, 8, 1, 2.5}}));
+  EXPECT_TRUE(
+      result->dual_solution.isApprox(VectorXd{{-2, 0, 2.375, 2.0 / 3}}));
+  EXPECT_THAT(result->constraint_statuses,
+              ElementsAre(ConstraintStatus::FIXED_VALUE,
+                          ConstraintStatus::BASIC,
+                          ConstraintStatus::AT_LOWER_BOUND,
+                          ConstraintStatus::AT_LOWER_BOUND));
+}
+
+TEST(CrossoverTest, FromZeroSolution) {
+  const absl::StatusOr<CrossoverResult> result =
+      RunCrossover(TinyLp(), VectorXd::Zero(4), VectorXd::Zero(3));
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(result->status, glop::ProblemStatus::OPTIMAL);
+  EXPECT_TRUE(result->primal_solution.isApprox(VectorXd{{1, 0, 6, 2}}));
+  EXPECT_TRUE(result->dual_solution.isApprox(VectorXd{{0.5, 4, 0}}));
+}
+
+TEST(CrossoverTest, PushesInteriorSolutionToVertex) {
+  // Every feasible point is optimal without an objective. The interior point
+  // below guesses all the variables basic, and the simplex has to push the
+  // ones it leaves out of the basis to a bound.
+  QuadraticProgram lp = TinyLp();
+  lp.objective_vector.setZero();
+  const absl::StatusOr<CrossoverResult> result =
+      RunCrossover(lp, VectorXd{{1.8, 1, 5.5, 0.95}}, VectorXd::Zero(3));
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(result->status, glop::ProblemStatus::OPTIMAL);
+  EXPECT_EQ(result->num_guessed_basic, 6);
+  const int num_basic =
+      std::count(result->variable_statuses.begin(),
+                 result->variable_statuses.end(), VariableStatus::BASIC) +
+      std::count(result->constraint_statuses.begin(),
+                 result->constraint_statuses.end(), ConstraintStatus::BASIC);
+  EXPECT_EQ(num_basic, 3);
+  for (int col = 0; col < 4; ++col) {
+    const VariableStatus status =
+        result->variable_statuses[glop::ColIndex(col)];
+    EXPECT_NE(status, VariableStatus::FREE);
+    if (status == VariableStatus::AT_LOWER_BOUND) {
+      EXPECT_EQ(result->primal_solution[col], lp.variable_lower_bounds[col]);
+    } else if (status == VariableStatus::AT_UPPER_BOUND) {
+      EXPECT_EQ(result->primal_solution[col], lp.variable_upper_bounds[col]);
+    }
+  }
+  const VectorXd activities = lp.constraint_matrix * result->primal_solution;
+  EXPECT_NEAR(activities[0], 12, 1.0e-9);
+  EXPECT_GE(activities[1], 7 - 1.0e-9);
+  EXPECT_GE(activities[2], 1 - 1.0e-9);
+}
+
+TEST(CrossoverTest, RejectsQuadraticPrograms) {
+  const QuadraticProgram qp = TestDiagonalQp1();
+  EXPECT_EQ(RunCrossover(qp, VectorXd::Zero(qp.variable_lower_bounds.size()),
+                         VectorXd::Zero(qp.constraint_lower_bounds.size()))
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(CrossoverTest, RejectsSolutionsOfTheWrongSize) {
+  EXPECT_EQ(RunCrossover(TinyLp(), VectorXd::Zero(3), VectorXd::Zero(3))
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(RunCrossover(TinyLp(), VectorXd::Zero(4), VectorXd::Zero(4))
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace operations_research::pdlp
@@ -0,0 +1,669 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/pdlp/distributed_primal_dual_hybrid_gradient.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/SparseCore"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "ortools/base/status_macros.h"
+#include "ortools/base/threadpool.h"
+#include "ortools/base/timer.h"
+#include "ortools/pdlp/communicator.h"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/pdlp/sharder.h"
+#include "ortools/pdlp/solve_log.pb.h"
+#include "ortools/pdlp/solvers.pb.h"
+#include "ortools/pdlp/solvers_proto_validation.h"
+#include "ortools/pdlp/termination.h"
+
+namespace operations_research::pdlp {
+
+namespace {
+
+using ::Eigen::VectorXd;
+
+using ReductionOp = Communicator::ReductionOp;
+
+// The same as in `PrimalDualHybridGradient()`.
+constexpr double kDivergentMovement = 1.0e100;
+constexpr int kMaxInnerIterations = 60;
+
+Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> ColumnBlock(
+    const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix,
+    const int64_t start, const int64_t size) {
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> block =
+      matrix.middleCols(start, size);
+  block.makeCompressed();
+  return block;
+}
+
+absl::Status CheckSupportedParams(
+    const PrimalDualHybridGradientParams& params) {
+  RETURN_IF_ERROR(ValidatePrimalDualHybridGradientParams(params));
+  if (params.linesearch_rule() !=
+      PrimalDualHybridGradientParams::ADAPTIVE_LINESEARCH_RULE) {
+    return absl::InvalidArgumentError(
+        "DistributedPrimalDualHybridGradient() only supports the adaptive "
+        "linesearch rule");
+  }
+  if (params.presolve_options().use_glop() ||
+      params.presolve_options().use_native_presolve()) {
+    return absl::InvalidArgumentError(
+        "DistributedPrimalDualHybridGradient() doesn't support presolve");
+  }
+  if (params.restart_strategy() != PrimalDualHybridGradientParams::NO_RESTARTS) {
+    return absl::InvalidArgumentError(
+        "DistributedPrimalDualHybridGradient() doesn't support restarts, "
+        "restart_strategy must be NO_RESTARTS");
+  }
+  if (params.l_inf_ruiz_iterations() > 0 || params.l2_norm_rescaling()) {
+    return absl::InvalidArgumentError(
+        "DistributedPrimalDualHybridGradient() doesn't support rescaling, "
+        "l_inf_ruiz_iterations must be 0 and l2_norm_rescaling false");
+  }
+  if (params.use_float_transposed_constraint_matrix()) {
+    return absl::InvalidArgumentError(
+        "DistributedPrimalDualHybridGradient() doesn't support "
+        "use_float_transposed_constraint_matrix");
+  }
+  if (params.use_feasibility_polishing()) {
+    return absl::InvalidArgumentError(
+        "DistributedPrimalDualHybridGradient() doesn't support feasibility "
+        "polishing");
+  }
+  if (params.termination_criteria().optimality_norm() ==
+      OPTIMALITY_NORM_L_INF_COMPONENTWISE) {
+    return absl::InvalidArgumentError(
+        "DistributedPrimalDualHybridGradient() doesn't support the "
+        "componentwise optimality norm");
+  }
+  return absl::OkStatus();
+}
+
+// The largest absolute finite value of `lower_bound` and `upper_bound`, as in
+// the `combined_bounds_*` problem statistics.
+double CombinedBound(const double lower_bound, const double upper_bound) {
+  double result = 0.0;
+  if (std::isfinite(lower_bound)) result = std::abs(lower_bound);
+  if (std::isfinite(upper_bound)) {
+    result = std::max(result, std::abs(upper_bound));
+  }
+  return result;
+}
+
+// The variable bound that multiplies a reduced cost in the dual objective,
+// and whether the reduced cost is a dual residual instead, following
+// `handle_some_primal_gradients_on_finite_bounds_as_residuals`. See
+// `DualResidualNorms()` in iteration_stats.cc.
+struct ReducedCostBound {
+  double bound_for_objective;
+  bool is_residual;
+};
+
+ReducedCostBound BoundForReducedCost(
+    const PrimalDualHybridGradientParams& params, const double primal_value,
+    const double reduced_cost, const double lower_bound,
+    const double upper_bound) {
+  auto treat_as_finite = [&](const double bound) {
+    if (params.handle_some_primal_gradients_on_finite_bounds_as_residuals()) {
+      return std::abs(primal_value - bound) <= std::abs(primal_value);
+    }
+    return std::isfinite(bound);
+  };
+  const double kInfinity = std::numeric_limits<double>::infinity();
+  const double effective_lower_bound =
+      treat_as_finite(lower_bound) ? lower_bound : -kInfinity;
+  const double effective_upper_bound =
+      treat_as_finite(upper_bound) ? upper_bound : kInfinity;
+  const double primary_bound =
+      reduced_cost >= 0.0 ? effective_lower_bound : effective_upper_bound;
+  const double secondary_bound =
+      reduced_cost >= 0.0 ? effective_upper_bound : effective_lower_bound;
+  ReducedCostBound result = {.bound_for_objective = 0.0,
+                             .is_residual = std::isinf(primary_bound)};
+  if (std::isfinite(primary_bound)) {
+    result.bound_for_objective = primary_bound;
+  } else if (std::isfinite(secondary_bound)) {
+    result.bound_for_objective = secondary_bound;
+  }
+  return result;
+}
+
+absl::StatusOr<VectorXd> AllGatherVector(const VectorXd& local,
+                                         Communicator& communicator) {
+  ASSIGN_OR_RETURN(
+      std::vector<double> all_values,
+      communicator.AllGather(absl::MakeConstSpan(local.data(), local.size())));
+  return Eigen::Map<const VectorXd>(all_values.data(), all_values.size());
+}
+
+class DistributedSolver {
+ public:
+  DistributedSolver(const LpBlock& block,
+                    const PrimalDualHybridGradientParams& params,
+                    Communicator& communicator);
+
+  absl::StatusOr<DistributedSolverResult> Solve();
+
+ private:
+  struct NextSolutionAndDelta {
+    VectorXd value;
+    VectorXd delta;
+    double delta_squared_norm = 0.0;
+  };
+
+  // The owned slice of the next primal solution, and of the extrapolated
+  // primal solution in `extrapolated_primal`.
+  NextSolutionAndDelta ComputeNextPrimalSolution(
+      double primal_step_size, VectorXd& extrapolated_primal) const;
+
+  // The owned slice of the next dual solution, given the whole extrapolated
+  // primal solution.
+  NextSolutionAndDelta ComputeNextDualSolution(
+      double dual_step_size, const VectorXd& extrapolated_primal) const;
+
+  // Computes the norms of the objective and constraint bounds, the initial
+  // step size and the initial primal weight.
+  absl::StatusOr<QuadraticProgramBoundNorms> Initialize();
+
+  // Takes one step of PDHG with the adaptive linesearch rule, like
+  // `Solver::TakeAdaptiveStep()`. Returns true if the solve must terminate
+  // with a numerical error.
+  absl::StatusOr<bool> TakeAdaptiveStep();
+
+  // Updates the primal weight from the distances traveled since the last major
+  // iteration, and makes the current iterate the new start point, like
+  // `NO_RESTARTS` does at each major iteration of `Solver`.
+  absl::Status UpdatePrimalWeight();
+
+  absl::StatusOr<ConvergenceInformation> ComputeConvergenceInformation();
+
+  // Returns true if the time limit is reached on any rank, so that all the
+  // ranks stop at the same iteration.
+  absl::StatusOr<bool> TimeLimitReached(const WallTimer& timer);
+
+  const LpBlock& block_;
+  const PrimalDualHybridGradientParams& params_;
+  Communicator& communicator_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+  // Shards the owned variables, with the mass of `constraint_matrix_columns`.
+  Sharder primal_sharder_;
+  // Shards the owned constraints, with the mass of
+  // `transposed_constraint_matrix_rows`.
+  Sharder dual_sharder_;
+  // The owned slices of the current iterate, and of K^T times the whole
+  // current dual solution.
+  VectorXd current_primal_solution_;
+  VectorXd current_dual_solution_;
+  VectorXd current_dual_product_;
+  // The owned slices of the iterate at the last major iteration.
+  VectorXd last_primal_start_point_;
+  VectorXd last_dual_start_point_;
+  double step_size_ = 0.0;
+  double primal_weight_ = 0.0;
+  int iterations_completed_ = 0;
+  int num_rejected_steps_ = 0;
+};
+
+int NumThreads(const PrimalDualHybridGradientParams& params) {
+  return std::max(1, params.num_threads());
+}
+
+int NumShards(const PrimalDualHybridGradientParams& params) {
+  if (params.num_shards() > 0) return params.num_shards();
+  return NumThreads(params) == 1 ? 1 : 4 * NumThreads(params);
+}
+
+DistributedSolver::DistributedSolver(
+    const LpBlock& block, const PrimalDualHybridGradientParams& params,
+    Communicator& communicator)
+    : block_(block),
+      params_(params),
+      communicator_(communicator),
+      thread_pool_(NumThreads(params) == 1
+                       ? nullptr
+                       : std::make_unique<ThreadPool>("DistributedPDLP",
+                                                      NumThreads(params))),
+      primal_sharder_(block.constraint_matrix_columns, NumShards(params),
+                      thread_pool_.get()),
+      dual_sharder_(block.transposed_constraint_matrix_rows, NumShards(params),
+                    thread_pool_.get()),
+      // Like `PreprocessSolver::PreprocessAndSolve()`, starts from zero
+      // projected on the variable bounds. Zero is within the dual bounds.
+      current_primal_solution_(
+          VectorXd::Zero(block.objective_vector.size())
+              .cwiseMin(block.variable_upper_bounds)
+              .cwiseMax(block.variable_lower_bounds)),
+      current_dual_solution_(
+          VectorXd::Zero(block.constraint_lower_bounds.size())),
+      current_dual_product_(VectorXd::Zero(block.objective_vector.size())),
+      last_primal_start_point_(current_primal_solution_),
+      last_dual_start_point_(current_dual_solution_) {
+  if (thread_pool_ != nullptr) thread_pool_->StartWorkers();
+}
+
+absl::StatusOr<QuadraticProgramBoundNorms> DistributedSolver::Initialize() {
+  double sums[] = {
+      SquaredNorm(block_.objective_vector, primal_sharder_),
+      dual_sharder_.ParallelSumOverShards([&](const Sharder::Shard& shard) {
+        const auto lower_bounds = shard(block_.constraint_lower_bounds);
+        const auto upper_bounds = shard(block_.constraint_upper_bounds);
+        double sum = 0.0;
+        for (int64_t i = 0; i < lower_bounds.size(); ++i) {
+          const double bound = CombinedBound(lower_bounds[i], upper_bounds[i]);
+          sum += bound * bound;
+        }
+        return sum;
+      })};
+  double maxima[] = {
+      LInfNorm(block_.objective_vector, primal_sharder_),
+      0.0,
+      0.0,
+  };
+  for (int64_t i = 0; i < block_.constraint_lower_bounds.size(); ++i) {
+    maxima[1] = std::max(maxima[1],
+                         CombinedBound(block_.constraint_lower_bounds[i],
+                                       block_.constraint_upper_bounds[i]));
+  }
+  // Each non-zero of the constraint matrix is in exactly one column block.
+  for (int64_t col = 0; col < block_.constraint_matrix_columns.outerSize();
+       ++col) {
+    for (decltype(block_.constraint_matrix_columns)::InnerIterator it(
+             block_.constraint_matrix_columns, col);
+         it; ++it) {
+      maxima[2] = std::max(maxima[2], std::abs(it.value()));
+    }
+  }
+  RETURN_IF_ERROR(communicator_.AllReduce(ReductionOp::kSum, sums));
+  RETURN_IF_ERROR(communicator_.AllReduce(ReductionOp::kMax, maxima));
+  const QuadraticProgramBoundNorms bound_norms = {
+      .l2_norm_primal_linear_objective = std::sqrt(sums[0]),
+      .l2_norm_constraint_bounds = std::sqrt(sums[1]),
+      .l_inf_norm_primal_linear_objective = maxima[0],
+      .l_inf_norm_constraint_bounds = maxima[1]};
+
+  // See `PreprocessSolver::PreprocessSolver()` and
+  // `PreprocessSolver::InitialPrimalWeight()`.
+  step_size_ = params_.initial_step_size_scaling() /
+               std::max(1.0e-20, /*constraint_matrix_abs_max=*/maxima[2]);
+  if (params_.has_initial_primal_weight()) {
+    primal_weight_ = params_.initial_primal_weight();
+  } else if (bound_norms.l2_norm_primal_linear_objective > 0.0 &&
+             bound_norms.l2_norm_constraint_bounds > 0.0) {
+    primal_weight_ = bound_norms.l2_norm_primal_linear_objective /
+                     bound_norms.l2_norm_constraint_bounds;
+  } else {
+    primal_weight_ = 1.0;
+  }
+  return bound_norms;
+}
+
+DistributedSolver::NextSolutionAndDelta
+DistributedSolver::ComputeNextPrimalSolution(
+    const double primal_step_size, VectorXd& extrapolated_primal) const {
+  const int64_t primal_size = current_primal_solution_.size();
+  NextSolutionAndDelta result = {
+      .value = VectorXd(primal_size),
+      .delta = VectorXd(primal_size),
+  };
+  extrapolated_primal.resize(primal_size);
+  // See `Solver::ComputeNextPrimalSolution()` for the LP case.
+  result.delta_squared_norm =
+      primal_sharder_.ParallelSumOverShards([&](const Sharder::Shard& shard) {
+        auto value = shard(result.value);
+        auto delta = shard(result.delta);
+        const auto current = shard(current_primal_solution_);
+        value = (current - primal_step_size * (shard(block_.objective_vector) -
+                                               shard(current_dual_product_)))
+                    .cwiseMin(shard(block_.variable_upper_bounds))
+                    .cwiseMax(shard(block_.variable_lower_bounds));
+        delta = value - current;
+        shard(extrapolated_primal) = value + delta;
+        return delta.squaredNorm();
+      });
+  return result;
+}
+
+DistributedSolver::NextSolutionAndDelta
+DistributedSolver::ComputeNextDualSolution(
+    const double dual_step_size, const VectorXd& extrapolated_primal) const {
+  const int64_t dual_size = current_dual_solution_.size();
+  NextSolutionAndDelta result = {
+      .value = VectorXd(dual_size),
+      .delta = VectorXd(dual_size),
+  };
+  const VectorXd activities = TransposedMatrixVectorProduct(
+      block_.transposed_constraint_matrix_rows, extrapolated_primal,
+      dual_sharder_);
+  // See `Solver::ComputeNextDualSolution()`.
+  result.delta_squared_norm =
+      dual_sharder_.ParallelSumOverShards([&](const Sharder::Shard& shard) {
+        auto value = shard(result.value);
+        auto delta = shard(result.delta);
+        const auto current = shard(current_dual_solution_);
+        const VectorXd temp = current - dual_step_size * shard(activities);
+        value = VectorXd::Zero(temp.size())
+                    .cwiseMin(temp + dual_step_size *
+                                         shard(block_.constraint_upper_bounds))
+                    .cwiseMax(temp + dual_step_size *
+                                         shard(block_.constraint_lower_bounds));
+        delta = value - current;
+        return delta.squaredNorm();
+      });
+  return result;
+}
+
+absl::StatusOr<bool> DistributedSolver::TakeAdaptiveStep() {
+  for (int inner_iterations = 0;; ++inner_iterations) {
+    if (inner_iterations >= kMaxInnerIterations) return true;
+    const double primal_step_size = step_size_ / primal_weight_;
+    const double dual_step_size = step_size_ * primal_weight_;
+    VectorXd local_extrapolated_primal;
+    NextSolutionAndDelta next_primal_solution =
+        ComputeNextPrimalSolution(primal_step_size, local_extrapolated_primal);
+    ASSIGN_OR_RETURN(
+        const VectorXd extrapolated_primal,
+        AllGatherVector(local_extrapolated_primal, communicator_));
+    NextSolutionAndDelta next_dual_solution =
+        ComputeNextDualSolution(dual_step_size, extrapolated_primal);
+    ASSIGN_OR_RETURN(const VectorXd next_dual,
+                     AllGatherVector(next_dual_solution.value, communicator_));
+    ProductChange dual_product_change;
+    VectorXd next_dual_product = TransposedMatrixVectorProductAndChange(
+        block_.constraint_matrix_columns, next_dual, current_dual_product_,
+        next_primal_solution.delta, primal_sharder_, dual_product_change);
+    // The movement and the nonlinearity of the whole LP, which are all that
+    // the step size rule needs.
+    double sums[] = {next_primal_solution.delta_squared_norm,
+                     next_dual_solution.delta_squared_norm,
+                     -dual_product_change.direction_dot_change};
+    RETURN_IF_ERROR(communicator_.AllReduce(ReductionOp::kSum, sums));
+    const double movement =
+        (0.5 * primal_weight_) * sums[0] + (0.5 / primal_weight_) * sums[1];
+    const double nonlinearity = sums[2];
+    if (movement == 0.0 || movement > kDivergentMovement) return true;
+
+    // The rest is the same as in `Solver::TakeAdaptiveStep()`.
+    const double step_size_limit =
+        nonlinearity > 0 ? movement / nonlinearity
+                         : std::numeric_limits<double>::infinity();
+    const bool accepted_step = step_size_ <= step_size_limit;
+    if (accepted_step) {
+      current_primal_solution_ = std::move(next_primal_solution.value);
+      current_dual_solution_ = std::move(next_dual_solution.value);
+      current_dual_product_ = std::move(next_dual_product);
+    }
+    const double total_steps_attempted =
+        num_rejected_steps_ + inner_iterations + iterations_completed_ + 1;
+    const double first_term =
+        std::isinf(step_size_limit)
+            ? step_size_limit
+            : (1 - std::pow(total_steps_attempted + 1.0,
+                            -params_.adaptive_linesearch_parameters()
+                                 .step_size_reduction_exponent())) *
+                  step_size_limit;
+    const double second_term =
+        (1 + std::pow(total_steps_attempted + 1.0,
+                      -params_.adaptive_linesearch_parameters()
+                           .step_size_growth_exponent())) *
+        step_size_;
+    step_size_ = std::min(first_term, second_term);
+    if (accepted_step) {
+      num_rejected_steps_ += inner_iterations;
+      return false;
+    }
+  }
+}
+
+absl::Status DistributedSolver::UpdatePrimalWeight() {
+  double sums[] = {SquaredDistance(current_primal_solution_,
+                                   last_primal_start_point_, primal_sharder_),
+                   SquaredDistance(current_dual_solution_,
+                                   last_dual_start_point_, dual_sharder_)};
+  RETURN_IF_ERROR(communicator_.AllReduce(ReductionOp::kSum, sums));
+  // See `Solver::ComputeNewPrimalWeight()`.
+  const double primal_distance = std::sqrt(sums[0]);
+  const double dual_distance = std::sqrt(sums[1]);
+  constexpr double kNonzeroTol = 1.0e-10;
+  if (primal_distance > kNonzeroTol && primal_distance < 1.0 / kNonzeroTol &&
+      dual_distance > kNonzeroTol && dual_distance < 1.0 / kNonzeroTol) {
+    const double smoothing_param = params_.primal_weight_update_smoothing();
+    primal_weight_ =
+        std::exp(smoothing_param * std::log(dual_distance / primal_distance) +
+                 (1.0 - smoothing_param) * std::log(primal_weight_));
+  }
+  last_primal_start_point_ = current_primal_solution_;
+  last_dual_start_point_ = current_dual_solution_;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<ConvergenceInformation>
+DistributedSolver::ComputeConvergenceInformation() {
+  ASSIGN_OR_RETURN(const VectorXd primal_solution,
+                   AllGatherVector(current_primal_solution_, communicator_));
+  const VectorXd activities = TransposedMatrixVectorProduct(
+      block_.transposed_constraint_matrix_rows, primal_solution,
+      dual_sharder_);
+  // See `ComputeConvergenceInformation()` in iteration_stats.cc. The sums are
+  // the squared primal residual norm, the squared dual residual norm, the
+  // primal objective and the dual objective, and the maxima are the primal and
+  // dual residual infinity norms.
+  double sums[] = {0.0, 0.0, 0.0, 0.0};
+  double maxima[] = {0.0, 0.0};
+  for (int64_t i = 0; i < activities.size(); ++i) {
+    double residual = 0.0;
+    if (activities[i] > block_.constraint_upper_bounds[i]) {
+      residual = activities[i] - block_.constraint_upper_bounds[i];
+    } else if (activities[i] < block_.constraint_lower_bounds[i]) {
+      residual = block_.constraint_lower_bounds[i] - activities[i];
+    }
+    sums[0] += residual * residual;
+    maxima[0] = std::max(maxima[0], residual);
+    // Can't use `.dot(.cwiseMin(...))` because that gives 0 * inf = NaN.
+    const double dual_value = current_dual_solution_[i];
+    if (dual_value > 0.0) {
+      sums[3] += block_.constraint_lower_bounds[i] * dual_value;
+    } else if (dual_value < 0.0) {
+      sums[3] += block_.constraint_upper_bounds[i] * dual_value;
+    }
+  }
+  for (int64_t j = 0; j < current_primal_solution_.size(); ++j) {
+    const double primal_value = current_primal_solution_[j];
+    sums[2] += block_.objective_vector[j] * primal_value;
+    const double reduced_cost =
+        block_.objective_vector[j] - current_dual_product_[j];
+    if (reduced_cost == 0.0) continue;
+    const ReducedCostBound bound = BoundForReducedCost(
+        params_, primal_value, reduced_cost, block_.variable_lower_bounds[j],
+        block_.variable_upper_bounds[j]);
+    sums[3] += bound.bound_for_objective * reduced_cost;
+    if (bound.is_residual) {
+      sums[1] += reduced_cost * reduced_cost;
+      maxima[1] = std::max(maxima[1], std::abs(reduced_cost));
+    }
+  }
+  RETURN_IF_ERROR(communicator_.AllReduce(ReductionOp::kSum, sums));
+  RETURN_IF_ERROR(communicator_.AllReduce(ReductionOp::kMax, maxima));
+
+  auto apply_scaling_and_offset = [this](const double objective) {
+    return block_.objective_scaling_factor *
+           (objective + block_.objective_offset);
+  };
+  ConvergenceInformation result;
+  result.set_candidate_type(POINT_TYPE_CURRENT_ITERATE);
+  result.set_l2_primal_residual(std::sqrt(sums[0]));
+  result.set_l_inf_primal_residual(maxima[0]);
+  result.set_l2_dual_residual(std::sqrt(sums[1]));
+  result.set_l_inf_dual_residual(maxima[1]);
+  result.set_primal_objective(apply_scaling_and_offset(sums[2]));
+  result.set_dual_objective(apply_scaling_and_offset(sums[3]));
+  return result;
+}
+
+absl::StatusOr<bool> DistributedSolver::TimeLimitReached(
+    const WallTimer& timer) {
+  const double time_sec_limit =
+      params_.termination_criteria().time_sec_limit();
+  // All the ranks have the same `params_`, so they agree on skipping the
+  // reduction.
+  if (!std::isfinite(time_sec_limit)) return false;
+  double reached[] = {timer.Get() >= time_sec_limit ? 1.0 : 0.0};
+  RETURN_IF_ERROR(communicator_.AllReduce(ReductionOp::kMax, reached));
+  return reached[0] > 0.0;
+}
+
+absl::StatusOr<DistributedSolverResult> DistributedSolver::Solve() {
+  WallTimer timer;
+  timer.Start();
+  ASSIGN_OR_RETURN(const QuadraticProgramBoundNorms bound_norms, Initialize());
+  const TerminationCriteria& criteria = params_.termination_criteria();
+  const TerminationCriteria::DetailedOptimalityCriteria optimality_criteria =
+      EffectiveOptimalityCriteria(criteria);
+  DistributedSolverResult result;
+  bool force_numerical_termination = false;
+  while (true) {
+    const bool iteration_limit_reached =
+        iterations_completed_ >= criteria.iteration_limit();
+    // The termination checks and the major iterations are at the same
+    // iterations as in `Solver::MajorIterationAndTerminationCheck()`.
+    const int major_iteration_cycle =
+        iterations_completed_ % params_.major_iteration_frequency();
+    if (major_iteration_cycle % params_.termination_check_frequency() == 0 ||
+        iteration_limit_reached || force_numerical_termination) {
+      ASSIGN_OR_RETURN(result.convergence_information,
+                       ComputeConvergenceInformation());
+      if (OptimalityCriteriaMet(optimality_criteria,
+                                result.convergence_information,
+                                criteria.optimality_norm(), bound_norms)) {
+        result.termination_reason = TERMINATION_REASON_OPTIMAL;
+      } else if (force_numerical_termination) {
+        result.termination_reason = TERMINATION_REASON_NUMERICAL_ERROR;
+      } else if (iteration_limit_reached) {
+        result.termination_reason = TERMINATION_REASON_ITERATION_LIMIT;
+      }
+      if (result.termination_reason != TERMINATION_REASON_UNSPECIFIED) break;
+      ASSIGN_OR_RETURN(const bool time_limit_reached, TimeLimitReached(timer));
+      if (time_limit_reached) {
+        result.termination_reason = TERMINATION_REASON_TIME_LIMIT;
+        break;
+      }
+    }
+    if (major_iteration_cycle == 0 && iterations_completed_ > 0) {
+      RETURN_IF_ERROR(UpdatePrimalWeight());
+    }
+    // Like in `Solver::Solve()`, a step that forces a numerical termination
+    // also counts as an iteration.
+    ASSIGN_OR_RETURN(force_numerical_termination, TakeAdaptiveStep());
+    ++iterations_completed_;
+  }
+  result.primal_solution = std::move(current_primal_solution_);
+  result.dual_solution = std::move(current_dual_solution_);
+  result.iteration_count = iterations_completed_;
+  return result;
+}
+
+}  // namespace
+
+std::vector<int64_t> EvenBlockStarts(const int64_t size, const int num_blocks) {
+  CHECK_GE(size, 0);
+  CHECK_GE(num_blocks, 1);
+  std::vector<int64_t> starts(num_blocks + 1);
+  for (int block = 0; block <= num_blocks; ++block) {
+    starts[block] = size / num_blocks * block +
+                    std::min<int64_t>(block, size % num_blocks);
+  }
+  return starts;
+}
+
+LpBlock ExtractLpBlock(const QuadraticProgram& lp,
+                       absl::Span<const int64_t> variable_starts,
+                       absl::Span<const int64_t> constraint_starts,
+                       const int rank) {
+  CHECK(IsLinearProgram(lp));
+  CHECK_EQ(variable_starts.size(), constraint_starts.size());
+  CHECK_GE(rank, 0);
+  CHECK_LT(rank + 1, variable_starts.size());
+  CHECK_EQ(variable_starts.back(), lp.variable_lower_bounds.size());
+  CHECK_EQ(constraint_starts.back(), lp.constraint_lower_bounds.size());
+  const int64_t first_variable = variable_starts[rank];
+  const int64_t num_owned_variables =
+      variable_starts[rank + 1] - first_variable;
+  const int64_t first_constraint = constraint_starts[rank];
+  const int64_t num_owned_constraints =
+      constraint_starts[rank + 1] - first_constraint;
+  CHECK_GE(num_owned_variables, 0);
+  CHECK_GE(num_owned_constraints, 0);
+
+  LpBlock block;
+  block.num_variables = lp.variable_lower_bounds.size();
+  block.num_constraints = lp.constraint_lower_bounds.size();
+  block.first_variable = first_variable;
+  block.first_constraint = first_constraint;
+  block.objective_vector =
+      lp.objective_vector.segment(first_variable, num_owned_variables);
+  block.variable_lower_bounds =
+      lp.variable_lower_bounds.segment(first_variable, num_owned_variables);
+  block.variable_upper_bounds =
+      lp.variable_upper_bounds.segment(first_variable, num_owned_variables);
+  block.constraint_lower_bounds =
+      lp.constraint_lower_bounds.segment(first_constraint,
+                                         num_owned_constraints);
+  block.constraint_upper_bounds =
+      lp.constraint_upper_bounds.segment(first_constraint,
+                                         num_owned_constraints);
+  block.constraint_matrix_columns =
+      ColumnBlock(lp.constraint_matrix, first_variable, num_owned_variables);
+  const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>
+      transposed_constraint_matrix = lp.constraint_matrix.transpose();
+  block.transposed_constraint_matrix_rows = ColumnBlock(
+      transposed_constraint_matrix, first_constraint, num_owned_constraints);
+  block.objective_offset = lp.objective_offset;
+  block.objective_scaling_factor = lp.objective_scaling_factor;
+  return block;
+}
+
+absl::StatusOr<DistributedSolverResult> DistributedPrimalDualHybridGradient(
+    const LpBlock& block, const PrimalDualHybridGradientParams& params,
+    Communicator& communicator) {
+  RETURN_IF_ERROR(CheckSupportedParams(params));
+  if (block.objective_vector.size() != block.variable_lower_bounds.size() ||
+      block.objective_vector.size() != block.variable_upper_bounds.size() ||
+      block.objective_vector.size() != block.constraint_matrix_columns.cols() ||
+      block.constraint_lower_bounds.size() !=
+          block.constraint_upper_bounds.size() ||
+      block.constraint_lower_bounds.size() !=
+          block.transposed_constraint_matrix_rows.cols() ||
+      block.constraint_matrix_columns.rows() != block.num_constraints ||
+      block.transposed_constraint_matrix_rows.rows() != block.num_variables) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("inconsistent LpBlock sizes on rank ",
+                     communicator.Rank()));
+  }
+  DistributedSolver solver(block, params, communicator);
+  return solver.Solve();
+}
+
+}  // namespace operations_research::pdlp
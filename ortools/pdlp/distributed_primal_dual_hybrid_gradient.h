@@ -0,0 +1,125 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PDLP_DISTRIBUTED_PRIMAL_DUAL_HYBRID_GRADIENT_H_
+#define PDLP_DISTRIBUTED_PRIMAL_DUAL_HYBRID_GRADIENT_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/SparseCore"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ortools/pdlp/communicator.h"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/pdlp/solve_log.pb.h"
+#include "ortools/pdlp/solvers.pb.h"
+
+namespace operations_research::pdlp {
+
+// The part of an LP owned by one rank of a `Communicator`. The variables and
+// the constraints are split in contiguous ranges, one per rank; the rank owns
+// the objective and bounds of its variables and constraints, the columns of the
+// constraint matrix of its variables, and the rows of the constraint matrix of
+// its constraints. Each non-zero of the constraint matrix is thus stored twice
+// in the group, once in a column block and once in a row block, like
+// `ShardedQuadraticProgram` stores the matrix and its transpose.
+struct LpBlock {
+  // The sizes of the whole LP.
+  int64_t num_variables = 0;
+  int64_t num_constraints = 0;
+  // The global index of the first owned variable and constraint.
+  int64_t first_variable = 0;
+  int64_t first_constraint = 0;
+
+  // The entries of the owned variables.
+  Eigen::VectorXd objective_vector;
+  Eigen::VectorXd variable_lower_bounds;
+  Eigen::VectorXd variable_upper_bounds;
+  // The entries of the owned constraints.
+  Eigen::VectorXd constraint_lower_bounds;
+  Eigen::VectorXd constraint_upper_bounds;
+  // The columns of the owned variables: a `num_constraints` by
+  // `objective_vector.size()` matrix.
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>
+      constraint_matrix_columns;
+  // The transpose of the rows of the owned constraints: a `num_variables` by
+  // `constraint_lower_bounds.size()` matrix.
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>
+      transposed_constraint_matrix_rows;
+
+  // The same on all ranks. See `QuadraticProgram`.
+  double objective_offset = 0.0;
+  double objective_scaling_factor = 1.0;
+};
+
+// Returns `num_blocks + 1` block starts that split `size` elements in
+// contiguous blocks whose sizes differ by at most one.
+std::vector<int64_t> EvenBlockStarts(int64_t size, int num_blocks);
+
+// Extracts the block of `lp` owned by `rank`. The variables owned by rank `r`
+// are [`variable_starts[r]`, `variable_starts[r + 1]`), and likewise for the
+// constraints; both spans have one more entry than the number of ranks, start
+// at 0 and end at the size of `lp`. `lp` must be a linear program.
+//
+// This is meant for tests and for processes that have the whole LP in memory
+// anyway; a real distributed setup builds its `LpBlock` from its own part of
+// the data.
+LpBlock ExtractLpBlock(const QuadraticProgram& lp,
+                       absl::Span<const int64_t> variable_starts,
+                       absl::Span<const int64_t> constraint_starts, int rank);
+
+struct DistributedSolverResult {
+  // The entries of the owned variables and constraints of the last iterate.
+  Eigen::VectorXd primal_solution;
+  Eigen::VectorXd dual_solution;
+  TerminationReason termination_reason = TERMINATION_REASON_UNSPECIFIED;
+  int iteration_count = 0;
+  // The convergence information of the last iterate, for the whole LP. The
+  // componentwise residuals are not computed.
+  ConvergenceInformation convergence_information;
+};
+
+// Solves an LP with PDHG, with each rank of `communicator` owning a block of
+// the LP. All the ranks must call this function with their block and the same
+// `params`. The iterations are those of `PrimalDualHybridGradient()` with the
+// adaptive linesearch rule on the unpresolved, unscaled LP and without
+// restarts, up to the rounding of the sums that are split across ranks: the
+// result doesn't depend on the timing of the ranks, and the ranks always agree
+// on the step sizes and on the termination.
+//
+// Each iteration exchanges the owned slices of the extrapolated primal
+// solution and of the dual solution, and one reduction of three scalars. The
+// termination criteria are checked on the current iterate at the same
+// iterations as in `PrimalDualHybridGradient()`, with one more exchange of the
+// primal slices and two reductions. The primal weight is updated every
+// `params.major_iteration_frequency()` iterations, with one more reduction.
+//
+// Only a subset of `params` is supported: the `linesearch_rule` must be
+// `ADAPTIVE_LINESEARCH_RULE`, the `restart_strategy` must be `NO_RESTARTS`,
+// and presolve, rescaling (`l_inf_ruiz_iterations` and `l2_norm_rescaling`),
+// `use_float_transposed_constraint_matrix`, feasibility polishing and the
+// componentwise optimality norm return an `InvalidArgumentError`. Of the
+// termination criteria, the optimality criteria, the iteration limit and the
+// time limit are checked. The time limit is checked with the termination
+// criteria, and is reached as soon as it is reached on one rank, so that all
+// the ranks stop at the same iteration. `num_threads` and `num_shards` apply
+// to each rank.
+absl::StatusOr<DistributedSolverResult> DistributedPrimalDualHybridGradient(
+    const LpBlock& block, const PrimalDualHybridGradientParams& params,
+    Communicator& communicator);
+
+}  // namespace operations_research::pdlp
+
+#endif  // PDLP_DISTRIBUTED_PRIMAL_DUAL_HYBRID_GRADIENT_H_
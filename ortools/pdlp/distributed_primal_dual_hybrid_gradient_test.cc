@@ -0,0 +1,369 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/pdlp/distributed_primal_dual_hybrid_gradient.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "Eigen/Core"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ortools/pdlp/communicator.h"
+#include "ortools/pdlp/iteration_stats.h"
+#include "ortools/pdlp/primal_dual_hybrid_gradient.h"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/pdlp/solve_log.pb.h"
+#include "ortools/pdlp/solvers.pb.h"
+#include "ortools/pdlp/termination.h"
+#include "ortools/pdlp/test_util.h"
+
+namespace operations_research::pdlp {
+namespace {
+
+using ::Eigen::VectorXd;
+using ::testing::DoubleNear;
+using ::testing::ElementsAre;
+
+PrimalDualHybridGradientParams TestParams() {
+  PrimalDualHybridGradientParams params;
+  params.mutable_termination_criteria()
+      ->mutable_simple_optimality_criteria()
+      ->set_eps_optimal_relative(0.0);
+  params.mutable_termination_criteria()
+      ->mutable_simple_optimality_criteria()
+      ->set_eps_optimal_absolute(1.0e-6);
+  params.mutable_termination_criteria()->set_iteration_limit(2000);
+  params.mutable_presolve_options()->set_use_glop(false);
+  params.set_restart_strategy(PrimalDualHybridGradientParams::NO_RESTARTS);
+  params.set_l_inf_ruiz_iterations(0);
+  params.set_l2_norm_rescaling(false);
+  return params;
+}
+
+// The results of all the ranks, with the owned slices concatenated.
+struct GlobalResult {
+  std::vector<DistributedSolverResult> rank_results;
+  VectorXd primal_solution;
+  VectorXd dual_solution;
+};
+
+GlobalResult SolveWithInProcessRanks(
+    const QuadraticProgram& lp, const int num_ranks,
+    const PrimalDualHybridGradientParams& params) {
+  const std::vector<int64_t> variable_starts =
+      EvenBlockStarts(lp.variable_lower_bounds.size(), num_ranks);
+  const std::vector<int64_t> constraint_starts =
+      EvenBlockStarts(lp.constraint_lower_bounds.size(), num_ranks);
+  InProcessCommunicatorGroup group(num_ranks);
+  GlobalResult result;
+  result.rank_results.resize(num_ranks);
+  std::vector<std::thread> threads;
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    threads.emplace_back([&, rank]() {
+      const LpBlock block =
+          ExtractLpBlock(lp, variable_starts, constraint_starts, rank);
+      absl::StatusOr<DistributedSolverResult> rank_result =
+          DistributedPrimalDualHybridGradient(block, params, group.Get(rank));
+      ASSERT_TRUE(rank_result.ok()) << rank_result.status();
+      result.rank_results[rank] = *std::move(rank_result);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  result.primal_solution.resize(lp.variable_lower_bounds.size());
+  result.dual_solution.resize(lp.constraint_lower_bounds.size());
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    const DistributedSolverResult& rank_result = result.rank_results[rank];
+    result.primal_solution.segment(variable_starts[rank],
+                                   rank_result.primal_solution.size()) =
+        rank_result.primal_solution;
+    result.dual_solution.segment(constraint_starts[rank],
+                                 rank_result.dual_solution.size()) =
+        rank_result.dual_solution;
+  }
+  return result;
+}
+
+TEST(EvenBlockStartsTest, SplitsRemainderOnFirstBlocks) {
+  EXPECT_THAT(EvenBlockStarts(7, 3), ElementsAre(0, 3, 5, 7));
+  EXPECT_THAT(EvenBlockStarts(2, 3), ElementsAre(0, 1, 2, 2));
+  EXPECT_THAT(EvenBlockStarts(0, 2), ElementsAre(0, 0, 0));
+}
+
+TEST(ExtractLpBlockTest, TinyLp) {
+  const QuadraticProgram lp = TinyLp();
+  const LpBlock block = ExtractLpBlock(lp, /*variable_starts=*/{0, 1, 4},
+                                       /*constraint_starts=*/{0, 2, 3},
+                                       /*rank=*/1);
+  EXPECT_EQ(block.num_variables, 4);
+  EXPECT_EQ(block.num_constraints, 3);
+  EXPECT_EQ(block.first_variable, 1);
+  EXPECT_EQ(block.first_constraint, 2);
+  EXPECT_THAT(block.objective_vector, ElementsAre(2, 1, 1));
+  EXPECT_THAT(block.variable_upper_bounds, ElementsAre(4, 6, 3));
+  EXPECT_THAT(block.constraint_lower_bounds, ElementsAre(1));
+  EXPECT_THAT(ToDense(block.constraint_matrix_columns),
+              EigenArrayEq<double>({{1, 1, 2}, {0, 1, 0}, {0, 1, -1}}));
+  EXPECT_THAT(ToDense(block.transposed_constraint_matrix_rows),
+              EigenArrayEq<double>({{0}, {0}, {1}, {-1}}));
+  EXPECT_EQ(block.objective_offset, lp.objective_offset);
+}
+
+TEST(DistributedPrimalDualHybridGradientTest, SolvesTinyLpOnOneRank) {
+  const GlobalResult result =
+      SolveWithInProcessRanks(TinyLp(), /*num_ranks=*/1, TestParams());
+  const DistributedSolverResult& rank_result = result.rank_results[0];
+  EXPECT_EQ(rank_result.termination_reason, TERMINATION_REASON_OPTIMAL);
+  EXPECT_THAT(result.primal_solution,
+              EigenArrayNear<double>({1, 0, 6, 2}, 1.0e-4));
+  EXPECT_THAT(result.dual_solution,
+              EigenArrayNear<double>({0.5, 4.0, 0.0}, 1.0e-4));
+  EXPECT_NEAR(rank_result.convergence_information.primal_objective(), -1.0,
+              1.0e-4);
+  EXPECT_NEAR(rank_result.convergence_information.dual_objective(), -1.0,
+              1.0e-4);
+}
+
+class DistributedPrimalDualHybridGradientRanksTest
+    : public testing::TestWithParam<int> {};
+
+// The iterates on several ranks are those on one rank up to the rounding of the
+// split reductions. Since the rounding differences are amplified by the step
+// size choices, only a limited number of iterations is compared.
+TEST_P(DistributedPrimalDualHybridGradientRanksTest, MatchesOneRank) {
+  const int num_ranks = GetParam();
+  PrimalDualHybridGradientParams params = TestParams();
+  params.mutable_termination_criteria()
+      ->mutable_simple_optimality_criteria()
+      ->set_eps_optimal_absolute(0.0);
+  params.mutable_termination_criteria()->set_iteration_limit(50);
+  for (const QuadraticProgram& lp :
+       {TinyLp(), CorrelationClusteringLp(), TestLp()}) {
+    const GlobalResult reference =
+        SolveWithInProcessRanks(lp, /*num_ranks=*/1, params);
+    const GlobalResult result = SolveWithInProcessRanks(lp, num_ranks, params);
+    const DistributedSolverResult& reference_result = reference.rank_results[0];
+    const ConvergenceInformation& reference_information =
+        reference_result.convergence_information;
+    for (const DistributedSolverResult& rank_result : result.rank_results) {
+      EXPECT_EQ(rank_result.termination_reason,
+                reference_result.termination_reason);
+      EXPECT_EQ(rank_result.iteration_count, reference_result.iteration_count);
+      EXPECT_THAT(rank_result.convergence_information.primal_objective(),
+                  DoubleNear(reference_information.primal_objective(),
+                             1.0e-9));
+      EXPECT_THAT(rank_result.convergence_information.dual_objective(),
+                  DoubleNear(reference_information.dual_objective(), 1.0e-9));
+    }
+    EXPECT_THAT(result.primal_solution,
+                EigenArrayNear(reference.primal_solution, 1.0e-9));
+    EXPECT_THAT(result.dual_solution,
+                EigenArrayNear(reference.dual_solution, 1.0e-9));
+  }
+}
+
+TEST_P(DistributedPrimalDualHybridGradientRanksTest, SolvesTestLp) {
+  const GlobalResult result =
+      SolveWithInProcessRanks(TestLp(), GetParam(), TestParams());
+  for (const DistributedSolverResult& rank_result : result.rank_results) {
+    EXPECT_EQ(rank_result.termination_reason, TERMINATION_REASON_OPTIMAL);
+  }
+  EXPECT_THAT(result.primal_solution,
+              EigenArrayNear<double>({-1, 8, 1, 2.5}, 1.0e-4));
+  EXPECT_THAT(result.dual_solution,
+              EigenArrayNear<double>({-2, 0, 2.375, 2.0 / 3}, 1.0e-4));
+}
+
+INSTANTIATE_TEST_SUITE_P(NumRanks,
+                         DistributedPrimalDualHybridGradientRanksTest,
+                         testing::Values(2, 3, 5));
+
+class DistributedPrimalDualHybridGradientSingleProcessTest
+    : public testing::TestWithParam<int> {};
+
+// With the adaptive step size rule, no restarts and no rescaling, the iterates
+// are those of `PrimalDualHybridGradient()`, whose current iterate is recorded
+// at each termination check of a solve without optimality criteria. Since the
+// distributed solver only checks the current iterate, and not the average, it
+// stops at the first of these checks at which the current iterate is optimal.
+// On several ranks, the rounding differences of the split reductions are
+// amplified by the step size choices, so the iterates are only close.
+TEST_P(DistributedPrimalDualHybridGradientSingleProcessTest,
+       MatchesPrimalDualHybridGradient) {
+  const int num_ranks = GetParam();
+  const double tolerance = num_ranks == 1 ? 1.0e-9 : 1.0e-3;
+  const PrimalDualHybridGradientParams params = TestParams();
+  PrimalDualHybridGradientParams reference_params = params;
+  reference_params.mutable_termination_criteria()
+      ->mutable_simple_optimality_criteria()
+      ->set_eps_optimal_absolute(0.0);
+  reference_params.set_record_iteration_stats(true);
+  for (const QuadraticProgram& lp :
+       {TinyLp(), CorrelationClusteringLp(), TestLp()}) {
+    const SolverResult reference =
+        PrimalDualHybridGradient(lp, reference_params);
+    const QuadraticProgramBoundNorms bound_norms = BoundNormsFromProblemStats(
+        reference.solve_log.original_problem_stats());
+    std::optional<int> expected_iteration_count;
+    for (const IterationStats& stats : reference.solve_log.iteration_stats()) {
+      const std::optional<ConvergenceInformation> expected_information =
+          GetConvergenceInformation(stats, POINT_TYPE_CURRENT_ITERATE);
+      if (!expected_information.has_value() || stats.iteration_number() == 0) {
+        continue;
+      }
+      PrimalDualHybridGradientParams limited_params = reference_params;
+      limited_params.mutable_termination_criteria()->set_iteration_limit(
+          stats.iteration_number());
+      const GlobalResult result =
+          SolveWithInProcessRanks(lp, num_ranks, limited_params);
+      const ConvergenceInformation& information =
+          result.rank_results[0].convergence_information;
+      EXPECT_EQ(result.rank_results[0].iteration_count,
+                stats.iteration_number());
+      EXPECT_THAT(information.primal_objective(),
+                  DoubleNear(expected_information->primal_objective(),
+                             tolerance))
+          << stats.iteration_number();
+      EXPECT_THAT(information.dual_objective(),
+                  DoubleNear(expected_information->dual_objective(), tolerance))
+          << stats.iteration_number();
+      EXPECT_THAT(information.l2_primal_residual(),
+                  DoubleNear(expected_information->l2_primal_residual(),
+                             tolerance))
+          << stats.iteration_number();
+      EXPECT_THAT(information.l2_dual_residual(),
+                  DoubleNear(expected_information->l2_dual_residual(),
+                             tolerance))
+          << stats.iteration_number();
+
+      IterationStats current_iterate_stats = stats;
+      current_iterate_stats.clear_convergence_information();
+      current_iterate_stats.clear_infeasibility_information();
+      *current_iterate_stats.add_convergence_information() =
+          *expected_information;
+      const std::optional<TerminationReasonAndPointType> termination =
+          CheckIterateTerminationCriteria(params.termination_criteria(),
+                                          current_iterate_stats, bound_norms);
+      if (termination.has_value() &&
+          termination->reason == TERMINATION_REASON_OPTIMAL) {
+        expected_iteration_count = stats.iteration_number();
+        break;
+      }
+    }
+    ASSERT_TRUE(expected_iteration_count.has_value());
+
+    const GlobalResult result = SolveWithInProcessRanks(lp, num_ranks, params);
+    for (const DistributedSolverResult& rank_result : result.rank_results) {
+      EXPECT_EQ(rank_result.termination_reason, TERMINATION_REASON_OPTIMAL);
+      EXPECT_EQ(rank_result.iteration_count, *expected_iteration_count);
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(NumRanks,
+                         DistributedPrimalDualHybridGradientSingleProcessTest,
+                         testing::Values(1, 3));
+
+TEST(DistributedPrimalDualHybridGradientTest, IterationLimit) {
+  PrimalDualHybridGradientParams params = TestParams();
+  params.mutable_termination_criteria()->set_iteration_limit(10);
+  const GlobalResult result =
+      SolveWithInProcessRanks(TinyLp(), /*num_ranks=*/2, params);
+  for (const DistributedSolverResult& rank_result : result.rank_results) {
+    EXPECT_EQ(rank_result.termination_reason,
+              TERMINATION_REASON_ITERATION_LIMIT);
+    EXPECT_EQ(rank_result.iteration_count, 10);
+  }
+}
+
+TEST(DistributedPrimalDualHybridGradientTest, TimeLimit) {
+  PrimalDualHybridGradientParams params = TestParams();
+  params.mutable_termination_criteria()->set_time_sec_limit(0.0);
+  const GlobalResult result =
+      SolveWithInProcessRanks(TinyLp(), /*num_ranks=*/2, params);
+  for (const DistributedSolverResult& rank_result : result.rank_results) {
+    EXPECT_EQ(rank_result.termination_reason, TERMINATION_REASON_TIME_LIMIT);
+    EXPECT_EQ(rank_result.iteration_count, 0);
+  }
+}
+
+TEST(DistributedPrimalDualHybridGradientTest, RejectsUnsupportedParams) {
+  const QuadraticProgram lp = TinyLp();
+  const LpBlock block = ExtractLpBlock(lp, {0, 4}, {0, 3}, /*rank=*/0);
+  InProcessCommunicatorGroup group(1);
+  std::vector<PrimalDualHybridGradientParams> unsupported_params(6,
+                                                                 TestParams());
+  unsupported_params[0].set_linesearch_rule(
+      PrimalDualHybridGradientParams::MALITSKY_POCK_LINESEARCH_RULE);
+  unsupported_params[1].mutable_presolve_options()->set_use_glop(true);
+  unsupported_params[2].set_restart_strategy(
+      PrimalDualHybridGradientParams::ADAPTIVE_HEURISTIC);
+  unsupported_params[3].set_l_inf_ruiz_iterations(5);
+  unsupported_params[4].set_l2_norm_rescaling(true);
+  unsupported_params[5].set_use_float_transposed_constraint_matrix(true);
+  for (int i = 0; i < unsupported_params.size(); ++i) {
+    EXPECT_EQ(DistributedPrimalDualHybridGradient(block, unsupported_params[i],
+                                                  group.Get(0))
+                  .status()
+                  .code(),
+              absl::StatusCode::kInvalidArgument)
+        << "unsupported_params[" << i << "]";
+  }
+}
+
+#if !defined(_WIN32)
+TEST(DistributedPrimalDualHybridGradientTest, SolvesTinyLpOverUnixSockets) {
+  const QuadraticProgram lp = TinyLp();
+  const int num_ranks = 2;
+  const std::string socket_path =
+      absl::StrCat(::testing::TempDir(), "/distributed_pdhg.socket");
+  const std::vector<int64_t> variable_starts = EvenBlockStarts(4, num_ranks);
+  const std::vector<int64_t> constraint_starts = EvenBlockStarts(3, num_ranks);
+  std::vector<DistributedSolverResult> results(num_ranks);
+  std::vector<std::thread> threads;
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    threads.emplace_back([&, rank]() {
+      absl::StatusOr<std::unique_ptr<UnixSocketCommunicator>> communicator =
+          UnixSocketCommunicator::Create(socket_path, rank, num_ranks);
+      ASSERT_TRUE(communicator.ok()) << communicator.status();
+      const LpBlock block =
+          ExtractLpBlock(lp, variable_starts, constraint_starts, rank);
+      absl::StatusOr<DistributedSolverResult> result =
+          DistributedPrimalDualHybridGradient(block, TestParams(),
+                                              **communicator);
+      ASSERT_TRUE(result.ok()) << result.status();
+      results[rank] = *std::move(result);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  EXPECT_EQ(results[0].termination_reason, TERMINATION_REASON_OPTIMAL);
+  EXPECT_EQ(results[1].termination_reason, TERMINATION_REASON_OPTIMAL);
+  EXPECT_THAT(results[0].primal_solution,
+              EigenArrayNear<double>({1, 0}, 1.0e-4));
+  EXPECT_THAT(results[1].primal_solution,
+              EigenArrayNear<double>({6, 2}, 1.0e-4));
+  EXPECT_THAT(results[0].dual_solution,
+              EigenArrayNear<double>({0.5, 4.0}, 1.0e-4));
+  EXPECT_THAT(results[1].dual_solution, ElementsAre(DoubleNear(0.0, 1.0e-4)));
+}
+#endif  // !defined(_WIN32)
+
+}  // namespace
+}  // namespace operations_research::pdlp
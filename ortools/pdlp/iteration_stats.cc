@@ -73,9 +73,8 @@ ResidualNorms PrimalResidualNorms(
   CHECK_EQ(row_scaling_vec.size(), sharded_qp.DualSize());
   CHECK_EQ(scaled_primal_solution.size(), sharded_qp.PrimalSize());
 
-  VectorXd primal_product = TransposedMatrixVectorProduct(
-      sharded_qp.TransposedConstraintMatrix(), scaled_primal_solution,
-      sharded_qp.TransposedConstraintMatrixSharder());
+  VectorXd primal_product =
+      sharded_qp.ConstraintActivities(scaled_primal_solution);
   VectorXd local_l_inf_residual(sharded_qp.DualSharder().NumShards());
   VectorXd local_sumsq_residual(sharded_qp.DualSharder().NumShards());
   VectorXd local_l_inf_componentwise_residual(
@@ -0,0 +1,743 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/pdlp/presolve.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/SparseCore"
+#include "absl/hash/hash.h"
+#include "absl/log/check.h"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/pdlp/sharded_quadratic_program.h"
+#include "ortools/pdlp/sharder.h"
+#include "ortools/pdlp/solve_log.pb.h"
+
+namespace operations_research::pdlp {
+
+namespace {
+
+using ::Eigen::VectorXd;
+using SparseMatrix = Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>;
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+// The absolute tolerance (relative for values larger than one in absolute
+// value) used to compare bounds and activities.
+constexpr double kBoundTolerance = 1.0e-9;
+
+// The relative tolerance used to decide that two constraints are parallel.
+constexpr double kParallelTolerance = 1.0e-12;
+
+// Returns true if `a` is greater than `b` by more than the bound tolerance.
+bool Exceeds(const double a, const double b) {
+  if (!std::isfinite(b)) return a > b;
+  return a > b + kBoundTolerance * std::max(1.0, std::abs(b));
+}
+
+}  // namespace
+
+struct LpPresolver::WorkingLp {
+  explicit WorkingLp(const ShardedQuadraticProgram& sharded_lp)
+      : sharded_lp(sharded_lp),
+        matrix(sharded_lp.Qp().constraint_matrix),
+        transposed_matrix(sharded_lp.TransposedConstraintMatrix()),
+        objective_vector(sharded_lp.Qp().objective_vector),
+        variable_lower_bounds(sharded_lp.Qp().variable_lower_bounds),
+        variable_upper_bounds(sharded_lp.Qp().variable_upper_bounds),
+        constraint_lower_bounds(sharded_lp.Qp().constraint_lower_bounds),
+        constraint_upper_bounds(sharded_lp.Qp().constraint_upper_bounds),
+        objective_offset(sharded_lp.Qp().objective_offset),
+        variable_removed(sharded_lp.PrimalSize(), 0),
+        variable_changed(sharded_lp.PrimalSize(), 0),
+        variable_size(sharded_lp.PrimalSize(), 0),
+        constraint_removed(sharded_lp.DualSize(), 0),
+        constraint_size(sharded_lp.DualSize(), 0),
+        min_activity(sharded_lp.DualSize()),
+        max_activity(sharded_lp.DualSize()),
+        min_activity_infinities(sharded_lp.DualSize(), 0),
+        max_activity_infinities(sharded_lp.DualSize(), 0) {}
+
+  // Returns true if the entry of variable `column` with value `value` is in
+  // the LP.
+  bool VariableEntryInLp(const int64_t column, const double value) const {
+    return value != 0.0 && !variable_removed[column];
+  }
+  bool ConstraintEntryInLp(const int64_t row, const double value) const {
+    return value != 0.0 && !constraint_removed[row];
+  }
+
+  const ShardedQuadraticProgram& sharded_lp;
+  const SparseMatrix& matrix;
+  const SparseMatrix& transposed_matrix;
+  const VectorXd& objective_vector;
+  VectorXd variable_lower_bounds;
+  VectorXd variable_upper_bounds;
+  VectorXd constraint_lower_bounds;
+  VectorXd constraint_upper_bounds;
+  double objective_offset;
+
+  // The flags and counts are `char` and `int64_t` rather than `bool` so that
+  // different shards can write them concurrently.
+  std::vector<char> variable_removed;
+  // Set for the variables whose bounds changed since the constraint
+  // activities were computed, or that `RemoveFixedVariables()` is removing.
+  std::vector<char> variable_changed;
+  // The number of constraints of each variable, computed by
+  // `ReduceVariables()`.
+  std::vector<int64_t> variable_size;
+  std::vector<char> constraint_removed;
+
+  // Computed by `ReduceConstraints()`: the number of variables of each
+  // constraint, and the finite parts and the number of infinite terms of the
+  // smallest and largest activity allowed by the variable bounds.
+  std::vector<int64_t> constraint_size;
+  VectorXd min_activity;
+  VectorXd max_activity;
+  std::vector<int64_t> min_activity_infinities;
+  std::vector<int64_t> max_activity_infinities;
+};
+
+void LpPresolver::RemoveVariable(const int64_t column, WorkingLp& lp) {
+  lp.variable_removed[column] = 1;
+  variable_removal_step_[column] = static_cast<int64_t>(steps_.size()) - 1;
+}
+
+bool LpPresolver::RemoveFixedVariables(WorkingLp& lp) {
+  bool changed = false;
+  for (int64_t col = 0; col < num_variables_; ++col) {
+    if (lp.variable_removed[col] ||
+        lp.variable_lower_bounds[col] != lp.variable_upper_bounds[col]) {
+      continue;
+    }
+    const double value = lp.variable_lower_bounds[col];
+    steps_.push_back({.type = PostsolveStep::Type::kFixedVariable,
+                      .column = col,
+                      .value = value});
+    lp.objective_offset += lp.objective_vector[col] * value;
+    RemoveVariable(col, lp);
+    lp.variable_changed[col] = 1;
+    changed = true;
+  }
+  if (!changed) return false;
+  const Sharder& sharder = lp.sharded_lp.TransposedConstraintMatrixSharder();
+  sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = sharder.ShardStart(shard.Index());
+    const int64_t shard_end = shard_start + sharder.ShardSize(shard.Index());
+    for (int64_t row = shard_start; row < shard_end; ++row) {
+      if (lp.constraint_removed[row]) continue;
+      double shift = 0.0;
+      for (SparseMatrix::InnerIterator it(lp.transposed_matrix, row); it;
+           ++it) {
+        if (lp.variable_changed[it.index()]) {
+          shift += it.value() * lp.variable_lower_bounds[it.index()];
+        }
+      }
+      lp.constraint_lower_bounds[row] -= shift;
+      lp.constraint_upper_bounds[row] -= shift;
+    }
+  });
+  std::fill(lp.variable_changed.begin(), lp.variable_changed.end(), 0);
+  return true;
+}
+
+bool LpPresolver::ReduceConstraints(WorkingLp& lp) {
+  const Sharder& sharder = lp.sharded_lp.TransposedConstraintMatrixSharder();
+  sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = sharder.ShardStart(shard.Index());
+    const int64_t shard_end = shard_start + sharder.ShardSize(shard.Index());
+    for (int64_t row = shard_start; row < shard_end; ++row) {
+      if (lp.constraint_removed[row]) continue;
+      int64_t size = 0;
+      double min_activity = 0.0;
+      double max_activity = 0.0;
+      int64_t min_activity_infinities = 0;
+      int64_t max_activity_infinities = 0;
+      for (SparseMatrix::InnerIterator it(lp.transposed_matrix, row); it;
+           ++it) {
+        const int64_t col = it.index();
+        const double coefficient = it.value();
+        if (!lp.VariableEntryInLp(col, coefficient)) continue;
+        ++size;
+        const double lower_term =
+            coefficient * (coefficient > 0.0 ? lp.variable_lower_bounds[col]
+                                             : lp.variable_upper_bounds[col]);
+        const double upper_term =
+            coefficient * (coefficient > 0.0 ? lp.variable_upper_bounds[col]
+                                             : lp.variable_lower_bounds[col]);
+        if (std::isinf(lower_term)) {
+          ++min_activity_infinities;
+        } else {
+          min_activity += lower_term;
+        }
+        if (std::isinf(upper_term)) {
+          ++max_activity_infinities;
+        } else {
+          max_activity += upper_term;
+        }
+      }
+      lp.constraint_size[row] = size;
+      lp.min_activity[row] = min_activity;
+      lp.max_activity[row] = max_activity;
+      lp.min_activity_infinities[row] = min_activity_infinities;
+      lp.max_activity_infinities[row] = max_activity_infinities;
+    }
+  });
+
+  bool changed = false;
+  for (int64_t row = 0; row < num_constraints_; ++row) {
+    if (lp.constraint_removed[row]) continue;
+    double& lower = lp.constraint_lower_bounds[row];
+    double& upper = lp.constraint_upper_bounds[row];
+    if (lp.constraint_size[row] == 0) {
+      if (Exceeds(lower, 0.0) || Exceeds(0.0, upper)) {
+        termination_ = TERMINATION_REASON_PRIMAL_OR_DUAL_INFEASIBLE;
+        return true;
+      }
+      lp.constraint_removed[row] = 1;
+      changed = true;
+      continue;
+    }
+    if (lower == -kInfinity && upper == kInfinity) {
+      lp.constraint_removed[row] = 1;
+      changed = true;
+      continue;
+    }
+    if (lp.constraint_size[row] == 1) {
+      SparseMatrix::InnerIterator it(lp.transposed_matrix, row);
+      while (!lp.VariableEntryInLp(it.index(), it.value())) ++it;
+      const int64_t col = it.index();
+      const double coefficient = it.value();
+      PostsolveStep step = {.type = PostsolveStep::Type::kSingletonConstraint,
+                            .row = row,
+                            .column = col,
+                            .coefficient = coefficient};
+      const double implied_lower =
+          (coefficient > 0.0 ? lower : upper) / coefficient;
+      const double implied_upper =
+          (coefficient > 0.0 ? upper : lower) / coefficient;
+      double& variable_lower = lp.variable_lower_bounds[col];
+      double& variable_upper = lp.variable_upper_bounds[col];
+      if (implied_lower > variable_lower) {
+        variable_lower = implied_lower;
+        step.lower_from_row = true;
+      }
+      if (implied_upper < variable_upper) {
+        variable_upper = implied_upper;
+        step.upper_from_row = true;
+      }
+      if (variable_lower > variable_upper) {
+        if (Exceeds(variable_lower, variable_upper)) {
+          termination_ = TERMINATION_REASON_PRIMAL_OR_DUAL_INFEASIBLE;
+          return true;
+        }
+        // The bounds cross by less than the tolerance: keeps the bound from
+        // the constraint.
+        if (step.lower_from_row) {
+          variable_upper = variable_lower;
+        } else {
+          variable_lower = variable_upper;
+        }
+      }
+      steps_.push_back(step);
+      lp.constraint_removed[row] = 1;
+      lp.variable_changed[col] = 1;
+      changed = true;
+      continue;
+    }
+
+    const bool finite_min_activity = lp.min_activity_infinities[row] == 0;
+    const bool finite_max_activity = lp.max_activity_infinities[row] == 0;
+    const double min_activity = lp.min_activity[row];
+    const double max_activity = lp.max_activity[row];
+    if ((finite_min_activity && Exceeds(min_activity, upper)) ||
+        (finite_max_activity && Exceeds(lower, max_activity))) {
+      termination_ = TERMINATION_REASON_PRIMAL_OR_DUAL_INFEASIBLE;
+      return true;
+    }
+    const bool forced_to_min_activity =
+        finite_min_activity && !Exceeds(upper, min_activity);
+    const bool forced_to_max_activity =
+        finite_max_activity && !Exceeds(max_activity, lower);
+    if (forced_to_min_activity || forced_to_max_activity) {
+      // The activity bounds only shrink when variable bounds change, so the
+      // checks above still hold for the changed variables, but the activity
+      // might now be unable to reach the bound at all. Such constraints are
+      // revisited in the next pass.
+      bool has_changed_variable = false;
+      for (SparseMatrix::InnerIterator it(lp.transposed_matrix, row); it;
+           ++it) {
+        if (lp.VariableEntryInLp(it.index(), it.value()) &&
+            lp.variable_changed[it.index()]) {
+          has_changed_variable = true;
+          break;
+        }
+      }
+      if (!has_changed_variable) {
+        steps_.push_back({.type = PostsolveStep::Type::kForcingConstraint,
+                          .row = row,
+                          .upper_from_row = forced_to_min_activity});
+        for (SparseMatrix::InnerIterator it(lp.transposed_matrix, row); it;
+             ++it) {
+          const int64_t col = it.index();
+          if (!lp.VariableEntryInLp(col, it.value())) continue;
+          const double value = (it.value() > 0.0) == forced_to_min_activity
+                                   ? lp.variable_lower_bounds[col]
+                                   : lp.variable_upper_bounds[col];
+          lp.variable_lower_bounds[col] = value;
+          lp.variable_upper_bounds[col] = value;
+          lp.variable_changed[col] = 1;
+        }
+        lp.constraint_removed[row] = 1;
+        changed = true;
+        continue;
+      }
+    }
+    // Drops the bounds implied by the variable bounds. With a zero dual on
+    // the dropped bound, the variables at the bounds that imply it keep dual
+    // feasible reduced costs, so nothing is needed in postsolve.
+    if (lower != -kInfinity && finite_min_activity &&
+        !Exceeds(lower, min_activity)) {
+      lower = -kInfinity;
+      changed = true;
+    }
+    if (upper != kInfinity && finite_max_activity &&
+        !Exceeds(max_activity, upper)) {
+      upper = kInfinity;
+      changed = true;
+    }
+    if (lower == -kInfinity && upper == kInfinity) {
+      lp.constraint_removed[row] = 1;
+    }
+  }
+  std::fill(lp.variable_changed.begin(), lp.variable_changed.end(), 0);
+  return changed;
+}
+
+bool LpPresolver::ReduceVariables(WorkingLp& lp) {
+  const Sharder& sharder = lp.sharded_lp.ConstraintMatrixSharder();
+  sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = sharder.ShardStart(shard.Index());
+    const int64_t shard_end = shard_start + sharder.ShardSize(shard.Index());
+    for (int64_t col = shard_start; col < shard_end; ++col) {
+      if (lp.variable_removed[col]) continue;
+      int64_t size = 0;
+      for (SparseMatrix::InnerIterator it(lp.matrix, col); it; ++it) {
+        if (lp.ConstraintEntryInLp(it.index(), it.value())) ++size;
+      }
+      lp.variable_size[col] = size;
+    }
+  });
+
+  bool changed = false;
+  for (int64_t col = 0; col < num_variables_; ++col) {
+    if (lp.variable_removed[col] || lp.variable_size[col] > 1) continue;
+    const double objective = lp.objective_vector[col];
+    const double variable_lower = lp.variable_lower_bounds[col];
+    const double variable_upper = lp.variable_upper_bounds[col];
+    if (lp.variable_size[col] == 0) {
+      double value = std::clamp(0.0, variable_lower, variable_upper);
+      if (objective > 0.0) value = variable_lower;
+      if (objective < 0.0) value = variable_upper;
+      if (std::isinf(value)) {
+        termination_ = TERMINATION_REASON_PRIMAL_OR_DUAL_INFEASIBLE;
+        return true;
+      }
+      steps_.push_back({.type = PostsolveStep::Type::kFixedVariable,
+                        .column = col,
+                        .value = value});
+      lp.objective_offset += objective * value;
+      RemoveVariable(col, lp);
+      changed = true;
+    } else if (objective == 0.0) {
+      SparseMatrix::InnerIterator it(lp.matrix, col);
+      while (!lp.ConstraintEntryInLp(it.index(), it.value())) ++it;
+      const int64_t row = it.index();
+      const double coefficient = it.value();
+      double& lower = lp.constraint_lower_bounds[row];
+      double& upper = lp.constraint_upper_bounds[row];
+      steps_.push_back(
+          {.type = PostsolveStep::Type::kZeroCostSingletonVariable,
+           .row = row,
+           .column = col,
+           .coefficient = coefficient,
+           .row_lower = lower,
+           .row_upper = upper,
+           .variable_lower = variable_lower,
+           .variable_upper = variable_upper});
+      // The terms can't be +inf and -inf respectively, so this doesn't
+      // produce NaNs.
+      lower -= coefficient * (coefficient > 0.0 ? variable_upper
+                                                : variable_lower);
+      upper -= coefficient * (coefficient > 0.0 ? variable_lower
+                                                : variable_upper);
+      RemoveVariable(col, lp);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool LpPresolver::MergeParallelConstraints(WorkingLp& lp) {
+  // The fingerprint of a constraint hashes its variables and its coefficients
+  // divided by the first one, rounded to single precision. Parallel
+  // constraints have the same fingerprint, except in the rare cases where the
+  // rounding of their ratios differs. Constraints with fewer than two variables
+  // get a zero fingerprint and are skipped.
+  std::vector<size_t> fingerprints(num_constraints_, 0);
+  const Sharder& sharder = lp.sharded_lp.TransposedConstraintMatrixSharder();
+  sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = sharder.ShardStart(shard.Index());
+    const int64_t shard_end = shard_start + sharder.ShardSize(shard.Index());
+    for (int64_t row = shard_start; row < shard_end; ++row) {
+      if (lp.constraint_removed[row]) continue;
+      size_t fingerprint = 0;
+      double first_coefficient = 0.0;
+      int64_t size = 0;
+      for (SparseMatrix::InnerIterator it(lp.transposed_matrix, row); it;
+           ++it) {
+        if (!lp.VariableEntryInLp(it.index(), it.value())) continue;
+        if (size == 0) first_coefficient = it.value();
+        ++size;
+        fingerprint =
+            absl::HashOf(fingerprint, it.index(),
+                         static_cast<float>(it.value() / first_coefficient));
+      }
+      if (size >= 2) fingerprints[row] = fingerprint | 1;
+    }
+  });
+  std::vector<int64_t> candidates;
+  for (int64_t row = 0; row < num_constraints_; ++row) {
+    if (fingerprints[row] != 0) candidates.push_back(row);
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [&](const int64_t a, const int64_t b) {
+              return std::make_pair(fingerprints[a], a) <
+                     std::make_pair(fingerprints[b], b);
+            });
+
+  // Returns the ratio of `other_row` to `row` if they are parallel.
+  const auto parallel_ratio = [&](const int64_t row,
+                                  const int64_t other_row) {
+    std::optional<double> ratio;
+    SparseMatrix::InnerIterator it(lp.transposed_matrix, row);
+    SparseMatrix::InnerIterator other_it(lp.transposed_matrix, other_row);
+    for (;;) {
+      while (it && !lp.VariableEntryInLp(it.index(), it.value())) ++it;
+      while (other_it &&
+             !lp.VariableEntryInLp(other_it.index(), other_it.value())) {
+        ++other_it;
+      }
+      if (!it || !other_it) break;
+      if (it.index() != other_it.index()) return std::optional<double>();
+      if (!ratio.has_value()) ratio = other_it.value() / it.value();
+      if (std::abs(other_it.value() - *ratio * it.value()) >
+          kParallelTolerance * std::abs(other_it.value())) {
+        return std::optional<double>();
+      }
+      ++it;
+      ++other_it;
+    }
+    if (it || other_it) return std::optional<double>();
+    return ratio;
+  };
+
+  bool changed = false;
+  for (int64_t group_start = 0; group_start < candidates.size();) {
+    const int64_t row = candidates[group_start];
+    int64_t group_end = group_start + 1;
+    while (group_end < candidates.size() &&
+           fingerprints[candidates[group_end]] == fingerprints[row]) {
+      ++group_end;
+    }
+    for (int64_t i = group_start + 1; i < group_end; ++i) {
+      const int64_t other_row = candidates[i];
+      const std::optional<double> ratio = parallel_ratio(row, other_row);
+      if (!ratio.has_value()) continue;
+      PostsolveStep step = {.type = PostsolveStep::Type::kParallelConstraint,
+                            .row = row,
+                            .other_row = other_row,
+                            .coefficient = *ratio};
+      const double other_lower = lp.constraint_lower_bounds[other_row];
+      const double other_upper = lp.constraint_upper_bounds[other_row];
+      const double implied_lower =
+          (*ratio > 0.0 ? other_lower : other_upper) / *ratio;
+      const double implied_upper =
+          (*ratio > 0.0 ? other_upper : other_lower) / *ratio;
+      double& lower = lp.constraint_lower_bounds[row];
+      double& upper = lp.constraint_upper_bounds[row];
+      if (implied_lower > lower) {
+        lower = implied_lower;
+        step.lower_from_row = true;
+      }
+      if (implied_upper < upper) {
+        upper = implied_upper;
+        step.upper_from_row = true;
+      }
+      if (lower > upper) {
+        if (Exceeds(lower, upper)) {
+          termination_ = TERMINATION_REASON_PRIMAL_OR_DUAL_INFEASIBLE;
+          return true;
+        }
+        if (step.lower_from_row) {
+          upper = lower;
+        } else {
+          lower = upper;
+        }
+      }
+      steps_.push_back(step);
+      lp.constraint_removed[other_row] = 1;
+      changed = true;
+    }
+    group_start = group_end;
+  }
+  return changed;
+}
+
+QuadraticProgram LpPresolver::BuildPresolvedLp(const WorkingLp& lp) {
+  const QuadraticProgram& original_lp = lp.sharded_lp.Qp();
+  std::vector<int64_t> new_variable_index(num_variables_, -1);
+  presolved_variables_.clear();
+  for (int64_t col = 0; col < num_variables_; ++col) {
+    if (lp.variable_removed[col]) continue;
+    new_variable_index[col] = presolved_variables_.size();
+    presolved_variables_.push_back(col);
+  }
+  std::vector<int64_t> new_constraint_index(num_constraints_, -1);
+  presolved_constraints_.clear();
+  for (int64_t row = 0; row < num_constraints_; ++row) {
+    if (lp.constraint_removed[row]) continue;
+    new_constraint_index[row] = presolved_constraints_.size();
+    presolved_constraints_.push_back(row);
+  }
+  const int64_t num_presolved_variables = presolved_variables_.size();
+  const int64_t num_presolved_constraints = presolved_constraints_.size();
+
+  QuadraticProgram presolved_lp(num_presolved_variables,
+                                num_presolved_constraints);
+  for (int64_t i = 0; i < num_presolved_variables; ++i) {
+    const int64_t col = presolved_variables_[i];
+    presolved_lp.objective_vector[i] = lp.objective_vector[col];
+    presolved_lp.variable_lower_bounds[i] = lp.variable_lower_bounds[col];
+    presolved_lp.variable_upper_bounds[i] = lp.variable_upper_bounds[col];
+  }
+  for (int64_t i = 0; i < num_presolved_constraints; ++i) {
+    const int64_t row = presolved_constraints_[i];
+    presolved_lp.constraint_lower_bounds[i] = lp.constraint_lower_bounds[row];
+    presolved_lp.constraint_upper_bounds[i] = lp.constraint_upper_bounds[row];
+  }
+  presolved_lp.objective_offset = lp.objective_offset;
+  presolved_lp.objective_scaling_factor = original_lp.objective_scaling_factor;
+  presolved_lp.problem_name = original_lp.problem_name;
+  if (original_lp.variable_names.has_value()) {
+    presolved_lp.variable_names.emplace();
+    for (const int64_t col : presolved_variables_) {
+      presolved_lp.variable_names->push_back(
+          (*original_lp.variable_names)[col]);
+    }
+  }
+  if (original_lp.constraint_names.has_value()) {
+    presolved_lp.constraint_names.emplace();
+    for (const int64_t row : presolved_constraints_) {
+      presolved_lp.constraint_names->push_back(
+          (*original_lp.constraint_names)[row]);
+    }
+  }
+
+  // Counts the entries of each column in parallel, then fills the columns in
+  // parallel at the offsets given by the prefix sums of the counts.
+  std::vector<int64_t> column_starts(num_presolved_variables + 1, 0);
+  const Sharder& sharder = lp.sharded_lp.ConstraintMatrixSharder();
+  sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = sharder.ShardStart(shard.Index());
+    const int64_t shard_end = shard_start + sharder.ShardSize(shard.Index());
+    for (int64_t col = shard_start; col < shard_end; ++col) {
+      if (lp.variable_removed[col]) continue;
+      int64_t size = 0;
+      for (SparseMatrix::InnerIterator it(lp.matrix, col); it; ++it) {
+        if (lp.ConstraintEntryInLp(it.index(), it.value())) ++size;
+      }
+      column_starts[new_variable_index[col] + 1] = size;
+    }
+  });
+  std::partial_sum(column_starts.begin(), column_starts.end(),
+                   column_starts.begin());
+  SparseMatrix presolved_matrix(num_presolved_constraints,
+                                num_presolved_variables);
+  presolved_matrix.data().resize(column_starts.back());
+  std::copy(column_starts.begin(), column_starts.end(),
+            presolved_matrix.outerIndexPtr());
+  sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = sharder.ShardStart(shard.Index());
+    const int64_t shard_end = shard_start + sharder.ShardSize(shard.Index());
+    for (int64_t col = shard_start; col < shard_end; ++col) {
+      if (lp.variable_removed[col]) continue;
+      int64_t position = column_starts[new_variable_index[col]];
+      for (SparseMatrix::InnerIterator it(lp.matrix, col); it; ++it) {
+        if (!lp.ConstraintEntryInLp(it.index(), it.value())) continue;
+        presolved_matrix.innerIndexPtr()[position] =
+            new_constraint_index[it.index()];
+        presolved_matrix.valuePtr()[position] = it.value();
+        ++position;
+      }
+    }
+  });
+  presolved_lp.constraint_matrix.swap(presolved_matrix);
+  return presolved_lp;
+}
+
+QuadraticProgram LpPresolver::Presolve(
+    const ShardedQuadraticProgram& sharded_lp) {
+  CHECK(IsLinearProgram(sharded_lp.Qp()));
+  num_variables_ = sharded_lp.PrimalSize();
+  num_constraints_ = sharded_lp.DualSize();
+  steps_.clear();
+  termination_.reset();
+  variable_removal_step_.assign(num_variables_,
+                                std::numeric_limits<int64_t>::max());
+  WorkingLp lp(sharded_lp);
+  for (int pass = 0; pass < kMaxPasses; ++pass) {
+    bool changed = RemoveFixedVariables(lp);
+    if (!termination_.has_value()) changed |= ReduceConstraints(lp);
+    if (!termination_.has_value()) changed |= ReduceVariables(lp);
+    if (!termination_.has_value()) changed |= MergeParallelConstraints(lp);
+    if (termination_.has_value() || !changed) break;
+  }
+  for (int64_t& step : variable_removal_step_) {
+    step = std::min(step, static_cast<int64_t>(steps_.size()));
+  }
+  QuadraticProgram presolved_lp = BuildPresolvedLp(lp);
+  if (!termination_.has_value() && presolved_variables_.empty() &&
+      presolved_constraints_.empty()) {
+    termination_ = TERMINATION_REASON_OPTIMAL;
+  }
+  return presolved_lp;
+}
+
+void LpPresolver::Postsolve(const ShardedQuadraticProgram& sharded_lp,
+                            const VectorXd& presolved_primal_solution,
+                            const VectorXd& presolved_dual_solution,
+                            VectorXd& primal_solution,
+                            VectorXd& dual_solution) const {
+  const QuadraticProgram& lp = sharded_lp.Qp();
+  CHECK_EQ(lp.objective_vector.size(), num_variables_);
+  CHECK_EQ(lp.constraint_lower_bounds.size(), num_constraints_);
+  primal_solution = ZeroVector(sharded_lp.PrimalSharder());
+  dual_solution = ZeroVector(sharded_lp.DualSharder());
+  if (termination_ == TERMINATION_REASON_PRIMAL_OR_DUAL_INFEASIBLE) return;
+  CHECK_EQ(presolved_primal_solution.size(), presolved_variables_.size());
+  CHECK_EQ(presolved_dual_solution.size(), presolved_constraints_.size());
+  for (int64_t i = 0; i < presolved_variables_.size(); ++i) {
+    primal_solution[presolved_variables_[i]] = presolved_primal_solution[i];
+  }
+  for (int64_t i = 0; i < presolved_constraints_.size(); ++i) {
+    dual_solution[presolved_constraints_[i]] = presolved_dual_solution[i];
+  }
+
+  const SparseMatrix& transposed_matrix =
+      sharded_lp.TransposedConstraintMatrix();
+  // The duals of the constraints that are not restored yet are zero, so this
+  // is the reduced cost of `col` in the LP when the step being undone was
+  // taken.
+  const auto reduced_cost = [&](const int64_t col) {
+    double reduced_cost = lp.objective_vector[col];
+    for (SparseMatrix::InnerIterator it(lp.constraint_matrix, col); it; ++it) {
+      reduced_cost -= it.value() * dual_solution[it.index()];
+    }
+    return reduced_cost;
+  };
+  for (int64_t s = static_cast<int64_t>(steps_.size()) - 1; s >= 0; --s) {
+    const PostsolveStep& step = steps_[s];
+    switch (step.type) {
+      case PostsolveStep::Type::kFixedVariable:
+        primal_solution[step.column] = step.value;
+        break;
+      case PostsolveStep::Type::kSingletonConstraint: {
+        // Moves the reduced cost of the variable to the constraint if the
+        // bound it implies is the one that needs a non-zero dual.
+        const double column_reduced_cost = reduced_cost(step.column);
+        if ((column_reduced_cost > 0.0 && step.lower_from_row) ||
+            (column_reduced_cost < 0.0 && step.upper_from_row)) {
+          dual_solution[step.row] = column_reduced_cost / step.coefficient;
+        }
+        break;
+      }
+      case PostsolveStep::Type::kForcingConstraint: {
+        // The variables are at the bounds that minimize the activity if the
+        // constraint is at its upper bound. The largest non-positive dual for
+        // which all reduced costs have the sign of the bound each variable is
+        // at is the smallest ratio of reduced cost to coefficient; likewise
+        // for the maximum activity.
+        double dual = 0.0;
+        for (SparseMatrix::InnerIterator it(transposed_matrix, step.row); it;
+             ++it) {
+          if (it.value() == 0.0 || variable_removal_step_[it.index()] <= s) {
+            continue;
+          }
+          const double ratio = reduced_cost(it.index()) / it.value();
+          dual = step.upper_from_row ? std::min(dual, ratio)
+                                     : std::max(dual, ratio);
+        }
+        dual_solution[step.row] = dual;
+        break;
+      }
+      case PostsolveStep::Type::kZeroCostSingletonVariable: {
+        // The variable is still zero, so this is the activity of the other
+        // variables.
+        double activity = 0.0;
+        for (SparseMatrix::InnerIterator it(transposed_matrix, step.row); it;
+             ++it) {
+          activity += it.value() * primal_solution[it.index()];
+        }
+        const double term_lower = step.row_lower - activity;
+        const double term_upper = step.row_upper - activity;
+        const double dual = dual_solution[step.row];
+        // With a non-zero dual, the widened bound is tight, and the variable
+        // is at the bound that makes the original bound tight.
+        double term = step.coefficient * std::clamp(0.0, step.variable_lower,
+                                                    step.variable_upper);
+        if (dual > 0.0 && std::isfinite(term_lower)) {
+          term = term_lower;
+        } else if (dual < 0.0 && std::isfinite(term_upper)) {
+          term = term_upper;
+        } else {
+          term = std::min(std::max(term, term_lower), term_upper);
+        }
+        primal_solution[step.column] =
+            std::min(std::max(term / step.coefficient, step.variable_lower),
+                     step.variable_upper);
+        break;
+      }
+      case PostsolveStep::Type::kParallelConstraint: {
+        const double dual = dual_solution[step.row];
+        if ((dual > 0.0 && step.lower_from_row) ||
+            (dual < 0.0 && step.upper_from_row)) {
+          dual_solution[step.other_row] = dual / step.coefficient;
+          dual_solution[step.row] = 0.0;
+        }
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace operations_research::pdlp
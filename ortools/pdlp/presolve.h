@@ -0,0 +1,165 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A presolver for linear programs that works directly on the column-major
+// constraint matrix of a `ShardedQuadraticProgram` and its transpose, without
+// converting the problem to another format.
+
+#ifndef PDLP_PRESOLVE_H_
+#define PDLP_PRESOLVE_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "Eigen/Core"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/pdlp/sharded_quadratic_program.h"
+#include "ortools/pdlp/solve_log.pb.h"
+
+namespace operations_research::pdlp {
+
+// `Presolve()` repeats the following reductions until none applies, or for at
+// most `kMaxPasses` passes:
+//  - Fixed variables are removed, and their contribution is moved to the
+//    constraint bounds and to the objective offset.
+//  - Empty constraints are removed, or show that the LP is infeasible.
+//  - Constraints with a single variable become bounds on that variable.
+//  - Constraint bounds that are implied by the variable bounds are dropped,
+//    and constraints left without bounds are removed. Constraints whose
+//    activity can only meet a bound at one point (forcing constraints) fix
+//    their variables at the corresponding bounds.
+//  - Empty variables are fixed at their best bound, or show that the LP is
+//    primal or dual infeasible.
+//  - Variables with a zero objective coefficient that appear in a single
+//    constraint are removed, and the bounds of that constraint are widened by
+//    the range of the variable's term.
+//  - Constraints that are multiples of another constraint are merged into it.
+//
+// The counts, the activity bounds and the fingerprints used to find parallel
+// constraints are computed in parallel over the shards of the
+// `ShardedQuadraticProgram`, and so is the construction of the presolved
+// constraint matrix. The reductions themselves are applied in one sequential
+// pass over the constraints and one over the variables, each in linear time.
+//
+// `Postsolve()` undoes the reductions in reverse order to map a primal and
+// dual solution of the presolved LP to a primal and dual solution of the
+// original LP. When the presolved solution is optimal, so is the postsolved
+// one, up to the tolerances of the solution.
+class LpPresolver {
+ public:
+  static constexpr int kMaxPasses = 20;
+
+  LpPresolver() = default;
+
+  // Presolves `sharded_lp.Qp()`, which must be a valid linear program, and
+  // returns the presolved LP. If presolve solves the LP or finds it infeasible,
+  // `Termination()` returns the corresponding reason, and the returned LP is
+  // still the (possibly inconsistent) LP at the point presolve stopped.
+  // `sharded_lp` must be the same when calling `Postsolve()`.
+  QuadraticProgram Presolve(const ShardedQuadraticProgram& sharded_lp);
+
+  // Returns nullopt if the LP returned by `Presolve()` needs solving, and
+  // otherwise `TERMINATION_REASON_OPTIMAL` if presolve removed all variables
+  // and constraints, or `TERMINATION_REASON_PRIMAL_OR_DUAL_INFEASIBLE` if it
+  // found the LP infeasible or unbounded.
+  std::optional<TerminationReason> Termination() const { return termination_; }
+
+  int64_t NumRemovedVariables() const {
+    return num_variables_ - static_cast<int64_t>(presolved_variables_.size());
+  }
+  int64_t NumRemovedConstraints() const {
+    return num_constraints_ -
+           static_cast<int64_t>(presolved_constraints_.size());
+  }
+
+  // Maps a primal and dual solution of the LP returned by `Presolve()` to a
+  // primal and dual solution of `sharded_lp.Qp()`. If `Termination()` is
+  // `TERMINATION_REASON_PRIMAL_OR_DUAL_INFEASIBLE`, ignores the input and
+  // returns zero vectors.
+  void Postsolve(const ShardedQuadraticProgram& sharded_lp,
+                 const Eigen::VectorXd& presolved_primal_solution,
+                 const Eigen::VectorXd& presolved_dual_solution,
+                 Eigen::VectorXd& primal_solution,
+                 Eigen::VectorXd& dual_solution) const;
+
+ private:
+  // A reduction that `Postsolve()` needs to undo. Which fields are used
+  // depends on `type`.
+  struct PostsolveStep {
+    enum class Type {
+      // `column` was fixed at `value`.
+      kFixedVariable,
+      // `row` had the single coefficient `coefficient` in `column`, and set the
+      // lower (`lower_from_row`) and/or upper (`upper_from_row`) bound of
+      // `column`.
+      kSingletonConstraint,
+      // `row` forced its variables to the bounds that minimize its activity if
+      // `upper_from_row`, or that maximize it otherwise.
+      kForcingConstraint,
+      // `column`, in [`variable_lower`, `variable_upper`] with a zero objective
+      // coefficient, had the single coefficient `coefficient` in `row`, which
+      // had the bounds [`row_lower`, `row_upper`].
+      kZeroCostSingletonVariable,
+      // `other_row` was `coefficient` times `row`, and set the lower
+      // (`lower_from_row`) and/or upper (`upper_from_row`) bound of `row`.
+      kParallelConstraint,
+    };
+    Type type;
+    int64_t row = -1;
+    int64_t other_row = -1;
+    int64_t column = -1;
+    double coefficient = 0.0;
+    double value = 0.0;
+    double row_lower = 0.0;
+    double row_upper = 0.0;
+    double variable_lower = 0.0;
+    double variable_upper = 0.0;
+    bool lower_from_row = false;
+    bool upper_from_row = false;
+  };
+
+  // The state of the LP during `Presolve()`. Defined in presolve.cc.
+  struct WorkingLp;
+
+  // The reductions listed above. Each returns true if it changed the LP, and
+  // sets `termination_` if it finds the LP infeasible or unbounded.
+  bool RemoveFixedVariables(WorkingLp& lp);
+  bool ReduceConstraints(WorkingLp& lp);
+  bool ReduceVariables(WorkingLp& lp);
+  bool MergeParallelConstraints(WorkingLp& lp);
+
+  // Builds the presolved LP from `lp` and fills `presolved_variables_` and
+  // `presolved_constraints_`.
+  QuadraticProgram BuildPresolvedLp(const WorkingLp& lp);
+
+  // Marks `column` as removed by the last step in `steps_`.
+  void RemoveVariable(int64_t column, WorkingLp& lp);
+
+  int64_t num_variables_ = 0;
+  int64_t num_constraints_ = 0;
+  std::vector<PostsolveStep> steps_;
+  // For each variable, the index in `steps_` of the step that removed it, or
+  // `steps_.size()` if it is in the presolved LP. A variable was in the LP
+  // when step `s` was taken iff its removal step is greater than `s`.
+  std::vector<int64_t> variable_removal_step_;
+  // The indices in the original LP of the variables and constraints of the
+  // presolved LP.
+  std::vector<int64_t> presolved_variables_;
+  std::vector<int64_t> presolved_constraints_;
+  std::optional<TerminationReason> termination_;
+};
+
+}  // namespace operations_research::pdlp
+
+#endif  // PDLP_PRESOLVE_H_
@@ -0,0 +1,243 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/pdlp/presolve.h"
+
+#include <limits>
+#include <optional>
+
+#include "Eigen/Core"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/pdlp/sharded_quadratic_program.h"
+#include "ortools/pdlp/solve_log.pb.h"
+#include "ortools/pdlp/test_util.h"
+
+namespace operations_research::pdlp {
+namespace {
+
+using ::Eigen::VectorXd;
+using ::testing::ElementsAre;
+using ::testing::Optional;
+
+const double kInfinity = std::numeric_limits<double>::infinity();
+
+// The number of threads and of shards.
+class LpPresolverTest : public testing::TestWithParam<std::tuple<int, int>> {
+ protected:
+  ShardedQuadraticProgram Shard(QuadraticProgram lp) {
+    const auto [num_threads, num_shards] = GetParam();
+    return ShardedQuadraticProgram(std::move(lp), num_threads, num_shards);
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(Threads, LpPresolverTest,
+                         testing::Values(std::make_tuple(1, 1),
+                                         std::make_tuple(2, 4)));
+
+TEST_P(LpPresolverTest, SingletonConstraintBecomesVariableBound) {
+  // The constraint 4 x_0 >= -4 becomes the bound x_0 >= -1.
+  const ShardedQuadraticProgram sharded_lp = Shard(TestLp());
+  LpPresolver presolver;
+  const QuadraticProgram presolved_lp = presolver.Presolve(sharded_lp);
+  EXPECT_EQ(presolver.Termination(), std::nullopt);
+  EXPECT_EQ(presolver.NumRemovedVariables(), 0);
+  EXPECT_EQ(presolver.NumRemovedConstraints(), 1);
+  EXPECT_THAT(presolved_lp.variable_lower_bounds,
+              ElementsAre(-1, -2, -kInfinity, 2.5));
+  EXPECT_THAT(presolved_lp.constraint_lower_bounds,
+              ElementsAre(12, -kInfinity, -1));
+  EXPECT_THAT(
+      ToDense(presolved_lp.constraint_matrix),
+      EigenArrayEq<double>({{2, 1, 1, 2}, {1, 0, 1, 0}, {0, 0, 1.5, -1}}));
+
+  // The optimal solution of the presolved LP gets the reduced cost of x_0 as
+  // the dual of the removed constraint.
+  VectorXd primal_solution, dual_solution;
+  presolver.Postsolve(sharded_lp, VectorXd{{-1, 8, 1, 2.5}},
+                      VectorXd{{-2, 0, 2.0 / 3}}, primal_solution,
+                      dual_solution);
+  EXPECT_THAT(primal_solution, ElementsAre(-1, 8, 1, 2.5));
+  EXPECT_THAT(dual_solution,
+              EigenArrayNear<double>({-2, 0, 2.375, 2.0 / 3}, 1.0e-12));
+}
+
+TEST_P(LpPresolverTest, RemovesFixedAndEmptyVariables) {
+  // min x_0 - x_1 + 3 x_2 s.t. x_2 <= 10, 1 <= x_0 <= 4, 0 <= x_1 <= 5,
+  // x_2 = 2.
+  QuadraticProgram lp(3, 1);
+  lp.objective_vector = VectorXd{{1, -1, 3}};
+  lp.constraint_matrix.coeffRef(0, 2) = 1;
+  lp.constraint_matrix.makeCompressed();
+  lp.constraint_upper_bounds = VectorXd{{10}};
+  lp.variable_lower_bounds = VectorXd{{1, 0, 2}};
+  lp.variable_upper_bounds = VectorXd{{4, 5, 2}};
+  const ShardedQuadraticProgram sharded_lp = Shard(std::move(lp));
+  LpPresolver presolver;
+  const QuadraticProgram presolved_lp = presolver.Presolve(sharded_lp);
+  EXPECT_THAT(presolver.Termination(), Optional(TERMINATION_REASON_OPTIMAL));
+  EXPECT_EQ(presolved_lp.objective_vector.size(), 0);
+  EXPECT_EQ(presolved_lp.constraint_lower_bounds.size(), 0);
+  EXPECT_EQ(presolved_lp.objective_offset, 2);
+
+  VectorXd primal_solution, dual_solution;
+  presolver.Postsolve(sharded_lp, VectorXd(0), VectorXd(0), primal_solution,
+                      dual_solution);
+  EXPECT_THAT(primal_solution, ElementsAre(1, 5, 2));
+  EXPECT_THAT(dual_solution, ElementsAre(0));
+}
+
+TEST_P(LpPresolverTest, DetectsUnboundedEmptyVariable) {
+  QuadraticProgram lp(1, 0);
+  lp.objective_vector = VectorXd{{-1}};
+  lp.variable_lower_bounds = VectorXd{{0}};
+  const ShardedQuadraticProgram sharded_lp = Shard(std::move(lp));
+  LpPresolver presolver;
+  presolver.Presolve(sharded_lp);
+  EXPECT_THAT(presolver.Termination(),
+              Optional(TERMINATION_REASON_PRIMAL_OR_DUAL_INFEASIBLE));
+}
+
+TEST_P(LpPresolverTest, DetectsInfeasibleParallelConstraints) {
+  const ShardedQuadraticProgram sharded_lp = Shard(SmallPrimalInfeasibleLp());
+  LpPresolver presolver;
+  presolver.Presolve(sharded_lp);
+  EXPECT_THAT(presolver.Termination(),
+              Optional(TERMINATION_REASON_PRIMAL_OR_DUAL_INFEASIBLE));
+  VectorXd primal_solution, dual_solution;
+  presolver.Postsolve(sharded_lp, VectorXd(2), VectorXd(0), primal_solution,
+                      dual_solution);
+  EXPECT_THAT(primal_solution, ElementsAre(0, 0));
+  EXPECT_THAT(dual_solution, ElementsAre(0, 0));
+}
+
+TEST_P(LpPresolverTest, MergesParallelConstraints) {
+  // min x_0 + x_1 s.t. x_0 + x_1 >= 1, 2 x_0 + 2 x_1 >= 4, x_0, x_1 >= 0.
+  QuadraticProgram lp(2, 2);
+  lp.objective_vector = VectorXd{{1, 1}};
+  lp.constraint_matrix.coeffRef(0, 0) = 1;
+  lp.constraint_matrix.coeffRef(0, 1) = 1;
+  lp.constraint_matrix.coeffRef(1, 0) = 2;
+  lp.constraint_matrix.coeffRef(1, 1) = 2;
+  lp.constraint_matrix.makeCompressed();
+  lp.constraint_lower_bounds = VectorXd{{1, 4}};
+  lp.variable_lower_bounds = VectorXd{{0, 0}};
+  const ShardedQuadraticProgram sharded_lp = Shard(std::move(lp));
+  LpPresolver presolver;
+  const QuadraticProgram presolved_lp = presolver.Presolve(sharded_lp);
+  EXPECT_EQ(presolver.Termination(), std::nullopt);
+  EXPECT_THAT(presolved_lp.constraint_lower_bounds, ElementsAre(2));
+  EXPECT_THAT(presolved_lp.constraint_upper_bounds, ElementsAre(kInfinity));
+
+  // The dual of the merged constraint goes to the constraint that set its
+  // lower bound.
+  VectorXd primal_solution, dual_solution;
+  presolver.Postsolve(sharded_lp, VectorXd{{2, 0}}, VectorXd{{1}},
+                      primal_solution, dual_solution);
+  EXPECT_THAT(primal_solution, ElementsAre(2, 0));
+  EXPECT_THAT(dual_solution, ElementsAre(0, 0.5));
+}
+
+TEST_P(LpPresolverTest, FixesVariablesOfForcingConstraint) {
+  // min -x_0 - 2 x_1 s.t. x_0 + x_1 <= 0, 0 <= x_0, x_1 <= 1.
+  QuadraticProgram lp(2, 1);
+  lp.objective_vector = VectorXd{{-1, -2}};
+  lp.constraint_matrix.coeffRef(0, 0) = 1;
+  lp.constraint_matrix.coeffRef(0, 1) = 1;
+  lp.constraint_matrix.makeCompressed();
+  lp.constraint_upper_bounds = VectorXd{{0}};
+  lp.variable_lower_bounds = VectorXd{{0, 0}};
+  lp.variable_upper_bounds = VectorXd{{1, 1}};
+  const ShardedQuadraticProgram sharded_lp = Shard(std::move(lp));
+  LpPresolver presolver;
+  presolver.Presolve(sharded_lp);
+  EXPECT_THAT(presolver.Termination(), Optional(TERMINATION_REASON_OPTIMAL));
+
+  // The dual makes both reduced costs non-negative, as both variables are at
+  // their lower bound.
+  VectorXd primal_solution, dual_solution;
+  presolver.Postsolve(sharded_lp, VectorXd(0), VectorXd(0), primal_solution,
+                      dual_solution);
+  EXPECT_THAT(primal_solution, ElementsAre(0, 0));
+  EXPECT_THAT(dual_solution, ElementsAre(-2));
+}
+
+TEST_P(LpPresolverTest, RemovesZeroCostSingletonVariable) {
+  // min x_0 s.t. x_0 + x_1 = 3, x_0 >= 0, 0 <= x_1 <= 1.
+  QuadraticProgram lp(2, 1);
+  lp.objective_vector = VectorXd{{1, 0}};
+  lp.constraint_matrix.coeffRef(0, 0) = 1;
+  lp.constraint_matrix.coeffRef(0, 1) = 1;
+  lp.constraint_matrix.makeCompressed();
+  lp.constraint_lower_bounds = VectorXd{{3}};
+  lp.constraint_upper_bounds = VectorXd{{3}};
+  lp.variable_lower_bounds = VectorXd{{0, 0}};
+  lp.variable_upper_bounds = VectorXd{{kInfinity, 1}};
+  const ShardedQuadraticProgram sharded_lp = Shard(std::move(lp));
+  LpPresolver presolver;
+  presolver.Presolve(sharded_lp);
+  EXPECT_THAT(presolver.Termination(), Optional(TERMINATION_REASON_OPTIMAL));
+
+  VectorXd primal_solution, dual_solution;
+  presolver.Postsolve(sharded_lp, VectorXd(0), VectorXd(0), primal_solution,
+                      dual_solution);
+  EXPECT_THAT(primal_solution, ElementsAre(2, 1));
+  EXPECT_THAT(dual_solution, ElementsAre(1));
+}
+
+TEST_P(LpPresolverTest, DropsImpliedConstraintBounds) {
+  // min x_0 - x_1 s.t. -10 <= x_0 + x_1 <= 5, x_0 - x_1 >= -0.5,
+  // 0 <= x_0, x_1 <= 1.
+  QuadraticProgram lp(2, 2);
+  lp.objective_vector = VectorXd{{1, -1}};
+  lp.constraint_matrix.coeffRef(0, 0) = 1;
+  lp.constraint_matrix.coeffRef(0, 1) = 1;
+  lp.constraint_matrix.coeffRef(1, 0) = 1;
+  lp.constraint_matrix.coeffRef(1, 1) = -1;
+  lp.constraint_matrix.makeCompressed();
+  lp.constraint_lower_bounds = VectorXd{{-10, -0.5}};
+  lp.constraint_upper_bounds = VectorXd{{5, kInfinity}};
+  lp.variable_lower_bounds = VectorXd{{0, 0}};
+  lp.variable_upper_bounds = VectorXd{{1, 1}};
+  const ShardedQuadraticProgram sharded_lp = Shard(std::move(lp));
+  LpPresolver presolver;
+  const QuadraticProgram presolved_lp = presolver.Presolve(sharded_lp);
+  EXPECT_EQ(presolver.Termination(), std::nullopt);
+  EXPECT_EQ(presolver.NumRemovedVariables(), 0);
+  EXPECT_EQ(presolver.NumRemovedConstraints(), 1);
+  EXPECT_THAT(presolved_lp.constraint_lower_bounds, ElementsAre(-0.5));
+  EXPECT_THAT(presolved_lp.constraint_upper_bounds, ElementsAre(kInfinity));
+
+  VectorXd primal_solution, dual_solution;
+  presolver.Postsolve(sharded_lp, VectorXd{{0, 0.5}}, VectorXd{{1}},
+                      primal_solution, dual_solution);
+  EXPECT_THAT(primal_solution, ElementsAre(0, 0.5));
+  EXPECT_THAT(dual_solution, ElementsAre(0, 1));
+}
+
+TEST_P(LpPresolverTest, KeepsNamesOfRemainingVariablesAndConstraints) {
+  QuadraticProgram lp = TestLp();
+  lp.variable_names = {"x_0", "x_1", "x_2", "x_3"};
+  lp.constraint_names = {"c_0", "c_1", "c_2", "c_3"};
+  LpPresolver presolver;
+  const QuadraticProgram presolved_lp =
+      presolver.Presolve(Shard(std::move(lp)));
+  EXPECT_THAT(presolved_lp.variable_names,
+              Optional(ElementsAre("x_0", "x_1", "x_2", "x_3")));
+  EXPECT_THAT(presolved_lp.constraint_names,
+              Optional(ElementsAre("c_0", "c_1", "c_3")));
+}
+
+}  // namespace
+}  // namespace operations_research::pdlp
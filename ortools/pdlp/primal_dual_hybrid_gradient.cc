@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <optional>
 #include <random>
 #include <string>
@@ -46,7 +47,9 @@
 #include "ortools/lp_data/lp_data.h"
 #include "ortools/lp_data/lp_types.h"
 #include "ortools/lp_data/proto_utils.h"
+#include "ortools/pdlp/crossover.h"
 #include "ortools/pdlp/iteration_stats.h"
+#include "ortools/pdlp/presolve.h"
 #include "ortools/pdlp/quadratic_program.h"
 #include "ortools/pdlp/sharded_optimization_utils.h"
 #include "ortools/pdlp/sharded_quadratic_program.h"
@@ -56,6 +59,7 @@
 #include "ortools/pdlp/solvers_proto_validation.h"
 #include "ortools/pdlp/termination.h"
 #include "ortools/pdlp/trust_region.h"
+#include "ortools/util/time_limit.h"
 
 namespace operations_research::pdlp {
 
@@ -430,6 +434,8 @@ class PreprocessSolver {
 
     glop::GlopParameters preprocessor_parameters;
     glop::MainLpPreprocessor preprocessor;
+    // Set iff the native presolve is used instead of `preprocessor`.
+    std::optional<LpPresolver> native_presolver;
     ShardedQuadraticProgram sharded_original_qp;
     bool presolved_problem_was_maximization = false;
     const VectorXd trivial_col_scaling_vec, trivial_row_scaling_vec;
@@ -540,6 +546,8 @@ class Solver {
     VectorXd value;
     // `delta` is `value` - current_solution.
     VectorXd delta;
+    // `delta.squaredNorm()`, computed in the same pass as `value`.
+    double delta_squared_norm = 0.0;
   };
 
   struct DistanceBasedRestartInfo {
@@ -575,17 +583,20 @@ class Solver {
                                 const std::atomic<bool>* interrupt_solve,
                                 SolveLog& solve_log);
 
-  NextSolutionAndDelta ComputeNextPrimalSolution(double primal_step_size) const;
+  // If `extrapolated_primal` is not null, it is set to `value` + `delta` in
+  // the same pass, for use by `ComputeNextDualSolution()`.
+  NextSolutionAndDelta ComputeNextPrimalSolution(
+      double primal_step_size, VectorXd* extrapolated_primal = nullptr) const;
 
   NextSolutionAndDelta ComputeNextDualSolution(
-      double dual_step_size, double extrapolation_factor,
-      const NextSolutionAndDelta& next_primal) const;
+      double dual_step_size, const VectorXd& extrapolated_primal) const;
 
-  double ComputeMovement(const VectorXd& delta_primal,
-                         const VectorXd& delta_dual) const;
+  // Returns `next_primal.value` + `extrapolation_factor` * `next_primal.delta`.
+  VectorXd ExtrapolatedPrimal(double extrapolation_factor,
+                              const NextSolutionAndDelta& next_primal) const;
 
-  double ComputeNonlinearity(const VectorXd& delta_primal,
-                             const VectorXd& next_dual_product) const;
+  double ComputeMovement(double delta_primal_squared_norm,
+                         double delta_dual_squared_norm) const;
 
   // Creates all the simple-to-compute statistics in stats.
   IterationStats CreateSimpleIterationStats(RestartChoice restart_used) const;
@@ -712,7 +723,8 @@ PreprocessSolver::PreprocessSolver(QuadraticProgram qp,
                                    const PrimalDualHybridGradientParams& params)
     : num_threads_(NumThreads(params.num_threads(), params.num_shards(), qp)),
       num_shards_(NumShards(num_threads_, params.num_shards())),
-      sharded_qp_(std::move(qp), num_threads_, num_shards_) {}
+      sharded_qp_(std::move(qp), num_threads_, num_shards_,
+                  params.pin_threads_to_cpus()) {}
 
 SolverResult ErrorSolverResult(const TerminationReason reason,
                                const std::string& message) {
@@ -1096,6 +1108,10 @@ SolverResult PreprocessSolver::PreprocessAndSolve(
       params, solve_log.preprocessed_problem_stats().objective_vector_l2_norm(),
       solve_log.preprocessed_problem_stats().combined_bounds_l2_norm());
 
+  if (params.use_float_transposed_constraint_matrix()) {
+    sharded_qp_.ConvertTransposedConstraintMatrixToFloat();
+  }
+
   Solver solver(params, starting_primal_solution, starting_dual_solution,
                 step_size, primal_weight, this);
   solve_log.set_preprocessing_time_sec(timer.Get());
@@ -1145,7 +1161,8 @@ TerminationReason GlopStatusToTerminationReason(
 std::optional<TerminationReason> PreprocessSolver::ApplyPresolveIfEnabled(
     const PrimalDualHybridGradientParams& params,
     std::optional<PrimalAndDualSolution>* const initial_solution) {
-  const bool presolve_enabled = params.presolve_options().use_glop();
+  const bool presolve_enabled = params.presolve_options().use_glop() ||
+                                params.presolve_options().use_native_presolve();
   if (!presolve_enabled) {
     return std::nullopt;
   }
@@ -1154,6 +1171,31 @@ std::optional<TerminationReason> PreprocessSolver::ApplyPresolveIfEnabled(
         << "Skipping presolve, which is only supported for linear programs";
     return std::nullopt;
   }
+  if (params.presolve_options().use_native_presolve()) {
+    if (initial_solution->has_value()) {
+      LOG(WARNING) << "Ignoring initial solution. Initial solutions "
+                      "are ignored when presolve is on.";
+      initial_solution->reset();
+    }
+    presolve_info_.emplace(std::move(sharded_qp_), params);
+    LpPresolver& presolver = presolve_info_->native_presolver.emplace();
+    QuadraticProgram presolved_qp =
+        presolver.Presolve(presolve_info_->sharded_original_qp);
+    if (params.verbosity_level() >= 1) {
+      LogInfoWithoutPrefix(absl::StrFormat(
+          "Presolve removed %i variables and %i constraints.",
+          presolver.NumRemovedVariables(), presolver.NumRemovedConstraints()));
+    }
+    sharded_qp_ =
+        ShardedQuadraticProgram(std::move(presolved_qp), num_threads_,
+                                num_shards_, params.pin_threads_to_cpus());
+    if (presolver.Termination().has_value()) {
+      col_scaling_vec_ = OnesVector(sharded_qp_.PrimalSharder());
+      row_scaling_vec_ = OnesVector(sharded_qp_.DualSharder());
+      return presolver.Termination();
+    }
+    return std::nullopt;
+  }
   absl::StatusOr<MPModelProto> model = QpToMpModelProto(Qp());
   if (!model.ok()) {
     LOG(WARNING)
@@ -1188,8 +1230,9 @@ std::optional<TerminationReason> PreprocessSolver::ApplyPresolveIfEnabled(
   // The scaling factor of `presolved_qp` isn't actually used anywhere, but we
   // set it for completeness.
   presolved_qp->objective_scaling_factor = glop_lp.objective_scaling_factor();
-  sharded_qp_ = ShardedQuadraticProgram(std::move(*presolved_qp), num_threads_,
-                                        num_shards_);
+  sharded_qp_ =
+      ShardedQuadraticProgram(std::move(*presolved_qp), num_threads_,
+                              num_shards_, params.pin_threads_to_cpus());
   // A status of `INIT` means the preprocessor created a (usually) smaller
   // problem that needs solving. Other statuses mean the preprocessor solved
   // the problem completely.
@@ -1287,6 +1330,26 @@ double PreprocessSolver::InitialPrimalWeight(
 
 PrimalAndDualSolution PreprocessSolver::RecoverOriginalSolution(
     PrimalAndDualSolution working_solution) const {
+  if (presolve_info_.has_value() &&
+      presolve_info_->native_presolver.has_value()) {
+    CoefficientWiseProductInPlace(col_scaling_vec_,
+                                  sharded_qp_.PrimalSharder(),
+                                  working_solution.primal_solution);
+    CoefficientWiseProductInPlace(row_scaling_vec_, sharded_qp_.DualSharder(),
+                                  working_solution.dual_solution);
+    PrimalAndDualSolution solution;
+    presolve_info_->native_presolver->Postsolve(
+        presolve_info_->sharded_original_qp, working_solution.primal_solution,
+        working_solution.dual_solution, solution.primal_solution,
+        solution.dual_solution);
+    // The postsolved solution is within the bounds up to the rounding of the
+    // presolved bounds. To be safe we project both primal and dual.
+    ProjectToPrimalVariableBounds(presolve_info_->sharded_original_qp,
+                                  solution.primal_solution);
+    ProjectToDualVariableBounds(presolve_info_->sharded_original_qp,
+                                solution.dual_solution);
+    return solution;
+  }
   glop::ProblemSolution glop_solution(glop::RowIndex{0}, glop::ColIndex{0});
   if (presolve_info_.has_value()) {
     // We compute statuses relative to the working problem so we can detect when
@@ -1657,13 +1720,15 @@ Solver::Solver(const PrimalDualHybridGradientParams& params,
       preprocess_solver_(preprocess_solver) {}
 
 Solver::NextSolutionAndDelta Solver::ComputeNextPrimalSolution(
-    double primal_step_size) const {
+    double primal_step_size, VectorXd* extrapolated_primal) const {
   const int64_t primal_size = ShardedWorkingQp().PrimalSize();
   NextSolutionAndDelta result = {
       .value = VectorXd(primal_size),
       .delta = VectorXd(primal_size),
   };
+  if (extrapolated_primal != nullptr) extrapolated_primal->resize(primal_size);
   const QuadraticProgram& qp = WorkingQp();
+  const bool is_lp = IsLinearProgram(qp);
   // This computes the primal portion of the PDHG algorithm:
   // argmin_x[gradient(f)(`current_primal_solution_`)^T x + g(x)
   //   + `current_dual_solution_`^T K x
@@ -1672,102 +1737,127 @@ Solver::NextSolutionAndDelta Solver::ComputeNextPrimalSolution(
   // We omitted the constant terms from Chambolle and Pock's (7).
   // This minimization is easy to do in closed form since it can be separated
   // into independent problems for each of the primal variables.
-  ShardedWorkingQp().PrimalSharder().ParallelForEachShard(
-      [&](const Sharder::Shard& shard) {
-        if (!IsLinearProgram(qp)) {
-          // TODO(user): Does changing this to auto (so it becomes an
-          // Eigen deferred result), or inlining it below, change performance?
-          const VectorXd diagonal_scaling =
-              primal_step_size *
-                  shard(qp.objective_matrix->diagonal()).array() +
-              1.0;
-          shard(result.value) =
-              (shard(current_primal_solution_) -
-               primal_step_size *
-                   (shard(qp.objective_vector) - shard(current_dual_product_)))
-                  // Scale i-th element by 1 / (1 + `primal_step_size` * Q_{ii})
-                  .cwiseQuotient(diagonal_scaling)
-                  .cwiseMin(shard(qp.variable_upper_bounds))
-                  .cwiseMax(shard(qp.variable_lower_bounds));
-        } else {
-          // The formula in the LP case is simplified for better performance.
-          shard(result.value) =
-              (shard(current_primal_solution_) -
-               primal_step_size *
-                   (shard(qp.objective_vector) - shard(current_dual_product_)))
-                  .cwiseMin(shard(qp.variable_upper_bounds))
-                  .cwiseMax(shard(qp.variable_lower_bounds));
-        }
-        shard(result.delta) =
-            shard(result.value) - shard(current_primal_solution_);
-      });
+  // The step, the projection, the delta, its norm and the extrapolation are
+  // done block by block, so that each input is read from memory only once.
+  result.delta_squared_norm =
+      ShardedWorkingQp().PrimalSharder().ParallelSumOverShards(
+          [&](const Sharder::Shard& shard) {
+            auto shard_value = shard(result.value);
+            auto shard_delta = shard(result.delta);
+            const auto shard_current = shard(current_primal_solution_);
+            const auto shard_objective = shard(qp.objective_vector);
+            const auto shard_dual_product = shard(current_dual_product_);
+            const auto shard_lower_bounds = shard(qp.variable_lower_bounds);
+            const auto shard_upper_bounds = shard(qp.variable_upper_bounds);
+            double delta_squared_norm = 0.0;
+            ForEachFusedKernelBlock(
+                shard_value.size(), [&](int64_t start, int64_t size) {
+                  auto value = shard_value.segment(start, size);
+                  auto delta = shard_delta.segment(start, size);
+                  const auto current = shard_current.segment(start, size);
+                  const auto lower_bounds =
+                      shard_lower_bounds.segment(start, size);
+                  const auto upper_bounds =
+                      shard_upper_bounds.segment(start, size);
+                  const auto unprojected =
+                      current - primal_step_size *
+                                    (shard_objective.segment(start, size) -
+                                     shard_dual_product.segment(start, size));
+                  if (!is_lp) {
+                    // Scale i-th element by
+                    // 1 / (1 + `primal_step_size` * Q_{ii}).
+                    const auto diagonal_scaling =
+                        primal_step_size *
+                            shard(qp.objective_matrix->diagonal())
+                                .segment(start, size)
+                                .array() +
+                        1.0;
+                    value = unprojected.cwiseQuotient(diagonal_scaling.matrix())
+                                .cwiseMin(upper_bounds)
+                                .cwiseMax(lower_bounds);
+                  } else {
+                    // The formula in the LP case is simplified for better
+                    // performance.
+                    value = unprojected.cwiseMin(upper_bounds)
+                                .cwiseMax(lower_bounds);
+                  }
+                  delta = value - current;
+                  delta_squared_norm += delta.squaredNorm();
+                  if (extrapolated_primal != nullptr) {
+                    shard(*extrapolated_primal).segment(start, size) =
+                        value + delta;
+                  }
+                });
+            return delta_squared_norm;
+          });
   return result;
 }
 
 Solver::NextSolutionAndDelta Solver::ComputeNextDualSolution(
-    double dual_step_size, double extrapolation_factor,
-    const NextSolutionAndDelta& next_primal_solution) const {
+    double dual_step_size, const VectorXd& extrapolated_primal) const {
   const int64_t dual_size = ShardedWorkingQp().DualSize();
   NextSolutionAndDelta result = {
       .value = VectorXd(dual_size),
       .delta = VectorXd(dual_size),
   };
   const QuadraticProgram& qp = WorkingQp();
-  VectorXd extrapolated_primal(ShardedWorkingQp().PrimalSize());
-  ShardedWorkingQp().PrimalSharder().ParallelForEachShard(
-      [&](const Sharder::Shard& shard) {
-        shard(extrapolated_primal) =
-            (shard(next_primal_solution.value) +
-             extrapolation_factor * shard(next_primal_solution.delta));
-      });
-  // TODO(user): Refactor this multiplication so that we only do one matrix
-  // vector multiply for the primal variable. This only applies to Malitsky and
-  // Pock and not to the adaptive step size rule.
-  ShardedWorkingQp().TransposedConstraintMatrixSharder().ParallelForEachShard(
+  const ShardedQuadraticProgram& sharded_qp = ShardedWorkingQp();
+  const Sharder& sharder = sharded_qp.TransposedConstraintMatrixSharder();
+  result.delta_squared_norm = sharder.ParallelSumOverShards(
       [&](const Sharder::Shard& shard) {
-        VectorXd temp =
-            shard(current_dual_solution_) -
-            dual_step_size *
-                shard(ShardedWorkingQp().TransposedConstraintMatrix())
-                    .transpose() *
-                extrapolated_primal;
-        // Each element of the argument of `.cwiseMin()` is the critical point
-        // of the respective 1D minimization problem if it's negative.
-        // Likewise the argument to the `.cwiseMax()` is the critical point if
-        // positive.
-        shard(result.value) =
-            VectorXd::Zero(temp.size())
-                .cwiseMin(temp +
-                          dual_step_size * shard(qp.constraint_upper_bounds))
-                .cwiseMax(temp +
-                          dual_step_size * shard(qp.constraint_lower_bounds));
-        shard(result.delta) =
-            (shard(result.value) - shard(current_dual_solution_));
+        const int64_t shard_start = sharder.ShardStart(shard.Index());
+        auto shard_value = shard(result.value);
+        auto shard_delta = shard(result.delta);
+        const auto shard_current = shard(current_dual_solution_);
+        const auto shard_lower_bounds = shard(qp.constraint_lower_bounds);
+        const auto shard_upper_bounds = shard(qp.constraint_upper_bounds);
+        double delta_squared_norm = 0.0;
+        ForEachFusedKernelBlock(
+            shard_value.size(), [&](int64_t start, int64_t size) {
+              auto value = shard_value.segment(start, size);
+              auto delta = shard_delta.segment(start, size);
+              const auto current = shard_current.segment(start, size);
+              const auto lower_bounds = shard_lower_bounds.segment(start, size);
+              const auto upper_bounds = shard_upper_bounds.segment(start, size);
+              // The block is written in place, without temporary vectors.
+              for (int64_t i = 0; i < size; ++i) {
+                const double temp =
+                    current[i] -
+                    dual_step_size * sharded_qp.ConstraintActivity(
+                                         shard_start + start + i,
+                                         extrapolated_primal);
+                // The argument of `std::min()` is the critical point of the 1D
+                // minimization problem if it's negative. Likewise the second
+                // argument of `std::max()` is the critical point if positive.
+                value[i] = std::max(
+                    std::min(0.0, temp + dual_step_size * upper_bounds[i]),
+                    temp + dual_step_size * lower_bounds[i]);
+              }
+              delta = value - current;
+              delta_squared_norm += delta.squaredNorm();
+            });
+        return delta_squared_norm;
       });
   return result;
 }
 
-double Solver::ComputeMovement(const VectorXd& delta_primal,
-                               const VectorXd& delta_dual) const {
-  const double primal_movement =
-      (0.5 * primal_weight_) *
-      SquaredNorm(delta_primal, ShardedWorkingQp().PrimalSharder());
-  const double dual_movement =
-      (0.5 / primal_weight_) *
-      SquaredNorm(delta_dual, ShardedWorkingQp().DualSharder());
-  return primal_movement + dual_movement;
-}
-
-double Solver::ComputeNonlinearity(const VectorXd& delta_primal,
-                                   const VectorXd& next_dual_product) const {
-  // Lemma 1 in Chambolle and Pock includes a term with L_f, the Lipshitz
-  // constant of f. This is zero in our formulation.
-  return ShardedWorkingQp().PrimalSharder().ParallelSumOverShards(
+VectorXd Solver::ExtrapolatedPrimal(
+    const double extrapolation_factor,
+    const NextSolutionAndDelta& next_primal) const {
+  VectorXd extrapolated_primal(ShardedWorkingQp().PrimalSize());
+  ShardedWorkingQp().PrimalSharder().ParallelForEachShard(
       [&](const Sharder::Shard& shard) {
-        return -shard(delta_primal)
-                    .dot(shard(next_dual_product) -
-                         shard(current_dual_product_));
+        shard(extrapolated_primal) =
+            shard(next_primal.value) +
+            extrapolation_factor * shard(next_primal.delta);
       });
+  return extrapolated_primal;
+}
+
+double Solver::ComputeMovement(const double delta_primal_squared_norm,
+                               const double delta_dual_squared_norm) const {
+  return (0.5 * primal_weight_) * delta_primal_squared_norm +
+         (0.5 / primal_weight_) * delta_dual_squared_norm;
 }
 
 IterationStats Solver::CreateSimpleIterationStats(
@@ -2237,17 +2327,18 @@ InnerStepOutcome Solver::TakeMalitskyPockStep() {
     const double new_last_two_step_sizes_ratio =
         new_primal_step_size / primal_step_size;
     NextSolutionAndDelta next_dual_solution = ComputeNextDualSolution(
-        dual_weight * new_primal_step_size, new_last_two_step_sizes_ratio,
-        next_primal_solution);
+        dual_weight * new_primal_step_size,
+        ExtrapolatedPrimal(new_last_two_step_sizes_ratio,
+                           next_primal_solution));
 
-    VectorXd next_dual_product = TransposedMatrixVectorProduct(
+    ProductChange dual_product_change;
+    VectorXd next_dual_product = TransposedMatrixVectorProductAndChange(
         WorkingQp().constraint_matrix, next_dual_solution.value,
-        ShardedWorkingQp().ConstraintMatrixSharder());
-    double delta_dual_norm =
-        Norm(next_dual_solution.delta, ShardedWorkingQp().DualSharder());
+        current_dual_product_, next_primal_solution.delta,
+        ShardedWorkingQp().ConstraintMatrixSharder(), dual_product_change);
+    double delta_dual_norm = std::sqrt(next_dual_solution.delta_squared_norm);
     double delta_dual_prod_norm =
-        Distance(current_dual_product_, next_dual_product,
-                 ShardedWorkingQp().PrimalSharder());
+        std::sqrt(dual_product_change.squared_change_norm);
     if (primal_weight_ * new_primal_step_size * delta_dual_prod_norm <=
         contraction_factor * delta_dual_norm) {
       // Accept new_step_size as a good step.
@@ -2271,7 +2362,8 @@ InnerStepOutcome Solver::TakeMalitskyPockStep() {
       dual_average_.Add(current_dual_solution_,
                         /*weight=*/new_primal_step_size);
       const double movement =
-          ComputeMovement(next_primal_solution.delta, next_dual_solution.delta);
+          ComputeMovement(next_primal_solution.delta_squared_norm,
+                          next_dual_solution.delta_squared_norm);
       if (movement == 0.0) {
         LogNumericalTermination();
         ResetAverageToCurrent();
@@ -2304,12 +2396,14 @@ InnerStepOutcome Solver::TakeAdaptiveStep() {
     }
     const double primal_step_size = step_size_ / primal_weight_;
     const double dual_step_size = step_size_ * primal_weight_;
+    VectorXd extrapolated_primal;
     NextSolutionAndDelta next_primal_solution =
-        ComputeNextPrimalSolution(primal_step_size);
-    NextSolutionAndDelta next_dual_solution = ComputeNextDualSolution(
-        dual_step_size, /*extrapolation_factor=*/1.0, next_primal_solution);
+        ComputeNextPrimalSolution(primal_step_size, &extrapolated_primal);
+    NextSolutionAndDelta next_dual_solution =
+        ComputeNextDualSolution(dual_step_size, extrapolated_primal);
     const double movement =
-        ComputeMovement(next_primal_solution.delta, next_dual_solution.delta);
+        ComputeMovement(next_primal_solution.delta_squared_norm,
+                        next_dual_solution.delta_squared_norm);
     if (movement == 0.0) {
       LogNumericalTermination();
       ResetAverageToCurrent();
@@ -2320,11 +2414,14 @@ InnerStepOutcome Solver::TakeAdaptiveStep() {
       outcome = InnerStepOutcome::kForceNumericalTermination;
       break;
     }
-    VectorXd next_dual_product = TransposedMatrixVectorProduct(
+    // Lemma 1 in Chambolle and Pock includes a term with L_f, the Lipshitz
+    // constant of f. This is zero in our formulation.
+    ProductChange dual_product_change;
+    VectorXd next_dual_product = TransposedMatrixVectorProductAndChange(
         WorkingQp().constraint_matrix, next_dual_solution.value,
-        ShardedWorkingQp().ConstraintMatrixSharder());
-    const double nonlinearity =
-        ComputeNonlinearity(next_primal_solution.delta, next_dual_product);
+        current_dual_product_, next_primal_solution.delta,
+        ShardedWorkingQp().ConstraintMatrixSharder(), dual_product_change);
+    const double nonlinearity = -dual_product_change.direction_dot_change;
 
     // See equation (5) in https://arxiv.org/pdf/2106.04756.pdf.
     const double step_size_limit =
@@ -2378,12 +2475,14 @@ InnerStepOutcome Solver::TakeAdaptiveStep() {
 InnerStepOutcome Solver::TakeConstantSizeStep() {
   const double primal_step_size = step_size_ / primal_weight_;
   const double dual_step_size = step_size_ * primal_weight_;
+  VectorXd extrapolated_primal;
   NextSolutionAndDelta next_primal_solution =
-      ComputeNextPrimalSolution(primal_step_size);
-  NextSolutionAndDelta next_dual_solution = ComputeNextDualSolution(
-      dual_step_size, /*extrapolation_factor=*/1.0, next_primal_solution);
+      ComputeNextPrimalSolution(primal_step_size, &extrapolated_primal);
+  NextSolutionAndDelta next_dual_solution =
+      ComputeNextDualSolution(dual_step_size, extrapolated_primal);
   const double movement =
-      ComputeMovement(next_primal_solution.delta, next_dual_solution.delta);
+      ComputeMovement(next_primal_solution.delta_squared_norm,
+                      next_dual_solution.delta_squared_norm);
   if (movement == 0.0) {
     LogNumericalTermination();
     ResetAverageToCurrent();
@@ -2773,6 +2872,97 @@ SolverResult Solver::Solve(const IterationType iteration_type,
   }  // loop over iterations
 }
 
+glop::GlopParameters CrossoverParameters(
+    const PrimalDualHybridGradientParams& params,
+    const double elapsed_time_sec) {
+  glop::GlopParameters glop_params;
+  glop_params.set_crossover_bound_snapping_distance(1.0e-6);
+  if (params.crossover_options().has_glop_parameters()) {
+    glop_params.MergeFrom(params.crossover_options().glop_parameters());
+  }
+  glop_params.set_max_time_in_seconds(std::min(
+      glop_params.max_time_in_seconds(),
+      std::max(0.0, params.termination_criteria().time_sec_limit() -
+                        elapsed_time_sec)));
+  return glop_params;
+}
+
+// Runs the crossover from the solution in `result`, which must be an optimal
+// solution of `lp`. Replaces it with the basic solution found by the crossover
+// if that solution also satisfies the termination criteria.
+void ApplyCrossover(const PrimalDualHybridGradientParams& params,
+                    QuadraticProgram lp, SolverResult& result) {
+  WallTimer timer;
+  timer.Start();
+  // The crossover is sequential, and this is only used for one pass to check
+  // the termination criteria.
+  ShardedQuadraticProgram sharded_lp(std::move(lp), /*num_threads=*/1,
+                                     /*num_shards=*/1);
+  sharded_lp.ReplaceLargeConstraintBoundsWithInfinity(
+      params.infinite_constraint_bound_threshold());
+  const glop::GlopParameters glop_params =
+      CrossoverParameters(params, result.solve_log.solve_time_sec());
+  std::unique_ptr<TimeLimit> time_limit =
+      TimeLimit::FromParameters(glop_params);
+  absl::StatusOr<CrossoverResult> crossover =
+      Crossover(sharded_lp.Qp(), result.primal_solution, result.dual_solution,
+                glop_params, time_limit.get());
+  CrossoverDetails& details = *result.solve_log.mutable_crossover_details();
+  if (!crossover.ok()) {
+    LOG(WARNING) << "Skipping crossover: " << crossover.status();
+    details.set_status(crossover.status().ToString());
+  } else {
+    details.set_status(glop::GetProblemStatusString(crossover->status));
+    details.set_num_guessed_basic(crossover->num_guessed_basic);
+    details.set_simplex_iteration_count(crossover->simplex_iteration_count);
+  }
+  if (crossover.ok() && crossover->status == glop::ProblemStatus::OPTIMAL) {
+    const TerminationCriteria::DetailedOptimalityCriteria criteria =
+        EffectiveOptimalityCriteria(params.termination_criteria());
+    const ConvergenceInformation convergence_information =
+        ComputeConvergenceInformation(
+            params, sharded_lp, OnesVector(sharded_lp.PrimalSharder()),
+            OnesVector(sharded_lp.DualSharder()), crossover->primal_solution,
+            crossover->dual_solution,
+            EpsilonRatio(criteria.eps_optimal_primal_residual_absolute(),
+                         criteria.eps_optimal_primal_residual_relative()),
+            EpsilonRatio(criteria.eps_optimal_dual_residual_absolute(),
+                         criteria.eps_optimal_dual_residual_relative()),
+            POINT_TYPE_CROSSOVER_SOLUTION);
+    if (OptimalityCriteriaMet(
+            criteria, convergence_information,
+            params.termination_criteria().optimality_norm(),
+            BoundNormsFromProblemStats(
+                result.solve_log.original_problem_stats()))) {
+      result.reduced_costs =
+          ReducedCosts(params, sharded_lp, crossover->primal_solution,
+                       crossover->dual_solution);
+      result.primal_solution = std::move(crossover->primal_solution);
+      result.dual_solution = std::move(crossover->dual_solution);
+      result.variable_statuses = std::move(crossover->variable_statuses);
+      result.constraint_statuses = std::move(crossover->constraint_statuses);
+      *result.solve_log.mutable_solution_stats()
+           ->add_convergence_information() = convergence_information;
+      result.solve_log.set_solution_type(POINT_TYPE_CROSSOVER_SOLUTION);
+      details.set_solution_replaced(true);
+    } else {
+      LOG(WARNING) << "Keeping the PDHG solution because the solution found "
+                      "by crossover doesn't satisfy the optimality criteria.";
+    }
+  }
+  details.set_solve_time_sec(timer.Get());
+  result.solve_log.set_solve_time_sec(result.solve_log.solve_time_sec() +
+                                      details.solve_time_sec());
+  if (params.verbosity_level() >= 1) {
+    LogInfoWithoutPrefix(absl::StrFormat(
+        "Crossover: %s after %d simplex iterations in %.3f seconds, %s.",
+        details.status(), details.simplex_iteration_count(),
+        details.solve_time_sec(),
+        details.solution_replaced() ? "solution replaced"
+                                    : "solution kept"));
+  }
+}
+
 }  // namespace
 
 SolverResult PrimalDualHybridGradient(
@@ -2824,10 +3014,25 @@ SolverResult PrimalDualHybridGradient(
         TERMINATION_REASON_INVALID_PARAMETER,
         "use_feasibility_polishing is only implemented for linear programs.");
   }
+  if (params.crossover_options().use_crossover() && !IsLinearProgram(qp)) {
+    return ErrorSolverResult(
+        TERMINATION_REASON_INVALID_PARAMETER,
+        "crossover_options.use_crossover is only implemented for linear "
+        "programs.");
+  }
+  std::optional<QuadraticProgram> crossover_lp;
+  if (params.crossover_options().use_crossover()) {
+    crossover_lp = qp;
+  }
   PreprocessSolver solver(std::move(qp), params);
-  return solver.PreprocessAndSolve(params, std::move(initial_solution),
-                                   interrupt_solve,
-                                   std::move(iteration_stats_callback));
+  SolverResult result = solver.PreprocessAndSolve(
+      params, std::move(initial_solution), interrupt_solve,
+      std::move(iteration_stats_callback));
+  if (crossover_lp.has_value() &&
+      result.solve_log.termination_reason() == TERMINATION_REASON_OPTIMAL) {
+    ApplyCrossover(params, *std::move(crossover_lp), result);
+  }
+  return result;
 }
 
 namespace internal {
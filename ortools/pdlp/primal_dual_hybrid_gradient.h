@@ -20,6 +20,7 @@
 
 #include "Eigen/Core"
 #include "ortools/lp_data/lp_data.h"
+#include "ortools/lp_data/lp_types.h"
 #include "ortools/pdlp/quadratic_program.h"
 #include "ortools/pdlp/solve_log.pb.h"
 #include "ortools/pdlp/solvers.pb.h"
@@ -66,6 +67,11 @@ struct SolverResult {
   // https://developers.google.com/optimization/lp/pdlp_math#reduced_costs_dual_residuals_and_the_corrected_dual_objective
   // for details.
   Eigen::VectorXd reduced_costs;
+  // The basis of the solution. Empty unless the solution was found by
+  // crossover (`solve_log.solution_type` is `POINT_TYPE_CROSSOVER_SOLUTION`);
+  // see `PrimalDualHybridGradientParams.crossover_options`.
+  glop::VariableStatusRow variable_statuses;
+  glop::ConstraintStatusColumn constraint_statuses;
   SolveLog solve_log;
 };
 
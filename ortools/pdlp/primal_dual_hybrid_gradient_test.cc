@@ -896,6 +896,76 @@ TEST(PrimalDualHybridGradientTest, StepSizeScaling) {
             initial_step_size * kStepSizeScaling);
 }
 
+class PrimalDualHybridGradientFloatMatrixTest
+    : public testing::TestWithParam<
+          std::tuple<PrimalDualHybridGradientParams::LinesearchRule,
+                     /*num_threads=*/int>> {};
+
+INSTANTIATE_TEST_SUITE_P(
+    FloatMatrix, PrimalDualHybridGradientFloatMatrixTest,
+    testing::Combine(
+        testing::Values(
+            PrimalDualHybridGradientParams::ADAPTIVE_LINESEARCH_RULE,
+            PrimalDualHybridGradientParams::MALITSKY_POCK_LINESEARCH_RULE,
+            PrimalDualHybridGradientParams::CONSTANT_STEP_SIZE_RULE),
+        testing::Values(1, 4)),
+    [](const testing::TestParamInfo<
+        PrimalDualHybridGradientFloatMatrixTest::ParamType>& info) {
+      return absl::StrCat(PrimalDualHybridGradientParams::LinesearchRule_Name(
+                              std::get<0>(info.param)),
+                          "_", std::get<1>(info.param), "Threads");
+    });
+
+// With `use_float_transposed_constraint_matrix`, the test LPs should be solved
+// to the same moderate accuracy as in double precision, in a similar number of
+// iterations.
+TEST_P(PrimalDualHybridGradientFloatMatrixTest, ConvergenceParityOnTestLps) {
+  const auto [linesearch_rule, num_threads] = GetParam();
+  const std::vector<std::pair<std::string, QuadraticProgram>> lps = {
+      {"TestLp", TestLp()},
+      {"TinyLp", TinyLp()},
+      {"CorrelationClusteringLp", CorrelationClusteringLp()},
+      {"CorrelationClusteringStarLp", CorrelationClusteringStarLp()}};
+  for (const auto& [name, lp] : lps) {
+    SCOPED_TRACE(name);
+    PrimalDualHybridGradientParams params;
+    params.set_linesearch_rule(linesearch_rule);
+    params.set_num_threads(num_threads);
+    params.mutable_termination_criteria()->set_iteration_limit(20000);
+    params.mutable_termination_criteria()
+        ->mutable_simple_optimality_criteria()
+        ->set_eps_optimal_absolute(1.0e-6);
+    params.mutable_termination_criteria()
+        ->mutable_simple_optimality_criteria()
+        ->set_eps_optimal_relative(1.0e-6);
+    const SolverResult double_output = PrimalDualHybridGradient(lp, params);
+    params.set_use_float_transposed_constraint_matrix(true);
+    const SolverResult float_output = PrimalDualHybridGradient(lp, params);
+
+    ASSERT_EQ(double_output.solve_log.termination_reason(),
+              TERMINATION_REASON_OPTIMAL);
+    ASSERT_EQ(float_output.solve_log.termination_reason(),
+              TERMINATION_REASON_OPTIMAL);
+    EXPECT_LE(float_output.solve_log.iteration_count(),
+              2 * double_output.solve_log.iteration_count() + 64);
+    EXPECT_THAT(float_output.primal_solution,
+                EigenArrayNear(double_output.primal_solution, 1.0e-4));
+    EXPECT_THAT(float_output.dual_solution,
+                EigenArrayNear(double_output.dual_solution, 1.0e-4));
+    const auto& double_convergence_info =
+        GetConvergenceInformation(double_output.solve_log.solution_stats(),
+                                  double_output.solve_log.solution_type());
+    const auto& float_convergence_info =
+        GetConvergenceInformation(float_output.solve_log.solution_stats(),
+                                  float_output.solve_log.solution_type());
+    ASSERT_TRUE(double_convergence_info.has_value());
+    ASSERT_TRUE(float_convergence_info.has_value());
+    EXPECT_THAT(float_convergence_info->primal_objective(),
+                DoubleNear(double_convergence_info->primal_objective(),
+                           1.0e-4));
+  }
+}
+
 // This verifies that `kkt_matrix_pass_limit` is checked every iteration.
 TEST(PrimalDualHybridGradientTest, KktMatrixPassTermination) {
   const int kkt_matrix_pass_limit = 13;
@@ -1388,6 +1458,47 @@ TEST(PrimalDualHybridGradientTest, DetectsFeasibilityPolishingForQp) {
             TERMINATION_REASON_INVALID_PARAMETER);
 }
 
+TEST(PrimalDualHybridGradientTest, DetectsCrossoverForQp) {
+  QuadraticProgram qp = TestDiagonalQp1();
+  PrimalDualHybridGradientParams params;
+  params.mutable_crossover_options()->set_use_crossover(true);
+
+  SolverResult output = PrimalDualHybridGradient(qp, params);
+  EXPECT_EQ(output.solve_log.termination_reason(),
+            TERMINATION_REASON_INVALID_PARAMETER);
+}
+
+TEST(PrimalDualHybridGradientTest, CrossoverFindsOptimalBasis) {
+  PrimalDualHybridGradientParams params;
+  params.mutable_termination_criteria()
+      ->mutable_simple_optimality_criteria()
+      ->set_eps_optimal_absolute(1.0e-4);
+  params.mutable_termination_criteria()
+      ->mutable_simple_optimality_criteria()
+      ->set_eps_optimal_relative(0.0);
+  params.mutable_crossover_options()->set_use_crossover(true);
+
+  SolverResult output = PrimalDualHybridGradient(TinyLp(), params);
+  EXPECT_EQ(output.solve_log.termination_reason(), TERMINATION_REASON_OPTIMAL);
+  EXPECT_EQ(output.solve_log.solution_type(), POINT_TYPE_CROSSOVER_SOLUTION);
+  EXPECT_EQ(output.solve_log.crossover_details().status(), "OPTIMAL");
+  EXPECT_TRUE(output.solve_log.crossover_details().solution_replaced());
+  EXPECT_THAT(output.primal_solution,
+              ElementsAre(DoubleNear(1, 1.0e-12), DoubleNear(0, 1.0e-12),
+                          DoubleNear(6, 1.0e-12), DoubleNear(2, 1.0e-12)));
+  EXPECT_THAT(output.dual_solution,
+              ElementsAre(DoubleNear(0.5, 1.0e-12), DoubleNear(4, 1.0e-12),
+                          DoubleNear(0, 1.0e-12)));
+  EXPECT_THAT(output.variable_statuses,
+              ElementsAre(VariableStatus::BASIC, VariableStatus::AT_LOWER_BOUND,
+                          VariableStatus::AT_UPPER_BOUND,
+                          VariableStatus::BASIC));
+  EXPECT_THAT(output.constraint_statuses,
+              ElementsAre(ConstraintStatus::FIXED_VALUE,
+                          ConstraintStatus::AT_LOWER_BOUND,
+                          ConstraintStatus::BASIC));
+}
+
 TEST(PrimalDualHybridGradientTest, ChecksTerminationAtCorrectFrequency) {
   // `termination_check_frequency` is chosen so that it does not divide the
   // `major_iteration_frequency`.
@@ -2034,6 +2145,43 @@ TEST(PresolveTest, PresolveInfeasible) {
   EXPECT_EQ(output.solve_log.iteration_count(), 0);
 }
 
+TEST(PresolveTest, NativePresolveSolvesTestLp) {
+  PrimalDualHybridGradientParams params;
+  params.mutable_presolve_options()->set_use_native_presolve(true);
+  SolverResult output = PrimalDualHybridGradient(TestLp(), params);
+  VerifyTerminationReasonAndIterationCount(params, output,
+                                           /*use_iteration_limit=*/false);
+  EXPECT_EQ(output.solve_log.preprocessed_problem_stats().num_constraints(),
+            3);
+  VerifyObjectiveValues(output, -34.0, 1.0e-4);
+  EXPECT_THAT(output.primal_solution,
+              EigenArrayNear<double>({-1, 8, 1, 2.5}, 1.0e-4));
+  EXPECT_THAT(output.dual_solution,
+              EigenArrayNear<double>({-2, 0, 2.375, 2.0 / 3}, 1.0e-4));
+}
+
+TEST(PresolveTest, NativePresolveSolvesToOptimality) {
+  PrimalDualHybridGradientParams params;
+  params.mutable_presolve_options()->set_use_native_presolve(true);
+  SolverResult output =
+      PrimalDualHybridGradient(LpWithoutConstraints(), params);
+  EXPECT_EQ(output.solve_log.termination_reason(), TERMINATION_REASON_OPTIMAL);
+  EXPECT_EQ(output.solve_log.iteration_count(), 0);
+  EXPECT_EQ(output.solve_log.solution_type(), POINT_TYPE_PRESOLVER_SOLUTION);
+  EXPECT_THAT(output.primal_solution, ElementsAre(0.0, 0.0));
+}
+
+TEST(PresolveTest, NativePresolveInfeasible) {
+  PrimalDualHybridGradientParams params;
+  params.mutable_presolve_options()->set_use_native_presolve(true);
+  SolverResult output =
+      PrimalDualHybridGradient(SmallPrimalInfeasibleLp(), params);
+  EXPECT_EQ(output.solve_log.termination_reason(),
+            TERMINATION_REASON_PRIMAL_OR_DUAL_INFEASIBLE);
+  EXPECT_EQ(output.solve_log.solution_type(), POINT_TYPE_PRESOLVER_SOLUTION);
+  EXPECT_EQ(output.solve_log.iteration_count(), 0);
+}
+
 TEST_P(PresolveDualScalingTest, Dualize) {
   auto [dualize, negate_and_scale_objective] = GetParam();
   PrimalDualHybridGradientParams params;
@@ -13,6 +13,7 @@
 
 #include "ortools/pdlp/quadratic_program_io.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <limits>
@@ -101,9 +102,48 @@ absl::Status WriteQuadraticProgramToMPModelProto(
 
 namespace {
 
+// Sorts the entries of each column of the compressed `matrix` by row and sums
+// the repeated entries, which MPS files may contain. Compacts the storage in
+// place.
+void SortColumnsAndCombineRepeatedEntries(
+    Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix) {
+  int64_t* const outer = matrix.outerIndexPtr();
+  int64_t* const rows = matrix.innerIndexPtr();
+  double* const values = matrix.valuePtr();
+  std::vector<std::pair<int64_t, double>> entries;
+  int64_t num_non_zeros = 0;
+  for (int64_t col = 0; col < matrix.cols(); ++col) {
+    const int64_t begin = outer[col];
+    const int64_t end = outer[col + 1];
+    outer[col] = num_non_zeros;
+    entries.clear();
+    for (int64_t i = begin; i < end; ++i) {
+      entries.emplace_back(rows[i], values[i]);
+    }
+    // `std::stable_sort()` keeps repeated entries in file order, so that they
+    // are summed in the same order as before.
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const auto& lhs, const auto& rhs) {
+                       return lhs.first < rhs.first;
+                     });
+    for (const auto& [row, value] : entries) {
+      if (num_non_zeros > outer[col] && rows[num_non_zeros - 1] == row) {
+        values[num_non_zeros - 1] += value;
+      } else {
+        rows[num_non_zeros] = row;
+        values[num_non_zeros] = value;
+        ++num_non_zeros;
+      }
+    }
+  }
+  outer[matrix.cols()] = num_non_zeros;
+  matrix.data().resize(num_non_zeros);
+}
+
 // Class implementing the
 // `ortools/lp_data/mps_reader_template.h` interface that only
-// stores the names of rows and columns, and the number of non-zeros found.
+// stores the names of rows and columns, and the number of non-zeros found in
+// each column.
 class MpsReaderDimensionAndNames {
  public:
   using IndexType = int64_t;
@@ -111,7 +151,7 @@ class MpsReaderDimensionAndNames {
     read_or_parse_failed_ = false;
     col_name_to_index_.clear();
     row_name_to_index_.clear();
-    added_non_zeros_ = 0;
+    column_non_zeros_.clear();
   }
   void CleanUp() {}
   double ConstraintLowerBound(IndexType index) { return 0; }
@@ -122,15 +162,16 @@ class MpsReaderDimensionAndNames {
     return it->second;
   }
   IndexType FindOrCreateVariable(absl::string_view col_name) {
-    const auto [it, success_unused] = col_name_to_index_.try_emplace(
+    const auto [it, inserted] = col_name_to_index_.try_emplace(
         col_name, static_cast<IndexType>(col_name_to_index_.size()));
+    if (inserted) column_non_zeros_.push_back(0);
     return it->second;
   }
   void SetConstraintBounds(IndexType row_index, double lower_bound,
                            double upper_bound) {}
   void SetConstraintCoefficient(IndexType row_index, IndexType col_index,
                                 double coefficient) {
-    ++added_non_zeros_;
+    ++column_non_zeros_[col_index];
   }
   void SetIsLazy(IndexType row_index) {}
   void SetName(absl::string_view problem_name) {}
@@ -176,8 +217,11 @@ class MpsReaderDimensionAndNames {
     return it->second;
   }
 
-  // Number of non-zeros added so-far.
-  int64_t AddedNonZeros() const { return added_non_zeros_; }
+  // Number of non-zeros added so-far to each column, repeated entries
+  // included.
+  const std::vector<int64_t>& ColumnNonZeros() const {
+    return column_non_zeros_;
+  }
 
   // Number of variables added so-far.
   int64_t NumVariables() const { return col_name_to_index_.size(); }
@@ -202,11 +246,15 @@ class MpsReaderDimensionAndNames {
   bool read_or_parse_failed_ = false;
   absl::flat_hash_map<std::string, IndexType> col_name_to_index_;
   absl::flat_hash_map<std::string, IndexType> row_name_to_index_;
-  int64_t added_non_zeros_ = 0;
+  std::vector<int64_t> column_non_zeros_;
 };
 
 // Class implementing the
 // `ortools/lp_data/mps_reader_template.h` interface.
+// The non-zeros are written directly into the compressed storage of the
+// constraint matrix, whose columns are sized from the counts of the first pass,
+// so the peak memory is that of the final `QuadraticProgram` plus one counter
+// per column.
 // It is intended to be used in conjunction with `MpsReaderDimensionAndNames`
 // as follows:
 //
@@ -238,9 +286,24 @@ class MpsReaderQpDataWrapper {
   void SetUp() {
     const int64_t num_variables = dimension_and_names_.NumVariables();
     const int64_t num_constraints = dimension_and_names_.NumConstraints();
-    triplets_.reserve(dimension_and_names_.AddedNonZeros());
     quadratic_program_ = QuadraticProgram(/*num_variables=*/num_variables,
                                           /*num_constraints=*/num_constraints);
+    // Column `col` gets the positions [`next_entry_[col]`,
+    // `outerIndexPtr()[col + 1]`) of the compressed storage.
+    Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix =
+        quadratic_program_.constraint_matrix;
+    const std::vector<int64_t>& column_non_zeros =
+        dimension_and_names_.ColumnNonZeros();
+    next_entry_.resize(num_variables);
+    int64_t num_non_zeros = 0;
+    for (int64_t col = 0; col < num_variables; ++col) {
+      matrix.outerIndexPtr()[col] = num_non_zeros;
+      next_entry_[col] = num_non_zeros;
+      num_non_zeros += column_non_zeros[col];
+    }
+    matrix.outerIndexPtr()[num_variables] = num_non_zeros;
+    matrix.data().resize(num_non_zeros);
+    entries_mismatch_ = false;
     // Default variables in MPS files have a zero lower bound, an infinity
     // upper bound, and a zero objective; while default constraints are
     // 'equal to zero' constraints.
@@ -252,8 +315,18 @@ class MpsReaderQpDataWrapper {
         Eigen::VectorXd::Zero(num_variables);
   }
   void CleanUp() {
-    SetEigenMatrixFromTriplets(std::move(triplets_),
-                               quadratic_program_.constraint_matrix);
+    for (int64_t col = 0; col < dimension_and_names_.NumVariables(); ++col) {
+      if (next_entry_[col] !=
+          quadratic_program_.constraint_matrix.outerIndexPtr()[col + 1]) {
+        entries_mismatch_ = true;
+      }
+    }
+    // Frees the cursors before sorting.
+    next_entry_ = std::vector<int64_t>();
+    if (!entries_mismatch_) {
+      SortColumnsAndCombineRepeatedEntries(
+          quadratic_program_.constraint_matrix);
+    }
     // Deal with maximization problems.
     if (quadratic_program_.objective_scaling_factor == -1) {
       quadratic_program_.objective_offset *= -1;
@@ -294,8 +367,16 @@ class MpsReaderQpDataWrapper {
   }
   void SetConstraintCoefficient(IndexType row_index, IndexType col_index,
                                 double coefficient) {
-    DCHECK_LT(triplets_.size(), triplets_.capacity());
-    triplets_.emplace_back(row_index, col_index, coefficient);
+    Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix =
+        quadratic_program_.constraint_matrix;
+    const int64_t position = next_entry_[col_index];
+    if (position == matrix.outerIndexPtr()[col_index + 1]) {
+      entries_mismatch_ = true;
+      return;
+    }
+    matrix.innerIndexPtr()[position] = row_index;
+    matrix.valuePtr()[position] = coefficient;
+    ++next_entry_[col_index];
   }
   void SetIsLazy(IndexType row_index) {
     LOG_FIRST_N(WARNING, 1) << "Lazy constraint information lost, treated as "
@@ -344,6 +425,10 @@ class MpsReaderQpDataWrapper {
                    "been detected before (in MpsReaderDimensionAndNames)";
   }
 
+  // Returns true if the non-zeros of a column differ in number from the first
+  // pass, in which case the constraint matrix is invalid.
+  bool EntriesMismatch() const { return entries_mismatch_; }
+
   // Returns a `QuadraticProgram` holding all information read by the
   // `mps_reader_template.h` interface. It leaves the internal quadratic
   // program in an indeterminate state.
@@ -355,28 +440,35 @@ class MpsReaderQpDataWrapper {
   bool include_names_;
   QuadraticProgram quadratic_program_;
   const MpsReaderDimensionAndNames& dimension_and_names_;
-  std::vector<Eigen::Triplet<double, int64_t>> triplets_;
+  // The next free position of each column in the constraint matrix.
+  std::vector<int64_t> next_entry_;
+  bool entries_mismatch_ = false;
 };
 
 }  // namespace
 
-absl::StatusOr<QuadraticProgram> ReadMpsLinearProgram(
-    const std::string& lp_file, bool include_names) {
+namespace internal {
+
+absl::StatusOr<QuadraticProgram> TestableReadMpsLinearProgram(
+    const std::string& pass_one_file, const std::string& pass_two_file,
+    bool include_names) {
   MpsReaderDimensionAndNames dimension_and_names;
   // Collect MPS format, sizes and names.
   MPSReaderTemplate<MpsReaderDimensionAndNames> pass_one_reader;
   const absl::StatusOr<MPSReaderFormat> pass_one_format =
-      pass_one_reader.ParseFile(lp_file, &dimension_and_names,
+      pass_one_reader.ParseFile(pass_one_file, &dimension_and_names,
                                 MPSReaderFormat::kAutoDetect);
   if (!pass_one_format.ok()) {
-    return util::StatusBuilder(pass_one_format.status()) << absl::StrFormat(
-               "Could not read or parse file `%s` as an MPS file", lp_file);
+    return util::StatusBuilder(pass_one_format.status())
+           << absl::StrFormat(
+                  "Could not read or parse file `%s` as an MPS file",
+                  pass_one_file);
   }
   if (dimension_and_names.FailedToParse()) {
     return absl::InvalidArgumentError(absl::StrFormat(
         "Could not read or parse file `%s` as an MPS file, or unsupported "
         "features/sections found",
-        lp_file));
+        pass_one_file));
   }
   DCHECK(*pass_one_format == MPSReaderFormat::kFixed ||
          *pass_one_format == MPSReaderFormat::kFree);
@@ -384,26 +476,41 @@ absl::StatusOr<QuadraticProgram> ReadMpsLinearProgram(
   MpsReaderQpDataWrapper qp_data_wrapper(&dimension_and_names, include_names);
   MPSReaderTemplate<MpsReaderQpDataWrapper> pass_two_reader;
   const absl::StatusOr<MPSReaderFormat> pass_two_format =
-      pass_two_reader.ParseFile(lp_file, &qp_data_wrapper, *pass_one_format);
+      pass_two_reader.ParseFile(pass_two_file, &qp_data_wrapper,
+                                *pass_one_format);
   if (!pass_two_format.ok()) {
     return util::StatusBuilder(pass_two_format.status()) << absl::StrFormat(
                "Could not read or parse file `%s` as an MPS file "
                "(maybe file changed between reads?)",
-               lp_file);
+               pass_two_file);
+  }
+  if (qp_data_wrapper.EntriesMismatch()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Could not read or parse file `%s` as an MPS file (the non-zeros "
+        "differed between reads, maybe file changed?)",
+        pass_two_file));
   }
   DCHECK(*pass_one_format == *pass_two_format);
   return qp_data_wrapper.GetAndClearQuadraticProgram();
 }
 
+}  // namespace internal
+
+absl::StatusOr<QuadraticProgram> ReadMpsLinearProgram(
+    const std::string& lp_file, bool include_names) {
+  return internal::TestableReadMpsLinearProgram(lp_file, lp_file,
+                                                include_names);
+}
+
 QuadraticProgram ReadMpsLinearProgramOrDie(const std::string& lp_file,
                                            bool include_names) {
-  const absl::StatusOr<QuadraticProgram> result =
+  absl::StatusOr<QuadraticProgram> result =
       ReadMpsLinearProgram(lp_file, include_names);
   if (!result.ok()) {
     LOG(QFATAL) << "Error reading MPS Linear Program from " << lp_file << ": "
                 << result.status().message();
   }
-  return *result;
+  return *std::move(result);
 }
 
 }  // namespace operations_research::pdlp
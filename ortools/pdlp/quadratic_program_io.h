@@ -52,5 +52,15 @@ absl::Status WriteQuadraticProgramToMPModelProto(
     const QuadraticProgram& quadratic_program,
     const std::string& mpmodel_proto_file);
 
+// Utility functions for internal use only.
+namespace internal {
+// Like `ReadMpsLinearProgram()`, but the first pass, which reads the sizes and
+// names, reads `pass_one_file` and the second pass, which reads the data, reads
+// `pass_two_file`. `ReadMpsLinearProgram()` passes the same file twice and unit
+// tests pass different files, as if the file had changed between the reads.
+absl::StatusOr<QuadraticProgram> TestableReadMpsLinearProgram(
+    const std::string& pass_one_file, const std::string& pass_two_file,
+    bool include_names);
+}  // namespace internal
 }  // namespace operations_research::pdlp
 #endif  // PDLP_QUADRATIC_PROGRAM_IO_H_
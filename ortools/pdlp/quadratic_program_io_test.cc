@@ -0,0 +1,143 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/pdlp/quadratic_program_io.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/SparseCore"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ortools/base/file.h"
+#include "ortools/pdlp/quadratic_program.h"
+
+namespace operations_research::pdlp {
+namespace {
+
+using ::operations_research::pdlp::internal::TestableReadMpsLinearProgram;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+// Column x has its entries out of row order and two entries on row c1, in
+// separate lines. Column y has two entries on row c2 in the same line.
+constexpr char kRepeatedEntriesMps[] = R"(NAME repeated
+ROWS
+ N obj
+ L c1
+ L c2
+ L c3
+COLUMNS
+ x obj 1 c3 4
+ x c1 1.5
+ y c2 1 c2 2
+ x c1 -0.5
+ y c1 3
+RHS
+ rhs c1 1 c2 2
+ rhs c3 3
+ENDATA
+)";
+
+// Same rows and columns as `kRepeatedEntriesMps`, with one entry of x less.
+constexpr char kMissingEntryMps[] = R"(NAME repeated
+ROWS
+ N obj
+ L c1
+ L c2
+ L c3
+COLUMNS
+ x obj 1 c3 4
+ x c1 1.5
+ y c2 1 c2 2
+ y c1 3
+RHS
+ rhs c1 1 c2 2
+ rhs c3 3
+ENDATA
+)";
+
+// Same rows and columns as `kRepeatedEntriesMps`, with one entry of y more.
+constexpr char kExtraEntryMps[] = R"(NAME repeated
+ROWS
+ N obj
+ L c1
+ L c2
+ L c3
+COLUMNS
+ x obj 1 c3 4
+ x c1 1.5
+ y c2 1 c2 2
+ x c1 -0.5
+ y c1 3 c3 1
+RHS
+ rhs c1 1 c2 2
+ rhs c3 3
+ENDATA
+)";
+
+std::string WriteMps(const std::string& name, const std::string& contents) {
+  const std::string file_name =
+      absl::StrCat(::testing::TempDir(), "/", name, ".mps");
+  CHECK_OK(file::SetContents(file_name, contents, file::Defaults()));
+  return file_name;
+}
+
+TEST(ReadMpsLinearProgramTest, SumsRepeatedEntries) {
+  const std::string file_name =
+      WriteMps("repeated_entries", kRepeatedEntriesMps);
+  const absl::StatusOr<QuadraticProgram> lp = ReadMpsLinearProgram(file_name);
+  ASSERT_TRUE(lp.ok()) << lp.status();
+  const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix =
+      lp->constraint_matrix;
+  ASSERT_TRUE(matrix.isCompressed());
+  // The columns are sorted by row, without repeated entries.
+  EXPECT_THAT(
+      std::vector<int64_t>(matrix.outerIndexPtr(),
+                           matrix.outerIndexPtr() + matrix.cols() + 1),
+      ElementsAre(0, 2, 4));
+  EXPECT_THAT(std::vector<int64_t>(matrix.innerIndexPtr(),
+                                   matrix.innerIndexPtr() + matrix.nonZeros()),
+              ElementsAre(0, 2, 0, 1));
+  EXPECT_THAT(std::vector<double>(matrix.valuePtr(),
+                                  matrix.valuePtr() + matrix.nonZeros()),
+              ElementsAre(1.0, 4.0, 3.0, 3.0));
+  EXPECT_THAT(lp->objective_vector, ElementsAre(1.0, 0.0));
+  EXPECT_THAT(lp->constraint_upper_bounds, ElementsAre(1.0, 2.0, 3.0));
+}
+
+TEST(ReadMpsLinearProgramTest, RejectsNonZerosChangedBetweenReads) {
+  const std::string file_name =
+      WriteMps("repeated_entries", kRepeatedEntriesMps);
+  for (const auto& [name, contents] :
+       {std::make_pair("missing_entry", kMissingEntryMps),
+        std::make_pair("extra_entry", kExtraEntryMps)}) {
+    const std::string changed_file_name = WriteMps(name, contents);
+    const absl::StatusOr<QuadraticProgram> lp = TestableReadMpsLinearProgram(
+        file_name, changed_file_name, /*include_names=*/false);
+    EXPECT_EQ(lp.status().code(), absl::StatusCode::kInvalidArgument) << name;
+    EXPECT_THAT(lp.status().message(),
+                HasSubstr("the non-zeros differed between reads"))
+        << name;
+  }
+}
+
+}  // namespace
+}  // namespace operations_research::pdlp
@@ -14,6 +14,7 @@
 #include "ortools/pdlp/sharded_quadratic_program.h"
 
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -62,9 +63,17 @@ void WarnIfMatrixUnbalanced(
 
 ShardedQuadraticProgram::ShardedQuadraticProgram(QuadraticProgram qp,
                                                  const int num_threads,
-                                                 const int num_shards)
+                                                 const int num_shards,
+                                                 const bool pin_threads_to_cpus)
     : qp_(std::move(qp)),
-      transposed_constraint_matrix_(qp_.constraint_matrix.transpose()),
+      // With several threads, the transpose is computed in parallel below.
+      transposed_constraint_matrix_(
+          num_threads == 1
+              ? Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>(
+                    qp_.constraint_matrix.transpose())
+              : Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>(
+                    qp_.constraint_matrix.cols(),
+                    qp_.constraint_matrix.rows())),
       thread_pool_(num_threads == 1
                        ? nullptr
                        : std::make_unique<ThreadPool>("PDLP", num_threads)),
@@ -79,7 +88,34 @@ ShardedQuadraticProgram::ShardedQuadraticProgram(QuadraticProgram qp,
   CHECK_GE(num_threads, 1);
   CHECK_GE(num_shards, num_threads);
   if (num_threads > 1) {
+    thread_pool_->SetPinWorkersToCpus(pin_threads_to_cpus);
     thread_pool_->StartWorkers();
+    // The transposed sharder was built for an empty placeholder, so it is
+    // rebuilt once the transpose is known. Its shards are the ones that
+    // `ShardedTranspose()` first-touched.
+    ShardedTranspose(qp_.constraint_matrix, constraint_matrix_sharder_,
+                     num_shards)
+        .swap(transposed_constraint_matrix_);
+    transposed_constraint_matrix_sharder_ =
+        Sharder(transposed_constraint_matrix_, num_shards, thread_pool_.get());
+    // The QP was built by the calling thread, so all its pages are on the
+    // memory node of that thread. With pinned workers, copies them to pages
+    // first touched by the workers that own each shard. Unpinned workers may
+    // move between nodes, so the copies would only cost time and memory. The
+    // sharders only depend on the sparsity pattern, which is unchanged.
+    if (pin_threads_to_cpus) {
+      ShardedCopy(qp_.constraint_matrix, constraint_matrix_sharder_)
+          .swap(qp_.constraint_matrix);
+      qp_.objective_vector = CloneVector(qp_.objective_vector, primal_sharder_);
+      qp_.variable_lower_bounds =
+          CloneVector(qp_.variable_lower_bounds, primal_sharder_);
+      qp_.variable_upper_bounds =
+          CloneVector(qp_.variable_upper_bounds, primal_sharder_);
+      qp_.constraint_lower_bounds =
+          CloneVector(qp_.constraint_lower_bounds, dual_sharder_);
+      qp_.constraint_upper_bounds =
+          CloneVector(qp_.constraint_upper_bounds, dual_sharder_);
+    }
     const int64_t work_per_iteration = qp_.constraint_matrix.nonZeros() +
                                        qp_.variable_lower_bounds.size() +
                                        qp_.constraint_lower_bounds.size();
@@ -134,6 +170,7 @@ void ReplaceLargeValuesWithInfinity(const double threshold,
 void ShardedQuadraticProgram::RescaleQuadraticProgram(
     const Eigen::VectorXd& col_scaling_vec,
     const Eigen::VectorXd& row_scaling_vec) {
+  CHECK(!has_float_transposed_constraint_matrix_);
   CHECK_EQ(PrimalSize(), col_scaling_vec.size());
   CHECK_EQ(DualSize(), row_scaling_vec.size());
   primal_sharder_.ParallelForEachShard([&](const Sharder::Shard& shard) {
@@ -166,6 +203,38 @@ void ShardedQuadraticProgram::RescaleQuadraticProgram(
               transposed_constraint_matrix_);
 }
 
+bool ShardedQuadraticProgram::ConvertTransposedConstraintMatrixToFloat() {
+  if (has_float_transposed_constraint_matrix_) return true;
+  constexpr int64_t kMaxIndex = std::numeric_limits<int32_t>::max();
+  if (transposed_constraint_matrix_.nonZeros() > kMaxIndex ||
+      transposed_constraint_matrix_.rows() > kMaxIndex ||
+      transposed_constraint_matrix_.cols() > kMaxIndex) {
+    LOG(WARNING) << "The constraint matrix is too large for 32-bit indices, "
+                    "keeping it in double precision.";
+    return false;
+  }
+  float_transposed_constraint_matrix_ =
+      transposed_constraint_matrix_.cast<float>();
+  float_transposed_constraint_matrix_.makeCompressed();
+  // Frees the memory of the double precision transpose.
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>().swap(
+      transposed_constraint_matrix_);
+  has_float_transposed_constraint_matrix_ = true;
+  return true;
+}
+
+Eigen::VectorXd ShardedQuadraticProgram::ConstraintActivities(
+    const Eigen::VectorXd& primal_solution) const {
+  if (has_float_transposed_constraint_matrix_) {
+    return TransposedMatrixVectorProduct(float_transposed_constraint_matrix_,
+                                         primal_solution,
+                                         transposed_constraint_matrix_sharder_);
+  }
+  return TransposedMatrixVectorProduct(transposed_constraint_matrix_,
+                                       primal_solution,
+                                       transposed_constraint_matrix_sharder_);
+}
+
 void ShardedQuadraticProgram::ReplaceLargeConstraintBoundsWithInfinity(
     const double threshold) {
   ReplaceLargeValuesWithInfinity(threshold, DualSharder(),
@@ -21,6 +21,7 @@
 
 #include "Eigen/Core"
 #include "Eigen/SparseCore"
+#include "absl/log/check.h"
 #include "ortools/base/threadpool.h"
 #include "ortools/pdlp/quadratic_program.h"
 #include "ortools/pdlp/sharder.h"
@@ -29,7 +30,8 @@ namespace operations_research::pdlp {
 
 // This class stores:
 //  - A `QuadraticProgram` (QP)
-//  - A transposed version of the QP's constraint matrix
+//  - A transposed version of the QP's constraint matrix, optionally in single
+//    precision
 //  - A thread pool
 //  - Various `Sharder` objects for doing sharded matrix and vector
 //    computations.
@@ -37,7 +39,12 @@ class ShardedQuadraticProgram {
  public:
   // Requires `num_shards` >= `num_threads` >= 1.
   // Note that the `qp` is intentionally passed by value.
-  ShardedQuadraticProgram(QuadraticProgram qp, int num_threads, int num_shards);
+  // With `num_threads` > 1 and `pin_threads_to_cpus` true, the workers are
+  // pinned to distinct CPUs (see `ThreadPool::SetPinWorkersToCpus()`) and the
+  // vectors and matrices of the QP are copied so that each shard is first
+  // touched by the worker that processes it (see `Sharder::ShardWorker()`).
+  ShardedQuadraticProgram(QuadraticProgram qp, int num_threads, int num_shards,
+                          bool pin_threads_to_cpus = false);
 
   // Movable but not copyable.
   ShardedQuadraticProgram(const ShardedQuadraticProgram&) = delete;
@@ -48,11 +55,44 @@ class ShardedQuadraticProgram {
   const QuadraticProgram& Qp() const { return qp_; }
 
   // Returns a reference to the transpose of the QP's constraint matrix.
+  // Requires `!HasFloatTransposedConstraintMatrix()`.
   const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>&
   TransposedConstraintMatrix() const {
+    CHECK(!has_float_transposed_constraint_matrix_);
     return transposed_constraint_matrix_;
   }
 
+  // Replaces the transpose of the QP's constraint matrix by a copy with single
+  // precision values and 32-bit indices. This halves the memory used by the
+  // transpose, and the memory traffic of `ConstraintActivities()` and
+  // `ConstraintActivity()`, which still accumulate in double precision. The
+  // coefficients are rounded to about 7 significant digits, which is only
+  // suitable for moderate accuracy targets. Does nothing and returns false if
+  // the matrix is too large for 32-bit indices.
+  // After this, `TransposedConstraintMatrix()` can no longer be called and the
+  // QP can no longer be rescaled.
+  bool ConvertTransposedConstraintMatrixToFloat();
+
+  bool HasFloatTransposedConstraintMatrix() const {
+    return has_float_transposed_constraint_matrix_;
+  }
+
+  // Returns the QP's constraint matrix times `primal_solution`, computed in
+  // parallel from the transposed constraint matrix, in whichever precision it
+  // is stored.
+  Eigen::VectorXd ConstraintActivities(
+      const Eigen::VectorXd& primal_solution) const;
+
+  // Returns the `row`-th element of `ConstraintActivities(primal_solution)`.
+  double ConstraintActivity(const int64_t row,
+                            const Eigen::VectorXd& primal_solution) const {
+    return has_float_transposed_constraint_matrix_
+               ? SparseColumnDot(float_transposed_constraint_matrix_, row,
+                                 primal_solution)
+               : SparseColumnDot(transposed_constraint_matrix_, row,
+                                 primal_solution);
+  }
+
   // Returns a `Sharder` intended for the columns of the QP's constraint matrix.
   const Sharder& ConstraintMatrixSharder() const {
     return constraint_matrix_sharder_;
@@ -108,8 +148,13 @@ class ShardedQuadraticProgram {
 
  private:
   QuadraticProgram qp_;
+  // Empty if `has_float_transposed_constraint_matrix_`.
   Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>
       transposed_constraint_matrix_;
+  // Only used if `has_float_transposed_constraint_matrix_`.
+  Eigen::SparseMatrix<float, Eigen::ColMajor, int32_t>
+      float_transposed_constraint_matrix_;
+  bool has_float_transposed_constraint_matrix_ = false;
   std::unique_ptr<ThreadPool> thread_pool_;
   Sharder constraint_matrix_sharder_;
   Sharder transposed_constraint_matrix_sharder_;
@@ -15,6 +15,7 @@
 
 #include <limits>
 #include <optional>
+#include <utility>
 
 #include "Eigen/Core"
 #include "gmock/gmock.h"
@@ -48,6 +49,25 @@ TEST(ShardedQuadraticProgramTest, BasicTest) {
             dual_size);
 }
 
+TEST(ShardedQuadraticProgramTest, PinnedThreadsKeepTheQp) {
+  const int num_threads = 2;
+  const int num_shards = 4;
+  ShardedQuadraticProgram sharded_qp(TestLp(), num_threads, num_shards,
+                                     /*pin_threads_to_cpus=*/true);
+  const QuadraticProgram lp = TestLp();
+  EXPECT_EQ(Eigen::MatrixXd(sharded_qp.Qp().constraint_matrix),
+            Eigen::MatrixXd(lp.constraint_matrix));
+  EXPECT_EQ(Eigen::MatrixXd(sharded_qp.TransposedConstraintMatrix()),
+            Eigen::MatrixXd(lp.constraint_matrix.transpose()));
+  EXPECT_EQ(sharded_qp.Qp().objective_vector, lp.objective_vector);
+  EXPECT_EQ(sharded_qp.Qp().variable_lower_bounds, lp.variable_lower_bounds);
+  EXPECT_EQ(sharded_qp.Qp().variable_upper_bounds, lp.variable_upper_bounds);
+  EXPECT_EQ(sharded_qp.Qp().constraint_lower_bounds,
+            lp.constraint_lower_bounds);
+  EXPECT_EQ(sharded_qp.Qp().constraint_upper_bounds,
+            lp.constraint_upper_bounds);
+}
+
 TEST(ShardedQuadraticProgramTest, SwapVariableBounds) {
   const int num_threads = 2;
   const int num_shards = 2;
@@ -153,6 +173,46 @@ TEST(RescaleProblem, BasicTest) {
               EigenArrayEq<double>({4, 0.25}));
 }
 
+TEST(ShardedQuadraticProgramTest, ConstraintActivities) {
+  const int num_threads = 2;
+  const int num_shards = 2;
+  ShardedQuadraticProgram sharded_qp(TestLp(), num_threads, num_shards);
+  const Eigen::VectorXd primal_solution{{1, 2, 3, 4}};
+  EXPECT_THAT(sharded_qp.ConstraintActivities(primal_solution),
+              ElementsAre(15, 4, 4, 0.5));
+  EXPECT_EQ(sharded_qp.ConstraintActivity(3, primal_solution), 0.5);
+}
+
+TEST(ShardedQuadraticProgramTest, ConvertTransposedConstraintMatrixToFloat) {
+  const int num_threads = 2;
+  const int num_shards = 2;
+  ShardedQuadraticProgram sharded_qp(TestLp(), num_threads, num_shards);
+  EXPECT_FALSE(sharded_qp.HasFloatTransposedConstraintMatrix());
+  EXPECT_TRUE(sharded_qp.ConvertTransposedConstraintMatrixToFloat());
+  EXPECT_TRUE(sharded_qp.HasFloatTransposedConstraintMatrix());
+  // The coefficients of `TestLp()` are exact in single precision.
+  const Eigen::VectorXd primal_solution{{1, 2, 3, 4}};
+  EXPECT_THAT(sharded_qp.ConstraintActivities(primal_solution),
+              ElementsAre(15, 4, 4, 0.5));
+  EXPECT_EQ(sharded_qp.ConstraintActivity(0, primal_solution), 15);
+  // The constraint matrix itself stays in double precision.
+  EXPECT_THAT(ToDense(sharded_qp.Qp().constraint_matrix),
+              EigenArrayEq<double>(
+                  {{2, 1, 1, 2}, {1, 0, 1, 0}, {4, 0, 0, 0}, {0, 0, 1.5, -1}}));
+}
+
+TEST(ShardedQuadraticProgramTest, FloatConstraintActivitiesAreRounded) {
+  QuadraticProgram lp = TestLp();
+  lp.constraint_matrix.coeffRef(0, 0) = 0.1;
+  const int num_threads = 2;
+  const int num_shards = 2;
+  ShardedQuadraticProgram sharded_qp(std::move(lp), num_threads, num_shards);
+  ASSERT_TRUE(sharded_qp.ConvertTransposedConstraintMatrixToFloat());
+  const Eigen::VectorXd primal_solution{{1, 0, 0, 0}};
+  EXPECT_EQ(sharded_qp.ConstraintActivity(0, primal_solution),
+            static_cast<double>(0.1f));
+}
+
 TEST(ShardedQuadraticProgramTest, ReplaceLargeConstraintBoundsWithInfinity) {
   const int num_threads = 2;
   const int num_shards = 2;
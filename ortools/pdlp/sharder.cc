@@ -14,9 +14,11 @@
 #include "ortools/pdlp/sharder.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <functional>
+#include <utility>
 #include <vector>
 
 #include "Eigen/Core"
@@ -108,11 +110,13 @@ Sharder::Sharder(const Sharder& other_sharder, const int64_t num_elements)
 
 void Sharder::ParallelForEachShard(
     const std::function<void(const Shard&)>& func) const {
-  if (thread_pool_) {
+  // Running the shards in the calling thread when it is one of the workers
+  // avoids waiting for tasks queued behind the current one on that worker.
+  if (thread_pool_ != nullptr && thread_pool_->CurrentWorker() < 0) {
     absl::BlockingCounter counter(NumShards());
     VLOG(2) << "Starting ParallelForEachShard()";
     for (int shard_num = 0; shard_num < NumShards(); ++shard_num) {
-      thread_pool_->Schedule([&, shard_num]() {
+      thread_pool_->ScheduleOnWorker(ShardWorker(shard_num), [&, shard_num]() {
         WallTimer timer;
         if (VLOG_IS_ON(2)) {
           timer.Start();
@@ -175,6 +179,198 @@ VectorXd TransposedMatrixVectorProduct(
   return answer;
 }
 
+VectorXd TransposedMatrixVectorProduct(
+    const Eigen::SparseMatrix<float, Eigen::ColMajor, int32_t>& matrix,
+    const VectorXd& vector, const Sharder& sharder) {
+  CHECK_EQ(vector.size(), matrix.rows());
+  VectorXd answer(matrix.cols());
+  sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = sharder.ShardStart(shard.Index());
+    const int64_t shard_end = shard_start + sharder.ShardSize(shard.Index());
+    for (int64_t col = shard_start; col < shard_end; ++col) {
+      answer[col] = SparseColumnDot(matrix, col, vector);
+    }
+  });
+  return answer;
+}
+
+RowMajorMatrixXd TransposedMatrixMatrixProduct(
+    const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix,
+    const RowMajorMatrixXd& dense, const Sharder& sharder) {
+  CHECK_EQ(dense.rows(), matrix.rows());
+  CHECK_EQ(matrix.cols(), sharder.NumElements());
+  using InnerIterator =
+      Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>::InnerIterator;
+  RowMajorMatrixXd answer(matrix.cols(), dense.cols());
+  sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = sharder.ShardStart(shard.Index());
+    const int64_t shard_end = shard_start + sharder.ShardSize(shard.Index());
+    for (int64_t col = shard_start; col < shard_end; ++col) {
+      auto answer_row = answer.row(col);
+      answer_row.setZero();
+      for (InnerIterator it(matrix, col); it; ++it) {
+        answer_row += it.value() * dense.row(it.row());
+      }
+    }
+  });
+  return answer;
+}
+
+VectorXd TransposedMatrixVectorProductAndChange(
+    const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix,
+    const VectorXd& vector, const VectorXd& previous_answer,
+    const VectorXd& direction, const Sharder& sharder, ProductChange& change) {
+  CHECK_EQ(vector.size(), matrix.rows());
+  CHECK_EQ(previous_answer.size(), matrix.cols());
+  CHECK_EQ(direction.size(), matrix.cols());
+  VectorXd answer(matrix.cols());
+  std::vector<ProductChange> local_changes(sharder.NumShards());
+  sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = sharder.ShardStart(shard.Index());
+    const int64_t shard_end = shard_start + sharder.ShardSize(shard.Index());
+    // The reductions are done block by block, right after the product of the
+    // block, while its answer is still in cache.
+    double direction_dot_change = 0.0;
+    double squared_change_norm = 0.0;
+    ForEachFusedKernelBlock(
+        shard_end - shard_start, [&](int64_t start, int64_t size) {
+          const int64_t block_start = shard_start + start;
+          for (int64_t col = block_start; col < block_start + size; ++col) {
+            answer[col] = SparseColumnDot(matrix, col, vector);
+          }
+          const auto block_change = answer.segment(block_start, size) -
+                                    previous_answer.segment(block_start, size);
+          direction_dot_change +=
+              direction.segment(block_start, size).dot(block_change);
+          squared_change_norm += block_change.squaredNorm();
+        });
+    local_changes[shard.Index()] = {
+        .direction_dot_change = direction_dot_change,
+        .squared_change_norm = squared_change_norm};
+  });
+  change = ProductChange();
+  for (const ProductChange& local_change : local_changes) {
+    change.direction_dot_change += local_change.direction_dot_change;
+    change.squared_change_norm += local_change.squared_change_norm;
+  }
+  return answer;
+}
+
+Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> ShardedCopy(
+    const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix,
+    const Sharder& sharder) {
+  CHECK_EQ(matrix.cols(), sharder.NumElements());
+  if (!matrix.isCompressed()) {
+    Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> compressed = matrix;
+    compressed.makeCompressed();
+    return ShardedCopy(compressed, sharder);
+  }
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> copy(matrix.rows(),
+                                                             matrix.cols());
+  // This allocates the values and the indices without initializing them, so
+  // that their pages are only touched in the loop below.
+  copy.data().resize(matrix.nonZeros());
+  std::copy(matrix.outerIndexPtr(), matrix.outerIndexPtr() + matrix.cols() + 1,
+            copy.outerIndexPtr());
+  sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = sharder.ShardStart(shard.Index());
+    const int64_t begin = matrix.outerIndexPtr()[shard_start];
+    const int64_t end =
+        matrix.outerIndexPtr()[shard_start + sharder.ShardSize(shard.Index())];
+    std::copy(matrix.valuePtr() + begin, matrix.valuePtr() + end,
+              copy.valuePtr() + begin);
+    std::copy(matrix.innerIndexPtr() + begin, matrix.innerIndexPtr() + end,
+              copy.innerIndexPtr() + begin);
+  });
+  return copy;
+}
+
+Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> ShardedTranspose(
+    const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix,
+    const Sharder& sharder, const int num_transpose_shards) {
+  CHECK_EQ(matrix.cols(), sharder.NumElements());
+  using InnerIterator =
+      Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>::InnerIterator;
+  const int64_t num_rows = matrix.rows();
+  // First the number of non-zeros of each row, then the next free position in
+  // the corresponding column of the transpose.
+  std::vector<std::atomic<int64_t>> row_positions(num_rows);
+  sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = sharder.ShardStart(shard.Index());
+    const int64_t shard_end = shard_start + sharder.ShardSize(shard.Index());
+    for (int64_t col = shard_start; col < shard_end; ++col) {
+      for (InnerIterator it(matrix, col); it; ++it) {
+        row_positions[it.row()].fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  });
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> transpose(
+      matrix.cols(), num_rows);
+  int64_t num_non_zeros = 0;
+  for (int64_t row = 0; row < num_rows; ++row) {
+    transpose.outerIndexPtr()[row] = num_non_zeros;
+    num_non_zeros += row_positions[row].exchange(num_non_zeros,
+                                                 std::memory_order_relaxed);
+  }
+  transpose.outerIndexPtr()[num_rows] = num_non_zeros;
+  // This allocates the values and the indices without initializing them. Each
+  // worker then touches the pages of its shards of the transpose, so that the
+  // scatter below writes them where they are used.
+  transpose.data().resize(num_non_zeros);
+  const Sharder transpose_sharder(sharder, transpose, num_transpose_shards);
+  transpose_sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = transpose_sharder.ShardStart(shard.Index());
+    const int64_t shard_end =
+        shard_start + transpose_sharder.ShardSize(shard.Index());
+    const int64_t begin = transpose.outerIndexPtr()[shard_start];
+    const int64_t end = transpose.outerIndexPtr()[shard_end];
+    std::fill(transpose.innerIndexPtr() + begin,
+              transpose.innerIndexPtr() + end, int64_t{0});
+    std::fill(transpose.valuePtr() + begin, transpose.valuePtr() + end, 0.0);
+  });
+  sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = sharder.ShardStart(shard.Index());
+    const int64_t shard_end = shard_start + sharder.ShardSize(shard.Index());
+    for (int64_t col = shard_start; col < shard_end; ++col) {
+      for (InnerIterator it(matrix, col); it; ++it) {
+        const int64_t position = row_positions[it.row()].fetch_add(
+            1, std::memory_order_relaxed);
+        transpose.innerIndexPtr()[position] = col;
+        transpose.valuePtr()[position] = it.value();
+      }
+    }
+  });
+  // The shards scatter concurrently, so the entries of a column of the
+  // transpose are in an arbitrary order. Sorting by index and value also makes
+  // the order of repeated entries deterministic.
+  transpose_sharder.ParallelForEachShard([&](const Sharder::Shard& shard) {
+    const int64_t shard_start = transpose_sharder.ShardStart(shard.Index());
+    const int64_t shard_end =
+        shard_start + transpose_sharder.ShardSize(shard.Index());
+    std::vector<std::pair<int64_t, double>> entries;
+    for (int64_t col = shard_start; col < shard_end; ++col) {
+      const int64_t begin = transpose.outerIndexPtr()[col];
+      const int64_t end = transpose.outerIndexPtr()[col + 1];
+      int64_t* const indices = transpose.innerIndexPtr();
+      if (std::adjacent_find(indices + begin, indices + end,
+                             [](int64_t a, int64_t b) { return a >= b; }) ==
+          indices + end) {
+        continue;
+      }
+      entries.clear();
+      for (int64_t i = begin; i < end; ++i) {
+        entries.emplace_back(indices[i], transpose.valuePtr()[i]);
+      }
+      std::sort(entries.begin(), entries.end());
+      for (int64_t i = begin; i < end; ++i) {
+        indices[i] = entries[i - begin].first;
+        transpose.valuePtr()[i] = entries[i - begin].second;
+      }
+    }
+  });
+  return transpose;
+}
+
 void SetZero(const Sharder& sharder, VectorXd& dest) {
   dest.resize(sharder.NumElements());
   sharder.ParallelForEachShard(
@@ -14,6 +14,7 @@
 #ifndef PDLP_SHARDER_H_
 #define PDLP_SHARDER_H_
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <type_traits>
@@ -170,6 +171,15 @@ class Sharder {
   // comments on the first constructor.
   Sharder(const Sharder& other_sharder, int64_t num_elements);
 
+  // Constructs a `Sharder` with the same thread pool as `other_sharder`, for
+  // processing `matrix` with approximately `num_shards` shards. This is the
+  // same as `Sharder(matrix, num_shards, thread_pool)` with the thread pool of
+  // `other_sharder`.
+  Sharder(const Sharder& other_sharder,
+          const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix,
+          int num_shards)
+      : Sharder(matrix, num_shards, other_sharder.thread_pool_) {}
+
   // `Sharder` may be moved, but not copied.
   // Moved-from objects may be in an invalid state. The only methods that may be
   // called on a moved-from object are the destructor or `operator=`.
@@ -201,7 +211,22 @@ class Sharder {
     return shard_masses_[shard];
   }
 
-  // Runs `func` on each of the shards.
+  // The worker of the thread pool that runs `shard` in the parallel functions
+  // below. This is the same for all the `Sharder`s with the same number of
+  // shards and thread pool, so that the threads keep processing the same parts
+  // of the vectors and matrices. With first-touch page placement, the memory
+  // of a vector or matrix is on the NUMA node of the worker that first writes
+  // it, so vectors initialized with these functions (e.g. `ZeroVector()` and
+  // `CloneVector()`) have each shard in the memory of its worker's node.
+  int ShardWorker(int shard) const {
+    CHECK_GE(shard, 0);
+    CHECK_LT(shard, NumShards());
+    return thread_pool_ == nullptr ? 0 : shard % thread_pool_->NumWorkers();
+  }
+
+  // Runs `func` on each of the shards. With a thread pool, the shard `s` is run
+  // by the worker `ShardWorker(s)`, or by the calling thread if it is already
+  // one of the workers.
   void ParallelForEachShard(
       const std::function<void(const Shard&)>& func) const;
 
@@ -238,6 +263,103 @@ Eigen::VectorXd TransposedMatrixVectorProduct(
     const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix,
     const Eigen::VectorXd& vector, const Sharder& sharder);
 
+// Same as above for a matrix stored in single precision with 32-bit indices.
+// The products are accumulated in double precision.
+Eigen::VectorXd TransposedMatrixVectorProduct(
+    const Eigen::SparseMatrix<float, Eigen::ColMajor, int32_t>& matrix,
+    const Eigen::VectorXd& vector, const Sharder& sharder);
+
+// A dense matrix with one column per right-hand side of
+// `TransposedMatrixMatrixProduct()`. Row-major, so that the entries multiplied
+// by one non-zero of the sparse matrix are contiguous.
+using RowMajorMatrixXd =
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+// Like `matrix.transpose() * dense` but executed in parallel using `sharder`.
+// The size of `sharder` must match the number of columns in `matrix`. This
+// reads `matrix` once for all the columns of `dense`, instead of once per
+// column with `TransposedMatrixVectorProduct()`, and each column of the result
+// is the same as with `TransposedMatrixVectorProduct()` up to rounding.
+RowMajorMatrixXd TransposedMatrixMatrixProduct(
+    const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix,
+    const RowMajorMatrixXd& dense, const Sharder& sharder);
+
+// Returns `matrix.col(col).dot(vector)`, accumulated in double precision
+// whatever the scalar type of `matrix`.
+template <typename Scalar, typename StorageIndex>
+double SparseColumnDot(
+    const Eigen::SparseMatrix<Scalar, Eigen::ColMajor, StorageIndex>& matrix,
+    const int64_t col, const Eigen::VectorXd& vector) {
+  double result = 0.0;
+  for (typename Eigen::SparseMatrix<Scalar, Eigen::ColMajor,
+                                    StorageIndex>::InnerIterator it(matrix,
+                                                                    col);
+       it; ++it) {
+    result += static_cast<double>(it.value()) * vector[it.row()];
+  }
+  return result;
+}
+
+// Fused kernels process each shard by consecutive blocks of at most this many
+// elements, and do all their work on a block before moving to the next one, so
+// that the block is still in cache when it is read again. This avoids
+// streaming the vectors through memory once per operation, which matters since
+// the iterations are memory-bandwidth bound on large problems.
+constexpr int64_t kFusedKernelBlockSize = 1024;
+
+// Calls `block_function(start, size)` on consecutive blocks of at most
+// `kFusedKernelBlockSize` elements that cover [0, `num_elements`).
+template <typename BlockFunction>
+void ForEachFusedKernelBlock(int64_t num_elements,
+                             const BlockFunction& block_function) {
+  for (int64_t start = 0; start < num_elements;
+       start += kFusedKernelBlockSize) {
+    block_function(start,
+                   std::min(kFusedKernelBlockSize, num_elements - start));
+  }
+}
+
+// The reductions computed by `TransposedMatrixVectorProductAndChange()`.
+struct ProductChange {
+  // `direction.dot(answer - previous_answer)`.
+  double direction_dot_change = 0.0;
+  // `(answer - previous_answer).squaredNorm()`.
+  double squared_change_norm = 0.0;
+};
+
+// Like `TransposedMatrixVectorProduct()`, but also computes the change from
+// `previous_answer` to the returned answer, as described in `ProductChange`,
+// in the same pass (see `kFusedKernelBlockSize`). `previous_answer` and
+// `direction` must have the size of `sharder`. The reductions are summed over
+// the shards in shard order.
+Eigen::VectorXd TransposedMatrixVectorProductAndChange(
+    const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix,
+    const Eigen::VectorXd& vector, const Eigen::VectorXd& previous_answer,
+    const Eigen::VectorXd& direction, const Sharder& sharder,
+    ProductChange& change);
+
+// Returns a compressed copy of `matrix` in which the values and row indices of
+// the columns of each shard are first written by `sharder.ShardWorker()` of
+// that shard. With first-touch page placement this puts them in the memory of
+// the NUMA node of the worker that uses them in the products above. The size of
+// `sharder` must match the number of columns in `matrix`.
+Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> ShardedCopy(
+    const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix,
+    const Sharder& sharder);
+
+// Returns `matrix.transpose()` as a compressed column-major matrix, with the
+// entries of each column sorted by row. The non-zeros of each row of `matrix`
+// are counted and scattered in parallel over the shards of `sharder`, whose
+// size must match the number of columns in `matrix`, and the columns of the
+// result are then sorted in parallel. Unlike Eigen's transpose, this needs no
+// memory besides the result and one counter per row of `matrix`.
+// The values and column indices of each shard of
+// `Sharder(sharder, result, num_transpose_shards)` are first written by the
+// worker of that shard, as in `ShardedCopy()`.
+Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> ShardedTranspose(
+    const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix,
+    const Sharder& sharder, int num_transpose_shards);
+
 ////////////////////////////////////////////////////////////////////////////////
 // The following functions use `sharder` to compute a vector operation in
 // parallel. `sharder` should have the same size as the vector(s). For best
@@ -0,0 +1,217 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Memory traffic of the products done by PDHG.
+//
+// The first benchmarks compare the product and reductions done by the adaptive
+// step of PDHG, `K^T y` followed by `delta_x^T (K^T y - previous K^T y)` and
+// `|K^T y - previous K^T y|^2`, computed with separate sharded passes versus
+// with `TransposedMatrixVectorProductAndChange()`. The last one compares the
+// product with a matrix in double and in single precision.
+//
+// The bytes_moved counter is a model of the bytes read and written from memory
+// per call, assuming that nothing but a `kFusedKernelBlockSize` block stays in
+// cache: each pass over a vector of n doubles moves 8n bytes, and the product
+// moves the matrix (a value and an index per non-zero, plus the column starts)
+// once. Since the product gathers the entries of `vector` at random, the time
+// is also bound by the memory latency, which the model ignores.
+//
+// `BM_ShardedQpProductsScaling` measures how the products of a PDHG iteration
+// on a large LP scale with the number of threads, with and without pinning the
+// threads to CPUs (see `PrimalDualHybridGradientParams.pin_threads_to_cpus`).
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/SparseCore"
+#include "benchmark/benchmark.h"
+#include "ortools/base/threadpool.h"
+#include "ortools/pdlp/quadratic_program.h"
+#include "ortools/pdlp/sharded_quadratic_program.h"
+#include "ortools/pdlp/sharder.h"
+
+namespace operations_research::pdlp {
+namespace {
+
+using ::Eigen::VectorXd;
+
+constexpr int kEntriesPerCol = 8;
+
+Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> RandomMatrix(
+    const int64_t num_rows, const int64_t num_cols) {
+  std::mt19937 random(12345);
+  std::uniform_int_distribution<int64_t> row(0, num_rows - 1);
+  std::uniform_real_distribution<double> value(-1.0, 1.0);
+  std::vector<Eigen::Triplet<double, int64_t>> triplets;
+  triplets.reserve(num_cols * kEntriesPerCol);
+  for (int64_t col = 0; col < num_cols; ++col) {
+    for (int e = 0; e < kEntriesPerCol; ++e) {
+      triplets.emplace_back(row(random), col, value(random));
+    }
+  }
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> matrix(num_rows,
+                                                               num_cols);
+  matrix.setFromTriplets(triplets.begin(), triplets.end());
+  matrix.makeCompressed();
+  return matrix;
+}
+
+int64_t MatrixBytes(
+    const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t>& matrix) {
+  return matrix.nonZeros() * (sizeof(double) + sizeof(int64_t)) +
+         matrix.cols() * sizeof(int64_t);
+}
+
+// Arguments are the number of columns (the number of rows is half of it) and
+// the number of threads.
+void BM_UnfusedProductAndChange(benchmark::State& state) {
+  const int64_t num_cols = state.range(0);
+  const int num_threads = state.range(1);
+  const auto matrix = RandomMatrix(num_cols / 2, num_cols);
+  ThreadPool pool("BM_UnfusedProductAndChange", num_threads);
+  pool.StartWorkers();
+  Sharder sharder(matrix, 4 * num_threads, &pool);
+  const VectorXd vector = VectorXd::Random(matrix.rows());
+  const VectorXd previous_answer = VectorXd::Random(num_cols);
+  const VectorXd direction = VectorXd::Random(num_cols);
+  for (auto _ : state) {
+    const VectorXd answer =
+        TransposedMatrixVectorProduct(matrix, vector, sharder);
+    const double direction_dot_change = sharder.ParallelSumOverShards(
+        [&](const Sharder::Shard& shard) {
+          return shard(direction).dot(shard(answer) -
+                                      shard(previous_answer));
+        });
+    const double squared_change_norm =
+        SquaredDistance(answer, previous_answer, sharder);
+    benchmark::DoNotOptimize(direction_dot_change);
+    benchmark::DoNotOptimize(squared_change_norm);
+  }
+  // Product: matrix, `vector` and the answer. Dot: three vectors. Distance:
+  // two vectors.
+  const int64_t bytes_moved =
+      MatrixBytes(matrix) +
+      sizeof(double) * (matrix.rows() + num_cols + 3 * num_cols + 2 * num_cols);
+  state.counters["bytes_moved"] = bytes_moved;
+}
+BENCHMARK(BM_UnfusedProductAndChange)
+    ->ArgNames({"cols", "threads"})
+    ->ArgsProduct({{1 << 16, 1 << 20, 1 << 22}, {1, 4}})
+    ->UseRealTime();
+
+void BM_FusedProductAndChange(benchmark::State& state) {
+  const int64_t num_cols = state.range(0);
+  const int num_threads = state.range(1);
+  const auto matrix = RandomMatrix(num_cols / 2, num_cols);
+  ThreadPool pool("BM_FusedProductAndChange", num_threads);
+  pool.StartWorkers();
+  Sharder sharder(matrix, 4 * num_threads, &pool);
+  const VectorXd vector = VectorXd::Random(matrix.rows());
+  const VectorXd previous_answer = VectorXd::Random(num_cols);
+  const VectorXd direction = VectorXd::Random(num_cols);
+  for (auto _ : state) {
+    ProductChange change;
+    const VectorXd answer = TransposedMatrixVectorProductAndChange(
+        matrix, vector, previous_answer, direction, sharder, change);
+    benchmark::DoNotOptimize(answer.data());
+    benchmark::DoNotOptimize(change);
+  }
+  // Matrix, `vector`, the answer, `previous_answer` and `direction`.
+  const int64_t bytes_moved =
+      MatrixBytes(matrix) +
+      sizeof(double) * (matrix.rows() + num_cols + 2 * num_cols);
+  state.counters["bytes_moved"] = bytes_moved;
+}
+BENCHMARK(BM_FusedProductAndChange)
+    ->ArgNames({"cols", "threads"})
+    ->ArgsProduct({{1 << 16, 1 << 20, 1 << 22}, {1, 4}})
+    ->UseRealTime();
+
+// `TransposedMatrixVectorProduct()` with the matrix in double precision and
+// 64-bit indices (argument 0) or in single precision and 32-bit indices
+// (argument 1), as with `use_float_transposed_constraint_matrix`.
+void BM_TransposedMatrixVectorProduct(benchmark::State& state) {
+  const bool use_float = state.range(0);
+  const int64_t num_cols = state.range(1);
+  const auto matrix = RandomMatrix(num_cols / 2, num_cols);
+  const Eigen::SparseMatrix<float, Eigen::ColMajor, int32_t> float_matrix =
+      matrix.cast<float>();
+  Sharder sharder(matrix, /*num_shards=*/1, nullptr);
+  const VectorXd vector = VectorXd::Random(matrix.rows());
+  for (auto _ : state) {
+    const VectorXd answer =
+        use_float ? TransposedMatrixVectorProduct(float_matrix, vector, sharder)
+                  : TransposedMatrixVectorProduct(matrix, vector, sharder);
+    benchmark::DoNotOptimize(answer.data());
+  }
+  const int64_t matrix_bytes =
+      use_float ? matrix.nonZeros() * (sizeof(float) + sizeof(int32_t)) +
+                      num_cols * sizeof(int32_t)
+                : MatrixBytes(matrix);
+  state.counters["bytes_moved"] =
+      matrix_bytes + sizeof(double) * (matrix.rows() + num_cols);
+}
+BENCHMARK(BM_TransposedMatrixVectorProduct)
+    ->ArgNames({"float", "cols"})
+    ->ArgsProduct({{0, 1}, {1 << 16, 1 << 20, 1 << 22}});
+
+// Arguments are the number of threads and whether they are pinned to CPUs.
+// Each iteration does the products of one PDHG iteration, `K^T y` with its
+// change and `K x`, and updates `x`, on an LP with 2^22 variables and 2^21
+// constraints.
+void BM_ShardedQpProductsScaling(benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const bool pin_threads_to_cpus = state.range(1);
+  const int64_t num_cols = int64_t{1} << 22;
+  QuadraticProgram lp(num_cols, num_cols / 2);
+  lp.constraint_matrix = RandomMatrix(num_cols / 2, num_cols);
+  lp.objective_vector = VectorXd::Random(num_cols);
+  ShardedQuadraticProgram sharded_qp(std::move(lp), num_threads,
+                                     4 * num_threads, pin_threads_to_cpus);
+  const Sharder& primal_sharder = sharded_qp.PrimalSharder();
+  VectorXd primal = ZeroVector(primal_sharder);
+  const VectorXd dual =
+      CloneVector(VectorXd::Random(num_cols / 2), sharded_qp.DualSharder());
+  VectorXd dual_product = ZeroVector(primal_sharder);
+  const VectorXd direction = OnesVector(primal_sharder);
+  for (auto _ : state) {
+    ProductChange change;
+    VectorXd next_dual_product = TransposedMatrixVectorProductAndChange(
+        sharded_qp.Qp().constraint_matrix, dual, dual_product, direction,
+        sharded_qp.ConstraintMatrixSharder(), change);
+    dual_product.swap(next_dual_product);
+    AddScaledVector(-1.0e-3, dual_product, primal_sharder, primal);
+    const VectorXd primal_product = TransposedMatrixVectorProduct(
+        sharded_qp.TransposedConstraintMatrix(), primal,
+        sharded_qp.TransposedConstraintMatrixSharder());
+    benchmark::DoNotOptimize(primal_product.data());
+    benchmark::DoNotOptimize(change);
+  }
+  // Both products move the matrix, the vector they multiply and the answer;
+  // the change also reads the previous answer and `direction`, and the update
+  // reads and writes `primal` and reads `dual_product`.
+  state.counters["bytes_moved"] =
+      2 * MatrixBytes(sharded_qp.Qp().constraint_matrix) +
+      sizeof(double) * (3 * num_cols / 2 + 4 * num_cols + 3 * num_cols);
+}
+BENCHMARK(BM_ShardedQpProductsScaling)
+    ->ArgNames({"threads", "pin"})
+    ->ArgsProduct({{1, 2, 4, 8, 16, 32, 64}, {0, 1}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace operations_research::pdlp
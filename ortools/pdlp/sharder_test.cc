@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <numeric>
 #include <random>
+#include <utility>
 #include <vector>
 
 #include "Eigen/Core"
@@ -36,6 +37,7 @@ using ::Eigen::DiagonalMatrix;
 using ::Eigen::VectorXd;
 using ::testing::DoubleNear;
 using ::testing::ElementsAre;
+using ::testing::Pair;
 using ::testing::Test;
 using Shard = Sharder::Shard;
 
@@ -257,6 +259,107 @@ TEST(MatrixVectorProductTest, SmallExample) {
   EXPECT_THAT(ans, ElementsAre(6.0, -0.5, 6.0, 19));
 }
 
+TEST(MatrixVectorProductTest, SmallFloatExample) {
+  const Eigen::SparseMatrix<float, Eigen::ColMajor, int32_t> mat =
+      TestSparseMatrix().cast<float>();
+  Sharder sharder(TestSparseMatrix(), /*num_shards=*/3, nullptr);
+  const VectorXd vec{{1, 2, 3}};
+  VectorXd ans = TransposedMatrixVectorProduct(mat, vec, sharder);
+  EXPECT_THAT(ans, ElementsAre(6.0, -0.5, 6.0, 19));
+}
+
+TEST(TransposedMatrixMatrixProductTest, SmallExample) {
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> mat =
+      TestSparseMatrix();
+  Sharder sharder(mat, /*num_shards=*/3, nullptr);
+  RowMajorMatrixXd dense(mat.rows(), 2);
+  dense << 1, 2, 3, 4, 5, 6;
+  const RowMajorMatrixXd product =
+      TransposedMatrixMatrixProduct(mat, dense, sharder);
+  for (int col = 0; col < 2; ++col) {
+    EXPECT_EQ(VectorXd(product.col(col)),
+              TransposedMatrixVectorProduct(mat, dense.col(col), sharder));
+  }
+}
+
+TEST(SparseColumnDotTest, AccumulatesInDouble) {
+  Eigen::SparseMatrix<float, Eigen::ColMajor, int32_t> mat(2, 1);
+  mat.coeffRef(0, 0) = 1.0f;
+  mat.coeffRef(1, 0) = 1.0f;
+  mat.makeCompressed();
+  // 1 + 1e-10 is not representable in single precision.
+  const VectorXd vec{{1.0, 1.0e-10}};
+  EXPECT_EQ(SparseColumnDot(mat, 0, vec), 1.0 + 1.0e-10);
+}
+
+TEST(MatrixVectorProductAndChangeTest, SmallExample) {
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> mat =
+      TestSparseMatrix();
+  Sharder sharder(mat, /*num_shards=*/3, nullptr);
+  const VectorXd vec{{1, 2, 3}};
+  const VectorXd previous_answer{{1, 1, 1, 1}};
+  const VectorXd direction{{1, 0, -1, 2}};
+  ProductChange change;
+  VectorXd ans = TransposedMatrixVectorProductAndChange(
+      mat, vec, previous_answer, direction, sharder, change);
+  EXPECT_THAT(ans, ElementsAre(6.0, -0.5, 6.0, 19));
+  EXPECT_EQ(change.direction_dot_change, 36.0);
+  EXPECT_EQ(change.squared_change_norm, 376.25);
+}
+
+TEST(ForEachFusedKernelBlockTest, CoversAllElements) {
+  const int64_t num_elements = 2 * kFusedKernelBlockSize + 3;
+  std::vector<std::pair<int64_t, int64_t>> blocks;
+  ForEachFusedKernelBlock(num_elements, [&](int64_t start, int64_t size) {
+    blocks.emplace_back(start, size);
+  });
+  EXPECT_THAT(blocks, ElementsAre(Pair(0, kFusedKernelBlockSize),
+                                  Pair(kFusedKernelBlockSize,
+                                       kFusedKernelBlockSize),
+                                  Pair(2 * kFusedKernelBlockSize, 3)));
+}
+
+TEST(ShardedCopyTest, SmallExample) {
+  const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> mat =
+      TestSparseMatrix();
+  Sharder sharder(mat, /*num_shards=*/3, nullptr);
+  const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> copy =
+      ShardedCopy(mat, sharder);
+  EXPECT_TRUE(copy.isCompressed());
+  EXPECT_EQ(copy.nonZeros(), mat.nonZeros());
+  EXPECT_EQ(Eigen::MatrixXd(copy), Eigen::MatrixXd(mat));
+}
+
+TEST(ShardedCopyTest, UncompressedMatrix) {
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> mat(2, 2);
+  mat.insert(1, 0) = 3.0;
+  mat.insert(0, 1) = -1.0;
+  ASSERT_FALSE(mat.isCompressed());
+  Sharder sharder(mat, /*num_shards=*/2, nullptr);
+  EXPECT_EQ(Eigen::MatrixXd(ShardedCopy(mat, sharder)), Eigen::MatrixXd(mat));
+}
+
+TEST(ShardedTransposeTest, SmallExample) {
+  const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> mat =
+      TestSparseMatrix();
+  Sharder sharder(mat, /*num_shards=*/3, nullptr);
+  const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> transpose =
+      ShardedTranspose(mat, sharder, /*num_transpose_shards=*/3);
+  EXPECT_TRUE(transpose.isCompressed());
+  EXPECT_EQ(transpose.nonZeros(), mat.nonZeros());
+  EXPECT_EQ(Eigen::MatrixXd(transpose), Eigen::MatrixXd(mat.transpose()));
+}
+
+TEST(ShardedTransposeTest, EmptyRowsAndColumns) {
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> mat(4, 3);
+  mat.insert(2, 0) = 3.0;
+  mat.insert(0, 2) = -1.0;
+  Sharder sharder(mat, /*num_shards=*/2, nullptr);
+  EXPECT_EQ(Eigen::MatrixXd(ShardedTranspose(mat, sharder,
+                                             /*num_transpose_shards=*/2)),
+            Eigen::MatrixXd(mat.transpose()));
+}
+
 TEST(SetZeroTest, SmallExample) {
   Sharder sharder(3, /*num_shards=*/2, nullptr);
   VectorXd vec{{1, 7}};
@@ -426,6 +529,49 @@ TEST(ScaledColL2Norm, SmallExample) {
   EXPECT_THAT(answer, ElementsAre(std::sqrt(54), 1.0, 6.0, std::sqrt(41)));
 }
 
+TEST(ShardWorkerTest, WithoutThreadPool) {
+  Sharder sharder(/*num_elements=*/10, /*num_shards=*/3, nullptr);
+  for (int shard = 0; shard < sharder.NumShards(); ++shard) {
+    EXPECT_EQ(sharder.ShardWorker(shard), 0);
+  }
+}
+
+TEST(ParallelForEachShardTest, ShardsRunOnTheirWorker) {
+  const int num_threads = 3;
+  ThreadPool pool("ShardsRunOnTheirWorker", num_threads);
+  pool.StartWorkers();
+  Sharder sharder(/*num_elements=*/100, /*num_shards=*/10, &pool);
+  std::vector<int> first_workers(sharder.NumShards(), -1);
+  sharder.ParallelForEachShard([&](const Shard& shard) {
+    first_workers[shard.Index()] = pool.CurrentWorker();
+  });
+  std::vector<int> second_workers(sharder.NumShards(), -1);
+  sharder.ParallelForEachShard([&](const Shard& shard) {
+    second_workers[shard.Index()] = pool.CurrentWorker();
+  });
+  for (int shard = 0; shard < sharder.NumShards(); ++shard) {
+    EXPECT_EQ(first_workers[shard], sharder.ShardWorker(shard))
+        << " in shard: " << shard;
+  }
+  EXPECT_EQ(first_workers, second_workers);
+}
+
+TEST(ParallelForEachShardTest, NestedCallsRunInline) {
+  const int num_threads = 2;
+  ThreadPool pool("NestedCallsRunInline", num_threads);
+  pool.StartWorkers();
+  Sharder sharder(/*num_elements=*/8, /*num_shards=*/4, &pool);
+  std::vector<double> sums(sharder.NumShards(), 0.0);
+  sharder.ParallelForEachShard([&](const Shard& shard) {
+    const int worker = pool.CurrentWorker();
+    sums[shard.Index()] = sharder.ParallelSumOverShards([&](const Shard&) {
+      EXPECT_EQ(pool.CurrentWorker(), worker);
+      return 1.0;
+    });
+  });
+  EXPECT_THAT(sums, ElementsAre(4.0, 4.0, 4.0, 4.0));
+}
+
 class VariousSizesTest : public testing::TestWithParam<int64_t> {};
 
 TEST_P(VariousSizesTest, LargeMatVec) {
@@ -443,6 +589,82 @@ TEST_P(VariousSizesTest, LargeMatVec) {
   EXPECT_LE((direct - threaded).norm(), 1.0e-8);
 }
 
+TEST_P(VariousSizesTest, LargeShardedCopy) {
+  const int64_t size = GetParam();
+  const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> mat =
+      LargeSparseMatrix(size);
+  const int num_threads = 5;
+  const int shards_per_thread = 3;
+  ThreadPool pool("ShardedCopyTest", num_threads);
+  pool.StartWorkers();
+  Sharder sharder(mat, shards_per_thread * num_threads, &pool);
+  const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> copy =
+      ShardedCopy(mat, sharder);
+  ASSERT_EQ(copy.nonZeros(), mat.nonZeros());
+  EXPECT_TRUE(std::equal(mat.outerIndexPtr(),
+                         mat.outerIndexPtr() + mat.cols() + 1,
+                         copy.outerIndexPtr()));
+  EXPECT_TRUE(std::equal(mat.innerIndexPtr(),
+                         mat.innerIndexPtr() + mat.nonZeros(),
+                         copy.innerIndexPtr()));
+  EXPECT_TRUE(std::equal(mat.valuePtr(), mat.valuePtr() + mat.nonZeros(),
+                         copy.valuePtr()));
+}
+
+TEST_P(VariousSizesTest, LargeShardedTranspose) {
+  const int64_t size = GetParam();
+  const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> mat =
+      LargeSparseMatrix(size);
+  const int num_threads = 5;
+  const int shards_per_thread = 3;
+  ThreadPool pool("ShardedTransposeTest", num_threads);
+  pool.StartWorkers();
+  Sharder sharder(mat, shards_per_thread * num_threads, &pool);
+  const Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> transpose =
+      ShardedTranspose(mat, sharder, shards_per_thread * num_threads);
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> direct =
+      mat.transpose();
+  direct.makeCompressed();
+  ASSERT_EQ(transpose.nonZeros(), direct.nonZeros());
+  EXPECT_TRUE(std::equal(direct.outerIndexPtr(),
+                         direct.outerIndexPtr() + direct.cols() + 1,
+                         transpose.outerIndexPtr()));
+  EXPECT_TRUE(std::equal(direct.innerIndexPtr(),
+                         direct.innerIndexPtr() + direct.nonZeros(),
+                         transpose.innerIndexPtr()));
+  EXPECT_TRUE(std::equal(direct.valuePtr(),
+                         direct.valuePtr() + direct.nonZeros(),
+                         transpose.valuePtr()));
+}
+
+TEST_P(VariousSizesTest, LargeMatVecAndChange) {
+  const int64_t size = GetParam();
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int64_t> mat =
+      LargeSparseMatrix(size);
+  const int num_threads = 5;
+  const int shards_per_thread = 3;
+  ThreadPool pool("MatrixVectorProductAndChangeTest", num_threads);
+  pool.StartWorkers();
+  Sharder sharder(mat, shards_per_thread * num_threads, &pool);
+  VectorXd rhs = VectorXd::Random(size);
+  VectorXd previous_answer = VectorXd::Random(size);
+  VectorXd direction = VectorXd::Random(size);
+  VectorXd direct = mat.transpose() * rhs;
+  ProductChange change;
+  VectorXd threaded = TransposedMatrixVectorProductAndChange(
+      mat, rhs, previous_answer, direction, sharder, change);
+  EXPECT_LE((direct - threaded).norm(), 1.0e-8);
+  const double direct_squared_change_norm =
+      (direct - previous_answer).squaredNorm();
+  EXPECT_THAT(change.squared_change_norm,
+              DoubleNear(direct_squared_change_norm,
+                         1.0e-12 * direct_squared_change_norm));
+  const double direct_dot_change = direction.dot(direct - previous_answer);
+  EXPECT_THAT(change.direction_dot_change,
+              DoubleNear(direct_dot_change,
+                         1.0e-12 * direct_squared_change_norm));
+}
+
 TEST_P(VariousSizesTest, LargeVectors) {
   const int64_t size = GetParam();
   const int num_threads = 5;
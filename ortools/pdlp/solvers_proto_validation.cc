@@ -294,6 +294,18 @@ absl::Status ValidatePrimalDualHybridGradientParams(
         "use_feasibility_polishing and glop presolve can not be used "
         "together.");
   }
+  if (params.use_feasibility_polishing() &&
+      params.presolve_options().use_native_presolve()) {
+    return InvalidArgumentError(
+        "use_feasibility_polishing and native presolve can not be used "
+        "together.");
+  }
+  if (params.presolve_options().use_glop() &&
+      params.presolve_options().use_native_presolve()) {
+    return InvalidArgumentError(
+        "presolve_options.use_glop and presolve_options.use_native_presolve "
+        "can not be used together.");
+  }
   return OkStatus();
 }
 
@@ -706,5 +706,25 @@ TEST(ValidatePrimalDualHybridGradientParams,
   EXPECT_THAT(status.message(), HasSubstr("use_feasibility_polishing"));
 }
 
+TEST(ValidatePrimalDualHybridGradientParams,
+     FeasibilityPolishingAndNativePresolve) {
+  PrimalDualHybridGradientParams params;
+  params.set_use_feasibility_polishing(true);
+  params.set_handle_some_primal_gradients_on_finite_bounds_as_residuals(false);
+  params.mutable_presolve_options()->set_use_native_presolve(true);
+  const absl::Status status = ValidatePrimalDualHybridGradientParams(params);
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("use_feasibility_polishing"));
+}
+
+TEST(ValidatePrimalDualHybridGradientParams, GlopAndNativePresolve) {
+  PrimalDualHybridGradientParams params;
+  params.mutable_presolve_options()->set_use_glop(true);
+  params.mutable_presolve_options()->set_use_native_presolve(true);
+  const absl::Status status = ValidatePrimalDualHybridGradientParams(params);
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("use_native_presolve"));
+}
+
 }  // namespace
 }  // namespace operations_research::pdlp
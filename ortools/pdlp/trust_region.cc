@@ -987,9 +987,7 @@ LocalizedLagrangianBounds ComputeLocalizedLagrangianBounds(
   VectorXd dual_product_storage;
 
   if (primal_product == nullptr) {
-    primal_product_storage = TransposedMatrixVectorProduct(
-        sharded_qp.TransposedConstraintMatrix(), primal_solution,
-        sharded_qp.TransposedConstraintMatrixSharder());
+    primal_product_storage = sharded_qp.ConstraintActivities(primal_solution);
     primal_product = &primal_product_storage;
   }
   if (dual_product == nullptr) {
@@ -29,6 +29,7 @@
 #include "ortools/sat/model.h"
 #include "ortools/sat/sat_base.h"
 #include "ortools/sat/sat_solver.h"
+#include "ortools/util/bitset.h"
 #include "ortools/util/sort.h"
 #include "ortools/util/strong_integers.h"
 
@@ -109,6 +110,31 @@ std::function<void(Model*)> AllDifferentAC(
   };
 }
 
+namespace {
+
+// Output of FindStronglyConnectedComponents() that fills a node -> component
+// map. If local_to_node is not null, the SCC nodes are indices in it.
+struct SccOutput {
+  explicit SccOutput(std::vector<int>* c,
+                     const std::vector<int>* local_to_node = nullptr,
+                     int first_component = 0)
+      : num_components(first_component),
+        components(c),
+        local_to_node(local_to_node) {}
+  void emplace_back(int const* b, int const* e) {
+    for (int const* it = b; it < e; ++it) {
+      const int node = local_to_node == nullptr ? *it : (*local_to_node)[*it];
+      (*components)[node] = num_components;
+    }
+    ++num_components;
+  }
+  int num_components = 0;
+  std::vector<int>* components;
+  const std::vector<int>* local_to_node;
+};
+
+}  // namespace
+
 AllDifferentConstraint::AllDifferentConstraint(
     std::vector<IntegerVariable> variables, IntegerEncoder* encoder,
     Trail* trail, IntegerTrail* integer_trail)
@@ -166,6 +192,15 @@ AllDifferentConstraint::AllDifferentConstraint(
   variable_visited_from_.resize(num_variables_);
   residual_graph_successors_.resize(num_variables_ + num_all_values_ + 1);
   component_number_.resize(num_variables_ + num_all_values_ + 1);
+
+  num_words_ = BitLength64(num_all_values_);
+  use_bitsets_ = num_variables_ * static_cast<int64_t>(num_words_) <=
+                 kMaxBitsetMatrixWords;
+  if (use_bitsets_) {
+    domain_bits_.assign(num_variables_ * num_words_, 0);
+    hk_word_index_.resize(num_variables_);
+    hk_used_values_.resize(num_words_);
+  }
 }
 
 void AllDifferentConstraint::RegisterWith(GenericLiteralWatcher* watcher) {
@@ -242,6 +277,237 @@ bool AllDifferentConstraint::MakeAugmentingPath(int start) {
   return false;
 }
 
+void AllDifferentConstraint::ComputeResidualGraphComponents() {
+  for (int x = 0; x < num_variables_; x++) {
+    residual_graph_successors_[x].clear();
+    for (const int succ : successor_[x]) {
+      if (succ != variable_to_value_[x]) {
+        residual_graph_successors_[x].push_back(num_variables_ + succ);
+      }
+    }
+  }
+  for (int offset_value = 0; offset_value < num_all_values_; offset_value++) {
+    residual_graph_successors_[num_variables_ + offset_value].clear();
+    if (value_to_variable_[offset_value] != -1) {
+      residual_graph_successors_[num_variables_ + offset_value].push_back(
+          value_to_variable_[offset_value]);
+    }
+  }
+  const int dummy_node = num_variables_ + num_all_values_;
+  residual_graph_successors_[dummy_node].clear();
+  if (num_variables_ < num_all_values_) {
+    for (int x = 0; x < num_variables_; x++) {
+      residual_graph_successors_[dummy_node].push_back(x);
+    }
+    for (int offset_value = 0; offset_value < num_all_values_; offset_value++) {
+      if (value_to_variable_[offset_value] == -1) {
+        residual_graph_successors_[num_variables_ + offset_value].push_back(
+            dummy_node);
+      }
+    }
+  }
+
+  // Compute SCCs, make node -> component map.
+  SccOutput scc_output(&component_number_);
+  FindStronglyConnectedComponents(
+      static_cast<int>(residual_graph_successors_.size()),
+      residual_graph_successors_, &scc_output);
+  num_components_ = scc_output.num_components;
+}
+
+bool AllDifferentConstraint::ComputeMaxMatchingWithBitsets() {
+  const int kUnreached = std::numeric_limits<int>::max();
+  while (true) {
+    // BFS from all the free variables. hk_used_values_ contains the values
+    // already reached.
+    hk_queue_.clear();
+    hk_distance_.assign(num_variables_, kUnreached);
+    for (int x = 0; x < num_variables_; ++x) {
+      if (variable_to_value_[x] != -1) continue;
+      hk_distance_[x] = 0;
+      hk_queue_.push_back(x);
+    }
+    if (hk_queue_.empty()) return true;
+
+    // The distance of the variables adjacent to a free value on the shortest
+    // augmenting paths. We do not explore further than that.
+    int max_distance = kUnreached;
+    std::fill(hk_used_values_.begin(), hk_used_values_.end(), 0);
+    for (int i = 0; i < hk_queue_.size(); ++i) {
+      const int x = hk_queue_[i];
+      if (hk_distance_[x] >= max_distance) break;
+      const uint64_t* const bits = &domain_bits_[x * num_words_];
+      for (int w = 0; w < num_words_; ++w) {
+        uint64_t word = bits[w] & ~hk_used_values_[w];
+        hk_used_values_[w] |= word;
+        for (; word != 0; word &= word - 1) {
+          const int value = BitShift64(w) + LeastSignificantBitPosition64(word);
+          const int y = value_to_variable_[value];
+          if (y == -1) {
+            max_distance = hk_distance_[x];
+          } else if (hk_distance_[y] == kUnreached) {
+            hk_distance_[y] = hk_distance_[x] + 1;
+            hk_queue_.push_back(y);
+          }
+        }
+      }
+    }
+    if (max_distance == kUnreached) return false;
+
+    // Augment along a maximal set of vertex disjoint shortest paths.
+    bool augmented = false;
+    std::fill(hk_used_values_.begin(), hk_used_values_.end(), 0);
+    for (int x = 0; x < num_variables_; ++x) {
+      if (variable_to_value_[x] != -1 || hk_distance_[x] != 0) continue;
+      if (AugmentAlongShortestPath(x, max_distance)) augmented = true;
+    }
+    DCHECK(augmented);
+    if (!augmented) return false;
+  }
+}
+
+// This is an iterative DFS that only follows the arcs between two consecutive
+// BFS layers. Dead-end variables are removed from the layers by setting their
+// distance to -1, and the values are used at most once per phase.
+bool AllDifferentConstraint::AugmentAlongShortestPath(int start,
+                                                      int max_distance) {
+  hk_path_variables_.clear();
+  hk_path_values_.clear();
+  hk_path_variables_.push_back(start);
+  hk_word_index_[start] = 0;
+  while (!hk_path_variables_.empty()) {
+    const int x = hk_path_variables_.back();
+    const uint64_t* const bits = &domain_bits_[x * num_words_];
+    int next_variable = -1;
+    int& w = hk_word_index_[x];
+    for (; w < num_words_; ++w) {
+      for (uint64_t word = bits[w] & ~hk_used_values_[w]; word != 0;
+           word &= word - 1) {
+        const int value = BitShift64(w) + LeastSignificantBitPosition64(word);
+        const int y = value_to_variable_[value];
+        if (y == -1) {
+          // By construction of the layers, only the variables at the last
+          // layer can be adjacent to a free value.
+          DCHECK_EQ(hk_distance_[x], max_distance);
+          SetBit64(hk_used_values_.data(), value);
+          hk_path_values_.push_back(value);
+          for (int i = 0; i < hk_path_variables_.size(); ++i) {
+            const int path_variable = hk_path_variables_[i];
+            const int path_value = hk_path_values_[i];
+            variable_to_value_[path_variable] = path_value;
+            value_to_variable_[path_value] = path_variable;
+          }
+          return true;
+        }
+        if (hk_distance_[x] >= max_distance ||
+            hk_distance_[y] != hk_distance_[x] + 1) {
+          continue;
+        }
+        SetBit64(hk_used_values_.data(), value);
+        hk_path_values_.push_back(value);
+        next_variable = y;
+        break;
+      }
+      if (next_variable != -1) break;
+    }
+    if (next_variable != -1) {
+      hk_word_index_[next_variable] = 0;
+      hk_path_variables_.push_back(next_variable);
+      continue;
+    }
+
+    // Dead end, backtrack.
+    hk_distance_[x] = -1;
+    hk_path_variables_.pop_back();
+    if (!hk_path_values_.empty()) hk_path_values_.pop_back();
+  }
+  return false;
+}
+
+bool AllDifferentConstraint::UpdateComponentsIncrementally() {
+  DCHECK(use_bitsets_);
+  if (!scc_is_valid_ || scc_matching_ != variable_to_value_) return false;
+
+  // Avoid an unbounded growth of the component indices.
+  const int num_nodes = num_variables_ + num_all_values_ + 1;
+  if (num_components_ > 2 * num_nodes) return false;
+
+  // Find the components that lost an internal arc. Note that since the
+  // matching did not change, only arcs from a variable to a value can have
+  // been removed.
+  bool some_dirty_component = false;
+  component_is_dirty_.assign(num_components_, false);
+  for (int x = 0; x < num_variables_; ++x) {
+    const uint64_t* const old_bits = &scc_domain_bits_[x * num_words_];
+    const uint64_t* const new_bits = &domain_bits_[x * num_words_];
+    for (int w = 0; w < num_words_; ++w) {
+      if ((new_bits[w] & ~old_bits[w]) != 0) return false;
+      for (uint64_t removed = old_bits[w] & ~new_bits[w]; removed != 0;
+           removed &= removed - 1) {
+        const int value =
+            BitShift64(w) + LeastSignificantBitPosition64(removed);
+        const int component = component_number_[x];
+        if (component_number_[num_variables_ + value] == component) {
+          component_is_dirty_[component] = true;
+          some_dirty_component = true;
+        }
+      }
+    }
+  }
+  if (!some_dirty_component) return true;
+
+  // Build the residual graph induced by the nodes of the dirty components. An
+  // arc between two different old components can't be part of a new one.
+  local_to_node_.clear();
+  node_to_local_.assign(num_nodes, -1);
+  for (int node = 0; node < num_nodes; ++node) {
+    if (!component_is_dirty_[component_number_[node]]) continue;
+    node_to_local_[node] = local_to_node_.size();
+    local_to_node_.push_back(node);
+  }
+  const int num_local_nodes = local_to_node_.size();
+  if (local_graph_.size() < num_local_nodes) {
+    local_graph_.resize(num_local_nodes);
+  }
+  const int dummy_node = num_variables_ + num_all_values_;
+  const bool has_dummy_arcs = num_variables_ < num_all_values_;
+  const auto add_arc = [this](int local_tail, int tail, int head) {
+    if (node_to_local_[head] == -1) return;
+    if (component_number_[head] != component_number_[tail]) return;
+    local_graph_[local_tail].push_back(node_to_local_[head]);
+  };
+  for (int local = 0; local < num_local_nodes; ++local) {
+    const int node = local_to_node_[local];
+    local_graph_[local].clear();
+    if (node < num_variables_) {
+      const uint64_t* const bits = &domain_bits_[node * num_words_];
+      for (int w = 0; w < num_words_; ++w) {
+        for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+          const int value =
+              BitShift64(w) + LeastSignificantBitPosition64(word);
+          if (value == variable_to_value_[node]) continue;
+          add_arc(local, node, num_variables_ + value);
+        }
+      }
+    } else if (node < dummy_node) {
+      const int matched_variable = value_to_variable_[node - num_variables_];
+      if (matched_variable != -1) {
+        add_arc(local, node, matched_variable);
+      } else if (has_dummy_arcs) {
+        add_arc(local, node, dummy_node);
+      }
+    } else if (has_dummy_arcs) {
+      for (int x = 0; x < num_variables_; ++x) add_arc(local, node, x);
+    }
+  }
+
+  // The new components get fresh indices.
+  SccOutput scc_output(&component_number_, &local_to_node_, num_components_);
+  FindStronglyConnectedComponents(num_local_nodes, local_graph_, &scc_output);
+  num_components_ = scc_output.num_components;
+  return true;
+}
+
 // The algorithm copies the solver state to successor_, which is used to compute
 // a matching. If all variables can be matched, it generates the residual graph
 // in separate vectors, computes its SCCs, and filters variable -> value if
@@ -251,12 +517,13 @@ bool AllDifferentConstraint::MakeAugmentingPath(int start) {
 // with |variables| < |values|; filtering is explained by the Hall set that
 // would happen if the variable was assigned to the value.
 //
+// When the bit matrix of the domains is small enough, the matching uses
+// Hopcroft-Karp on bitsets and the SCC decomposition is only updated for the
+// components that lost an arc since the last call.
+//
 // TODO(user): If needed, there are several ways performance could be
 // improved.
 // If copying the variable state is too costly, it could be maintained instead.
-// If the propagator has too many fruitless calls (without failing/pruning),
-// we can remember the O(n) arcs used in the matching and the SCC decomposition,
-// and guard calls to Propagate() if these arcs are still valid.
 bool AllDifferentConstraint::Propagate() {
   // Copy variable state to graph state.
   prev_matching_ = variable_to_value_;
@@ -264,6 +531,9 @@ bool AllDifferentConstraint::Propagate() {
   variable_to_value_.assign(num_variables_, -1);
   for (int x = 0; x < num_variables_; x++) {
     successor_[x].clear();
+    uint64_t* const bits =
+        use_bitsets_ ? &domain_bits_[x * num_words_] : nullptr;
+    if (use_bitsets_) std::fill(bits, bits + num_words_, 0);
     const int64_t min_value = integer_trail_->LowerBound(variables_[x]).value();
     const int64_t max_value = integer_trail_->UpperBound(variables_[x]).value();
     for (int64_t value = min_value; value <= max_value; value++) {
@@ -271,6 +541,7 @@ bool AllDifferentConstraint::Propagate() {
         const int offset_value = value - min_all_values_;
         // Forward-checking should propagate x != value.
         successor_[x].push_back(offset_value);
+        if (use_bitsets_) SetBit64(bits, offset_value);
       }
     }
     if (successor_[x].size() == 1) {
@@ -309,13 +580,26 @@ bool AllDifferentConstraint::Propagate() {
 
   // Compute max matching.
   int x = 0;
-  for (; x < num_variables_; x++) {
-    if (variable_to_value_[x] == -1) {
+  if (use_bitsets_) {
+    if (!ComputeMaxMatchingWithBitsets()) {
+      // The matching is maximum, so the search below fails and leaves in
+      // variable/value_visited_ the information needed for the explanation.
+      while (variable_to_value_[x] != -1) ++x;
       value_visited_.assign(num_all_values_, false);
       variable_visited_.assign(num_variables_, false);
       MakeAugmentingPath(x);
+    } else {
+      x = num_variables_;
+    }
+  } else {
+    for (; x < num_variables_; x++) {
+      if (variable_to_value_[x] == -1) {
+        value_visited_.assign(num_all_values_, false);
+        variable_visited_.assign(num_variables_, false);
+        MakeAugmentingPath(x);
+      }
+      if (variable_to_value_[x] == -1) break;  // No augmenting path exists.
     }
-    if (variable_to_value_[x] == -1) break;  // No augmenting path exists.
   }
 
   // Fail if covering variables impossible.
@@ -340,53 +624,15 @@ bool AllDifferentConstraint::Propagate() {
   }
 
   // The current matching is a valid solution, now try to filter values.
-  // Build residual graph, compute its SCCs.
-  for (int x = 0; x < num_variables_; x++) {
-    residual_graph_successors_[x].clear();
-    for (const int succ : successor_[x]) {
-      if (succ != variable_to_value_[x]) {
-        residual_graph_successors_[x].push_back(num_variables_ + succ);
-      }
-    }
+  if (!use_bitsets_ || !UpdateComponentsIncrementally()) {
+    ComputeResidualGraphComponents();
   }
-  for (int offset_value = 0; offset_value < num_all_values_; offset_value++) {
-    residual_graph_successors_[num_variables_ + offset_value].clear();
-    if (value_to_variable_[offset_value] != -1) {
-      residual_graph_successors_[num_variables_ + offset_value].push_back(
-          value_to_variable_[offset_value]);
-    }
-  }
-  const int dummy_node = num_variables_ + num_all_values_;
-  residual_graph_successors_[dummy_node].clear();
-  if (num_variables_ < num_all_values_) {
-    for (int x = 0; x < num_variables_; x++) {
-      residual_graph_successors_[dummy_node].push_back(x);
-    }
-    for (int offset_value = 0; offset_value < num_all_values_; offset_value++) {
-      if (value_to_variable_[offset_value] == -1) {
-        residual_graph_successors_[num_variables_ + offset_value].push_back(
-            dummy_node);
-      }
-    }
+  if (use_bitsets_) {
+    scc_domain_bits_ = domain_bits_;
+    scc_matching_ = variable_to_value_;
+    scc_is_valid_ = true;
   }
 
-  // Compute SCCs, make node -> component map.
-  struct SccOutput {
-    explicit SccOutput(std::vector<int>* c) : components(c) {}
-    void emplace_back(int const* b, int const* e) {
-      for (int const* it = b; it < e; ++it) {
-        (*components)[*it] = num_components;
-      }
-      ++num_components;
-    }
-    int num_components = 0;
-    std::vector<int>* components;
-  };
-  SccOutput scc_output(&component_number_);
-  FindStronglyConnectedComponents(
-      static_cast<int>(residual_graph_successors_.size()),
-      residual_graph_successors_, &scc_output);
-
   // Remove arcs var -> val where SCC(var) -/->* SCC(val).
   for (int x = 0; x < num_variables_; x++) {
     if (successor_[x].size() == 1) continue;
@@ -426,11 +672,22 @@ bool AllDifferentConstraint::Propagate() {
           }
         }
 
+        // Restore the matching. The arcs removed by this loop are not in the
+        // matching and join different components, so the matching and the
+        // components stay valid and we can keep filtering. This also lets the
+        // next call seed from the matching and reuse the components.
+        variable_to_value_[x] = old_value;
+        value_to_variable_[old_value] = x;
+        variable_to_value_[old_variable] = offset_value;
+        value_to_variable_[offset_value] = old_variable;
+
         const LiteralIndex li =
             VariableLiteralIndexOf(x, offset_value + min_all_values_);
         DCHECK_NE(li, kTrueLiteralIndex);
         DCHECK_NE(li, kFalseLiteralIndex);
-        return trail_->EnqueueWithStoredReason(Literal(li).Negated());
+        if (!trail_->EnqueueWithStoredReason(Literal(li).Negated())) {
+          return false;
+        }
       }
     }
   }
@@ -85,6 +85,28 @@ class AllDifferentConstraint : PropagatorInterface {
   // or manipulate it to create what-if scenarios without modifying successor_.
   bool MakeAugmentingPath(int start);
 
+  // Bitset version of the maximum matching computation, used when
+  // use_bitsets_ is true. This runs Hopcroft-Karp phases starting from the
+  // current (partial) assignment, and returns true iff all variables could be
+  // matched. Each phase is a BFS computing the layers of the shortest
+  // augmenting paths followed by DFSs that augment along vertex disjoint
+  // shortest paths. The values adjacent to a variable are scanned 64 at a time
+  // by masking domain_bits_ with the values already used in the phase.
+  bool ComputeMaxMatchingWithBitsets();
+  bool AugmentAlongShortestPath(int start, int max_distance);
+
+  // Fills component_number_ with the SCCs of the residual graph of the current
+  // matching. See the comment on residual_graph_successors_ below.
+  void ComputeResidualGraphComponents();
+
+  // When the matching did not change since the last SCC computation and the
+  // domains only lost values (i.e. we did not backtrack), the residual graph
+  // only lost arcs. Components can then only split, and only the ones that lost
+  // an internal arc need to be recomputed. Returns false if this incremental
+  // update is not possible, in which case component_number_ is left untouched.
+  // This requires use_bitsets_.
+  bool UpdateComponentsIncrementally();
+
   // Accessors to the cache of literals.
   inline LiteralIndex VariableLiteralIndexOf(int x, int64_t value);
   inline bool VariableHasPossibleValue(int x, int64_t value);
@@ -132,6 +154,38 @@ class AllDifferentConstraint : PropagatorInterface {
   // we add it anyway to simplify the code.
   std::vector<std::vector<int>> residual_graph_successors_;
   std::vector<int> component_number_;
+  int num_components_ = 0;
+
+  // If the dense (variable x value) bit matrix of the domains has at most this
+  // number of words, we use it for the matching and to compute the SCCs
+  // incrementally between two calls.
+  static constexpr int64_t kMaxBitsetMatrixWords = int64_t{1} << 20;
+
+  // domain_bits_[x * num_words_ + w] contains the bits [64 * w, 64 * w + 63]
+  // of the offset values in successor_[x]. scc_domain_bits_ and scc_matching_
+  // are a copy of domain_bits_ and variable_to_value_ taken the last time
+  // component_number_ was computed, and only make sense if scc_is_valid_.
+  bool use_bitsets_ = false;
+  int num_words_ = 0;
+  std::vector<uint64_t> domain_bits_;
+  std::vector<uint64_t> scc_domain_bits_;
+  std::vector<int> scc_matching_;
+  bool scc_is_valid_ = false;
+
+  // Internal state of ComputeMaxMatchingWithBitsets().
+  std::vector<int> hk_distance_;
+  std::vector<int> hk_queue_;
+  std::vector<int> hk_word_index_;
+  std::vector<int> hk_path_variables_;
+  std::vector<int> hk_path_values_;
+  std::vector<uint64_t> hk_used_values_;
+
+  // Internal state of UpdateComponentsIncrementally(). The subgraph induced by
+  // the nodes of the components to recompute is remapped to [0, num_local).
+  std::vector<bool> component_is_dirty_;
+  std::vector<int> node_to_local_;
+  std::vector<int> local_to_node_;
+  std::vector<std::vector<int>> local_graph_;
 
   Trail* trail_;
   IntegerTrail* integer_trail_;
@@ -0,0 +1,227 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/sat/all_different.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/random/distributions.h"
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "ortools/sat/integer.h"
+#include "ortools/sat/model.h"
+#include "ortools/sat/sat_base.h"
+#include "ortools/sat/sat_solver.h"
+#include "ortools/util/sorted_interval_list.h"
+
+namespace operations_research {
+namespace sat {
+namespace {
+
+using Domains = std::vector<std::vector<int64_t>>;
+
+// Fills supported[x] with the values of domains[x] that appear in at least one
+// solution of the all different constraint.
+void FindSupports(const Domains& domains, int x, std::vector<int64_t>* tuple,
+                  std::vector<std::vector<bool>>* supported) {
+  if (x == domains.size()) {
+    for (int y = 0; y < domains.size(); ++y) {
+      for (int i = 0; i < domains[y].size(); ++i) {
+        if (domains[y][i] == (*tuple)[y]) (*supported)[y][i] = true;
+      }
+    }
+    return;
+  }
+  for (const int64_t value : domains[x]) {
+    bool used = false;
+    for (int y = 0; y < x; ++y) used |= (*tuple)[y] == value;
+    if (used) continue;
+    (*tuple)[x] = value;
+    FindSupports(domains, x + 1, tuple, supported);
+  }
+}
+
+void RemoveValue(int x, int64_t value, Domains* domains) {
+  std::vector<int64_t>& domain = (*domains)[x];
+  domain.erase(std::remove(domain.begin(), domain.end(), value), domain.end());
+}
+
+// Returns the domains restricted to their supported values. All domains are
+// empty if the constraint is infeasible.
+Domains ArcConsistentDomains(const Domains& domains) {
+  std::vector<std::vector<bool>> supported(domains.size());
+  for (int x = 0; x < domains.size(); ++x) {
+    supported[x].assign(domains[x].size(), false);
+  }
+  std::vector<int64_t> tuple(domains.size());
+  FindSupports(domains, 0, &tuple, &supported);
+  Domains result(domains.size());
+  for (int x = 0; x < domains.size(); ++x) {
+    for (int i = 0; i < domains[x].size(); ++i) {
+      if (supported[x][i]) result[x].push_back(domains[x][i]);
+    }
+  }
+  return result;
+}
+
+class AllDifferentACTest : public ::testing::Test {
+ protected:
+  void CreateConstraint(const Domains& domains) {
+    for (const std::vector<int64_t>& domain : domains) {
+      variables_.push_back(
+          model_.Add(NewIntegerVariable(Domain::FromValues(domain))));
+    }
+    model_.Add(AllDifferentBinary(variables_));
+    model_.Add(AllDifferentAC(variables_));
+  }
+
+  // Returns the values of the variables whose literal is not false.
+  Domains CurrentDomains() {
+    IntegerEncoder* encoder = model_.GetOrCreate<IntegerEncoder>();
+    const VariablesAssignment& assignment =
+        model_.GetOrCreate<Trail>()->Assignment();
+    Domains domains;
+    for (const IntegerVariable var : variables_) {
+      domains.emplace_back();
+      for (const ValueLiteralPair& pair : encoder->FullDomainEncoding(var)) {
+        if (assignment.LiteralIsFalse(pair.literal)) continue;
+        domains.back().push_back(pair.value.value());
+      }
+    }
+    return domains;
+  }
+
+  Literal EqualityLiteral(int x, int64_t value) {
+    IntegerEncoder* encoder = model_.GetOrCreate<IntegerEncoder>();
+    return encoder->GetOrCreateLiteralAssociatedToEquality(variables_[x],
+                                                           IntegerValue(value));
+  }
+
+  Model model_;
+  std::vector<IntegerVariable> variables_;
+};
+
+TEST_F(AllDifferentACTest, RemovesValuesOutsideOfMatchings) {
+  // {0, 1} is a Hall set for the first two variables.
+  CreateConstraint({{0, 1}, {0, 1}, {0, 1, 2, 3}, {1, 2, 3}});
+  SatSolver* sat_solver = model_.GetOrCreate<SatSolver>();
+  ASSERT_TRUE(sat_solver->Propagate());
+  EXPECT_EQ(CurrentDomains(), Domains({{0, 1}, {0, 1}, {2, 3}, {2, 3}}));
+}
+
+TEST_F(AllDifferentACTest, DetectsInfeasibility) {
+  CreateConstraint({{0, 1, 2}, {0, 1}, {0, 1}, {1, 2}, {3, 4}});
+  EXPECT_TRUE(model_.GetOrCreate<SatSolver>()->ModelIsUnsat() ||
+              !model_.GetOrCreate<SatSolver>()->Propagate());
+}
+
+// Removes random values one at a time, and checks that the constraint keeps
+// the domains arc consistent. This goes through the incremental update of the
+// strongly connected components, which is only used when the matching did not
+// change since the previous call.
+TEST_F(AllDifferentACTest, StaysArcConsistentOnRandomDecisions) {
+  std::mt19937 random(12345);
+  const int kNumVariables = 7;
+  const int kNumValues = 9;
+  Domains domains(kNumVariables);
+  for (int x = 0; x < kNumVariables; ++x) {
+    for (int value = 0; value < kNumValues; ++value) {
+      if (absl::Bernoulli(random, 0.7) || value == x) {
+        domains[x].push_back(value);
+      }
+    }
+  }
+  CreateConstraint(domains);
+  SatSolver* sat_solver = model_.GetOrCreate<SatSolver>();
+  ASSERT_TRUE(sat_solver->Propagate());
+  Domains current = CurrentDomains();
+  ASSERT_EQ(current, ArcConsistentDomains(domains));
+
+  for (int step = 0; step < 200; ++step) {
+    if (step % 25 == 0) {
+      sat_solver->Backtrack(0);
+      current = CurrentDomains();
+    }
+
+    // Removes a random value whose removal keeps the problem feasible.
+    std::vector<std::pair<int, int64_t>> candidates;
+    for (int x = 0; x < kNumVariables; ++x) {
+      if (current[x].size() == 1) continue;
+      for (const int64_t value : current[x]) {
+        Domains next = current;
+        RemoveValue(x, value, &next);
+        if (!ArcConsistentDomains(next)[0].empty()) {
+          candidates.push_back({x, value});
+        }
+      }
+    }
+    if (candidates.empty()) {
+      sat_solver->Backtrack(0);
+      current = CurrentDomains();
+      continue;
+    }
+    const auto [x, value] = candidates[absl::Uniform<int>(
+        random, 0, candidates.size())];
+    RemoveValue(x, value, &current);
+    const Domains expected = ArcConsistentDomains(current);
+    ASSERT_TRUE(sat_solver->EnqueueDecisionIfNotConflicting(
+        EqualityLiteral(x, value).Negated()));
+    current = CurrentDomains();
+    ASSERT_EQ(current, expected) << "step " << step;
+  }
+}
+
+// Permutation of n variables over n values, each variable missing a few random
+// values. Each iteration removes values until all variables are fixed.
+void BM_AllDifferentACPropagation(benchmark::State& state) {
+  const int num_variables = state.range(0);
+  std::mt19937 random(12345);
+  Model model;
+  std::vector<IntegerVariable> variables;
+  for (int x = 0; x < num_variables; ++x) {
+    std::vector<int64_t> values;
+    for (int value = 0; value < num_variables; ++value) {
+      if (value == x || absl::Bernoulli(random, 0.9)) values.push_back(value);
+    }
+    variables.push_back(
+        model.Add(NewIntegerVariable(Domain::FromValues(values))));
+  }
+  model.Add(AllDifferentBinary(variables));
+  model.Add(AllDifferentAC(variables));
+  SatSolver* sat_solver = model.GetOrCreate<SatSolver>();
+  IntegerEncoder* encoder = model.GetOrCreate<IntegerEncoder>();
+  const VariablesAssignment& assignment =
+      model.GetOrCreate<Trail>()->Assignment();
+  CHECK(sat_solver->Propagate());
+  for (auto _ : state) {
+    sat_solver->Backtrack(0);
+    // Fixes the variables one by one to their smallest remaining value, which
+    // always keeps the identity matching, hence the problem, feasible.
+    for (int x = 0; x < num_variables; ++x) {
+      const Literal literal = encoder->GetOrCreateLiteralAssociatedToEquality(
+          variables[x], IntegerValue(x));
+      if (assignment.LiteralIsTrue(literal)) continue;
+      CHECK(sat_solver->EnqueueDecisionIfNotConflicting(literal));
+    }
+  }
+}
+BENCHMARK(BM_AllDifferentACPropagation)->Arg(16)->Arg(64)->Arg(256);
+
+}  // namespace
+}  // namespace sat
+}  // namespace operations_research
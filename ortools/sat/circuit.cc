@@ -48,8 +48,16 @@ CircuitPropagator::CircuitPropagator(const int num_nodes,
   must_be_in_cycle_.resize(num_nodes_);
   absl::flat_hash_map<LiteralIndex, int> literal_to_watch_index;
 
+  // We use a matrix if at least a quarter of the possible arcs are present.
   const int num_arcs = tails.size();
-  graph_.reserve(num_arcs);
+  const int64_t dense_size = static_cast<int64_t>(num_nodes_) * num_nodes_;
+  use_dense_graph_ =
+      dense_size <= kMaxDenseGraphSize && 4 * int64_t{num_arcs} >= dense_size;
+  if (use_dense_graph_) {
+    dense_graph_.assign(dense_size, kNoLiteralIndex);
+  } else {
+    graph_.reserve(num_arcs);
+  }
   self_arcs_.resize(num_nodes_,
                     model->GetOrCreate<IntegerEncoder>()->GetFalseLiteral());
   for (int arc = 0; arc < num_arcs; ++arc) {
@@ -60,6 +68,9 @@ CircuitPropagator::CircuitPropagator(const int num_nodes,
 
     if (tail == head) {
       self_arcs_[tail] = literal;
+    } else if (use_dense_graph_) {
+      dense_graph_[static_cast<int64_t>(tail) * num_nodes_ + head] =
+          literal.Index();
     } else {
       graph_[{tail, head}] = literal;
     }
@@ -147,6 +158,14 @@ void CircuitPropagator::FillReasonForPath(int start_node,
   }
 }
 
+LiteralIndex CircuitPropagator::ArcLiteral(int tail, int head) const {
+  if (use_dense_graph_) {
+    return dense_graph_[static_cast<int64_t>(tail) * num_nodes_ + head];
+  }
+  const auto it = graph_.find({tail, head});
+  return it == graph_.end() ? kNoLiteralIndex : it->second.Index();
+}
+
 // If multiple_subcircuit_through_zero is true, we never fill next_[0] and
 // prev_[0].
 void CircuitPropagator::AddArc(int tail, int head, LiteralIndex literal_index) {
@@ -205,14 +224,20 @@ bool CircuitPropagator::IncrementalPropagate(
 // are all up to date.
 bool CircuitPropagator::Propagate() {
   processed_.assign(num_nodes_, false);
+  in_current_path_.assign(num_nodes_, false);
+  current_path_.clear();
   for (int n = 0; n < num_nodes_; ++n) {
     if (processed_[n]) continue;
     if (next_[n] == n) continue;
     if (next_[n] == -1 && prev_[n] == -1) continue;
 
-    // TODO(user): both this and the loop on must_be_in_cycle_ might take some
-    // time on large graph. Optimize if this become an issue.
-    in_current_path_.assign(num_nodes_, false);
+    // Only clear the nodes of the previous path, this is important on large
+    // graphs with many partial paths.
+    //
+    // TODO(user): the loop on must_be_in_cycle_ might take some time on large
+    // graph. Optimize if this become an issue.
+    for (const int node : current_path_) in_current_path_[node] = false;
+    current_path_.clear();
 
     // Find the start and end of the path containing node n. If this is a
     // circuit, we will have start_node == end_node.
@@ -220,17 +245,20 @@ bool CircuitPropagator::Propagate() {
     int end_node = n;
     in_current_path_[n] = true;
     processed_[n] = true;
+    current_path_.push_back(n);
     while (next_[end_node] != -1) {
       end_node = next_[end_node];
+      if (end_node == n) break;
       in_current_path_[end_node] = true;
       processed_[end_node] = true;
-      if (end_node == n) break;
+      current_path_.push_back(end_node);
     }
     while (prev_[start_node] != -1) {
       start_node = prev_[start_node];
+      if (start_node == n) break;
       in_current_path_[start_node] = true;
       processed_[start_node] = true;
-      if (start_node == n) break;
+      current_path_.push_back(start_node);
     }
 
     // TODO(user): we can fail early in more case, like no more possible path
@@ -245,9 +273,9 @@ bool CircuitPropagator::Propagate() {
       // An incomplete path cannot be closed except if one of the end-points
       // is zero.
       if (start_node != end_node && start_node != 0 && end_node != 0) {
-        const auto it = graph_.find({end_node, start_node});
-        if (it == graph_.end()) continue;
-        const Literal literal = it->second;
+        const LiteralIndex index = ArcLiteral(end_node, start_node);
+        if (index == kNoLiteralIndex) continue;
+        const Literal literal(index);
         if (assignment_.LiteralIsFalse(literal)) continue;
 
         std::vector<Literal>* reason = trail_->GetEmptyVectorToStoreReason();
@@ -290,9 +318,9 @@ bool CircuitPropagator::Propagate() {
       // We have an unclosed path. Propagate the fact that it cannot
       // be closed into a cycle, i.e. not(end_node -> start_node).
       if (start_node != end_node) {
-        const auto it = graph_.find({end_node, start_node});
-        if (it == graph_.end()) continue;
-        const Literal literal = it->second;
+        const LiteralIndex index = ArcLiteral(end_node, start_node);
+        if (index == kNoLiteralIndex) continue;
+        const Literal literal(index);
         if (assignment_.LiteralIsFalse(literal)) continue;
 
         std::vector<Literal>* reason = trail_->GetEmptyVectorToStoreReason();
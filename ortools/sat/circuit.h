@@ -14,6 +14,7 @@
 #ifndef OR_TOOLS_SAT_CIRCUIT_H_
 #define OR_TOOLS_SAT_CIRCUIT_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -76,6 +77,10 @@ class CircuitPropagator : PropagatorInterface, ReversibleInterface {
   // start (not like a rho shape).
   void FillReasonForPath(int start_node, std::vector<Literal>* reason) const;
 
+  // Returns the literal of the arc tail -> head, or kNoLiteralIndex if there is
+  // no such arc.
+  LiteralIndex ArcLiteral(int tail, int head) const;
+
   const int num_nodes_;
   const Options options_;
   Trail* trail_;
@@ -85,10 +90,14 @@ class CircuitPropagator : PropagatorInterface, ReversibleInterface {
   // accessed often, so we use a more efficient std::vector<> for them. Note
   // that we do not add self-arcs to graph_.
   //
-  // TODO(user): for large dense graph, using a matrix is faster and uses less
-  // memory. If the need arise we can have the two implementations.
+  // For dense enough graphs, using a matrix is faster and uses less memory, so
+  // in this case we fill dense_graph_[tail * num_nodes_ + head] instead of
+  // graph_, with kNoLiteralIndex for the missing arcs.
+  static constexpr int64_t kMaxDenseGraphSize = int64_t{1} << 24;
   std::vector<Literal> self_arcs_;
   absl::flat_hash_map<std::pair<int, int>, Literal> graph_;
+  bool use_dense_graph_ = false;
+  std::vector<LiteralIndex> dense_graph_;
 
   // Data used to interpret the watch indices passed to IncrementalPropagate().
   struct Arc {
@@ -116,6 +125,7 @@ class CircuitPropagator : PropagatorInterface, ReversibleInterface {
   // Temporary vectors.
   std::vector<bool> processed_;
   std::vector<bool> in_current_path_;
+  std::vector<int> current_path_;
 };
 
 // Enforce the fact that there is no cycle in the given directed graph.
@@ -0,0 +1,177 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/sat/circuit.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/random/distributions.h"
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "ortools/sat/integer.h"
+#include "ortools/sat/model.h"
+#include "ortools/sat/sat_base.h"
+#include "ortools/sat/sat_solver.h"
+
+namespace operations_research {
+namespace sat {
+namespace {
+
+struct Graph {
+  int num_nodes;
+  std::vector<int> tails;
+  std::vector<int> heads;
+};
+
+// Returns a graph where each arc is present with the given probability.
+Graph RandomGraph(int num_nodes, double density, bool with_self_arcs,
+                  std::mt19937* random) {
+  Graph graph{num_nodes, {}, {}};
+  for (int tail = 0; tail < num_nodes; ++tail) {
+    for (int head = 0; head < num_nodes; ++head) {
+      if (tail == head ? !with_self_arcs : !absl::Bernoulli(*random, density)) {
+        continue;
+      }
+      graph.tails.push_back(tail);
+      graph.heads.push_back(head);
+    }
+  }
+  return graph;
+}
+
+// Counts the successor functions of the graph where the nodes that are not
+// their own successor form a single circuit, by enumerating permutations.
+int CountSubcircuitsByBruteForce(const Graph& graph) {
+  const int n = graph.num_nodes;
+  std::vector<bool> has_arc(n * n, false);
+  for (int arc = 0; arc < graph.tails.size(); ++arc) {
+    has_arc[graph.tails[arc] * n + graph.heads[arc]] = true;
+  }
+  std::vector<int> next(n);
+  std::iota(next.begin(), next.end(), 0);
+  int num_solutions = 0;
+  do {
+    bool valid = true;
+    int num_in_circuit = 0;
+    int start = -1;
+    for (int node = 0; node < n; ++node) {
+      valid &= has_arc[node * n + next[node]];
+      if (next[node] != node) {
+        ++num_in_circuit;
+        start = node;
+      }
+    }
+    if (!valid) continue;
+    if (num_in_circuit > 0) {
+      int length = 0;
+      int node = start;
+      do {
+        node = next[node];
+        ++length;
+      } while (node != start);
+      if (length != num_in_circuit) continue;
+    }
+    ++num_solutions;
+  } while (std::next_permutation(next.begin(), next.end()));
+  return num_solutions;
+}
+
+// Counts the solutions of SubcircuitConstraint() on the graph.
+int CountSubcircuitsWithSolver(const Graph& graph) {
+  Model model;
+  std::vector<Literal> literals;
+  for (int arc = 0; arc < graph.tails.size(); ++arc) {
+    literals.push_back(Literal(model.Add(NewBooleanVariable()), true));
+  }
+  model.Add(SubcircuitConstraint(graph.num_nodes, graph.tails, graph.heads,
+                                 literals));
+  SatSolver* sat_solver = model.GetOrCreate<SatSolver>();
+  int num_solutions = 0;
+  while (!sat_solver->ModelIsUnsat() &&
+         sat_solver->Solve() == SatSolver::FEASIBLE) {
+    ++num_solutions;
+    std::vector<Literal> clause;
+    for (const Literal literal : literals) {
+      clause.push_back(sat_solver->Assignment().LiteralIsTrue(literal)
+                           ? literal.Negated()
+                           : literal);
+    }
+    sat_solver->Backtrack(0);
+    if (!sat_solver->AddProblemClause(clause)) break;
+  }
+  return num_solutions;
+}
+
+TEST(CircuitPropagatorTest, CompleteGraphHasFactorialCircuits) {
+  // (n - 1)! Hamiltonian circuits. The arc matrix is dense.
+  std::mt19937 random(12345);
+  EXPECT_EQ(CountSubcircuitsWithSolver(
+                RandomGraph(6, 1.0, /*with_self_arcs=*/false, &random)),
+            120);
+}
+
+// The dense arc matrix is used when at least a quarter of the possible arcs are
+// present, so these densities cover both representations.
+TEST(CircuitPropagatorTest, MatchesBruteForceOnRandomGraphs) {
+  std::mt19937 random(12345);
+  for (const double density : {0.15, 0.3, 0.6, 0.9}) {
+    for (const bool with_self_arcs : {false, true}) {
+      for (int trial = 0; trial < 5; ++trial) {
+        const Graph graph = RandomGraph(6, density, with_self_arcs, &random);
+        if (graph.tails.empty()) continue;
+        EXPECT_EQ(CountSubcircuitsWithSolver(graph),
+                  CountSubcircuitsByBruteForce(graph))
+            << "density " << density << " self arcs " << with_self_arcs
+            << " trial " << trial;
+      }
+    }
+  }
+}
+
+// Finds a Hamiltonian circuit of a random graph. The density argument is in
+// percent.
+void BM_FindCircuit(benchmark::State& state) {
+  const int num_nodes = state.range(0);
+  const double density = state.range(1) / 100.0;
+  std::mt19937 random(12345);
+  Graph graph = RandomGraph(num_nodes, density, /*with_self_arcs=*/false,
+                            &random);
+  // Makes sure that there is a solution.
+  for (int node = 0; node < num_nodes; ++node) {
+    graph.tails.push_back(node);
+    graph.heads.push_back((node + 1) % num_nodes);
+  }
+  for (auto _ : state) {
+    Model model;
+    std::vector<Literal> literals;
+    for (int arc = 0; arc < graph.tails.size(); ++arc) {
+      literals.push_back(Literal(model.Add(NewBooleanVariable()), true));
+    }
+    model.Add(SubcircuitConstraint(num_nodes, graph.tails, graph.heads,
+                                   literals));
+    CHECK_EQ(model.GetOrCreate<SatSolver>()->Solve(), SatSolver::FEASIBLE);
+  }
+}
+BENCHMARK(BM_FindCircuit)
+    ->Args({50, 10})
+    ->Args({50, 50})
+    ->Args({200, 10})
+    ->Args({200, 50});
+
+}  // namespace
+}  // namespace sat
+}  // namespace operations_research
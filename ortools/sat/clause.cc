@@ -16,6 +16,7 @@
 #include <stddef.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <queue>
@@ -23,6 +24,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/prefetch.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
@@ -33,7 +35,9 @@
 #include "ortools/base/logging.h"
 #include "ortools/base/stl_util.h"
 #include "ortools/base/strong_vector.h"
+#include "ortools/base/threadpool.h"
 #include "ortools/base/timer.h"
+#include "ortools/graph/connected_components.h"
 #include "ortools/graph/strongly_connected_components.h"
 #include "ortools/sat/drat_proof_handler.h"
 #include "ortools/sat/inclusion.h"
@@ -495,6 +499,12 @@ void LiteralWatchers::DeleteRemovedClauses() {
 void BinaryImplicationGraph::Resize(int num_variables) {
   SCOPED_TIME_STAT(&stats_);
   implications_.resize(num_variables << 1);
+  if (compact_is_valid_) {
+    // The new literals have no implications in the compact copy.
+    compact_starts_.resize(implications_.size() + 1,
+                           compact_implications_.size());
+    has_new_implications_.resize(implications_.size());
+  }
   is_redundant_.resize(implications_.size());
   is_removed_.resize(implications_.size(), false);
   estimated_sizes_.resize(implications_.size(), 0);
@@ -527,6 +537,8 @@ bool BinaryImplicationGraph::AddBinaryClause(Literal a, Literal b) {
   estimated_sizes_[b.NegatedIndex()]++;
   implications_[a.NegatedIndex()].push_back(b);
   implications_[b.NegatedIndex()].push_back(a);
+  NotifyNewImplications(a.NegatedIndex(), 1);
+  NotifyNewImplications(b.NegatedIndex(), 1);
   is_dag_ = false;
   num_implications_ += 2;
 
@@ -686,6 +698,7 @@ bool BinaryImplicationGraph::CleanUpAndAddAtMostOnes(const int base_index,
           if (a == b) continue;
           implications_[a].push_back(b.Negated());
         }
+        NotifyNewImplications(a.Index(), at_most_one.size() - 1);
       }
       num_implications_ += at_most_one.size() * (at_most_one.size() - 1);
 
@@ -711,19 +724,15 @@ bool BinaryImplicationGraph::CleanUpAndAddAtMostOnes(const int base_index,
   return true;
 }
 
-bool BinaryImplicationGraph::PropagateOnTrue(Literal true_literal,
-                                             Trail* trail) {
-  SCOPED_TIME_STAT(&stats_);
-
-  const auto assignment = AssignmentView(trail->Assignment());
-  DCHECK(assignment.LiteralIsTrue(true_literal));
-
+bool BinaryImplicationGraph::PropagateImplications(
+    Literal true_literal, absl::Span<const Literal> implications,
+    AssignmentView assignment, Trail* trail) {
   // Note(user): This update is not exactly correct because in case of conflict
   // we don't inspect that much clauses. But doing ++num_inspections_ inside the
   // loop does slow down the code by a few percent.
-  num_inspections_ += implications_[true_literal].size();
+  num_inspections_ += implications.size();
 
-  for (const Literal literal : implications_[true_literal]) {
+  for (const Literal literal : implications) {
     if (assignment.LiteralIsTrue(literal)) {
       // Note(user): I tried to update the reason here if the literal was
       // enqueued after the true_literal on the trail. This property is
@@ -744,6 +753,40 @@ bool BinaryImplicationGraph::PropagateOnTrue(Literal true_literal,
       trail->FastEnqueue(literal);
     }
   }
+  return true;
+}
+
+bool BinaryImplicationGraph::PropagateOnTrue(Literal true_literal,
+                                             Trail* trail) {
+  SCOPED_TIME_STAT(&stats_);
+
+  const auto assignment = AssignmentView(trail->Assignment());
+  DCHECK(assignment.LiteralIsTrue(true_literal));
+
+  if (compact_is_valid_) {
+    const int64_t start = compact_starts_[true_literal.Index().value()];
+    const int64_t size =
+        compact_starts_[true_literal.Index().value() + 1] - start;
+    if (!PropagateImplications(
+            true_literal,
+            absl::MakeConstSpan(compact_implications_.data() + start, size),
+            assignment, trail)) {
+      return false;
+    }
+    if (has_new_implications_[true_literal]) {
+      const auto& implications = implications_[true_literal];
+      if (!PropagateImplications(
+              true_literal,
+              absl::MakeConstSpan(implications.data() + size,
+                                  implications.size() - size),
+              assignment, trail)) {
+        return false;
+      }
+    }
+  } else if (!PropagateImplications(true_literal, implications_[true_literal],
+                                    assignment, trail)) {
+    return false;
+  }
 
   // Propagate the at_most_one constraints.
   if (true_literal.Index() < at_most_ones_.size()) {
@@ -789,11 +832,52 @@ bool BinaryImplicationGraph::Propagate(Trail* trail) {
   trail->SetCurrentPropagatorId(propagator_id_);
   while (propagation_trail_index_ < trail->Index()) {
     const Literal literal = (*trail)[propagation_trail_index_++];
+
+    // The list of the next literal on the trail is likely not in cache, so we
+    // start fetching it while we process the current one.
+    if (propagation_trail_index_ < trail->Index()) {
+      const Literal next = (*trail)[propagation_trail_index_];
+      if (compact_is_valid_) {
+        absl::PrefetchToLocalCache(compact_implications_.data() +
+                                   compact_starts_[next.Index().value()]);
+      } else {
+        absl::PrefetchToLocalCache(implications_[next].data());
+      }
+    }
     if (!PropagateOnTrue(literal, trail)) return false;
   }
   return true;
 }
 
+void BinaryImplicationGraph::CompactImplicationsIfUseful() {
+  DCHECK(CompactImplicationsAreOk());
+  if (compact_is_valid_) {
+    if (8 * num_new_implications_ <=
+        static_cast<int64_t>(compact_implications_.size())) {
+      return;
+    }
+  } else if (num_inspections_ - num_inspections_at_invalidation_ <
+             num_implications_) {
+    return;
+  }
+
+  SCOPED_TIME_STAT(&stats_);
+  const int num_literals = implications_.size();
+  compact_starts_.resize(num_literals + 1);
+  compact_implications_.clear();
+  compact_implications_.reserve(num_implications_);
+  for (LiteralIndex i(0); i < num_literals; ++i) {
+    compact_starts_[i.value()] = compact_implications_.size();
+    compact_implications_.insert(compact_implications_.end(),
+                                 implications_[i].begin(),
+                                 implications_[i].end());
+  }
+  compact_starts_[num_literals] = compact_implications_.size();
+  has_new_implications_.ClearAndResize(LiteralIndex(num_literals));
+  num_new_implications_ = 0;
+  compact_is_valid_ = true;
+}
+
 absl::Span<const Literal> BinaryImplicationGraph::Reason(
     const Trail& trail, int trail_index) const {
   return {&reasons_[trail_index], 1};
@@ -862,6 +946,7 @@ void BinaryImplicationGraph::MinimizeConflictWithReachability(
   // Now we can prune the direct implications list and make sure are the
   // literals there are marked.
   if (also_prune_direct_implication_list) {
+    InvalidateCompactImplications();
     int new_size = 0;
     for (const Literal l : direct_implications) {
       if (!is_marked_[l]) {
@@ -911,6 +996,7 @@ void BinaryImplicationGraph::MinimizeConflictFirstWithTransitiveReduction(
 
   int new_size = 0;
   auto& direct_implications = implications_[root_literal_index];
+  InvalidateCompactImplications();
 
   // The randomization allow to find more redundant implication since to find
   // a => b and remove b, a must be before b in direct_implications. Note that
@@ -1023,6 +1109,7 @@ void BinaryImplicationGraph::RemoveFixedVariables() {
   const int new_num_fixed = trail_->Index();
   DCHECK_EQ(propagation_trail_index_, new_num_fixed);
   if (num_processed_fixed_variables_ == new_num_fixed) return;
+  InvalidateCompactImplications();
 
   const VariablesAssignment& assignment = trail_->Assignment();
   is_marked_.ClearAndResize(LiteralIndex(implications_.size()));
@@ -1086,29 +1173,49 @@ class SccGraph {
       StronglyConnectedComponentsFinder<int32_t, SccGraph,
                                         std::vector<std::vector<int32_t>>>;
 
+  // If the graph is restricted to one weakly connected component of the
+  // implication graph, its node i is the literal component->literals[i].
+  // Otherwise the nodes are the literal indices.
+  struct Component {
+    // The index of this component in the two vectors below.
+    int32_t index;
+    absl::Span<const int32_t> literals;
+
+    // Indexed by literal. The index of the component of each literal, and the
+    // position of the literal in the literals of its component.
+    const std::vector<int32_t>* component_of;
+    const std::vector<int32_t>* node_of;
+  };
+
+  // The node from which each at most one in at_most_one_buffer was first
+  // explored is stored in previous_node_to_explore_at_most_one, indexed by
+  // the start of the at most one, which must be -1 for all of them
+  // initially. Each at most one is in a single weakly connected component,
+  // so the graphs of different components can share this vector.
   explicit SccGraph(SccFinder* finder, Implication* graph,
                     AtMostOne* at_most_ones,
-                    std::vector<Literal>* at_most_one_buffer)
+                    std::vector<Literal>* at_most_one_buffer,
+                    std::vector<int32_t>* previous_node_to_explore_at_most_one,
+                    const Component* component = nullptr)
       : finder_(*finder),
         implications_(*graph),
         at_most_ones_(*at_most_ones),
-        at_most_one_buffer_(*at_most_one_buffer) {}
+        at_most_one_buffer_(*at_most_one_buffer),
+        previous_node_to_explore_at_most_one_(
+            *previous_node_to_explore_at_most_one),
+        component_(component) {}
 
   const std::vector<int32_t>& operator[](int32_t node) const {
     tmp_.clear();
-    for (const Literal l : implications_[LiteralIndex(node)]) {
-      tmp_.push_back(l.Index().value());
-      if (finder_.NodeIsInCurrentDfsPath(l.NegatedIndex().value())) {
+    const LiteralIndex literal = LiteralOf(node);
+    for (const Literal l : implications_[literal]) {
+      tmp_.push_back(NodeOf(l.Index()));
+      if (IsInCurrentDfsPath(l.NegatedIndex())) {
         to_fix_.push_back(l);
       }
     }
-    if (node < at_most_ones_.size()) {
-      for (const int start : at_most_ones_[LiteralIndex(node)]) {
-        if (start >= at_most_one_already_explored_.size()) {
-          at_most_one_already_explored_.resize(start + 1, false);
-          previous_node_to_explore_at_most_one_.resize(start + 1);
-        }
-
+    if (literal < at_most_ones_.size()) {
+      for (const int start : at_most_ones_[literal]) {
         // In the presence of at_most_ones_ constraints, expanding them
         // implicitly to implications in the SCC computation can result in a
         // quadratic complexity rather than a linear one in term of the input
@@ -1116,7 +1223,7 @@ class SccGraph {
         // large at_most ones like the "ivu06-big.mps.gz" where without it, the
         // full FindStronglyConnectedComponents() take more than on hour instead
         // of less than a second!
-        if (at_most_one_already_explored_[start]) {
+        if (previous_node_to_explore_at_most_one_[start] >= 0) {
           // We never expand a node twice.
           const int first_node = previous_node_to_explore_at_most_one_[start];
           CHECK_NE(node, first_node);
@@ -1141,21 +1248,20 @@ class SccGraph {
           } else {
             // The first node is already settled and so are all its child. Only
             // not(first_node) might still need exploring.
-            tmp_.push_back(
-                Literal(LiteralIndex(first_node)).NegatedIndex().value());
+            tmp_.push_back(NodeOf(
+                Literal(LiteralOf(first_node)).NegatedIndex()));
             continue;
           }
         } else {
-          at_most_one_already_explored_[start] = true;
           previous_node_to_explore_at_most_one_[start] = node;
         }
 
         for (int i = start;; ++i) {
           const Literal l = at_most_one_buffer_[i];
           if (l.Index() == kNoLiteralIndex) break;
-          if (l.Index() == node) continue;
-          tmp_.push_back(l.NegatedIndex().value());
-          if (finder_.NodeIsInCurrentDfsPath(l.Index().value())) {
+          if (l.Index() == literal) continue;
+          tmp_.push_back(NodeOf(l.NegatedIndex()));
+          if (IsInCurrentDfsPath(l.Index())) {
             to_fix_.push_back(l.Negated());
           }
         }
@@ -1172,18 +1278,142 @@ class SccGraph {
   mutable int64_t work_done_ = 0;
 
  private:
+  LiteralIndex LiteralOf(int32_t node) const {
+    return LiteralIndex(component_ == nullptr ? node
+                                              : component_->literals[node]);
+  }
+
+  int32_t NodeOf(LiteralIndex literal) const {
+    return component_ == nullptr ? literal.value()
+                                 : (*component_->node_of)[literal.value()];
+  }
+
+  // Note that the negation of a literal of the component might not be in it.
+  bool IsInCurrentDfsPath(LiteralIndex literal) const {
+    if (component_ != nullptr &&
+        (*component_->component_of)[literal.value()] != component_->index) {
+      return false;
+    }
+    return finder_.NodeIsInCurrentDfsPath(NodeOf(literal));
+  }
+
   const SccFinder& finder_;
   const Implication& implications_;
   const AtMostOne& at_most_ones_;
   const std::vector<Literal>& at_most_one_buffer_;
 
-  mutable std::vector<int32_t> tmp_;
-
   // Used to get a non-quadratic complexity in the presence of at most ones.
-  mutable std::vector<bool> at_most_one_already_explored_;
-  mutable std::vector<int> previous_node_to_explore_at_most_one_;
+  std::vector<int32_t>& previous_node_to_explore_at_most_one_;
+
+  const Component* component_;
+
+  mutable std::vector<int32_t> tmp_;
 };
 
+void BinaryImplicationGraph::FindStronglyConnectedComponentsInParallel(
+    int num_workers, std::vector<std::vector<int32_t>>* scc,
+    std::vector<Literal>* to_fix, int64_t* work_done) {
+  const int32_t size(implications_.size());
+
+  // Splits the literals by weakly connected component. Each at most one
+  // connects its literals and their negations, which is a bit more than
+  // needed for at most ones of size 2.
+  DenseConnectedComponentsFinder weak_components;
+  weak_components.SetNumberOfNodes(size);
+  for (LiteralIndex i(0); i < size; ++i) {
+    for (const Literal l : implications_[i]) {
+      weak_components.AddEdge(i.value(), l.Index().value());
+    }
+  }
+  for (int i = 0; i < at_most_one_buffer_.size(); ++i) {
+    const Literal l = at_most_one_buffer_[i];
+    if (l.Index() == kNoLiteralIndex) continue;
+    weak_components.AddEdge(l.Index().value(), l.NegatedIndex().value());
+    if (i + 1 < at_most_one_buffer_.size() &&
+        at_most_one_buffer_[i + 1].Index() != kNoLiteralIndex) {
+      weak_components.AddEdge(l.Index().value(),
+                              at_most_one_buffer_[i + 1].Index().value());
+    }
+  }
+
+  // The components are numbered by their smallest literal, and the literals of
+  // a component are sorted, so that the result doesn't depend on the number of
+  // workers.
+  std::vector<int32_t> component_of(size);
+  std::vector<int32_t> node_of(size);
+  std::vector<int32_t> component_starts;
+  std::vector<int32_t> root_to_component(size, -1);
+  std::vector<int32_t> component_sizes;
+  for (int32_t i = 0; i < size; ++i) {
+    const int root = weak_components.FindRoot(i);
+    if (root_to_component[root] == -1) {
+      root_to_component[root] = component_sizes.size();
+      component_sizes.push_back(0);
+    }
+    const int32_t c = root_to_component[root];
+    component_of[i] = c;
+    node_of[i] = component_sizes[c]++;
+  }
+  const int num_components = component_sizes.size();
+  component_starts.assign(num_components + 1, 0);
+  for (int c = 0; c < num_components; ++c) {
+    component_starts[c + 1] = component_starts[c] + component_sizes[c];
+  }
+  std::vector<int32_t> literals(size);
+  for (int32_t i = 0; i < size; ++i) {
+    literals[component_starts[component_of[i]] + node_of[i]] = i;
+  }
+
+  // Each worker takes the next component not yet processed. Note that the
+  // order of the components in the result is a valid reverse topological order
+  // since there is no arc between two of them.
+  std::vector<std::vector<std::vector<int32_t>>> component_scc(num_components);
+  std::vector<std::vector<Literal>> component_to_fix(num_components);
+  std::vector<int64_t> component_work_done(num_components, 0);
+  std::vector<int32_t> previous_node_to_explore_at_most_one(
+      at_most_one_buffer_.size(), -1);
+  std::atomic<int> next_component = 0;
+  const auto process_components = [&]() {
+    SccGraph::SccFinder finder;
+    while (true) {
+      const int c = next_component.fetch_add(1, std::memory_order_relaxed);
+      if (c >= num_components) return;
+      const SccGraph::Component component = {
+          c,
+          absl::MakeConstSpan(literals.data() + component_starts[c],
+                              component_sizes[c]),
+          &component_of, &node_of};
+      SccGraph graph(&finder, &implications_, &at_most_ones_,
+                     &at_most_one_buffer_,
+                     &previous_node_to_explore_at_most_one, &component);
+      finder.FindStronglyConnectedComponents(component_sizes[c], graph,
+                                             &component_scc[c]);
+      for (std::vector<int32_t>& nodes : component_scc[c]) {
+        for (int32_t& node : nodes) node = component.literals[node];
+      }
+      component_to_fix[c] = std::move(graph.to_fix_);
+      component_work_done[c] = graph.work_done_;
+    }
+  };
+  {
+    ThreadPool pool("SccWorkers", num_workers);
+    pool.StartWorkers();
+    for (int w = 0; w < num_workers; ++w) pool.Schedule(process_components);
+  }
+
+  scc->clear();
+  to_fix->clear();
+  *work_done = 0;
+  for (int c = 0; c < num_components; ++c) {
+    for (std::vector<int32_t>& nodes : component_scc[c]) {
+      scc->push_back(std::move(nodes));
+    }
+    to_fix->insert(to_fix->end(), component_to_fix[c].begin(),
+                   component_to_fix[c].end());
+    *work_done += component_work_done[c];
+  }
+}
+
 bool BinaryImplicationGraph::DetectEquivalences(bool log_info) {
   // This was already called, and no new constraint where added. Note that new
   // fixed variable cannot create new equivalence, only new binary clauses do.
@@ -1197,6 +1427,7 @@ bool BinaryImplicationGraph::DetectEquivalences(bool log_info) {
   RemoveFixedVariables();
   const VariablesAssignment& assignment = trail_->Assignment();
   DCHECK(InvariantsAreOk());
+  InvalidateCompactImplications();
 
   // TODO(user): We could just do it directly though.
   int num_fixed_during_scc = 0;
@@ -1204,13 +1435,26 @@ bool BinaryImplicationGraph::DetectEquivalences(bool log_info) {
   std::vector<std::vector<int32_t>> scc;
   double dtime = 0.0;
   {
-    SccGraph::SccFinder finder;
-    SccGraph graph(&finder, &implications_, &at_most_ones_,
-                   &at_most_one_buffer_);
-    finder.FindStronglyConnectedComponents(size, graph, &scc);
-    dtime += 4e-8 * graph.work_done_;
-
-    for (const Literal l : graph.to_fix_) {
+    std::vector<Literal> to_fix;
+    int64_t work_done = 0;
+    const int num_workers = parameters_.equivalence_detection_num_workers();
+    if (num_workers > 1) {
+      FindStronglyConnectedComponentsInParallel(num_workers, &scc, &to_fix,
+                                                &work_done);
+    } else {
+      std::vector<int32_t> previous_node_to_explore_at_most_one(
+          at_most_one_buffer_.size(), -1);
+      SccGraph::SccFinder finder;
+      SccGraph graph(&finder, &implications_, &at_most_ones_,
+                     &at_most_one_buffer_,
+                     &previous_node_to_explore_at_most_one);
+      finder.FindStronglyConnectedComponents(size, graph, &scc);
+      to_fix = std::move(graph.to_fix_);
+      work_done = graph.work_done_;
+    }
+    dtime += 4e-8 * work_done;
+
+    for (const Literal l : to_fix) {
       if (assignment.LiteralIsFalse(l)) return false;
       if (assignment.LiteralIsTrue(l)) continue;
       ++num_fixed_during_scc;
@@ -1386,6 +1630,7 @@ bool BinaryImplicationGraph::ComputeTransitiveReduction(bool log_info) {
   if (!Propagate(trail_)) return false;
   RemoveFixedVariables();
   DCHECK(InvariantsAreOk());
+  InvalidateCompactImplications();
 
   log_info |= VLOG_IS_ON(1);
   WallTimer wall_timer;
@@ -2172,6 +2417,7 @@ int64_t BinaryImplicationGraph::NumImplicationOnVariableRemoval(
 // For all possible a => var => b, add a => b.
 void BinaryImplicationGraph::RemoveBooleanVariable(
     BooleanVariable var, std::deque<std::vector<Literal>>* postsolve_clauses) {
+  InvalidateCompactImplications();
   const Literal literal(var, true);
   direct_implications_of_negated_literal_ =
       DirectImplications(literal.Negated());
@@ -2217,6 +2463,7 @@ void BinaryImplicationGraph::RemoveBooleanVariable(
 }
 
 void BinaryImplicationGraph::CleanupAllRemovedVariables() {
+  InvalidateCompactImplications();
   for (LiteralIndex a(0); a < implications_.size(); ++a) {
     if (is_removed_[a]) {
       DCHECK(implications_[a].empty());
@@ -2237,6 +2484,29 @@ void BinaryImplicationGraph::CleanupAllRemovedVariables() {
   DCHECK(InvariantsAreOk());
 }
 
+bool BinaryImplicationGraph::CompactImplicationsAreOk() const {
+  if (!compact_is_valid_) return true;
+  for (LiteralIndex a_index(0); a_index < implications_.size(); ++a_index) {
+    const int64_t start = compact_starts_[a_index.value()];
+    const int64_t size = compact_starts_[a_index.value() + 1] - start;
+    const auto& implications = implications_[a_index];
+    if (size > implications.size() ||
+        !std::equal(compact_implications_.begin() + start,
+                    compact_implications_.begin() + start + size,
+                    implications.begin())) {
+      LOG(ERROR) << "The compact implications of " << Literal(a_index)
+                 << " are not a prefix of its implications.";
+      return false;
+    }
+    if (size < implications.size() && !has_new_implications_[a_index]) {
+      LOG(ERROR) << "The new implications of " << Literal(a_index)
+                 << " are not flagged.";
+      return false;
+    }
+  }
+  return true;
+}
+
 bool BinaryImplicationGraph::InvariantsAreOk() {
   // We check that if a => b then not(b) => not(a).
   absl::flat_hash_set<std::pair<LiteralIndex, LiteralIndex>> seen;
@@ -2301,6 +2571,8 @@ bool BinaryImplicationGraph::InvariantsAreOk() {
     }
   }
 
+  if (!CompactImplicationsAreOk()) return false;
+
   // Check the at-most ones.
   absl::flat_hash_set<std::pair<LiteralIndex, int>> lit_to_start;
   for (LiteralIndex i(0); i < at_most_ones_.size(); ++i) {
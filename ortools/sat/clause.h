@@ -460,6 +460,7 @@ class BinaryImplicationGraph : public SatPropagator {
   explicit BinaryImplicationGraph(Model* model)
       : SatPropagator("BinaryImplicationGraph"),
         stats_("BinaryImplicationGraph"),
+        parameters_(*model->GetOrCreate<SatParameters>()),
         time_limit_(model->GetOrCreate<TimeLimit>()),
         random_(model->GetOrCreate<ModelRandomGenerator>()),
         trail_(model->GetOrCreate<Trail>()) {
@@ -561,6 +562,13 @@ class BinaryImplicationGraph : public SatPropagator {
     return reverse_topological_order_;
   }
 
+  // Rebuilds the compact copy of the implication lists used by Propagate() if
+  // it is out of date and worth it. The rebuild is O(num_implications()), so
+  // this only happens when the propagation work done since the copy became
+  // invalid amortizes it, or when too many implications were added since the
+  // last rebuild. This is meant to be called at restarts.
+  void CompactImplicationsIfUseful();
+
   // Returns the list of literal "directly" implied by l. Beware that this can
   // easily change behind your back if you modify the solver state.
   const absl::InlinedVector<Literal, 6>& Implications(Literal l) const {
@@ -750,6 +758,27 @@ class BinaryImplicationGraph : public SatPropagator {
   // This calls trail->Enqueue() on the newly assigned literals.
   bool PropagateOnTrue(Literal true_literal, Trail* trail);
 
+  // Propagates the given implications of true_literal. Same as the first part
+  // of PropagateOnTrue().
+  bool PropagateImplications(Literal true_literal,
+                             absl::Span<const Literal> implications,
+                             AssignmentView assignment, Trail* trail);
+
+  // Must be called before any change of implications_ other than appending new
+  // literals at the end of a list. See compact_implications_.
+  void InvalidateCompactImplications() {
+    if (!compact_is_valid_) return;
+    compact_is_valid_ = false;
+    num_inspections_at_invalidation_ = num_inspections_;
+  }
+
+  // Must be called after appending literals to implications_[l].
+  void NotifyNewImplications(LiteralIndex l, int num_new) {
+    if (!compact_is_valid_) return;
+    has_new_implications_.Set(l);
+    num_new_implications_ += num_new;
+  }
+
   // Remove any literal whose negation is marked (except the first one).
   void RemoveRedundantLiterals(std::vector<Literal>* conflict);
 
@@ -772,10 +801,25 @@ class BinaryImplicationGraph : public SatPropagator {
   // If the final AMO size is smaller than "expansion_size" we fully expand it.
   bool CleanUpAndAddAtMostOnes(int base_index, int expansion_size = 10);
 
+  // Finds the same strongly connected components and literals to fix as the
+  // sequential search in DetectEquivalences(), with the weakly connected
+  // components of the graph processed by num_workers threads. The results of
+  // the weak components are concatenated in the order of their smallest
+  // literal, which is still a reverse topological order since there is no arc
+  // between them, so they don't depend on num_workers.
+  void FindStronglyConnectedComponentsInParallel(
+      int num_workers, std::vector<std::vector<int32_t>>* scc,
+      std::vector<Literal>* to_fix, int64_t* work_done);
+
   // To be used in DCHECKs().
   bool InvariantsAreOk();
 
+  // Checks the invariant of compact_implications_ below. This is part of
+  // InvariantsAreOk() but, unlike it, also holds at a positive decision level.
+  bool CompactImplicationsAreOk() const;
+
   mutable StatsGroup stats_;
+  const SatParameters& parameters_;
   TimeLimit* time_limit_;
   ModelRandomGenerator* random_;
   Trail* trail_;
@@ -799,6 +843,24 @@ class BinaryImplicationGraph : public SatPropagator {
       implications_;
   int64_t num_implications_ = 0;
 
+  // Contiguous copy of implications_ in CSR format used by the propagation.
+  // Walking the lists of many literals in a row with implications_ means
+  // jumping between a lot of small heap allocations, which dominates the
+  // propagation time on large graphs.
+  //
+  // When compact_is_valid_ is true, compact_implications_ contains, in order,
+  // the lists of all literals, the one of l being the range
+  // [compact_starts_[l], compact_starts_[l + 1]). Each range is a prefix of
+  // implications_[l], and has_new_implications_[l] is set if more literals were
+  // appended to implications_[l] since the last rebuild. Any other change to
+  // implications_ invalidates this copy until the next rebuild.
+  bool compact_is_valid_ = false;
+  std::vector<int64_t> compact_starts_;
+  std::vector<Literal> compact_implications_;
+  Bitset64<LiteralIndex> has_new_implications_;
+  int64_t num_new_implications_ = 0;
+  int64_t num_inspections_at_invalidation_ = 0;
+
   // Internal representation of at_most_one constraints. Each entry point to the
   // start of a constraint in the buffer. Constraints are terminated by
   // kNoLiteral. When LiteralIndex is true, then all entry in the at most one
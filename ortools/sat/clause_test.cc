@@ -0,0 +1,343 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/sat/clause.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/log/check.h"
+#include "absl/random/distributions.h"
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "ortools/sat/model.h"
+#include "ortools/sat/sat_base.h"
+#include "ortools/sat/sat_parameters.pb.h"
+#include "ortools/sat/sat_solver.h"
+
+namespace operations_research {
+namespace sat {
+namespace {
+
+Literal Lit(int signed_value) { return Literal(signed_value); }
+
+TEST(BinaryImplicationGraphTest, PropagatesChainsOfImplications) {
+  Model model;
+  SatSolver* sat_solver = model.GetOrCreate<SatSolver>();
+  sat_solver->SetNumVariables(4);
+  // 1 => 2 => 3 => not(4).
+  ASSERT_TRUE(sat_solver->AddBinaryClause(Lit(-1), Lit(2)));
+  ASSERT_TRUE(sat_solver->AddBinaryClause(Lit(-2), Lit(3)));
+  ASSERT_TRUE(sat_solver->AddBinaryClause(Lit(-3), Lit(-4)));
+  ASSERT_TRUE(sat_solver->EnqueueDecisionIfNotConflicting(Lit(1)));
+  const VariablesAssignment& assignment = sat_solver->Assignment();
+  EXPECT_TRUE(assignment.LiteralIsTrue(Lit(2)));
+  EXPECT_TRUE(assignment.LiteralIsTrue(Lit(3)));
+  EXPECT_TRUE(assignment.LiteralIsFalse(Lit(4)));
+
+  // The reason of each propagation is the literal that implied it.
+  const Trail& trail = *model.GetOrCreate<Trail>();
+  EXPECT_EQ(trail.Reason(Lit(3).Variable()), std::vector<Literal>{Lit(-2)});
+}
+
+TEST(BinaryImplicationGraphTest, DetectsConflicts) {
+  Model model;
+  SatSolver* sat_solver = model.GetOrCreate<SatSolver>();
+  sat_solver->SetNumVariables(3);
+  // 1 => 2, 1 => 3 and 2 => not(3).
+  ASSERT_TRUE(sat_solver->AddBinaryClause(Lit(-1), Lit(2)));
+  ASSERT_TRUE(sat_solver->AddBinaryClause(Lit(-1), Lit(3)));
+  ASSERT_TRUE(sat_solver->AddBinaryClause(Lit(-2), Lit(-3)));
+  EXPECT_FALSE(sat_solver->EnqueueDecisionIfNotConflicting(Lit(1)));
+
+  // The conflict analysis learns that 1 must be false.
+  sat_solver->EnqueueDecisionAndBackjumpOnConflict(Lit(1));
+  EXPECT_EQ(sat_solver->CurrentDecisionLevel(), 0);
+  EXPECT_TRUE(sat_solver->Assignment().LiteralIsFalse(Lit(1)));
+}
+
+TEST(BinaryImplicationGraphTest, DetectEquivalencesMergesCycles) {
+  Model model;
+  SatSolver* sat_solver = model.GetOrCreate<SatSolver>();
+  sat_solver->SetNumVariables(4);
+  // 1 => 2 => 3 => 1 and 3 => 4.
+  ASSERT_TRUE(sat_solver->AddBinaryClause(Lit(-1), Lit(2)));
+  ASSERT_TRUE(sat_solver->AddBinaryClause(Lit(-2), Lit(3)));
+  ASSERT_TRUE(sat_solver->AddBinaryClause(Lit(-3), Lit(1)));
+  ASSERT_TRUE(sat_solver->AddBinaryClause(Lit(-3), Lit(4)));
+  BinaryImplicationGraph* graph = model.GetOrCreate<BinaryImplicationGraph>();
+  ASSERT_TRUE(graph->DetectEquivalences());
+  const Literal representative = graph->RepresentativeOf(Lit(1));
+  EXPECT_EQ(graph->RepresentativeOf(Lit(2)), representative);
+  EXPECT_EQ(graph->RepresentativeOf(Lit(3)), representative);
+  EXPECT_EQ(graph->RepresentativeOf(Lit(-2)), representative.Negated());
+  EXPECT_EQ(graph->RepresentativeOf(Lit(4)), Lit(4));
+}
+
+TEST(BinaryImplicationGraphTest, DetectEquivalencesFindsFixedLiterals) {
+  Model model;
+  SatSolver* sat_solver = model.GetOrCreate<SatSolver>();
+  sat_solver->SetNumVariables(2);
+  // 1 => 2 => not(1), so 1 must be false.
+  ASSERT_TRUE(sat_solver->AddBinaryClause(Lit(-1), Lit(2)));
+  ASSERT_TRUE(sat_solver->AddBinaryClause(Lit(-2), Lit(-1)));
+  ASSERT_TRUE(
+      model.GetOrCreate<BinaryImplicationGraph>()->DetectEquivalences());
+  EXPECT_TRUE(sat_solver->Assignment().LiteralIsFalse(Lit(1)));
+}
+
+// Adds num_variables * clauses_per_variable random binary clauses. Most of
+// them are a => b with a < b, so that propagation does not always conflict.
+// The two variables of a clause are in the same block of block_size
+// consecutive variables, so that the implication graph has at least
+// num_variables / block_size weakly connected components.
+void AddRandomBinaryClauses(int num_variables, int clauses_per_variable,
+                            std::mt19937* random, SatSolver* sat_solver,
+                            int block_size = 0) {
+  if (block_size == 0) block_size = num_variables;
+  sat_solver->SetNumVariables(num_variables);
+  const int64_t num_clauses =
+      static_cast<int64_t>(num_variables) * clauses_per_variable;
+  for (int64_t i = 0; i < num_clauses; ++i) {
+    const int a = absl::Uniform<int>(*random, 0, num_variables);
+    const int block_start = a - a % block_size;
+    const int b = absl::Uniform<int>(
+        *random, block_start, std::min(block_start + block_size, num_variables));
+    if (a == b) continue;
+    sat_solver->AddBinaryClause(Literal(BooleanVariable(a), a > b),
+                                Literal(BooleanVariable(b), true));
+  }
+  CHECK(!sat_solver->ModelIsUnsat());
+}
+
+// Returns the literals propagated by each decision on the given variables,
+// in trail order, starting from level zero each time.
+std::vector<std::vector<Literal>> PropagateEachVariable(int num_variables,
+                                                        Model* model) {
+  SatSolver* sat_solver = model->GetOrCreate<SatSolver>();
+  const Trail& trail = *model->GetOrCreate<Trail>();
+  std::vector<std::vector<Literal>> result;
+  for (int var = 0; var < num_variables; ++var) {
+    for (const bool value : {true, false}) {
+      const Literal decision(BooleanVariable(var), value);
+      std::vector<Literal>& propagated = result.emplace_back();
+      if (sat_solver->Assignment().LiteralIsAssigned(decision)) continue;
+      if (!sat_solver->EnqueueDecisionIfNotConflicting(decision)) {
+        propagated.push_back(Literal(kNoLiteralIndex));
+        continue;
+      }
+      for (int i = trail.Index() - 1; trail[i] != decision; --i) {
+        propagated.push_back(trail[i]);
+      }
+      sat_solver->Backtrack(0);
+    }
+  }
+  return result;
+}
+
+// The compact copy of the implications is only built once the propagations
+// amortize it. It must then give the same propagations as the lists it copies,
+// after new clauses are appended to them, and after the lists are modified.
+TEST(BinaryImplicationGraphTest, PropagatesFromTheCompactCopy) {
+  constexpr int kNumVariables = 200;
+  std::mt19937 random(12345);
+  std::mt19937 expected_random(12345);
+  Model model;
+  SatSolver* sat_solver = model.GetOrCreate<SatSolver>();
+  AddRandomBinaryClauses(kNumVariables, 2, &random, sat_solver);
+  Model expected_model;
+  SatSolver* expected_sat_solver = expected_model.GetOrCreate<SatSolver>();
+  AddRandomBinaryClauses(kNumVariables, 2, &expected_random,
+                         expected_sat_solver);
+  BinaryImplicationGraph* graph = model.GetOrCreate<BinaryImplicationGraph>();
+
+  const auto expect_same_propagations = [&]() {
+    ASSERT_EQ(PropagateEachVariable(kNumVariables, &model),
+              PropagateEachVariable(kNumVariables, &expected_model));
+  };
+  expect_same_propagations();
+  graph->CompactImplicationsIfUseful();
+  expect_same_propagations();
+
+  // New clauses are read from the end of the implication lists. They all have
+  // a positive literal, so that setting all the variables to true stays a
+  // solution, and they close cycles of implications between positive literals.
+  for (int i = 0; i < kNumVariables / 2; ++i) {
+    const Literal a(BooleanVariable(absl::Uniform(random, 0, kNumVariables)),
+                    absl::Bernoulli(random, 0.5));
+    const Literal b(BooleanVariable(absl::Uniform(random, 0, kNumVariables)),
+                    true);
+    if (a.Variable() == b.Variable()) continue;
+    if (sat_solver->Assignment().VariableIsAssigned(a.Variable()) ||
+        sat_solver->Assignment().VariableIsAssigned(b.Variable())) {
+      continue;
+    }
+    ASSERT_TRUE(sat_solver->AddBinaryClause(a, b));
+    ASSERT_TRUE(expected_sat_solver->AddBinaryClause(a, b));
+    if (i % 10 == 0) expect_same_propagations();
+  }
+  expect_same_propagations();
+
+  // Merging the equivalent literals and fixing literals rewrites the lists.
+  ASSERT_TRUE(graph->DetectEquivalences());
+  ASSERT_TRUE(expected_model.GetOrCreate<BinaryImplicationGraph>()
+                  ->DetectEquivalences());
+  ASSERT_TRUE(sat_solver->FinishPropagation());
+  ASSERT_TRUE(expected_sat_solver->FinishPropagation());
+  graph->CompactImplicationsIfUseful();
+  expect_same_propagations();
+  expect_same_propagations();
+  graph->CompactImplicationsIfUseful();
+  expect_same_propagations();
+}
+
+// Returns the representative of all literals, or the fixed value for the fixed
+// ones, after DetectEquivalences() with the given number of workers.
+std::vector<Literal> DetectEquivalencesWithWorkers(
+    int num_workers, std::vector<LiteralIndex>* reverse_topological_order) {
+  constexpr int kNumVariables = 3000;
+  std::mt19937 random(12345);
+  Model model;
+  model.GetOrCreate<SatParameters>()->set_equivalence_detection_num_workers(
+      num_workers);
+  SatSolver* sat_solver = model.GetOrCreate<SatSolver>();
+  AddRandomBinaryClauses(kNumVariables, 1, &random, sat_solver,
+                         /*block_size=*/30);
+  // Implications in both directions between the variables of a block close
+  // cycles, whose literals are equivalent.
+  for (int i = 0; i < kNumVariables / 2; ++i) {
+    const int a = absl::Uniform<int>(random, 0, kNumVariables);
+    const int b = a - a % 30 + absl::Uniform<int>(random, 0, 30);
+    if (a == b || b >= kNumVariables) continue;
+    CHECK(sat_solver->AddBinaryClause(Literal(BooleanVariable(a), false),
+                                      Literal(BooleanVariable(b), true)));
+  }
+  BinaryImplicationGraph* graph = model.GetOrCreate<BinaryImplicationGraph>();
+  // The at most ones are on negated literals, so that setting all the
+  // variables to true stays a solution.
+  for (int start = 0; start + 5 <= kNumVariables; start += 50) {
+    std::vector<Literal> at_most_one;
+    for (int var = start; var < start + 5; ++var) {
+      at_most_one.push_back(Literal(BooleanVariable(var), false));
+    }
+    CHECK(graph->AddAtMostOne(at_most_one, /*expansion_size=*/0));
+  }
+  CHECK(graph->DetectEquivalences());
+  *reverse_topological_order = graph->ReverseTopologicalOrder();
+
+  std::vector<Literal> result;
+  const VariablesAssignment& assignment = sat_solver->Assignment();
+  for (int var = 0; var < kNumVariables; ++var) {
+    const Literal literal(BooleanVariable(var), true);
+    if (assignment.LiteralIsAssigned(literal)) {
+      result.push_back(assignment.GetTrueLiteralForAssignedVariable(
+          literal.Variable()));
+    } else {
+      result.push_back(graph->RepresentativeOf(literal));
+    }
+  }
+  return result;
+}
+
+TEST(BinaryImplicationGraphTest, DetectEquivalencesWithWorkers) {
+  std::vector<LiteralIndex> sequential_order;
+  const std::vector<Literal> expected =
+      DetectEquivalencesWithWorkers(1, &sequential_order);
+
+  // Make sure the instance has equivalences.
+  int num_equivalent = 0;
+  for (int var = 0; var < expected.size(); ++var) {
+    if (expected[var].Variable() != BooleanVariable(var)) ++num_equivalent;
+  }
+  EXPECT_GT(num_equivalent, 10);
+
+  std::vector<LiteralIndex> order;
+  EXPECT_EQ(DetectEquivalencesWithWorkers(2, &order), expected);
+  absl::c_sort(order);
+  absl::c_sort(sequential_order);
+  EXPECT_EQ(order, sequential_order);
+
+  std::vector<LiteralIndex> two_workers_order;
+  ASSERT_EQ(DetectEquivalencesWithWorkers(2, &two_workers_order), expected);
+  EXPECT_EQ(DetectEquivalencesWithWorkers(4, &order), expected);
+  EXPECT_EQ(order, two_workers_order);
+}
+
+// Propagation throughput on a random 2-SAT-like instance with the given number
+// of variables and binary clauses per variable. Each iteration propagates a
+// random decision and backtracks.
+void BM_PropagateBinaryClauses(benchmark::State& state) {
+  std::mt19937 random(12345);
+  Model model;
+  SatSolver* sat_solver = model.GetOrCreate<SatSolver>();
+  AddRandomBinaryClauses(state.range(0), state.range(1), &random, sat_solver);
+  const int num_variables = state.range(0);
+
+  int64_t num_propagated = 0;
+  for (auto _ : state) {
+    const Literal decision(
+        BooleanVariable(absl::Uniform<int>(random, 0, num_variables)),
+        absl::Bernoulli(random, 0.5));
+    if (sat_solver->Assignment().LiteralIsAssigned(decision)) continue;
+    sat_solver->EnqueueDecisionAndBackjumpOnConflict(decision);
+    num_propagated += model.GetOrCreate<Trail>()->Index();
+    sat_solver->Backtrack(0);
+  }
+  state.counters["propagations/s"] = benchmark::Counter(
+      static_cast<double>(num_propagated), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_PropagateBinaryClauses)
+    ->Args({100'000, 4})
+    ->Args({1'000'000, 4})
+    ->Args({1'000'000, 16});
+
+// Time of the SCC based equivalence detection on the same kind of instances,
+// with clauses between the variables of blocks of state.range(2) variables
+// (all of them if 0) and state.range(3) workers. The graph is rebuilt for each
+// iteration, outside of the timing, since DetectEquivalences() does nothing on
+// a graph that is already a DAG.
+void BM_DetectEquivalences(benchmark::State& state) {
+  std::mt19937 random(12345);
+  int64_t num_implications = 0;
+  std::unique_ptr<Model> model;
+  for (auto _ : state) {
+    state.PauseTiming();
+    model = std::make_unique<Model>();
+    model->GetOrCreate<SatParameters>()
+        ->set_equivalence_detection_num_workers(state.range(3));
+    AddRandomBinaryClauses(state.range(0), state.range(1), &random,
+                           model->GetOrCreate<SatSolver>(), state.range(2));
+    BinaryImplicationGraph* graph =
+        model->GetOrCreate<BinaryImplicationGraph>();
+    num_implications += graph->num_implications();
+    state.ResumeTiming();
+    graph->DetectEquivalences();
+  }
+  state.counters["implications/s"] = benchmark::Counter(
+      static_cast<double>(num_implications), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_DetectEquivalences)
+    ->Args({100'000, 4, 0, 1})
+    ->Args({1'000'000, 4, 0, 1})
+    ->Args({1'000'000, 4, 0, 4})
+    ->Args({1'000'000, 4, 10'000, 1})
+    ->Args({1'000'000, 4, 10'000, 4})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace sat
+}  // namespace operations_research
@@ -19,6 +19,7 @@
 #include <deque>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -37,6 +38,7 @@
 #include "ortools/base/macros.h"
 #include "ortools/base/stl_util.h"
 #include "ortools/base/strong_vector.h"
+#include "ortools/base/threadpool.h"
 #include "ortools/port/proto_utils.h"
 #include "ortools/sat/boolean_problem.h"
 #include "ortools/sat/boolean_problem.pb.h"
@@ -170,6 +172,114 @@ void MinimizeCoreWithSearch(TimeLimit* limit, SatSolver* solver,
   solver->mutable_logger()->EnableLogging(old_log_state);
 }
 
+namespace {
+
+// Collects the output of SatSolver::ExtractClauses() so it can be loaded in
+// other solvers.
+struct ClauseCollector {
+  void SetNumVariables(int n) { num_variables = n; }
+  void AddBinaryClause(Literal a, Literal b) { AddClause({a, b}); }
+  void AddClause(absl::Span<const Literal> clause) {
+    literals.insert(literals.end(), clause.begin(), clause.end());
+    clause_ends.push_back(literals.size());
+  }
+
+  int num_variables = 0;
+  std::vector<Literal> literals;
+  std::vector<int> clause_ends;
+};
+
+}  // namespace
+
+void MinimizeCoreWithSearchInParallel(int num_workers, TimeLimit* limit,
+                                      SatSolver* solver,
+                                      std::vector<Literal>* core) {
+  if (solver->ModelIsUnsat()) return;
+
+  // Same limits as in MinimizeCoreWithSearch().
+  if (core->size() > 100 || core->size() == 1) return;
+  num_workers = std::min<int>(num_workers, core->size());
+  if (num_workers <= 1) {
+    MinimizeCoreWithSearch(limit, solver, core);
+    return;
+  }
+
+  // The level zero assignment is exported as unit clauses. Note that this must
+  // be done after ExtractClauses() which propagates at level zero.
+  ClauseCollector clauses;
+  solver->ExtractClauses(&clauses);
+  if (solver->ModelIsUnsat()) return;
+  const Trail& trail = solver->LiteralTrail();
+  for (int i = 0; i < trail.Index(); ++i) clauses.AddClause({trail[i]});
+
+  // The time limits are set up here as they read the given one, which is not
+  // thread-safe.
+  std::vector<std::unique_ptr<TimeLimit>> worker_limits;
+  for (int w = 0; w < num_workers; ++w) {
+    worker_limits.push_back(std::make_unique<TimeLimit>());
+    worker_limits.back()->MergeWithGlobalTimeLimit(limit);
+  }
+
+  // Worker w puts the literals starting at position w * size / num_workers
+  // first, so MinimizeCoreWithSearch(), which tries to remove the last literals
+  // first, starts at a different literal for each worker.
+  const int size = core->size();
+  std::vector<std::vector<Literal>> worker_cores(num_workers);
+  for (int w = 0; w < num_workers; ++w) {
+    const int start = w * size / num_workers;
+    worker_cores[w].assign(core->begin() + start, core->end());
+    worker_cores[w].insert(worker_cores[w].end(), core->begin(),
+                           core->begin() + start);
+  }
+  {
+    ThreadPool pool("MinimizeCore", num_workers);
+    pool.StartWorkers();
+    for (int w = 0; w < num_workers; ++w) {
+      pool.Schedule([&clauses, &worker_limits, &worker_cores, solver, w]() {
+        Model model;
+        model.Register<TimeLimit>(worker_limits[w].get());
+        SatSolver* worker_solver = model.GetOrCreate<SatSolver>();
+        worker_solver->SetParameters(solver->parameters());
+        worker_solver->SetNumVariables(clauses.num_variables);
+        int start = 0;
+        for (const int end : clauses.clause_ends) {
+          if (!worker_solver->AddProblemClause(
+                  absl::MakeConstSpan(&clauses.literals[start], end - start),
+                  /*is_safe=*/false)) {
+            return;
+          }
+          start = end;
+        }
+        MinimizeCoreWithSearch(worker_limits[w].get(), worker_solver,
+                               &worker_cores[w]);
+      });
+    }
+  }
+
+  // Keep the smallest core, the first one in case of ties so that the result
+  // does not depend on the thread scheduling, and put it back in the original
+  // order.
+  int best = 0;
+  double max_worker_dtime = 0.0;
+  for (int w = 0; w < num_workers; ++w) {
+    if (worker_cores[w].size() < worker_cores[best].size()) best = w;
+    max_worker_dtime = std::max(
+        max_worker_dtime, worker_limits[w]->GetElapsedDeterministicTime());
+  }
+  limit->AdvanceDeterministicTime(max_worker_dtime);
+  if (worker_cores[best].size() < core->size()) {
+    VLOG(1) << "parallel minimization with search " << core->size() << " -> "
+            << worker_cores[best].size();
+    absl::flat_hash_set<LiteralIndex> kept;
+    for (const Literal l : worker_cores[best]) kept.insert(l.Index());
+    int new_size = 0;
+    for (const Literal l : *core) {
+      if (kept.contains(l.Index())) (*core)[new_size++] = l;
+    }
+    core->resize(new_size);
+  }
+}
+
 bool ProbeLiteral(Literal assumption, SatSolver* solver) {
   if (solver->ModelIsUnsat()) return false;
 
@@ -575,25 +685,45 @@ bool CoreBasedOptimizer::PropagateObjectiveBounds() {
 // TODO(user): There is many other possible heuristics here, and I
 // didn't have the time to properly compare them.
 void CoreBasedOptimizer::ComputeNextStratificationThreshold() {
-  std::vector<IntegerValue> weights;
-  for (ObjectiveTerm& term : terms_) {
-    if (term.weight >= stratification_threshold_) continue;
-    if (term.weight == 0) continue;
+  // The number of fixed literals is only meaningful at level zero.
+  const int64_t num_level_zero_enqueues =
+      integer_trail_->num_level_zero_enqueues();
+  const int64_t num_fixed_literals = sat_solver_->LiteralTrail().Index();
+  if (!stratification_weights_are_valid_ ||
+      sat_solver_->CurrentDecisionLevel() != 0 ||
+      num_level_zero_enqueues != stratification_num_level_zero_enqueues_ ||
+      num_fixed_literals != stratification_num_fixed_literals_) {
+    stratification_weights_are_valid_ =
+        sat_solver_->CurrentDecisionLevel() == 0;
+    stratification_num_level_zero_enqueues_ = num_level_zero_enqueues;
+    stratification_num_fixed_literals_ = num_fixed_literals;
+    stratification_weights_.clear();
+    for (ObjectiveTerm& term : terms_) {
+      if (term.weight == 0) continue;
 
-    const IntegerValue var_lb = integer_trail_->LevelZeroLowerBound(term.var);
-    const IntegerValue var_ub = integer_trail_->LevelZeroUpperBound(term.var);
-    if (var_lb == var_ub) continue;
+      const IntegerValue var_lb =
+          integer_trail_->LevelZeroLowerBound(term.var);
+      const IntegerValue var_ub =
+          integer_trail_->LevelZeroUpperBound(term.var);
+      if (var_lb == var_ub) continue;
 
-    weights.push_back(term.weight);
+      stratification_weights_.push_back(term.weight);
+    }
+    gtl::STLSortAndRemoveDuplicates(&stratification_weights_);
   }
-  if (weights.empty()) {
+
+  // Only the weights smaller than the current threshold are candidates.
+  const int num_weights =
+      std::lower_bound(stratification_weights_.begin(),
+                       stratification_weights_.end(),
+                       stratification_threshold_) -
+      stratification_weights_.begin();
+  if (num_weights == 0) {
     stratification_threshold_ = IntegerValue(0);
     return;
   }
-
-  gtl::STLSortAndRemoveDuplicates(&weights);
   stratification_threshold_ =
-      weights[static_cast<int>(std::floor(0.9 * weights.size()))];
+      stratification_weights_[static_cast<int>(std::floor(0.9 * num_weights))];
 }
 
 bool CoreBasedOptimizer::CoverOptimization() {
@@ -681,7 +811,8 @@ SatSolver::Status CoreBasedOptimizer::OptimizeWithSatEncoding(
   // non-overlapping small cores without the need to have dedicated
   // non-overlapping core finder.
   // TODO(user): It could still be beneficial to add one. Experiments.
-  ObjectiveEncoder encoder(model_);
+  sat_encoder_ = std::make_unique<ObjectiveEncoder>(model_);
+  ObjectiveEncoder& encoder = *sat_encoder_;
   if (vars.empty()) {
     // All Booleans.
     for (int i = 0; i < literals.size(); ++i) {
@@ -721,21 +852,35 @@ SatSolver::Status CoreBasedOptimizer::OptimizeWithSatEncoding(
 
   // Initialize the bounds.
   // This is in term of number of variables not at their minimal value.
-  Coefficient lower_bound(0);
+  sat_encoding_offset_ = offset;
+  sat_encoding_lower_bound_ = Coefficient(0);
 
   // This is used by the "stratified" approach.
-  Coefficient stratified_lower_bound(0);
+  sat_encoding_stratified_lower_bound_ = Coefficient(0);
   if (parameters_->max_sat_stratification() !=
       SatParameters::STRATIFICATION_NONE) {
     for (EncodingNode* n : encoder.nodes()) {
-      stratified_lower_bound = std::max(stratified_lower_bound, n->weight());
+      sat_encoding_stratified_lower_bound_ =
+          std::max(sat_encoding_stratified_lower_bound_, n->weight());
     }
   }
+  sat_encoding_num_cores_ = 0;
+  sat_encoding_max_depth_ = 0;
+  return ContinueWithSatEncoding();
+}
+
+SatSolver::Status CoreBasedOptimizer::ContinueWithSatEncoding() {
+  ObjectiveEncoder& encoder = *sat_encoder_;
+  const Coefficient offset = sat_encoding_offset_;
+  Coefficient& lower_bound = sat_encoding_lower_bound_;
+  Coefficient& stratified_lower_bound = sat_encoding_stratified_lower_bound_;
+  int& iter = sat_encoding_num_cores_;
+  int& max_depth = sat_encoding_max_depth_;
 
   // Start the algorithm.
-  int max_depth = 0;
+  stop_ = false;
   std::string previous_core_info = "";
-  for (int iter = 0;;) {
+  while (true) {
     if (time_limit_->LimitReached()) return SatSolver::LIMIT_REACHED;
     if (!sat_solver_->ResetToLevelZero()) return SatSolver::INFEASIBLE;
 
@@ -830,7 +975,9 @@ SatSolver::Status CoreBasedOptimizer::OptimizeWithSatEncoding(
       MinimizeCoreWithPropagation(time_limit_, sat_solver_, &core);
     }
     if (parameters_->core_minimization_level() > 1) {
-      MinimizeCoreWithSearch(time_limit_, sat_solver_, &core);
+      MinimizeCoreWithSearchInParallel(
+          parameters_->core_minimization_num_workers(), time_limit_,
+          sat_solver_, &core);
     }
     if (!sat_solver_->ResetToLevelZero()) return SatSolver::INFEASIBLE;
     FilterAssignedLiteral(sat_solver_->Assignment(), &core);
@@ -1032,6 +1179,8 @@ SatSolver::Status CoreBasedOptimizer::Optimize() {
   //
   // TODO(user): Try to understand exactly why and merge both code path.
   if (!parameters_->interleave_search()) {
+    if (sat_encoder_ != nullptr) return ContinueWithSatEncoding();
+
     Coefficient offset(0);
     std::vector<Literal> literals;
     std::vector<IntegerVariable> vars;
@@ -1222,7 +1371,8 @@ SatSolver::Status CoreBasedOptimizer::Optimize() {
     }
 
     // Process the cores by creating new variables and transferring the minimum
-    // weight of each core to it.
+    // weight of each core to it. This changes the weights of the terms.
+    if (!cores.empty()) stratification_weights_are_valid_ = false;
     if (!sat_solver_->ResetToLevelZero()) return SatSolver::INFEASIBLE;
     for (const std::vector<Literal>& core : cores) {
       // This just increase the lower-bound of the corresponding node.
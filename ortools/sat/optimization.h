@@ -14,11 +14,14 @@
 #ifndef OR_TOOLS_SAT_OPTIMIZATION_H_
 #define OR_TOOLS_SAT_OPTIMIZATION_H_
 
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include "ortools/sat/clause.h"
 #include "ortools/sat/cp_model_mapping.h"
+#include "ortools/sat/encoding.h"
 #include "ortools/sat/integer.h"
 #include "ortools/sat/integer_search.h"
 #include "ortools/sat/model.h"
@@ -45,6 +48,20 @@ void MinimizeCoreWithPropagation(TimeLimit* limit, SatSolver* solver,
 void MinimizeCoreWithSearch(TimeLimit* limit, SatSolver* solver,
                             std::vector<Literal>* core);
 
+// Same as MinimizeCoreWithSearch() but runs num_workers minimizations in
+// parallel, each one starting by trying to remove a different literal, and
+// keeps the smallest core found. Note that the literal of the minimized core
+// will stay in the same order.
+//
+// Each worker uses its own solver loaded with a copy of the problem clauses of
+// the given solver and of its level zero assignment. This is a relaxation of
+// the problem, so a subset of the core that is infeasible for a copy is also a
+// core of the solver, but the copies cannot remove the literals which are
+// only needed because of the non-clause constraints.
+void MinimizeCoreWithSearchInParallel(int num_workers, TimeLimit* limit,
+                                      SatSolver* solver,
+                                      std::vector<Literal>* core);
+
 bool ProbeLiteral(Literal assumption, SatSolver* solver);
 
 // Remove fixed literals from the core.
@@ -109,6 +126,9 @@ class CoreBasedOptimizer {
   // be of the same size as the coefficients vector.
   //
   // It seems to be more powerful, but it isn't completely implemented yet.
+  // The encoding is kept when this returns, and a later call to Optimize()
+  // resumes the search with it instead of encoding the objective again.
+  //
   // TODO(user):
   // - Support resuming for interleaved search.
   // - Implement all core heurisitics.
@@ -149,6 +169,10 @@ class CoreBasedOptimizer {
   // Sets it to zero if all the assumptions where already considered.
   void ComputeNextStratificationThreshold();
 
+  // The core loop of OptimizeWithSatEncoding(), which uses and extends
+  // sat_encoder_.
+  SatSolver::Status ContinueWithSatEncoding();
+
   // If we have an "at most one can be false" between literals with a positive
   // cost, you then know that at least n - 1 will contribute to the cost, and
   // you can increase the objective lower bound. This is the same as having
@@ -178,6 +202,26 @@ class CoreBasedOptimizer {
   IntegerValue stratification_threshold_;
   std::function<void()> feasible_solution_observer_;
 
+  // The sorted distinct weights of the terms_ with a positive weight which are
+  // not fixed at level zero, used by ComputeNextStratificationThreshold(). The
+  // weights only change when cores are processed, which clears the cache, and
+  // the level zero bounds only change when one of the two level zero counters
+  // changes, so the cache is recomputed when they differ from the saved ones.
+  std::vector<IntegerValue> stratification_weights_;
+  bool stratification_weights_are_valid_ = false;
+  int64_t stratification_num_level_zero_enqueues_ = 0;
+  int64_t stratification_num_fixed_literals_ = 0;
+
+  // The state of OptimizeWithSatEncoding(). The encoder owns the lazily
+  // extended totalizer nodes of all the cores found so far, and the bounds are
+  // in term of the nodes of the encoding.
+  std::unique_ptr<ObjectiveEncoder> sat_encoder_;
+  Coefficient sat_encoding_offset_;
+  Coefficient sat_encoding_lower_bound_;
+  Coefficient sat_encoding_stratified_lower_bound_;
+  int sat_encoding_num_cores_ = 0;
+  int sat_encoding_max_depth_ = 0;
+
   // This is used to not add the objective equation more than once if we
   // solve in "chunk".
   bool already_switched_to_linear_scan_ = false;
@@ -0,0 +1,274 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/sat/optimization.h"
+
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/random/distributions.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "ortools/sat/cp_model.pb.h"
+#include "ortools/sat/cp_model_solver.h"
+#include "ortools/sat/model.h"
+#include "ortools/sat/sat_base.h"
+#include "ortools/sat/sat_cnf_reader.h"
+#include "ortools/sat/sat_parameters.pb.h"
+#include "ortools/sat/sat_solver.h"
+#include "ortools/util/time_limit.h"
+
+namespace operations_research {
+namespace sat {
+namespace {
+
+Literal Lit(int signed_value) { return Literal(signed_value); }
+
+// Variables 1 to 10 with not(1) or not(2), and not(3) or not(4) or not(5). So
+// assuming all of them true is infeasible, and {1, 2} is the smallest core.
+class MinimizeCoreTest : public testing::TestWithParam<int> {
+ protected:
+  MinimizeCoreTest() : sat_solver_(model_.GetOrCreate<SatSolver>()) {
+    sat_solver_->SetNumVariables(10);
+    CHECK(sat_solver_->AddBinaryClause(Lit(-1), Lit(-2)));
+    CHECK(sat_solver_->AddProblemClause({Lit(-3), Lit(-4), Lit(-5)}));
+    for (int i = 1; i <= 10; ++i) core_.push_back(Lit(i));
+  }
+
+  Model model_;
+  SatSolver* sat_solver_;
+  std::vector<Literal> core_;
+};
+
+TEST_P(MinimizeCoreTest, FindsTheSmallestCore) {
+  TimeLimit limit;
+  MinimizeCoreWithSearchInParallel(/*num_workers=*/GetParam(), &limit,
+                                   sat_solver_, &core_);
+  EXPECT_EQ(core_, (std::vector<Literal>{Lit(1), Lit(2)}));
+  EXPECT_EQ(sat_solver_->CurrentDecisionLevel(), 0);
+  EXPECT_EQ(sat_solver_->ResetAndSolveWithGivenAssumptions(core_),
+            SatSolver::ASSUMPTIONS_UNSAT);
+}
+
+// With the last literals tried first, MinimizeCoreWithSearch() finds {3, 4, 5}
+// if the literals 1 and 2 come last.
+TEST_P(MinimizeCoreTest, KeepsTheOrderOfTheCore) {
+  std::vector<Literal> core = {Lit(3), Lit(4), Lit(5), Lit(1), Lit(2)};
+  TimeLimit limit;
+  MinimizeCoreWithSearch(&limit, sat_solver_, &core);
+  EXPECT_EQ(core, (std::vector<Literal>{Lit(3), Lit(4), Lit(5)}));
+
+  core = {Lit(3), Lit(4), Lit(5), Lit(1), Lit(2)};
+  MinimizeCoreWithSearchInParallel(/*num_workers=*/GetParam(), &limit,
+                                   sat_solver_, &core);
+  if (GetParam() == 1) {
+    EXPECT_EQ(core, (std::vector<Literal>{Lit(3), Lit(4), Lit(5)}));
+  } else {
+    EXPECT_EQ(core, (std::vector<Literal>{Lit(1), Lit(2)}));
+  }
+}
+
+// A literal fixed at level zero is part of the copies of the solver.
+TEST_P(MinimizeCoreTest, UsesTheLevelZeroAssignment) {
+  ASSERT_TRUE(sat_solver_->AddUnitClause(Lit(-6)));
+  std::vector<Literal> core = {Lit(7), Lit(8), Lit(6), Lit(9)};
+  TimeLimit limit;
+  MinimizeCoreWithSearchInParallel(/*num_workers=*/GetParam(), &limit,
+                                   sat_solver_, &core);
+  EXPECT_EQ(core, std::vector<Literal>{Lit(6)});
+}
+
+INSTANTIATE_TEST_SUITE_P(NumWorkers, MinimizeCoreTest,
+                         testing::Values(1, 2, 4));
+
+// A random weighted max-SAT instance in the WCNF format, with hard clauses of
+// size 3 and soft clauses of size 2.
+struct RandomMaxSat {
+  RandomMaxSat(int num_variables, int num_hard_clauses, int num_soft_clauses,
+               int64_t max_weight, std::mt19937* random)
+      : num_variables(num_variables) {
+    const auto random_clause = [&](int size) {
+      std::vector<int> clause;
+      for (int i = 0; i < size; ++i) {
+        const int var = absl::Uniform<int>(*random, 1, num_variables + 1);
+        clause.push_back(absl::Bernoulli(*random, 0.5) ? var : -var);
+      }
+      return clause;
+    };
+    for (int i = 0; i < num_hard_clauses; ++i) {
+      hard_clauses.push_back(random_clause(3));
+    }
+    for (int i = 0; i < num_soft_clauses; ++i) {
+      soft_clauses.push_back(random_clause(2));
+      weights.push_back(absl::Uniform<int64_t>(*random, 1, max_weight + 1));
+    }
+  }
+
+  // Writes the instance in the 2022 WCNF format and returns the file name.
+  std::string WriteWcnf(const std::string& name) const {
+    const std::string filename =
+        absl::StrCat(testing::TempDir(), "/", name, ".wcnf");
+    std::ofstream file(filename);
+    for (const std::vector<int>& clause : hard_clauses) {
+      file << "h";
+      for (const int lit : clause) file << " " << lit;
+      file << " 0\n";
+    }
+    for (int i = 0; i < soft_clauses.size(); ++i) {
+      file << weights[i];
+      for (const int lit : soft_clauses[i]) file << " " << lit;
+      file << " 0\n";
+    }
+    CHECK(file.good());
+    return filename;
+  }
+
+  // The minimum weight of the falsified soft clauses over all the assignments
+  // satisfying the hard clauses, or -1 if there is none.
+  int64_t BruteForceOptimum() const {
+    CHECK_LE(num_variables, 20);
+    const auto is_true = [](uint32_t assignment, int lit) {
+      const bool value = (assignment >> (std::abs(lit) - 1)) & 1;
+      return lit > 0 ? value : !value;
+    };
+    const auto is_satisfied = [&](uint32_t assignment,
+                                  const std::vector<int>& clause) {
+      for (const int lit : clause) {
+        if (is_true(assignment, lit)) return true;
+      }
+      return false;
+    };
+    int64_t best = std::numeric_limits<int64_t>::max();
+    for (uint32_t assignment = 0; assignment < (1u << num_variables);
+         ++assignment) {
+      bool feasible = true;
+      for (const std::vector<int>& clause : hard_clauses) {
+        if (!is_satisfied(assignment, clause)) {
+          feasible = false;
+          break;
+        }
+      }
+      if (!feasible) continue;
+      int64_t cost = 0;
+      for (int i = 0; i < soft_clauses.size(); ++i) {
+        if (!is_satisfied(assignment, soft_clauses[i])) cost += weights[i];
+      }
+      best = std::min(best, cost);
+    }
+    return best == std::numeric_limits<int64_t>::max() ? -1 : best;
+  }
+
+  int num_variables;
+  std::vector<std::vector<int>> hard_clauses;
+  std::vector<std::vector<int>> soft_clauses;
+  std::vector<int64_t> weights;
+};
+
+SatParameters CoreParameters(int core_minimization_num_workers) {
+  SatParameters parameters;
+  parameters.set_num_workers(1);
+  parameters.set_optimize_with_core(true);
+  parameters.set_cp_model_presolve(false);
+  parameters.set_core_minimization_num_workers(core_minimization_num_workers);
+  return parameters;
+}
+
+// The instances are read through SatCnfReader, and solved with the Boolean
+// encoding of the objective with 1 or 4 threads to minimize the cores.
+class CoreBasedMaxSatTest : public testing::TestWithParam<int> {};
+
+TEST_P(CoreBasedMaxSatTest, FindsTheOptimum) {
+  std::mt19937 random(12345);
+  for (int instance = 0; instance < 20; ++instance) {
+    const RandomMaxSat max_sat(/*num_variables=*/14, /*num_hard_clauses=*/25,
+                               /*num_soft_clauses=*/40, /*max_weight=*/10,
+                               &random);
+    const int64_t optimum = max_sat.BruteForceOptimum();
+    CpModelProto model_proto;
+    SatCnfReader reader;
+    ASSERT_TRUE(reader.Load(
+        max_sat.WriteWcnf(absl::StrCat("instance_", instance)), &model_proto));
+    const CpSolverResponse response =
+        SolveWithParameters(model_proto, CoreParameters(GetParam()));
+    if (optimum == -1) {
+      EXPECT_EQ(response.status(), CpSolverStatus::INFEASIBLE);
+      continue;
+    }
+    ASSERT_EQ(response.status(), CpSolverStatus::OPTIMAL) << instance;
+    EXPECT_EQ(response.objective_value(), optimum) << instance;
+  }
+}
+
+// An objective term with a domain of size 2^28 makes CoreBasedOptimizer use
+// its integer encoding, with stratification on the distinct weights.
+TEST_P(CoreBasedMaxSatTest, FindsTheOptimumWithTheIntegerEncoding) {
+  std::mt19937 random(12345);
+  for (int instance = 0; instance < 20; ++instance) {
+    const RandomMaxSat max_sat(/*num_variables=*/14, /*num_hard_clauses=*/25,
+                               /*num_soft_clauses=*/40, /*max_weight=*/1000,
+                               &random);
+    const int64_t optimum = max_sat.BruteForceOptimum();
+    if (optimum == -1) continue;
+    CpModelProto model_proto;
+    SatCnfReader reader;
+    ASSERT_TRUE(reader.Load(
+        max_sat.WriteWcnf(absl::StrCat("instance_", instance)), &model_proto));
+    IntegerVariableProto* const large = model_proto.add_variables();
+    large->add_domain(0);
+    large->add_domain(int64_t{1} << 28);
+    model_proto.mutable_objective()->add_vars(model_proto.variables_size() - 1);
+    model_proto.mutable_objective()->add_coeffs(1);
+    const CpSolverResponse response =
+        SolveWithParameters(model_proto, CoreParameters(GetParam()));
+    ASSERT_EQ(response.status(), CpSolverStatus::OPTIMAL) << instance;
+    EXPECT_EQ(response.objective_value(), optimum) << instance;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(NumWorkers, CoreBasedMaxSatTest,
+                         testing::Values(1, 4));
+
+// Time to solve a random weighted max-SAT instance with num_variables
+// variables read from a WCNF file, with the given number of threads to
+// minimize the cores. Note that the instances are generated once, and that
+// the file is read at each iteration as part of the timing.
+void BM_SolveWcnf(benchmark::State& state) {
+  const int num_variables = state.range(0);
+  std::mt19937 random(12345);
+  const RandomMaxSat max_sat(num_variables, 2 * num_variables,
+                             2 * num_variables, /*max_weight=*/100, &random);
+  const std::string filename =
+      max_sat.WriteWcnf(absl::StrCat("bm_solve_wcnf_", num_variables));
+  const SatParameters parameters = CoreParameters(state.range(1));
+  for (auto _ : state) {
+    CpModelProto model_proto;
+    SatCnfReader reader;
+    CHECK(reader.Load(filename, &model_proto));
+    const CpSolverResponse response =
+        SolveWithParameters(model_proto, parameters);
+    CHECK_EQ(response.status(), CpSolverStatus::OPTIMAL);
+  }
+}
+BENCHMARK(BM_SolveWcnf)
+    ->ArgsProduct({{100, 300}, {1, 4}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace sat
+}  // namespace operations_research
@@ -99,6 +99,9 @@ std::string ValidateParameters(const SatParameters& params) {
   TEST_IN_RANGE(min_num_lns_workers, 0, kMaxReasonableParallelism);
   TEST_IN_RANGE(shared_tree_num_workers, 0, kMaxReasonableParallelism);
   TEST_IN_RANGE(interleave_batch_size, 0, kMaxReasonableParallelism);
+  TEST_IN_RANGE(core_minimization_num_workers, 1, kMaxReasonableParallelism);
+  TEST_IN_RANGE(equivalence_detection_num_workers, 1,
+                kMaxReasonableParallelism);
 
   // TODO(user): Consider using annotations directly in the proto for these
   // validation. It is however not open sourced.
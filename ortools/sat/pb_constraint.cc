@@ -14,6 +14,8 @@
 #include "ortools/sat/pb_constraint.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -824,7 +826,15 @@ void UpperBoundedLinearConstraint::ResolvePBConflict(
 void UpperBoundedLinearConstraint::Untrail(Coefficient* threshold,
                                            int trail_index) {
   const Coefficient slack = GetSlackFromThreshold(*threshold);
-  while (index_ + 1 < coeffs_.size() && coeffs_[index_ + 1] <= slack) ++index_;
+
+  // On constraints with many distinct coefficients, the slack can jump over a
+  // lot of them after a long backtrack, so we use a binary search rather than
+  // a linear scan unless the index does not change.
+  if (index_ + 1 < coeffs_.size() && coeffs_[index_ + 1] <= slack) {
+    index_ = std::upper_bound(coeffs_.begin() + index_ + 2, coeffs_.end(),
+                              slack) -
+             coeffs_.begin() - 1;
+  }
   Update(slack, threshold);
   if (first_reason_trail_index_ >= trail_index) {
     first_reason_trail_index_ = -1;
@@ -887,9 +897,19 @@ bool PbConstraints::AddConstraint(const std::vector<LiteralWithCoeff>& cst,
   constraints_.emplace_back(c.release());
   for (LiteralWithCoeff term : cst) {
     DCHECK_LT(term.literal.Index(), to_update_.size());
-    to_update_[term.literal].push_back(ConstraintIndexWithCoeff(
-        trail->Assignment().VariableIsAssigned(term.literal.Variable()),
-        cst_index, term.coefficient));
+    const bool is_assigned =
+        trail->Assignment().VariableIsAssigned(term.literal.Variable());
+    if (term.coefficient.value() <= std::numeric_limits<int32_t>::max()) {
+      to_update_[term.literal].push_back(
+          SmallCoeffUpdate(is_assigned, cst_index,
+                           static_cast<int32_t>(term.coefficient.value())));
+    } else {
+      if (to_update_with_large_coeff_.empty()) {
+        to_update_with_large_coeff_.resize(to_update_.size());
+      }
+      to_update_with_large_coeff_[term.literal].push_back(
+          LargeCoeffUpdate(is_assigned, cst_index, term.coefficient));
+    }
   }
   return true;
 }
@@ -908,21 +928,16 @@ bool PbConstraints::AddLearnedConstraint(
   return result;
 }
 
-bool PbConstraints::PropagateNext(Trail* trail) {
-  SCOPED_TIME_STAT(&stats_);
-  const int source_trail_index = propagation_trail_index_;
-  const Literal true_literal = (*trail)[propagation_trail_index_];
-  ++propagation_trail_index_;
-
-  // We need to update ALL threshold, otherwise the Untrail() will not be
-  // synchronized.
-  bool conflict = false;
-  num_threshold_updates_ += to_update_[true_literal].size();
-  for (ConstraintIndexWithCoeff& update : to_update_[true_literal]) {
+template <typename Update>
+void PbConstraints::UpdateThresholdsAndPropagate(int source_trail_index,
+                                                 std::vector<Update>* updates,
+                                                 Trail* trail, bool* conflict) {
+  num_threshold_updates_ += updates->size();
+  for (Update& update : *updates) {
     const Coefficient threshold =
-        thresholds_[update.index] - update.coefficient;
+        thresholds_[update.index] - Coefficient(update.coefficient);
     thresholds_[update.index] = threshold;
-    if (threshold < 0 && !conflict) {
+    if (threshold < 0 && !*conflict) {
       UpperBoundedLinearConstraint* const cst =
           constraints_[update.index.value()].get();
       update.need_untrail_inspection = true;
@@ -932,7 +947,7 @@ bool PbConstraints::PropagateNext(Trail* trail) {
                           &enqueue_helper_)) {
         trail->MutableConflict()->swap(enqueue_helper_.conflict);
         conflicting_constraint_index_ = update.index;
-        conflict = true;
+        *conflict = true;
 
         // We bump the activity of the conflict.
         BumpActivity(constraints_[update.index.value()].get());
@@ -941,6 +956,24 @@ bool PbConstraints::PropagateNext(Trail* trail) {
           old_value - cst->already_propagated_end();
     }
   }
+}
+
+bool PbConstraints::PropagateNext(Trail* trail) {
+  SCOPED_TIME_STAT(&stats_);
+  const int source_trail_index = propagation_trail_index_;
+  const Literal true_literal = (*trail)[propagation_trail_index_];
+  ++propagation_trail_index_;
+
+  // We need to update ALL threshold, otherwise the Untrail() will not be
+  // synchronized.
+  bool conflict = false;
+  UpdateThresholdsAndPropagate(source_trail_index, &to_update_[true_literal],
+                               trail, &conflict);
+  if (!to_update_with_large_coeff_.empty()) {
+    UpdateThresholdsAndPropagate(source_trail_index,
+                                 &to_update_with_large_coeff_[true_literal],
+                                 trail, &conflict);
+  }
   return !conflict;
 }
 
@@ -952,21 +985,29 @@ bool PbConstraints::Propagate(Trail* trail) {
   return true;
 }
 
+template <typename Update>
+void PbConstraints::RestoreThresholds(std::vector<Update>* updates) {
+  for (Update& update : *updates) {
+    thresholds_[update.index] += Coefficient(update.coefficient);
+
+    // Only the constraints which were inspected during Propagate() need
+    // inspection during Untrail().
+    if (update.need_untrail_inspection) {
+      update.need_untrail_inspection = false;
+      to_untrail_.Set(update.index);
+    }
+  }
+}
+
 void PbConstraints::Untrail(const Trail& trail, int trail_index) {
   SCOPED_TIME_STAT(&stats_);
   to_untrail_.ClearAndResize(ConstraintIndex(constraints_.size()));
   while (propagation_trail_index_ > trail_index) {
     --propagation_trail_index_;
     const Literal literal = trail[propagation_trail_index_];
-    for (ConstraintIndexWithCoeff& update : to_update_[literal]) {
-      thresholds_[update.index] += update.coefficient;
-
-      // Only the constraints which were inspected during Propagate() need
-      // inspection during Untrail().
-      if (update.need_untrail_inspection) {
-        update.need_untrail_inspection = false;
-        to_untrail_.Set(update.index);
-      }
+    RestoreThresholds(&to_update_[literal]);
+    if (!to_update_with_large_coeff_.empty()) {
+      RestoreThresholds(&to_update_with_large_coeff_[literal]);
     }
   }
   for (ConstraintIndex cst_index : to_untrail_.PositionsSetAtLeastOnce()) {
@@ -1129,11 +1170,19 @@ void PbConstraints::DeleteConstraintMarkedForDeletion() {
 
   // This is the slow part, we need to remap all the ConstraintIndex to the
   // new ones.
-  for (LiteralIndex lit(0); lit < to_update_.size(); ++lit) {
-    std::vector<ConstraintIndexWithCoeff>& updates = to_update_[lit];
+  RemapConstraintIndices(index_mapping, &to_update_);
+  RemapConstraintIndices(index_mapping, &to_update_with_large_coeff_);
+}
+
+template <typename Update>
+void PbConstraints::RemapConstraintIndices(
+    const absl::StrongVector<ConstraintIndex, ConstraintIndex>& mapping,
+    absl::StrongVector<LiteralIndex, std::vector<Update>>* to_update) {
+  for (LiteralIndex lit(0); lit < to_update->size(); ++lit) {
+    std::vector<Update>& updates = (*to_update)[lit];
     int new_index = 0;
     for (int i = 0; i < updates.size(); ++i) {
-      const ConstraintIndex m = index_mapping[updates[i].index];
+      const ConstraintIndex m = mapping[updates[i].index];
       if (m != -1) {
         updates[new_index] = updates[i];
         updates[new_index].index = m;
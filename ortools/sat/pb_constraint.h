@@ -559,6 +559,9 @@ class PbConstraints : public SatPropagator {
       to_update_.resize(num_variables << 1);
       enqueue_helper_.reasons.resize(num_variables);
     }
+    if (!to_update_with_large_coeff_.empty()) {
+      to_update_with_large_coeff_.resize(num_variables << 1);
+    }
   }
 
   // Adds a constraint in canonical form to the set of managed constraints. Note
@@ -638,15 +641,43 @@ class PbConstraints : public SatPropagator {
   // pointer to an UpperBoundedLinearConstraint. The main reason for this is
   // probably that the thresholds_ vector is a lot more efficient cache-wise.
   DEFINE_STRONG_INDEX_TYPE(ConstraintIndex);
+  template <typename CoeffType>
   struct ConstraintIndexWithCoeff {
     ConstraintIndexWithCoeff() = default;  // Needed for vector.resize()
-    ConstraintIndexWithCoeff(bool n, ConstraintIndex i, Coefficient c)
+    ConstraintIndexWithCoeff(bool n, ConstraintIndex i, CoeffType c)
         : need_untrail_inspection(n), index(i), coefficient(c) {}
     bool need_untrail_inspection;
     ConstraintIndex index;
-    Coefficient coefficient;
+    CoeffType coefficient;
   };
 
+  // Almost all coefficients fit on 32 bits, in which case the entry only takes
+  // 12 bytes instead of 16. Since PropagateNext() is dominated by the scan of
+  // these lists, this makes a noticeable difference on large problems.
+  using SmallCoeffUpdate = ConstraintIndexWithCoeff<int32_t>;
+  using LargeCoeffUpdate = ConstraintIndexWithCoeff<Coefficient>;
+  static_assert(sizeof(SmallCoeffUpdate) == 12);
+
+  // Decreases the thresholds of all the constraints in updates by their
+  // coefficient and propagates the ones that become negative. Once a conflict
+  // is found, the thresholds are still updated but nothing is propagated.
+  template <typename Update>
+  void UpdateThresholdsAndPropagate(int source_trail_index,
+                                    std::vector<Update>* updates, Trail* trail,
+                                    bool* conflict);
+
+  // The reverse of UpdateThresholdsAndPropagate(), this also marks the
+  // constraints that need to be inspected by Untrail() in to_untrail_.
+  template <typename Update>
+  void RestoreThresholds(std::vector<Update>* updates);
+
+  // Remaps the constraint indices of all the given lists and removes the
+  // entries of the deleted constraints.
+  template <typename Update>
+  static void RemapConstraintIndices(
+      const absl::StrongVector<ConstraintIndex, ConstraintIndex>& mapping,
+      absl::StrongVector<LiteralIndex, std::vector<Update>>* to_update);
+
   // The set of all pseudo-boolean constraint managed by this class.
   std::vector<std::unique_ptr<UpperBoundedLinearConstraint>> constraints_;
 
@@ -654,9 +685,12 @@ class PbConstraints : public SatPropagator {
   absl::StrongVector<ConstraintIndex, Coefficient> thresholds_;
 
   // For each literal, the list of all the constraints that contains it together
-  // with the literal coefficient in these constraints.
-  absl::StrongVector<LiteralIndex, std::vector<ConstraintIndexWithCoeff>>
-      to_update_;
+  // with the literal coefficient in these constraints. The terms with a
+  // coefficient that does not fit on 32 bits are stored separately in
+  // to_update_with_large_coeff_ which is only allocated if needed.
+  absl::StrongVector<LiteralIndex, std::vector<SmallCoeffUpdate>> to_update_;
+  absl::StrongVector<LiteralIndex, std::vector<LargeCoeffUpdate>>
+      to_update_with_large_coeff_;
 
   // Bitset used to optimize the Untrail() function.
   SparseBitset<ConstraintIndex> to_untrail_;
@@ -0,0 +1,281 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/sat/pb_constraint.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/random/distributions.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "ortools/sat/boolean_problem.h"
+#include "ortools/sat/boolean_problem.pb.h"
+#include "ortools/sat/model.h"
+#include "ortools/sat/opb_reader.h"
+#include "ortools/sat/sat_base.h"
+#include "ortools/sat/sat_solver.h"
+
+namespace operations_research {
+namespace sat {
+namespace {
+
+// A constraint sum terms <= rhs.
+struct LinearConstraint {
+  std::vector<LiteralWithCoeff> terms;
+  Coefficient rhs;
+};
+
+// Returns num_terms terms on distinct variables with random signs. The
+// coefficients are in [1, 1000] if large is false, and above INT32_MAX
+// otherwise. They are distinct with high probability, so that a constraint
+// has many coefficient buckets.
+std::vector<LiteralWithCoeff> RandomTerms(int num_variables, int num_terms,
+                                          bool large, std::mt19937* random) {
+  std::vector<LiteralWithCoeff> terms;
+  std::vector<bool> used(num_variables, false);
+  while (terms.size() < num_terms) {
+    const int var = absl::Uniform<int>(*random, 0, num_variables);
+    if (used[var]) continue;
+    used[var] = true;
+    const int64_t coefficient =
+        large ? absl::Uniform<int64_t>(
+                    *random, int64_t{std::numeric_limits<int32_t>::max()} + 1,
+                    int64_t{1} << 34)
+              : absl::Uniform<int64_t>(*random, 1, 1001);
+    terms.push_back(LiteralWithCoeff(
+        Literal(BooleanVariable(var), absl::Bernoulli(*random, 0.5)),
+        Coefficient(coefficient)));
+  }
+  return terms;
+}
+
+// Returns the value of each variable, 1 for true, 0 for false and -1 if it is
+// unassigned, after setting the given decisions and propagating the
+// constraints until a fixed point. Returns an empty vector on conflict.
+std::vector<int> BruteForcePropagation(
+    int num_variables, const std::vector<LinearConstraint>& constraints,
+    const std::vector<Literal>& decisions) {
+  std::vector<int> values(num_variables, -1);
+  const auto is_true = [&values](Literal literal) {
+    return values[literal.Variable().value()] == (literal.IsPositive() ? 1 : 0);
+  };
+  for (const Literal decision : decisions) {
+    if (values[decision.Variable().value()] != -1) {
+      if (!is_true(decision)) return {};
+      continue;
+    }
+    values[decision.Variable().value()] = decision.IsPositive() ? 1 : 0;
+  }
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const LinearConstraint& constraint : constraints) {
+      Coefficient slack = constraint.rhs;
+      for (const LiteralWithCoeff& term : constraint.terms) {
+        if (is_true(term.literal)) slack -= term.coefficient;
+      }
+      if (slack < 0) return {};
+      for (const LiteralWithCoeff& term : constraint.terms) {
+        const int var = term.literal.Variable().value();
+        if (values[var] == -1 && term.coefficient > slack) {
+          values[var] = term.literal.IsPositive() ? 0 : 1;
+          changed = true;
+        }
+      }
+    }
+  }
+  return values;
+}
+
+std::vector<int> SolverValues(int num_variables, const SatSolver& solver) {
+  std::vector<int> values(num_variables, -1);
+  for (int var = 0; var < num_variables; ++var) {
+    const Literal literal(BooleanVariable(var), true);
+    if (solver.Assignment().LiteralIsTrue(literal)) values[var] = 1;
+    if (solver.Assignment().LiteralIsFalse(literal)) values[var] = 0;
+  }
+  return values;
+}
+
+// Constraints with only small coefficients, only coefficients above INT32_MAX,
+// or both, so that the literals are in the 32 and 64-bit update lists. Random
+// backtracks over several levels make the slack of the constraints with many
+// distinct coefficients jump over several buckets in Untrail().
+TEST(PbConstraintsTest, PropagatesLikeBruteForceWithLargeCoefficients) {
+  constexpr int kNumVariables = 40;
+  std::mt19937 random(12345);
+  int num_conflicts = 0;
+  int max_num_propagated = 0;
+  for (int trial = 0; trial < 20; ++trial) {
+    std::vector<LinearConstraint> constraints;
+    for (int i = 0; i < 9; ++i) {
+      LinearConstraint& constraint = constraints.emplace_back();
+      constraint.terms =
+          RandomTerms(kNumVariables, /*num_terms=*/8, /*large=*/i % 3 != 0,
+                      &random);
+      if (i % 3 == 2) {
+        for (const LiteralWithCoeff& term :
+             RandomTerms(kNumVariables, /*num_terms=*/8, /*large=*/false,
+                         &random)) {
+          bool is_new = true;
+          for (const LiteralWithCoeff& other : constraint.terms) {
+            is_new &= other.literal.Variable() != term.literal.Variable();
+          }
+          if (is_new) constraint.terms.push_back(term);
+        }
+      }
+      Coefficient sum(0);
+      for (const LiteralWithCoeff& term : constraint.terms) {
+        sum += term.coefficient;
+      }
+      constraint.rhs = Coefficient(
+          absl::Uniform<int64_t>(random, sum.value() / 3, sum.value() / 2));
+    }
+
+    Model model;
+    SatSolver* sat_solver = model.GetOrCreate<SatSolver>();
+    sat_solver->SetNumVariables(kNumVariables);
+    for (const LinearConstraint& constraint : constraints) {
+      std::vector<LiteralWithCoeff> terms = constraint.terms;
+      ASSERT_TRUE(sat_solver->AddLinearConstraint(
+          /*use_lower_bound=*/false, Coefficient(0),
+          /*use_upper_bound=*/true, constraint.rhs, &terms));
+    }
+
+    std::vector<Literal> decisions;
+    for (int step = 0; step < 200; ++step) {
+      if (!decisions.empty() && absl::Bernoulli(random, 0.2)) {
+        decisions.resize(absl::Uniform<int>(random, 0, decisions.size()));
+        sat_solver->Backtrack(decisions.size());
+      } else {
+        std::vector<BooleanVariable> unassigned;
+        for (BooleanVariable var(0); var < kNumVariables; ++var) {
+          if (!sat_solver->Assignment().VariableIsAssigned(var)) {
+            unassigned.push_back(var);
+          }
+        }
+        if (unassigned.empty()) {
+          decisions.clear();
+          sat_solver->Backtrack(0);
+          continue;
+        }
+        const Literal decision(
+            unassigned[absl::Uniform<int>(random, 0, unassigned.size())],
+            absl::Bernoulli(random, 0.5));
+        decisions.push_back(decision);
+        if (!sat_solver->EnqueueDecisionIfNotConflicting(decision)) {
+          ++num_conflicts;
+          EXPECT_TRUE(
+              BruteForcePropagation(kNumVariables, constraints, decisions)
+                  .empty())
+              << "trial " << trial << " step " << step;
+          decisions.pop_back();
+        }
+      }
+      ASSERT_EQ(sat_solver->CurrentDecisionLevel(), decisions.size());
+      const std::vector<int> values = SolverValues(kNumVariables, *sat_solver);
+      ASSERT_EQ(values,
+                BruteForcePropagation(kNumVariables, constraints, decisions))
+          << "trial " << trial << " step " << step;
+      int num_assigned = 0;
+      for (const int value : values) num_assigned += value != -1;
+      max_num_propagated = std::max<int>(max_num_propagated,
+                                         num_assigned - decisions.size());
+    }
+  }
+  // Make sure the constraints propagate and conflict.
+  EXPECT_GT(max_num_propagated, 5);
+  EXPECT_GT(num_conflicts, 10);
+}
+
+// Writes a random instance in the OPB format with num_constraints constraints
+// on all of the num_variables variables, and returns the file name. The
+// coefficients are above INT32_MAX if large is true. The assignment that
+// maximizes the left-hand side of a constraint exceeds its lower bound by 10
+// to 20 times its largest coefficient, so that a few decisions against it make
+// the constraint propagate.
+std::string WriteRandomOpb(const std::string& name, int num_variables,
+                           int num_constraints, bool large,
+                           std::mt19937* random) {
+  const std::string filename =
+      absl::StrCat(testing::TempDir(), "/", name, ".opb");
+  std::ofstream file(filename);
+  file << "* #variable= " << num_variables
+       << " #constraint= " << num_constraints << "\n";
+  for (int i = 0; i < num_constraints; ++i) {
+    int64_t max_value = 0;
+    int64_t max_coefficient = 0;
+    for (int var = 1; var <= num_variables; ++var) {
+      int64_t coefficient = absl::Uniform<int64_t>(*random, 1, 1001);
+      if (large) coefficient <<= 32;
+      if (absl::Bernoulli(*random, 0.5)) {
+        file << "+" << coefficient << " x" << var << " ";
+        max_value += coefficient;
+      } else {
+        file << "-" << coefficient << " x" << var << " ";
+      }
+      max_coefficient = std::max(max_coefficient, coefficient);
+    }
+    const int64_t slack =
+        absl::Uniform<int64_t>(*random, 10, 21) * max_coefficient;
+    file << ">= " << max_value - slack << " ;\n";
+  }
+  CHECK(file.good());
+  return filename;
+}
+
+// Propagation throughput of PbConstraints on a random instance read from an
+// OPB file, with 20 constraints on all of the state.range(0) variables, and
+// coefficients above INT32_MAX if state.range(1) is 1. Each iteration takes up
+// to 100 random decisions, until a conflict, and backtracks.
+void BM_PropagateOpb(benchmark::State& state) {
+  const int num_variables = state.range(0);
+  std::mt19937 random(12345);
+  const std::string filename = WriteRandomOpb(
+      absl::StrCat("bm_propagate_opb_", num_variables, "_", state.range(1)),
+      num_variables, /*num_constraints=*/20, state.range(1) == 1, &random);
+  LinearBooleanProblem problem;
+  OpbReader reader;
+  CHECK(reader.Load(filename, &problem));
+  Model model;
+  SatSolver* sat_solver = model.GetOrCreate<SatSolver>();
+  CHECK(LoadBooleanProblem(problem, sat_solver));
+
+  int64_t num_propagated = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < 100; ++i) {
+      const Literal decision(
+          BooleanVariable(absl::Uniform<int>(random, 0, num_variables)),
+          absl::Bernoulli(random, 0.5));
+      if (sat_solver->Assignment().LiteralIsAssigned(decision)) continue;
+      if (!sat_solver->EnqueueDecisionIfNotConflicting(decision)) break;
+    }
+    num_propagated += model.GetOrCreate<Trail>()->Index();
+    sat_solver->Backtrack(0);
+  }
+  state.counters["propagations/s"] = benchmark::Counter(
+      static_cast<double>(num_propagated), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_PropagateOpb)->ArgsProduct({{1'000, 10'000, 100'000}, {0, 1}});
+
+}  // namespace
+}  // namespace sat
+}  // namespace operations_research
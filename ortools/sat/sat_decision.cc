@@ -14,6 +14,7 @@
 #include "ortools/sat/sat_decision.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <random>
 #include <utility>
@@ -69,9 +70,11 @@ void SatDecisionPolicy::IncreaseNumVariables(int num_variables) {
 }
 
 void SatDecisionPolicy::BeforeConflict(int trail_index) {
-  if (parameters_.use_erwa_heuristic()) {
+  if (UseLearningRate()) {
     ++num_conflicts_;
     num_conflicts_stack_.push_back({trail_.Index(), 1});
+  } else if (parameters_.use_chb_heuristic()) {
+    ++num_conflicts_;
   }
 
   if (trail_index > target_length_) {
@@ -158,6 +161,8 @@ void SatDecisionPolicy::ResetDecisionHeuristic() {
 
   num_conflicts_ = 0;
   num_conflicts_stack_.clear();
+  last_conflict_.clear();
+  last_decay_conflict_.clear();
 
   var_ordering_is_initialized_ = false;
 }
@@ -303,7 +308,7 @@ void SatDecisionPolicy::UpdateWeightedSign(
 
 void SatDecisionPolicy::BumpVariableActivities(
     absl::Span<const Literal> literals) {
-  if (parameters_.use_erwa_heuristic()) {
+  if (UseLearningRate()) {
     if (num_bumps_.size() != activities_.size()) {
       num_bumps_.resize(activities_.size(), 0);
     }
@@ -316,6 +321,20 @@ void SatDecisionPolicy::BumpVariableActivities(
     return;
   }
 
+  if (parameters_.use_chb_heuristic()) {
+    if (last_conflict_.size() != activities_.size()) {
+      last_conflict_.resize(activities_.size(), 0);
+    }
+
+    // The bumps happen during the conflict analysis, before BeforeConflict()
+    // increments num_conflicts_, so we record the conflict about to be
+    // counted. The actual activity update is done on Untrail().
+    for (const Literal literal : literals) {
+      last_conflict_[literal.Variable()] = num_conflicts_ + 1;
+    }
+    return;
+  }
+
   const double max_activity_value = parameters_.max_variable_activity_value();
   for (const Literal literal : literals) {
     const BooleanVariable var = literal.Variable();
@@ -378,11 +397,19 @@ Literal SatDecisionPolicy::NextBranch() {
     }
   } else {
     // The loop is done this way in order to leave the final choice in the heap.
+    // With LRB, the top variable may also move down once its activity is
+    // decayed, in which case we look at the new top.
     DCHECK(!var_ordering_.IsEmpty());
     var = var_ordering_.Top().var;
-    while (trail_.Assignment().VariableIsAssigned(var)) {
-      var_ordering_.Pop();
-      pq_need_update_for_var_at_trail_index_.Set(trail_.Info(var).trail_index);
+    while (true) {
+      if (trail_.Assignment().VariableIsAssigned(var)) {
+        var_ordering_.Pop();
+        pq_need_update_for_var_at_trail_index_.Set(
+            trail_.Info(var).trail_index);
+      } else if (!parameters_.use_lrb_heuristic() ||
+                 !ApplyLrbLocalityDecay(var)) {
+        break;
+      }
       DCHECK(!var_ordering_.IsEmpty());
       var = var_ordering_.Top().var;
     }
@@ -401,12 +428,28 @@ Literal SatDecisionPolicy::NextBranch() {
   return Literal(var, var_polarity_[var]);
 }
 
+bool SatDecisionPolicy::ApplyLrbLocalityDecay(BooleanVariable var) {
+  if (last_decay_conflict_.size() != activities_.size()) {
+    last_decay_conflict_.resize(activities_.size(), 0);
+  }
+  const int64_t num_conflicts = num_conflicts_ - last_decay_conflict_[var];
+  if (num_conflicts <= 0) return false;
+  last_decay_conflict_[var] = num_conflicts_;
+  activities_[var] *= std::pow(0.95, static_cast<double>(num_conflicts));
+  PqInsertOrUpdate(var);
+  return true;
+}
+
 void SatDecisionPolicy::PqInsertOrUpdate(BooleanVariable var) {
   const WeightedVarQueueElement element{
       var, static_cast<float>(tie_breakers_[var]), activities_[var]};
   if (var_ordering_.Contains(var.value())) {
-    // Note that the new weight should always be higher than the old one.
-    var_ordering_.IncreasePriority(element);
+    if (ActivitiesCanDecrease()) {
+      var_ordering_.ChangePriority(element);
+    } else {
+      // Note that the new weight should always be higher than the old one.
+      var_ordering_.IncreasePriority(element);
+    }
   } else {
     var_ordering_.Add(element);
   }
@@ -422,10 +465,14 @@ void SatDecisionPolicy::Untrail(int target_trail_index) {
   }
 
   DCHECK_LT(target_trail_index, trail_.Index());
-  if (parameters_.use_erwa_heuristic()) {
+  if (UseLearningRate()) {
     if (num_bumps_.size() != activities_.size()) {
       num_bumps_.resize(activities_.size(), 0);
     }
+    const bool use_locality = parameters_.use_lrb_heuristic();
+    if (use_locality && last_decay_conflict_.size() != activities_.size()) {
+      last_decay_conflict_.resize(activities_.size(), 0);
+    }
 
     // The ERWA parameter between the new estimation of the learning rate and
     // the old one. TODO(user): Expose parameters for these values.
@@ -461,6 +508,9 @@ void SatDecisionPolicy::Untrail(int target_trail_index) {
         }
         activities_[var] = alpha * new_rate + (1 - alpha) * activities_[var];
       }
+      // The locality decay only applies to the conflicts that happen from now
+      // on, while var is unassigned.
+      if (use_locality) last_decay_conflict_[var] = num_conflicts_;
       if (var_ordering_is_initialized_) PqInsertOrUpdate(var);
     }
     if (num_conflicts > 0) {
@@ -471,6 +521,25 @@ void SatDecisionPolicy::Untrail(int target_trail_index) {
         num_conflicts_stack_.push_back({trail_.Index(), num_conflicts});
       }
     }
+  } else if (parameters_.use_chb_heuristic()) {
+    if (last_conflict_.size() != activities_.size()) {
+      last_conflict_.resize(activities_.size(), 0);
+    }
+
+    // In the paper, the score of a variable is updated each time it is
+    // assigned. We do it when it is unassigned instead, which is equivalent
+    // up to the conflicts that happen while the variable is on the trail, and
+    // lets us do a single pass over the untrailed variables.
+    const double alpha = std::max(0.06, 0.4 - 1e-6 * num_conflicts_);
+    for (int i = trail_.Index() - 1; i >= target_trail_index; --i) {
+      const BooleanVariable var = trail_[i].Variable();
+      const int64_t age =
+          std::max<int64_t>(0, num_conflicts_ - last_conflict_[var]);
+      const double multiplier = age == 0 ? 1.0 : 0.9;
+      const double reward = multiplier / static_cast<double>(age + 1);
+      activities_[var] = alpha * reward + (1 - alpha) * activities_[var];
+      if (var_ordering_is_initialized_) PqInsertOrUpdate(var);
+    }
   } else {
     if (!var_ordering_is_initialized_) return;
 
@@ -133,6 +133,28 @@ class SatDecisionPolicy {
   // already present.
   void PqInsertOrUpdate(BooleanVariable var);
 
+  // Returns true if the activities are the learning rates of the ERWA or LRB
+  // heuristics, which are computed from the number of bumps of each variable
+  // during the conflicts in which it was assigned.
+  bool UseLearningRate() const {
+    return parameters_.use_erwa_heuristic() || parameters_.use_lrb_heuristic();
+  }
+
+  // Returns true if the activities are learning rates (ERWA, LRB) or rewards
+  // (CHB) that can decrease when a variable is untrailed, as opposed to the
+  // VSIDS activities that can only increase between two rescales.
+  bool ActivitiesCanDecrease() const {
+    return UseLearningRate() || parameters_.use_chb_heuristic();
+  }
+
+  // Applies the locality extension of the LRB heuristic to the given
+  // unassigned variable: its activity decays by 0.95 for each conflict since
+  // it was unassigned or last decayed. Returns false if there was no such
+  // conflict, and true if its activity, and thus its place in var_ordering_,
+  // changed. This is done lazily, only for the variables reaching the top of
+  // var_ordering_, since the decay never increases an activity.
+  bool ApplyLrbLocalityDecay(BooleanVariable var);
+
   // Singleton model objects.
   const SatParameters& parameters_;
   const Trail& trail_;
@@ -179,8 +201,10 @@ class SatDecisionPolicy {
   static_assert(sizeof(WeightedVarQueueElement) == 16,
                 "ERROR_WeightedVarQueueElement_is_not_well_compacted");
 
+  // We use a 4-ary heap since with millions of variables, the priority queue
+  // operations done on each Untrail() are dominated by cache misses.
   bool var_ordering_is_initialized_ = false;
-  IntegerPriorityQueue<WeightedVarQueueElement> var_ordering_;
+  QuaternaryIntegerPriorityQueue<WeightedVarQueueElement> var_ordering_;
 
   // This is used for the branching heuristic described in "Learning Rate Based
   // Branching Heuristic for SAT solvers", J.H.Liang, V. Ganesh, P. Poupart,
@@ -196,6 +220,14 @@ class SatDecisionPolicy {
   int64_t num_conflicts_ = 0;
   std::vector<NumConflictsStackEntry> num_conflicts_stack_;
 
+  // Used by the CHB heuristic: the last conflict (as counted by num_conflicts_)
+  // in which each variable was bumped.
+  absl::StrongVector<BooleanVariable, int64_t> last_conflict_;
+
+  // Used by the LRB heuristic: the value of num_conflicts_ when each variable
+  // was last unassigned, or last decayed by ApplyLrbLocalityDecay().
+  absl::StrongVector<BooleanVariable, int64_t> last_decay_conflict_;
+
   // Whether the priority of the given variable needs to be updated in
   // var_ordering_. Note that this is only accessed for assigned variables and
   // that for efficiency it is indexed by trail indices. If
@@ -0,0 +1,231 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/sat/sat_decision.h"
+
+#include <random>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/random/distributions.h"
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "ortools/sat/model.h"
+#include "ortools/sat/sat_base.h"
+#include "ortools/sat/sat_parameters.pb.h"
+#include "ortools/sat/sat_solver.h"
+
+namespace operations_research {
+namespace sat {
+namespace {
+
+using Clauses = std::vector<std::vector<Literal>>;
+
+// Random 3-SAT instance with the given clause/variable ratio. The variables of
+// a clause are distinct.
+Clauses Random3Sat(int num_variables, double ratio, std::mt19937* random) {
+  Clauses clauses(static_cast<int>(ratio * num_variables));
+  for (std::vector<Literal>& clause : clauses) {
+    while (clause.size() < 3) {
+      const BooleanVariable var(absl::Uniform<int>(*random, 0, num_variables));
+      bool is_new = true;
+      for (const Literal literal : clause) is_new &= literal.Variable() != var;
+      if (is_new) clause.push_back(Literal(var, absl::Bernoulli(*random, 0.5)));
+    }
+  }
+  return clauses;
+}
+
+// Pigeon i is in hole j iff variable i * num_holes + j is true.
+Clauses PigeonHole(int num_holes) {
+  const int num_pigeons = num_holes + 1;
+  Clauses clauses;
+  for (int i = 0; i < num_pigeons; ++i) {
+    clauses.emplace_back();
+    for (int j = 0; j < num_holes; ++j) {
+      clauses.back().push_back(
+          Literal(BooleanVariable(i * num_holes + j), true));
+    }
+  }
+  for (int j = 0; j < num_holes; ++j) {
+    for (int i = 0; i < num_pigeons; ++i) {
+      for (int k = i + 1; k < num_pigeons; ++k) {
+        clauses.push_back({Literal(BooleanVariable(i * num_holes + j), false),
+                           Literal(BooleanVariable(k * num_holes + j), false)});
+      }
+    }
+  }
+  return clauses;
+}
+
+SatSolver::Status Solve(const Clauses& clauses, int num_variables,
+                        const SatParameters& parameters) {
+  Model model;
+  SatSolver* sat_solver = model.GetOrCreate<SatSolver>();
+  sat_solver->SetParameters(parameters);
+  sat_solver->SetNumVariables(num_variables);
+  for (const std::vector<Literal>& clause : clauses) {
+    if (!sat_solver->AddProblemClause(clause)) return SatSolver::INFEASIBLE;
+  }
+  const SatSolver::Status status = sat_solver->Solve();
+  if (status == SatSolver::FEASIBLE) {
+    for (const std::vector<Literal>& clause : clauses) {
+      bool is_satisfied = false;
+      for (const Literal literal : clause) {
+        is_satisfied |= sat_solver->Assignment().LiteralIsTrue(literal);
+      }
+      CHECK(is_satisfied);
+    }
+  }
+  return status;
+}
+
+SatParameters ChbParameters() {
+  SatParameters parameters;
+  parameters.set_use_chb_heuristic(true);
+  return parameters;
+}
+
+SatParameters LrbParameters() {
+  SatParameters parameters;
+  parameters.set_use_lrb_heuristic(true);
+  return parameters;
+}
+
+TEST(SatDecisionPolicyTest, ChbBranchesOnVariablesInRecentConflicts) {
+  Model model;
+  model.GetOrCreate<SatParameters>()->set_use_chb_heuristic(true);
+  Trail* trail = model.GetOrCreate<Trail>();
+  trail->Resize(3);
+  SatDecisionPolicy* policy = model.GetOrCreate<SatDecisionPolicy>();
+  policy->IncreaseNumVariables(3);
+  for (int var = 0; var < 3; ++var) {
+    trail->EnqueueSearchDecision(Literal(BooleanVariable(var), true));
+  }
+
+  // Variable 1 takes part in a conflict, and all variables are unassigned.
+  policy->BumpVariableActivities({Literal(BooleanVariable(1), true)});
+  policy->BeforeConflict(trail->Index());
+  policy->Untrail(0);
+  trail->Untrail(0);
+
+  const Literal bumped(BooleanVariable(1), true);
+  EXPECT_GT(policy->Activity(bumped), 0.0);
+  EXPECT_LT(policy->Activity(Literal(BooleanVariable(0), true)),
+            policy->Activity(bumped));
+  EXPECT_LT(policy->Activity(Literal(BooleanVariable(2), true)),
+            policy->Activity(bumped));
+  EXPECT_EQ(policy->NextBranch().Variable(), BooleanVariable(1));
+}
+
+TEST(SatDecisionPolicyTest, ChbSolvesPigeonHole) {
+  EXPECT_EQ(Solve(PigeonHole(6), 7 * 6, ChbParameters()),
+            SatSolver::INFEASIBLE);
+}
+
+// The CHB activities go up and down, so this exercises ChangePriority() on the
+// variable ordering. The result must not depend on the branching heuristic.
+TEST(SatDecisionPolicyTest, ChbAgreesWithDefaultHeuristicOnRandom3Sat) {
+  std::mt19937 random(12345);
+  int num_feasible = 0;
+  for (int trial = 0; trial < 40; ++trial) {
+    const int kNumVariables = 60;
+    const Clauses clauses = Random3Sat(kNumVariables, 4.26, &random);
+    const SatSolver::Status status =
+        Solve(clauses, kNumVariables, SatParameters());
+    ASSERT_EQ(Solve(clauses, kNumVariables, ChbParameters()), status)
+        << "trial " << trial;
+    if (status == SatSolver::FEASIBLE) ++num_feasible;
+  }
+  // Both outcomes must be covered at this ratio.
+  EXPECT_GT(num_feasible, 0);
+  EXPECT_LT(num_feasible, 40);
+}
+
+// With LRB, the activity of a variable decays by 0.95 for each conflict during
+// which it is unassigned, when it reaches the top of the variable ordering.
+TEST(SatDecisionPolicyTest, LrbDecaysTheActivityOfUnassignedVariables) {
+  Model model;
+  model.GetOrCreate<SatParameters>()->set_use_lrb_heuristic(true);
+  Trail* trail = model.GetOrCreate<Trail>();
+  trail->Resize(3);
+  SatDecisionPolicy* policy = model.GetOrCreate<SatDecisionPolicy>();
+  policy->IncreaseNumVariables(3);
+  for (int var = 0; var < 3; ++var) {
+    trail->EnqueueSearchDecision(Literal(BooleanVariable(var), true));
+  }
+
+  // Variable 0 takes part in a conflict, and all variables are unassigned.
+  const Literal bumped(BooleanVariable(0), true);
+  policy->BumpVariableActivities({bumped});
+  policy->BeforeConflict(trail->Index());
+  policy->Untrail(0);
+  trail->Untrail(0);
+  const double activity = policy->Activity(bumped);
+  EXPECT_GT(activity, 0.0);
+
+  // Two conflicts in which only variable 2 is assigned, and not bumped.
+  for (int i = 0; i < 2; ++i) {
+    trail->EnqueueSearchDecision(Literal(BooleanVariable(2), true));
+    policy->BeforeConflict(trail->Index());
+    policy->Untrail(0);
+    trail->Untrail(0);
+  }
+  EXPECT_EQ(policy->Activity(bumped), activity);
+  EXPECT_EQ(policy->NextBranch().Variable(), BooleanVariable(0));
+  EXPECT_DOUBLE_EQ(policy->Activity(bumped), activity * 0.95 * 0.95);
+}
+
+TEST(SatDecisionPolicyTest, LrbSolvesPigeonHole) {
+  EXPECT_EQ(Solve(PigeonHole(6), 7 * 6, LrbParameters()),
+            SatSolver::INFEASIBLE);
+}
+
+// LRB bumps the variables in the reasons of the learned clause, and decays the
+// activities in NextBranch(). The result must not depend on the heuristic.
+TEST(SatDecisionPolicyTest, LrbAgreesWithDefaultHeuristicOnRandom3Sat) {
+  std::mt19937 random(12345);
+  int num_feasible = 0;
+  for (int trial = 0; trial < 40; ++trial) {
+    const int kNumVariables = 60;
+    const Clauses clauses = Random3Sat(kNumVariables, 4.26, &random);
+    const SatSolver::Status status =
+        Solve(clauses, kNumVariables, SatParameters());
+    ASSERT_EQ(Solve(clauses, kNumVariables, LrbParameters()), status)
+        << "trial " << trial;
+    if (status == SatSolver::FEASIBLE) ++num_feasible;
+  }
+  EXPECT_GT(num_feasible, 0);
+  EXPECT_LT(num_feasible, 40);
+}
+
+// Solves random 3-SAT instances close to the phase transition. The argument
+// selects the heuristic: 0 for VSIDS, 1 for ERWA, 2 for CHB and 3 for LRB.
+void BM_SolveRandom3Sat(benchmark::State& state) {
+  const int num_variables = state.range(0);
+  SatParameters parameters;
+  parameters.set_use_erwa_heuristic(state.range(1) == 1);
+  parameters.set_use_chb_heuristic(state.range(1) == 2);
+  parameters.set_use_lrb_heuristic(state.range(1) == 3);
+  std::mt19937 random(12345);
+  for (auto _ : state) {
+    Solve(Random3Sat(num_variables, 4.26, &random), num_variables, parameters);
+  }
+}
+BENCHMARK(BM_SolveRandom3Sat)
+    ->ArgsProduct({{100, 150}, {0, 1, 2, 3}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace sat
+}  // namespace operations_research
@@ -721,7 +721,9 @@ void SatSolver::ProcessCurrentConflict() {
   // sets are disjoint.
   decision_policy_->BumpVariableActivities(learned_conflict_);
   decision_policy_->BumpVariableActivities(reason_used_to_infer_the_conflict_);
-  if (parameters_->also_bump_variables_in_conflict_reasons()) {
+  // This is the "reason side rate" extension of the LRB heuristic.
+  if (parameters_->also_bump_variables_in_conflict_reasons() ||
+      parameters_->use_lrb_heuristic()) {
     ComputeUnionOfReasons(learned_conflict_, &extra_reason_literals_);
     decision_policy_->BumpVariableActivities(extra_reason_literals_);
   }
@@ -1357,6 +1359,7 @@ SatSolver::Status SatSolver::SolveInternal(TimeLimit* time_limit,
 
       if (restart_->ShouldRestart()) {
         Backtrack(assumption_level_);
+        binary_implication_graph_->CompactImplicationsIfUseful();
       }
 
       // Clause minimization using propagation.
@@ -0,0 +1,79 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/util/file_contents.h"
+
+#if !defined(_MSC_VER)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !_MSC_VER
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ortools/base/file.h"
+#include "ortools/base/status_macros.h"
+
+namespace operations_research {
+
+absl::StatusOr<std::unique_ptr<FileContents>> FileContents::Open(
+    absl::string_view file_name, bool sequential_access) {
+  std::unique_ptr<FileContents> file(new FileContents());
+#if !defined(_MSC_VER) && !defined(__PORTABLE_PLATFORM__)
+  // Memory-map the file if we can, and fall back to reading it otherwise (for
+  // instance if file_name is not a regular file). The mapping is page-aligned.
+  const std::string file_name_str(file_name);
+  const int fd = open(file_name_str.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) &&
+        file_stat.st_size > 0) {
+      void* const data = mmap(nullptr, file_stat.st_size, PROT_READ,
+                              MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        if (sequential_access) {
+          madvise(data, file_stat.st_size, MADV_SEQUENTIAL);
+        }
+        file->mapped_data_ = data;
+        file->mapped_size_ = file_stat.st_size;
+        file->contents_ = absl::string_view(static_cast<const char*>(data),
+                                            file->mapped_size_);
+      }
+    }
+    close(fd);
+    if (file->is_mapped()) return file;
+  }
+#endif  // !_MSC_VER && !__PORTABLE_PLATFORM__
+  std::string contents;
+  RETURN_IF_ERROR(file::GetContents(file_name, &contents, file::Defaults()));
+  file->buffer_ = std::make_unique<uint64_t[]>(
+      (contents.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+  memcpy(file->buffer_.get(), contents.data(), contents.size());
+  file->contents_ = absl::string_view(
+      reinterpret_cast<const char*>(file->buffer_.get()), contents.size());
+  return file;
+}
+
+FileContents::~FileContents() {
+#if !defined(_MSC_VER) && !defined(__PORTABLE_PLATFORM__)
+  if (mapped_data_ != nullptr) munmap(mapped_data_, mapped_size_);
+#endif  // !_MSC_VER && !__PORTABLE_PLATFORM__
+}
+
+}  // namespace operations_research
@@ -0,0 +1,65 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OR_TOOLS_UTIL_FILE_CONTENTS_H_
+#define OR_TOOLS_UTIL_FILE_CONTENTS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace operations_research {
+
+// Read-only view of the whole content of a file. When possible, the file is
+// memory-mapped so that a large file is paged in by the OS as it is read
+// instead of being copied; otherwise it is read with file::GetContents().
+//
+// In both cases, the content starts at an address aligned for any of the
+// fundamental types, so that binary arrays stored at aligned offsets of the
+// file can be used in place.
+class FileContents {
+ public:
+  // Opens the given file. If sequential_access is true, the OS is told that
+  // the mapping will be read from start to end.
+  static absl::StatusOr<std::unique_ptr<FileContents>> Open(
+      absl::string_view file_name, bool sequential_access = false);
+
+  // This type is neither copyable nor movable.
+  FileContents(const FileContents&) = delete;
+  FileContents& operator=(const FileContents&) = delete;
+
+  ~FileContents();
+
+  absl::string_view contents() const { return contents_; }
+
+  // Returns true if the file is memory-mapped.
+  bool is_mapped() const { return mapped_data_ != nullptr; }
+
+ private:
+  FileContents() = default;
+
+  // The file content, when it is not memory-mapped. We use uint64_t to have
+  // the alignment of the mapped case.
+  std::unique_ptr<uint64_t[]> buffer_;
+
+  void* mapped_data_ = nullptr;
+  size_t mapped_size_ = 0;
+  absl::string_view contents_;
+};
+
+}  // namespace operations_research
+
+#endif  // OR_TOOLS_UTIL_FILE_CONTENTS_H_
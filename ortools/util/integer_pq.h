@@ -23,10 +23,13 @@
 #ifndef OR_TOOLS_UTIL_INTEGER_PQ_H_
 #define OR_TOOLS_UTIL_INTEGER_PQ_H_
 
+#include <algorithm>
+#include <functional>
 #include <vector>
 
 #include "ortools/base/logging.h"
 #include "ortools/base/macros.h"
+#include "ortools/util/aligned_memory.h"
 
 namespace operations_research {
 
@@ -185,6 +188,133 @@ class IntegerPriorityQueue {
   std::vector<int> position_;
 };
 
+// Same interface as IntegerPriorityQueue but using a 4-ary heap. Such a heap
+// has half the depth of a binary one, and the four children of a node are
+// stored contiguously in a cache-line aligned block (this is exact when
+// sizeof(Element) is 16, as is the case for the SAT variable ordering). This
+// trades a few more comparisons in SetAndDecreasePriority() for fewer cache
+// misses, which is a clear win when the queue contains millions of elements
+// and most of the operations are IncreasePriority() or Pop().
+//
+// Layout: the root is stored at heap_[kRoot] and the children of the node at
+// position i are stored at [4 * i - 8, 4 * i - 4). With kRoot = 3, each group
+// of siblings starts at a multiple of 4. Position 0 is still used as a
+// sentinel for the elements not in the queue.
+template <typename Element, class Compare = std::less<Element>>
+class QuaternaryIntegerPriorityQueue {
+ public:
+  explicit QuaternaryIntegerPriorityQueue(int n = 0, Compare comp = Compare())
+      : size_(0), less_(comp) {
+    Reserve(n);
+  }
+
+  void Reserve(int n) {
+    heap_.resize(n + kRoot);
+    position_.resize(n, 0);
+  }
+
+  int Size() const { return size_; }
+  bool IsEmpty() const { return size_ == 0; }
+
+  void Clear() {
+    size_ = 0;
+    position_.assign(position_.size(), 0);
+  }
+
+  bool Contains(int index) const { return position_[index] != 0; }
+
+  void Add(Element element) {
+    DCHECK(!Contains(element.Index()));
+    SetAndIncreasePriority(kRoot + size_++, element);
+  }
+
+  Element Top() const { return heap_[kRoot]; }
+  void Pop() {
+    DCHECK(!IsEmpty());
+    position_[Top().Index()] = 0;
+    const int last = kRoot + --size_;
+    if (size_ > 0) SetAndDecreasePriority(kRoot, heap_[last]);
+  }
+
+  void Remove(int index) {
+    DCHECK(Contains(index));
+    const int to_replace = position_[index];
+    position_[index] = 0;
+    const int last = kRoot + --size_;
+    if (to_replace == last) return;
+    const Element element = heap_[last];
+    if (less_(element, heap_[to_replace])) {
+      SetAndDecreasePriority(to_replace, element);
+    } else {
+      SetAndIncreasePriority(to_replace, element);
+    }
+  }
+
+  void ChangePriority(Element element) {
+    DCHECK(Contains(element.Index()));
+    const int i = position_[element.Index()];
+    if (i > kRoot && less_(heap_[Parent(i)], element)) {
+      SetAndIncreasePriority(i, element);
+    } else {
+      SetAndDecreasePriority(i, element);
+    }
+  }
+
+  void IncreasePriority(Element element) {
+    SetAndIncreasePriority(position_[element.Index()], element);
+  }
+  void DecreasePriority(Element element) {
+    SetAndDecreasePriority(position_[element.Index()], element);
+  }
+
+  Element GetElement(int index) const { return heap_[position_[index]]; }
+  Element QueueElement(int i) const { return heap_[kRoot + i]; }
+
+ private:
+  static constexpr int kRoot = 3;
+  static int Parent(int i) { return (i >> 2) + 2; }
+  static int FirstChild(int i) { return 4 * i - 8; }
+
+  void Set(int i, Element element) {
+    heap_[i] = element;
+    position_[element.Index()] = i;
+  }
+
+  void SetAndDecreasePriority(int i, const Element element) {
+    const int end = kRoot + size_;
+    while (true) {
+      const int first = FirstChild(i);
+      if (first >= end) break;
+      const int last = std::min(first + 4, end);
+      int best = first;
+      for (int c = first + 1; c < last; ++c) {
+        if (less_(heap_[best], heap_[c])) best = c;
+      }
+      const Element best_element = heap_[best];
+      if (!less_(element, best_element)) break;
+      Set(i, best_element);
+      i = best;
+    }
+    Set(i, element);
+  }
+
+  void SetAndIncreasePriority(int i, const Element element) {
+    while (i > kRoot) {
+      const int parent = Parent(i);
+      const Element parent_element = heap_[parent];
+      if (!less_(parent_element, element)) break;
+      Set(i, parent_element);
+      i = parent;
+    }
+    Set(i, element);
+  }
+
+  int size_;
+  Compare less_;
+  AlignedVector<Element, 64> heap_;
+  std::vector<int> position_;
+};
+
 }  // namespace operations_research
 
 #endif  // OR_TOOLS_UTIL_INTEGER_PQ_H_
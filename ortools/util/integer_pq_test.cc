@@ -0,0 +1,145 @@
+// Copyright 2010-2022 Google LLC
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ortools/util/integer_pq.h"
+
+#include <random>
+#include <vector>
+
+#include "absl/random/distributions.h"
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+
+namespace operations_research {
+namespace {
+
+struct Element {
+  int Index() const { return index; }
+  bool operator<(const Element& other) const {
+    return priority < other.priority ||
+           (priority == other.priority && index < other.index);
+  }
+
+  int index;
+  double priority;
+};
+
+template <typename Queue>
+class IntegerPriorityQueueTest : public ::testing::Test {};
+
+using QueueTypes = ::testing::Types<IntegerPriorityQueue<Element>,
+                                    QuaternaryIntegerPriorityQueue<Element>>;
+TYPED_TEST_SUITE(IntegerPriorityQueueTest, QueueTypes);
+
+TYPED_TEST(IntegerPriorityQueueTest, PopsInDecreasingOrder) {
+  TypeParam queue(5);
+  for (const int index : {3, 0, 4, 1, 2}) queue.Add({index, 1.0 * index});
+  EXPECT_EQ(queue.Size(), 5);
+  for (int index = 4; index >= 0; --index) {
+    ASSERT_FALSE(queue.IsEmpty());
+    EXPECT_EQ(queue.Top().index, index);
+    queue.Pop();
+    EXPECT_FALSE(queue.Contains(index));
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+// Applies random operations to the queue and to a plain vector of priorities,
+// and checks that they agree after each of them.
+TYPED_TEST(IntegerPriorityQueueTest, MatchesBruteForceOnRandomOperations) {
+  const int kNumElements = 200;
+  std::mt19937 random(12345);
+  TypeParam queue(kNumElements);
+  std::vector<bool> in_queue(kNumElements, false);
+  std::vector<double> priorities(kNumElements, 0.0);
+  for (int step = 0; step < 20000; ++step) {
+    const int index = absl::Uniform<int>(random, 0, kNumElements);
+    const double priority = absl::Uniform<int>(random, 0, 50);
+    const int operation = absl::Uniform<int>(random, 0, 5);
+    if (!in_queue[index]) {
+      queue.Add({index, priority});
+      in_queue[index] = true;
+      priorities[index] = priority;
+    } else if (operation == 0) {
+      queue.Remove(index);
+      in_queue[index] = false;
+    } else if (operation == 1 && priority >= priorities[index]) {
+      queue.IncreasePriority({index, priority});
+      priorities[index] = priority;
+    } else if (operation == 2 && priority <= priorities[index]) {
+      queue.DecreasePriority({index, priority});
+      priorities[index] = priority;
+    } else if (operation == 3) {
+      queue.ChangePriority({index, priority});
+      priorities[index] = priority;
+    } else if (!queue.IsEmpty()) {
+      in_queue[queue.Top().index] = false;
+      queue.Pop();
+    }
+
+    int expected_top = -1;
+    int expected_size = 0;
+    for (int i = 0; i < kNumElements; ++i) {
+      if (!in_queue[i]) continue;
+      ++expected_size;
+      if (expected_top == -1 ||
+          Element{expected_top, priorities[expected_top]} <
+              Element{i, priorities[i]}) {
+        expected_top = i;
+      }
+      ASSERT_TRUE(queue.Contains(i));
+      ASSERT_EQ(queue.GetElement(i).priority, priorities[i]);
+    }
+    ASSERT_EQ(queue.Size(), expected_size) << "step " << step;
+    if (expected_size > 0) {
+      ASSERT_EQ(queue.Top().index, expected_top) << "step " << step;
+    }
+  }
+}
+
+// Mimics the SAT variable ordering: all elements are in the queue, most
+// operations increase the priority of a random element, and from time to time
+// a few elements are popped and added back.
+template <typename Queue>
+void BM_IncreaseAndPop(benchmark::State& state) {
+  const int num_elements = state.range(0);
+  std::mt19937 random(12345);
+  Queue queue(num_elements);
+  std::vector<double> priorities(num_elements, 0.0);
+  for (int i = 0; i < num_elements; ++i) queue.Add({i, 0.0});
+  std::vector<Element> popped;
+  for (auto _ : state) {
+    for (int i = 0; i < 100; ++i) {
+      const int index = absl::Uniform<int>(random, 0, num_elements);
+      priorities[index] += absl::Uniform<double>(random, 0.0, 1.0);
+      queue.IncreasePriority({index, priorities[index]});
+    }
+    for (int i = 0; i < 10; ++i) {
+      popped.push_back(queue.Top());
+      queue.Pop();
+    }
+    for (const Element element : popped) {
+      queue.Add({element.index, priorities[element.index]});
+    }
+    popped.clear();
+  }
+}
+BENCHMARK_TEMPLATE(BM_IncreaseAndPop, IntegerPriorityQueue<Element>)
+    ->Arg(1'000)
+    ->Arg(1'000'000);
+BENCHMARK_TEMPLATE(BM_IncreaseAndPop, QuaternaryIntegerPriorityQueue<Element>)
+    ->Arg(1'000)
+    ->Arg(1'000'000);
+
+}  // namespace
+}  // namespace operations_research